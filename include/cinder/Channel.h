@@ -27,6 +27,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Area.h"
+#include "cinder/PixelAllocator.h"
 
 #include <algorithm>
 
@@ -42,6 +43,8 @@ class ChannelT {
 	ChannelT();
 	//! Allocates and owns a contiguous block of memory that is sizeof(T) * width * height
 	ChannelT( int32_t width, int32_t height );
+	//! Allocates and owns a block of memory whose rows are padded to a multiple of \a rowAlignment bytes, a power of two. Storage comes from \a allocator, or PixelAllocator::get() when it's \c nullptr.
+	ChannelT( int32_t width, int32_t height, size_t rowAlignment, const PixelAllocatorRef &allocator = nullptr );
 	//! Does not allocate or own memory pointed to by \a data
 	ChannelT( int32_t width, int32_t height, ptrdiff_t rowBytes, uint8_t increment, T *data );
 	//! Does not allocate memory pointed to by \a data but holds a reference to \a dataStore
@@ -60,6 +63,10 @@ class ChannelT {
 	//! Allocates and owns a contiguous block of memory that is sizeof(T) * width * height
 	static std::shared_ptr<ChannelT<T>> create( int32_t width, int32_t height )
 	{ return std::make_shared<ChannelT<T>>( width, height ); }
+
+	//! Allocates and owns a block of memory whose rows are padded to a multiple of \a rowAlignment bytes, a power of two. Storage comes from \a allocator, or PixelAllocator::get() when it's \c nullptr.
+	static std::shared_ptr<ChannelT<T>> create( int32_t width, int32_t height, size_t rowAlignment, const PixelAllocatorRef &allocator = nullptr )
+	{ return std::make_shared<ChannelT<T>>( width, height, rowAlignment, allocator ); }
 	
 	//! Does not allocate or own memory pointed to by \a data
 	static std::shared_ptr<ChannelT<T>> create( int32_t width, int32_t height, ptrdiff_t rowBytes, uint8_t increment, T *data )
@@ -275,6 +282,9 @@ class ChannelT {
 	ConstIter	getIter( const Area &area ) const { return ConstIter( *this, area ); }
 
   protected:
+	//! Allocates mHeight * mRowBytes bytes of planar storage from \a allocator, or PixelAllocator::get() when it's \c nullptr
+	void	allocateData( const PixelAllocatorRef &allocator = nullptr );
+
 	int32_t						mWidth, mHeight;
 	uint8_t						mIncrement;
 	ptrdiff_t					mRowBytes;
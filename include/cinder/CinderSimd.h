@@ -0,0 +1,72 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Noncopyable.h"
+
+// Instruction sets available to the compiler for this target. The AVX2 kernels are compiled regardless of compiler flags
+// and must only be called when simd::getLevel() reports AVX2 at runtime.
+#if defined( _M_X64 ) || defined( __x86_64__ ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) ) || defined( __SSE2__ )
+	#define CINDER_SIMD_SSE2
+	#define CINDER_SIMD_AVX2
+	#include <emmintrin.h>
+	#include <immintrin.h>
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+	#define CINDER_SIMD_NEON
+	#include <arm_neon.h>
+#endif
+
+// Kernels are written as templates over a set of vector operations and forced inline into an entry point that carries the
+// instruction set's target attribute, so that GCC and Clang emit AVX2 code without it being enabled for the whole translation unit.
+#if defined( _MSC_VER )
+	#define CINDER_SIMD_FORCEINLINE		__forceinline
+	#define CINDER_SIMD_TARGET_AVX2
+#else
+	#define CINDER_SIMD_FORCEINLINE		inline __attribute__(( always_inline ))
+	#define CINDER_SIMD_TARGET_AVX2		__attribute__(( target( "avx2" ) ))
+#endif
+
+namespace cinder { namespace simd {
+
+//! Instruction set levels used by Cinder's SIMD kernels, in increasing order of preference.
+enum class Level { SCALAR, NEON, SSE2, AVX2 };
+
+//! Returns the instruction set level that kernels should dispatch to, which is the best level supported by both the compiler and the CPU, limited by setMaxLevel().
+Level	getLevel();
+//! Limits the instruction set level returned by getLevel() to \a level. Passing Level::SCALAR forces the scalar fallbacks, which is mostly useful for testing and benchmarking.
+void	setMaxLevel( Level level );
+//! Returns the limit set with setMaxLevel(), Level::AVX2 by default.
+Level	getMaxLevel();
+
+//! Limits the instruction set level with setMaxLevel() for the lifetime of the object, restoring the previous limit when it goes out of scope.
+struct ScopedMaxLevel : private Noncopyable {
+	ScopedMaxLevel( Level level ) : mPrevLevel( getMaxLevel() )	{ setMaxLevel( level ); }
+	~ScopedMaxLevel()											{ setMaxLevel( mPrevLevel ); }
+
+  private:
+	Level	mPrevLevel;
+};
+
+} } // namespace cinder::simd
@@ -108,6 +108,40 @@ class DataSourceAndroidAsset : public DataSource {
 
 DataSourceRef	loadFile( const fs::path &path );
 
+
+typedef std::shared_ptr<class DataSourceMapped>	DataSourceMappedRef;
+
+//! A DataSourcePath whose Buffer maps the file into memory rather than reading a copy of it, so that decoders read straight from the page cache.
+/** The mapping is copy-on-write: writing to the Buffer is safe and only copies the pages touched, but never reaches the file. The file must not be truncated while
+	mapped. On UWP, where files can't be mapped, the file is read as DataSourcePath does. **/
+class DataSourceMapped : public DataSourcePath {
+  public:
+	//! How the mapped file is expected to be read, passed to the operating system as a paging hint
+	enum AccessHint {
+		ACCESS_NORMAL,		//!< No particular pattern
+		ACCESS_SEQUENTIAL,	//!< Read front to back, as decoders do. Pages are read ahead aggressively and may be dropped soon after they are read.
+		ACCESS_RANDOM,		//!< Read in no particular order, such as looking up parts of an archive. Read-ahead is disabled.
+		ACCESS_WILL_NEED	//!< The whole file will be read soon, so it's paged in ahead of time where supported
+	};
+
+	static DataSourceMappedRef	create( const fs::path &path, AccessHint accessHint = ACCESS_NORMAL );
+
+	//! Returns a stream which reads from the mapped Buffer
+	virtual IStreamRef	createStream();
+
+	AccessHint	getAccessHint() const	{ return mAccessHint; }
+
+  protected:
+	DataSourceMapped( const fs::path &path, AccessHint accessHint );
+
+	virtual	void	createBuffer();
+
+	AccessHint		mAccessHint;
+};
+
+//! Returns a DataSource for \a path whose getBuffer() maps the file into memory rather than copying it to the heap. \see DataSourceMapped
+DataSourceRef	loadFileMapped( const fs::path &path, DataSourceMapped::AccessHint accessHint = DataSourceMapped::ACCESS_NORMAL );
+
 #if ! defined( CINDER_UWP )
 typedef std::shared_ptr<class DataSourceUrl>	DataSourceUrlRef;
 
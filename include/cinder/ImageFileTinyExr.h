@@ -24,34 +24,58 @@
 #pragma once
 
 #include "cinder/ImageIo.h"
+#include "cinder/Area.h"
 
 #define USE_PLANAR_CHANNELS 1
 
-typedef struct _EXRImage EXRImage;
-
 namespace cinder {
 
 typedef std::shared_ptr<class ImageTargetFileTinyExr> ImageTargetFileTinyExrRef;
 
 typedef std::shared_ptr<class ImageSourceFileTinyExr>	ImageSourceFileTinyExrRef;
 
+//! Loads OpenEXR images, scanline or tiled, with NONE, RLE, ZIPS or ZIP compression.
+/** The image is decoded one chunk at a time as it is passed to the ImageTarget, so only the target holds the whole image. setRegion() restricts loading to
+	part of the image, or one of the levels of a mipmapped file, reading only the chunks it overlaps. ImageSource::Options::numThreads() decompresses chunks in
+	parallel, and ImageSource::Options::targetSize() selects the mip level closest to the requested size. **/
 class ImageSourceFileTinyExr : public ImageSource {
 public:
 	static ImageSourceRef	create( DataSourceRef dataSource, ImageSource::Options options = ImageSource::Options() );
+	~ImageSourceFileTinyExr();
 
 	void load( ImageTargetRef target ) override;
 
+	//! Returns whether the image is stored as tiles rather than scanlines
+	bool	isTiled() const;
+	//! Returns the number of resolution levels in the file. Only tiled files may have more than one.
+	int		getNumLevels() const;
+	//! Returns the size of resolution level \a level
+	ivec2	getLevelSize( int level ) const;
+	//! Restricts load() to \a area of resolution level \a level, clipped to the level's bounds. Subsequent calls to getWidth() and getHeight() return the size of the clipped area. Overrides any reduction requested through ImageSource::Options.
+	void	setRegion( const Area &area, int level = 0 );
+
 	static void		registerSelf();
 
 protected:
 	ImageSourceFileTinyExr( DataSourceRef dataSourceRef, ImageSource::Options options );
 
-	std::unique_ptr<EXRImage>	mExrImage;
+	std::unique_ptr<struct ExrFileLayout>	mLayout;
+	IStreamRef								mStream;
+	int										mNumThreads;
+	int										mLevel;
+	Area									mArea;
+	//! The index of each of the loaded channels in the file, in the order of getChannelOrder()
+	std::vector<size_t>						mChannelIndices;
 };
 
+//! Writes OpenEXR images with ZIP compression as they are loaded, so that only a few strips of the image are held in memory.
+/** Rows must be written in increasing order, as ImageSource::load() does. The create() overload taking a size allows writing an image a strip at a time without an
+	ImageSource. ImageTarget::Options::numThreads() compresses a batch of strips in parallel. The DataTarget's stream must be seekable. **/
 class ImageTargetFileTinyExr : public ImageTarget {
   public:
 	static ImageTargetRef		create( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string &extensionData );
+	//! Creates a target for writing an RGB, or RGBA if \a alpha, float image of \a width x \a height. Fill each row returned by getRowPointer() with interleaved values, in increasing order of rows, then call finalize().
+	static ImageTargetFileTinyExrRef	create( const DataTargetRef &dataTarget, int32_t width, int32_t height, bool alpha, const ImageTarget::Options &options = ImageTarget::Options() );
 
 	void*	getRowPointer( int32_t row ) override;
 	void	finalize() override;
@@ -59,12 +83,22 @@ class ImageTargetFileTinyExr : public ImageTarget {
 	static void		registerSelf();
 	
   protected:
-	ImageTargetFileTinyExr( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string &extensionData );
+	ImageTargetFileTinyExr( const DataTargetRef &dataTarget, int32_t width, int32_t height, ImageIo::ColorModel colorModel, bool alpha, const ImageTarget::Options &options );
+
+	//! Compresses and writes the rows buffered in \a mData
+	void	writeBatch();
 	
 	uint8_t						mNumComponents;
-	fs::path					mFilePath;
+	OStreamRef					mStream;
+	off_t						mStreamStart, mOffsetTablePos;
+	int							mNumThreads;
+	//! The rows buffered in \a mData start at \a mBatchStart
+	int32_t						mBatchStart, mRowsPerBatch;
 	std::vector<float>			mData;
 	std::vector<std::string>	mChannelNames;
+	//! The component of the interleaved rows stored in each channel of the file
+	std::vector<uint8_t>		mChannelComponents;
+	std::vector<uint64_t>		mChunkOffsets;
 };
 
 class ImageIoExceptionFailedLoadTinyExr : public ImageIoExceptionFailedLoad {
@@ -91,21 +91,40 @@ class ImageSource : public ImageIo {
 	//! Optional parameters passed when creating an Image. \see loadImage()
 	class Options {
 	  public:
-		Options() : mIndex( 0 ), mThrowOnFirstException( false ) {}
+		Options() : mIndex( 0 ), mThrowOnFirstException( false ), mTargetSize( 0 ), mScale( 1 ), mNumThreads( 1 ) {}
 
 		//! Specifies an image index for multi-part images, like animated GIFs. 0-based index.
 		Options& index( int32_t index )						{ mIndex = index; return *this; }
 		//! If an exception occurs, enabling this will prevent any attempts at using other handlers to load the image. Default = false, all handlers are tried and if none succeed, the last exception is rethrown. \see ImageIoException
 		Options& throwOnFirstException( bool b = true )		{ mThrowOnFirstException = b; return *this; }
+		/** \brief Requests a reduced resolution decode which is no smaller than \a size. A component of \c 0 leaves that dimension unconstrained, and the aspect ratio is always preserved.
+			Loaders reduce by whole factors as cheaply as their format allows, so the result is usually somewhat larger than \a size. Use SurfaceT( ImageSourceRef, const ivec2&, ... ) to arrive at an exact size. **/
+		Options& targetSize( const ivec2 &size )			{ mTargetSize = size; return *this; }
+		//! Requests a reduced resolution decode which is no smaller than \a scale times the full resolution, where \a scale is in (0, 1]. \see targetSize()
+		Options& scale( float scale )						{ mScale = scale; return *this; }
+		/** \brief Allows loaders which support it to decode independent parts of a single image on up to \a numThreads threads. \c 1, the default, decodes on the calling thread, and \c 0 uses the hardware concurrency.
+			Currently honored by the OpenEXR loader, which decompresses chunks in parallel, and the Radiance loader, which decodes scanlines in parallel. **/
+		Options& numThreads( int numThreads )				{ mNumThreads = numThreads; return *this; }
 
 		//! Returns image index. \see index()
 		int32_t				getIndex() const				{ return mIndex; }
 		//! Returns whether throwOnFirstException() is enabled or not.
 		bool				getThrowOnFirstException()		{ return mThrowOnFirstException; }
+		//! Returns the requested minimum decode size. \see targetSize()
+		const ivec2&		getTargetSize() const			{ return mTargetSize; }
+		//! Returns the requested decode scale. \see scale()
+		float				getScale() const				{ return mScale; }
+		//! Returns the number of threads a loader may decode with. \see numThreads()
+		int					getNumThreads() const			{ return mNumThreads; }
+		//! Returns the largest whole factor an image of \a fullSize can be reduced by while remaining no smaller than targetSize() and scale() allow. Returns \c 1 when no reduction was requested.
+		int32_t				calcReductionFactor( const ivec2 &fullSize ) const;
 		
 	  protected:
 		int32_t			mIndex;
 		bool			mThrowOnFirstException;
+		ivec2			mTargetSize;
+		float			mScale;
+		int				mNumThreads;
 	};
 
 	//! Returns the aspect ratio of individual pixels to accommodate non-square pixels
@@ -128,6 +147,14 @@ class ImageSource : public ImageIo {
 	void		setCustomPixelInc( int8_t customPixelInc ) { mCustomPixelInc = customPixelInc; }
 	void		setFrameCount( int32_t frameCount ) { mFrameCount = frameCount; }
 
+	/** \brief Declares that the decoder produces rows of \a decodedSize, which processRow() box-filters by \a factor before converting them.
+		The ImageSource's size becomes \a decodedSize divided by \a factor, rounded up. Used by loaders whose format offers no cheaper way to honor Options::targetSize() or Options::scale(). **/
+	void		setDecodedSize( const ivec2 &decodedSize, int32_t factor );
+	//! Returns the height of the image the decoder produces, which differs from getHeight() after setDecodedSize()
+	int32_t		getDecodedHeight() const;
+	//! Passes the decoder's row \a decodedRow through \a func to \a target, box-filtering it first when setDecodedSize() requested a reduction. Rows must arrive in order.
+	void		processRow( RowFunc func, const ImageTargetRef &target, int32_t decodedRow, const void *data );
+
 	RowFunc		setupRowFunc( ImageTargetRef target );
 	void		setupRowFuncRgbSource( ImageTargetRef target );
 	void		setupRowFuncGraySource( ImageTargetRef target );
@@ -152,6 +179,8 @@ class ImageSource : public ImageIo {
 	int8_t						mRowFuncTargetRed, mRowFuncTargetGreen, mRowFuncTargetBlue, mRowFuncTargetAlpha;
 	int8_t						mRowFuncSourceGray, mRowFuncTargetGray;
 	int8_t						mRowFuncSourceInc, mRowFuncTargetInc;
+
+	std::shared_ptr<class ImageSourceRowReducer>	mRowReducer;
 };
 
 class ImageTarget : public ImageIo {
@@ -161,24 +190,31 @@ class ImageTarget : public ImageIo {
 	virtual void*	getRowPointer( int32_t row ) = 0;
 	virtual void	setRow( int32_t /*row*/, const void * /*data*/ ) { throw; }
 	virtual void	finalize() { }
+	//! Returns whether getRowPointer() may be called for any row, in any order and from several threads at once, with each row's storage persisting until finalize(). Loaders which support it convert rows straight into such targets from worker threads.
+	virtual bool	supportsParallelRows() const { return false; }
 	
 	class Options {
 	  public:
-		Options() : mQuality( 0.9f ), mColorModelDefault( true ) {}
+		Options() : mQuality( 0.9f ), mColorModelDefault( true ), mNumThreads( 1 ) {}
 		
 		Options& quality( float quality ) { mQuality = quality; return *this; }
 		Options& colorModel( ImageIo::ColorModel cm ) { mColorModelDefault = false; mColorModel = cm; return *this; }
+		/** \brief Allows encoders which support it to compress a single image on up to \a numThreads threads. \c 1, the default, encodes on the calling thread, and \c 0 uses the hardware concurrency.
+			Currently honored by the PNG and Radiance HDR encoders of ImageTargetFileStbImage, which split the image into independently compressed strips. **/
+		Options& numThreads( int numThreads ) { mNumThreads = numThreads; return *this; }
 		
 		void	setColorModelDefault() { mColorModelDefault = true; }
 		
 		float				getQuality() const { return mQuality; }
 		bool				isColorModelDefault() const { return mColorModelDefault; }
 		ImageIo::ColorModel	getColorModel() const { return mColorModel; }
+		int					getNumThreads() const { return mNumThreads; }
 		
 	  protected:
 		float					mQuality;
 		bool					mColorModelDefault;
 		ImageIo::ColorModel		mColorModel;
+		int						mNumThreads;
 	};
 	
   protected:
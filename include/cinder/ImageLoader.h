@@ -0,0 +1,176 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/ImageIo.h"
+#include "cinder/Surface.h"
+#include "cinder/DataSource.h"
+#include "cinder/Filesystem.h"
+#include "cinder/Noncopyable.h"
+#include "cinder/Thread.h"
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class ImageLoader>	ImageLoaderRef;
+
+//! Decodes images into Surfaces on a pool of worker threads, so that loading never stalls the thread that requests it.
+/** Requests are decoded highest priority first, and pending requests can be canceled or reprioritized once they go stale. Completed requests
+	are delivered through a std::future, or queued for the owning thread to collect with update() or popResult(). Destroying the ImageLoader
+	cancels its pending requests and waits for the ones in flight. **/
+class ImageLoader : private Noncopyable {
+  public:
+	typedef uint64_t	RequestId;
+
+	//! The outcome of a request
+	struct Result {
+		Result() : mId( 0 ), mCanceled( false ) {}
+
+		//! Returns whether the image was decoded, in which case \a mSurface holds it
+		bool	isSuccess() const	{ return mSurface != nullptr; }
+
+		RequestId			mId;
+		Surface8uRef		mSurface;
+		//! The exception thrown while loading the image, if any. Rethrow it with std::rethrow_exception() to inspect it.
+		std::exception_ptr	mError;
+		//! Whether the request was canceled before it completed
+		bool				mCanceled;
+	};
+
+	typedef std::function<void( const Result &result )>	Callback;
+
+	//! Options for a single request
+	class Options {
+	  public:
+		Options() : mPriority( 0 ) {}
+
+		//! Requests with a higher \a priority are decoded first, ties in the order they were made. Defaults to \c 0.
+		Options&	priority( int priority )								{ mPriority = priority; return *this; }
+		//! Sets the ImageSource::Options passed to loadImage()
+		Options&	sourceOptions( const ImageSource::Options &options )	{ mSourceOptions = options; return *this; }
+		//! Forces the file type, as with loadImage(). For example "jpg" forces the image to load as a JPEG.
+		Options&	extension( const std::string &extension )				{ mExtension = extension; return *this; }
+		//! Sets a function to call from update() on the owning thread when the request completes, fails or is canceled. Requests without one are delivered through popResult().
+		Options&	callback( const Callback &callback )					{ mCallback = callback; return *this; }
+
+		int							getPriority() const			{ return mPriority; }
+		const ImageSource::Options&	getSourceOptions() const	{ return mSourceOptions; }
+		const std::string&			getExtension() const		{ return mExtension; }
+		const Callback&				getCallback() const			{ return mCallback; }
+
+	  private:
+		int						mPriority;
+		ImageSource::Options	mSourceOptions;
+		std::string				mExtension;
+		Callback				mCallback;
+	};
+
+	//! Options for constructing an ImageLoader
+	class Format {
+	  public:
+		Format() : mNumThreads( 0 ), mMaxPending( 0 ) {}
+
+		//! Sets the number of worker threads. \c 0, the default, uses one less than the hardware concurrency, and at least one.
+		Format&		numThreads( int numThreads )	{ mNumThreads = numThreads; return *this; }
+		//! Bounds the number of requests waiting for a worker. Beyond it, making a request cancels the pending request with the lowest priority, the oldest among equals, which may be the new request itself. \c 0, the default, is unbounded.
+		Format&		maxPending( size_t maxPending )	{ mMaxPending = maxPending; return *this; }
+
+		int			getNumThreads() const	{ return mNumThreads; }
+		size_t		getMaxPending() const	{ return mMaxPending; }
+
+	  private:
+		int			mNumThreads;
+		size_t		mMaxPending;
+	};
+
+	static ImageLoaderRef	create( const Format &format = Format() )	{ return ImageLoaderRef( new ImageLoader( format ) ); }
+	~ImageLoader();
+
+	//! Requests that the image at \a path be decoded. The file is opened on a worker thread. Returns an id for cancel() and setPriority().
+	RequestId	load( const fs::path &path, const Options &options = Options() );
+	//! Requests that the image in \a dataSource be decoded. Returns an id for cancel() and setPriority().
+	RequestId	load( const DataSourceRef &dataSource, const Options &options = Options() );
+	//! Requests that the image at \a path be decoded, returning a future which receives the Surface. The future throws the loading exception on failure, or ImageLoaderExceptionCanceled. Options::callback() is ignored.
+	std::future<Surface8uRef>	loadFuture( const fs::path &path, const Options &options = Options() );
+	//! Requests that the image in \a dataSource be decoded, returning a future which receives the Surface. The future throws the loading exception on failure, or ImageLoaderExceptionCanceled. Options::callback() is ignored.
+	std::future<Surface8uRef>	loadFuture( const DataSourceRef &dataSource, const Options &options = Options() );
+
+	//! Cancels the request \a id if it is still waiting for a worker, and returns whether it did. A request being decoded completes normally.
+	bool		cancel( RequestId id );
+	//! Cancels every request still waiting for a worker
+	void		cancelAll();
+	//! Changes the priority of the request \a id if it is still waiting for a worker, and returns whether it did
+	bool		setPriority( RequestId id, int priority );
+
+	//! Calls the callbacks of the requests completed since the last call, on the calling thread. Returns the number of callbacks called.
+	size_t		update();
+	//! Moves the oldest completed request without a callback into \a result and returns \c true, or returns \c false when there is none
+	bool		popResult( Result *result );
+
+	//! Returns the number of requests waiting for a worker
+	size_t		getNumPending() const;
+	//! Returns the number of requests being decoded
+	size_t		getNumInFlight() const;
+	//! Returns the number of worker threads
+	size_t		getNumThreads() const	{ return mThreads.size(); }
+
+  private:
+	struct Request {
+		RequestId									mId;
+		fs::path									mPath;
+		DataSourceRef								mDataSource;
+		Options										mOptions;
+		std::shared_ptr<std::promise<Surface8uRef>>	mPromise;
+	};
+
+	ImageLoader( const Format &format );
+
+	RequestId	enqueue( Request &&request );
+	void		complete( Request &request, Result &&result );
+	void		workerThread();
+
+	Format								mFormat;
+	std::vector<std::thread>			mThreads;
+	mutable std::mutex					mMutex;
+	std::condition_variable				mWorkAvailable;
+	std::deque<Request>					mPending;
+	std::deque<std::pair<Callback,Result>>	mCallbacks;
+	std::deque<Result>					mResults;
+	RequestId							mNextId;
+	size_t								mNumInFlight;
+	bool								mQuit;
+};
+
+//! Thrown by the futures of ImageLoader::loadFuture() when the request was canceled
+class ImageLoaderExceptionCanceled : public ImageIoException {
+  public:
+	ImageLoaderExceptionCanceled() : ImageIoException( "Image load request canceled." ) {}
+};
+
+} // namespace cinder
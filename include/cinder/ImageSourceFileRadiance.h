@@ -25,14 +25,17 @@
 #include "cinder/Cinder.h"
 #include "cinder/ImageIo.h"
 #include "cinder/Exception.h"
+#include "cinder/Buffer.h"
 
-namespace cinder {
+#include <vector>
 
-class IStreamCinder;
-typedef std::shared_ptr<IStreamCinder>	IStreamRef;
+namespace cinder {
 
 typedef std::shared_ptr<class ImageSourceFileRadiance>	ImageSourceFileRadianceRef;
 
+/** \brief Loads Radiance RGBE (.hdr) files as 32-bit float RGB.
+	The scanline offsets are found when the file is opened, so load() can decode scanlines on up to ImageSource::Options::numThreads() threads. Targets which support
+	it, such as a full size Surface32f, receive floats straight from the RGBE pixels. Scanlines following truncated or corrupt data load as black. **/
 class ImageSourceFileRadiance : public ImageSource {
   public:
 	static ImageSourceRef	create( DataSourceRef dataSourceRef, ImageSource::Options options = ImageSource::Options() );
@@ -44,9 +47,19 @@ class ImageSourceFileRadiance : public ImageSource {
   protected:
 	ImageSourceFileRadiance( DataSourceRef dataSourceRef, ImageSource::Options options );
 	
-	void	loadStream( IStreamRef stream );
+	void	parseHeader();
+	void	findScanlines();
+	//! Decodes scanline \a fileRow into \a rgbe, returning \c false if it wasn't found in the file
+	bool	decodeScanline( int32_t fileRow, uint8_t *rgbe ) const;
 	
-	std::unique_ptr<float[]>		mRgbData;
+	BufferRef					mBuffer;
+	size_t						mDataOffset;
+	int32_t						mScanlineWidth, mNumScanlines;
+	bool						mFlipped;
+	//! The offset of each complete scanline, and the pixel preceding it, which old-style runs at its start repeat
+	std::vector<size_t>			mScanlineOffsets;
+	std::vector<uint32_t>		mScanlineSeeds;
+	int							mNumThreads;
 };
 
 class ImageSourceFileRadianceException : public ImageIoException {
@@ -47,11 +47,14 @@ class ImageSourcePng : public ImageSource {
 
   protected:
 	ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Options options );
-	bool loadHeader();
+	bool loadHeader( const ImageSource::Options &options );
 	
 	std::shared_ptr<ci_png_info>	mCiInfoPtr;
 	png_struct_def					*mPngPtr;
 	png_info						*mInfoPtr;
+	int								mNumPasses;
+	//! Whole factor by which skipping Adam7 passes reduces an interlaced image, otherwise 1
+	int32_t							mPassReduction;
 };
 
 class ImageSourcePngException : public ImageIoException {
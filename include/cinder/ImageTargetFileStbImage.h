@@ -40,8 +40,14 @@ class ImageTargetFileStbImage : public ImageTarget {
 	
   protected:
 	ImageTargetFileStbImage( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string &extensionData );
+
+	//! Writes a PNG whose rows are filtered and deflated in strips on \a mNumThreads threads
+	void	writePngParallel( OStream *stream );
+	//! Writes a Radiance HDR whose scanlines are run-length encoded in strips on \a mNumThreads threads
+	void	writeHdrParallel( OStream *stream );
 	
 	uint8_t						mNumComponents;
+	int							mNumThreads;
 	size_t						mRowBytes;
 	std::string					mExtension;
 	fs::path					mFilePath;
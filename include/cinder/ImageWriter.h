@@ -0,0 +1,133 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/ImageIo.h"
+#include "cinder/Surface.h"
+#include "cinder/DataTarget.h"
+#include "cinder/Filesystem.h"
+#include "cinder/Noncopyable.h"
+#include "cinder/Thread.h"
+
+#include <deque>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class ImageWriter>	ImageWriterRef;
+
+//! Encodes and writes images on a pool of worker threads through a bounded queue, so that saving frames never stalls the thread that captures them.
+/** Surfaces are copied when a write is requested, so the caller may reuse them immediately. Writes complete in the order they were requested when
+	the writer has a single thread, the default. Once the queue is full, new writes are either dropped or wait for room, depending on Format::blockWhenFull().
+	Destroying the ImageWriter waits for every queued write to complete. **/
+class ImageWriter : private Noncopyable {
+  public:
+	//! Options for constructing an ImageWriter
+	class Format {
+	  public:
+		Format() : mNumThreads( 1 ), mMaxPending( 8 ), mBlockWhenFull( false ) {}
+
+		//! Sets the number of worker threads. Defaults to \c 1, which writes images in order. \c 0 uses one less than the hardware concurrency, and at least one.
+		Format&		numThreads( int numThreads )		{ mNumThreads = numThreads; return *this; }
+		//! Bounds the number of writes waiting for a worker. Defaults to \c 8. \c 0 is unbounded, at the cost of memory when encoding can't keep up.
+		Format&		maxPending( size_t maxPending )		{ mMaxPending = maxPending; return *this; }
+		//! Sets whether a write requested while the queue is full waits for room, rather than being dropped. Defaults to \c false, which never blocks the caller.
+		Format&		blockWhenFull( bool block = true )	{ mBlockWhenFull = block; return *this; }
+
+		int			getNumThreads() const		{ return mNumThreads; }
+		size_t		getMaxPending() const		{ return mMaxPending; }
+		bool		isBlockWhenFull() const		{ return mBlockWhenFull; }
+
+	  private:
+		int			mNumThreads;
+		size_t		mMaxPending;
+		bool		mBlockWhenFull;
+	};
+
+	static ImageWriterRef	create( const Format &format = Format() )	{ return ImageWriterRef( new ImageWriter( format ) ); }
+	//! Returns the ImageWriter used by writeImageAsync(), created with the default Format on first use
+	static ImageWriterRef	getDefault();
+	~ImageWriter();
+
+	//! Writes a copy of \a surface to \a path, as writeImage() does. The returned future throws the writing exception on failure, or ImageWriterExceptionDropped.
+	template<typename T>
+	std::future<void>	write( const fs::path &path, const SurfaceT<T> &surface, const ImageTarget::Options &options = ImageTarget::Options(), const std::string &extension = "" )
+	{ return write( path, (ImageSourceRef)SurfaceT<T>( surface ), options, extension ); }
+	//! Writes \a imageSource to \a path, as writeImage() does. \a imageSource is read on a worker thread, so it must not change until the write completes.
+	std::future<void>	write( const fs::path &path, const ImageSourceRef &imageSource, const ImageTarget::Options &options = ImageTarget::Options(), const std::string &extension = "" );
+	//! Writes \a imageSource to \a dataTarget, as writeImage() does. \a imageSource is read on a worker thread, so it must not change until the write completes.
+	std::future<void>	write( const DataTargetRef &dataTarget, const ImageSourceRef &imageSource, const ImageTarget::Options &options = ImageTarget::Options(), const std::string &extension = "" );
+
+	//! Blocks until every write requested so far has completed
+	void		flush();
+
+	//! Returns the number of writes waiting for a worker
+	size_t		getNumPending() const;
+	//! Returns the number of writes being encoded
+	size_t		getNumInFlight() const;
+	//! Returns the number of writes dropped because the queue was full
+	size_t		getNumDropped() const;
+	//! Returns the number of worker threads
+	size_t		getNumThreads() const	{ return mThreads.size(); }
+
+  private:
+	struct Request {
+		fs::path							mPath;
+		DataTargetRef						mDataTarget;
+		ImageSourceRef						mImageSource;
+		ImageTarget::Options				mOptions;
+		std::string							mExtension;
+		std::shared_ptr<std::promise<void>>	mPromise;
+	};
+
+	ImageWriter( const Format &format );
+
+	std::future<void>	enqueue( Request &&request );
+	void				workerThread();
+
+	Format							mFormat;
+	std::vector<std::thread>		mThreads;
+	mutable std::mutex				mMutex;
+	std::condition_variable			mWorkAvailable, mRoomAvailable, mIdle;
+	std::deque<Request>				mPending;
+	size_t							mNumInFlight;
+	size_t							mNumDropped;
+	bool							mQuit;
+};
+
+//! Thrown by the futures of ImageWriter::write() when the write was dropped because the queue was full
+class ImageWriterExceptionDropped : public ImageIoException {
+  public:
+	ImageWriterExceptionDropped() : ImageIoException( "Image write dropped because the queue was full." ) {}
+};
+
+//! Writes a copy of \a surface to \a path on the default ImageWriter's thread, returning immediately. \see ImageWriter
+template<typename T>
+std::future<void>	writeImageAsync( const fs::path &path, const SurfaceT<T> &surface, const ImageTarget::Options &options = ImageTarget::Options(), const std::string &extension = "" )
+{ return ImageWriter::getDefault()->write( path, surface, options, extension ); }
+//! Writes \a imageSource to \a path on the default ImageWriter's thread, returning immediately. \a imageSource must not change until the write completes. \see ImageWriter
+std::future<void>	writeImageAsync( const fs::path &path, const ImageSourceRef &imageSource, const ImageTarget::Options &options = ImageTarget::Options(), const std::string &extension = "" );
+
+} // namespace cinder
@@ -0,0 +1,109 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class PixelAllocator>	PixelAllocatorRef;
+typedef std::shared_ptr<class PixelPool>		PixelPoolRef;
+
+//! Supplies the pixel storage of SurfaceT and ChannelT. Storage is always aligned to PixelAllocator::ALIGNMENT bytes.
+class PixelAllocator {
+  public:
+	virtual ~PixelAllocator() {}
+
+	//! Alignment in bytes of all storage returned by allocate(), suitable for any SIMD load
+	static const size_t ALIGNMENT = 64;
+
+	//! Returns storage of at least \a numBytes aligned to ALIGNMENT. The storage is released back to its allocator when the last reference to the result goes away, which may be after the allocator itself has been destroyed. Throws std::bad_alloc on failure.
+	virtual std::shared_ptr<void>	allocate( size_t numBytes ) = 0;
+
+	//! Returns the allocator used by Surfaces and Channels which aren't given one explicitly. Defaults to getHeap(). Each thread caches the result, so this only locks after a call to set().
+	static PixelAllocatorRef	get();
+	//! Sets the allocator used by Surfaces and Channels which aren't given one explicitly. Passing \c nullptr restores getHeap(). Safe to call from any thread.
+	//! A thread's cached reference keeps the previous allocator alive until that thread next calls get() or exits.
+	static void					set( const PixelAllocatorRef &allocator );
+	//! Returns the allocator which takes aligned storage directly from the heap
+	static PixelAllocatorRef	getHeap();
+
+	//! Returns \a rowBytes rounded up to a multiple of \a alignment, which must be a power of two
+	static ptrdiff_t	alignRowBytes( ptrdiff_t rowBytes, size_t alignment = ALIGNMENT )	{ return ( rowBytes + (ptrdiff_t)alignment - 1 ) & ~( (ptrdiff_t)alignment - 1 ); }
+
+	//! Allocates \a numBytes aligned to ALIGNMENT directly from the heap. Returns \c nullptr on failure.
+	static void*	alignedMalloc( size_t numBytes );
+	//! Frees storage returned by alignedMalloc()
+	static void		alignedFree( void *data );
+};
+
+/** \brief PixelAllocator which recycles storage of identical sizes.
+	Storage released by Surfaces and Channels is kept on a free list and handed out again to the next request of the same size, which removes
+	the steady-state heap traffic of processing a stream of same-sized images. Install it globally with PixelAllocator::set() or pass it to individual
+	Surfaces through SurfaceConstraints::getAllocator(). **/
+class PixelPool : public PixelAllocator {
+  public:
+	//! Creates a pool which keeps at most \a maxFreeBytes of released storage for reuse, freeing anything beyond that
+	static PixelPoolRef		create( size_t maxFreeBytes = 256 * 1024 * 1024 )	{ return PixelPoolRef( new PixelPool( maxFreeBytes ) ); }
+
+	std::shared_ptr<void>	allocate( size_t numBytes ) override;
+
+	//! Frees all storage currently on the free list. Storage still in use is unaffected.
+	void	clear();
+
+	//! Returns the number of bytes currently held on the free list
+	size_t	getNumFreeBytes() const;
+	//! Returns the maximum number of bytes kept on the free list
+	size_t	getMaxFreeBytes() const;
+	//! Sets the maximum number of bytes kept on the free list, freeing storage as necessary
+	void	setMaxFreeBytes( size_t maxFreeBytes );
+
+	//! Returns the number of calls to allocate() which were satisfied from the free list
+	size_t	getNumReused() const;
+	//! Returns the number of calls to allocate() which required a new heap allocation
+	size_t	getNumAllocated() const;
+
+  protected:
+	PixelPool( size_t maxFreeBytes );
+
+	// Outlives the pool as long as storage allocated from it is alive
+	struct State {
+		~State();
+		void	release( void *data, size_t numBytes );
+		void	trim();
+
+		mutable std::mutex						mMutex;
+		std::map<size_t,std::vector<void*>>		mFree;
+		size_t									mFreeBytes, mMaxFreeBytes;
+		size_t									mNumReused, mNumAllocated;
+	};
+
+	std::shared_ptr<State>	mState;
+};
+
+} // namespace cinder
@@ -33,6 +33,7 @@
 #include "cinder/Color.h"
 #include "cinder/Filesystem.h"
 #include "cinder/Exception.h"
+#include "cinder/Filter.h"
 
 #include <boost/logic/tribool.hpp>
 
@@ -94,11 +95,29 @@ class SurfaceConstraints {
 
 	virtual SurfaceChannelOrder getChannelOrder( bool alpha ) const { return ( alpha ) ? SurfaceChannelOrder::RGBA : SurfaceChannelOrder::RGB; }
 	virtual ptrdiff_t			getRowBytes( int32_t requestedWidth, const SurfaceChannelOrder &sco, int elementSize ) const { return requestedWidth * elementSize * sco.getPixelInc(); }
+	//! Returns the allocator the Surface's pixel storage comes from. \c nullptr selects PixelAllocator::get().
+	virtual PixelAllocatorRef	getAllocator() const { return nullptr; }
 };
 
 class SurfaceConstraintsDefault : public SurfaceConstraints {
 };
 
+//! SurfaceConstraints which pad rows to a multiple of \a rowAlignment bytes, so every row starts SIMD-aligned, and optionally draw storage from \a allocator such as a PixelPool
+class SurfaceConstraintsAligned : public SurfaceConstraints {
+  public:
+	SurfaceConstraintsAligned( size_t rowAlignment = PixelAllocator::ALIGNMENT, const PixelAllocatorRef &allocator = nullptr )
+		: mRowAlignment( rowAlignment ), mAllocator( allocator )
+	{}
+
+	ptrdiff_t			getRowBytes( int32_t requestedWidth, const SurfaceChannelOrder &sco, int elementSize ) const override
+	{ return PixelAllocator::alignRowBytes( requestedWidth * elementSize * sco.getPixelInc(), mRowAlignment ); }
+	PixelAllocatorRef	getAllocator() const override { return mAllocator; }
+
+  private:
+	size_t				mRowAlignment;
+	PixelAllocatorRef	mAllocator;
+};
+
 typedef std::shared_ptr<class ImageSource> ImageSourceRef;
 typedef std::shared_ptr<class ImageTarget> ImageTargetRef;
 
@@ -116,6 +135,9 @@ class SurfaceT {
 	SurfaceT( T *data, int32_t width, int32_t height, ptrdiff_t rowBytes, SurfaceChannelOrder channelOrder );
 	//! Constructs a Surface from an \a imageSource and optional \a constraints. Default value for \a alpha chooses one based on the contents of the ImageSource.
 	SurfaceT( ImageSourceRef imageSource, const SurfaceConstraints &constraints = SurfaceConstraintsDefault(), boost::tribool alpha = boost::logic::indeterminate );
+	/** \brief Constructs a Surface of size \a size from \a imageSource, resampled with \a filter. Default value for \a alpha chooses one based on the contents of the ImageSource.
+		Rows are resized as they are decoded, so the full-resolution image is never held in a Surface; only a few rows of it are buffered at once. **/
+	SurfaceT( ImageSourceRef imageSource, const ivec2 &size, const FilterBase &filter = FilterTriangle(), const SurfaceConstraints &constraints = SurfaceConstraintsDefault(), boost::tribool alpha = boost::logic::indeterminate );
 
 	//! Creates a clone of \a rhs. Matches rowBytes and channel order of \a rhs, but creates its own dataStore.
 	SurfaceT( const SurfaceT &rhs );
@@ -138,6 +160,10 @@ class SurfaceT {
 	static std::shared_ptr<SurfaceT<T>>	create( ImageSourceRef imageSource, const SurfaceConstraints &constraints = SurfaceConstraintsDefault(), boost::tribool alpha = boost::logic::indeterminate )
 	{ return std::make_shared<SurfaceT<T>>( imageSource, constraints, alpha ); }
 
+	//! Creates a SurfaceRef of size \a size from an \a imageSource, resampled with \a filter as it is decoded. Default value for \a alpha chooses one based on the contents of the ImageSource.
+	static std::shared_ptr<SurfaceT<T>>	create( ImageSourceRef imageSource, const ivec2 &size, const FilterBase &filter = FilterTriangle(), const SurfaceConstraints &constraints = SurfaceConstraintsDefault(), boost::tribool alpha = boost::logic::indeterminate )
+	{ return std::make_shared<SurfaceT<T>>( imageSource, size, filter, constraints, alpha ); }
+
 	//! Creates s SurfaceRef which is a clone of the Surface \a surface, and with its own dataStore
 	static std::shared_ptr<SurfaceT<T>>	create( const SurfaceT<T> &surface )
 	{ return std::make_shared<SurfaceT<T>>( surface ); }
@@ -247,20 +273,20 @@ class SurfaceT {
 	//! Convenience method for setting a single pixel. For performance-sensitive code consider \ref SurfaceT::Iter "Surface::Iter" instead.
 	void	setPixel( ivec2 pos, const ColorAT<T> &c ) { pos.x = constrain<int32_t>( pos.x, 0, mWidth - 1); pos.y = constrain<int32_t>( pos.y, 0, mHeight - 1 ); T *p = getData( pos ); p[getRedOffset()] = c.r; p[getGreenOffset()] = c.g; p[getBlueOffset()] = c.b; if( hasAlpha() ) p[getAlphaOffset()] = c.a; }
 
-	//! Copies the Area \a srcArea of the Surface \a srcSurface to \a this Surface. The destination Area is \a srcArea offset by \a relativeOffset.
+	//! Copies the Area \a srcArea of the Surface \a srcSurface to \a this Surface. The destination Area is \a srcArea offset by \a relativeOffset. Differing channel orders are converted with ip::convert().
 	void	copyFrom( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &relativeOffset = ivec2() );
 
 	//! Returns an averaged color for the Area defined by \a area
 	ColorT<T>	areaAverage( const Area &area ) const;
   private:
-	void init( ImageSourceRef imageSource, const SurfaceConstraints &constraints = SurfaceConstraintsDefault(), boost::tribool alpha = boost::logic::indeterminate );
+	//! Loads \a imageSource, resampling it to \a size with \a filter when one is supplied
+	void init( ImageSourceRef imageSource, const SurfaceConstraints &constraints = SurfaceConstraintsDefault(), boost::tribool alpha = boost::logic::indeterminate, const ivec2 &size = ivec2( -1 ), const FilterBase *filter = nullptr );
 
 	void	copyRawSameChannelOrder( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &absoluteOffset );
-	void	copyRawRgba( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &absoluteOffset );
-	void 	copyRawRgbFullAlpha( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &absoluteOffset );
-	void	copyRawRgb( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &absoluteOffset );
 
 	void	initChannels();
+	//! Allocates mHeight * mRowBytes bytes of storage from \a allocator, or PixelAllocator::get() when it's \c nullptr
+	void	allocateData( const PixelAllocatorRef &allocator = nullptr );
 
 	int32_t						mWidth, mHeight;
 	ptrdiff_t					mRowBytes;
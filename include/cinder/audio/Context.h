@@ -27,14 +27,19 @@
 #include "cinder/audio/InputNode.h"
 #include "cinder/audio/OutputNode.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <list>
 #include <mutex>
 #include <set>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace cinder { namespace audio {
 
 class DeviceManager;
+class GraphScheduler;
 
 //! \brief Manages the creation, connections, and lifecycle of audio::Node's.
 
@@ -83,6 +88,13 @@ class Context : public std::enable_shared_from_this<Context> {
 	//! Called by \a node when it's connections have changed, default implementation is empty.
 	virtual void connectionsDidChange( const NodeRef &node ) {} 
 
+	//! Sets the number of threads used to process the Node graph, including the audio thread. Independent branches that feed summing Node's are then processed in parallel, with identical results. Default is \c 1, which processes serially on the audio thread. \c 0 uses the hardware concurrency. \see GraphScheduler
+	void			setNumProcessingThreads( size_t numThreads );
+	//! Returns the number of threads used to process the Node graph, including the audio thread.
+	size_t			getNumProcessingThreads() const;
+	//! Returns the GraphScheduler used when processing with more than one thread, or \a null when processing serially.
+	GraphScheduler*	getGraphScheduler() const	{ return mGraphScheduler.get(); }
+
 	//! Returns the samplerate of this Context, which is governed by the current OutputNode.
 	size_t		getSampleRate()				{ return getOutput()->getOutputSampleRate(); }
 	//! Returns the number of frames processed in one block by this Node, which is governed by the current OutputNode.
@@ -105,16 +117,16 @@ class Context : public std::enable_shared_from_this<Context> {
 	virtual void disconnectAllNodes();
 
 	//! Add \a node to the list of auto-pulled nodes, who will have their Node::pullInputs() method called after a OutputDeviceNode implementation finishes pulling its inputs.
-	//! \note Callers on the non-audio thread must synchronize with getMutex().
+	//! \note Must be called on a non-audio thread, the change is published like a connection change. \see ScopedGraphEdit
 	void addAutoPulledNode( const NodeRef &node );
 	//! Remove \a node from the list of auto-pulled nodes.
-	//! \note Callers on the non-audio thread must synchronize with getMutex().
+	//! \note Must be called on a non-audio thread, the change is published like a connection change. \see ScopedGraphEdit
 	void removeAutoPulledNode( const NodeRef &node );
 
 	//! Schedule \a node to be enabled or disabled with with \a func on the audio thread, to be called at \a when seconds measured against getNumProcessedSeconds(). \a node is owned until the scheduled event completes.
 	void schedule( double when, const NodeRef &node, bool enable, const std::function<void ()> &func );
 
-	//! Returns the mutex used to synchronize the audio thread. This is also used internally by the Node class when making connections.
+	//! Returns the mutex used to synchronize the audio thread. This is also used internally by the Node class when a connection changes the format of a Node that is being processed.
 	std::mutex& getMutex() const			{ return mMutex; }
 	//! Returns true if the current thread is the thread used for audio processing, false otherwise.
 	bool isAudioThread() const;
@@ -127,6 +139,21 @@ class Context : public std::enable_shared_from_this<Context> {
 	//! Returns a string representation of the Node graph for debugging purposes.
 	std::string printGraphToString();
 
+	//! \brief RAII-style utility class that groups connection changes made on a non-audio thread into one graph edit.
+	//!
+	//! The audio thread never waits on connection changes: it pulls a copy of each Node's inputs, while changes are written to a second copy
+	//! that is published when the outermost ScopedGraphEdit goes out of scope and swapped to at the start of the next processing block.
+	//! Node's connection methods open one internally, so opening one around several changes makes them take effect in the same block.
+	//! Graph edits from different threads are serialized. Node's that are no longer pulled are released on a background thread once the audio thread has swapped away from them.
+	class ScopedGraphEdit {
+	  public:
+		//! Begins a graph edit on \a context, which may be \a null.
+		ScopedGraphEdit( Context *context );
+		~ScopedGraphEdit();
+	  private:
+		Context*	mContext;
+	};
+
   protected:
 	Context();
 
@@ -146,12 +173,24 @@ class Context : public std::enable_shared_from_this<Context> {
 	void	disconnectRecursive( const NodeRef &node, std::set<NodeRef> &traversedNodes );
 	void	initRecursisve( const NodeRef &node, std::set<NodeRef> &traversedNodes  );
 	void	uninitRecursive( const NodeRef &node, std::set<NodeRef> &traversedNodes  );
-	const	std::vector<Node *>& getAutoPulledNodes(); // called if there are any nodes besides output that need to be pulled
 	void	processAutoPulledNodes();
 	void	preProcessScheduledEvents();
 	void	postProcessScheduledEvents();
 	void	incrementFrameCount();
 
+	void	beginGraphEdit();
+	void	endGraphEdit();
+	// Writes the inputs of node to the copy that will be pulled once the current graph edit is published.
+	void	publishRenderInputs( Node *node );
+	void	writeRenderInputs( Node *node, size_t slot );
+	void	writeRenderAutoPulledNodes( size_t slot );
+	// Brings the slot that the audio thread stopped pulling up to date, releasing any Node's that only it still referenced.
+	void	releaseRetiredNodes( size_t slot );
+	void	retireAsyncImpl();
+	void	destroyRetireThreadImpl();
+	// Returns the index of the copy of the graph being pulled by the audio thread.
+	size_t	getRenderSlot() const	{ return mGraphState.load( std::memory_order_relaxed ) & 1; }
+
 	static void registerClearStatics();
 
 	bool						mEnabled;
@@ -161,16 +200,35 @@ class Context : public std::enable_shared_from_this<Context> {
 
 	// other nodes that don't have any outputs and need to be explictly pulled
 	std::set<NodeRef>		mAutoPulledNodes;
-	std::vector<Node *>		mAutoPullCache;
-	bool					mAutoPullRequired, mAutoPullCacheDirty;
+	std::vector<NodeRef>	mRenderAutoPulledNodes[2];
 	BufferDynamic			mAutoPullBuffer;
 
 	mutable std::mutex		mMutex;
 	std::thread::id			mAudioThreadId;
 
+	// Bit 0 of mGraphState is the slot pulled by the audio thread, bit 1 is set while a graph edit is published but not yet swapped to.
+	std::recursive_mutex	mGraphEditMutex;
+	size_t					mGraphEditDepth;
+	bool					mGraphEditPublish;
+	std::atomic<uint32_t>	mGraphState;
+	// Node's written by the last published edit, whose other slot is brought up to date once the audio thread swaps to it.
+	std::unordered_map<Node *, std::weak_ptr<Node>>	mPublishedNodes;
+	bool					mRenderSlotStale;
+
+	// Woken by the audio thread when it swaps to a published edit, so that the Node's it left are released without waiting for another edit.
+	std::unique_ptr<std::thread>	mRetireThread;
+	std::mutex						mRetireMutex;
+	std::condition_variable			mRetireCond;
+	std::atomic<bool>				mRetireRequested;
+	bool							mRetireShouldQuit;
+
+	std::unique_ptr<GraphScheduler>	mGraphScheduler;
+
 	// - Context is stored in Node classes as a weak_ptr, so it needs to (for now) be created as a shared_ptr
 	static std::shared_ptr<Context>			sMasterContext;
 	static std::unique_ptr<DeviceManager>	sDeviceManager; // TODO: consider turning DeviceManager into a HardwareContext class
+
+	friend class Node;
 };
 
 template<typename NodeT>
@@ -0,0 +1,95 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Context.h"
+#include "cinder/audio/Target.h"
+
+#include <functional>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class OutputOfflineNode>	OutputOfflineNodeRef;
+typedef std::shared_ptr<class ContextOffline>		ContextOfflineRef;
+
+//! \brief OutputNode that is pulled on demand by ContextOffline, rather than by a hardware device.
+//!
+//! You do not directly construct an OutputOfflineNode. Instead, it is created along with its ContextOffline and available from ContextOffline::getOutputOffline().
+//! Clip detection is disabled by default, as there are no speakers to protect and a rendered file should contain what the graph produced.
+class OutputOfflineNode : public OutputNode {
+  public:
+	OutputOfflineNode( size_t sampleRate, size_t framesPerBlock, const Format &format = Format() );
+
+	//! Returns the samplerate this Node was constructed with.
+	size_t getOutputSampleRate() override			{ return mSampleRate; }
+	//! Returns the frames per block this Node was constructed with.
+	size_t getOutputFramesPerBlock() override		{ return mFramesPerBlock; }
+
+	//! Processes one block of the graph on the calling thread, after which the result is available from getInternalBuffer().
+	void renderBlock();
+
+  protected:
+	bool supportsProcessInPlace() const	override	{ return false; }
+
+  private:
+	size_t		mSampleRate, mFramesPerBlock;
+};
+
+//! \brief Context that processes its graph as fast as the CPU allows, on the thread that calls render().
+//!
+//! A ContextOffline has no hardware I/O, so it can render audio faster than realtime, for example to export audio for a video or to run
+//! a graph in a test on a machine without a sound card. Nodes are created with makeNode() and connected to getOutput() as with the master Context.
+//! Rendering is explicit, so render() processes the graph whether or not the Context is enabled. The graph is processed in whole blocks, and frames of
+//! the last block that a call to render() didn't ask for are delivered first by the next call, so consecutive calls produce a continuous signal.
+class ContextOffline : public Context {
+  public:
+	//! Creates a ContextOffline whose output has \a numChannels channels and processes \a framesPerBlock frames at a time at \a sampleRate.
+	static ContextOfflineRef	create( size_t sampleRate = 44100, size_t framesPerBlock = 512, size_t numChannels = 2 );
+
+	//! Throws AudioContextExc, as a ContextOffline has no hardware devices.
+	OutputDeviceNodeRef	createOutputDeviceNode( const DeviceRef &device = Device::getDefaultOutput(), const Node::Format &format = Node::Format() ) override;
+	//! Throws AudioContextExc, as a ContextOffline has no hardware devices.
+	InputDeviceNodeRef	createInputDeviceNode( const DeviceRef &device = Device::getDefaultInput(), const Node::Format &format = Node::Format() ) override;
+
+	//! Sets the output of this Context to \a output, which must be an OutputOfflineNode created by this Context.
+	void setOutput( const OutputNodeRef &output ) override;
+	//! Returns the OutputOfflineNode that render() pulls.
+	const OutputOfflineNodeRef&	getOutputOffline() const	{ return mOutputOffline; }
+
+	//! Processes the next \a numFrames frames of the graph, passing each block to \a blockFn along with the range of its frames that belong to this call.
+	void render( size_t numFrames, const std::function<void ( const Buffer &block, size_t frameOffset, size_t numFrames )> &blockFn );
+	//! Processes the next \a numFrames frames of the graph and streams them to \a target, which must have the output's samplerate and number of channels.
+	void render( size_t numFrames, TargetFile *target );
+	//! Processes the next \a numFrames frames of the graph into \a destination, which is resized to \a numFrames frames and the output's number of channels.
+	void render( size_t numFrames, BufferDynamic *destination );
+
+  protected:
+	ContextOffline() : mBlockFramesConsumed( 0 ) {}
+
+  private:
+	OutputOfflineNodeRef	mOutputOffline;
+	size_t					mBlockFramesConsumed;
+};
+
+} } // namespace cinder::audio
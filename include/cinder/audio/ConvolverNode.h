@@ -0,0 +1,78 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Node.h"
+#include "cinder/audio/Source.h"
+
+#include <memory>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class ConvolverNode>		ConvolverNodeRef;
+
+//! \brief Convolves its input with an impulse response, such as a recorded room for reverb, using partitioned FFT convolution.
+//!
+//! The impulse response is split into partitions that grow in size along its length. The head uses partitions of one processing block,
+//! convolved on the audio thread so there is no latency. Each later stage uses partitions four times longer than the one before (up to
+//! getMaxPartitionSize()) and runs on its own background thread, which has a whole partition's worth of time to finish. Multi-second impulse
+//! responses therefore cost little more per block than short ones.
+//!
+//! Each channel is convolved with the impulse response channel of the same index, wrapping around when the impulse response has fewer channels
+//! (so a mono impulse response is applied to every channel). Without an impulse response the output is silent.
+//! \note If a background stage hasn't finished by the time its output is needed the audio thread waits for it. This keeps the output exact,
+//! which is what ContextOffline relies on, but means that on an overloaded system late tails cause dropouts rather than missing reverb.
+class ConvolverNode : public Node {
+  public:
+	//! Constructs a ConvolverNode without an impulse response, with the assumption one will be set later.
+	ConvolverNode( const Format &format = Format() );
+	//! Constructs a ConvolverNode that convolves with \a impulseResponse.
+	ConvolverNode( const BufferRef &impulseResponse, const Format &format = Format() );
+	virtual ~ConvolverNode();
+
+	//! Sets the impulse response. The partitions are transformed on the calling thread, so it is safe to call while enabled. Tails of the previous impulse response are cut off.
+	void	setImpulseResponse( const BufferRef &impulseResponse );
+	//! Loads the entire contents of \a sourceFile as the impulse response, resampled to the Context's samplerate if needed.
+	void	loadImpulseResponse( const SourceFileRef &sourceFile );
+	//! Returns the current impulse response, or an empty BufferRef if none is set.
+	const BufferRef&	getImpulseResponse() const	{ return mImpulseResponse; }
+
+	//! Returns the largest partition size in frames used by the background stages: the frames per block times the largest power of four that keeps it within 16384, or the frames per block if that is larger.
+	size_t	getMaxPartitionSize() const;
+	//! Returns the number of background threads used by the current impulse response.
+	size_t	getNumTailThreads() const;
+
+  protected:
+	void initialize()				override;
+	void uninitialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	class Engine;
+
+	BufferRef				mImpulseResponse;
+	std::unique_ptr<Engine>	mEngine;
+};
+
+} } // namespace cinder::audio
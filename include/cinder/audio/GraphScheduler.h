@@ -0,0 +1,99 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/Buffer.h"
+#include "cinder/Noncopyable.h"
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class Node>				NodeRef;
+
+//! \brief Processes the independent branches that feed summing Node's on a pool of worker threads.
+//!
+//! A GraphScheduler is owned by a Context when it processes with more than one thread (see Context::setNumProcessingThreads()).
+//! Whenever a graph edit is published, the graph pulled by the Context is compiled into a plan for each summing Node whose inputs head
+//! branches that share no Node's with the rest of the graph. Plans are kept for each copy of the graph, so compiling never blocks the audio thread. During processing those branches are claimed by the worker threads
+//! and the audio thread alike, each pulling into its own buffer. Once all are finished the results are summed on the audio thread
+//! in the same order that serial processing uses, so output is identical regardless of the number of threads.
+//!
+//! Branches are not parallelized if they contain a Node that supports cycles (such as DelayNode), or a Node with an output that
+//! could be pulled at the same time. Node's set as a Param processor are pulled on whichever thread processes the Param's owner, so
+//! they should not be shared between branches.
+class GraphScheduler : private Noncopyable {
+  public:
+	//! Creates a GraphScheduler that processes with \a numThreads threads, including the audio thread.
+	GraphScheduler( size_t numThreads );
+	~GraphScheduler();
+
+	//! Returns the number of threads used for processing, including the audio thread.
+	size_t	getNumThreads() const	{ return mWorkers.size() + 1; }
+	//! Returns true if the calling thread is one of the worker threads.
+	bool	isWorkerThread() const;
+
+	//! Rebuilds the plans for render slot \a slot from the graph pulled by \a output and \a autoPulledNodes. \note Called by the Context while publishing a graph edit, \a slot must not be the one the audio thread is pulling.
+	void	compile( const NodeRef &output, const std::set<NodeRef> &autoPulledNodes, size_t slot );
+	//! Called from Node::sumInputs() on the audio thread. If \a node has a plan in render slot \a slot, pulls its inputs in parallel, sums them into \a summingBuffer and returns true. Otherwise returns false and does nothing.
+	bool	sumInputs( Node *node, Buffer *summingBuffer, size_t slot );
+	//! Destroys the plans for render slot \a slot, releasing the Node's they reference. \note \a slot must not be the one the audio thread is pulling.
+	void	clearPlans( size_t slot );
+
+  private:
+	class Semaphore;
+
+	struct Branch {
+		NodeRef			mInput;
+		bool			mParallel;
+		BufferDynamic	mBuffer;
+	};
+
+	struct Plan {
+		NodeRef					mNode;
+		std::vector<Branch>		mBranches;
+		std::vector<Branch *>	mJobs;
+		std::atomic<size_t>		mNextJob, mJobsRemaining;
+	};
+
+	void	workerLoop();
+	void	runJobs( Plan *plan );
+
+	std::unordered_map<const Node *, std::unique_ptr<Plan>>	mPlans[2];
+
+	std::vector<std::thread>		mWorkers;
+	std::vector<std::thread::id>	mWorkerIds;
+	std::unique_ptr<Semaphore>		mSemaphore;
+	std::unique_ptr<Semaphore>		mCompletionSemaphore;
+	std::atomic<Plan *>				mCurrentPlan;
+	std::atomic<size_t>				mNumActiveWorkers;
+	std::atomic<bool>				mQuit;
+};
+
+} } // namespace cinder::audio
@@ -32,6 +32,7 @@
 #include <memory>
 #include <atomic>
 #include <set>
+#include <vector>
 
 namespace cinder { namespace audio {
 
@@ -48,8 +49,10 @@ typedef std::shared_ptr<class Node>				NodeRef;
 //!
 //! Audio Node's are designed to operate on two different threads: a 'user' thread (i.e. main / UI) and an audio thread. Specifically,
 //! methods for connecting and disconnecting are expected to come from the 'user' thread, while the Node's process() and internal pulling
-//! methods are called from a hard real-time thread. A mutex is used (Context::getMutex()) to synchronize connection changes and pulling
-//! the audio graph. Note that if the Node's initialize() method is heavy, it can be called before connected to anything, so as to not
+//! methods are called from a hard real-time thread. The audio thread pulls a copy of the connections, which connection changes update
+//! without blocking it and which it swaps to at the start of its next processing block. Only connections that change the format of a Node
+//! being processed, such as its channel count, are synchronized with the mutex that the audio thread holds while processing (Context::getMutex()).
+//! Note that if the Node's initialize() method is heavy, it can be called before connected to anything, so as to not
 //! block the audio graph. This must be done throught the Context::initializeNode() interface.
 //!
 //! Subclassing: implement process( Buffer *buffer ) to perform audio processing. A Node does not have access to its owning Context until
@@ -171,6 +174,8 @@ class Node : public std::enable_shared_from_this<Node>, private Noncopyable {
 	const Buffer*	getInternalBuffer() const	{ return &mInternalBuffer; }
 	//! Usually called internally by the Node, in special cases sub-classes may need to call this on other Node's.
 	void			pullInputs( Buffer *inPlaceBuffer );
+	//! Returns the inputs that the audio thread pulls during the current processing block, which may lag behind getInputs() until the next block. \note Only valid on the audio thread.
+	const std::vector<NodeRef>&	getRenderInputs() const;
 
   protected:
 
@@ -194,7 +199,7 @@ class Node : public std::enable_shared_from_this<Node>, private Noncopyable {
 	//! Default implementation returns true, subclasses should return false if they must process out-of-place (summing).
 	virtual bool supportsProcessInPlace() const							{ return true; }
 
-	//! \note Connection methods \must be called on a non-audio thread and synchronized with the Context's mutex.
+	//! \note Connection methods \must be called on a non-audio thread, they are synchronized internally.
 	virtual void connectInput( const NodeRef &input );
 	virtual void disconnectInput( const NodeRef &input );
 	virtual void disconnectOutput( const NodeRef &output );
@@ -225,6 +230,12 @@ class Node : public std::enable_shared_from_this<Node>, private Noncopyable {
 	// The owning Context calls this.
 	void setContext( const ContextRef &context )	{ mContext = context; }
 
+	void configureInput( const NodeRef &input, bool inputChannelsUnequal, bool isDelay );
+	// Returns true if the audio thread may be processing this Node.
+	bool isRendered() const		{ return mNumRenderReferences > 0 || mIsRenderRoot; }
+	// Returns true if connecting input changes the format of a Node that the audio thread may be processing.
+	bool connectionRequiresSync( const NodeRef &input ) const;
+
 	std::weak_ptr<Context>	mContext;
 	std::atomic<bool>		mEnabled;
 	bool					mInitialized;
@@ -242,8 +253,14 @@ class Node : public std::enable_shared_from_this<Node>, private Noncopyable {
 	std::set<std::shared_ptr<Node> >	mInputs;
 	std::vector<std::weak_ptr<Node> >	mOutputs;
 
+	// Copies of mInputs pulled by the audio thread, indexed by Context::getRenderSlot(). Counts how many render copies reference this Node.
+	std::vector<NodeRef>	mRenderInputs[2];
+	std::atomic<int>		mNumRenderReferences;
+	bool					mIsRenderRoot;
+
 	friend class Context;
 	friend class Param;
+	friend class GraphScheduler;
 };
 
 //! Enable connection syntax: `input >> output`, which is equivelant to `input->connect( output )`. Enables chaining.  \return the connected \a output
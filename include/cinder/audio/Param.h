@@ -25,10 +25,10 @@
 
 #include "cinder/audio/Buffer.h"
 
-#include <list>
 #include <atomic>
 #include <functional>
 #include <string>
+#include <vector>
 
 namespace cinder { namespace audio {
 
@@ -40,7 +40,7 @@ typedef std::shared_ptr<class Event>			EventRef;
 //! Ramping function that determines the curvature of a ramp.
 typedef std::function<void ( float *, size_t, double, double, float, float )>	RampFn;
 
-//! Array-based linear ramping function.
+//! Array-based linear ramping function. The built-in ramping functions compute each sample's position on the curve directly and are vectorized where SIMD is available.
 void rampLinear( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd );
 //! Array-based quadradic (t^2) ease-in ramping function.
 void rampInQuad( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd );
@@ -75,6 +75,7 @@ class Event {
 	float				mValueBegin, mValueEnd;
 	std::atomic<bool>	mIsComplete, mIsCanceled;
 	bool				mCopyValueOnBegin;
+	bool				mIsBuiltInRamp; // mRampFn is one of the built-in ramping functions, which can't vary when mValueBegin == mValueEnd
 	std::string			mLabel;
 	RampFn				mRampFn;
 
@@ -158,6 +159,7 @@ class Param {
 
 	//! Evaluates the Param for the current processing block, with current time determined from the parent Node's Context.
 	//! \return true if the Param is varying this block (there are Event's or a processing Node) and getValueArray() should be used, or false if the Param's value is constant for this block (use getValue()).
+	//! A built-in ramp whose begin and end values are equal counts as constant when it covers the whole block.
 	//! \note Safe to call on the audio thread.
 	bool	eval();
 	//! Evaluates the Param from \a timeBegin for \a arrayLength samples at \a sampleRate.
@@ -167,7 +169,7 @@ class Param {
 
 	//! Returns the total duration of any scheduled Event's, including delay, or 0 if none are scheduled.
 	float					findDuration() const;
-	//! Returns the end time and value of the latest scheduled Event, or [0, getValue()] if none are scheduled.
+	//! Returns the end time and value of the scheduled Event that ends last, or [0, getValue()] if none are scheduled.
 	std::pair<double, float> findEndTimeAndValue() const;
 
   protected:
@@ -176,14 +178,18 @@ class Param {
 	void		initInternalBuffer();
 	void		resetImpl();
 	void		removeEventsAt( double time );
+	void		insertEvent( const EventRef &event );
 	ContextRef	getContext() const;
 
-	std::list<EventRef>	mEvents;
-	std::atomic<float>	mValue;
-	bool				mIsVaryingThisBlock;
-	Node*				mParentNode;
-	NodeRef				mProcessor;
-	BufferDynamic		mInternalBuffer;
+	//! Scheduled Events, sorted by begin time.
+	std::vector<EventRef>	mEvents;
+	//! Events removed by eval(). They are released from a non-audio thread and there is always room for all of mEvents, so the audio thread never allocates or frees.
+	std::vector<EventRef>	mRetiredEvents;
+	std::atomic<float>		mValue;
+	bool					mIsVaryingThisBlock;
+	Node*					mParentNode;
+	NodeRef					mProcessor;
+	BufferDynamic			mInternalBuffer;
 };
 
 } } // namespace cinder::audio
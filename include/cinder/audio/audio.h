@@ -26,6 +26,7 @@
 // general
 #include "cinder/audio/Buffer.h"
 #include "cinder/audio/Context.h"
+#include "cinder/audio/ContextOffline.h"
 #include "cinder/audio/Device.h"
 #include "cinder/audio/Exception.h"
 #include "cinder/audio/Param.h"
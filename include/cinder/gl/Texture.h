@@ -42,7 +42,13 @@
   #endif
 #endif
 
-namespace cinder { namespace gl {
+namespace cinder {
+
+namespace ip {
+	template<typename T> class Pyramid;
+}
+
+namespace gl {
 
 typedef class Texture2d							Texture;
 typedef std::shared_ptr<class TextureBase>		TextureBaseRef;
@@ -403,6 +409,14 @@ class TextureData {
 	size_t						mDataStoreSize;
 };
 
+#if ! defined( CINDER_GL_ES_2 )
+/** \brief Fills \a resultData with the levels of \a pyramid as the mip chain of a 2D texture, suitable for Texture2d::create( const TextureData&, const Format& ).
+	Pixels are tightly packed as \c GL_RGB or \c GL_RGBA and rows are flipped as Texture2d does for Surfaces by default. sRGB pyramids of \c uint8_t use the
+	\c GL_SRGB8 internal formats. Supports \c uint8_t, \c float and, outside of OpenGL ES, \c uint16_t. **/
+template<typename T>
+void fillTextureData( const ip::Pyramid<T> &pyramid, TextureData *resultData );
+#endif
+
 #if ! defined( CINDER_GL_ES )
 class Texture1d : public TextureBase {
   public:
@@ -25,13 +25,26 @@
 
 #include "cinder/gl/Texture.h"
 #include "cinder/DataSource.h"
+#include "cinder/DataTarget.h"
+#include "cinder/ip/BlockCompress.h"
+#include "cinder/ip/Pyramid.h"
 
 namespace cinder { namespace gl {
 
 void parseKtx( const DataSourceRef &dataSource, TextureData *resultData );
 #if ! defined( CINDER_GL_ES ) || defined( CINDER_GL_ANGLE )
 void parseDds( const DataSourceRef &dataSource, TextureData *resultData );
+
+/** Block compresses \a surface as \a format into \a resultData, ready for Texture2d::create( const TextureData&, const Format& ) or writeDds().
+	Blocks are stored from the top row down, as in DDS and KTX files. BC4 and BC5 require RGTC support and are unavailable on ANGLE. \see ip::blockCompress() **/
+void compressTextureData( const Surface8u &surface, ip::BlockFormat format, TextureData *resultData, ip::BlockQuality quality = ip::BlockQuality::NORMAL, int numThreads = 1 );
+//! Block compresses every level of \a pyramid as \a format into \a resultData as its mip chain
+void compressTextureData( const ip::Pyramid8u &pyramid, ip::BlockFormat format, TextureData *resultData, ip::BlockQuality quality = ip::BlockQuality::NORMAL, int numThreads = 1 );
+//! Writes the block compressed \a textureData, such as from compressTextureData() or parseDds(), to \a dataTarget as a DDS file. \a textureData must not use a Pbo.
+void writeDds( const TextureData &textureData, const DataTargetRef &dataTarget );
 #endif
+//! Writes the compressed \a textureData, such as from compressTextureData() or parseKtx(), to \a dataTarget as a KTX file. \a textureData must not use a Pbo.
+void writeKtx( const TextureData &textureData, const DataTargetRef &dataTarget );
 
 
 
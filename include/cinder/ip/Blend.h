@@ -28,12 +28,37 @@
 #include "cinder/Vector.h"
 #include "cinder/Surface.h"
 
+#include <vector>
+
 namespace cinder { namespace ip {
 
+//! Composites \a foreground over \a background in \a srcArea, honoring the alpha and premultiplication of both Surfaces.
+/** Premultiplied backgrounds are fastest: the foreground is composited directly, premultiplying it on the fly if it isn't already, without
+	ever unpremultiplying. Unpremultiplied backgrounds with alpha require a division per pixel. **/
 void blend( Surface *background, const Surface &foreground, const Area &srcArea, const ivec2 &dstRelativeOffset = ivec2() );
 inline void blend( Surface *background, const Surface &foreground ) { blend( background, foreground, background->getBounds(), ivec2() ); }
 void blend( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const ivec2 &dstRelativeOffset = ivec2() );
 inline void blend( Surface32f *background, const Surface32f &foreground ) { blend( background, foreground, background->getBounds(), ivec2() ); }
 
+//! A Surface composited by the layered version of blend()
+template<typename T>
+struct BlendLayerT {
+	BlendLayerT( const SurfaceT<T> *surface, const ivec2 &offset = ivec2() ) : mSurface( surface ), mOffset( offset ) {}
+
+	//! The layer's pixels, which must remain valid during blend()
+	const SurfaceT<T>	*mSurface;
+	//! The position of the layer's upper-left corner in the background
+	ivec2				mOffset;
+};
+
+typedef BlendLayerT<uint8_t>	BlendLayer;
+typedef BlendLayerT<uint8_t>	BlendLayer8u;
+typedef BlendLayerT<float>		BlendLayer32f;
+
+//! Composites \a layers over \a background in order. Equivalent to calling blend() for each layer, but makes a single pass over the background's memory. Uses up to \a numThreads threads, 0 for the hardware concurrency.
+void blend( Surface *background, const std::vector<BlendLayer8u> &layers, int numThreads = 1 );
+//! Composites \a layers over \a background in order. Equivalent to calling blend() for each layer, but makes a single pass over the background's memory. Uses up to \a numThreads threads, 0 for the hardware concurrency.
+void blend( Surface32f *background, const std::vector<BlendLayer32f> &layers, int numThreads = 1 );
+
 
 } } // namespace cinder::ip
\ No newline at end of file
@@ -0,0 +1,66 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+namespace cinder { namespace ip {
+
+//! The S3TC / RGTC block compressed formats, which store each 4x4 block of pixels in 8 or 16 bytes
+enum class BlockFormat {
+	//! 8 bytes per block of RGB with optional 1-bit alpha, also known as DXT1
+	BC1,
+	//! 16 bytes per block of RGBA, BC1 color and BC4 alpha, also known as DXT5
+	BC3,
+	//! 8 bytes per block of a single channel, also known as ATI1 or RGTC1
+	BC4,
+	//! 16 bytes per block of two channels, such as the X and Y of normal maps, also known as ATI2 or RGTC2
+	BC5
+};
+
+//! Trades compression speed for quality
+enum class BlockQuality {
+	//! Color endpoints from the bounding box of the block, alpha endpoints from its range
+	FAST,
+	//! Color endpoints from the block's principal axis refined by least squares once, alpha in both 8 and 6-value modes
+	NORMAL,
+	//! As NORMAL, refining repeatedly and searching around the alpha endpoints
+	HIGH
+};
+
+//! Returns the number of bytes occupied by an image of \a size compressed as \a format. Partial blocks at the right and bottom edges are padded.
+size_t	calcBlockCompressedSize( BlockFormat format, const ivec2 &size );
+
+/** Compresses \a surface as \a format into \a dst, which must hold calcBlockCompressedSize() bytes. Blocks are written in rows from the top.
+	BC1 is opaque unless \a surface has alpha, in which case pixels with alpha below 128 become transparent. BC4 compresses the red channel and BC5
+	the red and green channels. Uses up to \a numThreads threads, 0 for the hardware concurrency. **/
+void	blockCompress( const Surface8u &surface, BlockFormat format, uint8_t *dst, BlockQuality quality = BlockQuality::NORMAL, int numThreads = 1 );
+//! Compresses \a channel as BC4 into \a dst, which must hold calcBlockCompressedSize() bytes
+void	blockCompress( const Channel8u &channel, uint8_t *dst, BlockQuality quality = BlockQuality::NORMAL, int numThreads = 1 );
+
+//! Decompresses \a src, an image the size of \a dstSurface compressed as \a format, into \a dstSurface. Channels a format lacks are set to 0, or 255 for alpha.
+void	blockDecompress( const uint8_t *src, BlockFormat format, Surface8u *dstSurface );
+
+} } // namespace cinder::ip
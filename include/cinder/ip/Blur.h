@@ -66,4 +66,51 @@ void		stackBlur( Channel32f *channel, const Area &area, int radius );
 //! Create a blurred copy of \a channel using "stackBlur", a Gaussian-approximating algorithm by Mario Klingemann.
 Channel32f	stackBlurCopy( const Channel32f &channel, int radius );
 
+//! \name Separable blurs
+//! gaussianBlur() and boxBlur() extend the image, or \a area, by repeating its edge pixels. Each splits its rows across up to \a numThreads threads,
+//! 0 for the hardware concurrency, and the result doesn't depend on the thread count.
+//@{
+
+//! Blur \a surface in-place with a Gaussian of standard deviation \a sigma, which may be fractional.
+/** Unlike stackBlur() the result is an exact, separable Gaussian, and its cost grows linearly with \a sigma. **/
+template<typename T>
+void		gaussianBlur( SurfaceT<T> *surface, float sigma, int numThreads = 1 );
+//! Blur \a surface in-place in \a area with a Gaussian of standard deviation \a sigma, which may be fractional.
+template<typename T>
+void		gaussianBlur( SurfaceT<T> *surface, const Area &area, float sigma, int numThreads = 1 );
+//! Create a copy of \a surface blurred with a Gaussian of standard deviation \a sigma, which may be fractional.
+template<typename T>
+SurfaceT<T>	gaussianBlurCopy( const SurfaceT<T> &surface, float sigma, int numThreads = 1 );
+
+//! Blur \a channel in-place with a Gaussian of standard deviation \a sigma, which may be fractional.
+template<typename T>
+void		gaussianBlur( ChannelT<T> *channel, float sigma, int numThreads = 1 );
+//! Blur \a channel in-place in \a area with a Gaussian of standard deviation \a sigma, which may be fractional.
+template<typename T>
+void		gaussianBlur( ChannelT<T> *channel, const Area &area, float sigma, int numThreads = 1 );
+//! Create a copy of \a channel blurred with a Gaussian of standard deviation \a sigma, which may be fractional.
+template<typename T>
+ChannelT<T>	gaussianBlurCopy( const ChannelT<T> &channel, float sigma, int numThreads = 1 );
+
+//! Blur \a surface in-place with a box filter spanning \a radius pixels on each side of the center. A fractional \a radius partially weights the outermost pixels.
+template<typename T>
+void		boxBlur( SurfaceT<T> *surface, float radius, int numThreads = 1 );
+//! Blur \a surface in-place in \a area with a box filter spanning \a radius pixels on each side of the center.
+template<typename T>
+void		boxBlur( SurfaceT<T> *surface, const Area &area, float radius, int numThreads = 1 );
+//! Create a copy of \a surface blurred with a box filter spanning \a radius pixels on each side of the center.
+template<typename T>
+SurfaceT<T>	boxBlurCopy( const SurfaceT<T> &surface, float radius, int numThreads = 1 );
+
+//! Blur \a channel in-place with a box filter spanning \a radius pixels on each side of the center. A fractional \a radius partially weights the outermost pixels.
+template<typename T>
+void		boxBlur( ChannelT<T> *channel, float radius, int numThreads = 1 );
+//! Blur \a channel in-place in \a area with a box filter spanning \a radius pixels on each side of the center.
+template<typename T>
+void		boxBlur( ChannelT<T> *channel, const Area &area, float radius, int numThreads = 1 );
+//! Create a copy of \a channel blurred with a box filter spanning \a radius pixels on each side of the center.
+template<typename T>
+ChannelT<T>	boxBlurCopy( const ChannelT<T> &channel, float radius, int numThreads = 1 );
+//@}
+
 } } // namespace cinder::ip
@@ -0,0 +1,41 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Area.h"
+
+namespace cinder { namespace ip {
+
+//! Converts \a srcArea of \a srcSurface to the channel order and data type of \a dstSurface, writing it at \a dstLT. Uses up to \a numThreads threads, 0 for the hardware concurrency.
+/** Depth changes match CHANTRAIT::convert() exactly. A destination alpha channel receives the source alpha, or the maximum value when the source has none. Destination padding (X) receives the source alpha or padding, or the maximum value for 3-channel sources.
+	The source and destination pixels must not overlap. **/
+template<typename S, typename D>
+void convert( const SurfaceT<S> &srcSurface, const Area &srcArea, SurfaceT<D> *dstSurface, const ivec2 &dstLT, int numThreads = 1 );
+//! Converts all of \a srcSurface to the channel order and data type of \a dstSurface, which takes on the premultiplication of \a srcSurface. Uses up to \a numThreads threads, 0 for the hardware concurrency.
+template<typename S, typename D>
+void convert( const SurfaceT<S> &srcSurface, SurfaceT<D> *dstSurface, int numThreads = 1 );
+
+} } // namespace cinder::ip
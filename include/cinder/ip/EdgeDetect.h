@@ -35,4 +35,20 @@ void edgeDetectSobel( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel );
 template<typename T>
 void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSuface );
 
+//! The 3x3 derivative kernels available to gradients(). Scharr's weights ( 3, 10, 3 ) are more rotationally symmetric than Sobel's ( 1, 2, 1 ).
+enum class GradientKernel { SOBEL, SCHARR };
+
+//! Computes the derivatives of \a srcChannel along x and y, their magnitude and their orientation, all in one pass over \a srcArea.
+/** Any of \a dx, \a dy, \a magnitude and \a orientation may be null and is then skipped. Results for the pixel at \a srcArea's upper-left are written to
+	\a dstOffset in each output, which must be large enough to hold them. Derivatives are unnormalized and follow the image axes, so \a dy is positive where
+	values increase downward; pixels outside \a srcChannel are clamped to its edges. \a orientation is atan2( dy, dx ) in radians in [-pi, pi], approximated to
+	within 1.2e-5. Uses up to \a numThreads threads, 0 for the hardware concurrency. **/
+template<typename T>
+void gradients( const ChannelT<T> &srcChannel, const Area &srcArea, const ivec2 &dstOffset, Channel32f *dx, Channel32f *dy, Channel32f *magnitude, Channel32f *orientation,
+				GradientKernel kernel = GradientKernel::SOBEL, int numThreads = 1 );
+//! Computes the derivatives of \a srcChannel along x and y, their magnitude and their orientation, all in one pass. Outputs may be null. \sa gradients()
+template<typename T>
+void gradients( const ChannelT<T> &srcChannel, Channel32f *dx, Channel32f *dy, Channel32f *magnitude, Channel32f *orientation,
+				GradientKernel kernel = GradientKernel::SOBEL, int numThreads = 1 );
+
 } } // namespace cinder::ip
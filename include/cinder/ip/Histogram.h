@@ -0,0 +1,112 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+#include "cinder/Area.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+//! The minimum, maximum, mean and standard deviation of a set of values, as computed by statistics()
+template<typename T>
+struct StatisticsT {
+	StatisticsT() : mMin( 0 ), mMax( 0 ), mMean( 0 ), mStdDev( 0 ), mCount( 0 ) {}
+
+	T			mMin, mMax;
+	double		mMean;
+	//! The population standard deviation, ie the square root of the mean squared deviation from mMean
+	double		mStdDev;
+	//! The number of values, 0 for an empty Area
+	uint64_t	mCount;
+};
+
+typedef StatisticsT<uint8_t>	Statistics;
+typedef StatisticsT<uint8_t>	Statistics8u;
+typedef StatisticsT<uint16_t>	Statistics16u;
+typedef StatisticsT<float>		Statistics32f;
+
+//! The statistics of each channel of a Surface, as computed by statistics(). \a mAlpha is empty when the Surface has no alpha.
+template<typename T>
+struct SurfaceStatisticsT {
+	StatisticsT<T>	mRed, mGreen, mBlue, mAlpha;
+};
+
+typedef SurfaceStatisticsT<uint8_t>		SurfaceStatistics;
+typedef SurfaceStatisticsT<uint8_t>		SurfaceStatistics8u;
+typedef SurfaceStatisticsT<uint16_t>	SurfaceStatistics16u;
+typedef SurfaceStatisticsT<float>		SurfaceStatistics32f;
+
+//! \name Statistics, histograms and equalization
+//! Each of these functions splits its work across up to \a numThreads threads, or as many as the hardware supports when \a numThreads is 0.
+//@{
+
+//! Returns the statistics of the values of \a channel in \a area.
+template<typename T>
+StatisticsT<T>			statistics( const ChannelT<T> &channel, const Area &area, int numThreads = 1 );
+//! Returns the statistics of the values of \a channel.
+template<typename T>
+StatisticsT<T>			statistics( const ChannelT<T> &channel, int numThreads = 1 );
+//! Returns the statistics of each channel of \a surface in \a area, computed in a single pass over its pixels.
+template<typename T>
+SurfaceStatisticsT<T>	statistics( const SurfaceT<T> &surface, const Area &area, int numThreads = 1 );
+//! Returns the statistics of each channel of \a surface, computed in a single pass over its pixels.
+template<typename T>
+SurfaceStatisticsT<T>	statistics( const SurfaceT<T> &surface, int numThreads = 1 );
+
+//! Returns a histogram of the values of \a channel in \a area, made of \a numBins bins evenly spanning [\a minValue, \a maxValue]. Values outside the range are counted in the first or last bin.
+/** For integer types the range is inclusive of \a maxValue, so an 8-bit Channel with 256 bins over [0, 255] has one bin per value. **/
+template<typename T>
+std::vector<uint32_t>	histogram( const ChannelT<T> &channel, const Area &area, int numBins, float minValue, float maxValue, int numThreads = 1 );
+//! Returns a histogram of the values of \a channel, made of \a numBins bins evenly spanning the range of \a T, [0, 1] for float.
+template<typename T>
+std::vector<uint32_t>	histogram( const ChannelT<T> &channel, int numBins = 256, int numThreads = 1 );
+//! Computes histograms of each channel of \a surface in \a area in a single pass over its pixels, binned as in the Channel version. Any of the outputs may be null.
+template<typename T>
+void					histogram( const SurfaceT<T> &surface, const Area &area, int numBins, float minValue, float maxValue,
+									std::vector<uint32_t> *red, std::vector<uint32_t> *green, std::vector<uint32_t> *blue, std::vector<uint32_t> *alpha = nullptr, int numThreads = 1 );
+
+//! Equalizes the histogram of \a channel in-place, remapping its values so that they spread evenly over the range of \a T.
+/** 8 and 16-bit values are mapped exactly. Float values are clamped to [0, 1] and binned to 12 bits. **/
+template<typename T>
+void	equalizeHistogram( ChannelT<T> *channel, int numThreads = 1 );
+//! Equalizes the histogram of each color channel of \a surface in-place, independently. The alpha channel is left untouched.
+template<typename T>
+void	equalizeHistogram( SurfaceT<T> *surface, int numThreads = 1 );
+
+//! Equalizes \a channel in-place with Contrast Limited Adaptive Histogram Equalization (CLAHE).
+/** The Channel is divided in a grid of \a numTiles tiles which are equalized separately, interpolating bilinearly between the mappings of neighboring tiles.
+	Each tile's histogram is clipped to \a clipLimit times the height of a uniform histogram before equalization, which limits the amplification of noise;
+	a \a clipLimit of 0 disables clipping. 16-bit values and floats, which are clamped to [0, 1], are binned to 12 bits. **/
+template<typename T>
+void	equalizeHistogramClahe( ChannelT<T> *channel, const ivec2 &numTiles = ivec2( 8 ), float clipLimit = 4.0f, int numThreads = 1 );
+//! Equalizes each color channel of \a surface in-place with CLAHE, independently. The alpha channel is left untouched.
+template<typename T>
+void	equalizeHistogramClahe( SurfaceT<T> *surface, const ivec2 &numTiles = ivec2( 8 ), float clipLimit = 4.0f, int numThreads = 1 );
+//@}
+
+} } // namespace cinder::ip
@@ -0,0 +1,134 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Channel.h"
+#include "cinder/Area.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+//! Types used to accumulate the summed-area tables of IntegralImageT
+template<typename T>
+struct IntegralImageTraits {};
+
+//! 8-bit sums are kept in 32 bits and wrap around on very large images. Box sums are still exact as long as the box's own sum fits in 32 bits, since the table is only ever differenced.
+template<>
+struct IntegralImageTraits<uint8_t> {
+	typedef uint32_t	Sum;
+	typedef uint64_t	SquaredSum;
+};
+
+template<>
+struct IntegralImageTraits<uint16_t> {
+	typedef uint64_t	Sum;
+	typedef uint64_t	SquaredSum;
+};
+
+template<>
+struct IntegralImageTraits<float> {
+	typedef double		Sum;
+	typedef double		SquaredSum;
+};
+
+/** \brief Summed-area table of a Channel, which answers the sum of any rectangle of values in constant time.
+	Build it once per image and reuse it for box sums, box blurs, local mean and variance, and adaptive thresholding at any number of window sizes.
+	The table is (width + 1) x (height + 1) values with a leading row and column of zeros, so the sum of the Area (x1, y1, x2, y2) is
+	<tt>S(x2, y2) - S(x1, y2) - S(x2, y1) + S(x1, y1)</tt>. **/
+template<typename T>
+class IntegralImageT {
+  public:
+	typedef typename IntegralImageTraits<T>::Sum			SumT;
+	typedef typename IntegralImageTraits<T>::SquaredSum		SquaredSumT;
+
+	IntegralImageT() : mWidth( 0 ), mHeight( 0 ), mHasSquaredSums( false ) {}
+	//! Builds the summed-area table of \a channel. If \a squaredSums is \c true the table of squared values is built too, which is required by getSquaredSum() and getVariance(). Uses up to \a numThreads threads, 0 for the hardware concurrency.
+	IntegralImageT( const ChannelT<T> &channel, bool squaredSums = false, int numThreads = 1 );
+
+	//! Rebuilds the tables from \a channel, reusing the existing storage when the dimensions are unchanged. Uses up to \a numThreads threads, 0 for the hardware concurrency.
+	void	update( const ChannelT<T> &channel, bool squaredSums = false, int numThreads = 1 );
+
+	//! Returns the width of the source Channel
+	int32_t		getWidth() const { return mWidth; }
+	//! Returns the height of the source Channel
+	int32_t		getHeight() const { return mHeight; }
+	//! Returns the bounds of the source Channel
+	Area		getBounds() const { return Area( 0, 0, mWidth, mHeight ); }
+	//! Returns whether the table of squared values was built
+	bool		hasSquaredSums() const { return mHasSquaredSums; }
+
+	//! Returns the sum of the values in [\a x1, \a x2) x [\a y1, \a y2) without clipping. The coordinates must lie in [0, getWidth()] x [0, getHeight()].
+	SumT		getSum( int32_t x1, int32_t y1, int32_t x2, int32_t y2 ) const
+	{
+		const SumT *row1 = &mSums[y1 * getRowStride()], *row2 = &mSums[y2 * getRowStride()];
+		return row2[x2] - row1[x2] - row2[x1] + row1[x1];
+	}
+	//! Returns the sum of the squared values in [\a x1, \a x2) x [\a y1, \a y2) without clipping. Requires hasSquaredSums().
+	SquaredSumT	getSquaredSum( int32_t x1, int32_t y1, int32_t x2, int32_t y2 ) const
+	{
+		const SquaredSumT *row1 = &mSquaredSums[y1 * getRowStride()], *row2 = &mSquaredSums[y2 * getRowStride()];
+		return row2[x2] - row1[x2] - row2[x1] + row1[x1];
+	}
+
+	//! Returns the sum of the values inside \a area, clipped to getBounds()
+	SumT		getSum( const Area &area ) const;
+	//! Returns the sum of the squared values inside \a area, clipped to getBounds(). Requires hasSquaredSums().
+	SquaredSumT	getSquaredSum( const Area &area ) const;
+	//! Returns the mean of the values inside \a area, clipped to getBounds()
+	double		getMean( const Area &area ) const;
+	//! Returns the variance of the values inside \a area, clipped to getBounds(). Requires hasSquaredSums().
+	double		getVariance( const Area &area ) const;
+
+	//! Returns the number of values between consecutive rows of the tables, which is getWidth() + 1
+	int32_t				getRowStride() const { return mWidth + 1; }
+	//! Returns the summed-area table
+	const SumT*			getData() const { return mSums.data(); }
+	//! Returns the summed-area table of squared values, or \c nullptr when it wasn't built
+	const SquaredSumT*	getSquaredData() const { return mHasSquaredSums ? mSquaredSums.data() : nullptr; }
+
+  private:
+	int32_t						mWidth, mHeight;
+	bool						mHasSquaredSums;
+	std::vector<SumT>			mSums;
+	std::vector<SquaredSumT>	mSquaredSums;
+};
+
+typedef IntegralImageT<uint8_t>		IntegralImage;
+typedef IntegralImageT<uint8_t>		IntegralImage8u;
+typedef IntegralImageT<uint16_t>	IntegralImage16u;
+typedef IntegralImageT<float>		IntegralImage32f;
+
+//! Box blurs the Channel \a integralImage was built from into \a dstChannel, averaging a window of \a windowSize x \a windowSize values centered on each pixel. The window is clipped at the edges.
+template<typename T>
+void boxBlur( const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<T> *dstChannel, int numThreads = 1 );
+//! Stores the mean of the \a windowSize x \a windowSize window centered on each pixel of the Channel \a integralImage was built from into \a dstChannel. The window is clipped at the edges.
+template<typename T>
+void localMean( const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<float> *dstChannel, int numThreads = 1 );
+//! Stores the variance of the \a windowSize x \a windowSize window centered on each pixel of the Channel \a integralImage was built from into \a dstChannel. Requires IntegralImageT::hasSquaredSums().
+template<typename T>
+void localVariance( const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<float> *dstChannel, int numThreads = 1 );
+
+} } // namespace cinder::ip
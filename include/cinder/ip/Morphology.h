@@ -0,0 +1,78 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Channel.h"
+
+namespace cinder { namespace ip {
+
+//! The shape of the neighborhood considered by the morphology operations
+enum class StructuringElement {
+	//! A (2 * radius.x + 1) by (2 * radius.y + 1) rectangle
+	RECT,
+	//! A horizontal line 2 * radius.x + 1 pixels long crossed by a vertical line 2 * radius.y + 1 pixels long
+	CROSS
+};
+
+/** The morphology operations use the van Herk / Gil-Werman algorithm, so their cost does not depend on \a radius. Pixels outside the Channel
+	are ignored, and when \a dstChannel differs in size from \a srcChannel only the area common to both is written. \a dstChannel may be the same
+	as \a srcChannel. Each uses up to \a numThreads threads, 0 for the hardware concurrency. **/
+
+//! Erodes \a srcChannel into \a dstChannel, replacing each value with the minimum of the values under \a element extending \a radius pixels from it.
+template<typename T>
+void erode( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element = StructuringElement::RECT, int numThreads = 1 );
+//! Erodes \a channel in-place, replacing each value with the minimum of the values under \a element extending \a radius pixels from it.
+template<typename T>
+void erode( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element = StructuringElement::RECT, int numThreads = 1 );
+
+//! Dilates \a srcChannel into \a dstChannel, replacing each value with the maximum of the values under \a element extending \a radius pixels from it.
+template<typename T>
+void dilate( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element = StructuringElement::RECT, int numThreads = 1 );
+//! Dilates \a channel in-place, replacing each value with the maximum of the values under \a element extending \a radius pixels from it.
+template<typename T>
+void dilate( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element = StructuringElement::RECT, int numThreads = 1 );
+
+//! Opens \a srcChannel into \a dstChannel, an erosion followed by a dilation, which removes bright features smaller than \a element.
+template<typename T>
+void open( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element = StructuringElement::RECT, int numThreads = 1 );
+//! Opens \a channel in-place, an erosion followed by a dilation, which removes bright features smaller than \a element.
+template<typename T>
+void open( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element = StructuringElement::RECT, int numThreads = 1 );
+
+//! Closes \a srcChannel into \a dstChannel, a dilation followed by an erosion, which fills dark features smaller than \a element.
+template<typename T>
+void close( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element = StructuringElement::RECT, int numThreads = 1 );
+//! Closes \a channel in-place, a dilation followed by an erosion, which fills dark features smaller than \a element.
+template<typename T>
+void close( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element = StructuringElement::RECT, int numThreads = 1 );
+
+//! Writes the morphological gradient of \a srcChannel to \a dstChannel, its dilation minus its erosion, which outlines the edges of features.
+template<typename T>
+void morphologicalGradient( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element = StructuringElement::RECT, int numThreads = 1 );
+//! Replaces \a channel with its morphological gradient, its dilation minus its erosion, which outlines the edges of features.
+template<typename T>
+void morphologicalGradient( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element = StructuringElement::RECT, int numThreads = 1 );
+
+} } // namespace cinder::ip
@@ -0,0 +1,96 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Surface.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+/** \brief A chain of successively half-sized copies of a Surface, such as the mip levels of a texture.
+	Every level is filtered from the previous one in a single pass per level which reads bands of source rows while they are in cache, with the rows of
+	each level spread across threads. Filtering happens in floating point linear light: when Format::srgb() is enabled the color channels are decoded
+	from sRGB before averaging and re-encoded afterwards, which keeps mip levels of sRGB images from darkening. Alpha is always treated as linear. **/
+template<typename T>
+class Pyramid {
+  public:
+	enum class Type {
+		//! Each level averages the 2x2 (or for odd sizes up to 3x3) area of the previous level it covers, down to 1x1. Sizes follow OpenGL's mip chain, halving and rounding down.
+		MIPMAP,
+		//! Each level is the previous level blurred with a 5x5 binomial kernel and decimated by 2, rounding up, as in Burt and Adelson's Gaussian pyramid
+		GAUSSIAN,
+		//! Each level but the last holds the difference between a Gaussian level and its expanded successor; the last holds the smallest Gaussian level. \see reconstruct()
+		LAPLACIAN
+	};
+
+	struct Format {
+		Format() : mType( Type::MIPMAP ), mSrgb( false ), mMaxLevels( 0 ), mNumThreads( 1 ) {}
+
+		//! Sets the kind of pyramid built. Default is Type::MIPMAP.
+		Format&		type( Type type )				{ mType = type; return *this; }
+		//! Sets whether color channels are sRGB encoded and should be filtered in linear light. Default is \c false.
+		Format&		srgb( bool srgb = true )		{ mSrgb = srgb; return *this; }
+		//! Limits the number of levels, including the original. \c 0, the default, continues down to 1x1.
+		Format&		maxLevels( int maxLevels )		{ mMaxLevels = maxLevels; return *this; }
+		//! Sets the number of threads used to filter each level. \c 0 uses the hardware concurrency. Default is \c 1.
+		Format&		numThreads( int numThreads )	{ mNumThreads = numThreads; return *this; }
+
+		Type		getType() const					{ return mType; }
+		bool		isSrgb() const					{ return mSrgb; }
+		int			getMaxLevels() const			{ return mMaxLevels; }
+		int			getNumThreads() const			{ return mNumThreads; }
+
+	  private:
+		Type		mType;
+		bool		mSrgb;
+		int			mMaxLevels, mNumThreads;
+	};
+
+	Pyramid() {}
+	//! Builds a pyramid from \a surface, which is copied to become level 0 (or for Type::LAPLACIAN, the source of its first difference)
+	Pyramid( const SurfaceT<T> &surface, const Format &format = Format() );
+
+	//! Returns the number of levels, including level 0
+	size_t					getNumLevels() const					{ return mLevels.size(); }
+	const SurfaceT<T>&		getLevel( size_t level ) const			{ return mLevels.at( level ); }
+	SurfaceT<T>&			getLevel( size_t level )				{ return mLevels.at( level ); }
+	const std::vector<SurfaceT<T>>&	getLevels() const				{ return mLevels; }
+	const Format&			getFormat() const						{ return mFormat; }
+
+	/** \brief Rebuilds the original image from a Type::LAPLACIAN pyramid by expanding each level and adding the next difference. Returns a copy of level 0 for other types.
+		Floating point differences are stored as is. Integer types store each difference \a d in [-1, 1] of the normalized range as (\a d + 1) / 2, so
+		integer reconstructions are accurate to within one step of the type. Each difference is taken against the level reconstruct() will rebuild from the quantized levels above it, so errors do not accumulate. **/
+	SurfaceT<T>				reconstruct() const;
+
+  private:
+	Format						mFormat;
+	std::vector<SurfaceT<T>>	mLevels;
+};
+
+typedef Pyramid<uint8_t>	Pyramid8u;
+typedef Pyramid<uint16_t>	Pyramid16u;
+typedef Pyramid<float>		Pyramid32f;
+
+} } // namespace cinder::ip
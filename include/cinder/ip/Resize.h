@@ -28,16 +28,47 @@
 
 namespace cinder { namespace ip {
 
+// All resize variants accept a \a numThreads parameter. Values greater than 1 split the destination into bands of rows which are filtered in parallel;
+// 0 uses the hardware concurrency. The result is identical to the single-threaded path.
+
 template<typename T>
-void resize( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter = FilterTriangle() );
+void resize( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter = FilterTriangle(), int numThreads = 1 );
 template<typename T>
-void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter = FilterTriangle() );
+void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter = FilterTriangle(), int numThreads = 1 );
 template<typename T>
-void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter = FilterTriangle() );
+void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter = FilterTriangle(), int numThreads = 1 );
 //! Returns a new Surface which is a copy of \a srcSurface's area \a srcArea scaled to size \a dstSize using filter \a filter
 template<typename T>
-SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &dstSize, const FilterBase &filter = FilterTriangle() );
+SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &dstSize, const FilterBase &filter = FilterTriangle(), int numThreads = 1 );
+template<typename T>
+void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter = FilterTriangle(), int numThreads = 1 );
+
+template<typename T> class ResizeStreamImpl;
+
+/** \brief Resizes an image which arrives one row at a time, such as one still being decoded.
+	Only the few x-filtered source rows spanned by the vertical filter are buffered, so memory is proportional to the destination width rather than to the source image.
+	Rows must be pushed in order from top to bottom, laid out like the rows of the destination Surface. The result matches ip::resize() exactly. **/
 template<typename T>
-void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter = FilterTriangle() );
+class ResizeStream {
+  public:
+	//! Prepares to scale a source image of size \a srcSize into \a dstArea of \a dstSurface using \a filter. \a dstSurface must outlive the ResizeStream.
+	ResizeStream( const ivec2 &srcSize, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter = FilterTriangle() );
+	//! Prepares to scale a source image of size \a srcSize into the entirety of \a dstSurface using \a filter. \a dstSurface must outlive the ResizeStream.
+	ResizeStream( const ivec2 &srcSize, SurfaceT<T> *dstSurface, const FilterBase &filter = FilterTriangle() );
+	~ResizeStream();
+
+	//! Submits the next source row of \c srcSize.x pixels in the destination Surface's channel order. Destination rows are written as soon as their last contributing source row arrives.
+	void		pushRow( const T *row );
+	//! Returns the number of source rows pushed so far
+	int32_t		getNumRowsPushed() const;
+	//! Returns whether every destination row has been written
+	bool		isComplete() const;
+
+  private:
+	ResizeStream( const ResizeStream& ) = delete;
+	ResizeStream& operator=( const ResizeStream& ) = delete;
+
+	std::unique_ptr<ResizeStreamImpl<T>>	mImpl;
+};
 
 } } // namespace cinder::ip
@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
+#include "cinder/ip/IntegralImage.h"
 
 #include <vector>
 
@@ -49,6 +50,9 @@ void adaptiveThreshold( const ChannelT<T> &srcChannel, int32_t windowSize, float
 /** Implements the algorithm described in "Adaptive Thresholding Using the Integral Image" by Bradley & Roth. The srcSurface.getWidth() / 8 is a good default for \a windowSize and 0.15 is for \a percentageDelta **/
 template<typename T>
 void adaptiveThreshold( ChannelT<T> *channel, int32_t windowSize, float percentageDelta );
+//! Adaptively thresholds \a srcChannel like adaptiveThreshold() above, using the prebuilt \a integralImage of \a srcChannel so it can be shared between calls with different window sizes or with other integral image queries. A \a percentageDelta of 0 is equivalent to adaptiveThresholdZero().
+template<typename T>
+void adaptiveThreshold( const IntegralImageT<T> &integralImage, const ChannelT<T> &srcChannel, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel );
 //! Thresholds \a srcChannel using an adaptive thresholding algorithm which considers a window of size \a windowSize pixels. Equivalent to calling adaptiveThreshold with a 0 for percentageDelta
 /** Implements the algorithm described in "Adaptive Thresholding Using the Integral Image" by Bradley & Roth. The srcSurface.getWidth() / 8 is a good default for \a windowSize **/
 template<typename T>
@@ -67,13 +71,11 @@ class AdaptiveThresholdT {
 	void calculate( int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel );
 
  private:
-	typedef typename CHANTRAIT<T>::Accum SUMT;
-
 	const ChannelT<T>*	mChannel;
 	int32_t				mImageWidth;
 	int32_t				mImageHeight;
 	uint8_t				mIncrement;
-	std::vector<SUMT>	mIntegralImage;
+	IntegralImageT<T>	mIntegralImage;
 };
 
 typedef AdaptiveThresholdT<uint8_t>		AdaptiveThreshold;
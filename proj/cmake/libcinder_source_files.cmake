@@ -17,6 +17,7 @@ list( APPEND SRC_SET_CINDER
 	${CINDER_SRC_DIR}/cinder/Channel.cpp
 	${CINDER_SRC_DIR}/cinder/CinderAssert.cpp
 	${CINDER_SRC_DIR}/cinder/CinderMath.cpp
+	${CINDER_SRC_DIR}/cinder/CinderSimd.cpp
 	${CINDER_SRC_DIR}/cinder/Clipboard.cpp
 	${CINDER_SRC_DIR}/cinder/Color.cpp
 	${CINDER_SRC_DIR}/cinder/ConvexHull.cpp
@@ -29,6 +30,8 @@ list( APPEND SRC_SET_CINDER
 	${CINDER_SRC_DIR}/cinder/GeomIo.cpp
 	${CINDER_SRC_DIR}/cinder/ImageFileTinyExr.cpp
 	${CINDER_SRC_DIR}/cinder/ImageIo.cpp
+	${CINDER_SRC_DIR}/cinder/ImageLoader.cpp
+	${CINDER_SRC_DIR}/cinder/ImageWriter.cpp
 	${CINDER_SRC_DIR}/cinder/ImageSourceFileRadiance.cpp
 	${CINDER_SRC_DIR}/cinder/ImageSourceFileStbImage.cpp
 	${CINDER_SRC_DIR}/cinder/ImageTargetFileStbImage.cpp
@@ -38,6 +41,7 @@ list( APPEND SRC_SET_CINDER
 	${CINDER_SRC_DIR}/cinder/ObjLoader.cpp
 	${CINDER_SRC_DIR}/cinder/Path2d.cpp
 	${CINDER_SRC_DIR}/cinder/Perlin.cpp
+	${CINDER_SRC_DIR}/cinder/PixelAllocator.cpp
 	${CINDER_SRC_DIR}/cinder/Plane.cpp
 	${CINDER_SRC_DIR}/cinder/PolyLine.cpp
 	${CINDER_SRC_DIR}/cinder/Rand.cpp
@@ -101,6 +105,9 @@ source_group( "cinder\\app" FILES   ${SRC_SET_CINDER_APP} )
 list( APPEND SRC_SET_CINDER_AUDIO
 	${CINDER_SRC_DIR}/cinder/audio/ChannelRouterNode.cpp
 	${CINDER_SRC_DIR}/cinder/audio/Context.cpp
+	${CINDER_SRC_DIR}/cinder/audio/ContextOffline.cpp
+	${CINDER_SRC_DIR}/cinder/audio/ConvolverNode.cpp
+	${CINDER_SRC_DIR}/cinder/audio/GraphScheduler.cpp
 	${CINDER_SRC_DIR}/cinder/audio/DelayNode.cpp
 	${CINDER_SRC_DIR}/cinder/audio/Device.cpp
 	${CINDER_SRC_DIR}/cinder/audio/FileOggVorbis.cpp
@@ -174,6 +181,7 @@ source_group( "cinder\\gl" FILES    ${SRC_SET_CINDER_GL} )
 
 list( APPEND SRC_SET_CINDER_IP
 	${CINDER_SRC_DIR}/cinder/ip/Blend.cpp
+	${CINDER_SRC_DIR}/cinder/ip/BlockCompress.cpp
 	${CINDER_SRC_DIR}/cinder/ip/Blur.cpp
 	${CINDER_SRC_DIR}/cinder/ip/Checkerboard.cpp
 	${CINDER_SRC_DIR}/cinder/ip/Fill.cpp
@@ -183,7 +191,13 @@ list( APPEND SRC_SET_CINDER_IP
 	${CINDER_SRC_DIR}/cinder/ip/EdgeDetect.cpp
 	${CINDER_SRC_DIR}/cinder/ip/Flip.cpp
 	${CINDER_SRC_DIR}/cinder/ip/Hdr.cpp
+	${CINDER_SRC_DIR}/cinder/ip/Morphology.cpp
+	${CINDER_SRC_DIR}/cinder/ip/Pyramid.cpp
+	${CINDER_SRC_DIR}/cinder/ip/Convert.cpp
+	${CINDER_SRC_DIR}/cinder/ip/Histogram.cpp
 	${CINDER_SRC_DIR}/cinder/ip/Resize.cpp
+	${CINDER_SRC_DIR}/cinder/ip/IntegralImage.cpp
+	${CINDER_SRC_DIR}/cinder/ip/Parallel.cpp
 	${CINDER_SRC_DIR}/cinder/ip/Trim.cpp
 )
 
@@ -117,8 +117,17 @@ ChannelT<T>::ChannelT( int32_t width, int32_t height )
 	mRowBytes = mWidth * sizeof(T);
 	mIncrement = 1;
 	
-	mDataStore = shared_ptr<T>( new T[mWidth * mHeight], std::default_delete<T[]>() );
-	mData = mDataStore.get();
+	allocateData();
+}
+
+template<typename T>
+ChannelT<T>::ChannelT( int32_t width, int32_t height, size_t rowAlignment, const PixelAllocatorRef &allocator )
+	: mWidth( width ), mHeight( height )
+{
+	mRowBytes = PixelAllocator::alignRowBytes( mWidth * sizeof(T), rowAlignment );
+	mIncrement = 1;
+
+	allocateData( allocator );
 }
 
 template<typename T>
@@ -138,8 +147,7 @@ template<typename T>
 ChannelT<T>::ChannelT( const ChannelT &rhs )
 	: mWidth( rhs.mWidth ), mHeight( rhs.mHeight ), mRowBytes( mWidth * sizeof(T) ), mIncrement( 1 )
 {
-	mDataStore = shared_ptr<T>( new T[mWidth * mHeight], std::default_delete<T[]>() );
-	mData = mDataStore.get();
+	allocateData();
 
 	copyFrom( rhs, Area( 0, 0, mWidth, mHeight ) );
 }
@@ -160,13 +168,20 @@ ChannelT<T>::ChannelT( const ImageSourceRef &imageSource )
 	mRowBytes = mWidth * sizeof(T);
 	mIncrement = 1;
 
-	mDataStore = shared_ptr<T>( new T[mHeight * (mRowBytes/sizeof(T))], std::default_delete<T[]>() );
-	mData = mDataStore.get();
+	allocateData();
 	
 	shared_ptr<ImageTargetChannel<T>> target = ImageTargetChannel<T>::createRef( this );
 	imageSource->load( target );
 }
 
+template<typename T>
+void ChannelT<T>::allocateData( const PixelAllocatorRef &allocator )
+{
+	std::shared_ptr<void> block = ( allocator ? allocator : PixelAllocator::get() )->allocate( mHeight * mRowBytes );
+	mDataStore = shared_ptr<T>( block, static_cast<T*>( block.get() ) );
+	mData = mDataStore.get();
+}
+
 template<typename T>
 ChannelT<T>& ChannelT<T>::operator=( const ChannelT &rhs )
 {
@@ -174,8 +189,7 @@ ChannelT<T>& ChannelT<T>::operator=( const ChannelT &rhs )
 	mHeight = rhs.mHeight;
 	mRowBytes = mWidth * sizeof(T);
 	mIncrement = 1;
-	mDataStore = shared_ptr<T>( new T[mHeight * mWidth], std::default_delete<T[]>() );
-	mData = mDataStore.get();
+	allocateData();
 	copyFrom( rhs, Area( 0, 0, mWidth, mHeight ) );
 	
 	return *this;
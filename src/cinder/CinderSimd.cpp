@@ -0,0 +1,69 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/CinderSimd.h"
+#include "cinder/System.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace cinder { namespace simd {
+
+namespace {
+
+std::atomic<int>	sMaxLevel( (int)Level::AVX2 );
+
+Level detectLevel()
+{
+#if defined( CINDER_SIMD_AVX2 )
+	if( System::hasAvx2() )
+		return Level::AVX2;
+#endif
+#if defined( CINDER_SIMD_SSE2 )
+	return Level::SSE2;
+#elif defined( CINDER_SIMD_NEON )
+	return Level::NEON;
+#else
+	return Level::SCALAR;
+#endif
+}
+
+} // anonymous namespace
+
+Level getLevel()
+{
+	static const Level sDetectedLevel = detectLevel();
+	return (Level)std::min( (int)sDetectedLevel, sMaxLevel.load() );
+}
+
+void setMaxLevel( Level level )
+{
+	sMaxLevel = (int)level;
+}
+
+Level getMaxLevel()
+{
+	return (Level)sMaxLevel.load();
+}
+
+} } // namespace cinder::simd
@@ -28,8 +28,113 @@
   #include "cinder/app/android/PlatformAndroid.h"
 #endif
 
+#if defined( CINDER_MSW_DESKTOP )
+	#include <windows.h>
+#elif defined( CINDER_POSIX ) || defined( CINDER_ANDROID )
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
 namespace cinder {
 
+namespace {
+
+// Keeps the mapped Buffer alive for as long as the stream reading from it
+class IStreamMapped : public IStreamMem {
+  public:
+	IStreamMapped( const BufferRef &buffer )
+		: IStreamMem( buffer->getData(), buffer->getSize() ), mBuffer( buffer )
+	{}
+
+  private:
+	BufferRef	mBuffer;
+};
+
+#if defined( CINDER_MSW_DESKTOP )
+BufferRef mapFile( const fs::path &path, DataSourceMapped::AccessHint accessHint )
+{
+	// Windows has no advice for views, but the file's caching flags also steer read-ahead for the page faults of a view of it
+	DWORD flags = FILE_ATTRIBUTE_NORMAL;
+	if( accessHint == DataSourceMapped::ACCESS_SEQUENTIAL || accessHint == DataSourceMapped::ACCESS_WILL_NEED )
+		flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+	else if( accessHint == DataSourceMapped::ACCESS_RANDOM )
+		flags |= FILE_FLAG_RANDOM_ACCESS;
+
+	HANDLE file = ::CreateFileW( path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+		throw StreamExc( "(loadFileMapped) couldn't open: " + path.string() );
+
+	LARGE_INTEGER size;
+	if( ! ::GetFileSizeEx( file, &size ) ) {
+		::CloseHandle( file );
+		throw StreamExc( "(loadFileMapped) couldn't get the size of: " + path.string() );
+	}
+	// empty files can't be mapped
+	if( size.QuadPart == 0 ) {
+		::CloseHandle( file );
+		return std::make_shared<Buffer>();
+	}
+
+	// the view keeps the mapping and the file open once their handles are closed
+	HANDLE mapping = ::CreateFileMappingW( file, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+	::CloseHandle( file );
+	if( ! mapping )
+		throw StreamExc( "(loadFileMapped) couldn't map: " + path.string() );
+	void *data = ::MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+	::CloseHandle( mapping );
+	if( ! data )
+		throw StreamExc( "(loadFileMapped) couldn't map: " + path.string() );
+
+	// Buffer doesn't own the view, so the deleter releases it. It may no longer be the Buffer's data if the Buffer was resized.
+	return BufferRef( new Buffer( data, (size_t)size.QuadPart ), [data]( Buffer *buffer ) {
+		::UnmapViewOfFile( data );
+		delete buffer;
+	} );
+}
+#elif defined( CINDER_POSIX ) || defined( CINDER_ANDROID )
+BufferRef mapFile( const fs::path &path, DataSourceMapped::AccessHint accessHint )
+{
+	int fd = ::open( path.string().c_str(), O_RDONLY );
+	if( fd < 0 )
+		throw StreamExc( "(loadFileMapped) couldn't open: " + path.string() );
+
+	struct stat info;
+	if( ::fstat( fd, &info ) != 0 ) {
+		::close( fd );
+		throw StreamExc( "(loadFileMapped) couldn't get the size of: " + path.string() );
+	}
+	const size_t size = (size_t)info.st_size;
+	// empty files can't be mapped
+	if( size == 0 ) {
+		::close( fd );
+		return std::make_shared<Buffer>();
+	}
+
+	// private and writable, so that writing through Buffer::getData() copies the page rather than faulting or modifying the file
+	void *data = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+	::close( fd );
+	if( data == MAP_FAILED )
+		throw StreamExc( "(loadFileMapped) couldn't map: " + path.string() );
+
+	switch( accessHint ) {
+		case DataSourceMapped::ACCESS_SEQUENTIAL:	::posix_madvise( data, size, POSIX_MADV_SEQUENTIAL ); break;
+		case DataSourceMapped::ACCESS_RANDOM:		::posix_madvise( data, size, POSIX_MADV_RANDOM ); break;
+		case DataSourceMapped::ACCESS_WILL_NEED:	::posix_madvise( data, size, POSIX_MADV_WILLNEED ); break;
+		default: break;
+	}
+
+	// Buffer doesn't own the mapping, so the deleter releases it. It may no longer be the Buffer's data if the Buffer was resized.
+	return BufferRef( new Buffer( data, size ), [data, size]( Buffer *buffer ) {
+		::munmap( data, size );
+		delete buffer;
+	} );
+}
+#endif
+
+} // anonymous namespace
+
 /////////////////////////////////////////////////////////////////////////////
 // DataSource
 void DataSource::setFilePathHint( const fs::path &aFilePathHint )
@@ -136,6 +241,43 @@ DataSourceRef loadFile( const fs::path &path )
 #endif	
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// DataSourceMapped
+DataSourceMappedRef DataSourceMapped::create( const fs::path &path, AccessHint accessHint )
+{
+	return DataSourceMappedRef( new DataSourceMapped( path, accessHint ) );
+}
+
+DataSourceMapped::DataSourceMapped( const fs::path &path, AccessHint accessHint )
+	: DataSourcePath( path ), mAccessHint( accessHint )
+{
+}
+
+void DataSourceMapped::createBuffer()
+{
+#if defined( CINDER_UWP )
+	DataSourcePath::createBuffer();
+#else
+	mBuffer = mapFile( mFilePath, mAccessHint );
+#endif
+}
+
+IStreamRef DataSourceMapped::createStream()
+{
+	IStreamRef stream( new IStreamMapped( getBuffer() ) );
+	stream->setFileName( mFilePath );
+	return stream;
+}
+
+DataSourceRef loadFileMapped( const fs::path &path, DataSourceMapped::AccessHint accessHint )
+{
+#if defined( CINDER_ANDROID )
+	// assets live inside the apk
+	if( ci::app::PlatformAndroid::isAssetPath( path ) )
+		return DataSourceAndroidAsset::create( path );
+#endif
+	return DataSourceMapped::create( path, accessHint );
+}
 
 #if ! defined( CINDER_UWP )
 /////////////////////////////////////////////////////////////////////////////
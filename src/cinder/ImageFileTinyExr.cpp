@@ -22,14 +22,236 @@
 */
 
 #include "cinder/ImageFileTinyExr.h"
-#include "cinder/Log.h"
+#include "cinder/ip/Parallel.h"
 
-#include "tinyexr/tinyexr.h"
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
 
 using namespace std;
 
 namespace cinder {
 
+namespace {
+
+const int32_t	EXR_MAGIC = 20000630;
+const uint32_t	EXR_TILED_FLAG = 0x200;
+const uint32_t	EXR_DEEP_FLAG = 0x800;
+const uint32_t	EXR_MULTIPART_FLAG = 0x1000;
+
+enum { EXR_NO_COMPRESSION = 0, EXR_RLE_COMPRESSION = 1, EXR_ZIPS_COMPRESSION = 2, EXR_ZIP_COMPRESSION = 3 };
+enum { EXR_PIXELTYPE_UINT = 0, EXR_PIXELTYPE_HALF = 1, EXR_PIXELTYPE_FLOAT = 2 };
+enum { EXR_ONE_LEVEL = 0, EXR_MIPMAP_LEVELS = 1, EXR_RIPMAP_LEVELS = 2 };
+
+// ZIP compresses blocks of 16 scanlines, the other supported compressions single scanlines
+const int32_t	EXR_ZIP_SCANLINES = 16;
+
+inline size_t pixelTypeSize( int32_t pixelType )
+{
+	return ( pixelType == EXR_PIXELTYPE_HALF ) ? 2 : 4;
+}
+
+// Returns the number of levels of a mipmap over \a size, which the file rounds either up or down
+int32_t calcNumLevels( int32_t size, bool roundUp )
+{
+	int32_t log2 = 0;
+	while( ( size >> ( log2 + 1 ) ) > 0 )
+		++log2;
+	if( roundUp && size > ( 1 << log2 ) )
+		++log2;
+	return log2 + 1;
+}
+
+int32_t calcLevelSize( int32_t size, int32_t level, bool roundUp )
+{
+	const int32_t result = roundUp ? ( ( size + ( 1 << level ) - 1 ) >> level ) : ( size >> level );
+	return std::max<int32_t>( 1, result );
+}
+
+// ZIP and RLE compress the bytes of a chunk split into two interleaved halves and delta encoded, which brings the similar high bytes of neighboring samples together
+void splitAndPredict( const uint8_t *src, size_t size, uint8_t *dst )
+{
+	uint8_t *t1 = dst, *t2 = dst + ( size + 1 ) / 2;
+	for( size_t i = 0; i < size; i += 2 ) {
+		*t1++ = src[i];
+		if( i + 1 < size )
+			*t2++ = src[i + 1];
+	}
+
+	int p = dst[0];
+	for( size_t i = 1; i < size; ++i ) {
+		int d = int( dst[i] ) - p + ( 128 + 256 );
+		p = dst[i];
+		dst[i] = (uint8_t)d;
+	}
+}
+
+// Inverse of splitAndPredict(). Modifies \a src.
+void unpredictAndInterleave( uint8_t *src, size_t size, uint8_t *dst )
+{
+	for( size_t i = 1; i < size; ++i )
+		src[i] = (uint8_t)( int( src[i - 1] ) + int( src[i] ) - 128 );
+
+	const uint8_t *t1 = src, *t2 = src + ( size + 1 ) / 2;
+	for( size_t i = 0; i < size; i += 2 ) {
+		dst[i] = *t1++;
+		if( i + 1 < size )
+			dst[i + 1] = *t2++;
+	}
+}
+
+bool rleDecompress( const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstSize )
+{
+	const uint8_t *srcEnd = src + srcSize;
+	uint8_t *dstEnd = dst + dstSize;
+	while( src < srcEnd ) {
+		const int count = (int8_t)*src++;
+		if( count < 0 ) { // a run of -count literal bytes
+			if( srcEnd - src < -count || dstEnd - dst < -count )
+				return false;
+			memcpy( dst, src, -count );
+			src += -count;
+			dst += -count;
+		}
+		else { // a byte repeated count + 1 times
+			if( src == srcEnd || dstEnd - dst < count + 1 )
+				return false;
+			memset( dst, *src++, count + 1 );
+			dst += count + 1;
+		}
+	}
+	return dst == dstEnd;
+}
+
+// Decompresses one chunk of \a dstSize bytes. \a scratch is reused between calls.
+bool decompressChunk( int32_t compression, const uint8_t *src, size_t srcSize, uint8_t *dst, size_t dstSize, vector<uint8_t> *scratch )
+{
+	// chunks which compression would have made larger are stored as is
+	if( compression == EXR_NO_COMPRESSION || srcSize == dstSize ) {
+		if( srcSize != dstSize )
+			return false;
+		memcpy( dst, src, dstSize );
+		return true;
+	}
+
+	scratch->resize( dstSize );
+	if( compression == EXR_RLE_COMPRESSION ) {
+		if( ! rleDecompress( src, srcSize, scratch->data(), dstSize ) )
+			return false;
+	}
+	else {
+		uLongf length = (uLongf)dstSize;
+		if( uncompress( scratch->data(), &length, src, (uLong)srcSize ) != Z_OK || length != dstSize )
+			return false;
+	}
+
+	unpredictAndInterleave( scratch->data(), dstSize, dst );
+	return true;
+}
+
+uint64_t decodeLittle64( const uint8_t *src )
+{
+	uint64_t result = 0;
+	for( int b = 7; b >= 0; --b )
+		result = ( result << 8 ) | src[b];
+	return result;
+}
+
+void encodeLittle64( uint64_t value, uint8_t *dst )
+{
+	for( int b = 0; b < 8; ++b )
+		dst[b] = (uint8_t)( value >> ( 8 * b ) );
+}
+
+// Reads the little endian fields of an attribute's value
+class AttributeReader {
+  public:
+	AttributeReader( const vector<uint8_t> &data )
+		: mData( data ), mPos( 0 )
+	{}
+
+	template<typename T>
+	T read()
+	{
+		if( mPos + sizeof( T ) > mData.size() )
+			throw ImageIoExceptionFailedLoadTinyExr( "OpenEXR attribute is truncated" );
+		T result;
+		memcpy( &result, &mData[mPos], sizeof( T ) );
+		mPos += sizeof( T );
+		return result;
+	}
+
+	string readString()
+	{
+		string result;
+		while( char c = read<char>() )
+			result += c;
+		return result;
+	}
+
+  private:
+	const vector<uint8_t>	&mData;
+	size_t					mPos;
+};
+
+string readNullTerminated( const IStreamRef &stream )
+{
+	string result;
+	char c;
+	while( ( stream->read( &c ), c != 0 ) ) {
+		result += c;
+		if( result.size() > 255 )
+			throw ImageIoExceptionFailedLoadTinyExr( "OpenEXR header is malformed" );
+	}
+	return result;
+}
+
+struct ExrChannel {
+	string		mName;
+	int32_t		mPixelType;
+};
+
+// A chunk read from the file and decompressed, covering a tile, or one or more scanlines of the full width
+struct ExrChunk {
+	Area			mBounds;
+	vector<uint8_t>	mPacked, mPixels;
+};
+
+} // anonymous namespace
+
+// Everything about the file's structure that load() needs
+struct ExrFileLayout {
+	struct Level {
+		int32_t		mWidth, mHeight;
+		int32_t		mNumTilesX, mNumTilesY;
+		//! The index of the level's first chunk in \a mChunkOffsets
+		size_t		mFirstChunk;
+		int32_t		mLevelX, mLevelY;
+	};
+
+	//! Returns the number of bytes of one line of \a width pixels of every channel
+	size_t		calcLineBytes( int32_t width ) const
+	{
+		size_t result = 0;
+		for( const auto &channel : mChannels )
+			result += width * pixelTypeSize( channel.mPixelType );
+		return result;
+	}
+
+	vector<ExrChannel>	mChannels;
+	int32_t				mCompression;
+	Area				mDataWindow;
+	bool				mTiled;
+	//! Scanline files are treated as tiles of the full width and the compression's scanlines per chunk
+	int32_t				mTileWidth, mTileHeight;
+	int32_t				mLevelMode;
+	bool				mRoundUp;
+	//! Scanline files have a single level. Ripmapped files list every combination of horizontal and vertical level, but only those with equal reductions are exposed.
+	vector<Level>		mLevels;
+	vector<size_t>		mPublicLevels;
+	vector<uint64_t>	mChunkOffsets;
+};
+
 // ----------------------------------------------------------------------------------------------------
 // ImageSourceFileTinyExr
 // ----------------------------------------------------------------------------------------------------
@@ -45,120 +267,303 @@ void ImageSourceFileTinyExr::registerSelf()
 	ImageIoRegistrar::registerSourceType( "exr", sourceFunc, 1 ); // lower is higher priority
 }
 
-ImageSourceFileTinyExr::ImageSourceFileTinyExr( DataSourceRef dataSource, ImageSource::Options /*options*/ )
+ImageSourceFileTinyExr::ImageSourceFileTinyExr( DataSourceRef dataSource, ImageSource::Options options )
+	: mLayout( new ExrFileLayout ), mNumThreads( options.getNumThreads() ), mLevel( 0 )
 {
-	mExrImage.reset( new EXRImage );
-	const char *error;
-
-	InitEXRImage( mExrImage.get() );
-
-	int status = 0;
-	if( dataSource->isFilePath() ) {
-		status = ParseMultiChannelEXRHeaderFromFile( mExrImage.get(), dataSource->getFilePath().string().c_str(), &error );
-		if( status != 0 )
-			throw ImageIoExceptionFailedLoadTinyExr( string( "Failed to parse OpenEXR header; Error message: " ) + error );
-		status = LoadMultiChannelEXRFromFile( mExrImage.get(), dataSource->getFilePath().string().c_str(), &error );
-		if( status != 0 )
-			throw ImageIoExceptionFailedLoadTinyExr( string( "Failed to parse OpenEXR file; Error message: " ) + error );
+	// chunks are read as they are needed, so the file is never held in memory whole
+	mStream = dataSource->createStream();
+	if( ! mStream )
+		throw ImageIoExceptionFailedLoadTinyExr( "Failed to open OpenEXR file" );
+
+	int32_t magic;
+	uint32_t version;
+	mStream->readLittle( &magic );
+	mStream->readLittle( &version );
+	if( magic != EXR_MAGIC )
+		throw ImageIoExceptionFailedLoadTinyExr( "Not an OpenEXR file" );
+	if( ( version & 0xFF ) != 2 || ( version & ( EXR_DEEP_FLAG | EXR_MULTIPART_FLAG ) ) )
+		throw ImageIoExceptionFailedLoadTinyExr( "Unsupported OpenEXR version; deep and multi-part files are not supported" );
+
+	ExrFileLayout &layout = *mLayout;
+	layout.mTiled = ( version & EXR_TILED_FLAG ) != 0;
+	layout.mCompression = -1;
+	layout.mLevelMode = EXR_ONE_LEVEL;
+	layout.mRoundUp = false;
+	bool hasDataWindow = false, hasTiles = false;
+
+	while( true ) {
+		const string name = readNullTerminated( mStream );
+		if( name.empty() )
+			break;
+		const string type = readNullTerminated( mStream );
+		int32_t size;
+		mStream->readLittle( &size );
+		if( size < 0 || size > mStream->size() - mStream->tell() )
+			throw ImageIoExceptionFailedLoadTinyExr( "OpenEXR header is malformed" );
+		vector<uint8_t> data( size );
+		mStream->readData( data.data(), size );
+		AttributeReader reader( data );
+
+		if( name == "channels" && type == "chlist" ) {
+			while( true ) {
+				ExrChannel channel;
+				channel.mName = reader.readString();
+				if( channel.mName.empty() )
+					break;
+				channel.mPixelType = reader.read<int32_t>();
+				reader.read<uint32_t>(); // pLinear and reserved
+				const int32_t xSampling = reader.read<int32_t>(), ySampling = reader.read<int32_t>();
+				if( xSampling != 1 || ySampling != 1 )
+					throw ImageIoExceptionFailedLoadTinyExr( "Subsampled OpenEXR channels are not supported" );
+				if( channel.mPixelType < EXR_PIXELTYPE_UINT || channel.mPixelType > EXR_PIXELTYPE_FLOAT )
+					throw ImageIoExceptionFailedLoadTinyExr( "Unknown OpenEXR pixel type" );
+				layout.mChannels.push_back( channel );
+			}
+		}
+		else if( name == "compression" ) {
+			layout.mCompression = reader.read<uint8_t>();
+		}
+		else if( name == "dataWindow" ) {
+			const int32_t x1 = reader.read<int32_t>(), y1 = reader.read<int32_t>(), x2 = reader.read<int32_t>(), y2 = reader.read<int32_t>();
+			layout.mDataWindow = Area( x1, y1, x2 + 1, y2 + 1 ); // inclusive in the file
+			hasDataWindow = true;
+		}
+		else if( name == "tiles" && type == "tiledesc" ) {
+			layout.mTileWidth = (int32_t)reader.read<uint32_t>();
+			layout.mTileHeight = (int32_t)reader.read<uint32_t>();
+			const uint8_t mode = reader.read<uint8_t>();
+			layout.mLevelMode = mode & 0x0F;
+			layout.mRoundUp = ( mode >> 4 ) != 0;
+			hasTiles = true;
+		}
+		else if( name == "pixelAspectRatio" && type == "float" ) {
+			setPixelAspectRatio( reader.read<float>() );
+		}
 	}
-	else {
-		BufferRef buffer = dataSource->getBuffer();
-		
-		status = ParseMultiChannelEXRHeaderFromMemory( mExrImage.get(), (const unsigned char*)buffer->getData(), &error );
-		if( status != 0 )
-			throw ImageIoExceptionFailedLoadTinyExr( string( "Failed to parse OpenEXR header; Error message: " ) + error );
-		status = LoadMultiChannelEXRFromMemory( mExrImage.get(), (const unsigned char*)buffer->getData(), &error );
-		if( status != 0 )
-			throw ImageIoExceptionFailedLoadTinyExr( string( "Failed to parse OpenEXR file; Error message: " ) + error );
+
+	if( layout.mCompression < EXR_NO_COMPRESSION || layout.mCompression > EXR_ZIP_COMPRESSION )
+		throw ImageIoExceptionFailedLoadTinyExr( "Unsupported OpenEXR compression; only NONE, RLE, ZIPS and ZIP are supported" );
+	if( ! hasDataWindow || layout.mDataWindow.getWidth() <= 0 || layout.mDataWindow.getHeight() <= 0 || layout.mChannels.empty() )
+		throw ImageIoExceptionFailedLoadTinyExr( "OpenEXR header is missing required attributes" );
+	if( layout.mTiled && ( ! hasTiles || layout.mTileWidth <= 0 || layout.mTileHeight <= 0 || layout.mLevelMode > EXR_RIPMAP_LEVELS ) )
+		throw ImageIoExceptionFailedLoadTinyExr( "OpenEXR tile description is missing or invalid" );
+
+	// lay out the levels and their chunks, in the order of the offset table
+	const int32_t width = layout.mDataWindow.getWidth(), height = layout.mDataWindow.getHeight();
+	if( ! layout.mTiled ) {
+		layout.mTileWidth = width;
+		layout.mTileHeight = ( layout.mCompression == EXR_ZIP_COMPRESSION ) ? EXR_ZIP_SCANLINES : 1;
+		layout.mLevelMode = EXR_ONE_LEVEL;
 	}
+	int32_t numLevelsX = 1, numLevelsY = 1;
+	if( layout.mLevelMode == EXR_MIPMAP_LEVELS )
+		numLevelsX = numLevelsY = calcNumLevels( std::max( width, height ), layout.mRoundUp );
+	else if( layout.mLevelMode == EXR_RIPMAP_LEVELS ) {
+		numLevelsX = calcNumLevels( width, layout.mRoundUp );
+		numLevelsY = calcNumLevels( height, layout.mRoundUp );
+	}
+
+	size_t numChunks = 0;
+	for( int32_t ly = 0; ly < numLevelsY; ++ly ) {
+		for( int32_t lx = 0; lx < numLevelsX; ++lx ) {
+			if( layout.mLevelMode == EXR_MIPMAP_LEVELS && lx != ly )
+				continue;
+			ExrFileLayout::Level level;
+			level.mLevelX = lx;
+			level.mLevelY = ly;
+			level.mWidth = calcLevelSize( width, lx, layout.mRoundUp );
+			level.mHeight = calcLevelSize( height, ly, layout.mRoundUp );
+			level.mNumTilesX = ( level.mWidth + layout.mTileWidth - 1 ) / layout.mTileWidth;
+			level.mNumTilesY = ( level.mHeight + layout.mTileHeight - 1 ) / layout.mTileHeight;
+			level.mFirstChunk = numChunks;
+			numChunks += level.mNumTilesX * level.mNumTilesY;
+			if( lx == ly )
+				layout.mPublicLevels.push_back( layout.mLevels.size() );
+			layout.mLevels.push_back( level );
+		}
+	}
+
+	if( (off_t)( numChunks * 8 ) > mStream->size() - mStream->tell() )
+		throw ImageIoExceptionFailedLoadTinyExr( "OpenEXR offset table is truncated" );
+	vector<uint8_t> offsetTable( numChunks * 8 );
+	mStream->readData( offsetTable.data(), offsetTable.size() );
+	layout.mChunkOffsets.resize( numChunks );
+	for( size_t c = 0; c < numChunks; ++c )
+		layout.mChunkOffsets[c] = decodeLittle64( &offsetTable[c * 8] );
+
+	// locate the channels to load; others are ignored
+	auto findChannel = [&]( const char *name ) -> int {
+		for( size_t c = 0; c < layout.mChannels.size(); ++c ) {
+			if( layout.mChannels[c].mName == name )
+				return (int)c;
+		}
+		return -1;
+	};
+	const int red = findChannel( "R" ), green = findChannel( "G" ), blue = findChannel( "B" ), alpha = findChannel( "A" ), luminance = findChannel( "Y" );
+	if( red >= 0 && green >= 0 && blue >= 0 ) {
+		setColorModel( ImageIo::CM_RGB );
+		setChannelOrder( ( alpha >= 0 ) ? ImageIo::ChannelOrder::RGBA : ImageIo::ChannelOrder::RGB );
+		mChannelIndices = { (size_t)red, (size_t)green, (size_t)blue };
+	}
+	else if( luminance >= 0 ) {
+		setColorModel( ImageIo::CM_GRAY );
+		setChannelOrder( ( alpha >= 0 ) ? ImageIo::ChannelOrder::YA : ImageIo::ChannelOrder::Y );
+		mChannelIndices = { (size_t)luminance };
+	}
+	else
+		throw ImageIoExceptionFailedLoadTinyExr( "Unable to locate channels for RGB or Y" );
+	if( alpha >= 0 )
+		mChannelIndices.push_back( (size_t)alpha );
 
 	// verify that the channels are all the same size; currently we don't support variably sized channels
-	int pixelType = mExrImage->pixel_types[0];
-	for( int c = 1; c < mExrImage->num_channels; ++c ) {
-		if( pixelType != mExrImage->pixel_types[c] )
+	const int32_t pixelType = layout.mChannels[mChannelIndices[0]].mPixelType;
+	for( size_t c : mChannelIndices ) {
+		if( layout.mChannels[c].mPixelType != pixelType )
 			throw ImageIoExceptionFailedLoadTinyExr( "TinyExr: heterogneous channel data types not supported" );
 	}
 
 	switch( pixelType ) {
-		case TINYEXR_PIXELTYPE_HALF:
+		case EXR_PIXELTYPE_HALF:
 			setDataType( ImageIo::FLOAT16 );
 		break;
-		case TINYEXR_PIXELTYPE_FLOAT:
+		case EXR_PIXELTYPE_FLOAT:
 			setDataType( ImageIo::FLOAT32 );
 		break;
 		default:
-			throw ImageIoExceptionFailedLoadTinyExr( "TinyExr: Unknown data type" );
+			throw ImageIoExceptionFailedLoadTinyExr( "TinyExr: Unsupported data type" );
 		break;
 	}
 
-	setSize( mExrImage->width, mExrImage->height );
+	// prefer a mip level to reduce, then box filter the rest of the way
+	const int32_t factor = options.calcReductionFactor( ivec2( width, height ) );
+	while( mLevel + 1 < getNumLevels() && ( 2 << mLevel ) <= factor )
+		++mLevel;
+	mArea = Area( ivec2( 0 ), getLevelSize( mLevel ) );
+	setDecodedSize( mArea.getSize(), std::max<int32_t>( 1, factor >> mLevel ) );
+}
 
-	switch( mExrImage->num_channels ) {
-		case 3:
-			setColorModel( ImageIo::CM_RGB );
-			setChannelOrder( ImageIo::ChannelOrder::RGB );
-		break;
-		case 4:
-			setColorModel( ImageIo::CM_RGB );
-			setChannelOrder( ImageIo::ChannelOrder::RGBA );
-		break;
-		default:
-			throw ImageIoExceptionFailedLoadTinyExr( "TinyExr: Unsupported number of channels (" + to_string( mExrImage->num_channels ) + ")" );
-	}
+ImageSourceFileTinyExr::~ImageSourceFileTinyExr()
+{
+}
+
+bool ImageSourceFileTinyExr::isTiled() const
+{
+	return mLayout->mTiled;
+}
+
+int ImageSourceFileTinyExr::getNumLevels() const
+{
+	return (int)mLayout->mPublicLevels.size();
+}
+
+ivec2 ImageSourceFileTinyExr::getLevelSize( int level ) const
+{
+	const ExrFileLayout::Level &l = mLayout->mLevels.at( mLayout->mPublicLevels.at( level ) );
+	return ivec2( l.mWidth, l.mHeight );
+}
+
+void ImageSourceFileTinyExr::setRegion( const Area &area, int level )
+{
+	if( level < 0 || level >= getNumLevels() )
+		throw ImageIoExceptionFailedLoadTinyExr( "OpenEXR level " + to_string( level ) + " does not exist" );
+
+	mLevel = level;
+	mArea = area.getClipBy( Area( ivec2( 0 ), getLevelSize( level ) ) );
+	setDecodedSize( ivec2( std::max( 0, mArea.getWidth() ), std::max( 0, mArea.getHeight() ) ), 1 );
 }
 
 void ImageSourceFileTinyExr::load( ImageTargetRef target )
 {
 	ImageSource::RowFunc rowFunc = setupRowFunc( target );
+	if( mArea.getWidth() <= 0 || mArea.getHeight() <= 0 )
+		return;
 
-	const size_t numChannels = mExrImage->num_channels;
-	const void *red = nullptr, *green = nullptr, *blue = nullptr, *alpha = nullptr;
-	
-	for( size_t c = 0; c < numChannels; ++c ) {
-		if( strcmp( mExrImage->channel_names[c], "R" ) == 0 )
-			red = mExrImage->images[c];
-		else if( strcmp( mExrImage->channel_names[c], "G" ) == 0 )
-			green = mExrImage->images[c];
-		else if( strcmp( mExrImage->channel_names[c], "B" ) == 0 )
-			blue = mExrImage->images[c];
-		else if( strcmp( mExrImage->channel_names[c], "A" ) == 0 )
-			alpha = mExrImage->images[c];
+	const ExrFileLayout &layout = *mLayout;
+	const ExrFileLayout::Level &level = layout.mLevels[layout.mPublicLevels[mLevel]];
+	const int numThreads = ip::getNumThreads( mNumThreads );
+	const size_t sampleBytes = pixelTypeSize( layout.mChannels[mChannelIndices[0]].mPixelType );
+	const size_t numChannels = mChannelIndices.size();
+
+	// byte offset of each loaded channel within a line, per pixel of the line's width
+	vector<size_t> channelOffsets;
+	for( size_t c : mChannelIndices ) {
+		size_t offset = 0;
+		for( size_t prev = 0; prev < c; ++prev )
+			offset += pixelTypeSize( layout.mChannels[prev].mPixelType );
+		channelOffsets.push_back( offset );
 	}
 
-	if( ( ! red ) || ( ! green ) || ( ! blue ) )
-		throw ImageIoExceptionFailedLoadTinyExr( "Unable to locate channels for RGB" );
-	
-	// load one interleaved row at a time
-	if( getDataType() == ImageIo::FLOAT32 ) {
-		vector<float> rowData( mWidth * mExrImage->num_channels, 0 );
-		for( int32_t row = 0; row < mHeight; row++ ) {
-			for( int32_t col = 0; col < mWidth; col++ ) {
-				rowData.at( col * numChannels + 0 ) = ((float*)red)[row * mWidth + col];
-				rowData.at( col * numChannels + 1 ) = ((float*)green)[row * mWidth + col];
-				rowData.at( col * numChannels + 2 ) = ((float*)blue)[row * mWidth + col];
-				if( alpha )
-					rowData.at( col * numChannels + 3 ) = ((float*)alpha)[row * mWidth + col];
+	const int32_t firstTileX = mArea.x1 / layout.mTileWidth, lastTileX = ( mArea.x2 - 1 ) / layout.mTileWidth;
+	const int32_t firstTileY = mArea.y1 / layout.mTileHeight, lastTileY = ( mArea.y2 - 1 ) / layout.mTileHeight;
+	const int32_t numTilesX = lastTileX - firstTileX + 1;
+	// read enough rows of tiles at once to give every thread a chunk to decompress
+	const int32_t tileRowsPerBatch = std::max<int32_t>( 1, ( numThreads * 2 ) / numTilesX );
+
+	vector<ExrChunk> chunks;
+	vector<uint8_t> rowData( mArea.getWidth() * numChannels * sampleBytes );
+	for( int32_t batchY = firstTileY; batchY <= lastTileY; batchY += tileRowsPerBatch ) {
+		const int32_t batchEndY = std::min( batchY + tileRowsPerBatch, lastTileY + 1 );
+
+		// reading is serial, decompression parallel
+		chunks.resize( ( batchEndY - batchY ) * numTilesX );
+		for( int32_t ty = batchY; ty < batchEndY; ++ty ) {
+			for( int32_t tx = firstTileX; tx <= lastTileX; ++tx ) {
+				ExrChunk &chunk = chunks[( ty - batchY ) * numTilesX + tx - firstTileX];
+				chunk.mBounds = Area( tx * layout.mTileWidth, ty * layout.mTileHeight, std::min( ( tx + 1 ) * layout.mTileWidth, level.mWidth ), std::min( ( ty + 1 ) * layout.mTileHeight, level.mHeight ) );
+
+				mStream->seekAbsolute( (off_t)layout.mChunkOffsets[level.mFirstChunk + ty * level.mNumTilesX + tx] );
+				if( layout.mTiled ) {
+					int32_t coords[4];
+					for( auto &coord : coords )
+						mStream->readLittle( &coord );
+					if( coords[0] != tx || coords[1] != ty || coords[2] != level.mLevelX || coords[3] != level.mLevelY )
+						throw ImageIoExceptionFailedLoadTinyExr( "OpenEXR tile is out of place" );
+				}
+				else {
+					int32_t y;
+					mStream->readLittle( &y );
+					if( y != layout.mDataWindow.y1 + chunk.mBounds.y1 )
+						throw ImageIoExceptionFailedLoadTinyExr( "OpenEXR scanline block is out of place" );
+				}
+				int32_t packedSize;
+				mStream->readLittle( &packedSize );
+				if( packedSize <= 0 || packedSize > mStream->size() - mStream->tell() )
+					throw ImageIoExceptionFailedLoadTinyExr( "OpenEXR chunk is truncated" );
+				chunk.mPacked.resize( packedSize );
+				mStream->readData( chunk.mPacked.data(), packedSize );
 			}
-
-			((*this).*rowFunc)( target, row, rowData.data() );
 		}
-	}
-	else { // float16
-		vector<uint16_t> rowData( mWidth * mExrImage->num_channels, 0 );
-		for( int32_t row = 0; row < mHeight; row++ ) {
-			for( int32_t col = 0; col < mWidth; col++ ) {
-				rowData.at( col * numChannels + 0 ) = ((uint16_t*)red)[row * mWidth + col];
-				rowData.at( col * numChannels + 1 ) = ((uint16_t*)green)[row * mWidth + col];
-				rowData.at( col * numChannels + 2 ) = ((uint16_t*)blue)[row * mWidth + col];
-				if( alpha )
-					rowData.at( col * numChannels + 3 ) = ((uint16_t*)alpha)[row * mWidth + col];
+
+		ip::parallelForRows( 0, (int32_t)chunks.size(), numThreads, [&]( int32_t chunkBegin, int32_t chunkEnd ) {
+			vector<uint8_t> scratch;
+			for( int32_t c = chunkBegin; c < chunkEnd; ++c ) {
+				ExrChunk &chunk = chunks[c];
+				chunk.mPixels.resize( chunk.mBounds.getHeight() * layout.calcLineBytes( chunk.mBounds.getWidth() ) );
+				if( ! decompressChunk( layout.mCompression, chunk.mPacked.data(), chunk.mPacked.size(), chunk.mPixels.data(), chunk.mPixels.size(), &scratch ) )
+					throw ImageIoExceptionFailedLoadTinyExr( "Failed to decompress OpenEXR chunk" );
+			}
+		}, 1 );
+
+		// interleave the loaded channels of each row of the area from the chunks' planar lines
+		const int32_t rowEnd = std::min( batchEndY * layout.mTileHeight, mArea.y2 );
+		for( int32_t y = std::max( batchY * layout.mTileHeight, mArea.y1 ); y < rowEnd; ++y ) {
+			const int32_t ty = y / layout.mTileHeight;
+			for( int32_t tx = firstTileX; tx <= lastTileX; ++tx ) {
+				const ExrChunk &chunk = chunks[( ty - batchY ) * numTilesX + tx - firstTileX];
+				const int32_t chunkWidth = chunk.mBounds.getWidth();
+				const uint8_t *line = chunk.mPixels.data() + ( y - chunk.mBounds.y1 ) * layout.calcLineBytes( chunkWidth );
+				const int32_t x1 = std::max( chunk.mBounds.x1, mArea.x1 ), x2 = std::min( chunk.mBounds.x2, mArea.x2 );
+				for( size_t c = 0; c < numChannels; ++c ) {
+					const uint8_t *src = line + chunkWidth * channelOffsets[c] + ( x1 - chunk.mBounds.x1 ) * sampleBytes;
+					uint8_t *dst = rowData.data() + ( ( x1 - mArea.x1 ) * numChannels + c ) * sampleBytes;
+					for( int32_t x = x1; x < x2; ++x, src += sampleBytes, dst += numChannels * sampleBytes )
+						memcpy( dst, src, sampleBytes );
+				}
 			}
 
-			((*this).*rowFunc)( target, row, rowData.data() );
+			processRow( rowFunc, target, y - mArea.y1, rowData.data() );
 		}
 	}
-	
-	FreeEXRImage( mExrImage.get() );
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -179,40 +584,51 @@ void ImageTargetFileTinyExr::registerSelf()
 	ImageIoRegistrar::registerTargetType( "exr", func, PRIORITY, "exr" );
 }
 
-ImageTargetRef ImageTargetFileTinyExr::create( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string &extensionData )
+ImageTargetRef ImageTargetFileTinyExr::create( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string & /*extensionData*/ )
 {
-	return ImageTargetRef( new ImageTargetFileTinyExr( dataTarget, imageSource, options, extensionData ) );
+	ImageIo::ColorModel cm = options.isColorModelDefault() ? imageSource->getColorModel() : options.getColorModel();
+	return ImageTargetRef( new ImageTargetFileTinyExr( dataTarget, imageSource->getWidth(), imageSource->getHeight(), cm, imageSource->hasAlpha(), options ) );
 }
 
-ImageTargetFileTinyExr::ImageTargetFileTinyExr( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string & /*extensionData*/ )
+ImageTargetFileTinyExrRef ImageTargetFileTinyExr::create( const DataTargetRef &dataTarget, int32_t width, int32_t height, bool alpha, const ImageTarget::Options &options )
 {
-	if( ! dataTarget->providesFilePath() ) {
-		throw ImageIoExceptionFailedWrite( "ImageTargetFileTinyExr only supports writing to files." );
-	}
+	return ImageTargetFileTinyExrRef( new ImageTargetFileTinyExr( dataTarget, width, height, ImageIo::CM_RGB, alpha, options ) );
+}
 
-	mFilePath = dataTarget->getFilePath();
+ImageTargetFileTinyExr::ImageTargetFileTinyExr( const DataTargetRef &dataTarget, int32_t width, int32_t height, ImageIo::ColorModel colorModel, bool alpha, const ImageTarget::Options &options )
+	: mNumThreads( ip::getNumThreads( options.getNumThreads() ) ), mBatchStart( 0 )
+{
+	if( width <= 0 || height <= 0 )
+		throw ImageIoExceptionFailedWriteTinyExr( "TinyExr: cannot write an empty image" );
 
-	setSize( imageSource->getWidth(), imageSource->getHeight() );
-	ImageIo::ColorModel cm = options.isColorModelDefault() ? imageSource->getColorModel() : options.getColorModel();
-	
-	switch( cm ) {
+	setSize( width, height );
+	// the file lists channels in alphabetical order, which is also the order of their data
+	switch( colorModel ) {
 		case ImageIo::ColorModel::CM_RGB:
-			mNumComponents = ( imageSource->hasAlpha() ) ? 4 : 3;
+			mNumComponents = alpha ? 4 : 3;
 			setColorModel( ImageIo::ColorModel::CM_RGB );
-			setChannelOrder( ( mNumComponents == 3 ) ? ImageIo::ChannelOrder::BGR : ImageIo::ChannelOrder::ABGR );
-			if( mNumComponents == 3 )
-				mChannelNames = { "G", "B", "R" };
-			else
-				mChannelNames = { "A", "G", "B", "R" };
+			setChannelOrder( alpha ? ImageIo::ChannelOrder::RGBA : ImageIo::ChannelOrder::RGB );
+			if( alpha ) {
+				mChannelNames = { "A", "B", "G", "R" };
+				mChannelComponents = { 3, 2, 1, 0 };
+			}
+			else {
+				mChannelNames = { "B", "G", "R" };
+				mChannelComponents = { 2, 1, 0 };
+			}
 		break;
 		case ImageIo::ColorModel::CM_GRAY:
-			mNumComponents = ( imageSource->hasAlpha() ) ? 2 : 1;
+			mNumComponents = alpha ? 2 : 1;
 			setColorModel( ImageIo::ColorModel::CM_GRAY );
-			setChannelOrder( ( mNumComponents == 2 ) ? ImageIo::ChannelOrder::YA : ImageIo::ChannelOrder::Y );
-			if( mNumComponents == 2 )
-				mChannelNames = { "Y", "A" };
-			else
+			setChannelOrder( alpha ? ImageIo::ChannelOrder::YA : ImageIo::ChannelOrder::Y );
+			if( alpha ) {
+				mChannelNames = { "A", "Y" };
+				mChannelComponents = { 1, 0 };
+			}
+			else {
 				mChannelNames = { "Y" };
+				mChannelComponents = { 0 };
+			}
 		break;
 		default:
 			throw ImageIoExceptionIllegalColorModel();
@@ -220,53 +636,134 @@ ImageTargetFileTinyExr::ImageTargetFileTinyExr( DataTargetRef dataTarget, ImageS
 
 	// TODO: consider supporting half float and uint types as well
 	setDataType( ImageIo::DataType::FLOAT32 );
-	mData.resize( mHeight * imageSource->getWidth() * mNumComponents );
+
+	mStream = dataTarget->getStream();
+	if( ! mStream )
+		throw ImageIoExceptionFailedWriteTinyExr( "TinyExr: failed to open stream" );
+	mStreamStart = mStream->tell();
+
+	// the header goes out immediately, followed by a placeholder for the offset table which finalize() fills in
+	vector<uint8_t> header;
+	auto append = [&header]( const void *data, size_t size ) { header.insert( header.end(), (const uint8_t*)data, (const uint8_t*)data + size ); };
+	auto appendString = [&]( const string &s ) { append( s.c_str(), s.size() + 1 ); };
+	auto appendAttribute = [&]( const string &name, const string &type, const void *data, int32_t size ) {
+		appendString( name );
+		appendString( type );
+		append( &size, 4 );
+		append( data, size );
+	};
+
+	append( &EXR_MAGIC, 4 );
+	const uint32_t version = 2;
+	append( &version, 4 );
+
+	vector<uint8_t> channelList;
+	for( const auto &name : mChannelNames ) {
+		channelList.insert( channelList.end(), name.begin(), name.end() );
+		const int32_t fields[4] = { EXR_PIXELTYPE_FLOAT, 0, 1, 1 }; // pixel type, pLinear and reserved, x and y sampling
+		channelList.push_back( 0 );
+		channelList.insert( channelList.end(), (const uint8_t*)fields, (const uint8_t*)fields + sizeof( fields ) );
+	}
+	channelList.push_back( 0 );
+	appendAttribute( "channels", "chlist", channelList.data(), (int32_t)channelList.size() );
+	const uint8_t compression = EXR_ZIP_COMPRESSION, lineOrder = 0; // increasing y
+	appendAttribute( "compression", "compression", &compression, 1 );
+	const int32_t window[4] = { 0, 0, width - 1, height - 1 };
+	appendAttribute( "dataWindow", "box2i", window, sizeof( window ) );
+	appendAttribute( "displayWindow", "box2i", window, sizeof( window ) );
+	appendAttribute( "lineOrder", "lineOrder", &lineOrder, 1 );
+	const float aspectRatio = 1, screenWindowCenter[2] = { 0, 0 }, screenWindowWidth = 1;
+	appendAttribute( "pixelAspectRatio", "float", &aspectRatio, 4 );
+	appendAttribute( "screenWindowCenter", "v2f", screenWindowCenter, sizeof( screenWindowCenter ) );
+	appendAttribute( "screenWindowWidth", "float", &screenWindowWidth, 4 );
+	header.push_back( 0 );
+
+	mStream->writeData( header.data(), header.size() );
+	mOffsetTablePos = mStream->tell();
+	mChunkOffsets.resize( ( height + EXR_ZIP_SCANLINES - 1 ) / EXR_ZIP_SCANLINES, 0 );
+	vector<uint8_t> placeholder( mChunkOffsets.size() * 8, 0 );
+	mStream->writeData( placeholder.data(), placeholder.size() );
+
+	// one chunk per thread is buffered at a time
+	mRowsPerBatch = EXR_ZIP_SCANLINES * mNumThreads;
+	mData.resize( mRowsPerBatch * width * mNumComponents );
 }
 
 void* ImageTargetFileTinyExr::getRowPointer( int32_t row )
 {
-	return &mData[row * getWidth() * mNumComponents];
+	if( row < mBatchStart )
+		throw ImageIoExceptionFailedWriteTinyExr( "TinyExr: rows must be written in increasing order" );
+	while( row >= mBatchStart + mRowsPerBatch ) {
+		writeBatch();
+		mBatchStart += mRowsPerBatch;
+	}
+
+	return &mData[( row - mBatchStart ) * getWidth() * mNumComponents];
 }
 
-void ImageTargetFileTinyExr::finalize()
+void ImageTargetFileTinyExr::writeBatch()
 {
-	unique_ptr<EXRImage> exrImage( new EXRImage );
-	InitEXRImage( exrImage.get() ); // we intentionally do not call FreeEXRImage on this
-
-	const char *channelNames[4];
-	
-	// turn interleaved data into a series of planar channels
-	std::vector<Channel32f> channels;
-	float *srcData = mData.data();
-	for( int c = 0; c < mNumComponents; ++c ) {
-		channels.emplace_back( getWidth(), getHeight() );
-		Channel32f srcChannel( getWidth(), getHeight(), mNumComponents * getWidth() * sizeof(float), mNumComponents, srcData + c );
-		channels.back().copyFrom( srcChannel, srcChannel.getBounds() );
-	}
+	const int32_t batchEnd = std::min( mBatchStart + mRowsPerBatch, mHeight );
+	const int32_t numChunks = ( batchEnd - mBatchStart + EXR_ZIP_SCANLINES - 1 ) / EXR_ZIP_SCANLINES;
+	if( numChunks <= 0 )
+		return;
 
-	exrImage->num_channels = mNumComponents;
-	exrImage->width = mWidth;
-	exrImage->height = mHeight;
+	vector<vector<uint8_t>> packed( numChunks );
+	ip::parallelForRows( 0, numChunks, mNumThreads, [&]( int32_t chunkBegin, int32_t chunkEnd ) {
+		vector<float> planar;
+		vector<uint8_t> predicted;
+		for( int32_t c = chunkBegin; c < chunkEnd; ++c ) {
+			const int32_t rowBegin = mBatchStart + c * EXR_ZIP_SCANLINES, rowEnd = std::min( rowBegin + EXR_ZIP_SCANLINES, mHeight );
+
+			// each line of the chunk holds all of one channel, then all of the next
+			planar.resize( ( rowEnd - rowBegin ) * mWidth * mNumComponents );
+			float *dst = planar.data();
+			for( int32_t row = rowBegin; row < rowEnd; ++row ) {
+				const float *src = &mData[( row - mBatchStart ) * mWidth * mNumComponents];
+				for( uint8_t component : mChannelComponents ) {
+					for( int32_t x = 0; x < mWidth; ++x )
+						*dst++ = src[x * mNumComponents + component];
+				}
+			}
 
-	float* imagePtr[4];
-	int pixelTypes[4], requested_pixel_types[4];
-	for( int i = 0; i < exrImage->num_channels; i++ ) {
-		pixelTypes[i] = TINYEXR_PIXELTYPE_FLOAT;
-		requested_pixel_types[i] = pixelTypes[i];
-		channelNames[i] = mChannelNames[i].c_str();
+			const size_t size = planar.size() * sizeof( float );
+			predicted.resize( size );
+			splitAndPredict( (const uint8_t*)planar.data(), size, predicted.data() );
+			uLongf packedSize = compressBound( (uLong)size );
+			packed[c].resize( packedSize );
+			if( compress( packed[c].data(), &packedSize, predicted.data(), (uLong)size ) != Z_OK )
+				throw ImageIoExceptionFailedWriteTinyExr( "TinyExr: failed to compress" );
+			// chunks which compression would make larger are stored as is
+			if( packedSize >= size )
+				packed[c].assign( (const uint8_t*)planar.data(), (const uint8_t*)planar.data() + size );
+			else
+				packed[c].resize( packedSize );
+		}
+	}, 1 );
 
-		imagePtr[i] = channels[i].getData();
+	for( int32_t c = 0; c < numChunks; ++c ) {
+		mChunkOffsets[mBatchStart / EXR_ZIP_SCANLINES + c] = (uint64_t)( mStream->tell() - mStreamStart );
+		const int32_t chunkHeader[2] = { mBatchStart + c * EXR_ZIP_SCANLINES, (int32_t)packed[c].size() };
+		mStream->writeData( chunkHeader, sizeof( chunkHeader ) );
+		mStream->writeData( packed[c].data(), packed[c].size() );
 	}
+}
 
-	exrImage->channel_names = channelNames;
-	exrImage->images = (unsigned char **)imagePtr;
-	exrImage->pixel_types = pixelTypes;
-	exrImage->requested_pixel_types = requested_pixel_types;
-
-	const char *error;
-	int status = SaveMultiChannelEXRToFile( exrImage.get(), mFilePath.string().c_str(), &error );
-	if( status != 0 )
-		throw ImageIoExceptionFailedWriteTinyExr( string( "TinyExr: failed to write. Error: " ) + error );
+void ImageTargetFileTinyExr::finalize()
+{
+	writeBatch();
+	mBatchStart += mRowsPerBatch;
+	if( std::find( mChunkOffsets.begin(), mChunkOffsets.end(), 0 ) != mChunkOffsets.end() )
+		throw ImageIoExceptionFailedWriteTinyExr( "TinyExr: failed to write. Error: not every row was written" );
+
+	vector<uint8_t> offsetTable( mChunkOffsets.size() * 8 );
+	for( size_t c = 0; c < mChunkOffsets.size(); ++c )
+		encodeLittle64( mChunkOffsets[c], &offsetTable[c * 8] );
+
+	const off_t end = mStream->tell();
+	mStream->seekAbsolute( mOffsetTablePos );
+	mStream->writeData( offsetTable.data(), offsetTable.size() );
+	mStream->seekAbsolute( end );
 }
 
-} // namespace cinder
\ No newline at end of file
+} // namespace cinder
@@ -28,6 +28,7 @@
 #include <boost/utility.hpp>
 #include <boost/type_traits/is_same.hpp>
 #include <cctype>
+#include <limits>
 
 #if defined( CINDER_COCOA )
 	#include "cinder/cocoa/CinderCocoa.h"
@@ -166,6 +167,163 @@ size_t ImageSource::getRowBytes() const
 	return getWidth() * ImageIo::channelOrderNumChannels( getChannelOrder() ) * ImageIo::dataTypeBytes( getDataType() );
 }
 
+int32_t ImageSource::Options::calcReductionFactor( const ivec2 &fullSize ) const
+{
+	// the smallest size that satisfies both the requested scale and the requested target size
+	ivec2 minSize( 0 );
+	if( ( mScale > 0 ) && ( mScale < 1 ) )
+		minSize = ivec2( (int32_t)ceil( fullSize.x * mScale ), (int32_t)ceil( fullSize.y * mScale ) );
+	minSize = glm::max( minSize, mTargetSize );
+
+	int32_t result = std::numeric_limits<int32_t>::max();
+	if( minSize.x > 0 )
+		result = std::min( result, fullSize.x / minSize.x );
+	if( minSize.y > 0 )
+		result = std::min( result, fullSize.y / minSize.y );
+	if( ( minSize.x <= 0 ) && ( minSize.y <= 0 ) )
+		result = 1;
+
+	return std::max( 1, result );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ImageSourceRowReducer
+namespace {
+
+// integer samples are summed exactly in 64 bits, which can't overflow even for 16-bit samples and large factors, and rounded on the way out;
+// floating point samples are summed as float
+template<typename T>
+struct ReduceSum {
+	typedef uint64_t Type;
+	static uint64_t	in( T v ) { return v; }
+	static T		out( uint64_t sum, uint64_t count ) { return static_cast<T>( ( sum + count / 2 ) / count ); }
+};
+
+template<>
+struct ReduceSum<float> {
+	typedef float Type;
+	static float	in( float v ) { return v; }
+	static float	out( float sum, uint64_t count ) { return sum / count; }
+};
+
+template<>
+struct ReduceSum<half_float> {
+	typedef float Type;
+	static float		in( half_float v ) { return halfToFloat( v ); }
+	static half_float	out( float sum, uint64_t count ) { return floatToHalf( sum / count ); }
+};
+
+} // anonymous namespace
+
+//! Averages each factor x factor block of the decoder's pixels as its rows arrive, buffering a single row of sums
+class ImageSourceRowReducer {
+  public:
+	ImageSourceRowReducer( const ivec2 &decodedSize, int32_t factor, ImageIo::DataType dataType, int8_t pixelInc )
+		: mDecodedSize( decodedSize ), mFactor( factor ), mRowsAccumulated( 0 ), mDataType( dataType ), mPixelInc( pixelInc )
+	{
+		mReducedWidth = ( decodedSize.x + factor - 1 ) / factor;
+		if( ( dataType == ImageIo::FLOAT32 ) || ( dataType == ImageIo::FLOAT16 ) )
+			mFloatSums.resize( mReducedWidth * pixelInc );
+		else
+			mIntSums.resize( mReducedWidth * pixelInc );
+		mRow.resize( mReducedWidth * pixelInc * ImageIo::dataTypeBytes( dataType ) );
+	}
+
+	const ivec2&	getDecodedSize() const { return mDecodedSize; }
+	int32_t			getFactor() const { return mFactor; }
+
+	//! Accumulates \a data, returning the reduced row when \a decodedRow completes one and \c nullptr otherwise
+	const void* addRow( int32_t decodedRow, const void *data )
+	{
+		const bool complete = ( mRowsAccumulated + 1 == mFactor ) || ( decodedRow + 1 == mDecodedSize.y );
+		switch( mDataType ) {
+			case ImageIo::UINT8:	reduce( reinterpret_cast<const uint8_t*>( data ), complete );		break;
+			case ImageIo::UINT16:	reduce( reinterpret_cast<const uint16_t*>( data ), complete );		break;
+			case ImageIo::FLOAT32:	reduce( reinterpret_cast<const float*>( data ), complete );			break;
+			case ImageIo::FLOAT16:	reduce( reinterpret_cast<const half_float*>( data ), complete );	break;
+			default:
+				throw ImageIoExceptionIllegalDataType();
+		}
+
+		return complete ? mRow.data() : nullptr;
+	}
+
+  private:
+	uint64_t*	getSums( uint64_t ) { return mIntSums.data(); }
+	float*		getSums( float ) { return mFloatSums.data(); }
+
+	template<typename T>
+	void reduce( const T *data, bool complete )
+	{
+		typedef typename ReduceSum<T>::Type S;
+		S *sums = getSums( S() );
+
+		if( mRowsAccumulated == 0 )
+			std::fill( sums, sums + mReducedWidth * mPixelInc, S( 0 ) );
+
+		S *sum = sums;
+		for( int32_t x = 0; x < mDecodedSize.x; x += mFactor ) {
+			const int32_t blockEnd = std::min( x + mFactor, mDecodedSize.x );
+			for( const T *src = data + x * mPixelInc; src < data + blockEnd * mPixelInc; src += mPixelInc )
+				for( int8_t e = 0; e < mPixelInc; ++e )
+					sum[e] += ReduceSum<T>::in( src[e] );
+			sum += mPixelInc;
+		}
+		++mRowsAccumulated;
+
+		if( complete ) {
+			T *row = reinterpret_cast<T*>( mRow.data() );
+			sum = sums;
+			for( int32_t x = 0; x < mReducedWidth; ++x ) {
+				const uint64_t count = uint64_t( std::min( mFactor, mDecodedSize.x - x * mFactor ) ) * mRowsAccumulated;
+				for( int8_t e = 0; e < mPixelInc; ++e )
+					row[e] = ReduceSum<T>::out( sum[e], count );
+				sum += mPixelInc;
+				row += mPixelInc;
+			}
+			mRowsAccumulated = 0;
+		}
+	}
+
+	ivec2					mDecodedSize;
+	int32_t					mFactor, mReducedWidth, mRowsAccumulated;
+	ImageIo::DataType		mDataType;
+	int8_t					mPixelInc;
+	std::vector<uint64_t>	mIntSums;
+	std::vector<float>		mFloatSums;
+	std::vector<uint8_t>	mRow;
+};
+
+void ImageSource::setDecodedSize( const ivec2 &decodedSize, int32_t factor )
+{
+	if( factor > 1 ) {
+		const int8_t pixelInc = ( mCustomPixelInc != 0 ) ? mCustomPixelInc : ImageIo::channelOrderNumChannels( mChannelOrder );
+		mRowReducer = make_shared<ImageSourceRowReducer>( decodedSize, factor, mDataType, pixelInc );
+		setSize( ( decodedSize.x + factor - 1 ) / factor, ( decodedSize.y + factor - 1 ) / factor );
+	}
+	else {
+		mRowReducer.reset();
+		setSize( decodedSize.x, decodedSize.y );
+	}
+}
+
+int32_t ImageSource::getDecodedHeight() const
+{
+	return mRowReducer ? mRowReducer->getDecodedSize().y : mHeight;
+}
+
+void ImageSource::processRow( RowFunc func, const ImageTargetRef &target, int32_t decodedRow, const void *data )
+{
+	if( ! mRowReducer ) {
+		((*this).*func)( target, decodedRow, data );
+		return;
+	}
+
+	const void *reducedRow = mRowReducer->addRow( decodedRow, data );
+	if( reducedRow )
+		((*this).*func)( target, decodedRow / mRowReducer->getFactor(), reducedRow );
+}
+
 /* SD - source data type, TD - target data type, TCM - target color model */
 template<typename SD, typename TD, ImageIo::ColorModel TCM, bool ALPHA>
 void ImageSource::rowFuncSourceRgb( ImageTargetRef target, int32_t row, const void *data )
@@ -0,0 +1,256 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ImageLoader.h"
+
+#include <algorithm>
+
+namespace cinder {
+
+ImageLoader::ImageLoader( const Format &format )
+	: mFormat( format ), mNextId( 1 ), mNumInFlight( 0 ), mQuit( false )
+{
+	// leave a core for the thread making the requests
+	int numThreads = format.getNumThreads();
+	if( numThreads <= 0 )
+		numThreads = std::max<int>( 1, (int)std::thread::hardware_concurrency() - 1 );
+
+	for( int t = 0; t < numThreads; ++t )
+		mThreads.emplace_back( &ImageLoader::workerThread, this );
+}
+
+ImageLoader::~ImageLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mQuit = true;
+		for( auto &request : mPending ) {
+			Result result;
+			result.mId = request.mId;
+			result.mCanceled = true;
+			complete( request, std::move( result ) );
+		}
+		mPending.clear();
+	}
+	mWorkAvailable.notify_all();
+
+	for( auto &thread : mThreads )
+		thread.join();
+}
+
+ImageLoader::RequestId ImageLoader::load( const fs::path &path, const Options &options )
+{
+	Request request;
+	request.mPath = path;
+	request.mOptions = options;
+	return enqueue( std::move( request ) );
+}
+
+ImageLoader::RequestId ImageLoader::load( const DataSourceRef &dataSource, const Options &options )
+{
+	Request request;
+	request.mDataSource = dataSource;
+	request.mOptions = options;
+	return enqueue( std::move( request ) );
+}
+
+std::future<Surface8uRef> ImageLoader::loadFuture( const fs::path &path, const Options &options )
+{
+	Request request;
+	request.mPath = path;
+	request.mOptions = options;
+	request.mPromise = std::make_shared<std::promise<Surface8uRef>>();
+	std::future<Surface8uRef> result = request.mPromise->get_future();
+	enqueue( std::move( request ) );
+	return result;
+}
+
+std::future<Surface8uRef> ImageLoader::loadFuture( const DataSourceRef &dataSource, const Options &options )
+{
+	Request request;
+	request.mDataSource = dataSource;
+	request.mOptions = options;
+	request.mPromise = std::make_shared<std::promise<Surface8uRef>>();
+	std::future<Surface8uRef> result = request.mPromise->get_future();
+	enqueue( std::move( request ) );
+	return result;
+}
+
+ImageLoader::RequestId ImageLoader::enqueue( Request &&request )
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	request.mId = mNextId++;
+	const RequestId id = request.mId;
+
+	if( mFormat.getMaxPending() > 0 && mPending.size() >= mFormat.getMaxPending() ) {
+		// make room by dropping the stalest request: the lowest priority, and the oldest of those, which may be the new one
+		auto lowest = std::min_element( mPending.begin(), mPending.end(), []( const Request &a, const Request &b ) { return a.mOptions.getPriority() < b.mOptions.getPriority(); } );
+		Result canceled;
+		canceled.mCanceled = true;
+		if( request.mOptions.getPriority() < lowest->mOptions.getPriority() ) {
+			canceled.mId = id;
+			complete( request, std::move( canceled ) );
+			return id;
+		}
+		canceled.mId = lowest->mId;
+		complete( *lowest, std::move( canceled ) );
+		mPending.erase( lowest );
+	}
+
+	mPending.push_back( std::move( request ) );
+	lock.unlock();
+	mWorkAvailable.notify_one();
+	return id;
+}
+
+bool ImageLoader::cancel( RequestId id )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	auto it = std::find_if( mPending.begin(), mPending.end(), [id]( const Request &request ) { return request.mId == id; } );
+	if( it == mPending.end() )
+		return false;
+
+	Result result;
+	result.mId = id;
+	result.mCanceled = true;
+	complete( *it, std::move( result ) );
+	mPending.erase( it );
+	return true;
+}
+
+void ImageLoader::cancelAll()
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	for( auto &request : mPending ) {
+		Result result;
+		result.mId = request.mId;
+		result.mCanceled = true;
+		complete( request, std::move( result ) );
+	}
+	mPending.clear();
+}
+
+bool ImageLoader::setPriority( RequestId id, int priority )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	auto it = std::find_if( mPending.begin(), mPending.end(), [id]( const Request &request ) { return request.mId == id; } );
+	if( it == mPending.end() )
+		return false;
+
+	it->mOptions.priority( priority );
+	return true;
+}
+
+size_t ImageLoader::update()
+{
+	// the callbacks run without the lock held, so they may make new requests
+	std::deque<std::pair<Callback,Result>> callbacks;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		callbacks.swap( mCallbacks );
+	}
+
+	for( auto &callback : callbacks )
+		callback.first( callback.second );
+
+	return callbacks.size();
+}
+
+bool ImageLoader::popResult( Result *result )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	if( mResults.empty() )
+		return false;
+
+	*result = std::move( mResults.front() );
+	mResults.pop_front();
+	return true;
+}
+
+size_t ImageLoader::getNumPending() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mPending.size();
+}
+
+size_t ImageLoader::getNumInFlight() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mNumInFlight;
+}
+
+// Called with mMutex held
+void ImageLoader::complete( Request &request, Result &&result )
+{
+	if( request.mPromise ) {
+		if( result.mSurface )
+			request.mPromise->set_value( result.mSurface );
+		else if( result.mError )
+			request.mPromise->set_exception( result.mError );
+		else
+			request.mPromise->set_exception( std::make_exception_ptr( ImageLoaderExceptionCanceled() ) );
+	}
+	else if( request.mOptions.getCallback() )
+		mCallbacks.emplace_back( request.mOptions.getCallback(), std::move( result ) );
+	else
+		mResults.push_back( std::move( result ) );
+}
+
+void ImageLoader::workerThread()
+{
+	ThreadSetup threadSetup;
+
+	while( true ) {
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock( mMutex );
+			mWorkAvailable.wait( lock, [this] { return mQuit || ! mPending.empty(); } );
+			if( mQuit )
+				return;
+
+			// the highest priority, and the oldest of those since requests are appended in id order
+			auto next = std::max_element( mPending.begin(), mPending.end(), []( const Request &a, const Request &b ) { return a.mOptions.getPriority() < b.mOptions.getPriority(); } );
+			request = std::move( *next );
+			mPending.erase( next );
+			++mNumInFlight;
+		}
+
+		Result result;
+		result.mId = request.mId;
+		try {
+			const ImageSource::Options &sourceOptions = request.mOptions.getSourceOptions();
+			const std::string &extension = request.mOptions.getExtension();
+			ImageSourceRef imageSource = request.mDataSource ? loadImage( request.mDataSource, sourceOptions, extension ) : loadImage( request.mPath, sourceOptions, extension );
+			result.mSurface = Surface8u::create( imageSource );
+		}
+		catch( ... ) {
+			result.mError = std::current_exception();
+		}
+
+		std::lock_guard<std::mutex> lock( mMutex );
+		--mNumInFlight;
+		complete( request, std::move( result ) );
+	}
+}
+
+} // namespace cinder
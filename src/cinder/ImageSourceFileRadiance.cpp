@@ -23,204 +23,279 @@
 */
 
 #include "cinder/ImageSourceFileRadiance.h"
-#include "cinder/Stream.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/CinderSimd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+using namespace std;
 
 namespace cinder {
 
-ImageSourceRef ImageSourceFileRadiance::create( DataSourceRef dataSourceRef, ImageSource::Options options )
-{
-	return ImageSourceRef( new ImageSourceFileRadiance( dataSourceRef, options ) );
-}
+namespace {
 
-void ImageSourceFileRadiance::load( ImageTargetRef target )
+const int32_t MINELEN =	8;				// minimum scanline length for encoding
+const int32_t MAXELEN = 0x7fff;			// maximum scanline length for encoding
+
+// Decodes the scanline at src into width RGBE pixels at dst, or only finds its end when WRITE is false. last holds the pixel preceding the scanline, which
+// old-style runs repeat, and receives the scanline's final pixel. Returns the end of the scanline, or nullptr if it is truncated or corrupt.
+template<bool WRITE>
+const uint8_t* decodeRgbeScanline( const uint8_t *src, const uint8_t *end, int32_t width, uint8_t last[4], uint8_t *dst )
 {
-	// get a pointer to the ImageSource function appropriate for handling our data configuration
-	ImageSource::RowFunc func = setupRowFunc( target );
-	//int number_passes = png_set_interlace_handling( mPngPtr );
-	for( int32_t row = 0; row < mHeight; ++row ) {
-		((*this).*func)( target, row, mRgbData.get() + ( row * mWidth * 3 ) );
+	// new-style run-length encoding stores each component separately, flagged by a pixel which can't otherwise occur
+	if( width >= MINELEN && width <= MAXELEN && end - src >= 4 && src[0] == 2 && src[1] == 2 && ! ( src[2] & 128 ) && ( ( src[2] << 8 ) | src[3] ) == width ) {
+		src += 4;
+		for( int c = 0; c < 4; ++c ) {
+			for( int32_t x = 0; x < width; ) {
+				if( src >= end )
+					return nullptr;
+				int32_t count = *src++;
+				if( count > 128 ) { // run
+					count &= 127;
+					if( src >= end || x + count > width )
+						return nullptr;
+					if( WRITE ) {
+						for( int32_t i = 0; i < count; ++i )
+							dst[( x + i ) * 4 + c] = *src;
+					}
+					last[c] = *src++;
+				}
+				else { // non-run
+					if( count == 0 || x + count > width || end - src < count )
+						return nullptr;
+					if( WRITE ) {
+						for( int32_t i = 0; i < count; ++i )
+							dst[( x + i ) * 4 + c] = src[i];
+					}
+					last[c] = src[count - 1];
+					src += count;
+				}
+				x += count;
+			}
+		}
+		return src;
 	}
-}
 
-void ImageSourceFileRadiance::registerSelf()
-{
-	ImageIoRegistrar::SourceCreationFunc sourceFunc = ImageSourceFileRadiance::create;
-	ImageIoRegistrar::registerSourceType( "hdr", sourceFunc, 1 );
+	// flat pixels, with old-style runs of the previous pixel flagged by ( 1, 1, 1, count ); consecutive runs extend the count by 8 bits each
+	int32_t rshift = 0;
+	for( int32_t x = 0; x < width; src += 4 ) {
+		if( end - src < 4 )
+			return nullptr;
+		if( src[0] == 1 && src[1] == 1 && src[2] == 1 ) {
+			if( rshift > 16 )
+				return nullptr;
+			const int32_t count = src[3] << rshift;
+			if( x + count > width )
+				return nullptr;
+			if( WRITE ) {
+				for( int32_t i = 0; i < count; ++i )
+					memcpy( dst + ( x + i ) * 4, last, 4 );
+			}
+			x += count;
+			rshift += 8;
+		}
+		else {
+			memcpy( last, src, 4 );
+			if( WRITE )
+				memcpy( dst + x * 4, src, 4 );
+			++x;
+			rshift = 0;
+		}
+	}
+	return src;
 }
 
-ImageSourceFileRadiance::ImageSourceFileRadiance( DataSourceRef dataSourceRef, ImageSource::Options /*options*/ )
+// Converts width RGBE pixels to floats at dst, whose pixels are inc floats apart with red, green and blue at the given offsets. The mantissas are scaled by
+// 2^(e-136), which is exact as a single rounding of the product. A zero exponent is black.
+void convertRgbeScanline( const uint8_t *rgbe, int32_t width, float *dst, int8_t red, int8_t green, int8_t blue, int8_t inc )
 {
-	IStreamRef stream = dataSourceRef->createStream();
-
-	loadStream( stream );
+	int32_t x = 0;
+#if defined( CINDER_SIMD_SSE2 )
+	// the common orders are stored four floats at a time, with the fourth lane set to 1 for alpha or overwritten by the next pixel. The last pixel of the row is
+	// always left to the scalar loop, so that no store reaches past the row
+	if( simd::getLevel() >= simd::Level::SSE2 && red == 0 && green == 1 && blue == 2 && ( inc == 3 || inc == 4 ) ) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i bias = _mm_set1_epi32( 127 - 68 );
+		const __m128 rgbMask = _mm_castsi128_ps( _mm_set_epi32( 0, -1, -1, -1 ) );
+		const __m128 alphaOne = _mm_set_ps( 1.0f, 0, 0, 0 );
+		for( ; x + 4 < width; x += 4 ) {
+			const __m128i packed = _mm_loadu_si128( reinterpret_cast<const __m128i*>( rgbe + x * 4 ) );
+			const __m128i lo = _mm_unpacklo_epi8( packed, zero ), hi = _mm_unpackhi_epi8( packed, zero );
+			const __m128i pixels[4] = { _mm_unpacklo_epi16( lo, zero ), _mm_unpackhi_epi16( lo, zero ), _mm_unpacklo_epi16( hi, zero ), _mm_unpackhi_epi16( hi, zero ) };
+			for( int p = 0; p < 4; ++p ) {
+				// 2^(e-136) can be denormal, so it's applied as two normal factors of 2^((e>>1)-68) and 2^(e-(e>>1)-68)
+				const __m128i e = _mm_shuffle_epi32( pixels[p], _MM_SHUFFLE( 3, 3, 3, 3 ) );
+				const __m128i eHalf = _mm_srli_epi32( e, 1 );
+				const __m128 scaleA = _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( eHalf, bias ), 23 ) );
+				const __m128 scaleB = _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( _mm_sub_epi32( e, eHalf ), bias ), 23 ) );
+				__m128 rgb = _mm_mul_ps( _mm_mul_ps( _mm_cvtepi32_ps( pixels[p] ), scaleA ), scaleB );
+				rgb = _mm_and_ps( rgb, _mm_and_ps( rgbMask, _mm_castsi128_ps( _mm_cmpgt_epi32( e, zero ) ) ) );
+				_mm_storeu_ps( dst + ( x + p ) * inc, _mm_or_ps( rgb, alphaOne ) );
+			}
+		}
+	}
+#endif
+	for( ; x < width; ++x ) {
+		const uint8_t *p = rgbe + x * 4;
+		float *d = dst + x * inc;
+		if( p[3] == 0 ) {
+			d[red] = d[green] = d[blue] = 0;
+		}
+		else {
+			const float scale = ldexpf( 1.0f, (int)p[3] - 136 );
+			d[red] = p[0] * scale;
+			d[green] = p[1] * scale;
+			d[blue] = p[2] * scale;
+		}
+	}
 }
 
-namespace {
-typedef unsigned char RgbePixel[4];
-
-const int MINELEN =	8;				// minimum scanline length for encoding
-const int MAXELEN = 0x7fff;			// maximum scanline length for encoding
+} // anonymous namespace
 
-enum { R, G, B, E };
+ImageSourceRef ImageSourceFileRadiance::create( DataSourceRef dataSourceRef, ImageSource::Options options )
+{
+	return ImageSourceRef( new ImageSourceFileRadiance( dataSourceRef, options ) );
+}
 
-void workOnRgbeScanline( RgbePixel *scan, int len, float *cols );
-bool decrunchScanline( RgbePixel *scanline, int len, IStreamCinder *stream );
-bool oldStyleDecrunch( RgbePixel *scanline, int len, IStreamCinder *stream );
+void ImageSourceFileRadiance::registerSelf()
+{
+	ImageIoRegistrar::SourceCreationFunc sourceFunc = ImageSourceFileRadiance::create;
+	ImageIoRegistrar::registerSourceType( "hdr", sourceFunc, 1 );
 }
 
-void ImageSourceFileRadiance::loadStream( IStreamRef stream )
+ImageSourceFileRadiance::ImageSourceFileRadiance( DataSourceRef dataSourceRef, ImageSource::Options options )
+	: mNumThreads( options.getNumThreads() )
 {
 	setDataType( ImageIo::FLOAT32 );
 	setColorModel( ImageIo::CM_RGB );
 	setChannelOrder( ImageIo::RGB );
 
-	char str[200];
-	stream->readData( str, 10 );
-	if( memcmp( str, "#?RADIANCE", 10 ) )
-		throw ImageSourceFileRadianceException( "Invalid header" );
+	// decoding reads straight from the DataSource's Buffer, which a DataSourceMapped doesn't copy
+	mBuffer = dataSourceRef->getBuffer();
+	parseHeader();
+	findScanlines();
 
-	stream->seekRelative( 1 );
+	const ivec2 size( mScanlineWidth, mNumScanlines );
+	setDecodedSize( size, options.calcReductionFactor( size ) );
+}
 
-	char cmd[200];
-	int i = 0;
-	char c = 0, oldc;
-	while( true ) {
-		oldc = c;
-		stream->read( &c );
-		if( c == 0xa && oldc == 0xa )
-			break;
-		cmd[i++] = c;
-	}
+void ImageSourceFileRadiance::parseHeader()
+{
+	const char *begin = static_cast<const char*>( mBuffer->getData() );
+	const char *end = begin + mBuffer->getSize();
+	if( end - begin < 2 || memcmp( begin, "#?", 2 ) )
+		throw ImageSourceFileRadianceException( "Invalid header" );
 
-	char resolution[200];
-	i = 0;
+	// header lines end with an empty line and are followed by the resolution line
+	const char *line = begin;
+	string resolution;
+	bool inHeader = true;
 	while( true ) {
-		stream->read( &c );
-		resolution[i++] = c;
-		if( c == 0xa )
+		const char *lineEnd = static_cast<const char*>( memchr( line, '\n', end - line ) );
+		if( ! lineEnd )
+			throw ImageSourceFileRadianceException( "Invalid header" );
+		const string text( line, lineEnd );
+		line = lineEnd + 1;
+		if( ! inHeader ) {
+			resolution = text;
 			break;
+		}
+		if( text.empty() )
+			inHeader = false;
+		else if( text.compare( 0, 7, "FORMAT=" ) == 0 && text != "FORMAT=32-bit_rle_rgbe" )
+			throw ImageSourceFileRadianceException( "Unsupported format: " + text.substr( 7 ) );
 	}
+	mDataOffset = line - begin;
 
-	int width, height;
-#if defined( CINDER_UWP )
-	if( ! sscanf_s( resolution, "-Y %d +X %d", &height, &width ) )
-#else
-	if( ! sscanf( resolution, "-Y %d +X %d", &height, &width ) )
-#endif
+	istringstream ss( resolution );
+	string yAxis, xAxis;
+	int32_t width = 0, height = 0;
+	if( ! ( ss >> yAxis >> height >> xAxis >> width ) || width <= 0 || height <= 0 )
 		throw ImageSourceFileRadianceException( "Unable to parse size" );
-	setSize( width, height );
-
-	mRgbData = std::unique_ptr<float[]>( new float[width * height * 3] );
-	std::unique_ptr<RgbePixel[]> scanline( new RgbePixel[width] );
-
-	// convert image
-	float *cols = mRgbData.get();
-	for( int y = height - 1; y >= 0; y-- ) {
-		if( ! decrunchScanline( scanline.get(), width, stream.get() ) )
-			break;
-		workOnRgbeScanline( scanline.get(), width, cols );
-		cols += width * 3;
-	}
-}
+	if( ( yAxis != "-Y" && yAxis != "+Y" ) || xAxis != "+X" )
+		throw ImageSourceFileRadianceException( "Unsupported orientation: " + resolution );
 
-namespace {
-// this should be optimized
-float convertComponent( int expo, int val )
-{
-	float v = val / 256.0f;
-	float d = powf( 2.0f, expo );
-	return v * d;
+	mScanlineWidth = width;
+	mNumScanlines = height;
+	mFlipped = ( yAxis == "+Y" );
 }
 
-void workOnRgbeScanline( RgbePixel *scan, int len, float *cols )
+void ImageSourceFileRadiance::findScanlines()
 {
-	while( len-- > 0 ) {
-		int expo = scan[0][E] - 128;
-		cols[0] = convertComponent( expo, scan[0][R] );
-		cols[1] = convertComponent( expo, scan[0][G] );
-		cols[2] = convertComponent( expo, scan[0][B] );
-		cols += 3;
-		scan++;
+	const uint8_t *data = static_cast<const uint8_t*>( mBuffer->getData() );
+	const uint8_t *end = data + mBuffer->getSize();
+	const uint8_t *src = data + mDataOffset;
+
+	mScanlineOffsets.clear();
+	mScanlineSeeds.clear();
+	mScanlineOffsets.reserve( mNumScanlines );
+	mScanlineSeeds.reserve( mNumScanlines );
+	uint8_t last[4] = { 0, 0, 0, 0 };
+	for( int32_t row = 0; row < mNumScanlines; ++row ) {
+		uint32_t seed;
+		memcpy( &seed, last, 4 );
+		const uint8_t *next = decodeRgbeScanline<false>( src, end, mScanlineWidth, last, nullptr );
+		if( ! next )
+			break;
+		mScanlineOffsets.push_back( src - data );
+		mScanlineSeeds.push_back( seed );
+		src = next;
 	}
 }
 
-bool decrunchScanline( RgbePixel *scanline, int len, IStreamCinder *stream )
+bool ImageSourceFileRadiance::decodeScanline( int32_t fileRow, uint8_t *rgbe ) const
 {
-	char i;
-
-	if( len < MINELEN || len > MAXELEN )
-		return oldStyleDecrunch(scanline, len, stream );
-
-	stream->read( &i );
-	if( i != 2 ) { // old style
-		stream->seekRelative( -1 );
-		return oldStyleDecrunch( scanline, len, stream );
+	if( fileRow >= (int32_t)mScanlineOffsets.size() ) {
+		memset( rgbe, 0, mScanlineWidth * 4 );
+		return false;
 	}
 
-	stream->read( &scanline[0][G] );
-	stream->read( &scanline[0][B] );
-	stream->read( &i );
+	const uint8_t *data = static_cast<const uint8_t*>( mBuffer->getData() );
+	uint8_t last[4];
+	memcpy( last, &mScanlineSeeds[fileRow], 4 );
+	decodeRgbeScanline<true>( data + mScanlineOffsets[fileRow], data + mBuffer->getSize(), mScanlineWidth, last, rgbe );
+	return true;
+}
 
-	if( scanline[0][G] != 2 || scanline[0][B] & 128 ) {
-		scanline[0][R] = 2;
-		scanline[0][E] = i;
-		return oldStyleDecrunch( scanline + 1, len - 1, stream );
+void ImageSourceFileRadiance::load( ImageTargetRef target )
+{
+	ImageSource::RowFunc rowFunc = setupRowFunc( target );
+	const int numThreads = ip::getNumThreads( mNumThreads );
+	const int32_t width = mScanlineWidth, height = mNumScanlines;
+
+	// convert straight into the rows of targets which allow it, such as a full size Surface32f
+	if( ! mRowReducer && target->supportsParallelRows() && target->getDataType() == ImageIo::FLOAT32 && target->getColorModel() == ImageIo::CM_RGB ) {
+		int8_t red, green, blue, alpha, inc;
+		translateRgbColorModelToOffsets( target->getChannelOrder(), &red, &green, &blue, &alpha, &inc );
+		ip::parallelForRows( 0, height, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+			vector<uint8_t> rgbe( width * 4 );
+			for( int32_t row = rowBegin; row < rowEnd; ++row ) {
+				decodeScanline( mFlipped ? height - 1 - row : row, rgbe.data() );
+				convertRgbeScanline( rgbe.data(), width, static_cast<float*>( target->getRowPointer( row ) ), red, green, blue, inc );
+			}
+		} );
+		return;
 	}
 
-	// read each component
-	for( i = 0; i < 4; i++ ) {
-	    for( int j = 0; j < len; ) {
-			unsigned char code;
-			stream->read( &code );
-			if( code > 128 ) { // run
-			    code &= 127;
-			    unsigned char val;
-				stream->read( &val );
-			    while( code-- )
-					scanline[j++][i] = val;
-			}
-			else {	// non-run
-				while( code-- )
-					stream->read( &scanline[j++][i] );
+	// otherwise decode batches of rows in parallel, and pass them on in order
+	const int32_t batchRows = 16 * numThreads;
+	vector<float> rows( (size_t)batchRows * width * 3 );
+	for( int32_t batchBegin = 0; batchBegin < height; batchBegin += batchRows ) {
+		const int32_t batchEnd = std::min( batchBegin + batchRows, height );
+		ip::parallelForRows( batchBegin, batchEnd, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+			vector<uint8_t> rgbe( width * 4 );
+			for( int32_t row = rowBegin; row < rowEnd; ++row ) {
+				decodeScanline( mFlipped ? height - 1 - row : row, rgbe.data() );
+				convertRgbeScanline( rgbe.data(), width, rows.data() + (size_t)( row - batchBegin ) * width * 3, 0, 1, 2, 3 );
 			}
-		}
-    }
-
-	return ! stream->isEof();
-}
+		} );
 
-bool oldStyleDecrunch( RgbePixel *scanline, int len, IStreamCinder *stream )
-{
-	int i;
-	int rshift = 0;
-	
-	while( len > 0 ) {
-		stream->read( &scanline[0][R] );
-		stream->read( &scanline[0][G] );
-		stream->read( &scanline[0][B] );
-		stream->read( &scanline[0][E] );
-		if( stream->isEof() )
-			return false;
-
-		if( scanline[0][R] == 1 &&
-			scanline[0][G] == 1 &&
-			scanline[0][B] == 1) {
-			for( i = scanline[0][E] << rshift; i > 0; i-- ) {
-				memcpy( &scanline[0][0], &scanline[-1][0], 4 );
-				scanline++;
-				len--;
-			}
-			rshift += 8;
-		}
-		else {
-			scanline++;
-			len--;
-			rshift = 0;
-		}
+		for( int32_t row = batchBegin; row < batchEnd; ++row )
+			processRow( rowFunc, target, row, rows.data() + (size_t)( row - batchBegin ) * width * 3 );
 	}
-	
-	return true;
 }
-} // anonymous namespace
 
-} // namespace cinder
\ No newline at end of file
+} // namespace cinder
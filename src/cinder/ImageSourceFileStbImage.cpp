@@ -57,7 +57,7 @@ void ImageSourceFileStbImage::registerSelf()
 
 ///////////////////////////////////////////////////////////////////////////////
 // ImageSourceFileStbImage
-ImageSourceFileStbImage::ImageSourceFileStbImage( DataSourceRef dataSourceRef, ImageSource::Options /*options*/ )
+ImageSourceFileStbImage::ImageSourceFileStbImage( DataSourceRef dataSourceRef, ImageSource::Options options )
 	: mData8u( nullptr ), mData32f( nullptr ), mRowBytes( 0 )
 {
 	int width = 0, height = 0, components = 0;
@@ -100,7 +100,6 @@ ImageSourceFileStbImage::ImageSourceFileStbImage( DataSourceRef dataSourceRef, I
 		setDataType( ImageIo::UINT8 );
 	else if( mData32f )
 		setDataType( ImageIo::FLOAT32 );
-	setSize( width, height );
 
 	switch( components ) {
 		case 1:
@@ -122,6 +121,9 @@ ImageSourceFileStbImage::ImageSourceFileStbImage( DataSourceRef dataSourceRef, I
 		default:
 			throw ImageIoException();
 	}
+
+	// stb_image can only decode at full resolution, so a requested reduction is box-filtered as the rows are converted
+	setDecodedSize( ivec2( width, height ), options.calcReductionFactor( ivec2( width, height ) ) );
 }
 
 
@@ -137,8 +139,8 @@ void ImageSourceFileStbImage::load( ImageTargetRef target )
 {
 	ImageSource::RowFunc func = setupRowFunc( target );
 	const uint8_t *data = ( mData8u ) ? mData8u : reinterpret_cast<uint8_t*>( mData32f );
-	for( int32_t row = 0; row < mHeight; ++row ) {
-		((*this).*func)( target, row, data + row * mRowBytes );
+	for( int32_t row = 0; row < getDecodedHeight(); ++row ) {
+		processRow( func, target, row, data + row * mRowBytes );
 	}
 }
 
@@ -76,8 +76,8 @@ ImageSourcePngRef ImageSourcePng::createRef( DataSourceRef dataSourceRef, ImageS
 	return ImageSourcePngRef( new ImageSourcePng( dataSourceRef, options ) );
 }
 
-ImageSourcePng::ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Options /*options*/ )
-	: ImageSource(), mInfoPtr( 0 ), mPngPtr( 0 )
+ImageSourcePng::ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Options options )
+	: ImageSource(), mInfoPtr( 0 ), mPngPtr( 0 ), mNumPasses( 1 ), mPassReduction( 1 )
 {
 	mPngPtr = png_create_read_struct( PNG_LIBPNG_VER_STRING, (png_voidp)NULL, NULL, NULL );
 	if( ! mPngPtr ) {
@@ -96,12 +96,12 @@ ImageSourcePng::ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Option
 		throw ImageSourcePngException( "Could not destroy png read struct." );
 	}
 	
-	if( ! loadHeader() )
+	if( ! loadHeader( options ) )
 		throw ImageSourcePngException( "Could not load png header." );
 }
 
 // part of this being separated allows for us to play nicely with the setjmp of libpng
-bool ImageSourcePng::loadHeader()
+bool ImageSourcePng::loadHeader( const ImageSource::Options &options )
 {
 	bool success = true;
 
@@ -120,7 +120,6 @@ bool ImageSourcePng::loadHeader()
 			return false;
 		}
 
-		setSize( width, height );
 		setDataType( ( bitDepth == 16 ) ? ImageIo::UINT16 : ImageIo::UINT8 );
 		
 	#ifdef CINDER_LITTLE_ENDIAN
@@ -152,6 +151,22 @@ bool ImageSourcePng::loadHeader()
 		png_set_expand_gray_1_2_4_to_8( mPngPtr );
 		png_set_palette_to_rgb( mPngPtr );
 		png_set_tRNS_to_alpha( mPngPtr );
+
+		// Interlaced images are reduced by decoding only the leading Adam7 passes. Pass 1 alone holds every 8th pixel of every 8th row,
+		// passes 1-3 every 4th and passes 1-5 every 2nd. Without interlace handling libpng returns each pass as its own sub-image.
+		const int32_t factor = options.calcReductionFactor( ivec2( width, height ) );
+		if( ( interlaceType == PNG_INTERLACE_ADAM7 ) && ( factor >= 2 ) ) {
+			mPassReduction = ( factor >= 8 ) ? 8 : ( factor >= 4 ) ? 4 : 2;
+			mNumPasses = ( mPassReduction == 8 ) ? 1 : ( mPassReduction == 4 ) ? 3 : 5;
+		}
+		else {
+			mPassReduction = 1;
+			mNumPasses = png_set_interlace_handling( mPngPtr );
+		}
+
+		// whatever remains of the reduction is box-filtered as the rows stream out
+		const ivec2 decodedSize( ( width + mPassReduction - 1 ) / mPassReduction, ( height + mPassReduction - 1 ) / mPassReduction );
+		setDecodedSize( decodedSize, factor / mPassReduction );
 		
 		png_read_update_info( mPngPtr, mInfoPtr );
 	}
@@ -176,11 +191,46 @@ void ImageSourcePng::load( ImageTargetRef target )
 	else {
 		// get a pointer to the ImageSource function appropriate for handling our data configuration
 		ImageSource::RowFunc func = setupRowFunc( target );
-		//int number_passes = png_set_interlace_handling( mPngPtr );
-		unique_ptr<png_byte[]> row_pointer( new png_byte[png_get_rowbytes( mPngPtr, mInfoPtr )] );
-		for( int32_t row = 0; row < mHeight; ++row ) {
-			png_read_row( mPngPtr, row_pointer.get(), NULL );
-			((*this).*func)( target, row, row_pointer.get() );
+		const size_t rowBytes = png_get_rowbytes( mPngPtr, mInfoPtr );
+		if( mPassReduction > 1 ) {
+			// scatter the retained passes' pixels into the reduced image; every one of them lands on a multiple of mPassReduction
+			const png_uint_32 width = png_get_image_width( mPngPtr, mInfoPtr ), height = png_get_image_height( mPngPtr, mInfoPtr );
+			const size_t pixelBytes = rowBytes / width;
+			const int32_t decodedWidth = ( width + mPassReduction - 1 ) / mPassReduction;
+			const size_t decodedRowBytes = decodedWidth * pixelBytes;
+			unique_ptr<png_byte[]> image( new png_byte[decodedRowBytes * getDecodedHeight()] );
+			unique_ptr<png_byte[]> passLine( new png_byte[rowBytes] );
+			for( int pass = 0; pass < mNumPasses; ++pass ) {
+				const png_uint_32 passCols = PNG_PASS_COLS( width, pass ), passRows = PNG_PASS_ROWS( height, pass );
+				if( ( passCols == 0 ) || ( passRows == 0 ) )
+					continue; // libpng skips empty passes
+				for( png_uint_32 passRow = 0; passRow < passRows; ++passRow ) {
+					png_read_row( mPngPtr, passLine.get(), NULL );
+					png_byte *dst = image.get() + ( PNG_ROW_FROM_PASS_ROW( passRow, pass ) / mPassReduction ) * decodedRowBytes;
+					for( png_uint_32 col = 0; col < passCols; ++col )
+						memcpy( dst + ( PNG_COL_FROM_PASS_COL( col, pass ) / mPassReduction ) * pixelBytes, passLine.get() + col * pixelBytes, pixelBytes );
+				}
+			}
+			for( int32_t row = 0; row < getDecodedHeight(); ++row )
+				processRow( func, target, row, image.get() + row * decodedRowBytes );
+		}
+		else if( mNumPasses == 1 ) {
+			// rows are handed to the target as they're decoded, so only one is ever buffered
+			unique_ptr<png_byte[]> row_pointer( new png_byte[rowBytes] );
+			for( int32_t row = 0; row < getDecodedHeight(); ++row ) {
+				png_read_row( mPngPtr, row_pointer.get(), NULL );
+				processRow( func, target, row, row_pointer.get() );
+			}
+		}
+		else {
+			// Adam7 interlacing revisits every row on each pass, so the whole image has to be decoded before any row is complete
+			unique_ptr<png_byte[]> image( new png_byte[rowBytes * mHeight] );
+			for( int pass = 0; pass < mNumPasses; ++pass ) {
+				for( int32_t row = 0; row < mHeight; ++row )
+					png_read_row( mPngPtr, image.get() + row * rowBytes, NULL );
+			}
+			for( int32_t row = 0; row < mHeight; ++row )
+				((*this).*func)( target, row, image.get() + row * rowBytes );
 		}
 	}
 	
@@ -22,14 +22,152 @@
 */
 
 #include "cinder/ImageTargetFileStbImage.h"
+#include "cinder/ip/Parallel.h"
 #include "cinder/Log.h"
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_STATIC
 #include "stb/stb_image_write.h"
 
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 namespace cinder {
 
+namespace {
+
+// Rows are grouped into strips of roughly this many bytes, each compressed independently. This is the granularity of parallelism.
+const size_t STRIP_BYTES = 256 * 1024;
+// Each PNG strip's deflate stream is primed with the tail of the strip before it, as pigz does, so splitting costs little compression
+const size_t PNG_DICTIONARY_BYTES = 32 * 1024;
+
+inline uint8_t paeth( int a, int b, int c )
+{
+	int p = a + b - c;
+	int pa = std::abs( p - a ), pb = std::abs( p - b ), pc = std::abs( p - c );
+	if( pa <= pb && pa <= pc )
+		return (uint8_t)a;
+	else if( pb <= pc )
+		return (uint8_t)b;
+	else
+		return (uint8_t)c;
+}
+
+// Applies PNG filter \a type to the \a len bytes of row \a cur, whose predecessor is \a prev, writing the result to \a out
+void filterPngRow( int type, const uint8_t *cur, const uint8_t *prev, size_t bpp, size_t len, uint8_t *out )
+{
+	switch( type ) {
+		case 0: // none
+			std::memcpy( out, cur, len );
+		break;
+		case 1: // sub
+			for( size_t i = 0; i < bpp; ++i )
+				out[i] = cur[i];
+			for( size_t i = bpp; i < len; ++i )
+				out[i] = cur[i] - cur[i - bpp];
+		break;
+		case 2: // up
+			for( size_t i = 0; i < len; ++i )
+				out[i] = cur[i] - prev[i];
+		break;
+		case 3: // average
+			for( size_t i = 0; i < bpp; ++i )
+				out[i] = cur[i] - ( prev[i] >> 1 );
+			for( size_t i = bpp; i < len; ++i )
+				out[i] = cur[i] - ( ( cur[i - bpp] + prev[i] ) >> 1 );
+		break;
+		case 4: // paeth
+			for( size_t i = 0; i < bpp; ++i )
+				out[i] = cur[i] - prev[i];
+			for( size_t i = bpp; i < len; ++i )
+				out[i] = cur[i] - paeth( cur[i - bpp], prev[i], prev[i - bpp] );
+		break;
+	}
+}
+
+// Filters rows [\a rowBegin, \a rowEnd) of \a data into \a filtered, choosing for each row the filter whose output has the smallest sum of absolute values, like stb_image_write
+void filterPngRows( const uint8_t *data, size_t rowBytes, size_t bpp, int32_t rowBegin, int32_t rowEnd, uint8_t *filtered )
+{
+	std::vector<uint8_t> trial( rowBytes ), zeroRow( ( rowBegin == 0 ) ? rowBytes : 0, 0 );
+	for( int32_t row = rowBegin; row < rowEnd; ++row ) {
+		const uint8_t *cur = data + row * rowBytes;
+		const uint8_t *prev = ( row > 0 ) ? cur - rowBytes : zeroRow.data();
+		uint8_t *out = filtered + row * ( rowBytes + 1 );
+		uint32_t bestSum = std::numeric_limits<uint32_t>::max();
+		for( int type = 0; type < 5; ++type ) {
+			filterPngRow( type, cur, prev, bpp, rowBytes, trial.data() );
+			uint32_t sum = 0;
+			for( size_t i = 0; i < rowBytes; ++i )
+				sum += std::abs( (int8_t)trial[i] );
+			if( sum < bestSum ) {
+				bestSum = sum;
+				out[0] = (uint8_t)type;
+				std::memcpy( out + 1, trial.data(), rowBytes );
+			}
+		}
+	}
+}
+
+// Appends \a size bytes of \a data to \a out as a raw deflate stream primed with \a dictionary. All but the \a last strip end in a
+// byte-aligned sync flush rather than a final block, so that the strips concatenate into a single valid stream.
+void deflateStrip( const uint8_t *data, size_t size, const uint8_t *dictionary, size_t dictionarySize, bool last, std::vector<uint8_t> *out )
+{
+	z_stream stream;
+	std::memset( &stream, 0, sizeof( stream ) );
+	if( deflateInit2( &stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+		throw ImageIoExceptionFailedWrite( "Failed to initialize zlib" );
+	if( dictionarySize )
+		deflateSetDictionary( &stream, dictionary, (uInt)dictionarySize );
+
+	// the sync flush marker is the only output deflateBound() does not account for
+	const size_t offset = out->size();
+	out->resize( offset + deflateBound( &stream, (uLong)size ) + 16 );
+	stream.next_in = const_cast<Bytef*>( data );
+	stream.avail_in = (uInt)size;
+	stream.next_out = out->data() + offset;
+	stream.avail_out = (uInt)( out->size() - offset );
+	int result = deflate( &stream, last ? Z_FINISH : Z_SYNC_FLUSH );
+	out->resize( offset + stream.total_out );
+	deflateEnd( &stream );
+
+	if( result != ( last ? Z_STREAM_END : Z_OK ) || stream.avail_in != 0 )
+		throw ImageIoExceptionFailedWrite( "Failed to compress PNG data" );
+}
+
+void writeBigEndian32( uint32_t value, uint8_t *dst )
+{
+	dst[0] = (uint8_t)( value >> 24 );
+	dst[1] = (uint8_t)( value >> 16 );
+	dst[2] = (uint8_t)( value >> 8 );
+	dst[3] = (uint8_t)value;
+}
+
+void writePngChunk( OStream *stream, const char *type, const uint8_t *data, size_t size )
+{
+	uint8_t header[8], footer[4];
+	writeBigEndian32( (uint32_t)size, header );
+	std::memcpy( header + 4, type, 4 );
+	uLong crc = crc32( 0, header + 4, 4 );
+	if( size )
+		crc = crc32( crc, data, (uInt)size );
+	writeBigEndian32( (uint32_t)crc, footer );
+
+	stream->writeData( header, 8 );
+	if( size )
+		stream->writeData( data, size );
+	stream->writeData( footer, 4 );
+}
+
+void stbWriteToVector( void *context, void *data, int size )
+{
+	std::vector<uint8_t> *vec = reinterpret_cast<std::vector<uint8_t> *>( context );
+	vec->insert( vec->end(), reinterpret_cast<uint8_t*>( data ), reinterpret_cast<uint8_t*>( data ) + size );
+}
+
+} // anonymous namespace
+
 void ImageTargetFileStbImage::registerSelf()
 {
 	static bool alreadyRegistered = false;
@@ -52,7 +190,7 @@ ImageTargetRef ImageTargetFileStbImage::create( DataTargetRef dataTarget, ImageS
 }
 
 ImageTargetFileStbImage::ImageTargetFileStbImage( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string &extensionData )
-	: mDataTarget( dataTarget )
+	: mNumThreads( options.getNumThreads() ), mDataTarget( dataTarget )
 {
 	if( ! ( mDataTarget->providesFilePath() || mDataTarget->getStream() ) ) {
 		throw ImageIoExceptionFailedWrite( "No file path or stream provided" );
@@ -83,7 +221,7 @@ ImageTargetFileStbImage::ImageTargetFileStbImage( DataTargetRef dataTarget, Imag
 	}
 	else {
 		setDataType( ImageIo::DataType::UINT8 );
-		mRowBytes = mNumComponents * imageSource->getWidth() * sizeof(float);
+		mRowBytes = mNumComponents * imageSource->getWidth() * sizeof(uint8_t);
 	}
 
 	if( mDataTarget->providesFilePath() ) {
@@ -106,7 +244,19 @@ void stbWriteToStream( void *context, void *data, int size )
 
 void ImageTargetFileStbImage::finalize()
 {
-	if( ! mFilePath.empty() ) {
+	if( mNumThreads != 1 && ( mExtension == "png" || mExtension == "hdr" ) ) {
+		if( mWidth <= 0 || mHeight <= 0 )
+			throw ImageIoExceptionFailedWrite();
+		OStreamRef stream = mDataTarget->getStream();
+		if( ! stream )
+			throw ImageIoExceptionFailedWrite( "Failed to open stream" );
+
+		if( mExtension == "png" )
+			writePngParallel( stream.get() );
+		else
+			writeHdrParallel( stream.get() );
+	}
+	else if( ! mFilePath.empty() ) {
 		if( mExtension == "png" ) {
 			if( ! stbi_write_png( mFilePath.string().c_str(), (int)mWidth, (int)mHeight, mNumComponents, mData.get(), (int)mRowBytes ) )
 				throw ImageIoExceptionFailedWrite();
@@ -145,4 +295,83 @@ void ImageTargetFileStbImage::finalize()
 	}
 }
 
+void ImageTargetFileStbImage::writePngParallel( OStream *stream )
+{
+	const int numThreads = ip::getNumThreads( mNumThreads );
+	const size_t filteredRowBytes = mRowBytes + 1;
+
+	// filtering only reads the previous row of the source, so rows can be filtered in any order
+	std::unique_ptr<uint8_t[]> filtered( new uint8_t[mHeight * filteredRowBytes] );
+	ip::parallelForRows( 0, mHeight, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		filterPngRows( mData.get(), mRowBytes, mNumComponents, rowBegin, rowEnd, filtered.get() );
+	} );
+
+	const int32_t rowsPerStrip = std::max<int32_t>( 1, int32_t( STRIP_BYTES / filteredRowBytes ) );
+	const int32_t numStrips = ( mHeight + rowsPerStrip - 1 ) / rowsPerStrip;
+	std::vector<std::vector<uint8_t>> strips( numStrips );
+	std::vector<uLong> adlers( numStrips );
+	strips[0] = { 0x78, 0x9C }; // zlib header: deflate, 32K window, default compression
+	ip::parallelForRows( 0, numStrips, numThreads, [&]( int32_t stripBegin, int32_t stripEnd ) {
+		for( int32_t s = stripBegin; s < stripEnd; ++s ) {
+			const size_t begin = s * rowsPerStrip * filteredRowBytes;
+			const size_t end = std::min<int32_t>( ( s + 1 ) * rowsPerStrip, mHeight ) * filteredRowBytes;
+			const size_t dictionarySize = std::min( begin, PNG_DICTIONARY_BYTES );
+			deflateStrip( filtered.get() + begin, end - begin, filtered.get() + begin - dictionarySize, dictionarySize, s == numStrips - 1, &strips[s] );
+			adlers[s] = adler32( adler32( 0, nullptr, 0 ), filtered.get() + begin, (uInt)( end - begin ) );
+		}
+	}, 1 );
+
+	// the zlib trailer is the adler32 of all of the filtered data
+	uLong adler = adlers[0];
+	for( int32_t s = 1; s < numStrips; ++s ) {
+		const size_t stripSize = ( std::min<int32_t>( ( s + 1 ) * rowsPerStrip, mHeight ) - s * rowsPerStrip ) * filteredRowBytes;
+		adler = adler32_combine( adler, adlers[s], (z_off_t)stripSize );
+	}
+	strips.back().resize( strips.back().size() + 4 );
+	writeBigEndian32( (uint32_t)adler, &strips.back()[strips.back().size() - 4] );
+
+	static const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	static const uint8_t colorTypes[5] = { 0, 0, 4, 2, 6 };
+	stream->writeData( signature, 8 );
+
+	uint8_t header[13];
+	writeBigEndian32( (uint32_t)mWidth, header );
+	writeBigEndian32( (uint32_t)mHeight, header + 4 );
+	header[8] = 8; // bit depth
+	header[9] = colorTypes[mNumComponents];
+	header[10] = header[11] = header[12] = 0; // deflate, adaptive filtering, no interlace
+	writePngChunk( stream, "IHDR", header, 13 );
+
+	// decoders treat consecutive IDAT chunks as one stream, so each strip can be its own chunk
+	for( const auto &strip : strips )
+		writePngChunk( stream, "IDAT", strip.data(), strip.size() );
+	writePngChunk( stream, "IEND", nullptr, 0 );
+}
+
+void ImageTargetFileStbImage::writeHdrParallel( OStream *stream )
+{
+	// same header as stbi_write_hdr()
+	char header[256];
+	int headerLength = sprintf( header, "#?RADIANCE\n# Written by stb_image_write.h\nFORMAT=32-bit_rle_rgbe\nEXPOSURE=          1.0000000000000\n\n-Y %d +X %d\n", mHeight, mWidth );
+	stream->writeData( header, headerLength );
+
+	// scanlines are run-length encoded independently of each other
+	const int32_t rowsPerStrip = std::max<int32_t>( 1, int32_t( STRIP_BYTES / mRowBytes ) );
+	const int32_t numStrips = ( mHeight + rowsPerStrip - 1 ) / rowsPerStrip;
+	std::vector<std::vector<uint8_t>> strips( numStrips );
+	ip::parallelForRows( 0, numStrips, ip::getNumThreads( mNumThreads ), [&]( int32_t stripBegin, int32_t stripEnd ) {
+		std::vector<unsigned char> scratch( mWidth * 4 );
+		for( int32_t s = stripBegin; s < stripEnd; ++s ) {
+			stbi__write_context context;
+			stbi__start_write_callbacks( &context, stbWriteToVector, &strips[s] );
+			const int32_t rowEnd = std::min<int32_t>( ( s + 1 ) * rowsPerStrip, mHeight );
+			for( int32_t row = s * rowsPerStrip; row < rowEnd; ++row )
+				stbiw__write_hdr_scanline( &context, mWidth, mNumComponents, scratch.data(), reinterpret_cast<float*>( &mData.get()[row * mRowBytes] ) );
+		}
+	}, 1 );
+
+	for( const auto &strip : strips )
+		stream->writeData( strip.data(), strip.size() );
+}
+
 } // namespace cinder
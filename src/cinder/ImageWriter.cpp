@@ -0,0 +1,173 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ImageWriter.h"
+
+#include <algorithm>
+
+namespace cinder {
+
+ImageWriterRef ImageWriter::getDefault()
+{
+	static ImageWriterRef sDefault = ImageWriter::create();
+	return sDefault;
+}
+
+ImageWriter::ImageWriter( const Format &format )
+	: mFormat( format ), mNumInFlight( 0 ), mNumDropped( 0 ), mQuit( false )
+{
+	// leave a core for the thread making the requests
+	int numThreads = format.getNumThreads();
+	if( numThreads <= 0 )
+		numThreads = std::max<int>( 1, (int)std::thread::hardware_concurrency() - 1 );
+
+	for( int t = 0; t < numThreads; ++t )
+		mThreads.emplace_back( &ImageWriter::workerThread, this );
+}
+
+ImageWriter::~ImageWriter()
+{
+	// unlike loads, queued writes are never discarded
+	flush();
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mQuit = true;
+	}
+	mWorkAvailable.notify_all();
+
+	for( auto &thread : mThreads )
+		thread.join();
+}
+
+std::future<void> ImageWriter::write( const fs::path &path, const ImageSourceRef &imageSource, const ImageTarget::Options &options, const std::string &extension )
+{
+	Request request;
+	request.mPath = path;
+	request.mImageSource = imageSource;
+	request.mOptions = options;
+	request.mExtension = extension;
+	return enqueue( std::move( request ) );
+}
+
+std::future<void> ImageWriter::write( const DataTargetRef &dataTarget, const ImageSourceRef &imageSource, const ImageTarget::Options &options, const std::string &extension )
+{
+	Request request;
+	request.mDataTarget = dataTarget;
+	request.mImageSource = imageSource;
+	request.mOptions = options;
+	request.mExtension = extension;
+	return enqueue( std::move( request ) );
+}
+
+std::future<void> ImageWriter::enqueue( Request &&request )
+{
+	request.mPromise = std::make_shared<std::promise<void>>();
+	std::future<void> result = request.mPromise->get_future();
+
+	std::unique_lock<std::mutex> lock( mMutex );
+	const size_t maxPending = mFormat.getMaxPending();
+	if( maxPending > 0 && mPending.size() >= maxPending ) {
+		if( mFormat.isBlockWhenFull() )
+			mRoomAvailable.wait( lock, [this, maxPending] { return mPending.size() < maxPending; } );
+		else {
+			++mNumDropped;
+			request.mPromise->set_exception( std::make_exception_ptr( ImageWriterExceptionDropped() ) );
+			return result;
+		}
+	}
+
+	mPending.push_back( std::move( request ) );
+	lock.unlock();
+	mWorkAvailable.notify_one();
+	return result;
+}
+
+void ImageWriter::flush()
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	mIdle.wait( lock, [this] { return mPending.empty() && mNumInFlight == 0; } );
+}
+
+size_t ImageWriter::getNumPending() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mPending.size();
+}
+
+size_t ImageWriter::getNumInFlight() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mNumInFlight;
+}
+
+size_t ImageWriter::getNumDropped() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mNumDropped;
+}
+
+void ImageWriter::workerThread()
+{
+	ThreadSetup threadSetup;
+
+	while( true ) {
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock( mMutex );
+			mWorkAvailable.wait( lock, [this] { return mQuit || ! mPending.empty(); } );
+			if( mQuit )
+				return;
+
+			request = std::move( mPending.front() );
+			mPending.pop_front();
+			++mNumInFlight;
+		}
+		mRoomAvailable.notify_one();
+
+		try {
+			if( request.mDataTarget )
+				writeImage( request.mDataTarget, request.mImageSource, request.mOptions, request.mExtension );
+			else
+				writeImage( request.mPath, request.mImageSource, request.mOptions, request.mExtension );
+			request.mPromise->set_value();
+		}
+		catch( ... ) {
+			request.mPromise->set_exception( std::current_exception() );
+		}
+
+		// release the image before reporting idle, so flush() also means the memory is free
+		request = Request();
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			--mNumInFlight;
+		}
+		mIdle.notify_all();
+	}
+}
+
+std::future<void> writeImageAsync( const fs::path &path, const ImageSourceRef &imageSource, const ImageTarget::Options &options, const std::string &extension )
+{
+	return ImageWriter::getDefault()->write( path, imageSource, options, extension );
+}
+
+} // namespace cinder
@@ -0,0 +1,239 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/PixelAllocator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#if defined( CINDER_MSW ) || defined( CINDER_UWP )
+	#include <malloc.h>
+#endif
+
+namespace cinder {
+
+namespace {
+
+class PixelAllocatorHeap : public PixelAllocator {
+  public:
+	std::shared_ptr<void> allocate( size_t numBytes ) override
+	{
+		void *data = alignedMalloc( numBytes );
+		if( ! data )
+			throw std::bad_alloc();
+		return std::shared_ptr<void>( data, &PixelAllocator::alignedFree );
+	}
+};
+
+std::mutex				sAllocatorMutex;
+PixelAllocatorRef		sAllocator;
+// incremented by every call to set(), under sAllocatorMutex
+std::atomic<uint32_t>	sAllocatorGeneration( 0 );
+
+#if ! defined( _MSC_VER ) || ( _MSC_VER >= 1900 )
+	#define CINDER_PIXEL_ALLOCATOR_THREAD_CACHE
+// Each thread's copy of the installed allocator, which lets get() skip sAllocatorMutex until set() is called again
+struct ThreadAllocatorCache {
+	uint32_t			mGeneration = UINT32_MAX;
+	PixelAllocatorRef	mAllocator;
+};
+
+thread_local ThreadAllocatorCache sThreadAllocatorCache;
+#endif
+
+} // anonymous namespace
+
+void* PixelAllocator::alignedMalloc( size_t numBytes )
+{
+	// zero-sized Surfaces still receive unique, non-null storage as they did with new[]
+	if( numBytes == 0 )
+		numBytes = 1;
+#if defined( CINDER_MSW ) || defined( CINDER_UWP )
+	return _aligned_malloc( numBytes, ALIGNMENT );
+#else
+	void *result = nullptr;
+	if( posix_memalign( &result, ALIGNMENT, numBytes ) != 0 )
+		return nullptr;
+	return result;
+#endif
+}
+
+void PixelAllocator::alignedFree( void *data )
+{
+#if defined( CINDER_MSW ) || defined( CINDER_UWP )
+	_aligned_free( data );
+#else
+	free( data );
+#endif
+}
+
+PixelAllocatorRef PixelAllocator::getHeap()
+{
+	static PixelAllocatorRef sHeap = std::make_shared<PixelAllocatorHeap>();
+	return sHeap;
+}
+
+PixelAllocatorRef PixelAllocator::get()
+{
+#if defined( CINDER_PIXEL_ALLOCATOR_THREAD_CACHE )
+	ThreadAllocatorCache &cache = sThreadAllocatorCache;
+	if( cache.mGeneration != sAllocatorGeneration.load( std::memory_order_acquire ) ) {
+		std::lock_guard<std::mutex> lock( sAllocatorMutex );
+		cache.mAllocator = sAllocator ? sAllocator : getHeap();
+		cache.mGeneration = sAllocatorGeneration.load( std::memory_order_relaxed );
+	}
+	return cache.mAllocator;
+#else
+	// Visual Studio 2013 lacks thread_local for types with destructors
+	std::lock_guard<std::mutex> lock( sAllocatorMutex );
+	return sAllocator ? sAllocator : getHeap();
+#endif
+}
+
+void PixelAllocator::set( const PixelAllocatorRef &allocator )
+{
+	std::lock_guard<std::mutex> lock( sAllocatorMutex );
+	sAllocator = allocator;
+	sAllocatorGeneration.fetch_add( 1, std::memory_order_release );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PixelPool
+PixelPool::PixelPool( size_t maxFreeBytes )
+	: mState( std::make_shared<State>() )
+{
+	mState->mFreeBytes = 0;
+	mState->mMaxFreeBytes = maxFreeBytes;
+	mState->mNumReused = mState->mNumAllocated = 0;
+}
+
+std::shared_ptr<void> PixelPool::allocate( size_t numBytes )
+{
+	void *data = nullptr;
+	{
+		std::lock_guard<std::mutex> lock( mState->mMutex );
+		auto freeIt = mState->mFree.find( numBytes );
+		if( freeIt != mState->mFree.end() && ! freeIt->second.empty() ) {
+			data = freeIt->second.back();
+			freeIt->second.pop_back();
+			mState->mFreeBytes -= numBytes;
+			++mState->mNumReused;
+		}
+		else
+			++mState->mNumAllocated;
+	}
+
+	if( ! data ) {
+		data = alignedMalloc( numBytes );
+		if( ! data )
+			throw std::bad_alloc();
+	}
+
+	std::weak_ptr<State> weakState = mState;
+	return std::shared_ptr<void>( data, [weakState, numBytes]( void *p ) {
+		auto state = weakState.lock();
+		if( state )
+			state->release( p, numBytes );
+		else
+			alignedFree( p );
+	} );
+}
+
+void PixelPool::clear()
+{
+	std::lock_guard<std::mutex> lock( mState->mMutex );
+	for( auto &sizeBlocks : mState->mFree )
+		for( void *data : sizeBlocks.second )
+			alignedFree( data );
+	mState->mFree.clear();
+	mState->mFreeBytes = 0;
+}
+
+size_t PixelPool::getNumFreeBytes() const
+{
+	std::lock_guard<std::mutex> lock( mState->mMutex );
+	return mState->mFreeBytes;
+}
+
+size_t PixelPool::getMaxFreeBytes() const
+{
+	std::lock_guard<std::mutex> lock( mState->mMutex );
+	return mState->mMaxFreeBytes;
+}
+
+void PixelPool::setMaxFreeBytes( size_t maxFreeBytes )
+{
+	std::lock_guard<std::mutex> lock( mState->mMutex );
+	mState->mMaxFreeBytes = maxFreeBytes;
+	mState->trim();
+}
+
+size_t PixelPool::getNumReused() const
+{
+	std::lock_guard<std::mutex> lock( mState->mMutex );
+	return mState->mNumReused;
+}
+
+size_t PixelPool::getNumAllocated() const
+{
+	std::lock_guard<std::mutex> lock( mState->mMutex );
+	return mState->mNumAllocated;
+}
+
+PixelPool::State::~State()
+{
+	for( auto &sizeBlocks : mFree )
+		for( void *data : sizeBlocks.second )
+			alignedFree( data );
+}
+
+void PixelPool::State::release( void *data, size_t numBytes )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	if( numBytes > mMaxFreeBytes ) {
+		alignedFree( data );
+		return;
+	}
+
+	mFree[numBytes].push_back( data );
+	mFreeBytes += numBytes;
+	trim();
+}
+
+// frees the largest blocks first until the free list fits in mMaxFreeBytes; requires mMutex to be locked
+void PixelPool::State::trim()
+{
+	while( mFreeBytes > mMaxFreeBytes && ! mFree.empty() ) {
+		auto largest = std::prev( mFree.end() );
+		while( ! largest->second.empty() && mFreeBytes > mMaxFreeBytes ) {
+			alignedFree( largest->second.back() );
+			largest->second.pop_back();
+			mFreeBytes -= largest->first;
+		}
+		if( largest->second.empty() )
+			mFree.erase( largest );
+	}
+}
+
+} // namespace cinder
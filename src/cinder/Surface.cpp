@@ -39,6 +39,8 @@
 #include "cinder/ChanTraits.h"
 #include "cinder/ImageIo.h"
 #include "cinder/ip/Fill.h"
+#include "cinder/ip/Convert.h"
+#include "cinder/ip/Resize.h"
 
 #include <boost/preprocessor/seq.hpp>
 #include <boost/type_traits/is_same.hpp>
@@ -55,6 +57,7 @@ class ImageTargetSurface : public ImageTarget {
 	virtual bool hasAlpha() const;
 	
 	virtual void*	getRowPointer( int32_t row );
+	virtual bool	supportsParallelRows() const	{ return true; }
 	
   protected:
 	ImageTargetSurface( SurfaceT<T> *surface );
@@ -62,6 +65,25 @@ class ImageTargetSurface : public ImageTarget {
 	SurfaceT<T>		*mSurface;
 };
 
+// Receives decoded rows at the source's full width in a scratch row laid out like the Surface, and feeds each one to an ip::ResizeStream once the source moves on to the next row
+template<typename T>
+class ImageTargetSurfaceResize : public ImageTargetSurface<T> {
+  public:
+	static std::shared_ptr<ImageTargetSurfaceResize<T> > createRef( SurfaceT<T> *surface, const ivec2 &srcSize, const FilterBase &filter, bool fillAlpha )
+	{ return std::shared_ptr<ImageTargetSurfaceResize<T> >( new ImageTargetSurfaceResize<T>( surface, srcSize, filter, fillAlpha ) ); }
+
+	virtual void*	getRowPointer( int32_t row );
+	virtual void	finalize();
+	virtual bool	supportsParallelRows() const	{ return false; }
+
+  protected:
+	ImageTargetSurfaceResize( SurfaceT<T> *surface, const ivec2 &srcSize, const FilterBase &filter, bool fillAlpha );
+
+	ip::ResizeStream<T>		mResizeStream;
+	std::unique_ptr<T[]>	mRow;
+	int32_t					mCurrentRow;
+};
+
 class ImageSourceSurface : public ImageSource {
   public:
 	template<typename T>
@@ -196,6 +218,14 @@ void SurfaceT<T>::initChannels()
 		mChannels[SurfaceChannelOrder::CHAN_ALPHA] = ChannelT<T>( mWidth, mHeight, mRowBytes, mChannelOrder.getPixelInc(), mData + mChannelOrder.getAlphaOffset(), mDataStore );
 }
 
+template<typename T>
+void SurfaceT<T>::allocateData( const PixelAllocatorRef &allocator )
+{
+	std::shared_ptr<void> block = ( allocator ? allocator : PixelAllocator::get() )->allocate( mHeight * mRowBytes );
+	mDataStore = std::shared_ptr<T>( block, static_cast<T*>( block.get() ) );
+	mData = mDataStore.get();
+}
+
 template<typename T>
 void SurfaceT<T>::setChannelOrder( const SurfaceChannelOrder &aChannelOrder )
 {
@@ -213,8 +243,7 @@ template<typename T>
 SurfaceT<T>::SurfaceT( const SurfaceT<T> &rhs )
 	: mWidth( rhs.mWidth ), mHeight( rhs.mHeight ), mChannelOrder( rhs.mChannelOrder ), mRowBytes( rhs.mRowBytes ), mPremultiplied( rhs.mPremultiplied )
 {
-	mDataStore = std::shared_ptr<T>( new T[mHeight * mRowBytes], std::default_delete<T[]>() );
-	mData = mDataStore.get();
+	allocateData();
 	initChannels();
 	copyFrom( rhs, Area( 0, 0, mWidth, mHeight ) );
 }
@@ -237,8 +266,7 @@ SurfaceT<T>::SurfaceT( int32_t width, int32_t height, bool alpha, SurfaceChannel
 		mChannelOrder = ( alpha ) ? SurfaceChannelOrder::RGBA : SurfaceChannelOrder::RGB;
 	mPremultiplied = false;
 	mRowBytes = width * sizeof(T) * mChannelOrder.getPixelInc();
-	mDataStore = std::shared_ptr<T>( new T[height * mRowBytes], std::default_delete<T[]>() );
-	mData = mDataStore.get();
+	allocateData();
 	initChannels();
 }
 
@@ -249,8 +277,7 @@ SurfaceT<T>::SurfaceT( int32_t width, int32_t height, bool alpha, const SurfaceC
 	mChannelOrder = constraints.getChannelOrder( alpha );
 	mPremultiplied = false;
 	mRowBytes = constraints.getRowBytes( width, mChannelOrder, sizeof(T) );
-	mDataStore = std::shared_ptr<T>( new T[height * mRowBytes], std::default_delete<T[]>() );
-	mData = mDataStore.get();
+	allocateData( constraints.getAllocator() );
 	initChannels();
 }
 
@@ -268,6 +295,12 @@ SurfaceT<T>::SurfaceT( ImageSourceRef imageSource, const SurfaceConstraints &con
 	init( imageSource, constraints, alpha );
 }
 
+template<typename T>
+SurfaceT<T>::SurfaceT( ImageSourceRef imageSource, const ivec2 &size, const FilterBase &filter, const SurfaceConstraints &constraints, boost::tribool alpha )
+{
+	init( imageSource, constraints, alpha, size, &filter );
+}
+
 #if defined( CINDER_UWP )
 
 template<typename T>
@@ -309,9 +342,7 @@ SurfaceT<T>& SurfaceT<T>::operator=( const SurfaceT<T> &rhs )
 	mChannelOrder = rhs.mChannelOrder;
 	mRowBytes = rhs.mRowBytes;
 	mPremultiplied = rhs.mPremultiplied;
-	mDataStore = std::shared_ptr<T>( new T[mHeight * mRowBytes], std::default_delete<T[]>() );
-	
-	mData = mDataStore.get();
+	allocateData();
 	initChannels();
 	
 	copyFrom( rhs, Area( 0, 0, mWidth, mHeight ) );
@@ -370,10 +401,12 @@ SurfaceT<T> SurfaceT<T>::clone( const Area &area, bool copyPixels ) const
 }
 
 template<typename T>
-void SurfaceT<T>::init( ImageSourceRef imageSource, const SurfaceConstraints &constraints, boost::tribool alpha )
+void SurfaceT<T>::init( ImageSourceRef imageSource, const SurfaceConstraints &constraints, boost::tribool alpha, const ivec2 &size, const FilterBase *filter )
 {
-	mWidth = imageSource->getWidth();
-	mHeight = imageSource->getHeight();
+	const ivec2 srcSize( imageSource->getWidth(), imageSource->getHeight() );
+	const bool resample = filter && ( size != srcSize );
+	mWidth = resample ? size.x : srcSize.x;
+	mHeight = resample ? size.y : srcSize.y;
 	bool hasAlpha;
 	if( alpha )
 		hasAlpha = true;
@@ -384,19 +417,24 @@ void SurfaceT<T>::init( ImageSourceRef imageSource, const SurfaceConstraints &co
 
 	mChannelOrder = constraints.getChannelOrder( hasAlpha );
 	mRowBytes = constraints.getRowBytes( mWidth, mChannelOrder, sizeof(T) );
-	
-	mDataStore = std::shared_ptr<T>( new T[mHeight * mRowBytes], std::default_delete<T[]>() );
-	mData = mDataStore.get();
+	allocateData( constraints.getAllocator() );
 
 	mPremultiplied = imageSource->isPremultiplied();
-	
-	std::shared_ptr<ImageTargetSurface<T> > target = ImageTargetSurface<T>::createRef( this );
-	imageSource->load( target );
-	
 	initChannels();
-	// if the image doesn't have alpha but we do, set the alpha to 1.0
-	if( hasAlpha && ( ! imageSource->hasAlpha() ) )
-		ip::fill( &getChannelAlpha(), CHANTRAIT<T>::max() );
+
+	const bool fillAlpha = hasAlpha && ( ! imageSource->hasAlpha() );
+	if( resample ) {
+		std::shared_ptr<ImageTargetSurfaceResize<T> > target = ImageTargetSurfaceResize<T>::createRef( this, srcSize, *filter, fillAlpha );
+		imageSource->load( target );
+		target->finalize();
+	}
+	else {
+		std::shared_ptr<ImageTargetSurface<T> > target = ImageTargetSurface<T>::createRef( this );
+		imageSource->load( target );
+		// if the image doesn't have alpha but we do, set the alpha to 1.0
+		if( fillAlpha )
+			ip::fill( &getChannelAlpha(), CHANTRAIT<T>::max() );
+	}
 }
 
 template<typename T>
@@ -406,12 +444,8 @@ void SurfaceT<T>::copyFrom( const SurfaceT<T> &srcSurface, const Area &srcArea,
 	
 	if( getChannelOrder() == srcSurface.getChannelOrder() )
 		copyRawSameChannelOrder( srcSurface, srcDst.first, srcDst.second );
-	else if( hasAlpha() && srcSurface.hasAlpha() )
-		copyRawRgba( srcSurface, srcDst.first, srcDst.second );
-	else if( hasAlpha() && ( ! srcSurface.hasAlpha() ) )
-		copyRawRgbFullAlpha( srcSurface, srcDst.first, srcDst.second );
 	else
-		copyRawRgb( srcSurface, srcDst.first, srcDst.second );
+		ip::convert( srcSurface, srcDst.first, this, srcDst.second );
 }
 
 template<typename T>
@@ -428,96 +462,6 @@ void SurfaceT<T>::copyRawSameChannelOrder( const SurfaceT<T> &srcSurface, const
 	}
 }
 
-template<typename T>
-void SurfaceT<T>::copyRawRgba( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &absoluteOffset )
-{
-	const ptrdiff_t srcRowBytes = srcSurface.getRowBytes();
-	uint8_t srcRed = srcSurface.getChannelOrder().getRedOffset();
-	uint8_t srcGreen = srcSurface.getChannelOrder().getGreenOffset();
-	uint8_t srcBlue = srcSurface.getChannelOrder().getBlueOffset();
-	uint8_t srcAlpha = srcSurface.getChannelOrder().getAlphaOffset();
-
-	uint8_t dstRed = getChannelOrder().getRedOffset();
-	uint8_t dstGreen = getChannelOrder().getGreenOffset();
-	uint8_t dstBlue = getChannelOrder().getBlueOffset();
-	uint8_t dstAlpha = getChannelOrder().getAlphaOffset();
-
-	int32_t width = srcArea.getWidth();
-
-	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
-		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * 4 ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
-			dst[dstRed] = src[srcRed];
-			dst[dstGreen] = src[srcGreen];
-			dst[dstBlue] = src[srcBlue];
-			dst[dstAlpha] = src[srcAlpha];
-			src += 4;
-			dst += 4;
-		}
-	}
-}
-
-template<typename T>
-void SurfaceT<T>::copyRawRgbFullAlpha( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &absoluteOffset )
-{
-	const ptrdiff_t srcRowBytes = srcSurface.getRowBytes();
-	const uint8_t srcPixelInc = srcSurface.getPixelInc();
-	uint8_t srcRed = srcSurface.getChannelOrder().getRedOffset();
-	uint8_t srcGreen = srcSurface.getChannelOrder().getGreenOffset();
-	uint8_t srcBlue = srcSurface.getChannelOrder().getBlueOffset();
-	const T fullAlpha = CHANTRAIT<T>::max();
-
-	uint8_t dstRed = getChannelOrder().getRedOffset();
-	uint8_t dstGreen = getChannelOrder().getGreenOffset();
-	uint8_t dstBlue = getChannelOrder().getBlueOffset();
-	uint8_t dstAlpha = getChannelOrder().getAlphaOffset();
-
-	int32_t width = srcArea.getWidth();
-
-	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
-		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * 4 ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
-			dst[dstRed] = src[srcRed];
-			dst[dstGreen] = src[srcGreen];
-			dst[dstBlue] = src[srcBlue];
-			dst[dstAlpha] = fullAlpha;
-			src += srcPixelInc;
-			dst += 4;
-		}
-	}
-}
-
-template<typename T>
-void SurfaceT<T>::copyRawRgb( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &absoluteOffset )
-{
-	const ptrdiff_t srcRowBytes = srcSurface.getRowBytes();
-	const uint8_t srcPixelInc = srcSurface.getPixelInc();
-	const uint8_t srcRed = srcSurface.getChannelOrder().getRedOffset();
-	const uint8_t srcGreen = srcSurface.getChannelOrder().getGreenOffset();
-	const uint8_t srcBlue = srcSurface.getChannelOrder().getBlueOffset();
-
-	const uint8_t dstPixelInc = getPixelInc();
-	const uint8_t dstRed = getChannelOrder().getRedOffset();
-	const uint8_t dstGreen = getChannelOrder().getGreenOffset();
-	const uint8_t dstBlue = getChannelOrder().getBlueOffset();
-
-	int32_t width = srcArea.getWidth();
-
-	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * srcPixelInc ) + ( srcArea.y1 + y ) * srcRowBytes );
-		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * dstPixelInc ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
-			dst[dstRed] = src[srcRed];
-			dst[dstGreen] = src[srcGreen];
-			dst[dstBlue] = src[srcBlue];
-			src += srcPixelInc;
-			dst += dstPixelInc;
-		}
-	}
-}
-
 template<typename T>
 ColorT<T> SurfaceT<T>::areaAverage( const Area &area ) const
 {
@@ -612,6 +556,45 @@ void* ImageTargetSurface<T>::getRowPointer( int32_t row )
 	return reinterpret_cast<void*>( mSurface->getData( ivec2( 0, row ) ) );
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ImageTargetSurfaceResize
+template<typename T>
+ImageTargetSurfaceResize<T>::ImageTargetSurfaceResize( SurfaceT<T> *surface, const ivec2 &srcSize, const FilterBase &filter, bool fillAlpha )
+	: ImageTargetSurface<T>( surface ), mResizeStream( srcSize, surface, filter ), mCurrentRow( -1 )
+{
+	const uint8_t pixelInc = surface->getPixelInc();
+	mRow = std::unique_ptr<T[]>( new T[srcSize.x * pixelInc]() );
+
+	// the row functions don't write alpha the source doesn't have, so it's set once here and survives every row
+	if( fillAlpha ) {
+		T *alpha = mRow.get() + surface->getAlphaOffset();
+		for( int32_t x = 0; x < srcSize.x; ++x, alpha += pixelInc )
+			*alpha = CHANTRAIT<T>::max();
+	}
+}
+
+template<typename T>
+void* ImageTargetSurfaceResize<T>::getRowPointer( int32_t row )
+{
+	if( row != mCurrentRow ) {
+		if( mCurrentRow >= 0 )
+			mResizeStream.pushRow( mRow.get() );
+		if( row != mResizeStream.getNumRowsPushed() )
+			throw ImageIoException( "Resizing while loading requires an ImageSource which supplies its rows in order." );
+		mCurrentRow = row;
+	}
+
+	return reinterpret_cast<void*>( mRow.get() );
+}
+
+template<typename T>
+void ImageTargetSurfaceResize<T>::finalize()
+{
+	if( mCurrentRow >= 0 )
+		mResizeStream.pushRow( mRow.get() );
+	mCurrentRow = -1;
+}
+
 #define Surface_PROTOTYPES(r,data,T)\
 	template class SurfaceT<T>;
 
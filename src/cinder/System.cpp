@@ -63,6 +63,13 @@
 
 #if defined( __clang__ ) || defined( __GNUC__ )
 	#include <cxxabi.h>
+	#if defined( __i386__ ) || defined( __x86_64__ )
+		#define CINDER_GCC_X86
+	#endif
+#endif
+
+#if defined( CINDER_MSW ) && ( defined( _M_IX86 ) || defined( _M_X64 ) )
+	#include <intrin.h>
 #endif
 
 #include <string>
@@ -278,6 +285,8 @@ bool System::hasSse2()
 		instance()->mHasSSE2 = ( instance()->mCPUID_EDX & 0x04000000 ) != 0;
 #elif defined( CINDER_UWP )
 		instance()->mHasSSE2 = IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE) != 0;
+#elif defined( CINDER_GCC_X86 )
+		instance()->mHasSSE2 = __builtin_cpu_supports( "sse2" ) != 0;
 #else
 	throw Exception( "Not implemented" );
 #endif
@@ -298,6 +307,8 @@ bool System::hasSse3()
 		instance()->mHasSSE3 = ( instance()->mCPUID_ECX & 0x00000001 ) != 0;
 #elif defined( CINDER_UWP )
 		instance()->mHasSSE3 = IsProcessorFeaturePresent(PF_SSE3_INSTRUCTIONS_AVAILABLE) != 0;
+#elif defined( CINDER_GCC_X86 )
+		instance()->mHasSSE3 = __builtin_cpu_supports( "sse3" ) != 0;
 #else
 		throw Exception( "Not implemented" );
 #endif
@@ -316,6 +327,8 @@ bool System::hasSse4_1()
 		instance()->mHasSSE4_1 = true; // TODO: this is not being tested
 #elif defined( CINDER_MSW_DESKTOP )
 		instance()->mHasSSE4_1 = ( instance()->mCPUID_ECX & ( 1 << 19 ) ) != 0;
+#elif defined( CINDER_GCC_X86 )
+		instance()->mHasSSE4_1 = __builtin_cpu_supports( "sse4.1" ) != 0;
 #else
 		throw Exception( "Not implemented" );
 #endif
@@ -334,6 +347,8 @@ bool System::hasSse4_2()
 		instance()->mHasSSE4_2 = true; // TODO: this is not being tested
 #elif defined( CINDER_MSW_DESKTOP )
 		instance()->mHasSSE4_2 = ( instance()->mCPUID_ECX & ( 1 << 20 ) ) != 0;
+#elif defined( CINDER_GCC_X86 )
+		instance()->mHasSSE4_2 = __builtin_cpu_supports( "sse4.2" ) != 0;
 #else
 		throw Exception( "Not implemented" );
 #endif		
@@ -343,6 +358,36 @@ bool System::hasSse4_2()
 	return instance()->mHasSSE4_2;
 }
 
+bool System::hasAvx2()
+{
+	if( ! instance()->mCachedValues[HAS_AVX2] ) {
+#if defined( CINDER_MAC )
+		instance()->mHasAvx2 = ( getSysCtlValue<int>( "hw.optional.avx2_0" ) == 1 );
+#elif defined( CINDER_MSW ) && ( defined( _M_IX86 ) || defined( _M_X64 ) )
+		// AVX2 requires both the CPUID feature bit and the OS saving the YMM registers, which is reported through XCR0
+		int info[4];
+		__cpuid( info, 0 );
+		bool result = false;
+		if( info[0] >= 7 ) {
+			__cpuid( info, 1 );
+			const bool osxsave = ( info[2] & ( 1 << 27 ) ) != 0;
+			const bool avx = ( info[2] & ( 1 << 28 ) ) != 0;
+			__cpuidex( info, 7, 0 );
+			const bool avx2 = ( info[1] & ( 1 << 5 ) ) != 0;
+			result = osxsave && avx && avx2 && ( ( _xgetbv( 0 ) & 0x6 ) == 0x6 );
+		}
+		instance()->mHasAvx2 = result;
+#elif defined( CINDER_GCC_X86 )
+		instance()->mHasAvx2 = __builtin_cpu_supports( "avx2" ) != 0;
+#else
+		instance()->mHasAvx2 = false;
+#endif
+		instance()->mCachedValues[HAS_AVX2] = true;
+	}
+
+	return instance()->mHasAvx2;
+}
+
 bool System::hasArm()
 {
 	if( ! instance()->mCachedValues[HAS_ARM] ) {
@@ -373,6 +418,8 @@ bool System::hasX86_64()
 		SYSTEM_INFO info;
 		::GetNativeSystemInfo(&info);
 		instance()->mHasX86_64 = info.wProcessorArchitecture == PROCESSOR_ARCHITECTURE_AMD64;
+#elif defined( __x86_64__ )
+		instance()->mHasX86_64 = true;
 #else
 		throw Exception( "Not implemented" );
 #endif		
@@ -22,6 +22,7 @@
 */
 
 #include "cinder/audio/Context.h"
+#include "cinder/audio/GraphScheduler.h"
 #include "cinder/audio/InputNode.h"
 #include "cinder/audio/Utilities.h"
 #include "cinder/audio/dsp/Converter.h"
@@ -29,6 +30,8 @@
 #include "cinder/Cinder.h"
 #include "cinder/app/AppBase.h"
 
+#include <algorithm>
+#include <chrono>
 #include <sstream>
 
 #if defined( CINDER_COCOA )
@@ -135,15 +138,22 @@ void Context::setMaster( Context *masterContext, DeviceManager *deviceManager )
 }
 
 Context::Context()
-	: mEnabled( false ), mAutoPullRequired( false ), mAutoPullCacheDirty( false ), mNumProcessedFrames( 0 )
+	: mEnabled( false ), mNumProcessedFrames( 0 ), mGraphEditDepth( 0 ), mGraphEditPublish( false ), mGraphState( 0 ), mRenderSlotStale( false ),
+		mRetireRequested( false ), mRetireShouldQuit( false )
 {
 }
 
 Context::~Context()
 {
+	destroyRetireThreadImpl();
 	disable();
 	lock_guard<mutex> lock( mMutex );
 	uninitializeAllNodes();
+
+	for( const auto &renderNodes : mRenderAutoPulledNodes ) {
+		for( const auto &node : renderNodes )
+			node->mNumRenderReferences--;
+	}
 }
 
 void Context::enable()
@@ -198,6 +208,8 @@ void Context::uninitializeAllNodes()
 
 void Context::disconnectAllNodes()
 {
+	ScopedGraphEdit edit( this );
+
 	set<NodeRef> traversedNodes;
 	disconnectRecursive( mOutput, traversedNodes );
 
@@ -207,13 +219,20 @@ void Context::disconnectAllNodes()
 
 void Context::setOutput( const OutputNodeRef &output )
 {
+	ScopedGraphEdit edit( this );
+
 	mOutput = output;
+	if( mOutput )
+		mOutput->mIsRenderRoot = true;
+
+	mGraphEditPublish = true;
 }
 
 const OutputNodeRef& Context::getOutput()
 {
 	if( ! mOutput ) {
 		mOutput = createOutputDeviceNode();
+		mOutput->mIsRenderRoot = true;
 	}
 	return mOutput;
 }
@@ -269,9 +288,10 @@ void Context::uninitRecursive( const NodeRef &node, set<NodeRef> &traversedNodes
 
 void Context::addAutoPulledNode( const NodeRef &node )
 {
+	ScopedGraphEdit edit( this );
+
 	mAutoPulledNodes.insert( node );
-	mAutoPullRequired = true;
-	mAutoPullCacheDirty = true;
+	mGraphEditPublish = true;
 
 	// if not done already, allocate a buffer for auto-pulling that is large enough for stereo processing
 	size_t framesPerBlock = getFramesPerBlock();
@@ -281,12 +301,12 @@ void Context::addAutoPulledNode( const NodeRef &node )
 
 void Context::removeAutoPulledNode( const NodeRef &node )
 {
+	ScopedGraphEdit edit( this );
+
 	size_t result = mAutoPulledNodes.erase( node );
 	CI_VERIFY( result );
 
-	mAutoPullCacheDirty = true;
-	if( mAutoPulledNodes.empty() )
-		mAutoPullRequired = false;
+	mGraphEditPublish = true;
 }
 
 void Context::schedule( double when, const NodeRef &node, bool enable, const std::function<void ()> &func )
@@ -304,13 +324,174 @@ void Context::schedule( double when, const NodeRef &node, bool enable, const std
 
 bool Context::isAudioThread() const
 {
-	return mAudioThreadId == std::this_thread::get_id();
+	return mAudioThreadId == std::this_thread::get_id() || ( mGraphScheduler && mGraphScheduler->isWorkerThread() );
+}
+
+void Context::setNumProcessingThreads( size_t numThreads )
+{
+	if( ! numThreads )
+		numThreads = std::max<size_t>( 1, std::thread::hardware_concurrency() );
+
+	if( numThreads == getNumProcessingThreads() )
+		return;
+
+	// the new GraphScheduler's plans are compiled when the edit is published, until then the audio thread pulls serially
+	ScopedGraphEdit edit( this );
+	unique_ptr<GraphScheduler> scheduler( numThreads > 1 ? new GraphScheduler( numThreads ) : nullptr );
+	{
+		lock_guard<mutex> lock( mMutex );
+		mGraphScheduler.swap( scheduler );
+	}
+
+	mGraphEditPublish = true;
+}
+
+size_t Context::getNumProcessingThreads() const
+{
+	return mGraphScheduler ? mGraphScheduler->getNumThreads() : 1;
+}
+
+void Context::beginGraphEdit()
+{
+	mGraphEditMutex.lock();
+	if( mGraphEditDepth++ )
+		return;
+
+	// Withdraw the last published edit if the audio thread hasn't swapped to it yet, in which case this edit adds to it.
+	uint32_t state = mGraphState.load( memory_order_acquire );
+	while( ( state & 2 ) && ! mGraphState.compare_exchange_weak( state, state & 1, memory_order_acq_rel, memory_order_acquire ) )
+		;
+
+	if( state & 2 ) {
+		mGraphEditPublish = true;
+		return;
+	}
+
+	// Otherwise the audio thread now pulls the last edit, so bring the slot it left up to date if the retire thread hasn't already.
+	if( mRenderSlotStale )
+		releaseRetiredNodes( ( state & 1 ) ^ 1 );
+}
+
+void Context::endGraphEdit()
+{
+	CI_ASSERT( mGraphEditDepth );
+
+	if( --mGraphEditDepth == 0 && mGraphEditPublish ) {
+		mGraphEditPublish = false;
+
+		const uint32_t renderSlot = mGraphState.load( memory_order_relaxed ) & 1;
+		const size_t slot = renderSlot ^ 1;
+		writeRenderAutoPulledNodes( slot );
+		if( mGraphScheduler )
+			mGraphScheduler->compile( mOutput, mAutoPulledNodes, slot );
+
+		mGraphState.store( renderSlot | 2, memory_order_release );
+		mRenderSlotStale = true;
+
+		if( ! mRetireThread && ! mRetireShouldQuit )
+			mRetireThread = unique_ptr<thread>( new thread( &Context::retireAsyncImpl, this ) );
+	}
+
+	mGraphEditMutex.unlock();
+}
+
+void Context::publishRenderInputs( Node *node )
+{
+	CI_ASSERT( mGraphEditDepth );
+
+	writeRenderInputs( node, getRenderSlot() ^ 1 );
+	mPublishedNodes[node] = node->shared_from_this();
+	mGraphEditPublish = true;
+}
+
+void Context::writeRenderInputs( Node *node, size_t slot )
+{
+	auto &renderInputs = node->mRenderInputs[slot];
+	for( const auto &input : renderInputs )
+		input->mNumRenderReferences--;
+
+	renderInputs.assign( node->mInputs.begin(), node->mInputs.end() );
+	for( const auto &input : renderInputs )
+		input->mNumRenderReferences++;
+}
+
+void Context::releaseRetiredNodes( size_t slot )
+{
+	for( const auto &published : mPublishedNodes ) {
+		NodeRef node = published.second.lock();
+		if( node )
+			writeRenderInputs( node.get(), slot );
+	}
+
+	mPublishedNodes.clear();
+	writeRenderAutoPulledNodes( slot );
+	if( mGraphScheduler )
+		mGraphScheduler->clearPlans( slot );
+
+	mRenderSlotStale = false;
+}
+
+void Context::retireAsyncImpl()
+{
+	while( true ) {
+		{
+			// The audio thread doesn't take mRetireMutex before notifying, so also wake up periodically in case a notification was missed.
+			unique_lock<mutex> lock( mRetireMutex );
+			mRetireCond.wait_for( lock, chrono::milliseconds( 100 ), [this] { return mRetireShouldQuit || mRetireRequested; } );
+			if( mRetireShouldQuit )
+				return;
+		}
+
+		mRetireRequested = false;
+
+		// Holding mGraphEditMutex means no edit is in progress, so the slot is only stale if the audio thread has swapped to the last published edit.
+		lock_guard<recursive_mutex> lock( mGraphEditMutex );
+		const uint32_t state = mGraphState.load( memory_order_acquire );
+		if( mRenderSlotStale && ! ( state & 2 ) )
+			releaseRetiredNodes( ( state & 1 ) ^ 1 );
+	}
+}
+
+void Context::destroyRetireThreadImpl()
+{
+	{
+		lock_guard<mutex> lock( mRetireMutex );
+		mRetireShouldQuit = true;
+	}
+
+	if( mRetireThread ) {
+		mRetireCond.notify_one();
+		mRetireThread->join();
+		mRetireThread.reset();
+	}
+}
+
+void Context::writeRenderAutoPulledNodes( size_t slot )
+{
+	auto &renderNodes = mRenderAutoPulledNodes[slot];
+	for( const auto &node : renderNodes )
+		node->mNumRenderReferences--;
+
+	renderNodes.assign( mAutoPulledNodes.begin(), mAutoPulledNodes.end() );
+	for( const auto &node : renderNodes )
+		node->mNumRenderReferences++;
 }
 
 void Context::preProcess()
 {
 	mAudioThreadId = std::this_thread::get_id();
 
+	// swap to the last published graph edit, if there is one
+	uint32_t state = mGraphState.load( memory_order_relaxed );
+	while( ( state & 2 ) && ! mGraphState.compare_exchange_weak( state, ( state & 1 ) ^ 1, memory_order_acq_rel, memory_order_relaxed ) )
+		;
+
+	// the retire thread releases the Node's that were only referenced by the slot left behind
+	if( state & 2 ) {
+		mRetireRequested = true;
+		mRetireCond.notify_one();
+	}
+
 	preProcessScheduledEvents();
 }
 
@@ -328,10 +509,7 @@ void Context::incrementFrameCount()
 
 void Context::processAutoPulledNodes()
 {
-	if( ! mAutoPullRequired )
-		return;
-
-	for( Node *node : getAutoPulledNodes() ) {
+	for( const NodeRef &node : mRenderAutoPulledNodes[getRenderSlot()] ) {
 		mAutoPullBuffer.setNumChannels( node->getNumChannels() );
 		node->pullInputs( &mAutoPullBuffer );
 		if( ! node->getProcessesInPlace() )
@@ -380,16 +558,6 @@ void Context::postProcessScheduledEvents()
 	}
 }
 
-const std::vector<Node *>& Context::getAutoPulledNodes()
-{
-	if( mAutoPullCacheDirty ) {
-		mAutoPullCache.clear();
-		for( const NodeRef &node : mAutoPulledNodes )
-			mAutoPullCache.push_back( node.get() );
-	}
-	return mAutoPullCache;
-}
-
 namespace {
 
 void printRecursive( ostream &stream, const NodeRef &node, size_t depth, set<NodeRef> &traversedNodes )
@@ -441,6 +609,23 @@ string Context::printGraphToString()
 	return stream.str();
 }
 
+// ----------------------------------------------------------------------------------------------------
+// Context::ScopedGraphEdit
+// ----------------------------------------------------------------------------------------------------
+
+Context::ScopedGraphEdit::ScopedGraphEdit( Context *context )
+	: mContext( context )
+{
+	if( mContext )
+		mContext->beginGraphEdit();
+}
+
+Context::ScopedGraphEdit::~ScopedGraphEdit()
+{
+	if( mContext )
+		mContext->endGraphEdit();
+}
+
 // ----------------------------------------------------------------------------------------------------
 // ScopedEnableContext
 // ----------------------------------------------------------------------------------------------------
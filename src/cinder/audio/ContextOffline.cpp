@@ -0,0 +1,151 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/ContextOffline.h"
+#include "cinder/audio/Exception.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+// ----------------------------------------------------------------------------------------------------
+// OutputOfflineNode
+// ----------------------------------------------------------------------------------------------------
+
+OutputOfflineNode::OutputOfflineNode( size_t sampleRate, size_t framesPerBlock, const Format &format )
+	: OutputNode( format ), mSampleRate( sampleRate ), mFramesPerBlock( framesPerBlock )
+{
+	if( ! mSampleRate || ! mFramesPerBlock )
+		throw AudioFormatExc( "OutputOfflineNode requires a non-zero samplerate and frames per block." );
+
+	if( getChannelMode() != ChannelMode::SPECIFIED ) {
+		setChannelMode( ChannelMode::SPECIFIED );
+		setNumChannels( 2 );
+	}
+
+	mClipDetectionEnabled = false;
+}
+
+void OutputOfflineNode::renderBlock()
+{
+	auto ctx = getContext();
+	CI_ASSERT( ctx );
+
+	lock_guard<mutex> lock( ctx->getMutex() );
+
+	ctx->preProcess();
+
+	auto internalBuffer = getInternalBuffer();
+	internalBuffer->zero();
+	pullInputs( internalBuffer );
+
+	if( checkNotClipping() )
+		internalBuffer->zero();
+
+	ctx->postProcess();
+}
+
+// ----------------------------------------------------------------------------------------------------
+// ContextOffline
+// ----------------------------------------------------------------------------------------------------
+
+// static
+ContextOfflineRef ContextOffline::create( size_t sampleRate, size_t framesPerBlock, size_t numChannels )
+{
+	ContextOfflineRef result( new ContextOffline() );
+	result->setOutput( result->makeNode( new OutputOfflineNode( sampleRate, framesPerBlock, Node::Format().channels( numChannels ) ) ) );
+	return result;
+}
+
+OutputDeviceNodeRef ContextOffline::createOutputDeviceNode( const DeviceRef &, const Node::Format & )
+{
+	throw AudioContextExc( "ContextOffline has no hardware output devices." );
+}
+
+InputDeviceNodeRef ContextOffline::createInputDeviceNode( const DeviceRef &, const Node::Format & )
+{
+	throw AudioContextExc( "ContextOffline has no hardware input devices." );
+}
+
+void ContextOffline::setOutput( const OutputNodeRef &output )
+{
+	auto outputOffline = dynamic_pointer_cast<OutputOfflineNode>( output );
+	if( ! outputOffline || outputOffline->getContext().get() != this )
+		throw AudioContextExc( "The output of a ContextOffline must be an OutputOfflineNode created by it." );
+
+	mOutputOffline = outputOffline;
+	mBlockFramesConsumed = 0;
+	Context::setOutput( output );
+}
+
+void ContextOffline::render( size_t numFrames, const std::function<void ( const Buffer &block, size_t frameOffset, size_t numFrames )> &blockFn )
+{
+	// output may not yet be initialized if no Node's are connected to it.
+	if( ! mOutputOffline->isInitialized() )
+		initializeNode( mOutputOffline );
+
+	const size_t framesPerBlock = mOutputOffline->getOutputFramesPerBlock();
+	const Buffer *block = mOutputOffline->getInternalBuffer();
+	while( numFrames ) {
+		if( ! mBlockFramesConsumed || mBlockFramesConsumed >= framesPerBlock ) {
+			mOutputOffline->renderBlock();
+			mBlockFramesConsumed = 0;
+		}
+
+		const size_t blockFrames = min( numFrames, framesPerBlock - mBlockFramesConsumed );
+		blockFn( *block, mBlockFramesConsumed, blockFrames );
+		mBlockFramesConsumed += blockFrames;
+		numFrames -= blockFrames;
+	}
+}
+
+void ContextOffline::render( size_t numFrames, TargetFile *target )
+{
+	CI_ASSERT( target );
+
+	if( target->getSampleRate() != getSampleRate() || target->getNumChannels() != mOutputOffline->getNumChannels() )
+		throw AudioFormatExc( "TargetFile format (samplerate: " + to_string( target->getSampleRate() ) + ", channels: " + to_string( target->getNumChannels() )
+								+ ") does not match the ContextOffline output (samplerate: " + to_string( getSampleRate() ) + ", channels: " + to_string( mOutputOffline->getNumChannels() ) + ")." );
+
+	render( numFrames, [target]( const Buffer &block, size_t frameOffset, size_t blockFrames ) {
+		target->write( &block, blockFrames, frameOffset );
+	} );
+}
+
+void ContextOffline::render( size_t numFrames, BufferDynamic *destination )
+{
+	CI_ASSERT( destination );
+
+	destination->setSize( numFrames, mOutputOffline->getNumChannels() );
+
+	size_t destFrame = 0;
+	render( numFrames, [destination, &destFrame]( const Buffer &block, size_t frameOffset, size_t blockFrames ) {
+		destination->copyOffset( block, blockFrames, destFrame, frameOffset );
+		destFrame += blockFrames;
+	} );
+}
+
+} } // namespace cinder::audio
@@ -0,0 +1,395 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/ConvolverNode.h"
+#include "cinder/audio/Context.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/audio/dsp/Fft.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const size_t MAX_PARTITION_SIZE = 16384;
+// each background stage's partitions are this many times longer than the previous stage's
+const size_t PARTITION_GROWTH = 4;
+
+// Accumulates the product of spectra a and b into result. dsp::Fft packs the DC and Nyquist bins, which are both real, into index 0 of the real and imaginary parts.
+void multiplyAccumulate( const BufferSpectral &a, const BufferSpectral &b, BufferSpectral *result )
+{
+	const size_t numBins = result->getNumFrames();
+	const float *aReal = a.getReal();
+	const float *aImag = a.getImag();
+	const float *bReal = b.getReal();
+	const float *bImag = b.getImag();
+	float *resultReal = result->getReal();
+	float *resultImag = result->getImag();
+
+	resultReal[0] += aReal[0] * bReal[0];
+	resultImag[0] += aImag[0] * bImag[0];
+
+	for( size_t k = 1; k < numBins; k++ ) {
+		resultReal[k] += aReal[k] * bReal[k] - aImag[k] * bImag[k];
+		resultImag[k] += aReal[k] * bImag[k] + aImag[k] * bReal[k];
+	}
+}
+
+// Uniformly partitioned overlap-save convolution with the frames [segmentBegin, segmentEnd) of an impulse response. Each call to process()
+// consumes one partition of input per channel and produces one partition of output, as if the segment began at the first frame.
+class PartitionedConvolver {
+  public:
+	PartitionedConvolver( const Buffer &impulseResponse, size_t segmentBegin, size_t segmentEnd, size_t partitionSize, size_t numChannels );
+
+	//! \a input and \a output have a partition of frames for each channel
+	void process( const Buffer &input, Buffer *output );
+
+  private:
+	size_t						mPartitionSize, mFftSize, mNumPartitions, mNumChannels, mNumIrChannels, mCurrentPartition;
+	dsp::Fft					mFft;
+	std::vector<BufferSpectral>	mIrSpectra;		// mNumPartitions for each impulse response channel
+	std::vector<BufferSpectral>	mInputSpectra;	// a frequency-domain delay line of mNumPartitions for each channel
+	std::vector<Buffer>			mInputWindows;	// the most recent mFftSize frames of input for each channel
+	Buffer						mTimeBuffer;
+	BufferSpectral				mSumSpectrum;
+};
+
+PartitionedConvolver::PartitionedConvolver( const Buffer &impulseResponse, size_t segmentBegin, size_t segmentEnd, size_t partitionSize, size_t numChannels )
+	: mPartitionSize( partitionSize ), mFftSize( nextPowerOf2( uint32_t( partitionSize * 2 - 1 ) ) ),
+		mNumPartitions( ( segmentEnd - segmentBegin + partitionSize - 1 ) / partitionSize ), mNumChannels( numChannels ),
+		mNumIrChannels( impulseResponse.getNumChannels() ), mCurrentPartition( 0 ), mFft( mFftSize ), mTimeBuffer( mFftSize ), mSumSpectrum( mFftSize )
+{
+	CI_ASSERT( segmentEnd <= impulseResponse.getNumFrames() && segmentBegin < segmentEnd );
+
+	// The scaling of dsp::Fft differs between backends, so measure what an impulse convolved with itself comes back as
+	BufferSpectral impulseSpectrum( mFftSize );
+	mTimeBuffer.zero();
+	mTimeBuffer[0] = 1;
+	mFft.forward( &mTimeBuffer, &impulseSpectrum );
+	mSumSpectrum.zero();
+	multiplyAccumulate( impulseSpectrum, impulseSpectrum, &mSumSpectrum );
+	mFft.inverse( &mSumSpectrum, &mTimeBuffer );
+	const float scale = 1.0f / mTimeBuffer[0];
+
+	mIrSpectra.reserve( mNumIrChannels * mNumPartitions );
+	for( size_t ch = 0; ch < mNumIrChannels; ch++ ) {
+		for( size_t i = 0; i < mNumPartitions; i++ ) {
+			const size_t partitionBegin = segmentBegin + i * partitionSize;
+			mTimeBuffer.zero();
+			dsp::mul( impulseResponse.getChannel( ch ) + partitionBegin, scale, mTimeBuffer.getData(), min( partitionSize, segmentEnd - partitionBegin ) );
+
+			mIrSpectra.emplace_back( mFftSize );
+			mFft.forward( &mTimeBuffer, &mIrSpectra.back() );
+		}
+	}
+
+	mInputSpectra.resize( mNumChannels * mNumPartitions, BufferSpectral( mFftSize ) );
+	mInputWindows.resize( mNumChannels, Buffer( mFftSize ) );
+}
+
+void PartitionedConvolver::process( const Buffer &input, Buffer *output )
+{
+	const size_t historySize = mFftSize - mPartitionSize;
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		// slide the window along by a partition and transform it into the newest slot of the delay line
+		float *window = mInputWindows[ch].getData();
+		std::copy( window + mPartitionSize, window + mFftSize, window );
+		std::copy( input.getChannel( ch ), input.getChannel( ch ) + mPartitionSize, window + historySize );
+
+		BufferSpectral *inputSpectra = &mInputSpectra[ch * mNumPartitions];
+		mFft.forward( &mInputWindows[ch], &inputSpectra[mCurrentPartition] );
+
+		// sum each partition of the impulse response multiplied by the input it lines up with
+		const BufferSpectral *irSpectra = &mIrSpectra[( ch % mNumIrChannels ) * mNumPartitions];
+		mSumSpectrum.zero();
+		for( size_t i = 0; i < mNumPartitions; i++ ) {
+			const size_t inputIndex = ( mCurrentPartition + mNumPartitions - i ) % mNumPartitions;
+			multiplyAccumulate( inputSpectra[inputIndex], irSpectra[i], &mSumSpectrum );
+		}
+
+		// only the last partition of the circular convolution is free of wrap around
+		mFft.inverse( &mSumSpectrum, &mTimeBuffer );
+		std::copy( mTimeBuffer.getData() + historySize, mTimeBuffer.getData() + mFftSize, output->getChannel( ch ) );
+	}
+
+	mCurrentPartition = ( mCurrentPartition + 1 ) % mNumPartitions;
+}
+
+// A segment of the impulse response that is convolved on a background thread. Input is collected a partition at a time and each partition
+// is handed to the thread once the result of the previous one is needed, which gives the thread a whole partition's worth of time. The
+// segment must begin at least two partitions into the impulse response so that results are ready in time. Input and output are double
+// buffered by the parity of the job that uses them.
+class TailStage {
+  public:
+	TailStage( const Buffer &impulseResponse, size_t segmentBegin, size_t segmentEnd, size_t partitionSize, size_t numChannels );
+	~TailStage();
+
+	//! Adds this stage's output for the current block to \a output and collects \a input. Called on the audio thread.
+	void process( const Buffer &input, Buffer *output );
+
+  private:
+	void submitJob();
+	void threadLoop();
+
+	PartitionedConvolver	mConvolver;
+	size_t					mPartitionSize, mFramesCollected;
+	Buffer					mInputs[2], mOutputs[2];
+	uint64_t				mNumSubmitted;
+
+	mutex					mMutex;
+	condition_variable		mRequestCond, mCompletedCond;
+	uint64_t				mNumRequested;
+	atomic<uint64_t>		mNumCompleted;
+	bool					mQuit;
+	thread					mThread;
+};
+
+TailStage::TailStage( const Buffer &impulseResponse, size_t segmentBegin, size_t segmentEnd, size_t partitionSize, size_t numChannels )
+	: mConvolver( impulseResponse, segmentBegin, segmentEnd, partitionSize, numChannels ), mPartitionSize( partitionSize ), mFramesCollected( 0 ),
+		mNumSubmitted( 0 ), mNumRequested( 0 ), mNumCompleted( 0 ), mQuit( false )
+{
+	CI_ASSERT( segmentBegin >= partitionSize * 2 );
+
+	for( size_t i = 0; i < 2; i++ ) {
+		mInputs[i] = Buffer( partitionSize, numChannels );
+		mOutputs[i] = Buffer( partitionSize, numChannels );
+	}
+
+	mThread = thread( &TailStage::threadLoop, this );
+}
+
+TailStage::~TailStage()
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+		mQuit = true;
+	}
+	mRequestCond.notify_one();
+	mThread.join();
+}
+
+void TailStage::process( const Buffer &input, Buffer *output )
+{
+	const size_t numFrames = input.getNumFrames();
+	const size_t parity = size_t( mNumSubmitted & 1 );
+	CI_ASSERT( mFramesCollected + numFrames <= mPartitionSize );
+
+	// the output being read was computed from the partition of input collected before the one being collected now
+	for( size_t ch = 0; ch < input.getNumChannels(); ch++ ) {
+		std::copy( input.getChannel( ch ), input.getChannel( ch ) + numFrames, mInputs[parity].getChannel( ch ) + mFramesCollected );
+		dsp::add( output->getChannel( ch ), mOutputs[parity].getChannel( ch ) + mFramesCollected, output->getChannel( ch ), numFrames );
+	}
+
+	mFramesCollected += numFrames;
+	if( mFramesCollected == mPartitionSize )
+		submitJob();
+}
+
+void TailStage::submitJob()
+{
+	// The previous job's output is read starting with the next block. This only waits if the thread is running late.
+	if( mNumCompleted.load( memory_order_acquire ) < mNumSubmitted ) {
+		unique_lock<mutex> lock( mMutex );
+		mCompletedCond.wait( lock, [this] { return mNumCompleted.load() >= mNumSubmitted; } );
+	}
+
+	mNumSubmitted++;
+	mFramesCollected = 0;
+
+	{
+		lock_guard<mutex> lock( mMutex );
+		mNumRequested = mNumSubmitted;
+	}
+	mRequestCond.notify_one();
+}
+
+void TailStage::threadLoop()
+{
+	uint64_t job = 0;
+	while( true ) {
+		{
+			unique_lock<mutex> lock( mMutex );
+			mRequestCond.wait( lock, [&] { return mQuit || mNumRequested > job; } );
+			if( mQuit )
+				return;
+		}
+
+		const size_t parity = size_t( job & 1 );
+		mConvolver.process( mInputs[parity], &mOutputs[parity] );
+		job++;
+
+		{
+			lock_guard<mutex> lock( mMutex );
+			mNumCompleted.store( job, memory_order_release );
+		}
+		mCompletedCond.notify_one();
+	}
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// ConvolverNode::Engine
+// ----------------------------------------------------------------------------------------------------
+
+// The partitioned impulse response for one channel count and block size, along with the threads that convolve its tail.
+class ConvolverNode::Engine {
+  public:
+	Engine( const Buffer &impulseResponse, size_t numChannels, size_t framesPerBlock, size_t maxPartitionSize );
+
+	void	process( Buffer *buffer );
+	size_t	getNumTailStages() const	{ return mTailStages.size(); }
+
+  private:
+	unique_ptr<PartitionedConvolver>	mHead;
+	vector<unique_ptr<TailStage>>		mTailStages;
+	Buffer								mOutput;
+};
+
+ConvolverNode::Engine::Engine( const Buffer &impulseResponse, size_t numChannels, size_t framesPerBlock, size_t maxPartitionSize )
+	: mOutput( framesPerBlock, numChannels )
+{
+	const size_t irFrames = impulseResponse.getNumFrames();
+	size_t segmentBegin = 0;
+	size_t partitionSize = framesPerBlock;
+	while( segmentBegin < irFrames ) {
+		// A stage with partitions of size P can begin 2P into the impulse response: one partition to collect input and one to convolve it.
+		// The current stage covers the frames until the next one can begin, or the rest once partitions stop growing.
+		// Partitions stay a whole number of blocks, as stages collect their input a block at a time.
+		const size_t nextPartitionSize = partitionSize < maxPartitionSize ? partitionSize * PARTITION_GROWTH : partitionSize;
+		const size_t segmentEnd = nextPartitionSize > partitionSize ? min( irFrames, nextPartitionSize * 2 ) : irFrames;
+
+		if( segmentBegin == 0 )
+			mHead.reset( new PartitionedConvolver( impulseResponse, segmentBegin, segmentEnd, partitionSize, numChannels ) );
+		else
+			mTailStages.emplace_back( new TailStage( impulseResponse, segmentBegin, segmentEnd, partitionSize, numChannels ) );
+
+		segmentBegin = segmentEnd;
+		partitionSize = nextPartitionSize;
+	}
+}
+
+void ConvolverNode::Engine::process( Buffer *buffer )
+{
+	CI_ASSERT( buffer->getNumFrames() == mOutput.getNumFrames() && buffer->getNumChannels() == mOutput.getNumChannels() );
+
+	if( ! mHead ) {
+		buffer->zero();
+		return;
+	}
+
+	mHead->process( *buffer, &mOutput );
+	for( auto &stage : mTailStages )
+		stage->process( *buffer, &mOutput );
+
+	buffer->copy( mOutput );
+}
+
+// ----------------------------------------------------------------------------------------------------
+// ConvolverNode
+// ----------------------------------------------------------------------------------------------------
+
+ConvolverNode::ConvolverNode( const Format &format )
+	: Node( format )
+{
+}
+
+ConvolverNode::ConvolverNode( const BufferRef &impulseResponse, const Format &format )
+	: Node( format ), mImpulseResponse( impulseResponse )
+{
+}
+
+ConvolverNode::~ConvolverNode()
+{
+}
+
+void ConvolverNode::setImpulseResponse( const BufferRef &impulseResponse )
+{
+	// Partition the new impulse response before taking the lock, and destroy the old Engine (joining its threads) after releasing it
+	unique_ptr<Engine> engine;
+	if( impulseResponse && isInitialized() )
+		engine.reset( new Engine( *impulseResponse, getNumChannels(), getFramesPerBlock(), getMaxPartitionSize() ) );
+
+	lock_guard<mutex> lock( getContext()->getMutex() );
+
+	mImpulseResponse = impulseResponse;
+	if( isInitialized() )
+		swap( mEngine, engine );
+}
+
+void ConvolverNode::loadImpulseResponse( const SourceFileRef &sourceFile )
+{
+	size_t sampleRate = getSampleRate();
+	if( sampleRate == sourceFile->getSampleRate() )
+		setImpulseResponse( sourceFile->loadBuffer() );
+	else {
+		auto sf = sourceFile->cloneWithSampleRate( sampleRate );
+		setImpulseResponse( sf->loadBuffer() );
+	}
+}
+
+size_t ConvolverNode::getMaxPartitionSize() const
+{
+	// the largest of framesPerBlock * PARTITION_GROWTH^k that doesn't exceed MAX_PARTITION_SIZE
+	size_t result = getFramesPerBlock();
+	while( result * PARTITION_GROWTH <= MAX_PARTITION_SIZE )
+		result *= PARTITION_GROWTH;
+
+	return result;
+}
+
+size_t ConvolverNode::getNumTailThreads() const
+{
+	lock_guard<mutex> lock( getContext()->getMutex() );
+	return mEngine ? mEngine->getNumTailStages() : 0;
+}
+
+void ConvolverNode::initialize()
+{
+	if( mImpulseResponse )
+		mEngine.reset( new Engine( *mImpulseResponse, getNumChannels(), getFramesPerBlock(), getMaxPartitionSize() ) );
+}
+
+void ConvolverNode::uninitialize()
+{
+	mEngine.reset();
+}
+
+void ConvolverNode::process( Buffer *buffer )
+{
+	if( mEngine )
+		mEngine->process( buffer );
+	else
+		buffer->zero();
+}
+
+} } // namespace cinder::audio
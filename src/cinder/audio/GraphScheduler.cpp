@@ -0,0 +1,423 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/GraphScheduler.h"
+#include "cinder/audio/Node.h"
+#include "cinder/audio/dsp/Converter.h"
+#include "cinder/CinderAssert.h"
+#include "cinder/CinderSimd.h"
+
+#include <algorithm>
+#include <map>
+
+#if defined( CINDER_MSW )
+	#include <windows.h>
+#elif defined( CINDER_COCOA )
+	#include <dispatch/dispatch.h>
+	#include <pthread.h>
+#else
+	#include <errno.h>
+	#include <pthread.h>
+	#include <semaphore.h>
+#endif
+
+using namespace std;
+
+namespace cinder { namespace audio {
+
+namespace {
+
+inline void spinPause()
+{
+#if defined( CINDER_SIMD_SSE2 )
+	_mm_pause();
+#endif
+}
+
+void setRealtimePriority()
+{
+	// Without the necessary privileges this fails, in which case the worker keeps running at the default priority.
+#if defined( CINDER_MSW )
+	::SetThreadPriority( ::GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL );
+#else
+	sched_param param;
+	param.sched_priority = sched_get_priority_max( SCHED_FIFO ) - 1;
+	pthread_setschedparam( pthread_self(), SCHED_FIFO, &param );
+#endif
+}
+
+void collectUpstream( Node *node, set<Node *> &result )
+{
+	for( const auto &input : node->getInputs() ) {
+		if( result.insert( input.get() ).second )
+			collectUpstream( input.get(), result );
+	}
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// GraphScheduler::Semaphore
+// ----------------------------------------------------------------------------------------------------
+
+// A counting semaphore that is signaled without locks or system calls unless a thread is actually asleep. Waiting
+// threads spin briefly first, as the next batch of jobs (or the last branch of the current one) usually arrives within the same processing block.
+// After that they sleep, which lets a preempted lower priority worker run instead of being starved by the spinning thread.
+class GraphScheduler::Semaphore {
+  public:
+	Semaphore()
+		: mCount( 0 )
+	{
+#if defined( CINDER_MSW )
+		mSemaphore = ::CreateSemaphore( nullptr, 0, MAXLONG, nullptr );
+#elif defined( CINDER_COCOA )
+		mSemaphore = dispatch_semaphore_create( 0 );
+#else
+		sem_init( &mSemaphore, 0, 0 );
+#endif
+	}
+
+	~Semaphore()
+	{
+#if defined( CINDER_MSW )
+		::CloseHandle( mSemaphore );
+#elif defined( CINDER_COCOA )
+		dispatch_release( mSemaphore );
+#else
+		sem_destroy( &mSemaphore );
+#endif
+	}
+
+	void wait()
+	{
+		for( int i = 0; i < 4096; i++ ) {
+			int count = mCount.load( memory_order_relaxed );
+			if( count > 0 && mCount.compare_exchange_weak( count, count - 1, memory_order_acquire ) )
+				return;
+
+			spinPause();
+		}
+
+		if( mCount.fetch_sub( 1, memory_order_acquire ) < 1 )
+			waitSystem();
+	}
+
+	void signal( int count )
+	{
+		int prevCount = mCount.fetch_add( count, memory_order_release );
+		int numSleeping = min( -prevCount, count );
+		if( numSleeping > 0 )
+			signalSystem( numSleeping );
+	}
+
+  private:
+	void waitSystem()
+	{
+#if defined( CINDER_MSW )
+		::WaitForSingleObject( mSemaphore, INFINITE );
+#elif defined( CINDER_COCOA )
+		dispatch_semaphore_wait( mSemaphore, DISPATCH_TIME_FOREVER );
+#else
+		while( sem_wait( &mSemaphore ) == -1 && errno == EINTR )
+			;
+#endif
+	}
+
+	void signalSystem( int count )
+	{
+#if defined( CINDER_MSW )
+		::ReleaseSemaphore( mSemaphore, count, nullptr );
+#elif defined( CINDER_COCOA )
+		while( count-- > 0 )
+			dispatch_semaphore_signal( mSemaphore );
+#else
+		while( count-- > 0 )
+			sem_post( &mSemaphore );
+#endif
+	}
+
+	atomic<int>		mCount;
+
+#if defined( CINDER_MSW )
+	HANDLE					mSemaphore;
+#elif defined( CINDER_COCOA )
+	dispatch_semaphore_t	mSemaphore;
+#else
+	sem_t					mSemaphore;
+#endif
+};
+
+// ----------------------------------------------------------------------------------------------------
+// GraphScheduler
+// ----------------------------------------------------------------------------------------------------
+
+GraphScheduler::GraphScheduler( size_t numThreads )
+	: mSemaphore( new Semaphore ), mCompletionSemaphore( new Semaphore ), mCurrentPlan( nullptr ), mNumActiveWorkers( 0 ), mQuit( false )
+{
+	for( size_t i = 1; i < numThreads; i++ ) {
+		mWorkers.emplace_back( &GraphScheduler::workerLoop, this );
+		mWorkerIds.push_back( mWorkers.back().get_id() );
+	}
+}
+
+GraphScheduler::~GraphScheduler()
+{
+	mQuit = true;
+	mSemaphore->signal( (int)mWorkers.size() );
+
+	for( auto &worker : mWorkers )
+		worker.join();
+}
+
+bool GraphScheduler::isWorkerThread() const
+{
+	const auto threadId = this_thread::get_id();
+	return find( mWorkerIds.begin(), mWorkerIds.end(), threadId ) != mWorkerIds.end();
+}
+
+void GraphScheduler::compile( const NodeRef &output, const set<NodeRef> &autoPulledNodes, size_t slot )
+{
+	clearPlans( slot );
+	if( ! output )
+		return;
+
+	// Node's pulled by the output are processed before any auto-pulled Node's, so a branch beneath the output can
+	// safely feed Node's that are only reached from the auto-pulled ones.
+	set<Node *> pulledByOutput = { output.get() };
+	collectUpstream( output.get(), pulledByOutput );
+
+	// Returns true if all Node's in the branch headed by input can be processed while the rest of the graph is being pulled.
+	auto branchIsIsolated = [&pulledByOutput]( Node *summingNode, Node *input, const set<Node *> &branch ) {
+		if( branch.count( summingNode ) )
+			return false;
+
+		const bool summingNodePulledByOutput = pulledByOutput.count( summingNode ) != 0;
+		for( Node *node : branch ) {
+			if( node->supportsCycles() )
+				return false;
+
+			for( const auto &output : node->getOutputs() ) {
+				if( output.get() == summingNode ) {
+					if( node != input )
+						return false;
+				}
+				else if( ! branch.count( output.get() ) ) {
+					// the other output must only be pulled after the output's graph, and find this Node already processed
+					if( ! summingNodePulledByOutput || pulledByOutput.count( output.get() ) || node->getProcessesInPlace() )
+						return false;
+				}
+			}
+		}
+
+		// The head of the in-place chain must completely overwrite the pulled buffer, as leftover samples differ between threads.
+		Node *chainHead = input;
+		while( chainHead->getProcessesInPlace() && ! chainHead->getInputs().empty() )
+			chainHead = chainHead->getInputs().begin()->get();
+
+		if( ! chainHead->getProcessesInPlace() ) {
+			const size_t numChannels = chainHead->getNumChannels();
+			if( numChannels != summingNode->getNumChannels() && numChannels != 1 && summingNode->getNumChannels() != 1 )
+				return false;
+		}
+
+		return true;
+	};
+
+	set<Node *> visited, parallelNodes;
+	vector<Node *> stack;
+	for( const auto &node : autoPulledNodes )
+		stack.push_back( node.get() );
+	stack.push_back( output.get() );
+
+	while( ! stack.empty() ) {
+		Node *node = stack.back();
+		stack.pop_back();
+		if( ! visited.insert( node ).second || parallelNodes.count( node ) )
+			continue;
+
+		const auto &inputs = node->getInputs();
+
+		unique_ptr<Plan> plan;
+		if( ! node->getProcessesInPlace() && inputs.size() > 1 && ! node->supportsCycles() ) {
+			vector<set<Node *>> branches;
+			map<Node *, size_t> branchCounts;
+			for( const auto &input : inputs ) {
+				branches.push_back( { input.get() } );
+				collectUpstream( input.get(), branches.back() );
+				for( Node *branchNode : branches.back() )
+					branchCounts[branchNode]++;
+			}
+
+			plan.reset( new Plan );
+			plan->mNode = node->shared_from_this();
+			size_t i = 0;
+			for( const auto &input : inputs ) {
+				const auto &branch = branches[i++];
+				bool parallel = all_of( branch.begin(), branch.end(), [&branchCounts]( Node *n ) { return branchCounts[n] == 1; } )
+								&& branchIsIsolated( node, input.get(), branch );
+
+				plan->mBranches.push_back( { input, parallel, BufferDynamic() } );
+				if( parallel )
+					plan->mBranches.back().mBuffer.setSize( node->getFramesPerBlock(), node->getNumChannels() );
+			}
+
+			for( auto &branch : plan->mBranches ) {
+				if( branch.mParallel )
+					plan->mJobs.push_back( &branch );
+			}
+
+			// a single parallel branch is pulled serially, there is nothing for it to run alongside.
+			if( plan->mJobs.size() < 2 )
+				plan.reset();
+		}
+
+		if( plan ) {
+			for( size_t i = 0; i < plan->mBranches.size(); i++ ) {
+				const auto &branch = plan->mBranches[i];
+				if( branch.mParallel ) {
+					parallelNodes.insert( branch.mInput.get() );
+					collectUpstream( branch.mInput.get(), parallelNodes );
+				}
+				else
+					stack.push_back( branch.mInput.get() );
+			}
+
+			mPlans[slot][node] = move( plan );
+		}
+		else {
+			for( const auto &input : inputs )
+				stack.push_back( input.get() );
+		}
+	}
+}
+
+bool GraphScheduler::sumInputs( Node *node, Buffer *summingBuffer, size_t slot )
+{
+	const auto &plans = mPlans[slot];
+	if( plans.empty() )
+		return false;
+
+	auto planIt = plans.find( node );
+	if( planIt == plans.end() )
+		return false;
+
+	Plan *plan = planIt->second.get();
+	CI_ASSERT( ! isWorkerThread() );
+
+	// make sure the plan still matches the Node's inputs and channels, otherwise fall back to serial pulling until recompiled.
+	const auto &inputs = node->mRenderInputs[slot];
+	if( inputs.size() != plan->mBranches.size() )
+		return false;
+
+	auto branchIt = plan->mBranches.begin();
+	for( const auto &input : inputs ) {
+		if( input != branchIt->mInput )
+			return false;
+		if( branchIt->mParallel && ( branchIt->mBuffer.getNumChannels() != node->getNumChannels() || branchIt->mBuffer.getNumFrames() != summingBuffer->getNumFrames() ) )
+			return false;
+
+		++branchIt;
+	}
+
+	// wake up the workers and help them until all parallel branches are processed
+	plan->mJobsRemaining.store( plan->mJobs.size(), memory_order_relaxed );
+	plan->mNextJob.store( 0, memory_order_release );
+	mCurrentPlan.store( plan );
+	mSemaphore->signal( (int)min( plan->mJobs.size() - 1, mWorkers.size() ) );
+
+	// Once there are no jobs left to claim, wait for the workers to finish the ones they are running. Whichever thread finishes the last job signals
+	// completion, so this returns immediately if it was the audio thread, and otherwise only spins for a bounded time before sleeping.
+	runJobs( plan );
+	mCompletionSemaphore->wait();
+
+	// sum in input order, exactly as Node::sumInputs() does when processing serially
+	Buffer *internalBuffer = node->getInternalBuffer();
+	for( auto &branch : plan->mBranches ) {
+		const NodeRef &input = branch.mInput;
+		if( ! branch.mParallel )
+			input->pullInputs( internalBuffer );
+
+		const Buffer *processedBuffer;
+		if( ! input->getProcessesInPlace() )
+			processedBuffer = input->getInternalBuffer();
+		else
+			processedBuffer = branch.mParallel ? &branch.mBuffer : internalBuffer;
+
+		dsp::sumBuffers( processedBuffer, summingBuffer );
+	}
+
+	return true;
+}
+
+void GraphScheduler::runJobs( Plan *plan )
+{
+	const size_t numJobs = plan->mJobs.size();
+	size_t jobIndex;
+	while( ( jobIndex = plan->mNextJob.fetch_add( 1, memory_order_acquire ) ) < numJobs ) {
+		Branch *branch = plan->mJobs[jobIndex];
+		branch->mInput->pullInputs( &branch->mBuffer );
+		if( plan->mJobsRemaining.fetch_sub( 1, memory_order_acq_rel ) == 1 )
+			mCompletionSemaphore->signal( 1 );
+	}
+}
+
+void GraphScheduler::workerLoop()
+{
+	setRealtimePriority();
+
+	while( true ) {
+		mSemaphore->wait();
+		if( mQuit )
+			return;
+
+		mNumActiveWorkers++;
+		Plan *plan = mCurrentPlan.load();
+		if( plan )
+			runJobs( plan );
+		mNumActiveWorkers--;
+	}
+}
+
+void GraphScheduler::clearPlans( size_t slot )
+{
+	auto &plans = mPlans[slot];
+	if( plans.empty() )
+		return;
+
+	// The audio thread only starts plans from the other slot, but a worker woken late may still be looking at one from
+	// this slot. Withdraw it if it is still current and wait for any worker that already picked it up before destroying anything.
+	Plan *currentPlan = mCurrentPlan.load();
+	for( const auto &plan : plans ) {
+		if( plan.second.get() == currentPlan ) {
+			mCurrentPlan.compare_exchange_strong( currentPlan, nullptr );
+			break;
+		}
+	}
+
+	while( mNumActiveWorkers )
+		this_thread::yield();
+
+	plans.clear();
+}
+
+} } // namespace cinder::audio
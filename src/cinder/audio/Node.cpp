@@ -25,6 +25,7 @@
 #include "cinder/audio/Node.h"
 #include "cinder/audio/DelayNode.h"
 #include "cinder/audio/Context.h"
+#include "cinder/audio/GraphScheduler.h"
 #include "cinder/audio/dsp/Dsp.h"
 #include "cinder/audio/dsp/Converter.h"
 #include "cinder/CinderAssert.h"
@@ -42,7 +43,8 @@ namespace cinder { namespace audio {
 
 Node::Node( const Format &format )
 	: mInitialized( false ), mEnabled( false ),	mChannelMode( format.getChannelMode() ),
-		mNumChannels( 1 ), mAutoEnabled( true ), mProcessInPlace( true ), mLastProcessedFrame( numeric_limits<uint64_t>::max() )
+		mNumChannels( 1 ), mAutoEnabled( true ), mProcessInPlace( true ), mLastProcessedFrame( numeric_limits<uint64_t>::max() ),
+		mNumRenderReferences( 0 ), mIsRenderRoot( false )
 {
 	if( format.getChannels() ) {
 		mNumChannels = format.getChannels();
@@ -55,6 +57,10 @@ Node::Node( const Format &format )
 
 Node::~Node()
 {
+	for( const auto &renderInputs : mRenderInputs ) {
+		for( const auto &input : renderInputs )
+			input->mNumRenderReferences--;
+	}
 }
 
 void Node::connect( const NodeRef &output )
@@ -63,7 +69,12 @@ void Node::connect( const NodeRef &output )
 	// disconnecting us, which we may need later anyway
 	NodeRef thisRef = shared_from_this();
 
-	if( ! output || ! output->canConnectToInput( thisRef ) )
+	if( ! output )
+		return;
+
+	Context::ScopedGraphEdit edit( getContext().get() );
+
+	if( ! output->canConnectToInput( thisRef ) )
 		return;
 
 	if( checkCycle( thisRef, output ) )
@@ -80,6 +91,8 @@ void Node::disconnect( const NodeRef &output )
 	if( ! output )
 		return;
 
+	Context::ScopedGraphEdit edit( getContext().get() );
+
 	for( auto weakOutIt = mOutputs.begin(); weakOutIt != mOutputs.end(); ++weakOutIt ) {
 		if( weakOutIt->lock() == output ) {
 			mOutputs.erase( weakOutIt );
@@ -93,6 +106,8 @@ void Node::disconnect( const NodeRef &output )
 
 void Node::disconnectAll()
 {
+	Context::ScopedGraphEdit edit( getContext().get() );
+
 	disconnectAllInputs();
 	disconnectAllOutputs();
 }
@@ -100,6 +115,7 @@ void Node::disconnectAll()
 void Node::disconnectAllOutputs()
 {
 	NodeRef thisRef = shared_from_this();
+	Context::ScopedGraphEdit edit( getContext().get() );
 
 	auto outputs = getOutputs(); // first make a copy of only the still-alive NodeRef's
 	for( const auto &output : outputs )
@@ -109,11 +125,16 @@ void Node::disconnectAllOutputs()
 void Node::disconnectAllInputs()
 {
 	NodeRef thisRef = shared_from_this();
+	auto ctx = getContext();
+	Context::ScopedGraphEdit edit( ctx.get() );
 
 	for( auto &input : mInputs )
 		input->disconnectOutput( thisRef );
 
 	mInputs.clear();
+	if( ctx )
+		ctx->publishRenderInputs( this );
+
 	notifyConnectionsDidChange();
 }
 
@@ -123,10 +144,21 @@ void Node::connectInput( const NodeRef &input )
 	if( ! ctx )
 		return;
 
-	lock_guard<mutex> lock( ctx->getMutex() );
+	Context::ScopedGraphEdit edit( ctx.get() );
+
+	// The audio thread keeps pulling the previous inputs until the edit is published, so only a change to the format of a Node it may be processing needs to wait for it.
+	const bool requiresSync = connectionRequiresSync( input );
+	unique_lock<mutex> lock( ctx->getMutex(), defer_lock );
+	if( requiresSync )
+		lock.lock();
 
 	mInputs.insert( input );
-	configureConnections();
+	if( isRendered() && ! requiresSync )
+		configureInput( input, false, false );
+	else
+		configureConnections();
+
+	ctx->publishRenderInputs( this );
 }
 
 void Node::disconnectInput( const NodeRef &input )
@@ -135,7 +167,7 @@ void Node::disconnectInput( const NodeRef &input )
 	if( ! ctx )
 		return;
 
-	lock_guard<mutex> lock( ctx->getMutex() );
+	Context::ScopedGraphEdit edit( ctx.get() );
 
 	for( auto inIt = mInputs.begin(); inIt != mInputs.end(); ++inIt ) {
 		if( *inIt == input ) {
@@ -143,16 +175,13 @@ void Node::disconnectInput( const NodeRef &input )
 			break;
 		}
 	}
+
+	ctx->publishRenderInputs( this );
 }
 
 void Node::disconnectOutput( const NodeRef &output )
 {
-	auto ctx = getContext();
-	if( ! ctx )
-		return;
-
-	lock_guard<mutex> lock( ctx->getMutex() );
-
+	// outputs are never read on the audio thread
 	for( auto outIt = mOutputs.begin(); outIt != mOutputs.end(); ++outIt ) {
 		if( outIt->lock() == output ) {
 			mOutputs.erase( outIt );
@@ -344,40 +373,8 @@ void Node::configureConnections()
 	bool isDelay = ( dynamic_cast<DelayNode *>( this ) != nullptr ); // see note above
 	bool inputChannelsUnequal = inputChannelsAreUnequal();
 
-	for( auto &input : mInputs ) {
-		bool inputProcessInPlace = true;
-
-		size_t inputNumChannels = input->getNumChannels();
-		if( ! supportsInputNumChannels( inputNumChannels ) ) {
-			if( mChannelMode == ChannelMode::MATCHES_INPUT )
-				setNumChannels( getMaxNumInputChannels() );
-			else if( input->getChannelMode() == ChannelMode::MATCHES_OUTPUT ) {
-				input->setNumChannels( mNumChannels );
-				input->configureConnections();
-			}
-			else {
-				mProcessInPlace = false;
-				inputProcessInPlace = false;
-			}
-		}
-
-		// inputs with more than one output cannot process in-place, so make them sum
-		if( input->getProcessesInPlace() && input->getNumConnectedOutputs() > 1 )
-			inputProcessInPlace = false;
-
-		// when there are multiple inputs and their channel counts don't match, they must be summed
-		if( inputChannelsUnequal )
-			inputProcessInPlace = false;
-
-		// if we're unable to process in-place and we're a DelayNode, its possible that the input may be part of a feedback loop, in which case input must sum.
-		if( ! mProcessInPlace && isDelay )
-			inputProcessInPlace = false;
-
-		if( ! inputProcessInPlace )
-			input->setupProcessWithSumming();
-
-		input->initializeImpl();
-	}
+	for( auto &input : mInputs )
+		configureInput( input, inputChannelsUnequal, isDelay );
 
 	for( auto &out : mOutputs ) {
 		NodeRef output = out.lock();
@@ -399,12 +396,49 @@ void Node::configureConnections()
 	initializeImpl();
 }
 
+void Node::configureInput( const NodeRef &input, bool inputChannelsUnequal, bool isDelay )
+{
+	bool inputProcessInPlace = true;
+
+	size_t inputNumChannels = input->getNumChannels();
+	if( ! supportsInputNumChannels( inputNumChannels ) ) {
+		if( mChannelMode == ChannelMode::MATCHES_INPUT )
+			setNumChannels( getMaxNumInputChannels() );
+		else if( input->getChannelMode() == ChannelMode::MATCHES_OUTPUT ) {
+			input->setNumChannels( mNumChannels );
+			input->configureConnections();
+		}
+		else {
+			mProcessInPlace = false;
+			inputProcessInPlace = false;
+		}
+	}
+
+	// inputs with more than one output cannot process in-place, so make them sum
+	if( input->getProcessesInPlace() && input->getNumConnectedOutputs() > 1 )
+		inputProcessInPlace = false;
+
+	// when there are multiple inputs and their channel counts don't match, they must be summed
+	if( inputChannelsUnequal )
+		inputProcessInPlace = false;
+
+	// if we're unable to process in-place and we're a DelayNode, its possible that the input may be part of a feedback loop, in which case input must sum.
+	if( ! mProcessInPlace && isDelay )
+		inputProcessInPlace = false;
+
+	if( ! inputProcessInPlace )
+		input->setupProcessWithSumming();
+
+	input->initializeImpl();
+}
+
 void Node::pullInputs( Buffer *inPlaceBuffer )
 {
 	CI_ASSERT( getContext() );
 
 	if( mProcessInPlace ) {
-		if( mInputs.empty() ) {
+		const auto &inputs = getRenderInputs();
+		if( inputs.empty() ) {
 			// Fastest route: no inputs and process in-place. inPlaceBuffer must be cleared so that samples left over
 			// from InputNode's that aren't filling the entire buffer are zero.
 			inPlaceBuffer->zero();
@@ -413,7 +447,7 @@ void Node::pullInputs( Buffer *inPlaceBuffer )
 		}
 		else {
 			// First pull the input (can only be one when in-place), then run process() if input did any processing.
-			const NodeRef &input = *mInputs.begin();
+			const NodeRef &input = inputs.front();
 			input->pullInputs( inPlaceBuffer );
 
 			if( ! input->getProcessesInPlace() )
@@ -437,12 +471,18 @@ void Node::pullInputs( Buffer *inPlaceBuffer )
 
 void Node::sumInputs()
 {
-	// Pull all inputs, summing the results from the buffer that input used for processing.
+	// Pull all inputs, summing the results from the buffer that input used for processing. When the Context processes with
+	// multiple threads, independent inputs are pulled in parallel by its GraphScheduler, which sums them in the same order.
 	// mInternalBuffer is not zero'ed before pulling inputs to allow for feedback.
-	for( auto &input : mInputs ) {
-		input->pullInputs( &mInternalBuffer );
-		const Buffer *processedBuffer = input->getProcessesInPlace() ? &mInternalBuffer : input->getInternalBuffer();
-		dsp::sumBuffers( processedBuffer, &mSummingBuffer );
+	auto ctx = getContext();
+	const size_t renderSlot = ctx->getRenderSlot();
+	GraphScheduler *scheduler = ctx->getGraphScheduler();
+	if( ! scheduler || ! scheduler->sumInputs( this, &mSummingBuffer, renderSlot ) ) {
+		for( auto &input : mRenderInputs[renderSlot] ) {
+			input->pullInputs( &mInternalBuffer );
+			const Buffer *processedBuffer = input->getProcessesInPlace() ? &mInternalBuffer : input->getInternalBuffer();
+			dsp::sumBuffers( processedBuffer, &mSummingBuffer );
+		}
 	}
 
 	// Process the summed results if enabled.
@@ -453,6 +493,11 @@ void Node::sumInputs()
 	dsp::mixBuffers( &mSummingBuffer, &mInternalBuffer );
 }
 
+const vector<NodeRef>& Node::getRenderInputs() const
+{
+	return mRenderInputs[getContext()->getRenderSlot()];
+}
+
 void Node::setupProcessWithSumming()
 {
 	CI_ASSERT( getContext() );
@@ -480,6 +525,40 @@ bool Node::checkCycle( const NodeRef &sourceNode, const NodeRef &destNode ) cons
 	return false;
 }
 
+bool Node::connectionRequiresSync( const NodeRef &input ) const
+{
+	// connecting a Node that is already processed to another output may change how it processes
+	if( input->isRendered() )
+		return true;
+
+	if( ! isRendered() ) {
+		// configureConnections() also reconfigures the other inputs and outputs, which may be processed
+		for( const auto &in : mInputs ) {
+			if( in->isRendered() )
+				return true;
+		}
+		for( const auto &out : mOutputs ) {
+			NodeRef output = out.lock();
+			if( output && output->isRendered() )
+				return true;
+		}
+
+		return false;
+	}
+
+	// the new input can be configured on its own if this Node is already summing (or has nothing yet to process in-place) and the channels agree
+	const size_t inputNumChannels = input->getNumChannels();
+	if( ! mInitialized || supportsCycles() || ( mProcessInPlace && ! mInputs.empty() ) || ! supportsInputNumChannels( inputNumChannels ) )
+		return true;
+
+	for( const auto &in : mInputs ) {
+		if( in->getNumChannels() != inputNumChannels )
+			return true;
+	}
+
+	return false;
+}
+
 void Node::notifyConnectionsDidChange()
 {
 	auto ctx = getContext();
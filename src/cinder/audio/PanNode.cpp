@@ -72,10 +72,7 @@ void Pan2dNode::pullInputs( Buffer *destBuffer )
 
 		size_t numFrames = mSummingBuffer.getNumFrames();
 		float *summingChannel0 = mSummingBuffer.getChannel( 0 );
-		for( NodeRef &input : mInputs ) {
-			if( ! input )
-				continue;
-
+		for( const NodeRef &input : getRenderInputs() ) {
 			input->pullInputs( &mInternalBuffer );
 			if( input->getProcessesInPlace() )
 				add( summingChannel0, mInternalBuffer.getChannel( 0 ), summingChannel0, numFrames );
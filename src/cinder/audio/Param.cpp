@@ -26,42 +26,177 @@
 #include "cinder/audio/dsp/Dsp.h"
 
 #include "cinder/CinderMath.h"
+#include "cinder/CinderSimd.h"
+
+#include <algorithm>
 
 using namespace std;
 
 namespace cinder { namespace audio {
 
-void rampLinear( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
+namespace {
+
+// Each ramp curve maps a sample's normalized time t to the factor used to interpolate between the begin and end values. The ramps compute
+// t = tBegin + i * tIncr for each sample directly rather than accumulating it, so that vector lanes are independent.
+
+struct CurveLinear {
+	static double factor( double t )								{ return t; }
+	template<typename OPS>
+	static CINDER_SIMD_FORCEINLINE void apply( const OPS &, typename OPS::V & )	{}
+};
+
+struct CurveInQuad {
+	static double factor( double t )								{ return t * t; }
+	template<typename OPS>
+	static CINDER_SIMD_FORCEINLINE void apply( const OPS &ops, typename OPS::V &t )	{ ops.mul( t, t, t ); }
+};
+
+struct CurveOutQuad {
+	static double factor( double t )								{ return -t * ( t - 2 ); }
+	template<typename OPS>
+	static CINDER_SIMD_FORCEINLINE void apply( const OPS &ops, typename OPS::V &t )
+	{
+		typename OPS::V two;
+		ops.set( two, 2.0f );
+		ops.sub( two, two, t );
+		ops.mul( t, t, two );
+	}
+};
+
+#if defined( CINDER_SIMD_SSE2 )
+
+struct RampOpsSse2 {
+	typedef __m128	V;
+	static const size_t WIDTH = 4;
+
+	void	lanes( V &v ) const								{ v = _mm_set_ps( 3, 2, 1, 0 ); }
+	void	set( V &v, float s ) const						{ v = _mm_set1_ps( s ); }
+	void	store( float *p, const V &v ) const				{ _mm_storeu_ps( p, v ); }
+	void	add( V &r, const V &a, const V &b ) const		{ r = _mm_add_ps( a, b ); }
+	void	sub( V &r, const V &a, const V &b ) const		{ r = _mm_sub_ps( a, b ); }
+	void	mul( V &r, const V &a, const V &b ) const		{ r = _mm_mul_ps( a, b ); }
+};
+
+struct RampOpsAvx2 {
+	typedef __m256	V;
+	static const size_t WIDTH = 8;
+
+	CINDER_SIMD_TARGET_AVX2 void	lanes( V &v ) const								{ v = _mm256_set_ps( 7, 6, 5, 4, 3, 2, 1, 0 ); }
+	CINDER_SIMD_TARGET_AVX2 void	set( V &v, float s ) const						{ v = _mm256_set1_ps( s ); }
+	CINDER_SIMD_TARGET_AVX2 void	store( float *p, const V &v ) const				{ _mm256_storeu_ps( p, v ); }
+	CINDER_SIMD_TARGET_AVX2 void	add( V &r, const V &a, const V &b ) const		{ r = _mm256_add_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void	sub( V &r, const V &a, const V &b ) const		{ r = _mm256_sub_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void	mul( V &r, const V &a, const V &b ) const		{ r = _mm256_mul_ps( a, b ); }
+};
+
+#elif defined( CINDER_SIMD_NEON )
+
+struct RampOpsNeon {
+	typedef float32x4_t	V;
+	static const size_t WIDTH = 4;
+
+	void	lanes( V &v ) const								{ const float lanes[4] = { 0, 1, 2, 3 }; v = vld1q_f32( lanes ); }
+	void	set( V &v, float s ) const						{ v = vdupq_n_f32( s ); }
+	void	store( float *p, const V &v ) const				{ vst1q_f32( p, v ); }
+	void	add( V &r, const V &a, const V &b ) const		{ r = vaddq_f32( a, b ); }
+	void	sub( V &r, const V &a, const V &b ) const		{ r = vsubq_f32( a, b ); }
+	void	mul( V &r, const V &a, const V &b ) const		{ r = vmulq_f32( a, b ); }
+};
+
+#endif
+
+// Fills the leading multiple of OPS::WIDTH samples, returning how many were written. Each vector's first t is computed in double precision
+// and the lanes are offset from it in single precision, so error does not grow along the ramp.
+template<typename CurveT, typename OPS>
+CINDER_SIMD_FORCEINLINE size_t rampSimd( const OPS &ops, float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor( t );
-		array[i] = lerp( valueBegin, valueEnd, factor );
-		t += tIncr;
+	typename OPS::V laneOffsets, begin, range, x;
+	ops.lanes( laneOffsets );
+	ops.set( x, float( tIncr ) );
+	ops.mul( laneOffsets, laneOffsets, x );
+	ops.set( begin, valueBegin );
+	ops.set( range, valueEnd - valueBegin );
+
+	size_t i = 0;
+	for( ; i + OPS::WIDTH <= count; i += OPS::WIDTH ) {
+		ops.set( x, float( t + (double)i * tIncr ) );
+		ops.add( x, x, laneOffsets );
+		CurveT::apply( ops, x );
+		ops.mul( x, x, range );
+		ops.add( x, x, begin );
+		ops.store( array + i, x );
 	}
+	return i;
 }
 
-void rampInQuad( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
+#if defined( CINDER_SIMD_SSE2 )
+
+template<typename CurveT>
+CINDER_SIMD_TARGET_AVX2 size_t rampAvx2( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor( t * t );
+	const RampOpsAvx2 ops;
+	return rampSimd<CurveT>( ops, array, count, t, tIncr, valueBegin, valueEnd );
+}
+
+#endif
+
+template<typename CurveT>
+void ramp( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 )
+	const simd::Level simdLevel = simd::getLevel();
+	if( simdLevel >= simd::Level::AVX2 )
+		i = rampAvx2<CurveT>( array, count, t, tIncr, valueBegin, valueEnd );
+	else if( simdLevel >= simd::Level::SSE2 )
+		i = rampSimd<CurveT>( RampOpsSse2(), array, count, t, tIncr, valueBegin, valueEnd );
+#elif defined( CINDER_SIMD_NEON )
+	if( simd::getLevel() >= simd::Level::NEON )
+		i = rampSimd<CurveT>( RampOpsNeon(), array, count, t, tIncr, valueBegin, valueEnd );
+#endif
+
+	for( ; i < count; i++ ) {
+		float factor( CurveT::factor( t + (double)i * tIncr ) );
 		array[i] = lerp( valueBegin, valueEnd, factor );
-		t += tIncr;
 	}
 }
 
-void rampOutQuad( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
+typedef void (*RampFnPtr)( float *, size_t, double, double, float, float );
+
+// Events are sorted by begin time, so the one that ends last can be anywhere when ramps overlap. Ties go to the later Event. \a events must not be empty.
+const EventRef& findLastEndingEvent( const vector<EventRef> &events )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor( -t * ( t - 2 ) );
-		array[i] = lerp( valueBegin, valueEnd, factor );
-		t += tIncr;
+	auto result = events.begin();
+	for( auto eventIt = events.begin() + 1; eventIt != events.end(); ++eventIt ) {
+		if( (*eventIt)->getTimeEnd() >= (*result)->getTimeEnd() )
+			result = eventIt;
 	}
+	return *result;
+}
+
+} // anonymous namespace
+
+void rampLinear( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
+{
+	ramp<CurveLinear>( array, count, t, tIncr, valueBegin, valueEnd );
+}
+
+void rampInQuad( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
+{
+	ramp<CurveInQuad>( array, count, t, tIncr, valueBegin, valueEnd );
+}
+
+void rampOutQuad( float *array, size_t count, double t, double tIncr, float valueBegin, float valueEnd )
+{
+	ramp<CurveOutQuad>( array, count, t, tIncr, valueBegin, valueEnd );
 }
 
 Event::Event( double timeBegin, double timeEnd, float valueBegin, float valueEnd, bool copyValueOnBegin, const RampFn &rampFn )
 	: mTimeBegin( timeBegin ), mTimeEnd( timeEnd ), mDuration( timeEnd - timeBegin ), mCopyValueOnBegin( copyValueOnBegin ),
 		mValueBegin( valueBegin ), mValueEnd( valueEnd ), mRampFn( rampFn ), mIsComplete( false ), mIsCanceled( false ), mTimeCancel( -1 )
 {
+	const RampFnPtr *fn = rampFn.target<RampFnPtr>();
+	mIsBuiltInRamp = fn && ( *fn == rampLinear || *fn == rampInQuad || *fn == rampOutQuad );
 }
 
 Param::Param( Node *parentNode, float initialValue )
@@ -95,7 +230,7 @@ EventRef Param::applyRamp( float valueEnd, double rampSeconds, const Options &op
 	if( mProcessor )
 		mProcessor.reset();
 
-	mEvents.push_back( event );
+	insertEvent( event );
 	return event;
 }
 
@@ -118,7 +253,7 @@ EventRef Param::applyRamp( float valueBegin, float valueEnd, double rampSeconds,
 	if( mProcessor )
 		mProcessor.reset();
 
-	mEvents.push_back( event );
+	insertEvent( event );
 	return event;
 }
 
@@ -137,7 +272,7 @@ EventRef Param::appendRamp( float valueEnd, double rampSeconds, const Options &o
 		event->mLabel = options.getLabel();
 
 	lock_guard<mutex> lock( ctx->getMutex() );
-	mEvents.push_back( event );
+	insertEvent( event );
 	return event;
 }
 
@@ -156,7 +291,7 @@ EventRef Param::appendRamp( float valueBegin, float valueEnd, double rampSeconds
 		event->mLabel = options.getLabel();
 
 	lock_guard<mutex> lock( ctx->getMutex() );
-	mEvents.push_back( event );
+	insertEvent( event );
 	return event;
 }
 
@@ -171,9 +306,10 @@ void Param::setProcessor( const NodeRef &node )
 
 	resetImpl();
 
-	// force node to be mono and initialize it
+	// force node to be mono and initialize it. It is pulled on the audio thread from now on, so connections that change its format must synchronize.
 	node->setNumChannels( 1 );
 	node->initializeImpl();
+	node->mIsRenderRoot = true;
 
 	mProcessor = node;
 	mIsVaryingThisBlock = true; // stays true until there is no more processor and eval() sets this to false.
@@ -200,7 +336,7 @@ float Param::findDuration() const
 	if( mEvents.empty() )
 		return 0;
 	else {
-		const EventRef &event = mEvents.back();
+		const EventRef &event = findLastEndingEvent( mEvents );
 		return event->mTimeEnd - (float)ctx->getNumProcessedSeconds();
 	}
 }
@@ -213,7 +349,7 @@ pair<double, float> Param::findEndTimeAndValue() const
 	if( mEvents.empty() )
 		return make_pair( ctx->getNumProcessedSeconds(), mValue.load() );
 	else {
-		const EventRef &event = mEvents.back();
+		const EventRef &event = findLastEndingEvent( mEvents );
 		return make_pair( event->mTimeEnd, event->mValueEnd );
 	}
 }
@@ -246,80 +382,111 @@ bool Param::eval( double timeBegin, float *array, size_t arrayLength, size_t sam
 {
 	const double samplePeriod = 1.0 / (double)sampleRate;
 	const double secondsPerBlock = (double)arrayLength * samplePeriod;
+	const double timeEnd = timeBegin + secondsPerBlock;
 	size_t samplesWritten = 0;
-
-	for( auto eventIt = mEvents.begin(); eventIt != mEvents.end(); /* */ ) {
-		Event &event = **eventIt;
+	bool isConstant = false;
+
+	// Events are sorted by begin time, so only the front of mEvents can overlap this block. Removed Events are moved to
+	// mRetiredEvents and the ones kept are compacted in place, so no memory is allocated or freed here.
+	const size_t numEvents = mEvents.size();
+	size_t numKept = 0;
+	size_t eventIndex = 0;
+	auto retireEvent = [&] {
+		mRetiredEvents.push_back( move( mEvents[eventIndex] ) );
+	};
+	auto keepEvent = [&] {
+		if( numKept != eventIndex )
+			mEvents[numKept] = move( mEvents[eventIndex] );
+		numKept++;
+	};
+
+	for( ; eventIndex < numEvents; eventIndex++ ) {
+		Event &event = *mEvents[eventIndex];
+
+		// this and all following Events begin after this block
+		if( event.mTimeBegin >= timeEnd )
+			break;
 
 		// first remove dead events
 		const bool cancelled = event.mIsCanceled;
 		if( event.mTimeEnd <= timeBegin || cancelled ) {
 			// if we skipped over the last event, record its end value before erasing.
-			if( mEvents.size() == 1 && ! cancelled )
+			if( numKept + numEvents - eventIndex == 1 && ! cancelled )
 				mValue = event.mValueEnd;
-			
-			eventIt = mEvents.erase( eventIt );
+
+			retireEvent();
 			continue;
 		}
 
-		const double timeEnd = timeBegin + secondsPerBlock;
-
-		if( event.mTimeBegin < timeEnd && event.mTimeEnd > timeBegin ) {
-			size_t startIndex = timeBegin >= event.mTimeBegin ? 0 : size_t( ( event.mTimeBegin - timeBegin ) * sampleRate );
-			size_t endIndex = timeEnd < event.mTimeEnd ? arrayLength : size_t( ( event.mTimeEnd - timeBegin ) * sampleRate );
-
-			CI_ASSERT( startIndex <= arrayLength && endIndex <= arrayLength );
-			CI_ASSERT( event.mTimeEnd >= event.mTimeBegin );
-
-			if( startIndex > 0 && samplesWritten == 0 )
-				dsp::fill( mValue, array, startIndex );
-
-			size_t count = size_t( endIndex - startIndex );
-			double timeBeginNormalized = ( timeBegin - event.mTimeBegin + startIndex * samplePeriod ) / event.mDuration;
-			double timeEndNormalized = ( timeBegin - event.mTimeBegin + endIndex * samplePeriod ) / event.mDuration;
-			double timeIncr = ( timeEndNormalized - timeBeginNormalized ) / (double)count;
-
-			// If the event has a cancel time, adjust the count if needed, but all other ramp values remain the same
-			if( event.mTimeCancel > 0 ) {
-				if( event.mTimeCancel < timeBegin ) {
-					// event should already be over
-					event.cancel();
-					eventIt = mEvents.erase( eventIt );
-					continue;
-				}
-
-				size_t endIndexModified = timeEnd < event.mTimeCancel ? arrayLength : size_t( ( event.mTimeCancel - timeBegin ) * sampleRate );
-				if( endIndexModified != endIndex ) {
-					count = endIndexModified - startIndex;
-					event.cancel(); // cancel but still process. This Event will be removed from the container next block.
-				}
-			}
+		size_t startIndex = timeBegin >= event.mTimeBegin ? 0 : size_t( ( event.mTimeBegin - timeBegin ) * sampleRate );
+		size_t endIndex = timeEnd < event.mTimeEnd ? arrayLength : size_t( ( event.mTimeEnd - timeBegin ) * sampleRate );
 
-			if( event.getCopyValueOnBegin() )
-				event.setValueBegin( mValue ); // this is only copied the first block the Event is processed, as next block getCopyValueOnBegin() is false.
+		CI_ASSERT( startIndex <= arrayLength && endIndex <= arrayLength );
+		CI_ASSERT( event.mTimeEnd >= event.mTimeBegin );
 
-			event.mRampFn( array + startIndex, count, timeBeginNormalized, timeIncr, event.mValueBegin, event.mValueEnd );
-			samplesWritten += count;
+		if( startIndex > 0 && samplesWritten == 0 )
+			dsp::fill( mValue, array, startIndex );
 
-			// if this ramp ended with the current processing block, update mValue then remove event
-			if( endIndex < arrayLength ) {
-				event.mIsComplete = true;
-				mValue = event.mValueEnd;
-				eventIt = mEvents.erase( eventIt );
+		size_t count = size_t( endIndex - startIndex );
+		double timeBeginNormalized = ( timeBegin - event.mTimeBegin + startIndex * samplePeriod ) / event.mDuration;
+		double timeEndNormalized = ( timeBegin - event.mTimeBegin + endIndex * samplePeriod ) / event.mDuration;
+		double timeIncr = ( timeEndNormalized - timeBeginNormalized ) / (double)count;
+
+		// If the event has a cancel time, adjust the count if needed, but all other ramp values remain the same
+		if( event.mTimeCancel > 0 ) {
+			if( event.mTimeCancel < timeBegin ) {
+				// event should already be over
+				event.cancel();
+				retireEvent();
+				continue;
 			}
-			else if( samplesWritten == arrayLength ) {
-				// the array was filled, store the last calculated samples in mValue and finish evaluating
-				mValue = array[arrayLength - 1];
-				break;
+
+			size_t endIndexModified = timeEnd < event.mTimeCancel ? arrayLength : size_t( ( event.mTimeCancel - timeBegin ) * sampleRate );
+			if( endIndexModified != endIndex ) {
+				count = endIndexModified - startIndex;
+				event.cancel(); // cancel but still process. This Event will be removed from the container next block.
 			}
-			else
-				++eventIt;
+		}
+
+		if( event.getCopyValueOnBegin() )
+			event.setValueBegin( mValue ); // this is only copied the first block the Event is processed, as next block getCopyValueOnBegin() is false.
+
+		if( event.mIsBuiltInRamp && event.mValueBegin == event.mValueEnd && samplesWritten == 0 && count == arrayLength ) {
+			// the Event holds one value over the whole block, so the array isn't needed
+			mValue = event.mValueEnd;
+			isConstant = true;
+			keepEvent();
+			eventIndex++;
+			break;
+		}
+
+		event.mRampFn( array + startIndex, count, timeBeginNormalized, timeIncr, event.mValueBegin, event.mValueEnd );
+		samplesWritten += count;
+
+		// if this ramp ended with the current processing block, update mValue then remove event
+		if( endIndex < arrayLength ) {
+			event.mIsComplete = true;
+			mValue = event.mValueEnd;
+			retireEvent();
+		}
+		else if( samplesWritten == arrayLength ) {
+			// the array was filled, store the last calculated samples in mValue and finish evaluating
+			mValue = array[arrayLength - 1];
+			keepEvent();
+			eventIndex++;
+			break;
 		}
 		else
-			++eventIt;
+			keepEvent();
 	}
 
-	if( ! samplesWritten )
+	// move the Events that weren't reached up behind the kept ones
+	if( numKept != eventIndex ) {
+		move( mEvents.begin() + eventIndex, mEvents.end(), mEvents.begin() + numKept );
+		mEvents.erase( mEvents.begin() + numKept + ( numEvents - eventIndex ), mEvents.end() );
+	}
+
+	if( ! samplesWritten || isConstant )
 		return false;
 	else if( samplesWritten < arrayLength )
 		dsp::fill( mValue, array + (size_t)samplesWritten, size_t( arrayLength - samplesWritten ) );
@@ -340,14 +507,19 @@ void Param::resetImpl()
 		mEvents.clear();
 	}
 
+	mRetiredEvents.clear();
 	mProcessor.reset();
 }
 
 void Param::removeEventsAt( double time )
 {
-	for( auto &event : mEvents ) {
+	for( auto eventIt = mEvents.begin(); eventIt != mEvents.end(); /* */ ) {
+		const EventRef &event = *eventIt;
 		if( event->getTimeBegin() >= time ) {
+			// Events that haven't begun can be removed here, as eval() won't have processed them yet
 			event->cancel();
+			eventIt = mEvents.erase( eventIt );
+			continue;
 		}
 		else if( event->getTimeEnd() >= time ) {
 			// Handle cancel later to allow the ramp to continue until the cancel point. Only reset cancel time if it is newer than a previous setting.
@@ -357,9 +529,23 @@ void Param::removeEventsAt( double time )
 			else
 				event->mTimeCancel = time;
 		}
+
+		++eventIt;
 	}
 }
 
+void Param::insertEvent( const EventRef &event )
+{
+	// release the Events that eval() removed, now that we are off the audio thread
+	mRetiredEvents.clear();
+
+	auto insertIt = upper_bound( mEvents.begin(), mEvents.end(), event, []( const EventRef &a, const EventRef &b ) {
+		return a->mTimeBegin < b->mTimeBegin;
+	} );
+	mEvents.insert( insertIt, event );
+	mRetiredEvents.reserve( mEvents.size() );
+}
+
 void Param::initInternalBuffer()
 {
 	if( mInternalBuffer.isEmpty() )
@@ -22,10 +22,16 @@
  */
 
 #include "cinder/audio/Target.h"
+#include "cinder/audio/Exception.h"
 #include "cinder/CinderAssert.h"
 
 #include "cinder/Utilities.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
 #if defined( CINDER_COCOA )
 	#include "cinder/audio/cocoa/FileCoreAudio.h"
 #elif defined( CINDER_MSW )
@@ -36,6 +42,87 @@ using namespace std;
 
 namespace cinder { namespace audio {
 
+#if ! defined( CINDER_COCOA ) && ! defined( CINDER_MSW )
+
+namespace {
+
+// Writes uncompressed .wav files on platforms without a native encoder. The RIFF and data chunk sizes are updated after every write, so the file
+// is valid whenever the TargetFile is idle. The DataTarget's stream must be seekable.
+class TargetFileWav : public TargetFile {
+  public:
+	TargetFileWav( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType )
+		: TargetFile( dataTarget, sampleRate, numChannels, sampleType ), mStream( dataTarget->getStream() ), mNumDataBytes( 0 )
+	{
+		switch( sampleType ) {
+			case SampleType::INT_16:	mBytesPerSample = 2; break;
+			case SampleType::INT_24:	mBytesPerSample = 3; break;
+			case SampleType::FLOAT_32:	mBytesPerSample = 4; break;
+		}
+
+		const uint16_t formatTag = ( sampleType == SampleType::FLOAT_32 ) ? 3 : 1; // WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM
+		const uint16_t blockAlign = uint16_t( numChannels * mBytesPerSample );
+
+		mHeaderOffset = mStream->tell();
+		mStream->writeData( "RIFF", 4 );
+		mStream->writeLittle( uint32_t( 36 ) );
+		mStream->writeData( "WAVEfmt ", 8 );
+		mStream->writeLittle( uint32_t( 16 ) );
+		mStream->writeLittle( formatTag );
+		mStream->writeLittle( uint16_t( numChannels ) );
+		mStream->writeLittle( uint32_t( sampleRate ) );
+		mStream->writeLittle( uint32_t( sampleRate * blockAlign ) );
+		mStream->writeLittle( blockAlign );
+		mStream->writeLittle( uint16_t( mBytesPerSample * 8 ) );
+		mStream->writeData( "data", 4 );
+		mStream->writeLittle( uint32_t( 0 ) );
+	}
+
+  protected:
+	void performWrite( const Buffer *buffer, size_t numFrames, size_t frameOffset ) override
+	{
+		CI_ASSERT( buffer->getNumChannels() == mNumChannels );
+
+		// interleave and convert to little endian samples, clamping integer formats to full scale
+		mSamples.resize( numFrames * mNumChannels * mBytesPerSample );
+		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+			const float *channel = buffer->getChannel( ch ) + frameOffset;
+			uint8_t *dest = mSamples.data() + ch * mBytesPerSample;
+			for( size_t i = 0; i < numFrames; i++, dest += mNumChannels * mBytesPerSample ) {
+				uint32_t sample;
+				if( mSampleType == SampleType::FLOAT_32 )
+					memcpy( &sample, &channel[i], 4 );
+				else {
+					const float clamped = std::max( -1.0f, std::min( 1.0f, channel[i] ) );
+					sample = uint32_t( int32_t( lrintf( clamped * ( mBytesPerSample == 2 ? 32767.0f : 8388607.0f ) ) ) );
+				}
+				for( size_t b = 0; b < mBytesPerSample; b++ )
+					dest[b] = uint8_t( sample >> ( b * 8 ) );
+			}
+		}
+
+		mStream->writeData( mSamples.data(), mSamples.size() );
+		mNumDataBytes += (uint32_t)mSamples.size();
+
+		const off_t end = mStream->tell();
+		mStream->seekAbsolute( mHeaderOffset + 4 );
+		mStream->writeLittle( uint32_t( 36 + mNumDataBytes ) );
+		mStream->seekAbsolute( mHeaderOffset + 40 );
+		mStream->writeLittle( mNumDataBytes );
+		mStream->seekAbsolute( end );
+	}
+
+  private:
+	OStreamRef				mStream;
+	off_t					mHeaderOffset;
+	size_t					mBytesPerSample;
+	uint32_t				mNumDataBytes;
+	std::vector<uint8_t>	mSamples;
+};
+
+} // anonymous namespace
+
+#endif // ! defined( CINDER_COCOA ) && ! defined( CINDER_MSW )
+
 // TODO: these should be replaced with a generic registrar derived from the ImageIo stuff.
 
 std::unique_ptr<TargetFile> TargetFile::create( const DataTargetRef &dataTarget, size_t sampleRate, size_t numChannels, SampleType sampleType, const std::string &extension )
@@ -51,6 +138,12 @@ std::unique_ptr<TargetFile> TargetFile::create( const DataTargetRef &dataTarget,
 	return std::unique_ptr<TargetFile>( new cocoa::TargetFileCoreAudio( dataTarget, sampleRate, numChannels, sampleType, ext ) );
 #elif defined( CINDER_MSW )
 	return std::unique_ptr<TargetFile>( new msw::TargetFileMediaFoundation( dataTarget, sampleRate, numChannels, sampleType, ext ) );
+#else
+	const string &format = extension.empty() ? ext : extension;
+	if( ! format.empty() && format != "wav" )
+		throw AudioFileExc( "Unsupported audio file extension: " + format + ". Only .wav files can be written on this platform." );
+
+	return std::unique_ptr<TargetFile>( new TargetFileWav( dataTarget, sampleRate, numChannels, sampleType ) );
 #endif
 }
 
@@ -104,8 +104,13 @@ void sumBuffers( const Buffer *sourceBuffer, Buffer *destBuffer, size_t numFrame
 	size_t destChannels = destBuffer->getNumChannels();
 
 	if( destChannels == sourceBuffer->getNumChannels() ) {
-		for( size_t c = 0; c < destChannels; c++ )
-			add( destBuffer->getChannel( c ), sourceBuffer->getChannel( c ), destBuffer->getChannel( c ), numFrames );
+		// channels are contiguous, so whole buffers can be summed in one pass
+		if( numFrames == destBuffer->getNumFrames() && numFrames == sourceBuffer->getNumFrames() )
+			add( destBuffer->getData(), sourceBuffer->getData(), destBuffer->getData(), destBuffer->getSize() );
+		else {
+			for( size_t c = 0; c < destChannels; c++ )
+				add( destBuffer->getChannel( c ), sourceBuffer->getChannel( c ), destBuffer->getChannel( c ), numFrames );
+		}
 	}
 	else if( sourceChannels == 1 ) {
 		// up-mix mono sourceBuffer to destChannels
@@ -24,6 +24,7 @@
 #include "cinder/audio/dsp/Dsp.h"
 
 #include "cinder/CinderMath.h"
+#include "cinder/CinderSimd.h"
 
 #if defined( CINDER_AUDIO_VDSP )
 	#include <Accelerate/Accelerate.h>
@@ -166,48 +167,291 @@ void addMul( const float *arrayA, const float *arrayB, float scalar, float *resu
 
 #else // ! defined( CINDER_AUDIO_VDSP )
 
+namespace {
+
+// Each set of vector operations processes WIDTH samples at a time. Element-wise kernels evaluate every sample exactly as the scalar
+// loops do, so their results are identical. Reductions keep a partial result per lane, so sum() and rms() may differ in the last bits.
+
+#if defined( CINDER_SIMD_SSE2 )
+
+struct DspOpsSse2 {
+	typedef __m128	V;
+	static const size_t WIDTH = 4;
+
+	void	load( V &v, const float *p ) const					{ v = _mm_loadu_ps( p ); }
+	void	store( float *p, const V &v ) const					{ _mm_storeu_ps( p, v ); }
+	void	set( V &v, float s ) const							{ v = _mm_set1_ps( s ); }
+	void	add( V &r, const V &a, const V &b ) const			{ r = _mm_add_ps( a, b ); }
+	void	sub( V &r, const V &a, const V &b ) const			{ r = _mm_sub_ps( a, b ); }
+	void	mul( V &r, const V &a, const V &b ) const			{ r = _mm_mul_ps( a, b ); }
+	// a > b ? a : b, which keeps b when a is NaN
+	void	greater( V &r, const V &a, const V &b ) const		{ r = _mm_max_ps( a, b ); }
+	float	reduceAdd( const V &v ) const
+	{
+		const __m128 t = _mm_add_ps( v, _mm_movehl_ps( v, v ) );
+		return _mm_cvtss_f32( _mm_add_ss( t, _mm_shuffle_ps( t, t, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+	}
+	float	reduceGreater( const V &v ) const
+	{
+		const __m128 t = _mm_max_ps( v, _mm_movehl_ps( v, v ) );
+		return _mm_cvtss_f32( _mm_max_ss( t, _mm_shuffle_ps( t, t, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+	}
+};
+
+struct DspOpsAvx2 {
+	typedef __m256	V;
+	static const size_t WIDTH = 8;
+
+	CINDER_SIMD_TARGET_AVX2 void	load( V &v, const float *p ) const				{ v = _mm256_loadu_ps( p ); }
+	CINDER_SIMD_TARGET_AVX2 void	store( float *p, const V &v ) const				{ _mm256_storeu_ps( p, v ); }
+	CINDER_SIMD_TARGET_AVX2 void	set( V &v, float s ) const						{ v = _mm256_set1_ps( s ); }
+	CINDER_SIMD_TARGET_AVX2 void	add( V &r, const V &a, const V &b ) const		{ r = _mm256_add_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void	sub( V &r, const V &a, const V &b ) const		{ r = _mm256_sub_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void	mul( V &r, const V &a, const V &b ) const		{ r = _mm256_mul_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void	greater( V &r, const V &a, const V &b ) const	{ r = _mm256_max_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 float	reduceAdd( const V &v ) const
+	{
+		return DspOpsSse2().reduceAdd( _mm_add_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) ) );
+	}
+	CINDER_SIMD_TARGET_AVX2 float	reduceGreater( const V &v ) const
+	{
+		return DspOpsSse2().reduceGreater( _mm_max_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) ) );
+	}
+};
+
+#elif defined( CINDER_SIMD_NEON )
+
+struct DspOpsNeon {
+	typedef float32x4_t	V;
+	static const size_t WIDTH = 4;
+
+	void	load( V &v, const float *p ) const					{ v = vld1q_f32( p ); }
+	void	store( float *p, const V &v ) const					{ vst1q_f32( p, v ); }
+	void	set( V &v, float s ) const							{ v = vdupq_n_f32( s ); }
+	void	add( V &r, const V &a, const V &b ) const			{ r = vaddq_f32( a, b ); }
+	void	sub( V &r, const V &a, const V &b ) const			{ r = vsubq_f32( a, b ); }
+	void	mul( V &r, const V &a, const V &b ) const			{ r = vmulq_f32( a, b ); }
+	void	greater( V &r, const V &a, const V &b ) const		{ r = vbslq_f32( vcgtq_f32( a, b ), a, b ); }
+	float	reduceAdd( const V &v ) const
+	{
+		const float32x2_t t = vadd_f32( vget_low_f32( v ), vget_high_f32( v ) );
+		return vget_lane_f32( vpadd_f32( t, t ), 0 );
+	}
+	float	reduceGreater( const V &v ) const
+	{
+		const float32x2_t t = vmax_f32( vget_low_f32( v ), vget_high_f32( v ) );
+		return vget_lane_f32( vpmax_f32( t, t ), 0 );
+	}
+};
+
+#endif
+
+// Kernels process the leading multiple of OPS::WIDTH samples and return how many they processed, leaving the rest to the scalar loops.
+
+struct FillKernel {
+	template<typename OPS>
+	static CINDER_SIMD_FORCEINLINE size_t run( const OPS &ops, float value, float *array, size_t length )
+	{
+		typename OPS::V v;
+		ops.set( v, value );
+		size_t i = 0;
+		for( ; i + OPS::WIDTH <= length; i += OPS::WIDTH )
+			ops.store( array + i, v );
+		return i;
+	}
+};
+
+// Binary operations applied element-wise by ArrayArrayKernel and ArrayScalarKernel
+struct AddKernel {
+	template<typename OPS, typename V>
+	static CINDER_SIMD_FORCEINLINE void apply( const OPS &ops, V &r, const V &a, const V &b )	{ ops.add( r, a, b ); }
+};
+
+struct SubKernel {
+	template<typename OPS, typename V>
+	static CINDER_SIMD_FORCEINLINE void apply( const OPS &ops, V &r, const V &a, const V &b )	{ ops.sub( r, a, b ); }
+};
+
+struct MulKernel {
+	template<typename OPS, typename V>
+	static CINDER_SIMD_FORCEINLINE void apply( const OPS &ops, V &r, const V &a, const V &b )	{ ops.mul( r, a, b ); }
+};
+
+template<typename OpT>
+struct ArrayArrayKernel {
+	template<typename OPS>
+	static CINDER_SIMD_FORCEINLINE size_t run( const OPS &ops, const float *arrayA, const float *arrayB, float *result, size_t length )
+	{
+		typename OPS::V a, b;
+		size_t i = 0;
+		for( ; i + OPS::WIDTH <= length; i += OPS::WIDTH ) {
+			ops.load( a, arrayA + i );
+			ops.load( b, arrayB + i );
+			OpT::apply( ops, a, a, b );
+			ops.store( result + i, a );
+		}
+		return i;
+	}
+};
+
+template<typename OpT>
+struct ArrayScalarKernel {
+	template<typename OPS>
+	static CINDER_SIMD_FORCEINLINE size_t run( const OPS &ops, const float *array, float scalar, float *result, size_t length )
+	{
+		typename OPS::V a, s;
+		ops.set( s, scalar );
+		size_t i = 0;
+		for( ; i + OPS::WIDTH <= length; i += OPS::WIDTH ) {
+			ops.load( a, array + i );
+			OpT::apply( ops, a, a, s );
+			ops.store( result + i, a );
+		}
+		return i;
+	}
+};
+
+struct AddMulKernel {
+	template<typename OPS>
+	static CINDER_SIMD_FORCEINLINE size_t run( const OPS &ops, const float *arrayA, const float *arrayB, float scalar, float *result, size_t length )
+	{
+		typename OPS::V a, b, s;
+		ops.set( s, scalar );
+		size_t i = 0;
+		for( ; i + OPS::WIDTH <= length; i += OPS::WIDTH ) {
+			ops.load( a, arrayA + i );
+			ops.load( b, arrayB + i );
+			ops.add( a, a, b );
+			ops.mul( a, a, s );
+			ops.store( result + i, a );
+		}
+		return i;
+	}
+};
+
+// Sums the samples, or their squares when SQUARE is true, into *result. Two accumulators hide the latency of the additions.
+template<bool SQUARE>
+struct SumKernel {
+	template<typename OPS>
+	static CINDER_SIMD_FORCEINLINE size_t run( const OPS &ops, const float *array, size_t length, float *result )
+	{
+		typename OPS::V sum0, sum1, a, b;
+		ops.set( sum0, 0.0f );
+		ops.set( sum1, 0.0f );
+		size_t i = 0;
+		for( ; i + OPS::WIDTH * 2 <= length; i += OPS::WIDTH * 2 ) {
+			ops.load( a, array + i );
+			ops.load( b, array + i + OPS::WIDTH );
+			if( SQUARE ) {
+				ops.mul( a, a, a );
+				ops.mul( b, b, b );
+			}
+			ops.add( sum0, sum0, a );
+			ops.add( sum1, sum1, b );
+		}
+		for( ; i + OPS::WIDTH <= length; i += OPS::WIDTH ) {
+			ops.load( a, array + i );
+			if( SQUARE )
+				ops.mul( a, a, a );
+			ops.add( sum0, sum0, a );
+		}
+
+		ops.add( sum0, sum0, sum1 );
+		*result = ops.reduceAdd( sum0 );
+		return i;
+	}
+};
+
+// Finds the largest sample that is greater than *result, ignoring NaN's like the scalar comparison does
+struct MaxKernel {
+	template<typename OPS>
+	static CINDER_SIMD_FORCEINLINE size_t run( const OPS &ops, const float *array, size_t length, float *result )
+	{
+		typename OPS::V max, a;
+		ops.set( max, *result );
+		size_t i = 0;
+		for( ; i + OPS::WIDTH <= length; i += OPS::WIDTH ) {
+			ops.load( a, array + i );
+			ops.greater( max, a, max );
+		}
+
+		*result = ops.reduceGreater( max );
+		return i;
+	}
+};
+
+#if defined( CINDER_SIMD_SSE2 )
+
+template<typename KernelT, typename... Args>
+CINDER_SIMD_TARGET_AVX2 size_t runAvx2( Args... args )
+{
+	const DspOpsAvx2 ops;
+	return KernelT::run( ops, args... );
+}
+
+#endif
+
+// Runs KernelT with the best instruction set available, returning the number of leading samples it processed
+template<typename KernelT, typename... Args>
+size_t runSimd( Args... args )
+{
+#if defined( CINDER_SIMD_SSE2 )
+	const simd::Level simdLevel = simd::getLevel();
+	if( simdLevel >= simd::Level::AVX2 )
+		return runAvx2<KernelT>( args... );
+	else if( simdLevel >= simd::Level::SSE2 )
+		return KernelT::run( DspOpsSse2(), args... );
+#elif defined( CINDER_SIMD_NEON )
+	if( simd::getLevel() >= simd::Level::NEON )
+		return KernelT::run( DspOpsNeon(), args... );
+#endif
+	return 0;
+}
+
+} // anonymous namespace
+
 void fill( float value, float *array, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	for( size_t i = runSimd<FillKernel>( value, array, length ); i < length; i++ )
 		array[i] = value;
 }
 
 float sum( const float *array, size_t length )
 {
 	float result( 0.0f );
-	for( size_t i = 0; i < length; i++ )
+	for( size_t i = runSimd<SumKernel<false>>( array, length, &result ); i < length; i++ )
 		result += array[i];
 	return result;
 }
 
 void add( const float *array, float scalar, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	for( size_t i = runSimd<ArrayScalarKernel<AddKernel>>( array, scalar, result, length ); i < length; i++ )
 		result[i] = array[i] + scalar;
 }
 
 void add( const float *arrayA, const float *arrayB, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	for( size_t i = runSimd<ArrayArrayKernel<AddKernel>>( arrayA, arrayB, result, length ); i < length; i++ )
 		result[i] = arrayA[i] + arrayB[i];
 }
 
 void sub( const float *array, float scalar, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	for( size_t i = runSimd<ArrayScalarKernel<SubKernel>>( array, scalar, result, length ); i < length; i++ )
 		result[i] = array[i] - scalar;
 }
 
 void sub( const float *arrayA, const float *arrayB, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	for( size_t i = runSimd<ArrayArrayKernel<SubKernel>>( arrayA, arrayB, result, length ); i < length; i++ )
 		result[i] = arrayA[i] - arrayB[i];
 }
 
 float rms( const float *array, size_t length )
 {
 	float sumSquared( 0.0f );
-	for( size_t i = 0; i < length; i++ ) {
+	for( size_t i = runSimd<SumKernel<true>>( array, length, &sumSquared ); i < length; i++ ) {
 		float val = array[i];
 		sumSquared += val * val;
 	}
@@ -217,13 +461,13 @@ float rms( const float *array, size_t length )
 
 void mul( const float *array, float scalar, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	for( size_t i = runSimd<ArrayScalarKernel<MulKernel>>( array, scalar, result, length ); i < length; i++ )
 		result[i] = array[i] * scalar;
 }
 
 void mul( const float *arrayA, const float *arrayB, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	for( size_t i = runSimd<ArrayArrayKernel<MulKernel>>( arrayA, arrayB, result, length ); i < length; i++ )
 		result[i] = arrayA[i] * arrayB[i];
 }
 
@@ -240,7 +484,7 @@ void divide( const float *arrayA, const float *arrayB, float *result, size_t len
 
 void addMul( const float *arrayA, const float *arrayB, float scalar, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
+	for( size_t i = runSimd<AddMulKernel>( arrayA, arrayB, scalar, result, length ); i < length; i++ )
 		result[i] = ( arrayA[i] + arrayB[i] ) * scalar;
 }
 
@@ -249,7 +493,11 @@ void addMul( const float *arrayA, const float *arrayB, float scalar, float *resu
 void normalize( float *array, size_t length, float maxValue )
 {
 	float max = 0;
-	for( size_t i = 0; i < length; i++ ) {
+	size_t i = 0;
+#if ! defined( CINDER_AUDIO_VDSP )
+	i = runSimd<MaxKernel>( array, length, &max );
+#endif
+	for( ; i < length; i++ ) {
 		if( max < array[i] )
 			max = array[i];
 	}
@@ -26,6 +26,8 @@
 #include "cinder/audio/Exception.h"
 #include "cinder/CinderMath.h"
 
+#include <cstring>
+
 #if defined( CINDER_AUDIO_FFT_OOURA )
 	#include "cinder/audio/dsp/ooura/fftsg.h"
 #endif
@@ -134,7 +136,8 @@ void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
 	CI_ASSERT( waveform->getNumFrames() == mSize );
 	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
 
-	mBufferCopy.copy( *spectral );
+	// Buffer::copy() would only copy the real channel, as spectral has half the frames and two channels
+	std::memcpy( mBufferCopy.getData(), spectral->getData(), mSize * sizeof( float ) );
 
 	float *real = mBufferCopy.getData();
 	float *imag = &mBufferCopy.getData()[mSizeOverTwo];
@@ -30,6 +30,7 @@
 #include "cinder/gl/ConstantConversions.h"
 #include "cinder/gl/scoped.h"
 #include "cinder/ip/Flip.h"
+#include "cinder/ip/Pyramid.h"
 #include "cinder/Log.h"
 #include <stdio.h>
 #include <algorithm>
@@ -2250,6 +2251,80 @@ void TextureData::unmapDataStore()
 #endif
 }
 
+#if ! defined( CINDER_GL_ES_2 )
+template<typename T>
+void fillTextureData( const ip::Pyramid<T> &pyramid, TextureData *resultData )
+{
+	resultData->clear();
+	if( pyramid.getNumLevels() == 0 )
+		return;
+
+	const SurfaceT<T> &base = pyramid.getLevel( 0 );
+	const bool alpha = base.hasAlpha();
+	const size_t numChannels = alpha ? 4 : 3;
+	if( std::is_same<T, uint8_t>::value ) {
+		if( pyramid.getFormat().isSrgb() )
+			resultData->setInternalFormat( alpha ? GL_SRGB8_ALPHA8 : GL_SRGB8 );
+		else
+			resultData->setInternalFormat( alpha ? GL_RGBA8 : GL_RGB8 );
+		resultData->setDataType( GL_UNSIGNED_BYTE );
+	}
+#if ! defined( CINDER_GL_ES )
+	else if( std::is_same<T, uint16_t>::value ) {
+		resultData->setInternalFormat( alpha ? GL_RGBA16 : GL_RGB16 );
+		resultData->setDataType( GL_UNSIGNED_SHORT );
+	}
+#endif
+	else {
+		resultData->setInternalFormat( alpha ? GL_RGBA32F : GL_RGB32F );
+		resultData->setDataType( GL_FLOAT );
+	}
+	resultData->setDataFormat( alpha ? GL_RGBA : GL_RGB );
+	resultData->setUnpackAlignment( 1 );
+	resultData->setWidth( base.getWidth() );
+	resultData->setHeight( base.getHeight() );
+	resultData->setDepth( 1 );
+	resultData->setNumFaces( 1 );
+
+	size_t spaceRequired = 0;
+	for( const auto &level : pyramid.getLevels() )
+		spaceRequired += level.getWidth() * level.getHeight() * numChannels * sizeof( T );
+	resultData->allocateDataStore( spaceRequired );
+
+	resultData->mapDataStore();
+	size_t byteOffset = 0;
+	for( const auto &surface : pyramid.getLevels() ) {
+		resultData->push_back( TextureData::Level() );
+		TextureData::Level &level = resultData->back();
+		level.width = surface.getWidth();
+		level.height = surface.getHeight();
+		level.depth = 0;
+		level.push_back( TextureData::Face() );
+		level.back().dataSize = (GLsizei)( surface.getWidth() * surface.getHeight() * numChannels * sizeof( T ) );
+		level.back().offset = byteOffset;
+
+		const uint8_t offsets[4] = { surface.getRedOffset(), surface.getGreenOffset(), surface.getBlueOffset(), surface.getAlphaOffset() };
+		const uint8_t pixelInc = surface.getPixelInc();
+		T *dst = reinterpret_cast<T*>( resultData->getDataStorePtr( byteOffset ) );
+		for( int32_t y = surface.getHeight() - 1; y >= 0; --y ) {
+			const T *src = surface.getData( ivec2( 0, y ) );
+			for( int32_t x = 0; x < surface.getWidth(); ++x, src += pixelInc ) {
+				for( size_t c = 0; c < numChannels; ++c )
+					*dst++ = src[offsets[c]];
+			}
+		}
+		byteOffset += level.back().dataSize;
+	}
+	resultData->unmapDataStore();
+}
+
+template void fillTextureData<uint8_t>( const ip::Pyramid<uint8_t> &pyramid, TextureData *resultData );
+template void fillTextureData<float>( const ip::Pyramid<float> &pyramid, TextureData *resultData );
+#if ! defined( CINDER_GL_ES )
+template void fillTextureData<uint16_t>( const ip::Pyramid<uint16_t> &pyramid, TextureData *resultData );
+#endif
+#endif // ! defined( CINDER_GL_ES_2 )
+
 void* TextureData::getDataStorePtr( size_t offset ) const
 {
 #if ! defined( CINDER_GL_ES )
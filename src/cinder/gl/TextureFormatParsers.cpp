@@ -128,6 +128,59 @@ void parseKtx( const DataSourceRef &dataSource, TextureData *resultData )
 	resultData->unmapDataStore();
 }
 
+void writeKtx( const TextureData &textureData, const DataTargetRef &dataTarget )
+{
+	static const uint8_t FileIdentifier[12] = {
+		0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+	};
+
+	if( textureData.getNumLevels() == 0 )
+		throw TextureDataExc( "Cannot write KTX without any levels" );
+
+	GLenum baseInternalFormat = textureData.getDataFormat();
+	if( textureData.isCompressed() ) {
+		switch( textureData.getInternalFormat() ) {
+#if ! defined( CINDER_GL_ES ) || defined( CINDER_GL_ANGLE )
+			case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:	baseInternalFormat = GL_RGB;	break;
+#endif
+#if ! defined( CINDER_GL_ES )
+			case GL_COMPRESSED_RED_RGTC1:			baseInternalFormat = GL_RED;	break;
+			case GL_COMPRESSED_RG_RGTC2:			baseInternalFormat = GL_RG;		break;
+#endif
+			default:								baseInternalFormat = GL_RGBA;	break;
+		}
+	}
+
+	uint32_t typeSize = 1;
+	if( textureData.getDataType() == GL_UNSIGNED_SHORT )
+		typeSize = 2;
+#if ! defined( CINDER_GL_ES_2 )
+	else if( textureData.getDataType() == GL_HALF_FLOAT )
+		typeSize = 2;
+#endif
+	else if( textureData.getDataType() == GL_FLOAT )
+		typeSize = 4;
+
+	const uint32_t header[13] = { 0x04030201, textureData.getDataType(), typeSize, textureData.getDataFormat(), (uint32_t)textureData.getInternalFormat(),
+		baseInternalFormat, (uint32_t)textureData.getWidth(), (uint32_t)textureData.getHeight(), 0 /* pixelDepth */, 0 /* numberOfArrayElements */,
+		(uint32_t)textureData.getNumFaces(), (uint32_t)textureData.getNumLevels(), 0 /* bytesOfKeyValueData */ };
+
+	auto stream = dataTarget->getStream();
+	stream->writeData( FileIdentifier, sizeof(FileIdentifier) );
+	for( uint32_t value : header )
+		stream->writeLittle( value );
+
+	const uint8_t padding[3] = { 0, 0, 0 };
+	for( const auto &level : textureData.getLevels() ) {
+		const uint32_t imageSize = level.getFace( 0 ).dataSize;
+		stream->writeLittle( imageSize );
+		for( const auto &face : level.getFaces() ) {
+			stream->writeData( textureData.getDataStorePtr( face.offset ), face.dataSize );
+			stream->writeData( padding, 3 - ( face.dataSize + 3 ) % 4 ); // cube padding
+		}
+	}
+}
+
 #if ! defined( CINDER_GL_ES ) || defined( CINDER_GL_ANGLE )
 void parseDds( const DataSourceRef &dataSource, TextureData *resultData )
 {
@@ -458,6 +511,115 @@ void parseDds( const DataSourceRef &dataSource, TextureData *resultData )
 
 	resultData->unmapDataStore();
 }
+
+namespace {
+
+GLint toInternalFormat( ip::BlockFormat format, bool alpha )
+{
+	switch( format ) {
+		case ip::BlockFormat::BC1:	return alpha ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case ip::BlockFormat::BC3:	return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+#if ! defined( CINDER_GL_ANGLE )
+		case ip::BlockFormat::BC4:	return GL_COMPRESSED_RED_RGTC1;
+		case ip::BlockFormat::BC5:	return GL_COMPRESSED_RG_RGTC2;
+#endif
+		default:					throw TextureDataExc( "Block format is not supported by this OpenGL implementation" );
+	}
+}
+
+void compressLevels( const std::vector<Surface8u> &levels, ip::BlockFormat format, TextureData *resultData, ip::BlockQuality quality, int numThreads )
+{
+	if( levels.empty() )
+		throw TextureDataExc( "Cannot compress an empty image" );
+
+	const Surface8u &base = levels.front();
+	resultData->setWidth( base.getWidth() );
+	resultData->setHeight( base.getHeight() );
+	resultData->setDepth( 1 );
+	resultData->setNumFaces( 1 );
+	resultData->setUnpackAlignment( 4 );
+	resultData->setDataFormat( 0 );
+	resultData->setInternalFormat( toInternalFormat( format, base.hasAlpha() ) );
+	resultData->setDataType( 0 ); // 0 implies compressed
+
+	size_t spaceRequired = 0;
+	for( const auto &surface : levels )
+		spaceRequired += ip::calcBlockCompressedSize( format, surface.getSize() );
+	resultData->clear();
+	resultData->allocateDataStore( spaceRequired );
+
+	resultData->mapDataStore();
+	size_t byteOffset = 0;
+	for( const auto &surface : levels ) {
+		resultData->push_back( TextureData::Level() );
+		TextureData::Level &level = resultData->back();
+		level.width = surface.getWidth();
+		level.height = surface.getHeight();
+		level.depth = 0;
+		level.push_back( TextureData::Face() );
+		level.back().dataSize = (GLsizei)ip::calcBlockCompressedSize( format, surface.getSize() );
+		level.back().offset = byteOffset;
+
+		ip::blockCompress( surface, format, static_cast<uint8_t*>( resultData->getDataStorePtr( byteOffset ) ), quality, numThreads );
+		byteOffset += level.back().dataSize;
+	}
+	resultData->unmapDataStore();
+}
+
+} // anonymous namespace
+
+void compressTextureData( const Surface8u &surface, ip::BlockFormat format, TextureData *resultData, ip::BlockQuality quality, int numThreads )
+{
+	compressLevels( std::vector<Surface8u>( 1, surface ), format, resultData, quality, numThreads );
+}
+
+void compressTextureData( const ip::Pyramid8u &pyramid, ip::BlockFormat format, TextureData *resultData, ip::BlockQuality quality, int numThreads )
+{
+	compressLevels( pyramid.getLevels(), format, resultData, quality, numThreads );
+}
+
+void writeDds( const TextureData &textureData, const DataTargetRef &dataTarget )
+{
+	enum { FOURCC_DXT1 = 0x31545844, FOURCC_DXT3 = 0x33545844, FOURCC_DXT5 = 0x35545844, FOURCC_ATI1 = 0x31495441, FOURCC_ATI2= 0x32495441 };
+	enum { DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000, DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000 };
+	enum { DDPF_FOURCC = 0x4, DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000 };
+
+	uint32_t fourCC;
+	switch( textureData.getInternalFormat() ) {
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:	fourCC = FOURCC_DXT1;	break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:	fourCC = FOURCC_DXT3;	break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:	fourCC = FOURCC_DXT5;	break;
+#if ! defined( CINDER_GL_ANGLE )
+		case GL_COMPRESSED_RED_RGTC1:			fourCC = FOURCC_ATI1;	break;
+		case GL_COMPRESSED_RG_RGTC2:			fourCC = FOURCC_ATI2;	break;
+#endif
+		default:
+			throw TextureDataExc( "Only DXT1, DXT3, DXT5, RGTC1 and RGTC2 data can be written as DDS" );
+	}
+	if( textureData.getNumLevels() == 0 || textureData.getNumFaces() != 1 )
+		throw TextureDataExc( "Only 2D textures with at least one level can be written as DDS" );
+
+	const bool mipmapped = textureData.getNumLevels() > 1;
+	uint32_t header[31] = {};
+	header[0] = 124; // dwSize
+	header[1] = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE | ( mipmapped ? DDSD_MIPMAPCOUNT : 0 );
+	header[2] = textureData.getHeight();
+	header[3] = textureData.getWidth();
+	header[4] = textureData.getLevels()[0].getFace( 0 ).dataSize;
+	header[6] = (uint32_t)textureData.getNumLevels();
+	header[18] = 32; // ddpfPixelFormat.dwSize
+	header[19] = DDPF_FOURCC;
+	header[20] = fourCC;
+	header[26] = DDSCAPS_TEXTURE | ( mipmapped ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0 );
+
+	auto stream = dataTarget->getStream();
+	stream->writeData( "DDS ", 4 );
+	for( uint32_t value : header )
+		stream->writeLittle( value );
+	for( const auto &level : textureData.getLevels() )
+		stream->writeData( textureData.getDataStorePtr( level.getFace( 0 ).offset ), level.getFace( 0 ).dataSize );
+}
 #endif // ! defined( CINDER_GL_ES ) || defined( CINDER_GL_ANGLE )
 
 } } // namespace cinder::gl
\ No newline at end of file
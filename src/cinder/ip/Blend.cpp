@@ -23,6 +23,8 @@
 
 #include "cinder/ip/Blend.h"
 #include "cinder/ip/Fill.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/CinderSimd.h"
 
 using namespace std;
 
@@ -35,204 +37,517 @@ namespace cinder { namespace ip {
 	αr×Cr = (1–αs)×Cd + (1–αd)×Cs + B(Cd, αd, Cs, αs)				Premult * Premult
 */
 
+namespace {
+
+// Offsets of the channels of a Surface and its pixel increment
+struct BlendChannels {
+	BlendChannels() : r( 0 ), g( 0 ), b( 0 ), a( 0 ), inc( 0 ) {}
+	template<typename T>
+	BlendChannels( const SurfaceT<T> &surface )
+		: r( surface.getRedOffset() ), g( surface.getGreenOffset() ), b( surface.getBlueOffset() ),
+			a( surface.hasAlpha() ? surface.getAlphaOffset() : 0 ), inc( surface.getPixelInc() )
+	{}
+
+	uint8_t		r, g, b, a, inc;
+};
+
+template<typename T>
+struct BlendRow {
+	typedef void (*Fn)( const T *src, const BlendChannels &srcChannels, T *dst, const BlendChannels &dstChannels, int32_t width );
+};
+
 template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
-void blendImpl_u8( Surface8u *background, const Surface8u &foreground, const Area &srcArea, ivec2 absOffset )
-{
-	bool SRCALPHA = foreground.hasAlpha();
-	const ptrdiff_t srcRowBytes = foreground.getRowBytes();
-	const uint8_t sR = foreground.getChannelOrder().getRedOffset();
-	const uint8_t sG = foreground.getChannelOrder().getGreenOffset();
-	const uint8_t sB = foreground.getChannelOrder().getBlueOffset();
-	const uint8_t sA = SRCALPHA ? (foreground.getChannelOrder().getAlphaOffset()) : 0;	
-	const uint8_t srcInc = foreground.getPixelInc();
-	const ptrdiff_t dstRowBytes = background->getRowBytes();
-	const uint8_t dR = background->getChannelOrder().getRedOffset();
-	const uint8_t dG = background->getChannelOrder().getGreenOffset();
-	const uint8_t dB = background->getChannelOrder().getBlueOffset();
-	const uint8_t dA = DSTALPHA ? (background->getChannelOrder().getAlphaOffset()) : 0;
-	const uint8_t dstInc = background->getPixelInc();
-	const int32_t width = srcArea.getWidth();
-	
-	if( ! SRCALPHA ) {// normal blend with no src alpha is a copy
-		ivec2 relativeOffset = absOffset - srcArea.getUL();
-		background->copyFrom( foreground, srcArea, relativeOffset );
+void blendRow_u8( const uint8_t *src, const BlendChannels &srcChannels, uint8_t *dst, const BlendChannels &dstChannels, int32_t width )
+{
+	const bool SRCALPHA = true;
+	const uint8_t sR = srcChannels.r, sG = srcChannels.g, sB = srcChannels.b, sA = srcChannels.a, srcInc = srcChannels.inc;
+	const uint8_t dR = dstChannels.r, dG = dstChannels.g, dB = dstChannels.b, dA = dstChannels.a, dstInc = dstChannels.inc;
+	for( int32_t x = 0; x < width; ++x ) {
+		const uint8_t alphaS = (SRCALPHA) ? src[sA] : 255;
+		const uint8_t invAlphaS = (SRCALPHA) ? CHANTRAIT<uint8_t>::inverse(src[sA]) : 0;
+		const uint8_t alphaD = (DSTALPHA) ? dst[dA] : CHANTRAIT<uint8_t>::max();
+		const uint8_t invAlphaD = (DSTALPHA) ? CHANTRAIT<uint8_t>::inverse(dst[dA]) : 0;
 		if( DSTALPHA )
-			ip::fill( &background->getChannelAlpha(), (uint8_t)255 );
-		return;
-	}
-	
-	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const uint8_t *src = reinterpret_cast<const uint8_t*>( reinterpret_cast<const uint8_t*>( foreground.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
-		uint8_t *dst = reinterpret_cast<uint8_t*>( reinterpret_cast<uint8_t*>( background->getData() + absOffset.x * 4 ) + ( y + absOffset.y ) * dstRowBytes );
-		for( int32_t x = 0; x < width; ++x ) {
-			const uint8_t alphaS = (SRCALPHA) ? src[sA] : 255;
-			const uint8_t invAlphaS = (SRCALPHA) ? CHANTRAIT<uint8_t>::inverse(src[sA]) : 0;
-			const uint8_t alphaD = (DSTALPHA) ? dst[dA] : CHANTRAIT<uint8_t>::max();
-			const uint8_t invAlphaD = (DSTALPHA) ? CHANTRAIT<uint8_t>::inverse(dst[dA]) : 0;
-			if( DSTALPHA )
-				dst[dA] = 255 - invAlphaS * invAlphaD / 255;			
-			if( ( ! DSTALPHA ) || dst[dA] ) {
-				if( ! DSTALPHA && ! SRCPREMULT ) { // none * unpremult -> none
-					dst[dR] = ( invAlphaS * dst[dR] + alphaS * src[sR] ) / 255;
-					dst[dG] = ( invAlphaS * dst[dG] + alphaS * src[sG] ) / 255;
-					dst[dB] = ( invAlphaS * dst[dB] + alphaS * src[sB] ) / 255;
-				}			
-				else if( ! DSTALPHA && SRCPREMULT ) { // none * premult -> none
-					dst[dR] = invAlphaS * dst[dR] / 255 + src[sR];
-					dst[dG] = invAlphaS * dst[dG] / 255 + src[sG];
-					dst[dB] = invAlphaS * dst[dB] / 255 + src[sB];
-				}
-				else if( ! DSTPREMULT && ! SRCPREMULT ) { // unpremult * unpremult -> unpremult
-					dst[dR] = ( invAlphaS * alphaD * dst[dR] + invAlphaD * alphaS * src[sR] + alphaD * alphaS * src[sR] ) / ( 255 * dst[dA] );
-					dst[dG] = ( invAlphaS * alphaD * dst[dG] + invAlphaD * alphaS * src[sG] + alphaD * alphaS * src[sG] ) / ( 255 * dst[dA] );
-					dst[dB] = ( invAlphaS * alphaD * dst[dB] + invAlphaD * alphaS * src[sB] + alphaD * alphaS * src[sB] ) / ( 255 * dst[dA] );
-				}
-				else if( ! DSTPREMULT && SRCPREMULT ) { // unpremult * premult -> unpremult
-					dst[dR] = ( invAlphaS * alphaD * dst[dR] / 255 + invAlphaD * src[sR] + alphaD * src[sR] ) / dst[dA];
-					dst[dG] = ( invAlphaS * alphaD * dst[dG] / 255 + invAlphaD * src[sG] + alphaD * src[sG] ) / dst[dA];
-					dst[dB] = ( invAlphaS * alphaD * dst[dB] / 255 + invAlphaD * src[sB] + alphaD * src[sB] ) / dst[dA];
-				}
-				else if( DSTPREMULT && SRCPREMULT ) { // premult * premult -> premult
-					dst[dR] = ( invAlphaS * dst[dR] + invAlphaD * src[sR] + alphaD * src[sR] ) / 255;
-					dst[dG] = ( invAlphaS * dst[dG] + invAlphaD * src[sG] + alphaD * src[sG] ) / 255;
-					dst[dB] = ( invAlphaS * dst[dB] + invAlphaD * src[sB] + alphaD * src[sB] ) / 255;
-				}
-				else if( DSTPREMULT && ! SRCPREMULT ) { // premult * unpremult -> premult
-					dst[dR] = ( invAlphaS * dst[dR] + ( invAlphaD * alphaS * src[sR] + alphaD * alphaS * src[sR] ) / 255 ) / 255;
-					dst[dG] = ( invAlphaS * dst[dG] + ( invAlphaD * alphaS * src[sG] + alphaD * alphaS * src[sG] ) / 255 ) / 255;
-					dst[dB] = ( invAlphaS * dst[dB] + ( invAlphaD * alphaS * src[sB] + alphaD * alphaS * src[sB] ) / 255 ) / 255;
-				}
+			dst[dA] = 255 - invAlphaS * invAlphaD / 255;			
+		if( ( ! DSTALPHA ) || dst[dA] ) {
+			if( ! DSTALPHA && ! SRCPREMULT ) { // none * unpremult -> none
+				dst[dR] = ( invAlphaS * dst[dR] + alphaS * src[sR] ) / 255;
+				dst[dG] = ( invAlphaS * dst[dG] + alphaS * src[sG] ) / 255;
+				dst[dB] = ( invAlphaS * dst[dB] + alphaS * src[sB] ) / 255;
+			}			
+			else if( ! DSTALPHA && SRCPREMULT ) { // none * premult -> none
+				dst[dR] = invAlphaS * dst[dR] / 255 + src[sR];
+				dst[dG] = invAlphaS * dst[dG] / 255 + src[sG];
+				dst[dB] = invAlphaS * dst[dB] / 255 + src[sB];
+			}
+			else if( ! DSTPREMULT && ! SRCPREMULT ) { // unpremult * unpremult -> unpremult
+				dst[dR] = ( invAlphaS * alphaD * dst[dR] + invAlphaD * alphaS * src[sR] + alphaD * alphaS * src[sR] ) / ( 255 * dst[dA] );
+				dst[dG] = ( invAlphaS * alphaD * dst[dG] + invAlphaD * alphaS * src[sG] + alphaD * alphaS * src[sG] ) / ( 255 * dst[dA] );
+				dst[dB] = ( invAlphaS * alphaD * dst[dB] + invAlphaD * alphaS * src[sB] + alphaD * alphaS * src[sB] ) / ( 255 * dst[dA] );
+			}
+			else if( ! DSTPREMULT && SRCPREMULT ) { // unpremult * premult -> unpremult
+				dst[dR] = ( invAlphaS * alphaD * dst[dR] / 255 + invAlphaD * src[sR] + alphaD * src[sR] ) / dst[dA];
+				dst[dG] = ( invAlphaS * alphaD * dst[dG] / 255 + invAlphaD * src[sG] + alphaD * src[sG] ) / dst[dA];
+				dst[dB] = ( invAlphaS * alphaD * dst[dB] / 255 + invAlphaD * src[sB] + alphaD * src[sB] ) / dst[dA];
+			}
+			else if( DSTPREMULT && SRCPREMULT ) { // premult * premult -> premult
+				dst[dR] = ( invAlphaS * dst[dR] + invAlphaD * src[sR] + alphaD * src[sR] ) / 255;
+				dst[dG] = ( invAlphaS * dst[dG] + invAlphaD * src[sG] + alphaD * src[sG] ) / 255;
+				dst[dB] = ( invAlphaS * dst[dB] + invAlphaD * src[sB] + alphaD * src[sB] ) / 255;
+			}
+			else if( DSTPREMULT && ! SRCPREMULT ) { // premult * unpremult -> premult
+				dst[dR] = ( invAlphaS * dst[dR] + ( invAlphaD * alphaS * src[sR] + alphaD * alphaS * src[sR] ) / 255 ) / 255;
+				dst[dG] = ( invAlphaS * dst[dG] + ( invAlphaD * alphaS * src[sG] + alphaD * alphaS * src[sG] ) / 255 ) / 255;
+				dst[dB] = ( invAlphaS * dst[dB] + ( invAlphaD * alphaS * src[sB] + alphaD * alphaS * src[sB] ) / 255 ) / 255;
 			}
-			src += srcInc;
-			dst += dstInc;
 		}
+		src += srcInc;
+		dst += dstInc;
 	}
 }
 
 template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
-void blendImpl_float( Surface32f *background, const Surface32f &foreground, const Area &srcArea, ivec2 absOffset )
-{
-	bool SRCALPHA = foreground.hasAlpha();
-	const ptrdiff_t srcRowBytes = foreground.getRowBytes();
-	const uint8_t sR = foreground.getChannelOrder().getRedOffset();
-	const uint8_t sG = foreground.getChannelOrder().getGreenOffset();
-	const uint8_t sB = foreground.getChannelOrder().getBlueOffset();
-	const uint8_t sA = SRCALPHA ? (foreground.getChannelOrder().getAlphaOffset()) : 0;	
-	const uint8_t srcInc = foreground.getPixelInc();
-	const ptrdiff_t dstRowBytes = background->getRowBytes();
-	const uint8_t dR = background->getChannelOrder().getRedOffset();
-	const uint8_t dG = background->getChannelOrder().getGreenOffset();
-	const uint8_t dB = background->getChannelOrder().getBlueOffset();
-	const uint8_t dA = DSTALPHA ? (background->getChannelOrder().getAlphaOffset()) : 0;
-	const uint8_t dstInc = background->getPixelInc();	
-	const int32_t width = srcArea.getWidth();
-	
-	if( ! SRCALPHA ) {// normal blend with no src alpha is a copy
-		ivec2 relativeOffset = absOffset - srcArea.getUL();
-		background->copyFrom( foreground, srcArea, relativeOffset );
+void blendRow_float( const float *src, const BlendChannels &srcChannels, float *dst, const BlendChannels &dstChannels, int32_t width )
+{
+	const bool SRCALPHA = true;
+	const uint8_t sR = srcChannels.r, sG = srcChannels.g, sB = srcChannels.b, sA = srcChannels.a, srcInc = srcChannels.inc;
+	const uint8_t dR = dstChannels.r, dG = dstChannels.g, dB = dstChannels.b, dA = dstChannels.a, dstInc = dstChannels.inc;
+	for( int32_t x = 0; x < width; ++x ) {
+		const float alphaS = (SRCALPHA) ? src[sA] : 1;
+		const float invAlphaS = (SRCALPHA) ? CHANTRAIT<float>::inverse(src[sA]) : 0;
+		const float alphaD = (DSTALPHA) ? dst[dA] : CHANTRAIT<float>::max();
+		const float invAlphaD = (DSTALPHA) ? CHANTRAIT<float>::inverse(dst[dA]) : 0;
 		if( DSTALPHA )
-			ip::fill( &background->getChannelAlpha(), 1.0f );
-		return;
-	}
-	
-	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const float *src = reinterpret_cast<const float*>( reinterpret_cast<const uint8_t*>( foreground.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
-		float *dst = reinterpret_cast<float*>( reinterpret_cast<uint8_t*>( background->getData() + absOffset.x * 4 ) + ( y + absOffset.y ) * dstRowBytes );
-		for( int32_t x = 0; x < width; ++x ) {
-			const float alphaS = (SRCALPHA) ? src[sA] : 1;
-			const float invAlphaS = (SRCALPHA) ? CHANTRAIT<float>::inverse(src[sA]) : 0;
-			const float alphaD = (DSTALPHA) ? dst[dA] : CHANTRAIT<float>::max();
-			const float invAlphaD = (DSTALPHA) ? CHANTRAIT<float>::inverse(dst[dA]) : 0;
-			if( DSTALPHA )
-				dst[dA] = 1 - invAlphaS * invAlphaD;
-			if( ( ! DSTALPHA ) || dst[dA] ) {
-				if( ! DSTALPHA && ! SRCPREMULT ) { // none * unpremult -> none
-					dst[dR] = invAlphaS * dst[dR] + alphaS * src[sR];
-					dst[dG] = invAlphaS * dst[dG] + alphaS * src[sG];
-					dst[dB] = invAlphaS * dst[dB] + alphaS * src[sB];
-				}			
-				else if( ! DSTALPHA && SRCPREMULT ) { // none * premult -> none
-					dst[dR] = invAlphaS * dst[dR] + src[sR];
-					dst[dG] = invAlphaS * dst[dG] + src[sG];
-					dst[dB] = invAlphaS * dst[dB] + src[sB];
-				}
-				else if( ! DSTPREMULT && ! SRCPREMULT ) { // unpremult * unpremult -> unpremult
-					float invDstA = 1.0f / dst[dA];
-					dst[dR] = ( invAlphaS * alphaD * dst[dR] + invAlphaD * alphaS * src[sR] + alphaD * alphaS * src[sR] ) * invDstA;
-					dst[dG] = ( invAlphaS * alphaD * dst[dG] + invAlphaD * alphaS * src[sG] + alphaD * alphaS * src[sG] ) * invDstA;
-					dst[dB] = ( invAlphaS * alphaD * dst[dB] + invAlphaD * alphaS * src[sB] + alphaD * alphaS * src[sB] ) * invDstA;
-				}
-				else if( ! DSTPREMULT && SRCPREMULT ) { // unpremult * premult -> unpremult
-					float invDstA = 1.0f / dst[dA];
-					dst[dR] = ( invAlphaS * alphaD * dst[dR] + invAlphaD * src[sR] + alphaD * src[sR] ) * invDstA;
-					dst[dG] = ( invAlphaS * alphaD * dst[dG] + invAlphaD * src[sG] + alphaD * src[sG] ) * invDstA;
-					dst[dB] = ( invAlphaS * alphaD * dst[dB] + invAlphaD * src[sB] + alphaD * src[sB] ) * invDstA;
-				}
-				else if( DSTPREMULT && SRCPREMULT ) { // premult * premult -> premult
-					dst[dR] = invAlphaS * dst[dR] + invAlphaD * src[sR] + alphaD * src[sR];
-					dst[dG] = invAlphaS * dst[dG] + invAlphaD * src[sG] + alphaD * src[sG];
-					dst[dB] = invAlphaS * dst[dB] + invAlphaD * src[sB] + alphaD * src[sB];
-				}
-				else if( DSTPREMULT && ! SRCPREMULT ) { // premult * unpremult -> premult
-					dst[dR] = invAlphaS * dst[dR] + invAlphaD * alphaS * src[sR] + alphaD * alphaS * src[sR];
-					dst[dG] = invAlphaS * dst[dG] + invAlphaD * alphaS * src[sG] + alphaD * alphaS * src[sG];
-					dst[dB] = invAlphaS * dst[dB] + invAlphaD * alphaS * src[sB] + alphaD * alphaS * src[sB];
-				}
+			dst[dA] = 1 - invAlphaS * invAlphaD;
+		if( ( ! DSTALPHA ) || dst[dA] ) {
+			if( ! DSTALPHA && ! SRCPREMULT ) { // none * unpremult -> none
+				dst[dR] = invAlphaS * dst[dR] + alphaS * src[sR];
+				dst[dG] = invAlphaS * dst[dG] + alphaS * src[sG];
+				dst[dB] = invAlphaS * dst[dB] + alphaS * src[sB];
+			}			
+			else if( ! DSTALPHA && SRCPREMULT ) { // none * premult -> none
+				dst[dR] = invAlphaS * dst[dR] + src[sR];
+				dst[dG] = invAlphaS * dst[dG] + src[sG];
+				dst[dB] = invAlphaS * dst[dB] + src[sB];
+			}
+			else if( ! DSTPREMULT && ! SRCPREMULT ) { // unpremult * unpremult -> unpremult
+				float invDstA = 1.0f / dst[dA];
+				dst[dR] = ( invAlphaS * alphaD * dst[dR] + invAlphaD * alphaS * src[sR] + alphaD * alphaS * src[sR] ) * invDstA;
+				dst[dG] = ( invAlphaS * alphaD * dst[dG] + invAlphaD * alphaS * src[sG] + alphaD * alphaS * src[sG] ) * invDstA;
+				dst[dB] = ( invAlphaS * alphaD * dst[dB] + invAlphaD * alphaS * src[sB] + alphaD * alphaS * src[sB] ) * invDstA;
+			}
+			else if( ! DSTPREMULT && SRCPREMULT ) { // unpremult * premult -> unpremult
+				float invDstA = 1.0f / dst[dA];
+				dst[dR] = ( invAlphaS * alphaD * dst[dR] + invAlphaD * src[sR] + alphaD * src[sR] ) * invDstA;
+				dst[dG] = ( invAlphaS * alphaD * dst[dG] + invAlphaD * src[sG] + alphaD * src[sG] ) * invDstA;
+				dst[dB] = ( invAlphaS * alphaD * dst[dB] + invAlphaD * src[sB] + alphaD * src[sB] ) * invDstA;
+			}
+			else if( DSTPREMULT && SRCPREMULT ) { // premult * premult -> premult
+				dst[dR] = invAlphaS * dst[dR] + invAlphaD * src[sR] + alphaD * src[sR];
+				dst[dG] = invAlphaS * dst[dG] + invAlphaD * src[sG] + alphaD * src[sG];
+				dst[dB] = invAlphaS * dst[dB] + invAlphaD * src[sB] + alphaD * src[sB];
+			}
+			else if( DSTPREMULT && ! SRCPREMULT ) { // premult * unpremult -> premult
+				dst[dR] = invAlphaS * dst[dR] + invAlphaD * alphaS * src[sR] + alphaD * alphaS * src[sR];
+				dst[dG] = invAlphaS * dst[dG] + invAlphaD * alphaS * src[sG] + alphaD * alphaS * src[sG];
+				dst[dB] = invAlphaS * dst[dB] + invAlphaD * alphaS * src[sB] + alphaD * alphaS * src[sB];
 			}
-			src += srcInc;
-			dst += dstInc;
 		}
+		src += srcInc;
+		dst += dstInc;
 	}
 }
 
-void blend( Surface8u *background, const Surface8u &foreground, const Area &srcArea, const ivec2 &dstRelativeOffset )
+template<typename T, bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+struct BlendRowScalar {};
+
+template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+struct BlendRowScalar<uint8_t,DSTALPHA,DSTPREMULT,SRCPREMULT> {
+	static void run( const uint8_t *src, const BlendChannels &srcChannels, uint8_t *dst, const BlendChannels &dstChannels, int32_t width )
+	{ blendRow_u8<DSTALPHA,DSTPREMULT,SRCPREMULT>( src, srcChannels, dst, dstChannels, width ); }
+};
+
+template<bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+struct BlendRowScalar<float,DSTALPHA,DSTPREMULT,SRCPREMULT> {
+	static void run( const float *src, const BlendChannels &srcChannels, float *dst, const BlendChannels &dstChannels, int32_t width )
+	{ blendRow_float<DSTALPHA,DSTPREMULT,SRCPREMULT>( src, srcChannels, dst, dstChannels, width ); }
+};
+
+#if defined( CINDER_SIMD_SSE2 )
+
+// 8u: pixels are widened to 16-bit lanes, where every product of two channels fits. x / 255 is computed exactly for
+// x in [0, 255 * 255] as ( x + 1 + ( x >> 8 ) ) >> 8, so the vector kernels match the scalar rows bit for bit.
+struct BlendOpsSse2_8u {
+	typedef __m128i		V;
+	static const int PIXELS = 4;
+
+	BlendOpsSse2_8u() : mZero( _mm_setzero_si128() ), mMax( _mm_set1_epi16( 255 ) ), mOne( _mm_set1_epi16( 1 ) ) {}
+
+	void load( V &v, const uint8_t *p ) const					{ v = _mm_loadu_si128( (const __m128i*)p ); }
+	void store( uint8_t *p, const V &v ) const					{ _mm_storeu_si128( (__m128i*)p, v ); }
+	void unpackLo( V &r, const V &v ) const						{ r = _mm_unpacklo_epi8( v, mZero ); }
+	void unpackHi( V &r, const V &v ) const						{ r = _mm_unpackhi_epi8( v, mZero ); }
+	void pack( V &r, const V &lo, const V &hi ) const			{ r = _mm_packus_epi16( lo, hi ); }
+	void add( V &r, const V &a, const V &b ) const				{ r = _mm_add_epi16( a, b ); }
+	void sub( V &r, const V &a, const V &b ) const				{ r = _mm_sub_epi16( a, b ); }
+	void mul( V &r, const V &a, const V &b ) const				{ r = _mm_mullo_epi16( a, b ); }
+	void inverse( V &r, const V &a ) const						{ r = _mm_sub_epi16( mMax, a ); }
+	void div255( V &r, const V &a ) const						{ r = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( a, mOne ), _mm_srli_epi16( a, 8 ) ), 8 ); }
+	void isZero( V &r, const V &a ) const						{ r = _mm_cmpeq_epi16( a, mZero ); }
+	void select( V &r, const V &mask, const V &a, const V &b ) const	{ r = _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) ); }
+	template<int A>
+	void broadcastAlpha( V &r, const V &v ) const				{ r = _mm_shufflehi_epi16( _mm_shufflelo_epi16( v, _MM_SHUFFLE( A, A, A, A ) ), _MM_SHUFFLE( A, A, A, A ) ); }
+	template<int A>
+	void alphaMask( V &r ) const								{ r = _mm_set1_epi64x( (long long)( 0xFFFFULL << ( 16 * A ) ) ); }
+
+	__m128i		mZero, mMax, mOne;
+};
+
+struct BlendOpsAvx2_8u {
+	typedef __m256i		V;
+	static const int PIXELS = 8;
+
+	CINDER_SIMD_TARGET_AVX2 BlendOpsAvx2_8u() : mZero( _mm256_setzero_si256() ), mMax( _mm256_set1_epi16( 255 ) ), mOne( _mm256_set1_epi16( 1 ) ) {}
+
+	CINDER_SIMD_TARGET_AVX2 void load( V &v, const uint8_t *p ) const				{ v = _mm256_loadu_si256( (const __m256i*)p ); }
+	CINDER_SIMD_TARGET_AVX2 void store( uint8_t *p, const V &v ) const				{ _mm256_storeu_si256( (__m256i*)p, v ); }
+	CINDER_SIMD_TARGET_AVX2 void unpackLo( V &r, const V &v ) const					{ r = _mm256_unpacklo_epi8( v, mZero ); }
+	CINDER_SIMD_TARGET_AVX2 void unpackHi( V &r, const V &v ) const					{ r = _mm256_unpackhi_epi8( v, mZero ); }
+	CINDER_SIMD_TARGET_AVX2 void pack( V &r, const V &lo, const V &hi ) const		{ r = _mm256_packus_epi16( lo, hi ); }
+	CINDER_SIMD_TARGET_AVX2 void add( V &r, const V &a, const V &b ) const			{ r = _mm256_add_epi16( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void sub( V &r, const V &a, const V &b ) const			{ r = _mm256_sub_epi16( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void mul( V &r, const V &a, const V &b ) const			{ r = _mm256_mullo_epi16( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void inverse( V &r, const V &a ) const					{ r = _mm256_sub_epi16( mMax, a ); }
+	CINDER_SIMD_TARGET_AVX2 void div255( V &r, const V &a ) const					{ r = _mm256_srli_epi16( _mm256_add_epi16( _mm256_add_epi16( a, mOne ), _mm256_srli_epi16( a, 8 ) ), 8 ); }
+	CINDER_SIMD_TARGET_AVX2 void isZero( V &r, const V &a ) const					{ r = _mm256_cmpeq_epi16( a, mZero ); }
+	CINDER_SIMD_TARGET_AVX2 void select( V &r, const V &mask, const V &a, const V &b ) const	{ r = _mm256_blendv_epi8( b, a, mask ); }
+	template<int A>
+	CINDER_SIMD_TARGET_AVX2 void broadcastAlpha( V &r, const V &v ) const			{ r = _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( v, _MM_SHUFFLE( A, A, A, A ) ), _MM_SHUFFLE( A, A, A, A ) ); }
+	template<int A>
+	CINDER_SIMD_TARGET_AVX2 void alphaMask( V &r ) const							{ r = _mm256_set1_epi64x( (long long)( 0xFFFFULL << ( 16 * A ) ) ); }
+
+	__m256i		mZero, mMax, mOne;
+};
+
+// 32f: one pixel per 128 bits. Every expression is evaluated in the same order as the scalar rows so the results are identical.
+struct BlendOpsSse2_32f {
+	typedef __m128		V;
+	static const int PIXELS = 1;
+
+	BlendOpsSse2_32f() : mZero( _mm_setzero_ps() ), mOne( _mm_set1_ps( 1.0f ) ) {}
+
+	void load( V &v, const float *p ) const						{ v = _mm_loadu_ps( p ); }
+	void store( float *p, const V &v ) const					{ _mm_storeu_ps( p, v ); }
+	void add( V &r, const V &a, const V &b ) const				{ r = _mm_add_ps( a, b ); }
+	void mul( V &r, const V &a, const V &b ) const				{ r = _mm_mul_ps( a, b ); }
+	void inverse( V &r, const V &a ) const						{ r = _mm_sub_ps( mOne, a ); }
+	void isZero( V &r, const V &a ) const						{ r = _mm_cmpeq_ps( a, mZero ); }
+	void select( V &r, const V &mask, const V &a, const V &b ) const	{ r = _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) ); }
+	template<int A>
+	void broadcastAlpha( V &r, const V &v ) const				{ r = _mm_shuffle_ps( v, v, _MM_SHUFFLE( A, A, A, A ) ); }
+	template<int A>
+	void alphaMask( V &r ) const								{ r = _mm_castsi128_ps( _mm_set_epi32( A == 3 ? -1 : 0, A == 2 ? -1 : 0, A == 1 ? -1 : 0, A == 0 ? -1 : 0 ) ); }
+
+	__m128		mZero, mOne;
+};
+
+struct BlendOpsAvx2_32f {
+	typedef __m256		V;
+	static const int PIXELS = 2;
+
+	CINDER_SIMD_TARGET_AVX2 BlendOpsAvx2_32f() : mZero( _mm256_setzero_ps() ), mOne( _mm256_set1_ps( 1.0f ) ) {}
+
+	CINDER_SIMD_TARGET_AVX2 void load( V &v, const float *p ) const					{ v = _mm256_loadu_ps( p ); }
+	CINDER_SIMD_TARGET_AVX2 void store( float *p, const V &v ) const				{ _mm256_storeu_ps( p, v ); }
+	CINDER_SIMD_TARGET_AVX2 void add( V &r, const V &a, const V &b ) const			{ r = _mm256_add_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void mul( V &r, const V &a, const V &b ) const			{ r = _mm256_mul_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void inverse( V &r, const V &a ) const					{ r = _mm256_sub_ps( mOne, a ); }
+	CINDER_SIMD_TARGET_AVX2 void isZero( V &r, const V &a ) const					{ r = _mm256_cmp_ps( a, mZero, _CMP_EQ_OQ ); }
+	CINDER_SIMD_TARGET_AVX2 void select( V &r, const V &mask, const V &a, const V &b ) const	{ r = _mm256_blendv_ps( b, a, mask ); }
+	template<int A>
+	CINDER_SIMD_TARGET_AVX2 void broadcastAlpha( V &r, const V &v ) const			{ r = _mm256_permute_ps( v, _MM_SHUFFLE( A, A, A, A ) ); }
+	template<int A>
+	CINDER_SIMD_TARGET_AVX2 void alphaMask( V &r ) const							{ r = _mm256_blend_ps( mZero, _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) ), ( 1 << A ) | ( 1 << ( A + 4 ) ) ); }
+
+	__m256		mZero, mOne;
+};
+
+// Composites one half (widened to 16 bits) of a vector of 8u pixels
+template<typename OPS, bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT, int A>
+CINDER_SIMD_FORCEINLINE void blendHalf_u8( const OPS &ops, const typename OPS::V &s, const typename OPS::V &d, const typename OPS::V &alphaMask, typename OPS::V &result )
 {
-	pair<Area,ivec2> srcDst = clippedSrcDst( foreground.getBounds(), srcArea, background->getBounds(), srcArea.getUL() + dstRelativeOffset );	
-	if( background->hasAlpha() ) {
-		if( background->isPremultiplied() ) {
-			if( foreground.isPremultiplied() )
-				blendImpl_u8<true, true, true>( background, foreground, srcDst.first, srcDst.second );
-			else
-				blendImpl_u8<true, true, false>( background, foreground, srcDst.first, srcDst.second );
+	typename OPS::V alphaS, invAlphaS, t, u;
+	ops.template broadcastAlpha<A>( alphaS, s );
+	ops.inverse( invAlphaS, alphaS );
+	ops.mul( t, invAlphaS, d );
+	if( SRCPREMULT ) { // src + invAlphaS * dst / 255
+		ops.div255( t, t );
+		ops.add( result, t, s );
+	}
+	else { // ( invAlphaS * dst + alphaS * src ) / 255
+		ops.mul( u, alphaS, s );
+		ops.add( t, t, u );
+		ops.div255( result, t );
+	}
+
+	if( DSTALPHA ) { // alpha is 255 - invAlphaS * invAlphaD / 255; the colors are left alone where it comes out 0
+		ops.inverse( u, d );
+		ops.mul( u, invAlphaS, u );
+		ops.div255( u, u );
+		ops.inverse( u, u );
+		ops.select( result, alphaMask, u, result );
+		ops.template broadcastAlpha<A>( u, result );
+		ops.isZero( u, u );
+		ops.select( result, u, d, result );
+	}
+	else // the unused 4th channel is preserved
+		ops.select( result, alphaMask, d, result );
+}
+
+template<typename OPS, bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT, int A>
+CINDER_SIMD_FORCEINLINE void blendRowSimd( const OPS &ops, const uint8_t *src, const BlendChannels &srcChannels, uint8_t *dst, const BlendChannels &dstChannels, int32_t width )
+{
+	typename OPS::V alphaMask, s, d, s16, d16, lo, hi;
+	ops.template alphaMask<A>( alphaMask );
+	int32_t x = 0;
+	for( ; x + OPS::PIXELS <= width; x += OPS::PIXELS ) {
+		ops.load( s, src + x * 4 );
+		ops.load( d, dst + x * 4 );
+		ops.unpackLo( s16, s );
+		ops.unpackLo( d16, d );
+		blendHalf_u8<OPS,DSTALPHA,DSTPREMULT,SRCPREMULT,A>( ops, s16, d16, alphaMask, lo );
+		ops.unpackHi( s16, s );
+		ops.unpackHi( d16, d );
+		blendHalf_u8<OPS,DSTALPHA,DSTPREMULT,SRCPREMULT,A>( ops, s16, d16, alphaMask, hi );
+		ops.pack( d, lo, hi );
+		ops.store( dst + x * 4, d );
+	}
+	blendRow_u8<DSTALPHA,DSTPREMULT,SRCPREMULT>( src + x * 4, srcChannels, dst + x * 4, dstChannels, width - x );
+}
+
+template<typename OPS, bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT, int A>
+CINDER_SIMD_FORCEINLINE void blendRowSimd( const OPS &ops, const float *src, const BlendChannels &srcChannels, float *dst, const BlendChannels &dstChannels, int32_t width )
+{
+	typename OPS::V alphaMask, s, d, alphaS, invAlphaS, alphaD, invAlphaD, color, t, u;
+	ops.template alphaMask<A>( alphaMask );
+	int32_t x = 0;
+	for( ; x + OPS::PIXELS <= width; x += OPS::PIXELS ) {
+		ops.load( s, src + x * 4 );
+		ops.load( d, dst + x * 4 );
+		ops.template broadcastAlpha<A>( alphaS, s );
+		ops.inverse( invAlphaS, alphaS );
+		ops.mul( color, invAlphaS, d );
+		if( ! DSTALPHA && ! SRCPREMULT ) { // invAlphaS * dst + alphaS * src
+			ops.mul( t, alphaS, s );
+			ops.add( color, color, t );
 		}
-		else { // background unpremult
-			if( foreground.isPremultiplied() )
-				blendImpl_u8<true, false, true>( background, foreground, srcDst.first, srcDst.second );
-			else
-				blendImpl_u8<true, false, false>( background, foreground, srcDst.first, srcDst.second );
+		else if( ! DSTALPHA && SRCPREMULT ) // invAlphaS * dst + src
+			ops.add( color, color, s );
+		else {
+			ops.template broadcastAlpha<A>( alphaD, d );
+			ops.inverse( invAlphaD, alphaD );
+			if( SRCPREMULT ) { // invAlphaS * dst + invAlphaD * src + alphaD * src
+				ops.mul( t, invAlphaD, s );
+				ops.mul( u, alphaD, s );
+			}
+			else { // invAlphaS * dst + invAlphaD * alphaS * src + alphaD * alphaS * src
+				ops.mul( t, invAlphaD, alphaS );
+				ops.mul( t, t, s );
+				ops.mul( u, alphaD, alphaS );
+				ops.mul( u, u, s );
+			}
+			ops.add( color, color, t );
+			ops.add( color, color, u );
+		}
+
+		if( DSTALPHA ) {
+			ops.mul( t, invAlphaS, invAlphaD );
+			ops.inverse( t, t );
+			ops.select( color, alphaMask, t, color );
+			ops.template broadcastAlpha<A>( t, color );
+			ops.isZero( t, t );
+			ops.select( color, t, d, color );
 		}
-	}
-	else { // background no alpha
-		if( foreground.isPremultiplied() )
-			blendImpl_u8<false, false, true>( background, foreground, srcDst.first, srcDst.second );
 		else
-			blendImpl_u8<false, false, false>( background, foreground, srcDst.first, srcDst.second );	
+			ops.select( color, alphaMask, d, color );
+		ops.store( dst + x * 4, color );
 	}
+	blendRow_float<DSTALPHA,DSTPREMULT,SRCPREMULT>( src + x * 4, srcChannels, dst + x * 4, dstChannels, width - x );
 }
 
-void blend( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const ivec2 &dstRelativeOffset )
+template<typename T>
+struct BlendSimdTraits {};
+
+template<>
+struct BlendSimdTraits<uint8_t> {
+	typedef BlendOpsSse2_8u		Sse2Ops;
+	typedef BlendOpsAvx2_8u		Avx2Ops;
+};
+
+template<>
+struct BlendSimdTraits<float> {
+	typedef BlendOpsSse2_32f	Sse2Ops;
+	typedef BlendOpsAvx2_32f	Avx2Ops;
+};
+
+template<typename T, bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT, int A>
+void blendRowSse2( const T *src, const BlendChannels &srcChannels, T *dst, const BlendChannels &dstChannels, int32_t width )
 {
-	pair<Area,ivec2> srcDst = clippedSrcDst( foreground.getBounds(), srcArea, background->getBounds(), srcArea.getUL() + dstRelativeOffset );
-	if( background->hasAlpha() ) {
-		if( background->isPremultiplied() ) {
+	const typename BlendSimdTraits<T>::Sse2Ops ops;
+	blendRowSimd<typename BlendSimdTraits<T>::Sse2Ops,DSTALPHA,DSTPREMULT,SRCPREMULT,A>( ops, src, srcChannels, dst, dstChannels, width );
+}
+
+template<typename T, bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT, int A>
+CINDER_SIMD_TARGET_AVX2 void blendRowAvx2( const T *src, const BlendChannels &srcChannels, T *dst, const BlendChannels &dstChannels, int32_t width )
+{
+	const typename BlendSimdTraits<T>::Avx2Ops ops;
+	blendRowSimd<typename BlendSimdTraits<T>::Avx2Ops,DSTALPHA,DSTPREMULT,SRCPREMULT,A>( ops, src, srcChannels, dst, dstChannels, width );
+}
+
+#endif // defined( CINDER_SIMD_SSE2 )
+
+template<typename T, bool DSTALPHA, bool DSTPREMULT, bool SRCPREMULT>
+typename BlendRow<T>::Fn selectBlendRow( const BlendChannels &srcChannels, const BlendChannels &dstChannels )
+{
+#if defined( CINDER_SIMD_SSE2 )
+	// the vector kernels need 4-channel pixels with matching color offsets, and don't handle an unpremultiplied background, which requires a division
+	const bool vectorizable = srcChannels.inc == 4 && dstChannels.inc == 4 && srcChannels.r == dstChannels.r && srcChannels.g == dstChannels.g
+								&& srcChannels.b == dstChannels.b && ( srcChannels.a == 0 || srcChannels.a == 3 ) && ( DSTPREMULT || ! DSTALPHA );
+	const simd::Level simdLevel = simd::getLevel();
+	if( vectorizable && simdLevel >= simd::Level::AVX2 )
+		return ( srcChannels.a == 0 ) ? &blendRowAvx2<T,DSTALPHA,DSTPREMULT,SRCPREMULT,0> : &blendRowAvx2<T,DSTALPHA,DSTPREMULT,SRCPREMULT,3>;
+	else if( vectorizable && simdLevel >= simd::Level::SSE2 )
+		return ( srcChannels.a == 0 ) ? &blendRowSse2<T,DSTALPHA,DSTPREMULT,SRCPREMULT,0> : &blendRowSse2<T,DSTALPHA,DSTPREMULT,SRCPREMULT,3>;
+#endif
+	return &BlendRowScalar<T,DSTALPHA,DSTPREMULT,SRCPREMULT>::run;
+}
+
+// Returns the row function compositing \a foreground over \a background, which is a copy when \a foreground has no alpha
+template<typename T>
+typename BlendRow<T>::Fn selectBlendRow( const SurfaceT<T> &background, const SurfaceT<T> &foreground )
+{
+	const BlendChannels srcChannels( foreground ), dstChannels( background );
+	if( background.hasAlpha() ) {
+		if( background.isPremultiplied() ) {
 			if( foreground.isPremultiplied() )
-				blendImpl_float<true, true, true>( background, foreground, srcDst.first, srcDst.second );
+				return selectBlendRow<T,true,true,true>( srcChannels, dstChannels );
 			else
-				blendImpl_float<true, true, false>( background, foreground, srcDst.first, srcDst.second );
+				return selectBlendRow<T,true,true,false>( srcChannels, dstChannels );
 		}
-		else {
+		else { // background unpremult
 			if( foreground.isPremultiplied() )
-				blendImpl_float<true, false, true>( background, foreground, srcDst.first, srcDst.second );
+				return selectBlendRow<T,true,false,true>( srcChannels, dstChannels );
 			else
-				blendImpl_float<true, false, false>( background, foreground, srcDst.first, srcDst.second );
+				return selectBlendRow<T,true,false,false>( srcChannels, dstChannels );
 		}
 	}
 	else { // background no alpha
 		if( foreground.isPremultiplied() )
-			blendImpl_float<false, false, true>( background, foreground, srcDst.first, srcDst.second );
+			return selectBlendRow<T,false,false,true>( srcChannels, dstChannels );
 		else
-			blendImpl_float<false, false, false>( background, foreground, srcDst.first, srcDst.second );	
+			return selectBlendRow<T,false,false,false>( srcChannels, dstChannels );
+	}
+}
+
+// One layer of a blend, clipped against the background
+template<typename T>
+struct BlendSpan {
+	const SurfaceT<T>			*mForeground;
+	Area						mSrcArea;
+	ivec2						mDstOffset;
+	typename BlendRow<T>::Fn	mRowFn;
+	BlendChannels				mSrcChannels, mDstChannels;
+};
+
+template<typename T>
+BlendSpan<T> makeBlendSpan( const SurfaceT<T> &background, const SurfaceT<T> &foreground, const Area &srcArea, const ivec2 &dstRelativeOffset )
+{
+	std::pair<Area,ivec2> srcDst = clippedSrcDst( foreground.getBounds(), srcArea, background.getBounds(), srcArea.getUL() + dstRelativeOffset );
+	BlendSpan<T> result;
+	result.mForeground = &foreground;
+	result.mSrcArea = srcDst.first;
+	result.mDstOffset = srcDst.second;
+	result.mSrcChannels = BlendChannels( foreground );
+	result.mDstChannels = BlendChannels( background );
+	result.mRowFn = foreground.hasAlpha() ? selectBlendRow( background, foreground ) : nullptr;
+	return result;
+}
+
+// Blends the row \a y of the background covered by \a span, if any
+template<typename T>
+void blendSpanRow( SurfaceT<T> *background, const BlendSpan<T> &span, int32_t y )
+{
+	const int32_t srcY = y - span.mDstOffset.y + span.mSrcArea.y1;
+	if( srcY < span.mSrcArea.y1 || srcY >= span.mSrcArea.y2 || span.mSrcArea.getWidth() <= 0 )
+		return;
+
+	if( ! span.mRowFn ) { // normal blend with no src alpha is a copy
+		const Area srcRow( span.mSrcArea.x1, srcY, span.mSrcArea.x2, srcY + 1 );
+		const ivec2 dstUL( span.mDstOffset.x, y );
+		background->copyFrom( *span.mForeground, srcRow, dstUL - srcRow.getUL() );
+		if( background->hasAlpha() )
+			ip::fill( &background->getChannelAlpha(), CHANTRAIT<T>::max(), Area( dstUL, dstUL + ivec2( span.mSrcArea.getWidth(), 1 ) ) );
+		return;
 	}
+
+	const T *src = span.mForeground->getData( ivec2( span.mSrcArea.x1, srcY ) );
+	T *dst = background->getData( ivec2( span.mDstOffset.x, y ) );
+	span.mRowFn( src, span.mSrcChannels, dst, span.mDstChannels, span.mSrcArea.getWidth() );
+}
+
+template<typename T>
+void blendImpl( SurfaceT<T> *background, const SurfaceT<T> &foreground, const Area &srcArea, const ivec2 &dstRelativeOffset )
+{
+	const BlendSpan<T> span = makeBlendSpan( *background, foreground, srcArea, dstRelativeOffset );
+	for( int32_t y = span.mDstOffset.y; y < span.mDstOffset.y + span.mSrcArea.getHeight(); ++y )
+		blendSpanRow( background, span, y );
+}
+
+// Walks the background once, compositing every layer into each row while it's in cache
+template<typename T>
+void blendLayersImpl( SurfaceT<T> *background, const std::vector<BlendLayerT<T>> &layers, int numThreads )
+{
+	std::vector<BlendSpan<T>> spans;
+	spans.reserve( layers.size() );
+	int32_t rowBegin = background->getHeight(), rowEnd = 0;
+	for( const auto &layer : layers ) {
+		if( ! layer.mSurface )
+			continue;
+		spans.push_back( makeBlendSpan( *background, *layer.mSurface, layer.mSurface->getBounds(), layer.mOffset ) );
+		const BlendSpan<T> &span = spans.back();
+		if( span.mSrcArea.getWidth() > 0 && span.mSrcArea.getHeight() > 0 ) {
+			rowBegin = std::min( rowBegin, span.mDstOffset.y );
+			rowEnd = std::max( rowEnd, span.mDstOffset.y + span.mSrcArea.getHeight() );
+		}
+	}
+
+	parallelForRows( rowBegin, rowEnd, numThreads, [&]( int32_t bandBegin, int32_t bandEnd ) {
+		for( int32_t y = bandBegin; y < bandEnd; ++y )
+			for( const auto &span : spans )
+				blendSpanRow( background, span, y );
+	} );
+}
+
+} // anonymous namespace
+
+void blend( Surface8u *background, const Surface8u &foreground, const Area &srcArea, const ivec2 &dstRelativeOffset )
+{
+	blendImpl( background, foreground, srcArea, dstRelativeOffset );
+}
+
+void blend( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const ivec2 &dstRelativeOffset )
+{
+	blendImpl( background, foreground, srcArea, dstRelativeOffset );
+}
+
+void blend( Surface8u *background, const std::vector<BlendLayer8u> &layers, int numThreads )
+{
+	blendLayersImpl( background, layers, numThreads );
+}
+
+void blend( Surface32f *background, const std::vector<BlendLayer32f> &layers, int numThreads )
+{
+	blendLayersImpl( background, layers, numThreads );
 }
 
 } } // namespace cinder::ip
@@ -0,0 +1,584 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/BlockCompress.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/CinderSimd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// The pixels of a 4x4 block as RGBA in rows from the top. Partial blocks repeat the image's last column and row.
+struct ColorBlock {
+	uint8_t		mPixels[16][4];
+};
+
+inline size_t calcBlockBytes( BlockFormat format )
+{
+	return ( format == BlockFormat::BC1 || format == BlockFormat::BC4 ) ? 8 : 16;
+}
+
+void loadBlock( const Surface8u &surface, int32_t blockX, int32_t blockY, ColorBlock *block )
+{
+	const uint8_t offsets[3] = { surface.getRedOffset(), surface.getGreenOffset(), surface.getBlueOffset() };
+	const uint8_t alphaOffset = surface.getAlphaOffset(), pixelInc = surface.getPixelInc();
+	const bool hasAlpha = surface.hasAlpha();
+	for( int32_t y = 0; y < 4; ++y ) {
+		const uint8_t *row = surface.getData( ivec2( 0, std::min( blockY * 4 + y, surface.getHeight() - 1 ) ) );
+		for( int32_t x = 0; x < 4; ++x ) {
+			const uint8_t *p = row + std::min( blockX * 4 + x, surface.getWidth() - 1 ) * pixelInc;
+			uint8_t *dst = block->mPixels[y * 4 + x];
+			for( int c = 0; c < 3; ++c )
+				dst[c] = p[offsets[c]];
+			dst[3] = hasAlpha ? p[alphaOffset] : 255;
+		}
+	}
+}
+
+inline int32_t expand5( int32_t v )		{ return ( v << 3 ) | ( v >> 2 ); }
+inline int32_t expand6( int32_t v )		{ return ( v << 2 ) | ( v >> 4 ); }
+
+inline uint16_t packColor565( const float *rgb )
+{
+	const int32_t r = constrain( int32_t( rgb[0] * ( 31 / 255.0f ) + 0.5f ), 0, 31 );
+	const int32_t g = constrain( int32_t( rgb[1] * ( 63 / 255.0f ) + 0.5f ), 0, 63 );
+	const int32_t b = constrain( int32_t( rgb[2] * ( 31 / 255.0f ) + 0.5f ), 0, 31 );
+	return (uint16_t)( ( r << 11 ) | ( g << 5 ) | b );
+}
+
+// A BC1 color block holds two endpoints and either two colors between them, or when c0 <= c1 their midpoint and transparent black
+void calcColorPalette( uint16_t c0, uint16_t c1, int32_t palette[4][3] )
+{
+	const uint16_t colors[2] = { c0, c1 };
+	for( int e = 0; e < 2; ++e ) {
+		palette[e][0] = expand5( colors[e] >> 11 );
+		palette[e][1] = expand6( ( colors[e] >> 5 ) & 63 );
+		palette[e][2] = expand5( colors[e] & 31 );
+	}
+	for( int c = 0; c < 3; ++c ) {
+		if( c0 > c1 ) {
+			palette[2][c] = ( 2 * palette[0][c] + palette[1][c] ) / 3;
+			palette[3][c] = ( palette[0][c] + 2 * palette[1][c] ) / 3;
+		}
+		else {
+			palette[2][c] = ( palette[0][c] + palette[1][c] ) / 2;
+			palette[3][c] = 0;
+		}
+	}
+}
+
+// Assigns each pixel in \a mask the nearest of the first \a numColors palette entries and returns the total squared error. Other pixels get index 3.
+typedef uint32_t (*MatchColorsFn)( const ColorBlock &block, uint16_t mask, const int32_t palette[4][3], int32_t numColors, uint32_t *indices );
+
+uint32_t matchColorsScalar( const ColorBlock &block, uint16_t mask, const int32_t palette[4][3], int32_t numColors, uint32_t *indices )
+{
+	uint32_t error = 0, result = 0;
+	for( int32_t i = 0; i < 16; ++i ) {
+		if( ! ( mask & ( 1 << i ) ) ) {
+			result |= 3u << ( 2 * i );
+			continue;
+		}
+		int32_t bestIndex = 0, bestDist = INT32_MAX;
+		for( int32_t k = 0; k < numColors; ++k ) {
+			int32_t dist = 0;
+			for( int c = 0; c < 3; ++c ) {
+				const int32_t d = block.mPixels[i][c] - palette[k][c];
+				dist += d * d;
+			}
+			if( dist < bestDist ) {
+				bestDist = dist;
+				bestIndex = k;
+			}
+		}
+		result |= uint32_t( bestIndex ) << ( 2 * i );
+		error += bestDist;
+	}
+	*indices = result;
+	return error;
+}
+
+#if defined( CINDER_SIMD_SSE2 )
+// Measures four pixels against each palette entry at once, matching matchColorsScalar() exactly
+uint32_t matchColorsSse2( const ColorBlock &block, uint16_t mask, const int32_t palette[4][3], int32_t numColors, uint32_t *indices )
+{
+	const __m128i zero = _mm_setzero_si128(), rgbMask = _mm_set_epi16( 0, -1, -1, -1, 0, -1, -1, -1 );
+	__m128i entries[4];
+	for( int32_t k = 0; k < numColors; ++k )
+		entries[k] = _mm_set_epi16( 0, (int16_t)palette[k][2], (int16_t)palette[k][1], (int16_t)palette[k][0], 0, (int16_t)palette[k][2], (int16_t)palette[k][1], (int16_t)palette[k][0] );
+
+	alignas( 16 ) int32_t bestIndices[16], bestDists[16];
+	for( int32_t group = 0; group < 4; ++group ) {
+		const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( block.mPixels[group * 4] ) );
+		const __m128i lo = _mm_and_si128( _mm_unpacklo_epi8( pixels, zero ), rgbMask ), hi = _mm_and_si128( _mm_unpackhi_epi8( pixels, zero ), rgbMask );
+		__m128i best = _mm_setzero_si128(), bestIndex = _mm_setzero_si128();
+		for( int32_t k = 0; k < numColors; ++k ) {
+			const __m128i dLo = _mm_sub_epi16( lo, entries[k] ), dHi = _mm_sub_epi16( hi, entries[k] );
+			// each pixel's r² + g² and b² land in adjacent lanes
+			const __m128 sLo = _mm_castsi128_ps( _mm_madd_epi16( dLo, dLo ) ), sHi = _mm_castsi128_ps( _mm_madd_epi16( dHi, dHi ) );
+			const __m128i dist = _mm_add_epi32( _mm_castps_si128( _mm_shuffle_ps( sLo, sHi, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ), _mm_castps_si128( _mm_shuffle_ps( sLo, sHi, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ) );
+			if( k == 0 )
+				best = dist;
+			else {
+				const __m128i closer = _mm_cmplt_epi32( dist, best );
+				best = _mm_or_si128( _mm_and_si128( closer, dist ), _mm_andnot_si128( closer, best ) );
+				bestIndex = _mm_or_si128( _mm_and_si128( closer, _mm_set1_epi32( k ) ), _mm_andnot_si128( closer, bestIndex ) );
+			}
+		}
+		_mm_store_si128( reinterpret_cast<__m128i*>( &bestIndices[group * 4] ), bestIndex );
+		_mm_store_si128( reinterpret_cast<__m128i*>( &bestDists[group * 4] ), best );
+	}
+
+	uint32_t error = 0, result = 0;
+	for( int32_t i = 0; i < 16; ++i ) {
+		if( mask & ( 1 << i ) ) {
+			result |= uint32_t( bestIndices[i] ) << ( 2 * i );
+			error += bestDists[i];
+		}
+		else
+			result |= 3u << ( 2 * i );
+	}
+	*indices = result;
+	return error;
+}
+#endif
+
+// Places the endpoints at the corners of the pixels' bounding box, on the diagonal that best follows their correlation, inset slightly
+void fitBoundingBox( const ColorBlock &block, uint16_t mask, float lo[3], float hi[3] )
+{
+	float mean[3] = { 0, 0, 0 };
+	int32_t count = 0;
+	for( int c = 0; c < 3; ++c ) {
+		lo[c] = 255;
+		hi[c] = 0;
+	}
+	for( int32_t i = 0; i < 16; ++i ) {
+		if( mask & ( 1 << i ) ) {
+			for( int c = 0; c < 3; ++c ) {
+				lo[c] = std::min<float>( lo[c], block.mPixels[i][c] );
+				hi[c] = std::max<float>( hi[c], block.mPixels[i][c] );
+				mean[c] += block.mPixels[i][c];
+			}
+			++count;
+		}
+	}
+	for( int c = 0; c < 3; ++c ) {
+		mean[c] /= count;
+		const float inset = ( hi[c] - lo[c] ) / 16;
+		lo[c] += inset;
+		hi[c] -= inset;
+	}
+
+	float covRG = 0, covBG = 0;
+	for( int32_t i = 0; i < 16; ++i ) {
+		if( mask & ( 1 << i ) ) {
+			const float g = block.mPixels[i][1] - mean[1];
+			covRG += ( block.mPixels[i][0] - mean[0] ) * g;
+			covBG += ( block.mPixels[i][2] - mean[2] ) * g;
+		}
+	}
+	if( covRG < 0 )
+		std::swap( lo[0], hi[0] );
+	if( covBG < 0 )
+		std::swap( lo[2], hi[2] );
+}
+
+// Places the endpoints at the extremes of the pixels' projections onto their principal axis
+void fitPrincipalAxis( const ColorBlock &block, uint16_t mask, float lo[3], float hi[3] )
+{
+	float mean[3] = { 0, 0, 0 };
+	int32_t count = 0;
+	for( int32_t i = 0; i < 16; ++i ) {
+		if( mask & ( 1 << i ) ) {
+			for( int c = 0; c < 3; ++c )
+				mean[c] += block.mPixels[i][c];
+			++count;
+		}
+	}
+	for( int c = 0; c < 3; ++c )
+		mean[c] /= count;
+
+	float cov[3][3] = {};
+	for( int32_t i = 0; i < 16; ++i ) {
+		if( mask & ( 1 << i ) ) {
+			const float d[3] = { block.mPixels[i][0] - mean[0], block.mPixels[i][1] - mean[1], block.mPixels[i][2] - mean[2] };
+			for( int r = 0; r < 3; ++r )
+				for( int c = 0; c < 3; ++c )
+					cov[r][c] += d[r] * d[c];
+		}
+	}
+
+	// power iteration, starting from the axis of greatest variance
+	float axis[3] = { 0, 0, 0 };
+	const int32_t start = ( cov[0][0] > cov[1][1] ) ? ( cov[0][0] > cov[2][2] ? 0 : 2 ) : ( cov[1][1] > cov[2][2] ? 1 : 2 );
+	axis[start] = 1;
+	for( int iteration = 0; iteration < 8; ++iteration ) {
+		float next[3];
+		for( int r = 0; r < 3; ++r )
+			next[r] = cov[r][0] * axis[0] + cov[r][1] * axis[1] + cov[r][2] * axis[2];
+		const float length = std::max( std::abs( next[0] ), std::max( std::abs( next[1] ), std::abs( next[2] ) ) );
+		if( length < 1e-6f )
+			break;
+		for( int c = 0; c < 3; ++c )
+			axis[c] = next[c] / length;
+	}
+	const float lengthSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+	float minT = 0, maxT = 0;
+	for( int32_t i = 0; i < 16; ++i ) {
+		if( mask & ( 1 << i ) ) {
+			const float t = ( ( block.mPixels[i][0] - mean[0] ) * axis[0] + ( block.mPixels[i][1] - mean[1] ) * axis[1] + ( block.mPixels[i][2] - mean[2] ) * axis[2] ) / lengthSq;
+			minT = std::min( minT, t );
+			maxT = std::max( maxT, t );
+		}
+	}
+	for( int c = 0; c < 3; ++c ) {
+		lo[c] = mean[c] + axis[c] * minT;
+		hi[c] = mean[c] + axis[c] * maxT;
+	}
+}
+
+// Solves for the endpoints which minimize the squared error of the pixels given their current palette indices. Returns false when the indices don't constrain both.
+bool refineEndpoints( const ColorBlock &block, uint16_t mask, uint32_t indices, bool fourColors, float c0[3], float c1[3] )
+{
+	static const float FOUR_COLOR_WEIGHTS[4] = { 1, 0, 2 / 3.0f, 1 / 3.0f }, THREE_COLOR_WEIGHTS[4] = { 1, 0, 0.5f, 0 };
+	const float *weights = fourColors ? FOUR_COLOR_WEIGHTS : THREE_COLOR_WEIGHTS;
+
+	float aa = 0, bb = 0, ab = 0, ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+	for( int32_t i = 0; i < 16; ++i ) {
+		if( ! ( mask & ( 1 << i ) ) )
+			continue;
+		const float a = weights[( indices >> ( 2 * i ) ) & 3], b = 1 - a;
+		aa += a * a;
+		bb += b * b;
+		ab += a * b;
+		for( int c = 0; c < 3; ++c ) {
+			ax[c] += a * block.mPixels[i][c];
+			bx[c] += b * block.mPixels[i][c];
+		}
+	}
+
+	const float det = aa * bb - ab * ab;
+	if( std::abs( det ) < 1e-6f )
+		return false;
+	for( int c = 0; c < 3; ++c ) {
+		c0[c] = constrain( ( ax[c] * bb - bx[c] * ab ) / det, 0.0f, 255.0f );
+		c1[c] = constrain( ( bx[c] * aa - ax[c] * ab ) / det, 0.0f, 255.0f );
+	}
+	return true;
+}
+
+inline void writeLittle16( uint16_t v, uint8_t *dst )
+{
+	dst[0] = uint8_t( v );
+	dst[1] = uint8_t( v >> 8 );
+}
+
+void encodeColorBlock( const ColorBlock &block, bool allowTransparent, BlockQuality quality, MatchColorsFn matchColors, uint8_t *dst )
+{
+	uint16_t mask = 0;
+	for( int32_t i = 0; i < 16; ++i ) {
+		if( ! allowTransparent || block.mPixels[i][3] >= 128 )
+			mask |= 1 << i;
+	}
+	// a transparent pixel requires the three color mode
+	const bool fourColors = ( mask == 0xFFFF );
+
+	uint16_t bestC0 = 0, bestC1 = 0;
+	uint32_t bestIndices = 0xFFFFFFFF, bestError = UINT32_MAX;
+	auto evaluate = [&]( const float *c0f, const float *c1f ) {
+		uint16_t c0 = packColor565( c0f ), c1 = packColor565( c1f );
+		if( fourColors ? ( c0 < c1 ) : ( c0 > c1 ) )
+			std::swap( c0, c1 );
+		int32_t palette[4][3];
+		calcColorPalette( c0, c1, palette );
+		// equal endpoints decode in the three color mode, whose first three entries are all the same color
+		const int32_t numColors = ( c0 == c1 ) ? 1 : ( fourColors ? 4 : 3 );
+		uint32_t indices;
+		const uint32_t error = matchColors( block, mask, palette, numColors, &indices );
+		if( error < bestError ) {
+			bestError = error;
+			bestC0 = c0;
+			bestC1 = c1;
+			bestIndices = indices;
+			return true;
+		}
+		return false;
+	};
+
+	if( mask ) {
+		float lo[3], hi[3];
+		if( quality != BlockQuality::FAST ) {
+			fitPrincipalAxis( block, mask, lo, hi );
+			evaluate( hi, lo );
+		}
+		if( quality != BlockQuality::NORMAL ) {
+			fitBoundingBox( block, mask, lo, hi );
+			evaluate( hi, lo );
+		}
+
+		const int iterations = ( quality == BlockQuality::FAST ) ? 0 : ( quality == BlockQuality::NORMAL ) ? 1 : 4;
+		for( int iteration = 0; iteration < iterations && bestError > 0; ++iteration ) {
+			float c0[3], c1[3];
+			if( ! refineEndpoints( block, mask, bestIndices, bestC0 > bestC1, c0, c1 ) || ! evaluate( c0, c1 ) )
+				break;
+		}
+	}
+
+	writeLittle16( bestC0, dst );
+	writeLittle16( bestC1, dst + 2 );
+	for( int b = 0; b < 4; ++b )
+		dst[4 + b] = uint8_t( bestIndices >> ( 8 * b ) );
+}
+
+// A BC4 block holds two endpoints and six values between them, or when a0 <= a1 four values between them plus 0 and 255
+void calcAlphaPalette( int32_t a0, int32_t a1, int32_t palette[8] )
+{
+	palette[0] = a0;
+	palette[1] = a1;
+	if( a0 > a1 ) {
+		for( int32_t i = 2; i < 8; ++i )
+			palette[i] = ( ( 8 - i ) * a0 + ( i - 1 ) * a1 + 3 ) / 7;
+	}
+	else {
+		for( int32_t i = 2; i < 6; ++i )
+			palette[i] = ( ( 6 - i ) * a0 + ( i - 1 ) * a1 + 2 ) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+uint32_t matchAlpha( const uint8_t values[16], int32_t a0, int32_t a1, uint64_t *indices )
+{
+	int32_t palette[8];
+	calcAlphaPalette( a0, a1, palette );
+	uint32_t error = 0;
+	uint64_t result = 0;
+	for( int32_t i = 0; i < 16; ++i ) {
+		int32_t bestIndex = 0, bestDist = INT32_MAX;
+		for( int32_t k = 0; k < 8; ++k ) {
+			const int32_t dist = ( values[i] - palette[k] ) * ( values[i] - palette[k] );
+			if( dist < bestDist ) {
+				bestDist = dist;
+				bestIndex = k;
+			}
+		}
+		result |= uint64_t( bestIndex ) << ( 3 * i );
+		error += bestDist;
+	}
+	*indices = result;
+	return error;
+}
+
+void encodeAlphaBlock( const uint8_t values[16], BlockQuality quality, uint8_t *dst )
+{
+	int32_t minValue = 255, maxValue = 0, minInner = 255, maxInner = 0;
+	for( int32_t i = 0; i < 16; ++i ) {
+		minValue = std::min<int32_t>( minValue, values[i] );
+		maxValue = std::max<int32_t>( maxValue, values[i] );
+		if( values[i] != 0 && values[i] != 255 ) {
+			minInner = std::min<int32_t>( minInner, values[i] );
+			maxInner = std::max<int32_t>( maxInner, values[i] );
+		}
+	}
+
+	int32_t bestA0 = 0, bestA1 = 0;
+	uint64_t bestIndices = 0;
+	uint32_t bestError = UINT32_MAX;
+	auto evaluate = [&]( int32_t a0, int32_t a1 ) {
+		uint64_t indices;
+		const uint32_t error = matchAlpha( values, a0, a1, &indices );
+		if( error < bestError ) {
+			bestError = error;
+			bestA0 = a0;
+			bestA1 = a1;
+			bestIndices = indices;
+		}
+	};
+
+	evaluate( maxValue, minValue );
+	if( quality != BlockQuality::FAST && bestError > 0 ) {
+		// the six value mode spends its endpoints on the values other than 0 and 255
+		if( minInner <= maxInner )
+			evaluate( minInner, maxInner );
+		else
+			evaluate( 0, 0 );
+	}
+	if( quality == BlockQuality::HIGH && bestError > 0 ) {
+		for( int32_t d0 = -2; d0 <= 2; ++d0 ) {
+			for( int32_t d1 = -2; d1 <= 2; ++d1 ) {
+				const int32_t a0 = constrain( maxValue + d0, 0, 255 ), a1 = constrain( minValue + d1, 0, 255 );
+				if( a0 > a1 )
+					evaluate( a0, a1 );
+			}
+		}
+	}
+
+	dst[0] = uint8_t( bestA0 );
+	dst[1] = uint8_t( bestA1 );
+	for( int b = 0; b < 6; ++b )
+		dst[2 + b] = uint8_t( bestIndices >> ( 8 * b ) );
+}
+
+void decodeColorBlock( const uint8_t *src, uint8_t pixels[16][4] )
+{
+	const uint16_t c0 = src[0] | ( src[1] << 8 ), c1 = src[2] | ( src[3] << 8 );
+	const uint32_t indices = src[4] | ( src[5] << 8 ) | ( src[6] << 16 ) | ( uint32_t( src[7] ) << 24 );
+	int32_t palette[4][3];
+	calcColorPalette( c0, c1, palette );
+	for( int32_t i = 0; i < 16; ++i ) {
+		const uint32_t index = ( indices >> ( 2 * i ) ) & 3;
+		for( int c = 0; c < 3; ++c )
+			pixels[i][c] = uint8_t( palette[index][c] );
+		pixels[i][3] = ( c0 <= c1 && index == 3 ) ? 0 : 255;
+	}
+}
+
+void decodeAlphaBlock( const uint8_t *src, uint8_t pixels[16][4], int channel )
+{
+	int32_t palette[8];
+	calcAlphaPalette( src[0], src[1], palette );
+	uint64_t indices = 0;
+	for( int b = 0; b < 6; ++b )
+		indices |= uint64_t( src[2 + b] ) << ( 8 * b );
+	for( int32_t i = 0; i < 16; ++i )
+		pixels[i][channel] = uint8_t( palette[( indices >> ( 3 * i ) ) & 7] );
+}
+
+} // anonymous namespace
+
+size_t calcBlockCompressedSize( BlockFormat format, const ivec2 &size )
+{
+	return size_t( ( size.x + 3 ) / 4 ) * size_t( ( size.y + 3 ) / 4 ) * calcBlockBytes( format );
+}
+
+void blockCompress( const Surface8u &surface, BlockFormat format, uint8_t *dst, BlockQuality quality, int numThreads )
+{
+	const int32_t blocksX = ( surface.getWidth() + 3 ) / 4, blocksY = ( surface.getHeight() + 3 ) / 4;
+	const size_t blockBytes = calcBlockBytes( format );
+	MatchColorsFn matchColors = matchColorsScalar;
+#if defined( CINDER_SIMD_SSE2 )
+	if( simd::getLevel() >= simd::Level::SSE2 )
+		matchColors = matchColorsSse2;
+#endif
+
+	parallelForRows( 0, blocksY, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		ColorBlock block;
+		uint8_t values[16];
+		auto encodeChannel = [&]( int channel, uint8_t *out ) {
+			for( int32_t i = 0; i < 16; ++i )
+				values[i] = block.mPixels[i][channel];
+			encodeAlphaBlock( values, quality, out );
+		};
+
+		for( int32_t blockY = rowBegin; blockY < rowEnd; ++blockY ) {
+			for( int32_t blockX = 0; blockX < blocksX; ++blockX ) {
+				uint8_t *out = dst + ( blockY * blocksX + blockX ) * blockBytes;
+				loadBlock( surface, blockX, blockY, &block );
+				switch( format ) {
+					case BlockFormat::BC1:
+						encodeColorBlock( block, surface.hasAlpha(), quality, matchColors, out );
+					break;
+					case BlockFormat::BC3:
+						encodeChannel( 3, out );
+						encodeColorBlock( block, false, quality, matchColors, out + 8 );
+					break;
+					case BlockFormat::BC4:
+						encodeChannel( 0, out );
+					break;
+					case BlockFormat::BC5:
+						encodeChannel( 0, out );
+						encodeChannel( 1, out + 8 );
+					break;
+				}
+			}
+		}
+	}, 4 );
+}
+
+void blockCompress( const Channel8u &channel, uint8_t *dst, BlockQuality quality, int numThreads )
+{
+	const int32_t blocksX = ( channel.getWidth() + 3 ) / 4, blocksY = ( channel.getHeight() + 3 ) / 4;
+	parallelForRows( 0, blocksY, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		uint8_t values[16];
+		for( int32_t blockY = rowBegin; blockY < rowEnd; ++blockY ) {
+			for( int32_t blockX = 0; blockX < blocksX; ++blockX ) {
+				for( int32_t y = 0; y < 4; ++y )
+					for( int32_t x = 0; x < 4; ++x )
+						values[y * 4 + x] = *channel.getData( ivec2( std::min( blockX * 4 + x, channel.getWidth() - 1 ), std::min( blockY * 4 + y, channel.getHeight() - 1 ) ) );
+				encodeAlphaBlock( values, quality, dst + ( blockY * blocksX + blockX ) * 8 );
+			}
+		}
+	}, 4 );
+}
+
+void blockDecompress( const uint8_t *src, BlockFormat format, Surface8u *dstSurface )
+{
+	const int32_t blocksX = ( dstSurface->getWidth() + 3 ) / 4, blocksY = ( dstSurface->getHeight() + 3 ) / 4;
+	const size_t blockBytes = calcBlockBytes( format );
+	const uint8_t offsets[4] = { dstSurface->getRedOffset(), dstSurface->getGreenOffset(), dstSurface->getBlueOffset(), dstSurface->getAlphaOffset() };
+	const int numChannels = dstSurface->hasAlpha() ? 4 : 3;
+	const uint8_t pixelInc = dstSurface->getPixelInc();
+
+	for( int32_t blockY = 0; blockY < blocksY; ++blockY ) {
+		for( int32_t blockX = 0; blockX < blocksX; ++blockX ) {
+			const uint8_t *block = src + ( blockY * blocksX + blockX ) * blockBytes;
+			uint8_t pixels[16][4];
+			switch( format ) {
+				case BlockFormat::BC1:
+					decodeColorBlock( block, pixels );
+				break;
+				case BlockFormat::BC3:
+					decodeColorBlock( block + 8, pixels );
+					decodeAlphaBlock( block, pixels, 3 );
+				break;
+				case BlockFormat::BC4:
+				case BlockFormat::BC5:
+					for( int32_t i = 0; i < 16; ++i ) {
+						pixels[i][1] = pixels[i][2] = 0;
+						pixels[i][3] = 255;
+					}
+					decodeAlphaBlock( block, pixels, 0 );
+					if( format == BlockFormat::BC5 )
+						decodeAlphaBlock( block + 8, pixels, 1 );
+				break;
+			}
+
+			for( int32_t y = 0; y < 4 && blockY * 4 + y < dstSurface->getHeight(); ++y ) {
+				uint8_t *row = dstSurface->getData( ivec2( blockX * 4, blockY * 4 + y ) );
+				for( int32_t x = 0; x < 4 && blockX * 4 + x < dstSurface->getWidth(); ++x ) {
+					for( int c = 0; c < numChannels; ++c )
+						row[x * pixelInc + offsets[c]] = pixels[y * 4 + x][c];
+				}
+			}
+		}
+	}
+}
+
+} } // namespace cinder::ip
@@ -21,6 +21,13 @@
 */
 
 #include "cinder/ip/Blur.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/CinderSimd.h"
+
+#include <boost/preprocessor/seq.hpp>
+#include <cmath>
+#include <vector>
 
 namespace cinder { namespace ip { 
 
@@ -52,36 +59,27 @@ uint8_t getPixelDataOffset( const ChannelT<T> &surface )
 	return 0;
 }
 
-// Core implementation of stackBlur algorithm due to Mario Klingemann.
-// http://incubator.quasimondo.com/processing/fast_blur_deluxe.php
+// Horizontal pass of the stackBlur algorithm. Writes the blurred rows of \a area to \a channelData, which is packed as width * height * CHANNELS values
 template<typename T, typename SUMT, typename IMAGET, uint8_t CHANNELS>
-void stackBlur_impl( const IMAGET &srcSurface, IMAGET *dstSurface, const Area &area, int radius )
+void stackBlurHorizontal( const IMAGET &srcSurface, const Area &area, int radius, SUMT *channelData )
 {
 	const int32_t width = area.getWidth();
 	const int32_t height = area.getHeight();
 	const int32_t widthMinusOne = width - 1;
-	const int32_t heightMinusOne = height - 1;
 	const int32_t div = radius + radius + 1;
 	const int32_t radiusPlusOne = radius + 1;
 	const SUMT divisor = (SUMT)(((div+1)>>1)*((div+1)>>1));
 	const SUMT invDivisor = 1 / divisor;
 	const uint8_t srcPixelInc = ( CHANNELS == 4 ) ? 4 : getPixelIncrement( srcSurface );
-	const uint8_t dstPixelInc = ( CHANNELS == 4 ) ? 4 : getPixelIncrement( *dstSurface );
 	const ptrdiff_t srcRowInc = srcSurface.getRowBytes() / sizeof(T);
-	const ptrdiff_t dstRowInc = dstSurface->getRowBytes() / sizeof(T);
 
 	const T *srcPixelData = srcSurface.getData( area.getUL() );
-	T *dstPixelData = dstSurface->getData( area.getUL() );
 	srcPixelData += getPixelDataOffset( srcSurface );
-	dstPixelData += getPixelDataOffset( *dstSurface );
 
 	std::unique_ptr<SUMT[]> stack( new SUMT[div*CHANNELS] );
-	SUMT *tempPixelData = (SUMT*)malloc(width * height * sizeof(SUMT) * CHANNELS);
-	SUMT *channelData = tempPixelData;
 
 	SUMT *sir;
 	SUMT inSum[CHANNELS], outSum[CHANNELS], sum[CHANNELS];
-	int32_t p, yp;
 	int stackPointer, rbs;
     
 	int yi = 0;
@@ -140,7 +138,32 @@ void stackBlur_impl( const IMAGET &srcSurface, IMAGET *dstSurface, const Area &a
 			yi++;
 		}
 	}
-    
+}
+
+// Vertical pass of the stackBlur algorithm, walking one column of \a channelData at a time
+template<typename T, typename SUMT, typename IMAGET, uint8_t CHANNELS>
+void stackBlurVertical( const SUMT *channelData, IMAGET *dstSurface, const Area &area, int radius )
+{
+	const int32_t width = area.getWidth();
+	const int32_t height = area.getHeight();
+	const int32_t heightMinusOne = height - 1;
+	const int32_t div = radius + radius + 1;
+	const int32_t radiusPlusOne = radius + 1;
+	const SUMT divisor = (SUMT)(((div+1)>>1)*((div+1)>>1));
+	const SUMT invDivisor = 1 / divisor;
+	const uint8_t dstPixelInc = ( CHANNELS == 4 ) ? 4 : getPixelIncrement( *dstSurface );
+	const ptrdiff_t dstRowInc = dstSurface->getRowBytes() / sizeof(T);
+
+	T *dstPixelData = dstSurface->getData( area.getUL() );
+	dstPixelData += getPixelDataOffset( *dstSurface );
+
+	std::unique_ptr<SUMT[]> stack( new SUMT[div*CHANNELS] );
+
+	SUMT *sir;
+	SUMT inSum[CHANNELS], outSum[CHANNELS], sum[CHANNELS];
+	int32_t p, yp, yi;
+	int stackPointer, rbs;
+
 	for( int32_t x = 0; x < width; x++ ) {
 		for( int c = 0; c < CHANNELS; ++c )
 			inSum[c] = outSum[c] = sum[c] = 0;
@@ -204,8 +227,439 @@ void stackBlur_impl( const IMAGET &srcSurface, IMAGET *dstSurface, const Area &a
 			offset += dstRowInc;
 		}
 	}
+}
+
+#if defined( CINDER_SIMD_SSE2 )
+
+// The SIMD path treats every channel of every column (vertical pass) or of every row (horizontal pass) as an independent
+// lane and runs the stackBlur recurrence on strips of up to STACKBLUR_STRIP_LANES lanes at once. Besides vectorizing
+// the sums, the vertical pass reads whole rows instead of walking down one column at a time.
+const int STACKBLUR_STRIP_LANES = 32;
+
+// Scalar lane operations, used for the lanes left over after the last full vector. Matches the arithmetic of the scalar passes
+template<typename TEMPT, typename SUMT>
+struct StackBlurOpsScalar {
+	typedef TEMPT	TempT;
+	typedef SUMT	V;
+	static const int LANES = 1;
+
+	StackBlurOpsScalar( int32_t divisor ) : mDivisor( (SUMT)divisor ), mInvDivisor( 1 / (SUMT)divisor ) {}
+
+	void zero( V &v ) const							{ v = 0; }
+	void load( V &v, const TempT *p ) const			{ v = *p; }
+	void add( V &a, const V &b ) const				{ a += b; }
+	void sub( V &a, const V &b ) const				{ a -= b; }
+	void addMul( V &a, const V &b, int32_t s ) const	{ a += b * s; }
+	void divide( const V &sum, TempT *out ) const
+	{
+		if( std::is_integral<SUMT>::value )
+			*out = (TempT)( sum / mDivisor );
+		else
+			*out = (TempT)( sum * mInvDivisor );
+	}
+
+	SUMT	mDivisor, mInvDivisor;
+};
+
+// 8u: integer sums. The integer division is done as truncate( ( sum + 0.5 ) / divisor ) in double precision, which is exact
+// since the fractional part of sum / divisor is at least 1 / divisor away from the next integer.
+struct StackBlurOpsSse2_8u {
+	typedef int32_t		TempT;
+	typedef __m128i		V;
+	static const int LANES = 4;
+
+	StackBlurOpsSse2_8u( int32_t divisor ) : mHalf( _mm_set1_pd( 0.5 ) ), mInvDivisor( _mm_set1_pd( 1.0 / divisor ) ) {}
+
+	void zero( V &v ) const							{ v = _mm_setzero_si128(); }
+	void load( V &v, const TempT *p ) const			{ v = _mm_loadu_si128( (const __m128i*)p ); }
+	void add( V &a, const V &b ) const				{ a = _mm_add_epi32( a, b ); }
+	void sub( V &a, const V &b ) const				{ a = _mm_sub_epi32( a, b ); }
+	void addMul( V &a, const V &b, int32_t s ) const
+	{
+		// SSE2 has no 32-bit mullo; multiply the even and odd lanes separately and interleave the low halves
+		const __m128i sv = _mm_set1_epi32( s );
+		const __m128i even = _mm_mul_epu32( b, sv );
+		const __m128i odd = _mm_mul_epu32( _mm_srli_si128( b, 4 ), sv );
+		a = _mm_add_epi32( a, _mm_unpacklo_epi32( _mm_shuffle_epi32( even, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm_shuffle_epi32( odd, _MM_SHUFFLE( 0, 0, 2, 0 ) ) ) );
+	}
+	void divide( const V &sum, TempT *out ) const
+	{
+		const __m128d lo = _mm_mul_pd( _mm_add_pd( _mm_cvtepi32_pd( sum ), mHalf ), mInvDivisor );
+		const __m128d hi = _mm_mul_pd( _mm_add_pd( _mm_cvtepi32_pd( _mm_shuffle_epi32( sum, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ), mHalf ), mInvDivisor );
+		_mm_storeu_si128( (__m128i*)out, _mm_unpacklo_epi64( _mm_cvttpd_epi32( lo ), _mm_cvttpd_epi32( hi ) ) );
+	}
+
+	__m128d		mHalf, mInvDivisor;
+};
+
+// 16u: sums can exceed 32 bits, so they're accumulated in doubles, which represent them exactly
+struct StackBlurOpsSse2_16u {
+	typedef int32_t		TempT;
+	typedef __m128d		V;
+	static const int LANES = 2;
+
+	StackBlurOpsSse2_16u( int32_t divisor ) : mHalf( _mm_set1_pd( 0.5 ) ), mInvDivisor( _mm_set1_pd( 1.0 / divisor ) ) {}
+
+	void zero( V &v ) const							{ v = _mm_setzero_pd(); }
+	void load( V &v, const TempT *p ) const			{ v = _mm_cvtepi32_pd( _mm_loadl_epi64( (const __m128i*)p ) ); }
+	void add( V &a, const V &b ) const				{ a = _mm_add_pd( a, b ); }
+	void sub( V &a, const V &b ) const				{ a = _mm_sub_pd( a, b ); }
+	void addMul( V &a, const V &b, int32_t s ) const	{ a = _mm_add_pd( a, _mm_mul_pd( b, _mm_set1_pd( s ) ) ); }
+	void divide( const V &sum, TempT *out ) const
+	{
+		_mm_storel_epi64( (__m128i*)out, _mm_cvttpd_epi32( _mm_mul_pd( _mm_add_pd( sum, mHalf ), mInvDivisor ) ) );
+	}
+
+	__m128d		mHalf, mInvDivisor;
+};
+
+struct StackBlurOpsSse2_32f {
+	typedef float		TempT;
+	typedef __m128		V;
+	static const int LANES = 4;
+
+	StackBlurOpsSse2_32f( int32_t divisor ) : mInvDivisor( _mm_set1_ps( 1 / (float)divisor ) ) {}
+
+	void zero( V &v ) const							{ v = _mm_setzero_ps(); }
+	void load( V &v, const TempT *p ) const			{ v = _mm_loadu_ps( p ); }
+	void add( V &a, const V &b ) const				{ a = _mm_add_ps( a, b ); }
+	void sub( V &a, const V &b ) const				{ a = _mm_sub_ps( a, b ); }
+	void addMul( V &a, const V &b, int32_t s ) const	{ a = _mm_add_ps( a, _mm_mul_ps( b, _mm_set1_ps( (float)s ) ) ); }
+	void divide( const V &sum, TempT *out ) const	{ _mm_storeu_ps( out, _mm_mul_ps( sum, mInvDivisor ) ); }
+
+	__m128		mInvDivisor;
+};
+
+struct StackBlurOpsAvx2_8u {
+	typedef int32_t		TempT;
+	typedef __m256i		V;
+	static const int LANES = 8;
+
+	CINDER_SIMD_TARGET_AVX2 StackBlurOpsAvx2_8u( int32_t divisor ) : mHalf( _mm256_set1_pd( 0.5 ) ), mInvDivisor( _mm256_set1_pd( 1.0 / divisor ) ) {}
+
+	CINDER_SIMD_TARGET_AVX2 void zero( V &v ) const							{ v = _mm256_setzero_si256(); }
+	CINDER_SIMD_TARGET_AVX2 void load( V &v, const TempT *p ) const			{ v = _mm256_loadu_si256( (const __m256i*)p ); }
+	CINDER_SIMD_TARGET_AVX2 void add( V &a, const V &b ) const				{ a = _mm256_add_epi32( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void sub( V &a, const V &b ) const				{ a = _mm256_sub_epi32( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void addMul( V &a, const V &b, int32_t s ) const	{ a = _mm256_add_epi32( a, _mm256_mullo_epi32( b, _mm256_set1_epi32( s ) ) ); }
+	CINDER_SIMD_TARGET_AVX2 void divide( const V &sum, TempT *out ) const
+	{
+		const __m256d lo = _mm256_mul_pd( _mm256_add_pd( _mm256_cvtepi32_pd( _mm256_castsi256_si128( sum ) ), mHalf ), mInvDivisor );
+		const __m256d hi = _mm256_mul_pd( _mm256_add_pd( _mm256_cvtepi32_pd( _mm256_extracti128_si256( sum, 1 ) ), mHalf ), mInvDivisor );
+		_mm_storeu_si128( (__m128i*)out, _mm256_cvttpd_epi32( lo ) );
+		_mm_storeu_si128( (__m128i*)( out + 4 ), _mm256_cvttpd_epi32( hi ) );
+	}
+
+	__m256d		mHalf, mInvDivisor;
+};
+
+struct StackBlurOpsAvx2_16u {
+	typedef int32_t		TempT;
+	typedef __m256d		V;
+	static const int LANES = 4;
+
+	CINDER_SIMD_TARGET_AVX2 StackBlurOpsAvx2_16u( int32_t divisor ) : mHalf( _mm256_set1_pd( 0.5 ) ), mInvDivisor( _mm256_set1_pd( 1.0 / divisor ) ) {}
+
+	CINDER_SIMD_TARGET_AVX2 void zero( V &v ) const							{ v = _mm256_setzero_pd(); }
+	CINDER_SIMD_TARGET_AVX2 void load( V &v, const TempT *p ) const			{ v = _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*)p ) ); }
+	CINDER_SIMD_TARGET_AVX2 void add( V &a, const V &b ) const				{ a = _mm256_add_pd( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void sub( V &a, const V &b ) const				{ a = _mm256_sub_pd( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void addMul( V &a, const V &b, int32_t s ) const	{ a = _mm256_add_pd( a, _mm256_mul_pd( b, _mm256_set1_pd( s ) ) ); }
+	CINDER_SIMD_TARGET_AVX2 void divide( const V &sum, TempT *out ) const
+	{
+		_mm_storeu_si128( (__m128i*)out, _mm256_cvttpd_epi32( _mm256_mul_pd( _mm256_add_pd( sum, mHalf ), mInvDivisor ) ) );
+	}
+
+	__m256d		mHalf, mInvDivisor;
+};
 
-	free( tempPixelData );
+struct StackBlurOpsAvx2_32f {
+	typedef float		TempT;
+	typedef __m256		V;
+	static const int LANES = 8;
+
+	CINDER_SIMD_TARGET_AVX2 StackBlurOpsAvx2_32f( int32_t divisor ) : mInvDivisor( _mm256_set1_ps( 1 / (float)divisor ) ) {}
+
+	CINDER_SIMD_TARGET_AVX2 void zero( V &v ) const							{ v = _mm256_setzero_ps(); }
+	CINDER_SIMD_TARGET_AVX2 void load( V &v, const TempT *p ) const			{ v = _mm256_loadu_ps( p ); }
+	CINDER_SIMD_TARGET_AVX2 void add( V &a, const V &b ) const				{ a = _mm256_add_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void sub( V &a, const V &b ) const				{ a = _mm256_sub_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void addMul( V &a, const V &b, int32_t s ) const	{ a = _mm256_add_ps( a, _mm256_mul_ps( b, _mm256_set1_ps( (float)s ) ) ); }
+	CINDER_SIMD_TARGET_AVX2 void divide( const V &sum, TempT *out ) const	{ _mm256_storeu_ps( out, _mm256_mul_ps( sum, mInvDivisor ) ); }
+
+	__m256		mInvDivisor;
+};
+
+template<typename T>
+struct StackBlurSimdTraits;
+
+template<>
+struct StackBlurSimdTraits<uint8_t> {
+	typedef int32_t								TempT;
+	typedef StackBlurOpsScalar<int32_t,int32_t>	ScalarOps;
+	typedef StackBlurOpsSse2_8u					Sse2Ops;
+	typedef StackBlurOpsAvx2_8u					Avx2Ops;
+};
+
+template<>
+struct StackBlurSimdTraits<uint16_t> {
+	typedef int32_t								TempT;
+	typedef StackBlurOpsScalar<int32_t,int64_t>	ScalarOps;
+	typedef StackBlurOpsSse2_16u				Sse2Ops;
+	typedef StackBlurOpsAvx2_16u				Avx2Ops;
+};
+
+template<>
+struct StackBlurSimdTraits<float> {
+	typedef float								TempT;
+	typedef StackBlurOpsScalar<float,float>		ScalarOps;
+	typedef StackBlurOpsSse2_32f				Sse2Ops;
+	typedef StackBlurOpsAvx2_32f				Avx2Ops;
+};
+
+// Reads the lanes of the vertical pass directly from the rows of the horizontal pass's output
+template<typename TEMPT>
+struct StackBlurColumnSource {
+	StackBlurColumnSource( const TEMPT *data, int32_t rowLanes )
+		: mData( data ), mRowLanes( rowLanes ) {}
+
+	const TEMPT*	fetch( int32_t pos )	{ return mData + pos * mRowLanes; }
+
+	const TEMPT		*mData;
+	int32_t			mRowLanes;
+};
+
+// Scatters the results of the vertical pass into the destination's pixels
+template<typename T, typename TEMPT>
+struct StackBlurColumnSink {
+	StackBlurColumnSink( T *data, ptrdiff_t rowInc, const ptrdiff_t *laneOffsets, int numLanes )
+		: mData( data ), mRowInc( rowInc ), mLaneOffsets( laneOffsets ), mNumLanes( numLanes ) {}
+
+	void store( int32_t pos, const TEMPT *result )
+	{
+		T *row = mData + pos * mRowInc;
+		for( int lane = 0; lane < mNumLanes; ++lane )
+			row[mLaneOffsets[lane]] = (T)result[lane];
+	}
+
+	T				*mData;
+	ptrdiff_t		mRowInc;
+	const ptrdiff_t	*mLaneOffsets;
+	int				mNumLanes;
+};
+
+// Gathers the lanes of the horizontal pass, which are the channels of several source rows, at column \a pos
+template<typename T, typename TEMPT, uint8_t CHANNELS>
+struct StackBlurRowSource {
+	StackBlurRowSource( const T *data, ptrdiff_t rowInc, uint8_t pixelInc, int numRows )
+		: mData( data ), mRowInc( rowInc ), mPixelInc( pixelInc ), mNumRows( numRows ) {}
+
+	const TEMPT* fetch( int32_t pos )
+	{
+		const T *src = mData + pos * mPixelInc;
+		TEMPT *dst = mLanes;
+		for( int row = 0; row < mNumRows; ++row, src += mRowInc )
+			for( int c = 0; c < CHANNELS; ++c )
+				*dst++ = (TEMPT)src[c];
+		return mLanes;
+	}
+
+	const T			*mData;
+	ptrdiff_t		mRowInc;
+	uint8_t			mPixelInc;
+	int				mNumRows;
+	TEMPT			mLanes[STACKBLUR_STRIP_LANES];
+};
+
+// Writes the results of the horizontal pass for several rows at column \a pos
+template<typename TEMPT, uint8_t CHANNELS>
+struct StackBlurRowSink {
+	StackBlurRowSink( TEMPT *data, int32_t rowLanes, int numRows )
+		: mData( data ), mRowLanes( rowLanes ), mNumRows( numRows ) {}
+
+	void store( int32_t pos, const TEMPT *result )
+	{
+		TEMPT *dst = mData + pos * CHANNELS;
+		for( int row = 0; row < mNumRows; ++row, dst += mRowLanes )
+			for( int c = 0; c < CHANNELS; ++c )
+				dst[c] = *result++;
+	}
+
+	TEMPT			*mData;
+	int32_t			mRowLanes;
+	int				mNumRows;
+};
+
+// Runs the stackBlur recurrence over positions [0, length) for \a numVecs vectors of lanes followed by \a numScalars scalar lanes,
+// with the same arithmetic as the scalar passes. The stacks must hold div * numVecs vectors and div * numScalars values.
+template<typename OPS, typename SCALAROPS, typename SOURCE, typename SINK>
+CINDER_SIMD_FORCEINLINE void stackBlurStrip( const OPS &ops, const SCALAROPS &scalarOps, SOURCE &source, SINK &sink, int32_t length, int radius,
+								int numVecs, int numScalars, typename OPS::V *stack, typename SCALAROPS::V *scalarStack )
+{
+	typedef typename OPS::V V;
+	typedef typename SCALAROPS::V S;
+	typedef typename OPS::TempT TempT;
+	const int32_t lengthMinusOne = length - 1;
+	const int div = radius + radius + 1;
+	const int scalarBegin = numVecs * OPS::LANES;
+
+	V sum[STACKBLUR_STRIP_LANES], inSum[STACKBLUR_STRIP_LANES], outSum[STACKBLUR_STRIP_LANES];
+	S scalarSum[STACKBLUR_STRIP_LANES] = {}, scalarInSum[STACKBLUR_STRIP_LANES] = {}, scalarOutSum[STACKBLUR_STRIP_LANES] = {};
+	TempT result[STACKBLUR_STRIP_LANES];
+
+	for( int v = 0; v < numVecs; ++v ) {
+		ops.zero( sum[v] );
+		ops.zero( inSum[v] );
+		ops.zero( outSum[v] );
+	}
+
+	for( int i = -radius; i <= radius; ++i ) {
+		const TempT *lanes = source.fetch( std::min( lengthMinusOne, std::max( i, 0 ) ) );
+		V *sir = stack + ( i + radius ) * numVecs;
+		S *scalarSir = scalarStack + ( i + radius ) * numScalars;
+		const int32_t rbs = radius + 1 - abs( i );
+		for( int v = 0; v < numVecs; ++v ) {
+			ops.load( sir[v], lanes + v * OPS::LANES );
+			ops.addMul( sum[v], sir[v], rbs );
+			if( i > 0 )
+				ops.add( inSum[v], sir[v] );
+			else
+				ops.add( outSum[v], sir[v] );
+		}
+		for( int s = 0; s < numScalars; ++s ) {
+			scalarOps.load( scalarSir[s], lanes + scalarBegin + s );
+			scalarOps.addMul( scalarSum[s], scalarSir[s], rbs );
+			if( i > 0 )
+				scalarOps.add( scalarInSum[s], scalarSir[s] );
+			else
+				scalarOps.add( scalarOutSum[s], scalarSir[s] );
+		}
+	}
+
+	int stackPointer = radius;
+	for( int32_t pos = 0; pos < length; ++pos ) {
+		const int outIndex = ( stackPointer - radius + div ) % div;
+		const int inIndex = ( stackPointer + 1 ) % div;
+		const TempT *lanes = source.fetch( std::min( pos + radius + 1, lengthMinusOne ) );
+
+		V *sirOut = stack + outIndex * numVecs;
+		V *sirIn = stack + inIndex * numVecs;
+		for( int v = 0; v < numVecs; ++v ) {
+			ops.divide( sum[v], result + v * OPS::LANES );
+			ops.sub( sum[v], outSum[v] );
+			ops.sub( outSum[v], sirOut[v] );
+			ops.load( sirOut[v], lanes + v * OPS::LANES );
+			ops.add( inSum[v], sirOut[v] );
+			ops.add( sum[v], inSum[v] );
+			ops.add( outSum[v], sirIn[v] );
+			ops.sub( inSum[v], sirIn[v] );
+		}
+
+		S *scalarSirOut = scalarStack + outIndex * numScalars;
+		S *scalarSirIn = scalarStack + inIndex * numScalars;
+		for( int s = 0; s < numScalars; ++s ) {
+			scalarOps.divide( scalarSum[s], result + scalarBegin + s );
+			scalarOps.sub( scalarSum[s], scalarOutSum[s] );
+			scalarOps.sub( scalarOutSum[s], scalarSirOut[s] );
+			scalarOps.load( scalarSirOut[s], lanes + scalarBegin + s );
+			scalarOps.add( scalarInSum[s], scalarSirOut[s] );
+			scalarOps.add( scalarSum[s], scalarInSum[s] );
+			scalarOps.add( scalarOutSum[s], scalarSirIn[s] );
+			scalarOps.sub( scalarInSum[s], scalarSirIn[s] );
+		}
+
+		stackPointer = inIndex;
+		sink.store( pos, result );
+	}
+}
+
+// Both passes of stackBlur, each run on strips of up to STACKBLUR_STRIP_LANES lanes. The horizontal pass processes several rows per strip.
+template<typename OPS, typename T, uint8_t CHANNELS>
+CINDER_SIMD_FORCEINLINE void stackBlurStrips( const T *srcPixelData, ptrdiff_t srcRowInc, uint8_t srcPixelInc, T *dstPixelData, ptrdiff_t dstRowInc, uint8_t dstPixelInc,
+								int32_t width, int32_t height, int radius )
+{
+	typedef typename StackBlurSimdTraits<T>::ScalarOps SCALAROPS;
+	typedef typename OPS::TempT TEMPT;
+	const int32_t rowLanes = width * CHANNELS;
+	const int32_t div = radius + radius + 1;
+	const int32_t divisor = ((div+1)>>1)*((div+1)>>1);
+
+	const OPS ops( divisor );
+	const SCALAROPS scalarOps( divisor );
+
+	std::unique_ptr<TEMPT[]> channelData( new TEMPT[rowLanes * height] );
+
+	// the vector stack needs to be aligned for OPS::V, so it's carved out of an over-allocated buffer
+	const size_t stackBytes = div * sizeof(typename OPS::V) * ( STACKBLUR_STRIP_LANES / OPS::LANES );
+	std::unique_ptr<uint8_t[]> stackStorage( new uint8_t[stackBytes + 64] );
+	typename OPS::V *stack = (typename OPS::V*)( ( (uintptr_t)stackStorage.get() + 63 ) & ~(uintptr_t)63 );
+	std::unique_ptr<typename SCALAROPS::V[]> scalarStack( new typename SCALAROPS::V[div * STACKBLUR_STRIP_LANES] );
+
+	const int rowsPerStrip = STACKBLUR_STRIP_LANES / CHANNELS;
+	for( int32_t y = 0; y < height; y += rowsPerStrip ) {
+		const int numRows = std::min<int>( rowsPerStrip, height - y );
+		const int numLanes = numRows * CHANNELS;
+		StackBlurRowSource<T,TEMPT,CHANNELS> source( srcPixelData + y * srcRowInc, srcRowInc, srcPixelInc, numRows );
+		StackBlurRowSink<TEMPT,CHANNELS> sink( channelData.get() + y * rowLanes, rowLanes, numRows );
+		stackBlurStrip( ops, scalarOps, source, sink, width, radius, numLanes / OPS::LANES, numLanes % OPS::LANES, stack, scalarStack.get() );
+	}
+
+	ptrdiff_t dstLaneOffsets[STACKBLUR_STRIP_LANES];
+	for( int32_t stripBegin = 0; stripBegin < rowLanes; stripBegin += STACKBLUR_STRIP_LANES ) {
+		const int numLanes = std::min<int>( STACKBLUR_STRIP_LANES, rowLanes - stripBegin );
+		for( int lane = 0; lane < numLanes; ++lane )
+			dstLaneOffsets[lane] = ( ( stripBegin + lane ) / CHANNELS ) * dstPixelInc + ( stripBegin + lane ) % CHANNELS;
+
+		StackBlurColumnSource<TEMPT> source( channelData.get() + stripBegin, rowLanes );
+		StackBlurColumnSink<T,TEMPT> sink( dstPixelData, dstRowInc, dstLaneOffsets, numLanes );
+		stackBlurStrip( ops, scalarOps, source, sink, height, radius, numLanes / OPS::LANES, numLanes % OPS::LANES, stack, scalarStack.get() );
+	}
+}
+
+template<typename T, uint8_t CHANNELS>
+void stackBlurSse2( const T *srcPixelData, ptrdiff_t srcRowInc, uint8_t srcPixelInc, T *dstPixelData, ptrdiff_t dstRowInc, uint8_t dstPixelInc, int32_t width, int32_t height, int radius )
+{
+	stackBlurStrips<typename StackBlurSimdTraits<T>::Sse2Ops,T,CHANNELS>( srcPixelData, srcRowInc, srcPixelInc, dstPixelData, dstRowInc, dstPixelInc, width, height, radius );
+}
+
+template<typename T, uint8_t CHANNELS>
+CINDER_SIMD_TARGET_AVX2 void stackBlurAvx2( const T *srcPixelData, ptrdiff_t srcRowInc, uint8_t srcPixelInc, T *dstPixelData, ptrdiff_t dstRowInc, uint8_t dstPixelInc, int32_t width, int32_t height, int radius )
+{
+	stackBlurStrips<typename StackBlurSimdTraits<T>::Avx2Ops,T,CHANNELS>( srcPixelData, srcRowInc, srcPixelInc, dstPixelData, dstRowInc, dstPixelInc, width, height, radius );
+}
+
+#endif // defined( CINDER_SIMD_SSE2 )
+
+// Core implementation of stackBlur algorithm due to Mario Klingemann.
+// http://incubator.quasimondo.com/processing/fast_blur_deluxe.php
+template<typename T, typename SUMT, typename IMAGET, uint8_t CHANNELS>
+void stackBlur_impl( const IMAGET &srcSurface, IMAGET *dstSurface, const Area &area, int radius )
+{
+	const int32_t width = area.getWidth();
+	const int32_t height = area.getHeight();
+	if( width <= 0 || height <= 0 )
+		return;
+
+#if defined( CINDER_SIMD_SSE2 )
+	const simd::Level simdLevel = simd::getLevel();
+	if( simdLevel >= simd::Level::SSE2 ) {
+		const T *srcPixelData = srcSurface.getData( area.getUL() ) + getPixelDataOffset( srcSurface );
+		const ptrdiff_t srcRowInc = srcSurface.getRowBytes() / sizeof(T);
+		const uint8_t srcPixelInc = ( CHANNELS == 4 ) ? 4 : getPixelIncrement( srcSurface );
+		T *dstPixelData = dstSurface->getData( area.getUL() ) + getPixelDataOffset( *dstSurface );
+		const ptrdiff_t dstRowInc = dstSurface->getRowBytes() / sizeof(T);
+		const uint8_t dstPixelInc = ( CHANNELS == 4 ) ? 4 : getPixelIncrement( *dstSurface );
+		if( simdLevel >= simd::Level::AVX2 )
+			stackBlurAvx2<T,CHANNELS>( srcPixelData, srcRowInc, srcPixelInc, dstPixelData, dstRowInc, dstPixelInc, width, height, radius );
+		else
+			stackBlurSse2<T,CHANNELS>( srcPixelData, srcRowInc, srcPixelInc, dstPixelData, dstRowInc, dstPixelInc, width, height, radius );
+		return;
+	}
+#endif
+
+	std::unique_ptr<SUMT[]> channelData( new SUMT[width * height * CHANNELS] );
+	stackBlurHorizontal<T,SUMT,IMAGET,CHANNELS>( srcSurface, area, radius, channelData.get() );
+	stackBlurVertical<T,SUMT,IMAGET,CHANNELS>( channelData.get(), dstSurface, area, radius );
 }
 
 } // anonymous namespace
@@ -405,4 +859,303 @@ Channel32f stackBlurCopy( const Channel32f &channel, int radius )
 	return result;
 }
 
+
+///////////////////////////////////////////////////////////////////////////////////
+// Separable blurs
+namespace {
+
+// The vertical pass works on strips of this many floats across the image, a multiple of 3 and 4 channels
+const int32_t SEPARABLE_STRIP = 1536;
+
+// Symmetric 1D kernel; weights[k] applies to the pixels at -k and +k
+struct SeparableKernel {
+	int32_t				radius;
+	std::vector<float>	weights;
+};
+
+SeparableKernel makeGaussianKernel( float sigma )
+{
+	SeparableKernel result;
+	result.radius = std::max<int32_t>( (int32_t)std::ceil( sigma * 3 ), 1 );
+	result.weights.resize( result.radius + 1 );
+	double sum = 0;
+	std::vector<double> weights( result.radius + 1 );
+	for( int32_t k = 0; k <= result.radius; ++k ) {
+		weights[k] = std::exp( -( k * k ) / ( 2.0 * sigma * sigma ) );
+		sum += ( k == 0 ) ? weights[k] : 2 * weights[k];
+	}
+	for( int32_t k = 0; k <= result.radius; ++k )
+		result.weights[k] = (float)( weights[k] / sum );
+	return result;
+}
+
+// A box of 2 * floor(radius) + 1 pixels at full weight plus the next pixel on each side weighted by the fractional part of radius
+SeparableKernel makeBoxKernel( float radius )
+{
+	SeparableKernel result;
+	const int32_t whole = (int32_t)radius;
+	const float fraction = radius - whole;
+	result.radius = ( fraction > 0 ) ? whole + 1 : whole;
+	const float norm = 1.0f / ( 2 * radius + 1 );
+	result.weights.assign( result.radius + 1, norm );
+	if( fraction > 0 )
+		result.weights[result.radius] = fraction * norm;
+	return result;
+}
+
+template<typename T>
+inline T separableFromFloat( float v )
+{
+	return static_cast<T>( std::min( v + 0.5f, (float)CHANTRAIT<T>::max() ) );
+}
+
+template<>
+inline float separableFromFloat<float>( float v )
+{
+	return v;
+}
+
+// Copies \a length pixels of CHANNELS values spaced \a pixelInc apart into \a line, padded by \a radius copies of the edge pixels on each side
+template<typename T, uint8_t CHANNELS>
+void separableLoadLine( const T *src, ptrdiff_t pixelInc, int32_t length, int32_t radius, float *line )
+{
+	float *dst = line + radius * CHANNELS;
+	if( pixelInc == CHANNELS ) {
+		for( int32_t i = 0; i < length * CHANNELS; ++i )
+			dst[i] = src[i];
+	}
+	else {
+		for( int32_t x = 0; x < length; ++x, src += pixelInc )
+			for( uint8_t c = 0; c < CHANNELS; ++c )
+				dst[x * CHANNELS + c] = src[c];
+	}
+
+	const float *first = dst, *last = dst + ( length - 1 ) * CHANNELS;
+	for( int32_t p = 1; p <= radius; ++p ) {
+		for( uint8_t c = 0; c < CHANNELS; ++c ) {
+			dst[-p * CHANNELS + c] = first[c];
+			dst[( length - 1 + p ) * CHANNELS + c] = last[c];
+		}
+	}
+}
+
+// Convolves a padded line with \a kernel; the loops run over contiguous floats so they vectorize regardless of CHANNELS
+template<uint8_t CHANNELS>
+void separableConvolveLine( const float *line, int32_t length, const SeparableKernel &kernel, float *out )
+{
+	const int32_t n = length * CHANNELS;
+	const float *center = line + kernel.radius * CHANNELS;
+	const float w0 = kernel.weights[0];
+	for( int32_t i = 0; i < n; ++i )
+		out[i] = w0 * center[i];
+	for( int32_t k = 1; k <= kernel.radius; ++k ) {
+		const float w = kernel.weights[k];
+		const float *left = center - k * CHANNELS, *right = center + k * CHANNELS;
+		for( int32_t i = 0; i < n; ++i )
+			out[i] += w * ( left[i] + right[i] );
+	}
+}
+
+// The horizontal pass writes float rows to an intermediate image. The vertical pass then accumulates whole rows of it, which
+// keeps every inner loop contiguous, in strips of SEPARABLE_STRIP floats so the 2 * radius + 1 source rows of a strip stay in cache.
+// The source is read completely before anything is written, so \a srcData and \a dstData may alias.
+template<typename T, uint8_t CHANNELS>
+void separableBlur( const T *srcData, ptrdiff_t srcRowInc, uint8_t srcPixelInc, T *dstData, ptrdiff_t dstRowInc, uint8_t dstPixelInc,
+					int32_t width, int32_t height, const SeparableKernel &kernel, int numThreads )
+{
+	const int32_t radius = kernel.radius;
+	const int32_t rowFloats = width * CHANNELS;
+	// the intermediate is frame-sized, so draw it from the pixel allocator where a PixelPool can recycle it
+	std::shared_ptr<void> horizontalStore = PixelAllocator::get()->allocate( sizeof(float) * rowFloats * height );
+	float *horizontal = static_cast<float*>( horizontalStore.get() );
+
+	parallelForRows( 0, height, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		std::vector<float> line( ( width + 2 * radius ) * CHANNELS );
+		for( int32_t y = rowBegin; y < rowEnd; ++y ) {
+			separableLoadLine<T,CHANNELS>( srcData + y * srcRowInc, srcPixelInc, width, radius, line.data() );
+			separableConvolveLine<CHANNELS>( line.data(), width, kernel, &horizontal[(size_t)y * rowFloats] );
+		}
+	} );
+
+	parallelForRows( 0, height, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		std::vector<float> accum( std::min( SEPARABLE_STRIP, rowFloats ) );
+		for( int32_t stripBegin = 0; stripBegin < rowFloats; stripBegin += SEPARABLE_STRIP ) {
+			const int32_t stripSize = std::min( SEPARABLE_STRIP, rowFloats - stripBegin );
+			float *acc = accum.data();
+			for( int32_t y = rowBegin; y < rowEnd; ++y ) {
+				const float *center = &horizontal[(size_t)y * rowFloats + stripBegin];
+				const float w0 = kernel.weights[0];
+				for( int32_t i = 0; i < stripSize; ++i )
+					acc[i] = w0 * center[i];
+				for( int32_t k = 1; k <= radius; ++k ) {
+					const float w = kernel.weights[k];
+					const float *above = &horizontal[(size_t)std::max( y - k, 0 ) * rowFloats + stripBegin];
+					const float *below = &horizontal[(size_t)std::min( y + k, height - 1 ) * rowFloats + stripBegin];
+					for( int32_t i = 0; i < stripSize; ++i )
+						acc[i] += w * ( above[i] + below[i] );
+				}
+
+				T *dst = dstData + y * dstRowInc + ( stripBegin / CHANNELS ) * dstPixelInc;
+				if( dstPixelInc == CHANNELS ) {
+					for( int32_t i = 0; i < stripSize; ++i )
+						dst[i] = separableFromFloat<T>( acc[i] );
+				}
+				else {
+					for( int32_t i = 0; i < stripSize; i += CHANNELS, dst += dstPixelInc )
+						for( uint8_t c = 0; c < CHANNELS; ++c )
+							dst[c] = separableFromFloat<T>( acc[i + c] );
+				}
+			}
+		}
+	} );
+}
+
+template<typename T>
+void separableBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const Area &area, const SeparableKernel &kernel, int numThreads )
+{
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
+	const ptrdiff_t srcRowInc = srcSurface.getRowBytes() / sizeof(T), dstRowInc = dstSurface->getRowBytes() / sizeof(T);
+	if( srcSurface.hasAlpha() ) {
+		const T *src = srcSurface.getData( area.getUL() );
+		T *dst = dstSurface->getData( area.getUL() );
+		separableBlur<T,4>( src, srcRowInc, 4, dst, dstRowInc, 4, area.getWidth(), area.getHeight(), kernel, numThreads );
+	}
+	else {
+		const T *src = srcSurface.getData( area.getUL() ) + getPixelDataOffset( srcSurface );
+		T *dst = dstSurface->getData( area.getUL() ) + getPixelDataOffset( *dstSurface );
+		separableBlur<T,3>( src, srcRowInc, srcSurface.getPixelInc(), dst, dstRowInc, dstSurface->getPixelInc(), area.getWidth(), area.getHeight(), kernel, numThreads );
+	}
+}
+
+template<typename T>
+void separableBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Area &area, const SeparableKernel &kernel, int numThreads )
+{
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
+	separableBlur<T,1>( srcChannel.getData( area.getUL() ), srcChannel.getRowBytes() / sizeof(T), srcChannel.getIncrement(),
+						dstChannel->getData( area.getUL() ), dstChannel->getRowBytes() / sizeof(T), dstChannel->getIncrement(),
+						area.getWidth(), area.getHeight(), kernel, numThreads );
+}
+
+} // anonymous namespace
+
+template<typename T>
+void gaussianBlur( SurfaceT<T> *surface, float sigma, int numThreads )
+{
+	if( sigma > 0 )
+		separableBlur( *surface, surface, surface->getBounds(), makeGaussianKernel( sigma ), numThreads );
+}
+
+template<typename T>
+void gaussianBlur( SurfaceT<T> *surface, const Area &area, float sigma, int numThreads )
+{
+	if( sigma > 0 )
+		separableBlur( *surface, surface, area.getClipBy( surface->getBounds() ), makeGaussianKernel( sigma ), numThreads );
+}
+
+template<typename T>
+SurfaceT<T> gaussianBlurCopy( const SurfaceT<T> &surface, float sigma, int numThreads )
+{
+	if( sigma <= 0 )
+		return surface.clone();
+
+	SurfaceT<T> result = surface.clone( false );
+	separableBlur( surface, &result, surface.getBounds(), makeGaussianKernel( sigma ), numThreads );
+	return result;
+}
+
+template<typename T>
+void gaussianBlur( ChannelT<T> *channel, float sigma, int numThreads )
+{
+	if( sigma > 0 )
+		separableBlur( *channel, channel, channel->getBounds(), makeGaussianKernel( sigma ), numThreads );
+}
+
+template<typename T>
+void gaussianBlur( ChannelT<T> *channel, const Area &area, float sigma, int numThreads )
+{
+	if( sigma > 0 )
+		separableBlur( *channel, channel, area.getClipBy( channel->getBounds() ), makeGaussianKernel( sigma ), numThreads );
+}
+
+template<typename T>
+ChannelT<T> gaussianBlurCopy( const ChannelT<T> &channel, float sigma, int numThreads )
+{
+	if( sigma <= 0 )
+		return channel.clone();
+
+	ChannelT<T> result = channel.clone( false );
+	separableBlur( channel, &result, channel.getBounds(), makeGaussianKernel( sigma ), numThreads );
+	return result;
+}
+
+template<typename T>
+void boxBlur( SurfaceT<T> *surface, float radius, int numThreads )
+{
+	if( radius > 0 )
+		separableBlur( *surface, surface, surface->getBounds(), makeBoxKernel( radius ), numThreads );
+}
+
+template<typename T>
+void boxBlur( SurfaceT<T> *surface, const Area &area, float radius, int numThreads )
+{
+	if( radius > 0 )
+		separableBlur( *surface, surface, area.getClipBy( surface->getBounds() ), makeBoxKernel( radius ), numThreads );
+}
+
+template<typename T>
+SurfaceT<T> boxBlurCopy( const SurfaceT<T> &surface, float radius, int numThreads )
+{
+	if( radius <= 0 )
+		return surface.clone();
+
+	SurfaceT<T> result = surface.clone( false );
+	separableBlur( surface, &result, surface.getBounds(), makeBoxKernel( radius ), numThreads );
+	return result;
+}
+
+template<typename T>
+void boxBlur( ChannelT<T> *channel, float radius, int numThreads )
+{
+	if( radius > 0 )
+		separableBlur( *channel, channel, channel->getBounds(), makeBoxKernel( radius ), numThreads );
+}
+
+template<typename T>
+void boxBlur( ChannelT<T> *channel, const Area &area, float radius, int numThreads )
+{
+	if( radius > 0 )
+		separableBlur( *channel, channel, area.getClipBy( channel->getBounds() ), makeBoxKernel( radius ), numThreads );
+}
+
+template<typename T>
+ChannelT<T> boxBlurCopy( const ChannelT<T> &channel, float radius, int numThreads )
+{
+	if( radius <= 0 )
+		return channel.clone();
+
+	ChannelT<T> result = channel.clone( false );
+	separableBlur( channel, &result, channel.getBounds(), makeBoxKernel( radius ), numThreads );
+	return result;
+}
+
+#define separableBlur_PROTOTYPES(r,data,T)\
+	template void gaussianBlur( SurfaceT<T> *surface, float sigma, int numThreads ); \
+	template void gaussianBlur( SurfaceT<T> *surface, const Area &area, float sigma, int numThreads ); \
+	template SurfaceT<T> gaussianBlurCopy( const SurfaceT<T> &surface, float sigma, int numThreads ); \
+	template void gaussianBlur( ChannelT<T> *channel, float sigma, int numThreads ); \
+	template void gaussianBlur( ChannelT<T> *channel, const Area &area, float sigma, int numThreads ); \
+	template ChannelT<T> gaussianBlurCopy( const ChannelT<T> &channel, float sigma, int numThreads ); \
+	template void boxBlur( SurfaceT<T> *surface, float radius, int numThreads ); \
+	template void boxBlur( SurfaceT<T> *surface, const Area &area, float radius, int numThreads ); \
+	template SurfaceT<T> boxBlurCopy( const SurfaceT<T> &surface, float radius, int numThreads ); \
+	template void boxBlur( ChannelT<T> *channel, float radius, int numThreads ); \
+	template void boxBlur( ChannelT<T> *channel, const Area &area, float radius, int numThreads ); \
+	template ChannelT<T> boxBlurCopy( const ChannelT<T> &channel, float radius, int numThreads );
+
+BOOST_PP_SEQ_FOR_EACH( separableBlur_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+
 } } // namespace cinder::ip
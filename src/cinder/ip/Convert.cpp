@@ -0,0 +1,461 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Convert.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/CinderSimd.h"
+
+#include <boost/preprocessor/seq.hpp>
+#include <boost/preprocessor/seq/for_each_product.hpp>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// Describes how a destination pixel is built from a source pixel: the source element of each destination element, or -1 where it is filled with CHANTRAIT::max().
+// Shuffles work on 16-byte groups of pixels, 4 / sizeof(T) of them, which are 12 bytes long for 3-element pixels. mShuffle and mFill build a destination group from a source group.
+struct SwizzleParams {
+	uint8_t		mSrcInc, mDstInc;
+	int8_t		mSrc[4];
+	uint8_t		mShuffle[16], mFill[16];
+};
+
+template<typename T>
+SwizzleParams makeSwizzleParams( const SurfaceChannelOrder &srcOrder, const SurfaceChannelOrder &dstOrder )
+{
+	SwizzleParams result;
+	result.mSrcInc = srcOrder.getPixelInc();
+	result.mDstInc = dstOrder.getPixelInc();
+
+	// alpha takes the source alpha when there is one and padding takes the source's fourth element, alpha or padding, so that matching orders copy every element
+	const int8_t srcFourth = ( result.mSrcInc == 4 ) ? 0 + 1 + 2 + 3 - srcOrder.getRedOffset() - srcOrder.getGreenOffset() - srcOrder.getBlueOffset() : -1;
+	for( int e = 0; e < 4; ++e )
+		result.mSrc[e] = srcFourth;
+	if( dstOrder.hasAlpha() )
+		result.mSrc[dstOrder.getAlphaOffset()] = srcOrder.hasAlpha() ? srcOrder.getAlphaOffset() : -1;
+	result.mSrc[dstOrder.getRedOffset()] = srcOrder.getRedOffset();
+	result.mSrc[dstOrder.getGreenOffset()] = srcOrder.getGreenOffset();
+	result.mSrc[dstOrder.getBlueOffset()] = srcOrder.getBlueOffset();
+
+	const T fill = CHANTRAIT<T>::max();
+	uint8_t fillBytes[sizeof(T)];
+	memcpy( fillBytes, &fill, sizeof(T) );
+	memset( result.mShuffle, 0x80, sizeof(result.mShuffle) );
+	memset( result.mFill, 0, sizeof(result.mFill) );
+	for( int p = 0; p < 4 / (int)sizeof(T); ++p ) {
+		for( int e = 0; e < result.mDstInc; ++e ) {
+			for( int b = 0; b < (int)sizeof(T); ++b ) {
+				const int dstByte = ( p * result.mDstInc + e ) * sizeof(T) + b;
+				if( result.mSrc[e] >= 0 )
+					result.mShuffle[dstByte] = ( p * result.mSrcInc + result.mSrc[e] ) * sizeof(T) + b;
+				else
+					result.mFill[dstByte] = fillBytes[b];
+			}
+		}
+	}
+
+	return result;
+}
+
+template<typename T, int SRCINC, int DSTINC>
+void swizzleRow( const T *src, T *dst, int32_t width, const SwizzleParams &params )
+{
+	// at most one element is filled, which is written after the copied ones rather than tested for in the inner loop
+	int idx[4], fillElement = -1;
+	for( int e = 0; e < 4; ++e ) {
+		idx[e] = std::max<int>( params.mSrc[e], 0 );
+		if( params.mSrc[e] < 0 && e < DSTINC )
+			fillElement = e;
+	}
+
+	const T fill = CHANTRAIT<T>::max();
+	for( int32_t x = 0; x < width; ++x ) {
+		const T e0 = src[idx[0]], e1 = src[idx[1]], e2 = src[idx[2]], e3 = src[idx[3]];
+		dst[0] = e0;
+		dst[1] = e1;
+		dst[2] = e2;
+		if( DSTINC == 4 )
+			dst[3] = e3;
+		if( fillElement >= 0 )
+			dst[fillElement] = fill;
+		src += SRCINC;
+		dst += DSTINC;
+	}
+}
+
+template<typename T>
+void swizzleRowScalar( const T *src, T *dst, int32_t width, const SwizzleParams &params )
+{
+	if( params.mSrcInc == 4 && params.mDstInc == 4 )
+		swizzleRow<T,4,4>( src, dst, width, params );
+	else if( params.mSrcInc == 4 )
+		swizzleRow<T,4,3>( src, dst, width, params );
+	else if( params.mDstInc == 4 )
+		swizzleRow<T,3,4>( src, dst, width, params );
+	else
+		swizzleRow<T,3,3>( src, dst, width, params );
+}
+
+#if defined( CINDER_SIMD_SSE2 )
+
+// SSE2 has no byte shuffle, so 8-bit 4-element pixels are swizzled by shifting and masking each element of the 32-bit pixel into place
+void swizzleRowSse2( const uint8_t *src, uint8_t *dst, int32_t width, const SwizzleParams &params )
+{
+	const __m128i fill = _mm_loadu_si128( reinterpret_cast<const __m128i*>( params.mFill ) );
+	__m128i srcShift[4], mask[4];
+	for( int e = 0; e < 4; ++e ) {
+		srcShift[e] = _mm_cvtsi32_si128( 8 * std::max<int>( params.mSrc[e], 0 ) );
+		mask[e] = _mm_set1_epi32( ( params.mSrc[e] >= 0 ) ? 0xFF : 0 );
+	}
+
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4 ) {
+		const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x * 4 ) );
+		__m128i result = _mm_or_si128( fill, _mm_and_si128( _mm_srl_epi32( v, srcShift[0] ), mask[0] ) );
+		result = _mm_or_si128( result, _mm_slli_epi32( _mm_and_si128( _mm_srl_epi32( v, srcShift[1] ), mask[1] ), 8 ) );
+		result = _mm_or_si128( result, _mm_slli_epi32( _mm_and_si128( _mm_srl_epi32( v, srcShift[2] ), mask[2] ), 16 ) );
+		result = _mm_or_si128( result, _mm_slli_epi32( _mm_and_si128( _mm_srl_epi32( v, srcShift[3] ), mask[3] ), 24 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x * 4 ), result );
+	}
+	swizzleRow<uint8_t,4,4>( src + x * 4, dst + x * 4, width - x, params );
+}
+
+// Shuffles two groups per iteration, one in each 128-bit lane. 12-byte groups are read and written 16 bytes at a time, the extra 4 bytes
+// being overwritten by the following group, so the loop stops while a full 16 bytes still lie within the row.
+template<typename T, int SRCINC, int DSTINC>
+CINDER_SIMD_TARGET_AVX2 void swizzleRowAvx2( const T *src, T *dst, int32_t width, const SwizzleParams &params )
+{
+	const int32_t groupPixels = 4 / sizeof(T);
+	const int32_t srcGroupBytes = SRCINC * 4, dstGroupBytes = DSTINC * 4;
+	const int32_t srcBytes = width * SRCINC * sizeof(T), dstBytes = width * DSTINC * sizeof(T);
+	const __m256i shuffle = _mm256_broadcastsi128_si256( _mm_loadu_si128( reinterpret_cast<const __m128i*>( params.mShuffle ) ) );
+	const __m256i fill = _mm256_broadcastsi128_si256( _mm_loadu_si128( reinterpret_cast<const __m128i*>( params.mFill ) ) );
+	const uint8_t *srcBase = reinterpret_cast<const uint8_t*>( src );
+	uint8_t *dstBase = reinterpret_cast<uint8_t*>( dst );
+
+	int32_t g = 0;
+	for( ; ( g + 1 ) * srcGroupBytes + 16 <= srcBytes && ( g + 1 ) * dstGroupBytes + 16 <= dstBytes; g += 2 ) {
+		const uint8_t *s = srcBase + g * srcGroupBytes;
+		uint8_t *d = dstBase + g * dstGroupBytes;
+		__m256i v;
+		if( SRCINC == 4 )
+			v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s ) );
+		else
+			v = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( reinterpret_cast<const __m128i*>( s ) ) ), _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + srcGroupBytes ) ), 1 );
+		v = _mm256_or_si256( _mm256_shuffle_epi8( v, shuffle ), fill );
+		if( DSTINC == 4 )
+			_mm256_storeu_si256( reinterpret_cast<__m256i*>( d ), v );
+		else {
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( d ), _mm256_castsi256_si128( v ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( d + dstGroupBytes ), _mm256_extracti128_si256( v, 1 ) );
+		}
+	}
+
+	const int32_t x = g * groupPixels;
+	swizzleRow<T,SRCINC,DSTINC>( src + x * SRCINC, dst + x * DSTINC, width - x, params );
+}
+
+#endif // defined( CINDER_SIMD_SSE2 )
+
+template<typename T>
+using SwizzleRowFn = void (*)( const T *src, T *dst, int32_t width, const SwizzleParams &params );
+
+template<typename T>
+SwizzleRowFn<T> selectSwizzleRow( const SwizzleParams &params, simd::Level level )
+{
+#if defined( CINDER_SIMD_SSE2 )
+	if( level == simd::Level::AVX2 ) {
+		if( params.mSrcInc == 4 && params.mDstInc == 4 )
+			return &swizzleRowAvx2<T,4,4>;
+		else if( params.mSrcInc == 4 )
+			return &swizzleRowAvx2<T,4,3>;
+		else if( params.mDstInc == 4 )
+			return &swizzleRowAvx2<T,3,4>;
+		else
+			return &swizzleRowAvx2<T,3,3>;
+	}
+	else if( level == simd::Level::SSE2 && std::is_same<T,uint8_t>::value && params.mSrcInc == 4 && params.mDstInc == 4 )
+		return reinterpret_cast<SwizzleRowFn<T>>( &swizzleRowSse2 );
+#endif
+	return &swizzleRowScalar<T>;
+}
+
+// Depth conversion kernels return the number of leading elements they converted, which match CHANTRAIT::convert() exactly; the remainder is converted by convertElements()
+template<typename S, typename D>
+int32_t convertElementsSimd( const S * /*src*/, D * /*dst*/, int32_t /*count*/, simd::Level /*level*/ )
+{
+	return 0;
+}
+
+#if defined( CINDER_SIMD_SSE2 )
+
+CINDER_SIMD_TARGET_AVX2 int32_t convertElementsAvx2( const uint8_t *src, float *dst, int32_t count )
+{
+	const __m256 scale = _mm256_set1_ps( 255.0f );
+	int32_t i = 0;
+	for( ; i + 8 <= count; i += 8 ) {
+		const __m256i v = _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src + i ) ) );
+		_mm256_storeu_ps( dst + i, _mm256_div_ps( _mm256_cvtepi32_ps( v ), scale ) );
+	}
+	return i;
+}
+
+CINDER_SIMD_TARGET_AVX2 int32_t convertElementsAvx2( const uint16_t *src, float *dst, int32_t count )
+{
+	const __m256 scale = _mm256_set1_ps( 65535.0f );
+	int32_t i = 0;
+	for( ; i + 8 <= count; i += 8 ) {
+		const __m256i v = _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) ) );
+		_mm256_storeu_ps( dst + i, _mm256_div_ps( _mm256_cvtepi32_ps( v ), scale ) );
+	}
+	return i;
+}
+
+CINDER_SIMD_TARGET_AVX2 int32_t convertElementsAvx2( const float *src, uint8_t *dst, int32_t count )
+{
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps( 1.0f ), scale = _mm256_set1_ps( 255.0f );
+	const __m256i order = _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 );
+	__m256i v[4];
+	int32_t i = 0;
+	for( ; i + 32 <= count; i += 32 ) {
+		for( int k = 0; k < 4; ++k )
+			v[k] = _mm256_cvttps_epi32( _mm256_mul_ps( _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( src + i + k * 8 ), zero ), one ), scale ) );
+		const __m256i packed = _mm256_packus_epi16( _mm256_packs_epi32( v[0], v[1] ), _mm256_packs_epi32( v[2], v[3] ) );
+		_mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i ), _mm256_permutevar8x32_epi32( packed, order ) );
+	}
+	return i;
+}
+
+CINDER_SIMD_TARGET_AVX2 int32_t convertElementsAvx2( const float *src, uint16_t *dst, int32_t count )
+{
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps( 1.0f ), scale = _mm256_set1_ps( 65535.0f );
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		const __m256i a = _mm256_cvttps_epi32( _mm256_mul_ps( _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( src + i ), zero ), one ), scale ) );
+		const __m256i b = _mm256_cvttps_epi32( _mm256_mul_ps( _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( src + i + 8 ), zero ), one ), scale ) );
+		_mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i ), _mm256_permute4x64_epi64( _mm256_packus_epi32( a, b ), 0xD8 ) );
+	}
+	return i;
+}
+
+CINDER_SIMD_TARGET_AVX2 int32_t convertElementsAvx2( const uint8_t *src, uint16_t *dst, int32_t count )
+{
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		const __m256i v = _mm256_cvtepu8_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) ) );
+		_mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i ), _mm256_or_si256( v, _mm256_slli_epi16( v, 8 ) ) );
+	}
+	return i;
+}
+
+// v / 257 == ( v * 0xFF01 ) >> 24 for every 16-bit v
+CINDER_SIMD_TARGET_AVX2 int32_t convertElementsAvx2( const uint16_t *src, uint8_t *dst, int32_t count )
+{
+	const __m256i scale = _mm256_set1_epi16( (short)0xFF01 );
+	int32_t i = 0;
+	for( ; i + 32 <= count; i += 32 ) {
+		const __m256i a = _mm256_srli_epi16( _mm256_mulhi_epu16( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src + i ) ), scale ), 8 );
+		const __m256i b = _mm256_srli_epi16( _mm256_mulhi_epu16( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src + i + 16 ) ), scale ), 8 );
+		_mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + i ), _mm256_permute4x64_epi64( _mm256_packus_epi16( a, b ), 0xD8 ) );
+	}
+	return i;
+}
+
+int32_t convertElementsSse2( const uint8_t *src, float *dst, int32_t count )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps( 255.0f );
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		const __m128i lo = _mm_unpacklo_epi8( v, zero ), hi = _mm_unpackhi_epi8( v, zero );
+		_mm_storeu_ps( dst + i, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo, zero ) ), scale ) );
+		_mm_storeu_ps( dst + i + 4, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo, zero ) ), scale ) );
+		_mm_storeu_ps( dst + i + 8, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi, zero ) ), scale ) );
+		_mm_storeu_ps( dst + i + 12, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi, zero ) ), scale ) );
+	}
+	return i;
+}
+
+int32_t convertElementsSse2( const uint16_t *src, float *dst, int32_t count )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps( 65535.0f );
+	int32_t i = 0;
+	for( ; i + 8 <= count; i += 8 ) {
+		const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		_mm_storeu_ps( dst + i, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( v, zero ) ), scale ) );
+		_mm_storeu_ps( dst + i + 4, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( v, zero ) ), scale ) );
+	}
+	return i;
+}
+
+int32_t convertElementsSse2( const float *src, uint8_t *dst, int32_t count )
+{
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps( 1.0f ), scale = _mm_set1_ps( 255.0f );
+	__m128i v[4];
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		for( int k = 0; k < 4; ++k )
+			v[k] = _mm_cvttps_epi32( _mm_mul_ps( _mm_min_ps( _mm_max_ps( _mm_loadu_ps( src + i + k * 4 ), zero ), one ), scale ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packus_epi16( _mm_packs_epi32( v[0], v[1] ), _mm_packs_epi32( v[2], v[3] ) ) );
+	}
+	return i;
+}
+
+// SSE2 only packs to signed 16-bit, so the values are biased into that range and back
+int32_t convertElementsSse2( const float *src, uint16_t *dst, int32_t count )
+{
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps( 1.0f ), scale = _mm_set1_ps( 65535.0f );
+	const __m128i bias32 = _mm_set1_epi32( 32768 ), bias16 = _mm_set1_epi16( (short)0x8000 );
+	int32_t i = 0;
+	for( ; i + 8 <= count; i += 8 ) {
+		const __m128i a = _mm_cvttps_epi32( _mm_mul_ps( _mm_min_ps( _mm_max_ps( _mm_loadu_ps( src + i ), zero ), one ), scale ) );
+		const __m128i b = _mm_cvttps_epi32( _mm_mul_ps( _mm_min_ps( _mm_max_ps( _mm_loadu_ps( src + i + 4 ), zero ), one ), scale ) );
+		const __m128i packed = _mm_packs_epi32( _mm_sub_epi32( a, bias32 ), _mm_sub_epi32( b, bias32 ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_xor_si128( packed, bias16 ) );
+	}
+	return i;
+}
+
+int32_t convertElementsSse2( const uint8_t *src, uint16_t *dst, int32_t count )
+{
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_unpacklo_epi8( v, v ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i + 8 ), _mm_unpackhi_epi8( v, v ) );
+	}
+	return i;
+}
+
+int32_t convertElementsSse2( const uint16_t *src, uint8_t *dst, int32_t count )
+{
+	const __m128i scale = _mm_set1_epi16( (short)0xFF01 );
+	int32_t i = 0;
+	for( ; i + 16 <= count; i += 16 ) {
+		const __m128i a = _mm_srli_epi16( _mm_mulhi_epu16( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) ), scale ), 8 );
+		const __m128i b = _mm_srli_epi16( _mm_mulhi_epu16( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i + 8 ) ), scale ), 8 );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packus_epi16( a, b ) );
+	}
+	return i;
+}
+
+#define convert_SIMD_OVERLOAD(S,D)\
+	int32_t convertElementsSimd( const S *src, D *dst, int32_t count, simd::Level level )\
+	{\
+		if( level == simd::Level::AVX2 )\
+			return convertElementsAvx2( src, dst, count );\
+		else if( level == simd::Level::SSE2 )\
+			return convertElementsSse2( src, dst, count );\
+		return 0;\
+	}
+
+convert_SIMD_OVERLOAD( uint8_t, float )
+convert_SIMD_OVERLOAD( uint16_t, float )
+convert_SIMD_OVERLOAD( float, uint8_t )
+convert_SIMD_OVERLOAD( float, uint16_t )
+convert_SIMD_OVERLOAD( uint8_t, uint16_t )
+convert_SIMD_OVERLOAD( uint16_t, uint8_t )
+
+#endif // defined( CINDER_SIMD_SSE2 )
+
+template<typename S, typename D>
+void convertElements( const S *src, D *dst, int32_t count, simd::Level level )
+{
+	for( int32_t i = convertElementsSimd( src, dst, count, level ); i < count; ++i )
+		dst[i] = CHANTRAIT<D>::convert( src[i] );
+}
+
+} // anonymous namespace
+
+template<typename S, typename D>
+void convert( const SurfaceT<S> &srcSurface, const Area &srcArea, SurfaceT<D> *dstSurface, const ivec2 &dstLT, int numThreads )
+{
+	const std::pair<Area,ivec2> srcDst = clippedSrcDst( srcSurface.getBounds(), srcArea, dstSurface->getBounds(), dstLT );
+	const Area &area = srcDst.first;
+	const ivec2 &dstOffset = srcDst.second;
+	const int32_t width = area.getWidth();
+	if( width <= 0 || area.getHeight() <= 0 )
+		return;
+
+	const SurfaceChannelOrder &srcOrder = srcSurface.getChannelOrder(), &dstOrder = dstSurface->getChannelOrder();
+	const uint8_t srcInc = srcOrder.getPixelInc(), dstInc = dstOrder.getPixelInc();
+	const bool sameOrder = srcOrder == dstOrder;
+	const bool sameDepth = std::is_same<S,D>::value;
+	// a depth change is paired with a swizzle in the smaller of the two types, through a row of temporary storage
+	const bool swizzleFirst = sizeof(S) <= sizeof(D);
+
+	// the kernels are picked once per call from the channel orders and the instruction set
+	const simd::Level level = simd::getLevel();
+	const SwizzleParams srcParams = makeSwizzleParams<S>( srcOrder, dstOrder );
+	const SwizzleParams dstParams = makeSwizzleParams<D>( srcOrder, dstOrder );
+	const SwizzleRowFn<S> swizzleSrc = selectSwizzleRow<S>( srcParams, level );
+	const SwizzleRowFn<D> swizzleDst = selectSwizzleRow<D>( dstParams, level );
+
+	parallelForRows( 0, area.getHeight(), numThreads, [&]( int32_t begin, int32_t end ) {
+		std::vector<uint8_t> tmp;
+		if( ! sameOrder && ! sameDepth )
+			tmp.resize( width * 4 * std::max( sizeof(S), sizeof(D) ) );
+		for( int32_t y = begin; y < end; ++y ) {
+			const S *src = reinterpret_cast<const S*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + area.x1 * srcInc ) + ( area.y1 + y ) * srcSurface.getRowBytes() );
+			D *dst = reinterpret_cast<D*>( reinterpret_cast<uint8_t*>( dstSurface->getData() + dstOffset.x * dstInc ) + ( dstOffset.y + y ) * dstSurface->getRowBytes() );
+			if( sameOrder && sameDepth )
+				memcpy( dst, src, width * srcInc * sizeof(S) );
+			else if( sameOrder )
+				convertElements( src, dst, width * srcInc, level );
+			else if( sameDepth )
+				swizzleSrc( src, reinterpret_cast<S*>( dst ), width, srcParams );
+			else if( swizzleFirst ) {
+				S *swizzled = reinterpret_cast<S*>( tmp.data() );
+				swizzleSrc( src, swizzled, width, srcParams );
+				convertElements( swizzled, dst, width * dstInc, level );
+			}
+			else {
+				D *converted = reinterpret_cast<D*>( tmp.data() );
+				convertElements( src, converted, width * srcInc, level );
+				swizzleDst( converted, dst, width, dstParams );
+			}
+		}
+	} );
+}
+
+template<typename S, typename D>
+void convert( const SurfaceT<S> &srcSurface, SurfaceT<D> *dstSurface, int numThreads )
+{
+	dstSurface->setPremultiplied( srcSurface.isPremultiplied() );
+	convert( srcSurface, srcSurface.getBounds(), dstSurface, ivec2( 0, 0 ), numThreads );
+}
+
+#define convert_PROTOTYPES(r,types)\
+	template void convert( const SurfaceT<BOOST_PP_SEQ_ELEM( 0, types )> &srcSurface, const Area &srcArea, SurfaceT<BOOST_PP_SEQ_ELEM( 1, types )> *dstSurface, const ivec2 &dstLT, int numThreads );\
+	template void convert( const SurfaceT<BOOST_PP_SEQ_ELEM( 0, types )> &srcSurface, SurfaceT<BOOST_PP_SEQ_ELEM( 1, types )> *dstSurface, int numThreads );
+
+BOOST_PP_SEQ_FOR_EACH_PRODUCT( convert_PROTOTYPES, ((uint8_t)(uint16_t)(float))((uint8_t)(uint16_t)(float)) )
+
+} } // namespace cinder::ip
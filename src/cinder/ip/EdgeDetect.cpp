@@ -23,45 +23,373 @@
 #include "cinder/ip/EdgeDetect.h"
 #include "cinder/Surface.h"
 #include "cinder/CinderMath.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/ip/Parallel.h"
 
 #include <boost/preprocessor/seq.hpp>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
 
 namespace cinder { namespace ip {
 
+namespace {
+
+// A 3x3 derivative kernel is separable into a smoothing ( edge, center, edge ) and a difference ( -1, 0, 1 )
+struct GradientWeights {
+	GradientWeights( GradientKernel kernel )
+		: edge( kernel == GradientKernel::SCHARR ? 3.0f : 1.0f ), center( kernel == GradientKernel::SCHARR ? 10.0f : 2.0f )
+	{}
+
+	float	edge, center;
+};
+
+// atan2( y, x ) via the polynomial of Abramowitz and Stegun 4.4.49 on [0, 1], max error ~1.2e-5 radians. The SIMD kernels evaluate exactly the same operations.
+inline float gradientOrientation( float y, float x )
+{
+	const float absX = std::abs( x ), absY = std::abs( y );
+	const float maxXY = std::max( absX, absY ), minXY = std::min( absX, absY );
+	const float a = ( maxXY > 0 ) ? minXY / maxXY : 0.0f;
+	const float s = a * a;
+	float r = a * ( 0.9998660f + s * ( -0.3302995f + s * ( 0.1801410f + s * ( -0.0851330f + s * 0.0208351f ) ) ) );
+	if( absY > absX )
+		r = 1.57079637f - r;
+	if( x < 0 )
+		r = 3.14159274f - r;
+	if( y < 0 )
+		r = -r;
+	return r;
+}
+
+// Smooths and differentiates three rows vertically, for the elements [begin, end)
+void gradientVerticalScalar( const float *above, const float *row, const float *below, const GradientWeights &weights, float *smooth, float *diff, int32_t begin, int32_t end )
+{
+	for( int32_t i = begin; i < end; ++i ) {
+		smooth[i] = ( above[i] + below[i] ) * weights.edge + row[i] * weights.center;
+		diff[i] = below[i] - above[i];
+	}
+}
+
+// Differentiates \a smooth and smooths \a diff horizontally, producing the outputs for the pixels [begin, end). The input rows are padded by one element on each side.
+void gradientHorizontalScalar( const float *smooth, const float *diff, const GradientWeights &weights, float *dx, float *dy, float *magnitude, float *orientation, int32_t begin, int32_t end )
+{
+	for( int32_t x = begin; x < end; ++x ) {
+		const float gx = smooth[x + 2] - smooth[x];
+		const float gy = ( diff[x] + diff[x + 2] ) * weights.edge + diff[x + 1] * weights.center;
+		if( dx )
+			dx[x] = gx;
+		if( dy )
+			dy[x] = gy;
+		if( magnitude )
+			magnitude[x] = std::sqrt( gx * gx + gy * gy );
+		if( orientation )
+			orientation[x] = gradientOrientation( gy, gx );
+	}
+}
+
+#if defined( CINDER_SIMD_SSE2 )
+
+struct GradientOpsSse2 {
+	typedef __m128		V;
+	static const int SIZE = 4;
+
+	void load( V &v, const float *p ) const							{ v = _mm_loadu_ps( p ); }
+	void store( float *p, const V &v ) const						{ _mm_storeu_ps( p, v ); }
+	void set1( V &v, float f ) const								{ v = _mm_set1_ps( f ); }
+	void add( V &r, const V &a, const V &b ) const					{ r = _mm_add_ps( a, b ); }
+	void sub( V &r, const V &a, const V &b ) const					{ r = _mm_sub_ps( a, b ); }
+	void mul( V &r, const V &a, const V &b ) const					{ r = _mm_mul_ps( a, b ); }
+	void div( V &r, const V &a, const V &b ) const					{ r = _mm_div_ps( a, b ); }
+	void sqrt( V &r, const V &a ) const								{ r = _mm_sqrt_ps( a ); }
+	void min( V &r, const V &a, const V &b ) const					{ r = _mm_min_ps( a, b ); }
+	void max( V &r, const V &a, const V &b ) const					{ r = _mm_max_ps( a, b ); }
+	void abs( V &r, const V &a ) const								{ r = _mm_andnot_ps( _mm_set1_ps( -0.0f ), a ); }
+	void cmpGt( V &r, const V &a, const V &b ) const				{ r = _mm_cmpgt_ps( a, b ); }
+	void cmpLt( V &r, const V &a, const V &b ) const				{ r = _mm_cmplt_ps( a, b ); }
+	void bitAnd( V &r, const V &a, const V &b ) const				{ r = _mm_and_ps( a, b ); }
+	void bitXor( V &r, const V &a, const V &b ) const				{ r = _mm_xor_ps( a, b ); }
+	void select( V &r, const V &mask, const V &a, const V &b ) const	{ r = _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) ); }
+};
+
+struct GradientOpsAvx2 {
+	typedef __m256		V;
+	static const int SIZE = 8;
+
+	CINDER_SIMD_TARGET_AVX2 void load( V &v, const float *p ) const						{ v = _mm256_loadu_ps( p ); }
+	CINDER_SIMD_TARGET_AVX2 void store( float *p, const V &v ) const					{ _mm256_storeu_ps( p, v ); }
+	CINDER_SIMD_TARGET_AVX2 void set1( V &v, float f ) const							{ v = _mm256_set1_ps( f ); }
+	CINDER_SIMD_TARGET_AVX2 void add( V &r, const V &a, const V &b ) const				{ r = _mm256_add_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void sub( V &r, const V &a, const V &b ) const				{ r = _mm256_sub_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void mul( V &r, const V &a, const V &b ) const				{ r = _mm256_mul_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void div( V &r, const V &a, const V &b ) const				{ r = _mm256_div_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void sqrt( V &r, const V &a ) const							{ r = _mm256_sqrt_ps( a ); }
+	CINDER_SIMD_TARGET_AVX2 void min( V &r, const V &a, const V &b ) const				{ r = _mm256_min_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void max( V &r, const V &a, const V &b ) const				{ r = _mm256_max_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void abs( V &r, const V &a ) const							{ r = _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), a ); }
+	CINDER_SIMD_TARGET_AVX2 void cmpGt( V &r, const V &a, const V &b ) const			{ r = _mm256_cmp_ps( a, b, _CMP_GT_OQ ); }
+	CINDER_SIMD_TARGET_AVX2 void cmpLt( V &r, const V &a, const V &b ) const			{ r = _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+	CINDER_SIMD_TARGET_AVX2 void bitAnd( V &r, const V &a, const V &b ) const			{ r = _mm256_and_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void bitXor( V &r, const V &a, const V &b ) const			{ r = _mm256_xor_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void select( V &r, const V &mask, const V &a, const V &b ) const	{ r = _mm256_blendv_ps( b, a, mask ); }
+};
+
+template<typename OPS>
+CINDER_SIMD_FORCEINLINE void gradientOrientationSimd( const OPS &ops, const typename OPS::V &y, const typename OPS::V &x, typename OPS::V &result )
+{
+	typedef typename OPS::V V;
+	V zero, absX, absY, maxXY, minXY, a, s, poly, r, t, mask;
+	ops.set1( zero, 0.0f );
+	ops.abs( absX, x );
+	ops.abs( absY, y );
+	ops.max( maxXY, absX, absY );
+	ops.min( minXY, absX, absY );
+	// a = min / max, or 0 where both are 0
+	ops.cmpGt( mask, maxXY, zero );
+	ops.div( a, minXY, maxXY );
+	ops.bitAnd( a, mask, a );
+	ops.mul( s, a, a );
+
+	static const float sCoefficients[] = { -0.0851330f, 0.1801410f, -0.3302995f, 0.9998660f };
+	ops.set1( poly, 0.0208351f );
+	for( float coefficient : sCoefficients ) {
+		ops.mul( poly, s, poly );
+		ops.set1( t, coefficient );
+		ops.add( poly, t, poly );
+	}
+	ops.mul( r, a, poly );
+
+	// unfold the octant: pi / 2 - r where |y| > |x|, pi - r where x < 0, then take the sign of y
+	ops.cmpGt( mask, absY, absX );
+	ops.set1( t, 1.57079637f );
+	ops.sub( t, t, r );
+	ops.select( r, mask, t, r );
+	ops.cmpLt( mask, x, zero );
+	ops.set1( t, 3.14159274f );
+	ops.sub( t, t, r );
+	ops.select( r, mask, t, r );
+	ops.cmpLt( mask, y, zero );
+	ops.set1( t, -0.0f );
+	ops.bitAnd( mask, mask, t );
+	ops.bitXor( result, r, mask );
+}
+
+template<typename OPS>
+CINDER_SIMD_FORCEINLINE void gradientRowSimd( const OPS &ops, const float *above, const float *row, const float *below, const GradientWeights &weights,
+												float *smooth, float *diff, float *dx, float *dy, float *magnitude, float *orientation, int32_t width )
+{
+	typedef typename OPS::V V;
+	V edge, center;
+	ops.set1( edge, weights.edge );
+	ops.set1( center, weights.center );
+
+	const int32_t paddedWidth = width + 2;
+	int32_t i = 0;
+	for( ; i + OPS::SIZE <= paddedWidth; i += OPS::SIZE ) {
+		V a, b, c, t;
+		ops.load( a, above + i );
+		ops.load( b, below + i );
+		ops.load( c, row + i );
+		ops.add( t, a, b );
+		ops.mul( t, t, edge );
+		ops.mul( c, c, center );
+		ops.add( t, t, c );
+		ops.store( smooth + i, t );
+		ops.sub( t, b, a );
+		ops.store( diff + i, t );
+	}
+	gradientVerticalScalar( above, row, below, weights, smooth, diff, i, paddedWidth );
+
+	int32_t x = 0;
+	for( ; x + OPS::SIZE <= width; x += OPS::SIZE ) {
+		V gx, gy, t, u;
+		ops.load( gx, smooth + x + 2 );
+		ops.load( t, smooth + x );
+		ops.sub( gx, gx, t );
+		ops.load( gy, diff + x );
+		ops.load( t, diff + x + 2 );
+		ops.add( gy, gy, t );
+		ops.mul( gy, gy, edge );
+		ops.load( t, diff + x + 1 );
+		ops.mul( t, t, center );
+		ops.add( gy, gy, t );
+		if( dx )
+			ops.store( dx + x, gx );
+		if( dy )
+			ops.store( dy + x, gy );
+		if( magnitude ) {
+			ops.mul( t, gx, gx );
+			ops.mul( u, gy, gy );
+			ops.add( t, t, u );
+			ops.sqrt( t, t );
+			ops.store( magnitude + x, t );
+		}
+		if( orientation ) {
+			gradientOrientationSimd( ops, gy, gx, t );
+			ops.store( orientation + x, t );
+		}
+	}
+	gradientHorizontalScalar( smooth, diff, weights, dx, dy, magnitude, orientation, x, width );
+}
+
+void gradientRowSse2( const float *above, const float *row, const float *below, const GradientWeights &weights,
+						float *smooth, float *diff, float *dx, float *dy, float *magnitude, float *orientation, int32_t width )
+{
+	const GradientOpsSse2 ops;
+	gradientRowSimd( ops, above, row, below, weights, smooth, diff, dx, dy, magnitude, orientation, width );
+}
+
+CINDER_SIMD_TARGET_AVX2 void gradientRowAvx2( const float *above, const float *row, const float *below, const GradientWeights &weights,
+												float *smooth, float *diff, float *dx, float *dy, float *magnitude, float *orientation, int32_t width )
+{
+	const GradientOpsAvx2 ops;
+	gradientRowSimd( ops, above, row, below, weights, smooth, diff, dx, dy, magnitude, orientation, width );
+}
+
+#endif // defined( CINDER_SIMD_SSE2 )
+
+// Computes the outputs for one row of \a width pixels from three source rows of width + 2, padded by one pixel on each side.
+// \a smooth and \a diff are scratch rows of width + 2; any of the outputs may be null.
+void gradientRow( const float *above, const float *row, const float *below, const GradientWeights &weights,
+					float *smooth, float *diff, float *dx, float *dy, float *magnitude, float *orientation, int32_t width )
+{
+#if defined( CINDER_SIMD_SSE2 )
+	const simd::Level simdLevel = simd::getLevel();
+	if( simdLevel >= simd::Level::AVX2 )
+		return gradientRowAvx2( above, row, below, weights, smooth, diff, dx, dy, magnitude, orientation, width );
+	else if( simdLevel >= simd::Level::SSE2 )
+		return gradientRowSse2( above, row, below, weights, smooth, diff, dx, dy, magnitude, orientation, width );
+#endif
+	gradientVerticalScalar( above, row, below, weights, smooth, diff, 0, width + 2 );
+	gradientHorizontalScalar( smooth, diff, weights, dx, dy, magnitude, orientation, 0, width );
+}
+
+// Converts the source row \a y, columns [x1 - 1, x1 + width], to float, clamping coordinates to the bounds of \a channel
+template<typename T>
+void loadGradientRow( const ChannelT<T> &channel, int32_t y, int32_t x1, int32_t width, float *dst )
+{
+	y = constrain<int32_t>( y, 0, channel.getHeight() - 1 );
+	const T *src = channel.getData( 0, y );
+	const uint8_t inc = channel.getIncrement();
+	const int32_t maxX = channel.getWidth() - 1;
+	dst[0] = src[std::max<int32_t>( x1 - 1, 0 ) * inc];
+	if( inc == 1 ) {
+		const T *srcLine = src + x1;
+		for( int32_t x = 0; x < width; ++x )
+			dst[x + 1] = srcLine[x];
+	}
+	else {
+		const T *srcLine = src + x1 * inc;
+		for( int32_t x = 0; x < width; ++x )
+			dst[x + 1] = srcLine[x * inc];
+	}
+	dst[width + 1] = src[std::min<int32_t>( x1 + width, maxX ) * inc];
+}
+
+// Stores \a width values to \a dst, clamping to the channel's range and truncating when \a T is integral
+template<typename T>
+void storeGradientRow( const float *src, T *dst, uint8_t inc, int32_t width )
+{
+	const float maxValue = (float)CHANTRAIT<T>::max();
+	for( int32_t x = 0; x < width; ++x )
+		dst[x * inc] = static_cast<T>( std::min( src[x], maxValue ) );
+}
+
+inline void storeGradientRow( const float *src, float *dst, uint8_t inc, int32_t width )
+{
+	for( int32_t x = 0; x < width; ++x )
+		dst[x * inc] = src[x];
+}
+
+template<typename T>
+void clipGradientArea( const ChannelT<T> *dstChannel, const Area &srcBounds, Area *srcArea, ivec2 *dstOffset )
+{
+	if( dstChannel ) {
+		std::pair<Area,ivec2> srcDst = clippedSrcDst( srcBounds, *srcArea, dstChannel->getBounds(), *dstOffset );
+		*srcArea = srcDst.first;
+		*dstOffset = srcDst.second;
+	}
+}
+
+// Returns a pointer to row \a y of \a dstChannel when it's tightly packed float, otherwise \a scratch, which is copied out by storeGradientOutput()
+template<typename M>
+float* getGradientOutput( ChannelT<M> *dstChannel, int32_t x, int32_t y, float *scratch )
+{
+	if( dstChannel && std::is_same<M,float>::value && dstChannel->getIncrement() == 1 )
+		return reinterpret_cast<float*>( dstChannel->getData( x, y ) );
+	else
+		return scratch;
+}
+
+template<typename M>
+void storeGradientOutput( const float *output, ChannelT<M> *dstChannel, int32_t x, int32_t y, int32_t width )
+{
+	if( dstChannel && reinterpret_cast<const void*>( output ) != reinterpret_cast<const void*>( dstChannel->getData( x, y ) ) )
+		storeGradientRow( output, dstChannel->getData( x, y ), dstChannel->getIncrement(), width );
+}
+
+// Gradients of \a srcArea written at \a dstLT. \a magnitude may be of any channel type, which edgeDetectSobel() relies on.
+template<typename T, typename M>
+void gradientsImpl( const ChannelT<T> &srcChannel, const Area &srcArea, const ivec2 &dstLT, Channel32f *dx, Channel32f *dy, ChannelT<M> *magnitude, Channel32f *orientation,
+					GradientKernel kernel, int numThreads )
+{
+	Area area = srcArea;
+	ivec2 dstOffset = dstLT;
+	clipGradientArea( dx, srcChannel.getBounds(), &area, &dstOffset );
+	clipGradientArea( dy, srcChannel.getBounds(), &area, &dstOffset );
+	clipGradientArea( magnitude, srcChannel.getBounds(), &area, &dstOffset );
+	clipGradientArea( orientation, srcChannel.getBounds(), &area, &dstOffset );
+	area.clipBy( srcChannel.getBounds() );
+	const int32_t width = area.getWidth();
+	if( width <= 0 || area.getHeight() <= 0 || ! ( dx || dy || magnitude || orientation ) )
+		return;
+
+	const GradientWeights weights( kernel );
+	parallelForRows( area.y1, area.y2, numThreads, [&]( int32_t bandBegin, int32_t bandEnd ) {
+		// three source rows, two vertical pass rows and four output rows
+		const size_t stride = width + 2;
+		std::vector<float> buffer( stride * 9 );
+		float *rows[3] = { &buffer[0], &buffer[stride], &buffer[stride * 2] };
+		float *smooth = &buffer[stride * 3], *diff = &buffer[stride * 4];
+		float *scratch[4] = { &buffer[stride * 5], &buffer[stride * 6], &buffer[stride * 7], &buffer[stride * 8] };
+
+		loadGradientRow( srcChannel, bandBegin - 1, area.x1, width, rows[0] );
+		loadGradientRow( srcChannel, bandBegin, area.x1, width, rows[1] );
+		for( int32_t y = bandBegin; y < bandEnd; ++y ) {
+			loadGradientRow( srcChannel, y + 1, area.x1, width, rows[2] );
+
+			const int32_t dstX = dstOffset.x, dstY = dstOffset.y + y - area.y1;
+			float *dxRow = dx ? getGradientOutput( dx, dstX, dstY, scratch[0] ) : nullptr;
+			float *dyRow = dy ? getGradientOutput( dy, dstX, dstY, scratch[1] ) : nullptr;
+			float *magnitudeRow = magnitude ? getGradientOutput( magnitude, dstX, dstY, scratch[2] ) : nullptr;
+			float *orientationRow = orientation ? getGradientOutput( orientation, dstX, dstY, scratch[3] ) : nullptr;
+			gradientRow( rows[0], rows[1], rows[2], weights, smooth, diff, dxRow, dyRow, magnitudeRow, orientationRow, width );
+			if( dx )
+				storeGradientOutput( dxRow, dx, dstX, dstY, width );
+			if( dy )
+				storeGradientOutput( dyRow, dy, dstX, dstY, width );
+			if( magnitude )
+				storeGradientOutput( magnitudeRow, magnitude, dstX, dstY, width );
+			if( orientation )
+				storeGradientOutput( orientationRow, orientation, dstX, dstY, width );
+
+			std::rotate( rows, rows + 1, rows + 3 );
+		}
+	} );
+}
+
+} // anonymous namespace
+
 //     X           Y
-// -1  0  1     1  2  1
-// -2  0  2     0  0  0
 // -1  0  1    -1 -2 -1
-// NOTE: this leaves garbage in the top and bottom rows, as well as the left and right columns
+// -2  0  2     0  0  0
+// -1  0  1     1  2  1
+// Pixels beyond the edges of srcChannel are clamped to them
 
 template<typename T>
 void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const ivec2 &dstLT, ChannelT<T> *dstChannel )
 {
-	std::pair<Area,ivec2> srcDst = clippedSrcDst( srcChannel.getBounds(), srcArea, dstChannel->getBounds(), dstLT );
-	const Area &area( srcDst.first );
-	const ivec2 &dstOffset( srcDst.second );
-	typename CHANTRAIT<T>::SignedSum sumX, sumY;
-
-	ptrdiff_t srcRowInc = srcChannel.getRowBytes() / sizeof(T);
-	uint8_t srcPixelInc = srcChannel.getIncrement();
-	uint8_t dstPixelInc = dstChannel->getIncrement();
-	const T maxValue = CHANTRAIT<T>::max();
-	for( int32_t y = 1; y < area.getHeight() - 1; ++y ) {
-		const T *srcLine = srcChannel.getData( area.getX1() + 1, area.getY1() + y );
-		T *dstLine = dstChannel->getData( dstOffset.x + area.getX1() + 1, dstOffset.y + y );
-		for( int32_t x = area.getX1() + 1; x < area.getX2() - 1; ++x ) {
-			sumX = -*(srcLine-srcRowInc-srcPixelInc) + *(srcLine-srcRowInc+srcPixelInc) - 2 * *(srcLine-srcPixelInc)
-							+ 2 * *(srcLine+srcPixelInc) - *(srcLine+srcRowInc-srcPixelInc) + *(srcLine+srcRowInc+srcPixelInc);
-			sumY = *(srcLine-srcRowInc-srcPixelInc) + 2 * *(srcLine-srcRowInc) + *(srcLine-srcRowInc+srcPixelInc)
-							- *(srcLine+srcRowInc-srcPixelInc) - 2 * *(srcLine+srcPixelInc) - *(srcLine+srcRowInc+srcPixelInc);
-			sumX = (typename CHANTRAIT<T>::SignedSum)math<float>::sqrt( (float)sumX * sumX + (float)sumY * sumY );
-			if( sumX > maxValue )
-				sumX = maxValue;
-			*dstLine = static_cast<T>( sumX );
-			dstLine += dstPixelInc;
-			srcLine += srcPixelInc;
-		}
-	}
+	gradientsImpl<T,T>( srcChannel, srcArea, dstLT, nullptr, nullptr, dstChannel, nullptr, GradientKernel::SOBEL, 1 );
 }
 
 template<typename T>
@@ -86,12 +414,26 @@ void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSuface )
 	edgeDetectSobel( srcSurface, srcSurface.getBounds(), ivec2(), dstSuface );
 }
 
+template<typename T>
+void gradients( const ChannelT<T> &srcChannel, const Area &srcArea, const ivec2 &dstOffset, Channel32f *dx, Channel32f *dy, Channel32f *magnitude, Channel32f *orientation,
+				GradientKernel kernel, int numThreads )
+{
+	gradientsImpl<T,float>( srcChannel, srcArea, dstOffset, dx, dy, magnitude, orientation, kernel, numThreads );
+}
+
+template<typename T>
+void gradients( const ChannelT<T> &srcChannel, Channel32f *dx, Channel32f *dy, Channel32f *magnitude, Channel32f *orientation, GradientKernel kernel, int numThreads )
+{
+	gradientsImpl<T,float>( srcChannel, srcChannel.getBounds(), ivec2(), dx, dy, magnitude, orientation, kernel, numThreads );
+}
 
 #define edgeDetect_PROTOTYPES(r,data,T)\
 	template void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const ivec2 &dstLT, ChannelT<T> *dstChannel ); \
 	template void edgeDetectSobel( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &dstLT, SurfaceT<T> *dstSurface ); \
 	template void edgeDetectSobel( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel );	\
-	template void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );	
+	template void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );	\
+	template void gradients( const ChannelT<T> &srcChannel, const Area &srcArea, const ivec2 &dstOffset, Channel32f *dx, Channel32f *dy, Channel32f *magnitude, Channel32f *orientation, GradientKernel kernel, int numThreads ); \
+	template void gradients( const ChannelT<T> &srcChannel, Channel32f *dx, Channel32f *dy, Channel32f *magnitude, Channel32f *orientation, GradientKernel kernel, int numThreads );
 
 BOOST_PP_SEQ_FOR_EACH( edgeDetect_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
 
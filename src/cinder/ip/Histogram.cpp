@@ -0,0 +1,806 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Histogram.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/CinderMath.h"
+#include "cinder/CinderSimd.h"
+
+#include <boost/preprocessor/seq.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Statistics
+
+template<typename T>
+struct StatisticsSum {
+	typedef uint64_t	Type;
+};
+
+template<>
+struct StatisticsSum<float> {
+	typedef double		Type;
+};
+
+// Totals of up to four interleaved channels, where lane i accumulates the values at positions i, i + period, i + 2 * period... of each row
+template<typename T>
+struct StatisticsAccumulator {
+	typedef typename StatisticsSum<T>::Type		Sum;
+
+	StatisticsAccumulator()
+	{
+		for( int lane = 0; lane < 4; ++lane ) {
+			mMin[lane] = std::numeric_limits<T>::max();
+			mMax[lane] = std::numeric_limits<T>::lowest();
+			mSum[lane] = mSumSquares[lane] = 0;
+			mCount[lane] = 0;
+		}
+	}
+
+	void merge( const StatisticsAccumulator &rhs )
+	{
+		for( int lane = 0; lane < 4; ++lane ) {
+			mMin[lane] = std::min( mMin[lane], rhs.mMin[lane] );
+			mMax[lane] = std::max( mMax[lane], rhs.mMax[lane] );
+			mSum[lane] += rhs.mSum[lane];
+			mSumSquares[lane] += rhs.mSumSquares[lane];
+			mCount[lane] += rhs.mCount[lane];
+		}
+	}
+
+	StatisticsT<T> getStatistics( int lane ) const
+	{
+		StatisticsT<T> result;
+		result.mCount = mCount[lane];
+		if( mCount[lane] ) {
+			const double count = (double)mCount[lane];
+			result.mMin = mMin[lane];
+			result.mMax = mMax[lane];
+			result.mMean = (double)mSum[lane] / count;
+			result.mStdDev = std::sqrt( std::max( (double)mSumSquares[lane] / count - result.mMean * result.mMean, 0.0 ) );
+		}
+		return result;
+	}
+
+	T		mMin[4], mMax[4];
+	Sum		mSum[4], mSumSquares[4];
+	uint64_t	mCount[4];
+};
+
+template<typename T>
+CINDER_SIMD_FORCEINLINE void accumulateValue( T value, int lane, StatisticsAccumulator<T> *acc )
+{
+	typedef typename StatisticsAccumulator<T>::Sum Sum;
+	acc->mMin[lane] = std::min( acc->mMin[lane], value );
+	acc->mMax[lane] = std::max( acc->mMax[lane], value );
+	acc->mSum[lane] += (Sum)value;
+	acc->mSumSquares[lane] += (Sum)value * (Sum)value;
+	acc->mCount[lane]++;
+}
+
+// Accumulates the values [begin, end) of a row whose lane 0 is at position 0, one pixel of PERIOD values at a time
+template<int PERIOD, typename T>
+void accumulateStatisticsScalar( const T *values, size_t begin, size_t end, StatisticsAccumulator<T> *acc )
+{
+	size_t i = begin;
+	for( ; i < end && ( i % PERIOD ); ++i )
+		accumulateValue( values[i], (int)( i % PERIOD ), acc );
+	for( ; i + PERIOD <= end; i += PERIOD )
+		for( int lane = 0; lane < PERIOD; ++lane )
+			accumulateValue( values[i + lane], lane, acc );
+	for( ; i < end; ++i )
+		accumulateValue( values[i], (int)( i % PERIOD ), acc );
+}
+
+template<typename T>
+void accumulateStatisticsScalar( const T *values, size_t begin, size_t end, int period, StatisticsAccumulator<T> *acc )
+{
+	switch( period ) {
+		case 1: accumulateStatisticsScalar<1>( values, begin, end, acc ); break;
+		case 2: accumulateStatisticsScalar<2>( values, begin, end, acc ); break;
+		case 3: accumulateStatisticsScalar<3>( values, begin, end, acc ); break;
+		default: accumulateStatisticsScalar<4>( values, begin, end, acc ); break;
+	}
+}
+
+// Adds the totals of positions modulo 4 gathered by a vector kernel into the lanes of \a acc modulo \a period, which divides 4
+template<typename T>
+void foldStatistics( const T *mins, const T *maxs, int numMinMaxLanes, const typename StatisticsAccumulator<T>::Sum *sums, const typename StatisticsAccumulator<T>::Sum *sumSquares,
+						size_t numValues, int period, StatisticsAccumulator<T> *acc )
+{
+	for( int i = 0; i < numMinMaxLanes; ++i ) {
+		acc->mMin[i % period] = std::min( acc->mMin[i % period], mins[i] );
+		acc->mMax[i % period] = std::max( acc->mMax[i % period], maxs[i] );
+	}
+	for( int i = 0; i < 4; ++i ) {
+		acc->mSum[i % period] += sums[i];
+		acc->mSumSquares[i % period] += sumSquares[i];
+	}
+	for( int lane = 0; lane < period; ++lane )
+		acc->mCount[lane] += numValues / period;
+}
+
+#if defined( CINDER_SIMD_SSE2 )
+
+// The vector kernels accumulate the first multiple of the vector width of a row's values, and return how many they processed. Every vector
+// lane holds positions that are equal modulo 4, so channels interleaved with a period of 1, 2 or 4 never mix. Integer sums are kept in
+// 32-bit lanes for chunks small enough that they can't overflow, then widened.
+const size_t STATISTICS_CHUNK = 65536;
+
+size_t accumulateStatisticsSse2( const uint8_t *values, size_t numValues, int period, StatisticsAccumulator<uint8_t> *acc )
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i minV = _mm_set1_epi8( (char)0xFF ), maxV = zero;
+	uint64_t sums[4] = { 0 }, sumSquares[4] = { 0 };
+	size_t i = 0;
+	while( i + 16 <= numValues ) {
+		const size_t chunkEnd = std::min( numValues, i + STATISTICS_CHUNK );
+		__m128i sum = zero, sumSq = zero;
+		for( ; i + 16 <= chunkEnd; i += 16 ) {
+			const __m128i v = _mm_loadu_si128( (const __m128i*)( values + i ) );
+			minV = _mm_min_epu8( minV, v );
+			maxV = _mm_max_epu8( maxV, v );
+			const __m128i lo = _mm_unpacklo_epi8( v, zero ), hi = _mm_unpackhi_epi8( v, zero );
+			const __m128i s = _mm_add_epi16( lo, hi );
+			sum = _mm_add_epi32( sum, _mm_add_epi32( _mm_unpacklo_epi16( s, zero ), _mm_unpackhi_epi16( s, zero ) ) );
+			const __m128i sqLo = _mm_mullo_epi16( lo, lo ), sqHi = _mm_mullo_epi16( hi, hi );
+			sumSq = _mm_add_epi32( sumSq, _mm_add_epi32( _mm_unpacklo_epi16( sqLo, zero ), _mm_unpackhi_epi16( sqLo, zero ) ) );
+			sumSq = _mm_add_epi32( sumSq, _mm_add_epi32( _mm_unpacklo_epi16( sqHi, zero ), _mm_unpackhi_epi16( sqHi, zero ) ) );
+		}
+		uint32_t sumLanes[4], sumSqLanes[4];
+		_mm_storeu_si128( (__m128i*)sumLanes, sum );
+		_mm_storeu_si128( (__m128i*)sumSqLanes, sumSq );
+		for( int lane = 0; lane < 4; ++lane ) {
+			sums[lane] += sumLanes[lane];
+			sumSquares[lane] += sumSqLanes[lane];
+		}
+	}
+	uint8_t mins[16], maxs[16];
+	_mm_storeu_si128( (__m128i*)mins, minV );
+	_mm_storeu_si128( (__m128i*)maxs, maxV );
+	foldStatistics<uint8_t>( mins, maxs, i ? 16 : 0, sums, sumSquares, i, period, acc );
+	return i;
+}
+
+size_t accumulateStatisticsSse2( const uint16_t *values, size_t numValues, int period, StatisticsAccumulator<uint16_t> *acc )
+{
+	// SSE2 only compares signed 16-bit values, so values are biased by 0x8000 for min and max
+	const __m128i zero = _mm_setzero_si128(), bias = _mm_set1_epi16( (short)0x8000 );
+	__m128i minV = _mm_set1_epi16( 0x7FFF ), maxV = _mm_set1_epi16( (short)0x8000 );
+	__m128i sumSqEven = zero, sumSqOdd = zero;
+	uint64_t sums[4] = { 0 };
+	size_t i = 0;
+	while( i + 8 <= numValues ) {
+		const size_t chunkEnd = std::min( numValues, i + STATISTICS_CHUNK );
+		__m128i sum = zero;
+		for( ; i + 8 <= chunkEnd; i += 8 ) {
+			const __m128i v = _mm_loadu_si128( (const __m128i*)( values + i ) );
+			const __m128i biased = _mm_xor_si128( v, bias );
+			minV = _mm_min_epi16( minV, biased );
+			maxV = _mm_max_epi16( maxV, biased );
+			const __m128i lo = _mm_unpacklo_epi16( v, zero ), hi = _mm_unpackhi_epi16( v, zero );
+			sum = _mm_add_epi32( sum, _mm_add_epi32( lo, hi ) );
+			// 64-bit squares of the even and odd 32-bit lanes
+			sumSqEven = _mm_add_epi64( sumSqEven, _mm_add_epi64( _mm_mul_epu32( lo, lo ), _mm_mul_epu32( hi, hi ) ) );
+			const __m128i loOdd = _mm_srli_epi64( lo, 32 ), hiOdd = _mm_srli_epi64( hi, 32 );
+			sumSqOdd = _mm_add_epi64( sumSqOdd, _mm_add_epi64( _mm_mul_epu32( loOdd, loOdd ), _mm_mul_epu32( hiOdd, hiOdd ) ) );
+		}
+		uint32_t sumLanes[4];
+		_mm_storeu_si128( (__m128i*)sumLanes, sum );
+		for( int lane = 0; lane < 4; ++lane )
+			sums[lane] += sumLanes[lane];
+	}
+	uint64_t even[2], odd[2];
+	_mm_storeu_si128( (__m128i*)even, sumSqEven );
+	_mm_storeu_si128( (__m128i*)odd, sumSqOdd );
+	const uint64_t sumSquares[4] = { even[0], odd[0], even[1], odd[1] };
+	uint16_t mins[8], maxs[8];
+	_mm_storeu_si128( (__m128i*)mins, _mm_xor_si128( minV, bias ) );
+	_mm_storeu_si128( (__m128i*)maxs, _mm_xor_si128( maxV, bias ) );
+	foldStatistics<uint16_t>( mins, maxs, i ? 8 : 0, sums, sumSquares, i, period, acc );
+	return i;
+}
+
+size_t accumulateStatisticsSse2( const float *values, size_t numValues, int period, StatisticsAccumulator<float> *acc )
+{
+	__m128 minV = _mm_set1_ps( std::numeric_limits<float>::max() ), maxV = _mm_set1_ps( std::numeric_limits<float>::lowest() );
+	__m128d sumLo = _mm_setzero_pd(), sumHi = _mm_setzero_pd(), sumSqLo = _mm_setzero_pd(), sumSqHi = _mm_setzero_pd();
+	size_t i = 0;
+	for( ; i + 4 <= numValues; i += 4 ) {
+		const __m128 v = _mm_loadu_ps( values + i );
+		minV = _mm_min_ps( minV, v );
+		maxV = _mm_max_ps( maxV, v );
+		const __m128d lo = _mm_cvtps_pd( v ), hi = _mm_cvtps_pd( _mm_movehl_ps( v, v ) );
+		sumLo = _mm_add_pd( sumLo, lo );
+		sumHi = _mm_add_pd( sumHi, hi );
+		sumSqLo = _mm_add_pd( sumSqLo, _mm_mul_pd( lo, lo ) );
+		sumSqHi = _mm_add_pd( sumSqHi, _mm_mul_pd( hi, hi ) );
+	}
+	double sums[4], sumSquares[4];
+	_mm_storeu_pd( sums, sumLo );
+	_mm_storeu_pd( sums + 2, sumHi );
+	_mm_storeu_pd( sumSquares, sumSqLo );
+	_mm_storeu_pd( sumSquares + 2, sumSqHi );
+	float mins[4], maxs[4];
+	_mm_storeu_ps( mins, minV );
+	_mm_storeu_ps( maxs, maxV );
+	foldStatistics<float>( mins, maxs, i ? 4 : 0, sums, sumSquares, i, period, acc );
+	return i;
+}
+
+CINDER_SIMD_TARGET_AVX2 size_t accumulateStatisticsAvx2( const uint8_t *values, size_t numValues, int period, StatisticsAccumulator<uint8_t> *acc )
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i minV = _mm256_set1_epi8( (char)0xFF ), maxV = zero;
+	uint64_t sums[4] = { 0 }, sumSquares[4] = { 0 };
+	size_t i = 0;
+	while( i + 32 <= numValues ) {
+		const size_t chunkEnd = std::min( numValues, i + STATISTICS_CHUNK );
+		__m256i sum = zero, sumSq = zero;
+		for( ; i + 32 <= chunkEnd; i += 32 ) {
+			const __m256i v = _mm256_loadu_si256( (const __m256i*)( values + i ) );
+			minV = _mm256_min_epu8( minV, v );
+			maxV = _mm256_max_epu8( maxV, v );
+			const __m256i lo = _mm256_unpacklo_epi8( v, zero ), hi = _mm256_unpackhi_epi8( v, zero );
+			const __m256i s = _mm256_add_epi16( lo, hi );
+			sum = _mm256_add_epi32( sum, _mm256_add_epi32( _mm256_unpacklo_epi16( s, zero ), _mm256_unpackhi_epi16( s, zero ) ) );
+			const __m256i sqLo = _mm256_mullo_epi16( lo, lo ), sqHi = _mm256_mullo_epi16( hi, hi );
+			sumSq = _mm256_add_epi32( sumSq, _mm256_add_epi32( _mm256_unpacklo_epi16( sqLo, zero ), _mm256_unpackhi_epi16( sqLo, zero ) ) );
+			sumSq = _mm256_add_epi32( sumSq, _mm256_add_epi32( _mm256_unpacklo_epi16( sqHi, zero ), _mm256_unpackhi_epi16( sqHi, zero ) ) );
+		}
+		uint32_t sumLanes[8], sumSqLanes[8];
+		_mm256_storeu_si256( (__m256i*)sumLanes, sum );
+		_mm256_storeu_si256( (__m256i*)sumSqLanes, sumSq );
+		for( int lane = 0; lane < 8; ++lane ) {
+			sums[lane % 4] += sumLanes[lane];
+			sumSquares[lane % 4] += sumSqLanes[lane];
+		}
+	}
+	uint8_t mins[32], maxs[32];
+	_mm256_storeu_si256( (__m256i*)mins, minV );
+	_mm256_storeu_si256( (__m256i*)maxs, maxV );
+	foldStatistics<uint8_t>( mins, maxs, i ? 32 : 0, sums, sumSquares, i, period, acc );
+	return i;
+}
+
+CINDER_SIMD_TARGET_AVX2 size_t accumulateStatisticsAvx2( const uint16_t *values, size_t numValues, int period, StatisticsAccumulator<uint16_t> *acc )
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i minV = _mm256_set1_epi16( (short)0xFFFF ), maxV = zero;
+	__m256i sumSqEven = zero, sumSqOdd = zero;
+	uint64_t sums[4] = { 0 };
+	size_t i = 0;
+	while( i + 16 <= numValues ) {
+		const size_t chunkEnd = std::min( numValues, i + STATISTICS_CHUNK );
+		__m256i sum = zero;
+		for( ; i + 16 <= chunkEnd; i += 16 ) {
+			const __m256i v = _mm256_loadu_si256( (const __m256i*)( values + i ) );
+			minV = _mm256_min_epu16( minV, v );
+			maxV = _mm256_max_epu16( maxV, v );
+			const __m256i lo = _mm256_unpacklo_epi16( v, zero ), hi = _mm256_unpackhi_epi16( v, zero );
+			sum = _mm256_add_epi32( sum, _mm256_add_epi32( lo, hi ) );
+			sumSqEven = _mm256_add_epi64( sumSqEven, _mm256_add_epi64( _mm256_mul_epu32( lo, lo ), _mm256_mul_epu32( hi, hi ) ) );
+			const __m256i loOdd = _mm256_srli_epi64( lo, 32 ), hiOdd = _mm256_srli_epi64( hi, 32 );
+			sumSqOdd = _mm256_add_epi64( sumSqOdd, _mm256_add_epi64( _mm256_mul_epu32( loOdd, loOdd ), _mm256_mul_epu32( hiOdd, hiOdd ) ) );
+		}
+		uint32_t sumLanes[8];
+		_mm256_storeu_si256( (__m256i*)sumLanes, sum );
+		for( int lane = 0; lane < 8; ++lane )
+			sums[lane % 4] += sumLanes[lane];
+	}
+	uint64_t even[4], odd[4];
+	_mm256_storeu_si256( (__m256i*)even, sumSqEven );
+	_mm256_storeu_si256( (__m256i*)odd, sumSqOdd );
+	const uint64_t sumSquares[4] = { even[0] + even[2], odd[0] + odd[2], even[1] + even[3], odd[1] + odd[3] };
+	uint16_t mins[16], maxs[16];
+	_mm256_storeu_si256( (__m256i*)mins, minV );
+	_mm256_storeu_si256( (__m256i*)maxs, maxV );
+	foldStatistics<uint16_t>( mins, maxs, i ? 16 : 0, sums, sumSquares, i, period, acc );
+	return i;
+}
+
+CINDER_SIMD_TARGET_AVX2 size_t accumulateStatisticsAvx2( const float *values, size_t numValues, int period, StatisticsAccumulator<float> *acc )
+{
+	__m256 minV = _mm256_set1_ps( std::numeric_limits<float>::max() ), maxV = _mm256_set1_ps( std::numeric_limits<float>::lowest() );
+	__m256d sum = _mm256_setzero_pd(), sumSq = _mm256_setzero_pd();
+	size_t i = 0;
+	for( ; i + 8 <= numValues; i += 8 ) {
+		const __m256 v = _mm256_loadu_ps( values + i );
+		minV = _mm256_min_ps( minV, v );
+		maxV = _mm256_max_ps( maxV, v );
+		const __m256d lo = _mm256_cvtps_pd( _mm256_castps256_ps128( v ) ), hi = _mm256_cvtps_pd( _mm256_extractf128_ps( v, 1 ) );
+		sum = _mm256_add_pd( sum, _mm256_add_pd( lo, hi ) );
+		sumSq = _mm256_add_pd( sumSq, _mm256_add_pd( _mm256_mul_pd( lo, lo ), _mm256_mul_pd( hi, hi ) ) );
+	}
+	double sums[4], sumSquares[4];
+	_mm256_storeu_pd( sums, sum );
+	_mm256_storeu_pd( sumSquares, sumSq );
+	float mins[8], maxs[8];
+	_mm256_storeu_ps( mins, minV );
+	_mm256_storeu_ps( maxs, maxV );
+	foldStatistics<float>( mins, maxs, i ? 8 : 0, sums, sumSquares, i, period, acc );
+	return i;
+}
+
+#endif // defined( CINDER_SIMD_SSE2 )
+
+// Accumulates a row of \a numValues values made of channels interleaved with \a period
+template<typename T>
+void accumulateStatistics( const T *values, size_t numValues, int period, StatisticsAccumulator<T> *acc )
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_SSE2 )
+	if( 4 % period == 0 ) {
+		const simd::Level simdLevel = simd::getLevel();
+		if( simdLevel >= simd::Level::AVX2 )
+			i = accumulateStatisticsAvx2( values, numValues, period, acc );
+		else if( simdLevel >= simd::Level::SSE2 )
+			i = accumulateStatisticsSse2( values, numValues, period, acc );
+	}
+#endif
+	accumulateStatisticsScalar( values, i, numValues, period, acc );
+}
+
+// Accumulates the rows of \a area starting at \a data, each \a numValues values long
+template<typename T>
+StatisticsAccumulator<T> accumulateStatistics( const T *data, ptrdiff_t rowBytes, const Area &area, size_t numValues, int period, int numThreads )
+{
+	StatisticsAccumulator<T> result;
+	std::mutex mutex;
+	parallelForRows( 0, area.getHeight(), numThreads, [&]( int32_t bandBegin, int32_t bandEnd ) {
+		StatisticsAccumulator<T> band;
+		for( int32_t y = bandBegin; y < bandEnd; ++y )
+			accumulateStatistics( reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( data ) + y * rowBytes ), numValues, period, &band );
+		std::lock_guard<std::mutex> lock( mutex );
+		result.merge( band );
+	} );
+	return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Histograms
+
+uint32_t shiftBin( uint8_t value, int shift )	{ return value >> shift; }
+uint32_t shiftBin( uint16_t value, int shift )	{ return value >> shift; }
+uint32_t shiftBin( float, int )					{ return 0; }
+
+// Maps values to histogram bins. Integer values spanning their type's range map to a power-of-two number of bins with a shift.
+template<typename T>
+class HistogramBinner {
+  public:
+	HistogramBinner( int numBins, float minValue, float maxValue )
+		: mNumBins( std::max( numBins, 1 ) ), mMinValue( minValue ), mShift( -1 )
+	{
+		const bool integral = std::numeric_limits<T>::is_integer;
+		const float range = integral ? ( maxValue - minValue + 1 ) : ( maxValue - minValue );
+		mScale = ( range > 0 ) ? mNumBins / range : 0;
+		if( integral && minValue == 0 && maxValue == (float)CHANTRAIT<T>::max() ) {
+			for( int shift = 0; shift < 16; ++shift )
+				if( ( (int64_t)mNumBins << shift ) == (int64_t)range )
+					mShift = shift;
+		}
+	}
+
+	int getNumBins() const { return mNumBins; }
+
+	uint32_t operator()( T value ) const
+	{
+		if( mShift >= 0 )
+			return shiftBin( value, mShift );
+		const float f = ( (float)value - mMinValue ) * mScale;
+		if( ! ( f >= 0 ) ) // also catches NaN
+			return 0;
+		return ( f < mNumBins ) ? (uint32_t)f : mNumBins - 1;
+	}
+
+  private:
+	int		mNumBins;
+	float	mMinValue, mScale;
+	int		mShift;
+};
+
+template<typename T>
+float getHistogramMax()
+{
+	return (float)CHANTRAIT<T>::max();
+}
+
+template<>
+float getHistogramMax<float>()
+{
+	return 1.0f;
+}
+
+// Counts the values of \a area into \a counts, interleaving four sub-histograms so that runs of equal values don't serialize on one counter
+template<typename T>
+void histogramRows( const ChannelT<T> &channel, const Area &area, int32_t rowBegin, int32_t rowEnd, const HistogramBinner<T> &binner, uint32_t *counts )
+{
+	const uint8_t inc = channel.getIncrement();
+	const size_t numBins = binner.getNumBins();
+	uint32_t *counts0 = counts, *counts1 = counts + numBins, *counts2 = counts + numBins * 2, *counts3 = counts + numBins * 3;
+	for( int32_t y = rowBegin; y < rowEnd; ++y ) {
+		const T *line = channel.getData( area.x1, y );
+		int32_t x = 0;
+		for( ; x + 4 <= area.getWidth(); x += 4 ) {
+			counts0[binner( line[( x + 0 ) * inc] )]++;
+			counts1[binner( line[( x + 1 ) * inc] )]++;
+			counts2[binner( line[( x + 2 ) * inc] )]++;
+			counts3[binner( line[( x + 3 ) * inc] )]++;
+		}
+		for( ; x < area.getWidth(); ++x )
+			counts0[binner( line[x * inc] )]++;
+	}
+}
+
+// Counts \a width interleaved pixels of INC values, each into its own histogram of \a counts
+template<int INC, typename T>
+void histogramPixels( const T *line, int32_t width, const HistogramBinner<T> &binner, uint32_t *counts )
+{
+	const size_t numBins = binner.getNumBins();
+	for( int32_t x = 0; x < width; ++x, line += INC )
+		for( int c = 0; c < INC; ++c )
+			counts[c * numBins + binner( line[c] )]++;
+}
+
+template<typename T>
+std::vector<uint32_t> histogramImpl( const ChannelT<T> &channel, const Area &srcArea, const HistogramBinner<T> &binner, int numThreads )
+{
+	const size_t numBins = binner.getNumBins();
+	std::vector<uint32_t> result( numBins, 0 );
+	const Area area = srcArea.getClipBy( channel.getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return result;
+
+	std::mutex mutex;
+	parallelForRows( area.y1, area.y2, numThreads, [&]( int32_t bandBegin, int32_t bandEnd ) {
+		std::vector<uint32_t> counts( numBins * 4, 0 );
+		histogramRows( channel, area, bandBegin, bandEnd, binner, counts.data() );
+		std::lock_guard<std::mutex> lock( mutex );
+		for( size_t b = 0; b < numBins; ++b )
+			result[b] += counts[b] + counts[b + numBins] + counts[b + numBins * 2] + counts[b + numBins * 3];
+	} );
+	return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Equalization
+
+// The number of bins used to equalize each type; 16-bit tiles and floats are binned to 12 bits
+template<typename T>
+struct EqualizationBins {
+	static const int GLOBAL = 256;
+	static const int TILE = 256;
+};
+
+template<>
+struct EqualizationBins<uint16_t> {
+	static const int GLOBAL = 65536;
+	static const int TILE = 4096;
+};
+
+template<>
+struct EqualizationBins<float> {
+	static const int GLOBAL = 4096;
+	static const int TILE = 4096;
+};
+
+// Converts a normalized value back to \a T, rounding integers
+template<typename T>
+T fromNormalized( float value )
+{
+	return static_cast<T>( std::min( value, 1.0f ) * CHANTRAIT<T>::max() + 0.5f );
+}
+
+template<>
+float fromNormalized<float>( float value )
+{
+	return value;
+}
+
+template<typename T>
+void applyLookup( ChannelT<T> *channel, const HistogramBinner<T> &binner, const std::vector<T> &lookup, int numThreads )
+{
+	const uint8_t inc = channel->getIncrement();
+	const int32_t width = channel->getWidth();
+	parallelForRows( 0, channel->getHeight(), numThreads, [&]( int32_t bandBegin, int32_t bandEnd ) {
+		for( int32_t y = bandBegin; y < bandEnd; ++y ) {
+			T *line = channel->getData( 0, y );
+			for( int32_t x = 0; x < width; ++x )
+				line[x * inc] = lookup[binner( line[x * inc] )];
+		}
+	} );
+}
+
+// Clips \a counts to \a limit and redistributes the excess evenly over all bins, as in Zuiderveld's CLAHE
+void clipHistogram( uint32_t *counts, int numBins, uint32_t limit )
+{
+	uint64_t excess = 0;
+	for( int b = 0; b < numBins; ++b ) {
+		if( counts[b] > limit ) {
+			excess += counts[b] - limit;
+			counts[b] = limit;
+		}
+	}
+
+	const uint32_t perBin = (uint32_t)( excess / numBins );
+	uint32_t residual = (uint32_t)( excess - (uint64_t)perBin * numBins );
+	for( int b = 0; b < numBins; ++b )
+		counts[b] += perBin;
+	if( residual ) {
+		const int step = std::max<int>( numBins / residual, 1 );
+		for( int b = 0; b < numBins && residual > 0; b += step, --residual )
+			counts[b]++;
+	}
+}
+
+// Returns for each column or row the two nearest tiles and the weight of the second, interpolating between tile centers
+void getClaheWeights( int32_t size, int32_t numTiles, std::vector<int32_t> *tile1, std::vector<int32_t> *tile2, std::vector<float> *weight2 )
+{
+	tile1->resize( size );
+	tile2->resize( size );
+	weight2->resize( size );
+	const float tileSize = size / (float)numTiles;
+	for( int32_t i = 0; i < size; ++i ) {
+		const float f = ( i + 0.5f ) / tileSize - 0.5f;
+		const int32_t t = (int32_t)std::floor( f );
+		(*tile1)[i] = constrain<int32_t>( t, 0, numTiles - 1 );
+		(*tile2)[i] = constrain<int32_t>( t + 1, 0, numTiles - 1 );
+		(*weight2)[i] = f - t;
+	}
+}
+
+} // anonymous namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Statistics
+
+template<typename T>
+StatisticsT<T> statistics( const ChannelT<T> &channel, const Area &srcArea, int numThreads )
+{
+	const Area area = srcArea.getClipBy( channel.getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return StatisticsT<T>();
+
+	// channels of interleaved pixels are read as rows of all of their pixels' values, keeping only the first lane
+	const uint8_t inc = channel.getIncrement();
+	const size_t numValues = ( area.getWidth() - 1 ) * inc + 1;
+	return accumulateStatistics( channel.getData( area.getUL() ), channel.getRowBytes(), area, numValues, inc, numThreads ).getStatistics( 0 );
+}
+
+template<typename T>
+StatisticsT<T> statistics( const ChannelT<T> &channel, int numThreads )
+{
+	return statistics( channel, channel.getBounds(), numThreads );
+}
+
+template<typename T>
+SurfaceStatisticsT<T> statistics( const SurfaceT<T> &surface, const Area &srcArea, int numThreads )
+{
+	const Area area = srcArea.getClipBy( surface.getBounds() );
+	const uint8_t inc = surface.getPixelInc();
+	StatisticsAccumulator<T> acc;
+	if( area.getWidth() > 0 && area.getHeight() > 0 )
+		acc = accumulateStatistics( surface.getData( area.getUL() ), surface.getRowBytes(), area, area.getWidth() * inc, inc, numThreads );
+
+	SurfaceStatisticsT<T> result;
+	result.mRed = acc.getStatistics( surface.getRedOffset() );
+	result.mGreen = acc.getStatistics( surface.getGreenOffset() );
+	result.mBlue = acc.getStatistics( surface.getBlueOffset() );
+	if( surface.hasAlpha() )
+		result.mAlpha = acc.getStatistics( surface.getAlphaOffset() );
+	return result;
+}
+
+template<typename T>
+SurfaceStatisticsT<T> statistics( const SurfaceT<T> &surface, int numThreads )
+{
+	return statistics( surface, surface.getBounds(), numThreads );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Histograms
+
+template<typename T>
+std::vector<uint32_t> histogram( const ChannelT<T> &channel, const Area &area, int numBins, float minValue, float maxValue, int numThreads )
+{
+	return histogramImpl( channel, area, HistogramBinner<T>( numBins, minValue, maxValue ), numThreads );
+}
+
+template<typename T>
+std::vector<uint32_t> histogram( const ChannelT<T> &channel, int numBins, int numThreads )
+{
+	return histogramImpl( channel, channel.getBounds(), HistogramBinner<T>( numBins, 0, getHistogramMax<T>() ), numThreads );
+}
+
+template<typename T>
+void histogram( const SurfaceT<T> &surface, const Area &srcArea, int numBins, float minValue, float maxValue,
+				std::vector<uint32_t> *red, std::vector<uint32_t> *green, std::vector<uint32_t> *blue, std::vector<uint32_t> *alpha, int numThreads )
+{
+	const HistogramBinner<T> binner( numBins, minValue, maxValue );
+	numBins = binner.getNumBins();
+	if( ! surface.hasAlpha() )
+		alpha = nullptr;
+
+	// outputs are gathered by channel offset so that each pixel's values are counted in memory order
+	std::vector<uint32_t> *outputs[4] = { nullptr, nullptr, nullptr, nullptr };
+	outputs[surface.getRedOffset()] = red;
+	outputs[surface.getGreenOffset()] = green;
+	outputs[surface.getBlueOffset()] = blue;
+	if( alpha )
+		outputs[surface.getAlphaOffset()] = alpha;
+	for( auto &output : outputs )
+		if( output )
+			output->assign( numBins, 0 );
+
+	const Area area = srcArea.getClipBy( surface.getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
+	const uint8_t inc = surface.getPixelInc();
+	std::mutex mutex;
+	parallelForRows( area.y1, area.y2, numThreads, [&]( int32_t bandBegin, int32_t bandEnd ) {
+		std::vector<uint32_t> counts( numBins * inc, 0 );
+		for( int32_t y = bandBegin; y < bandEnd; ++y ) {
+			const T *line = surface.getData( ivec2( area.x1, y ) );
+			if( inc == 4 )
+				histogramPixels<4>( line, area.getWidth(), binner, counts.data() );
+			else
+				histogramPixels<3>( line, area.getWidth(), binner, counts.data() );
+		}
+		std::lock_guard<std::mutex> lock( mutex );
+		for( uint8_t c = 0; c < inc; ++c )
+			if( outputs[c] )
+				for( int b = 0; b < numBins; ++b )
+					(*outputs[c])[b] += counts[c * numBins + b];
+	} );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Equalization
+
+template<typename T>
+void equalizeHistogram( ChannelT<T> *channel, int numThreads )
+{
+	const HistogramBinner<T> binner( EqualizationBins<T>::GLOBAL, 0, getHistogramMax<T>() );
+	const std::vector<uint32_t> counts = histogramImpl( *channel, channel->getBounds(), binner, numThreads );
+
+	// maps the lowest occupied bin to 0 and the highest to the maximum
+	const int numBins = binner.getNumBins();
+	const uint64_t numValues = (uint64_t)channel->getWidth() * channel->getHeight();
+	uint64_t firstCount = 0;
+	for( int b = 0; b < numBins && ! firstCount; ++b )
+		firstCount = counts[b];
+	if( numValues == firstCount ) // constant or empty
+		return;
+
+	std::vector<T> lookup( numBins );
+	uint64_t cumulative = 0;
+	for( int b = 0; b < numBins; ++b ) {
+		cumulative += counts[b];
+		const float normalized = ( cumulative > firstCount ) ? (float)( (double)( cumulative - firstCount ) / ( numValues - firstCount ) ) : 0.0f;
+		lookup[b] = fromNormalized<T>( normalized );
+	}
+	applyLookup( channel, binner, lookup, numThreads );
+}
+
+template<typename T>
+void equalizeHistogram( SurfaceT<T> *surface, int numThreads )
+{
+	equalizeHistogram( &surface->getChannelRed(), numThreads );
+	equalizeHistogram( &surface->getChannelGreen(), numThreads );
+	equalizeHistogram( &surface->getChannelBlue(), numThreads );
+}
+
+template<typename T>
+void equalizeHistogramClahe( ChannelT<T> *channel, const ivec2 &numTilesXY, float clipLimit, int numThreads )
+{
+	const int32_t width = channel->getWidth(), height = channel->getHeight();
+	if( width <= 0 || height <= 0 )
+		return;
+
+	const int32_t tilesX = constrain<int32_t>( numTilesXY.x, 1, width ), tilesY = constrain<int32_t>( numTilesXY.y, 1, height );
+	const HistogramBinner<T> binner( EqualizationBins<T>::TILE, 0, getHistogramMax<T>() );
+	const int numBins = binner.getNumBins();
+
+	// a normalized mapping per tile, computed in parallel over tiles
+	std::vector<float> mappings( (size_t)tilesX * tilesY * numBins );
+	parallelForRows( 0, tilesX * tilesY, numThreads, [&]( int32_t tileBegin, int32_t tileEnd ) {
+		std::vector<uint32_t> counts( numBins * 4 );
+		for( int32_t tile = tileBegin; tile < tileEnd; ++tile ) {
+			const int32_t tileX = tile % tilesX, tileY = tile / tilesX;
+			const Area tileArea( tileX * width / tilesX, tileY * height / tilesY, ( tileX + 1 ) * width / tilesX, ( tileY + 1 ) * height / tilesY );
+			std::fill( counts.begin(), counts.end(), 0 );
+			histogramRows( *channel, tileArea, tileArea.y1, tileArea.y2, binner, counts.data() );
+			for( int b = 0; b < numBins; ++b )
+				counts[b] += counts[b + numBins] + counts[b + numBins * 2] + counts[b + numBins * 3];
+
+			const uint32_t numValues = (uint32_t)tileArea.calcArea();
+			if( clipLimit > 0 )
+				clipHistogram( counts.data(), numBins, std::max<uint32_t>( (uint32_t)( clipLimit * numValues / numBins ), 1 ) );
+
+			float *mapping = &mappings[(size_t)tile * numBins];
+			uint32_t cumulative = 0;
+			for( int b = 0; b < numBins; ++b ) {
+				cumulative += counts[b];
+				mapping[b] = cumulative / (float)numValues;
+			}
+		}
+	}, 1 );
+
+	// each pixel interpolates bilinearly between the mappings of the four nearest tile centers
+	std::vector<int32_t> tileX1, tileX2, tileY1, tileY2;
+	std::vector<float> weightX2, weightY2;
+	getClaheWeights( width, tilesX, &tileX1, &tileX2, &weightX2 );
+	getClaheWeights( height, tilesY, &tileY1, &tileY2, &weightY2 );
+	const uint8_t inc = channel->getIncrement();
+	parallelForRows( 0, height, numThreads, [&]( int32_t bandBegin, int32_t bandEnd ) {
+		for( int32_t y = bandBegin; y < bandEnd; ++y ) {
+			const float *row1 = &mappings[(size_t)tileY1[y] * tilesX * numBins];
+			const float *row2 = &mappings[(size_t)tileY2[y] * tilesX * numBins];
+			const float wy = weightY2[y];
+			T *line = channel->getData( 0, y );
+			for( int32_t x = 0; x < width; ++x ) {
+				const uint32_t bin = binner( line[x * inc] );
+				const size_t t1 = (size_t)tileX1[x] * numBins + bin, t2 = (size_t)tileX2[x] * numBins + bin;
+				const float wx = weightX2[x];
+				const float top = row1[t1] + ( row1[t2] - row1[t1] ) * wx;
+				const float bottom = row2[t1] + ( row2[t2] - row2[t1] ) * wx;
+				line[x * inc] = fromNormalized<T>( top + ( bottom - top ) * wy );
+			}
+		}
+	} );
+}
+
+template<typename T>
+void equalizeHistogramClahe( SurfaceT<T> *surface, const ivec2 &numTiles, float clipLimit, int numThreads )
+{
+	equalizeHistogramClahe( &surface->getChannelRed(), numTiles, clipLimit, numThreads );
+	equalizeHistogramClahe( &surface->getChannelGreen(), numTiles, clipLimit, numThreads );
+	equalizeHistogramClahe( &surface->getChannelBlue(), numTiles, clipLimit, numThreads );
+}
+
+#define histogram_PROTOTYPES(r,data,T)\
+	template StatisticsT<T> statistics( const ChannelT<T> &channel, const Area &area, int numThreads ); \
+	template StatisticsT<T> statistics( const ChannelT<T> &channel, int numThreads ); \
+	template SurfaceStatisticsT<T> statistics( const SurfaceT<T> &surface, const Area &area, int numThreads ); \
+	template SurfaceStatisticsT<T> statistics( const SurfaceT<T> &surface, int numThreads ); \
+	template std::vector<uint32_t> histogram( const ChannelT<T> &channel, const Area &area, int numBins, float minValue, float maxValue, int numThreads ); \
+	template std::vector<uint32_t> histogram( const ChannelT<T> &channel, int numBins, int numThreads ); \
+	template void histogram( const SurfaceT<T> &surface, const Area &area, int numBins, float minValue, float maxValue, \
+								std::vector<uint32_t> *red, std::vector<uint32_t> *green, std::vector<uint32_t> *blue, std::vector<uint32_t> *alpha, int numThreads ); \
+	template void equalizeHistogram( ChannelT<T> *channel, int numThreads ); \
+	template void equalizeHistogram( SurfaceT<T> *surface, int numThreads ); \
+	template void equalizeHistogramClahe( ChannelT<T> *channel, const ivec2 &numTiles, float clipLimit, int numThreads ); \
+	template void equalizeHistogramClahe( SurfaceT<T> *surface, const ivec2 &numTiles, float clipLimit, int numThreads );
+
+BOOST_PP_SEQ_FOR_EACH( histogram_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+
+} } // namespace cinder::ip
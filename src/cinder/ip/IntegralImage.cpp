@@ -0,0 +1,255 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/IntegralImage.h"
+#include "cinder/ip/Parallel.h"
+
+#include <algorithm>
+#include <limits>
+#include <boost/preprocessor/seq.hpp>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// the vertical accumulation pass is split into bands of columns no narrower than this
+const int32_t INTEGRAL_MIN_COLUMNS_PER_BAND = 256;
+
+template<typename SUMT>
+void accumulateColumns( SUMT *table, int32_t rowStride, int32_t height, int numThreads )
+{
+	parallelForRows( 1, rowStride, numThreads, [=]( int32_t colBegin, int32_t colEnd ) {
+		for( int32_t y = 2; y <= height; ++y ) {
+			const SUMT *above = table + ( y - 1 ) * rowStride;
+			SUMT *row = table + y * rowStride;
+			for( int32_t x = colBegin; x < colEnd; ++x )
+				row[x] += above[x];
+		}
+	}, INTEGRAL_MIN_COLUMNS_PER_BAND );
+}
+
+template<typename T, bool INTEGRAL = std::numeric_limits<T>::is_integer>
+struct IntegralMean {
+	template<typename SUMT>
+	static T	get( SUMT sum, int32_t count ) { return static_cast<T>( ( sum + static_cast<SUMT>( count / 2 ) ) / static_cast<SUMT>( count ) ); }
+};
+
+template<typename T>
+struct IntegralMean<T,false> {
+	template<typename SUMT>
+	static T	get( SUMT sum, int32_t count ) { return static_cast<T>( sum / count ); }
+};
+
+// calls fn( dstPtr, x1, y1, x2, y2 ) for each pixel of dstChannel with the windowSize x windowSize window centered on it, clipped to the bounds
+template<typename T, typename DSTT, typename FN>
+void forEachWindow( const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<DSTT> *dstChannel, int numThreads, const FN &fn )
+{
+	const int32_t width = std::min( integralImage.getWidth(), dstChannel->getWidth() );
+	const int32_t height = std::min( integralImage.getHeight(), dstChannel->getHeight() );
+	const int32_t halfWindow = std::max<int32_t>( windowSize, 1 ) / 2;
+	const int32_t size = std::max<int32_t>( windowSize, 1 );
+	const uint8_t dstInc = dstChannel->getIncrement();
+
+	parallelForRows( 0, height, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		for( int32_t y = rowBegin; y < rowEnd; ++y ) {
+			const int32_t y1 = std::max<int32_t>( y - halfWindow, 0 );
+			const int32_t y2 = std::min<int32_t>( y - halfWindow + size, integralImage.getHeight() );
+			DSTT *dst = dstChannel->getData( 0, y );
+			for( int32_t x = 0; x < width; ++x ) {
+				const int32_t x1 = std::max<int32_t>( x - halfWindow, 0 );
+				const int32_t x2 = std::min<int32_t>( x - halfWindow + size, integralImage.getWidth() );
+				fn( dst, x1, y1, x2, y2 );
+				dst += dstInc;
+			}
+		}
+	} );
+}
+
+} // anonymous namespace
+
+template<typename T>
+IntegralImageT<T>::IntegralImageT( const ChannelT<T> &channel, bool squaredSums, int numThreads )
+	: mWidth( 0 ), mHeight( 0 ), mHasSquaredSums( false )
+{
+	update( channel, squaredSums, numThreads );
+}
+
+template<typename T>
+void IntegralImageT<T>::update( const ChannelT<T> &channel, bool squaredSums, int numThreads )
+{
+	mWidth = channel.getWidth();
+	mHeight = channel.getHeight();
+	mHasSquaredSums = squaredSums;
+
+	const int32_t rowStride = getRowStride();
+	const size_t tableSize = (size_t)rowStride * ( mHeight + 1 );
+	mSums.resize( tableSize );
+	std::fill( mSums.begin(), mSums.begin() + rowStride, SumT( 0 ) );
+	if( squaredSums ) {
+		mSquaredSums.resize( tableSize );
+		std::fill( mSquaredSums.begin(), mSquaredSums.begin() + rowStride, SquaredSumT( 0 ) );
+	}
+	else
+		mSquaredSums.clear();
+
+	const uint8_t srcInc = channel.getIncrement();
+	SumT *sums = mSums.data();
+	SquaredSumT *squared = mSquaredSums.data();
+
+	if( getNumThreads( numThreads ) <= 1 ) {
+		// single pass: each entry is the running sum of its row plus the entry above it
+		for( int32_t y = 0; y < mHeight; ++y ) {
+			const T *src = channel.getData( 0, y );
+			const SumT *above = sums + y * rowStride;
+			SumT *row = sums + ( y + 1 ) * rowStride;
+			SumT rowSum = 0;
+			row[0] = 0;
+			for( int32_t x = 0; x < mWidth; ++x, src += srcInc ) {
+				rowSum += *src;
+				row[x + 1] = above[x + 1] + rowSum;
+			}
+			if( squaredSums ) {
+				src = channel.getData( 0, y );
+				const SquaredSumT *squaredAbove = squared + y * rowStride;
+				SquaredSumT *squaredRow = squared + ( y + 1 ) * rowStride;
+				SquaredSumT squaredRowSum = 0;
+				squaredRow[0] = 0;
+				for( int32_t x = 0; x < mWidth; ++x, src += srcInc ) {
+					squaredRowSum += static_cast<SquaredSumT>( *src ) * static_cast<SquaredSumT>( *src );
+					squaredRow[x + 1] = squaredAbove[x + 1] + squaredRowSum;
+				}
+			}
+		}
+		return;
+	}
+
+	// two passes: the rows' prefix sums are independent of each other, and so are the columns' once the rows are done
+	parallelForRows( 0, mHeight, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		for( int32_t y = rowBegin; y < rowEnd; ++y ) {
+			const T *src = channel.getData( 0, y );
+			SumT *row = sums + ( y + 1 ) * rowStride;
+			SumT rowSum = 0;
+			row[0] = 0;
+			for( int32_t x = 0; x < mWidth; ++x, src += srcInc ) {
+				rowSum += *src;
+				row[x + 1] = rowSum;
+			}
+			if( squaredSums ) {
+				src = channel.getData( 0, y );
+				SquaredSumT *squaredRow = squared + ( y + 1 ) * rowStride;
+				SquaredSumT squaredRowSum = 0;
+				squaredRow[0] = 0;
+				for( int32_t x = 0; x < mWidth; ++x, src += srcInc ) {
+					squaredRowSum += static_cast<SquaredSumT>( *src ) * static_cast<SquaredSumT>( *src );
+					squaredRow[x + 1] = squaredRowSum;
+				}
+			}
+		}
+	} );
+
+	accumulateColumns( sums, rowStride, mHeight, numThreads );
+	if( squaredSums )
+		accumulateColumns( squared, rowStride, mHeight, numThreads );
+}
+
+template<typename T>
+typename IntegralImageT<T>::SumT IntegralImageT<T>::getSum( const Area &area ) const
+{
+	const Area clipped = area.getClipBy( getBounds() );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return SumT( 0 );
+	return getSum( clipped.x1, clipped.y1, clipped.x2, clipped.y2 );
+}
+
+template<typename T>
+typename IntegralImageT<T>::SquaredSumT IntegralImageT<T>::getSquaredSum( const Area &area ) const
+{
+	const Area clipped = area.getClipBy( getBounds() );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return SquaredSumT( 0 );
+	return getSquaredSum( clipped.x1, clipped.y1, clipped.x2, clipped.y2 );
+}
+
+template<typename T>
+double IntegralImageT<T>::getMean( const Area &area ) const
+{
+	const Area clipped = area.getClipBy( getBounds() );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return 0;
+	return static_cast<double>( getSum( clipped.x1, clipped.y1, clipped.x2, clipped.y2 ) ) / clipped.calcArea();
+}
+
+template<typename T>
+double IntegralImageT<T>::getVariance( const Area &area ) const
+{
+	const Area clipped = area.getClipBy( getBounds() );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 )
+		return 0;
+	const double count = clipped.calcArea();
+	const double mean = static_cast<double>( getSum( clipped.x1, clipped.y1, clipped.x2, clipped.y2 ) ) / count;
+	const double meanOfSquares = static_cast<double>( getSquaredSum( clipped.x1, clipped.y1, clipped.x2, clipped.y2 ) ) / count;
+	return std::max( meanOfSquares - mean * mean, 0.0 );
+}
+
+template<typename T>
+void boxBlur( const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<T> *dstChannel, int numThreads )
+{
+	typedef typename IntegralImageT<T>::SumT SUMT;
+	forEachWindow( integralImage, windowSize, dstChannel, numThreads, [&]( T *dst, int32_t x1, int32_t y1, int32_t x2, int32_t y2 ) {
+		const SUMT sum = integralImage.getSum( x1, y1, x2, y2 );
+		*dst = IntegralMean<T>::get( sum, ( x2 - x1 ) * ( y2 - y1 ) );
+	} );
+}
+
+template<typename T>
+void localMean( const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<float> *dstChannel, int numThreads )
+{
+	forEachWindow( integralImage, windowSize, dstChannel, numThreads, [&]( float *dst, int32_t x1, int32_t y1, int32_t x2, int32_t y2 ) {
+		const double count = ( x2 - x1 ) * ( y2 - y1 );
+		*dst = static_cast<float>( integralImage.getSum( x1, y1, x2, y2 ) / count );
+	} );
+}
+
+template<typename T>
+void localVariance( const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<float> *dstChannel, int numThreads )
+{
+	forEachWindow( integralImage, windowSize, dstChannel, numThreads, [&]( float *dst, int32_t x1, int32_t y1, int32_t x2, int32_t y2 ) {
+		const double count = ( x2 - x1 ) * ( y2 - y1 );
+		const double mean = integralImage.getSum( x1, y1, x2, y2 ) / count;
+		const double meanOfSquares = integralImage.getSquaredSum( x1, y1, x2, y2 ) / count;
+		*dst = static_cast<float>( std::max( meanOfSquares - mean * mean, 0.0 ) );
+	} );
+}
+
+template class IntegralImageT<uint8_t>;
+template class IntegralImageT<uint16_t>;
+template class IntegralImageT<float>;
+
+#define integralImage_PROTOTYPES(r,data,T)\
+	template void boxBlur( const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<T> *dstChannel, int numThreads ); \
+	template void localMean( const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<float> *dstChannel, int numThreads ); \
+	template void localVariance( const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<float> *dstChannel, int numThreads );
+
+BOOST_PP_SEQ_FOR_EACH( integralImage_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+
+} } // namespace cinder::ip
@@ -0,0 +1,396 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Morphology.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/PixelAllocator.h"
+
+#include <boost/preprocessor/seq.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// The vertical pass works on strips of this many bytes across the image, so that the two blocks of rows it keeps stay in cache
+const int32_t MORPHOLOGY_STRIP_BYTES = 2048;
+
+// Erosion is a running minimum, padded with the largest value, and dilation a running maximum, padded with the smallest
+template<typename T, bool ERODE>
+struct MorphologyOp {
+	static T	identity()				{ return ERODE ? ( std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max() )
+											: ( std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest() ); }
+	static T	apply( T a, T b )		{ return ERODE ? std::min( a, b ) : std::max( a, b ); }
+};
+
+#if defined( CINDER_SIMD_SSE2 )
+
+struct MorphologyOpsSse2_8u {
+	typedef __m128i		V;
+	static const int LANES = 16;
+	void load( V &v, const uint8_t *p ) const					{ v = _mm_loadu_si128( (const __m128i*)p ); }
+	void store( uint8_t *p, const V &v ) const					{ _mm_storeu_si128( (__m128i*)p, v ); }
+	void min( V &r, const V &a, const V &b ) const				{ r = _mm_min_epu8( a, b ); }
+	void max( V &r, const V &a, const V &b ) const				{ r = _mm_max_epu8( a, b ); }
+};
+
+// SSE2 has no unsigned 16-bit min and max, which are built from a saturating subtraction
+struct MorphologyOpsSse2_16u {
+	typedef __m128i		V;
+	static const int LANES = 8;
+	void load( V &v, const uint16_t *p ) const					{ v = _mm_loadu_si128( (const __m128i*)p ); }
+	void store( uint16_t *p, const V &v ) const					{ _mm_storeu_si128( (__m128i*)p, v ); }
+	void min( V &r, const V &a, const V &b ) const				{ r = _mm_sub_epi16( a, _mm_subs_epu16( a, b ) ); }
+	void max( V &r, const V &a, const V &b ) const				{ r = _mm_add_epi16( b, _mm_subs_epu16( a, b ) ); }
+};
+
+struct MorphologyOpsSse2_32f {
+	typedef __m128		V;
+	static const int LANES = 4;
+	void load( V &v, const float *p ) const						{ v = _mm_loadu_ps( p ); }
+	void store( float *p, const V &v ) const					{ _mm_storeu_ps( p, v ); }
+	void min( V &r, const V &a, const V &b ) const				{ r = _mm_min_ps( a, b ); }
+	void max( V &r, const V &a, const V &b ) const				{ r = _mm_max_ps( a, b ); }
+};
+
+struct MorphologyOpsAvx2_8u {
+	typedef __m256i		V;
+	static const int LANES = 32;
+	CINDER_SIMD_TARGET_AVX2 void load( V &v, const uint8_t *p ) const		{ v = _mm256_loadu_si256( (const __m256i*)p ); }
+	CINDER_SIMD_TARGET_AVX2 void store( uint8_t *p, const V &v ) const		{ _mm256_storeu_si256( (__m256i*)p, v ); }
+	CINDER_SIMD_TARGET_AVX2 void min( V &r, const V &a, const V &b ) const	{ r = _mm256_min_epu8( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void max( V &r, const V &a, const V &b ) const	{ r = _mm256_max_epu8( a, b ); }
+};
+
+struct MorphologyOpsAvx2_16u {
+	typedef __m256i		V;
+	static const int LANES = 16;
+	CINDER_SIMD_TARGET_AVX2 void load( V &v, const uint16_t *p ) const		{ v = _mm256_loadu_si256( (const __m256i*)p ); }
+	CINDER_SIMD_TARGET_AVX2 void store( uint16_t *p, const V &v ) const		{ _mm256_storeu_si256( (__m256i*)p, v ); }
+	CINDER_SIMD_TARGET_AVX2 void min( V &r, const V &a, const V &b ) const	{ r = _mm256_min_epu16( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void max( V &r, const V &a, const V &b ) const	{ r = _mm256_max_epu16( a, b ); }
+};
+
+struct MorphologyOpsAvx2_32f {
+	typedef __m256		V;
+	static const int LANES = 8;
+	CINDER_SIMD_TARGET_AVX2 void load( V &v, const float *p ) const			{ v = _mm256_loadu_ps( p ); }
+	CINDER_SIMD_TARGET_AVX2 void store( float *p, const V &v ) const		{ _mm256_storeu_ps( p, v ); }
+	CINDER_SIMD_TARGET_AVX2 void min( V &r, const V &a, const V &b ) const	{ r = _mm256_min_ps( a, b ); }
+	CINDER_SIMD_TARGET_AVX2 void max( V &r, const V &a, const V &b ) const	{ r = _mm256_max_ps( a, b ); }
+};
+
+template<typename T> struct MorphologySimd;
+template<> struct MorphologySimd<uint8_t> {
+	typedef MorphologyOpsSse2_8u	Sse2Ops;
+	typedef MorphologyOpsAvx2_8u	Avx2Ops;
+};
+template<> struct MorphologySimd<uint16_t> {
+	typedef MorphologyOpsSse2_16u	Sse2Ops;
+	typedef MorphologyOpsAvx2_16u	Avx2Ops;
+};
+template<> struct MorphologySimd<float> {
+	typedef MorphologyOpsSse2_32f	Sse2Ops;
+	typedef MorphologyOpsAvx2_32f	Avx2Ops;
+};
+
+// Returns the number of leading elements of out = op( a, b ) it computed
+template<bool ERODE, typename OPS, typename T>
+CINDER_SIMD_FORCEINLINE int32_t combineRowSimd( const OPS &ops, const T *a, const T *b, T *out, int32_t count )
+{
+	typename OPS::V va, vb;
+	int32_t i = 0;
+	for( ; i + OPS::LANES <= count; i += OPS::LANES ) {
+		ops.load( va, a + i );
+		ops.load( vb, b + i );
+		if( ERODE )
+			ops.min( va, va, vb );
+		else
+			ops.max( va, va, vb );
+		ops.store( out + i, va );
+	}
+	return i;
+}
+
+template<bool ERODE, typename T>
+int32_t combineRowSse2( const T *a, const T *b, T *out, int32_t count )
+{
+	return combineRowSimd<ERODE>( typename MorphologySimd<T>::Sse2Ops(), a, b, out, count );
+}
+
+template<bool ERODE, typename T>
+CINDER_SIMD_TARGET_AVX2 int32_t combineRowAvx2( const T *a, const T *b, T *out, int32_t count )
+{
+	return combineRowSimd<ERODE>( typename MorphologySimd<T>::Avx2Ops(), a, b, out, count );
+}
+
+#endif // defined( CINDER_SIMD_SSE2 )
+
+// out = op( a, b ) elementwise; \a out may be \a a or \a b
+template<typename T, bool ERODE>
+void combineRow( const T *a, const T *b, T *out, int32_t count, simd::Level level )
+{
+	int32_t i = 0;
+#if defined( CINDER_SIMD_SSE2 )
+	if( level == simd::Level::AVX2 )
+		i = combineRowAvx2<ERODE>( a, b, out, count );
+	else if( level == simd::Level::SSE2 )
+		i = combineRowSse2<ERODE>( a, b, out, count );
+#endif
+	for( ; i < count; ++i )
+		out[i] = MorphologyOp<T,ERODE>::apply( a[i], b[i] );
+}
+
+// Source rows of the vertical pass, where rows outside the image read as the identity
+template<typename T>
+struct MorphologyPlane {
+	const T* row( int32_t y, int32_t column ) const		{ return ( y >= 0 && y < mHeight ) ? ( mData + (size_t)y * mWidth + column ) : mIdentityRow; }
+
+	const T		*mData;
+	int32_t		mWidth, mHeight;
+	const T		*mIdentityRow;
+};
+
+// van Herk / Gil-Werman along a row: the padded row is split into blocks as long as the window, and every window spans the end of one block
+// and the start of the next, so it is op( suffix of the first, prefix of the second ). That costs three ops per value whatever the radius.
+template<typename T, bool ERODE>
+void morphologyRowHorizontal( const T *src, uint8_t srcInc, int32_t width, int32_t radius, T *line, T *prefix, T *suffix, T *out, simd::Level level )
+{
+	typedef MorphologyOp<T,ERODE> Op;
+	const int32_t window = 2 * radius + 1;
+	const int32_t length = ( width + 2 * radius + window - 1 ) / window * window;
+
+	std::fill( line, line + radius, Op::identity() );
+	for( int32_t x = 0; x < width; ++x )
+		line[radius + x] = src[x * srcInc];
+	std::fill( line + radius + width, line + length, Op::identity() );
+
+	for( int32_t begin = 0; begin < length; begin += window ) {
+		const int32_t end = begin + window - 1;
+		prefix[begin] = line[begin];
+		for( int32_t i = begin + 1; i <= end; ++i )
+			prefix[i] = Op::apply( prefix[i - 1], line[i] );
+		suffix[end] = line[end];
+		for( int32_t i = end - 1; i >= begin; --i )
+			suffix[i] = Op::apply( suffix[i + 1], line[i] );
+	}
+
+	// the window of out[x] is line[x, x + window - 1]
+	combineRow<T,ERODE>( suffix, prefix + window - 1, out, width, level );
+}
+
+// The same algorithm down the columns of \a plane, for the output rows [\a rowBegin, \a rowEnd). Each step is an elementwise op between whole rows
+// of a strip, so it vectorizes directly, and only one block of suffixes and one of prefixes are kept. When \a other is non-null it is combined into the result.
+template<typename T, bool ERODE>
+void morphologyVertical( const MorphologyPlane<T> &plane, const T *other, int32_t radius, int32_t rowBegin, int32_t rowEnd,
+							T *dst, ptrdiff_t dstRowInc, uint8_t dstInc, simd::Level level )
+{
+	const int32_t window = 2 * radius + 1;
+	const int32_t stripSize = std::max<int32_t>( MORPHOLOGY_STRIP_BYTES / sizeof(T), 1 );
+	std::vector<T> blocks( 2 * window * std::min( stripSize, plane.mWidth ) + std::min( stripSize, plane.mWidth ) );
+
+	for( int32_t column = 0; column < plane.mWidth; column += stripSize ) {
+		const int32_t size = std::min( stripSize, plane.mWidth - column );
+		T *suffix = blocks.data(), *prefix = suffix + window * size, *result = prefix + window * size;
+		for( int32_t blockOutput = rowBegin; blockOutput < rowEnd; blockOutput += window ) {
+			// the windows of the rows [blockOutput, blockOutput + window) start in the block beginning at row blockOutput - radius
+			const int32_t blockBegin = blockOutput - radius;
+			const int32_t numOutputs = std::min( window, rowEnd - blockOutput );
+			memcpy( suffix + ( window - 1 ) * size, plane.row( blockBegin + window - 1, column ), size * sizeof(T) );
+			for( int32_t i = window - 2; i >= 0; --i )
+				combineRow<T,ERODE>( suffix + ( i + 1 ) * size, plane.row( blockBegin + i, column ), suffix + i * size, size, level );
+			if( numOutputs > 1 ) {
+				memcpy( prefix, plane.row( blockBegin + window, column ), size * sizeof(T) );
+				for( int32_t i = 1; i < numOutputs - 1; ++i )
+					combineRow<T,ERODE>( prefix + ( i - 1 ) * size, plane.row( blockBegin + window + i, column ), prefix + i * size, size, level );
+			}
+
+			for( int32_t i = 0; i < numOutputs; ++i ) {
+				const int32_t y = blockOutput + i;
+				T *out = ( dstInc == 1 ) ? ( dst + y * dstRowInc + column ) : result;
+				// the window of row y is [blockBegin + i, blockBegin + i + window - 1], the whole block when i is 0
+				if( i == 0 )
+					memcpy( out, suffix, size * sizeof(T) );
+				else
+					combineRow<T,ERODE>( suffix + i * size, prefix + ( i - 1 ) * size, out, size, level );
+				if( other )
+					combineRow<T,ERODE>( out, other + (size_t)y * plane.mWidth + column, out, size, level );
+				if( dstInc != 1 ) {
+					T *d = dst + y * dstRowInc + column * dstInc;
+					for( int32_t x = 0; x < size; ++x )
+						d[x * dstInc] = result[x];
+				}
+			}
+		}
+	}
+}
+
+template<typename T, bool ERODE>
+void morphology( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element, int numThreads )
+{
+	const int32_t width = std::min( srcChannel.getWidth(), dstChannel->getWidth() );
+	const int32_t height = std::min( srcChannel.getHeight(), dstChannel->getHeight() );
+	if( width <= 0 || height <= 0 )
+		return;
+
+	const int32_t radiusX = std::max( radius.x, 0 ), radiusY = std::max( radius.y, 0 );
+	const bool cross = element == StructuringElement::CROSS;
+	const simd::Level level = simd::getLevel();
+	const ptrdiff_t srcRowInc = srcChannel.getRowBytes() / sizeof(T);
+	const uint8_t srcInc = srcChannel.getIncrement();
+	const T *srcData = srcChannel.getData();
+
+	// the horizontal pass fills a contiguous plane, so the vertical pass runs over whole rows. A cross also needs a contiguous copy of the source to erode vertically,
+	// which makes writing back into the source safe; the vertical pass then combines the two. Both are frame-sized, so a PixelPool can recycle them.
+	const size_t planeSize = (size_t)width * height;
+	std::shared_ptr<void> planeStore = PixelAllocator::get()->allocate( sizeof(T) * planeSize * ( cross ? 2 : 1 ) );
+	T *horizontal = static_cast<T*>( planeStore.get() );
+	T *source = cross ? horizontal + planeSize : nullptr;
+
+	parallelForRows( 0, height, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		const int32_t window = 2 * radiusX + 1;
+		const size_t length = ( width + 2 * radiusX + window - 1 ) / window * window;
+		std::vector<T> buffers( 3 * length );
+		for( int32_t y = rowBegin; y < rowEnd; ++y ) {
+			const T *src = srcData + y * srcRowInc;
+			morphologyRowHorizontal<T,ERODE>( src, srcInc, width, radiusX, buffers.data(), buffers.data() + length, buffers.data() + 2 * length, horizontal + (size_t)y * width, level );
+			if( source ) {
+				for( int32_t x = 0; x < width; ++x )
+					source[(size_t)y * width + x] = src[x * srcInc];
+			}
+		}
+	} );
+
+	const std::vector<T> identityRow( std::min<int32_t>( width, MORPHOLOGY_STRIP_BYTES / sizeof(T) ), MorphologyOp<T,ERODE>::identity() );
+	const MorphologyPlane<T> plane = { cross ? source : horizontal, width, height, identityRow.data() };
+	T *dstData = dstChannel->getData();
+	const ptrdiff_t dstRowInc = dstChannel->getRowBytes() / sizeof(T);
+	const uint8_t dstInc = dstChannel->getIncrement();
+	// bands shorter than the window would mostly recompute their neighbors' blocks
+	parallelForRows( 0, height, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		morphologyVertical<T,ERODE>( plane, cross ? horizontal : nullptr, radiusY, rowBegin, rowEnd, dstData, dstRowInc, dstInc, level );
+	}, std::max( 16, 2 * radiusY + 1 ) );
+}
+
+} // anonymous namespace
+
+template<typename T>
+void erode( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element, int numThreads )
+{
+	morphology<T,true>( srcChannel, dstChannel, radius, element, numThreads );
+}
+
+template<typename T>
+void erode( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element, int numThreads )
+{
+	morphology<T,true>( *channel, channel, radius, element, numThreads );
+}
+
+template<typename T>
+void dilate( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element, int numThreads )
+{
+	morphology<T,false>( srcChannel, dstChannel, radius, element, numThreads );
+}
+
+template<typename T>
+void dilate( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element, int numThreads )
+{
+	morphology<T,false>( *channel, channel, radius, element, numThreads );
+}
+
+template<typename T>
+void open( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element, int numThreads )
+{
+	morphology<T,true>( srcChannel, dstChannel, radius, element, numThreads );
+	morphology<T,false>( *dstChannel, dstChannel, radius, element, numThreads );
+}
+
+template<typename T>
+void open( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element, int numThreads )
+{
+	open( *channel, channel, radius, element, numThreads );
+}
+
+template<typename T>
+void close( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element, int numThreads )
+{
+	morphology<T,false>( srcChannel, dstChannel, radius, element, numThreads );
+	morphology<T,true>( *dstChannel, dstChannel, radius, element, numThreads );
+}
+
+template<typename T>
+void close( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element, int numThreads )
+{
+	close( *channel, channel, radius, element, numThreads );
+}
+
+template<typename T>
+void morphologicalGradient( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element, int numThreads )
+{
+	const int32_t width = std::min( srcChannel.getWidth(), dstChannel->getWidth() );
+	const int32_t height = std::min( srcChannel.getHeight(), dstChannel->getHeight() );
+	if( width <= 0 || height <= 0 )
+		return;
+
+	// the erosion is taken first, so that the dilation may overwrite the source
+	ChannelT<T> eroded( width, height );
+	morphology<T,true>( srcChannel, &eroded, radius, element, numThreads );
+	morphology<T,false>( srcChannel, dstChannel, radius, element, numThreads );
+
+	const ptrdiff_t dstRowInc = dstChannel->getRowBytes() / sizeof(T);
+	const uint8_t dstInc = dstChannel->getIncrement();
+	parallelForRows( 0, height, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		for( int32_t y = rowBegin; y < rowEnd; ++y ) {
+			T *dst = dstChannel->getData() + y * dstRowInc;
+			const T *e = eroded.getData( ivec2( 0, y ) );
+			for( int32_t x = 0; x < width; ++x )
+				dst[x * dstInc] -= e[x];
+		}
+	} );
+}
+
+template<typename T>
+void morphologicalGradient( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element, int numThreads )
+{
+	morphologicalGradient( *channel, channel, radius, element, numThreads );
+}
+
+#define morphology_PROTOTYPES(r,data,T)\
+	template void erode( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element, int numThreads );\
+	template void erode( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element, int numThreads );\
+	template void dilate( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element, int numThreads );\
+	template void dilate( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element, int numThreads );\
+	template void open( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element, int numThreads );\
+	template void open( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element, int numThreads );\
+	template void close( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element, int numThreads );\
+	template void close( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element, int numThreads );\
+	template void morphologicalGradient( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ivec2 &radius, StructuringElement element, int numThreads );\
+	template void morphologicalGradient( ChannelT<T> *channel, const ivec2 &radius, StructuringElement element, int numThreads );
+
+BOOST_PP_SEQ_FOR_EACH( morphology_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+
+} } // namespace cinder::ip
@@ -0,0 +1,83 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Parallel.h"
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cinder { namespace ip {
+
+int getNumThreads( int numThreads )
+{
+	if( numThreads > 0 )
+		return numThreads;
+
+	return std::max<int>( 1, (int)std::thread::hardware_concurrency() );
+}
+
+void parallelForRows( int32_t begin, int32_t end, int numThreads, const std::function<void( int32_t, int32_t )> &fn, int32_t minRowsPerBand )
+{
+	const int32_t numRows = end - begin;
+	if( numRows <= 0 )
+		return;
+
+	int32_t numBands = std::min<int32_t>( getNumThreads( numThreads ), numRows / std::max<int32_t>( 1, minRowsPerBand ) );
+	if( numBands <= 1 ) {
+		fn( begin, end );
+		return;
+	}
+
+	std::exception_ptr exc;
+	std::mutex excMutex;
+	auto runBand = [&]( int32_t band ) {
+		int32_t bandBegin = begin + (int32_t)( (int64_t)numRows * band / numBands );
+		int32_t bandEnd = begin + (int32_t)( (int64_t)numRows * ( band + 1 ) / numBands );
+		try {
+			fn( bandBegin, bandEnd );
+		}
+		catch( ... ) {
+			std::lock_guard<std::mutex> lock( excMutex );
+			if( ! exc )
+				exc = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve( numBands - 1 );
+	for( int32_t band = 1; band < numBands; ++band )
+		threads.emplace_back( runBand, band );
+
+	runBand( 0 );
+
+	for( auto &thread : threads )
+		thread.join();
+
+	if( exc )
+		std::rethrow_exception( exc );
+}
+
+} } // namespace cinder::ip
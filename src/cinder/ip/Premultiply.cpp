@@ -22,72 +22,261 @@
 
 #include "cinder/ip/Premultiply.h"
 #include "cinder/ChanTraits.h"
+#include "cinder/CinderSimd.h"
 
 #include <boost/preprocessor/seq.hpp>
 #include <algorithm>
 
 namespace cinder { namespace ip {
 
-// this is a candidate for sse2
+namespace {
+
 template<typename T>
-void premultiply( SurfaceT<T> *surface )
+void premultiplyRow( T *dstPtr, uint8_t pixelInc, uint8_t redOffset, uint8_t greenOffset, uint8_t blueOffset, uint8_t alphaOffset, int32_t width )
 {
-	const Area clippedArea = surface->getBounds();
+	for( int32_t x = 0; x < width; ++x ) {
+		T alpha = dstPtr[alphaOffset];
+		dstPtr[redOffset] = CHANTRAIT<T>::premultiply( dstPtr[redOffset], alpha );
+		dstPtr[greenOffset] = CHANTRAIT<T>::premultiply( dstPtr[greenOffset], alpha );
+		dstPtr[blueOffset] = CHANTRAIT<T>::premultiply( dstPtr[blueOffset], alpha );
+		dstPtr += pixelInc;
+	}
+}
 
-	if( ! surface->hasAlpha() )
-		return;
+void unpremultiplyRow( uint8_t *dstPtr, uint8_t pixelInc, uint8_t redOffset, uint8_t greenOffset, uint8_t blueOffset, uint8_t alphaOffset, int32_t width )
+{
+	for( int32_t x = 0; x < width; ++x ) {
+		// The basic formula for unpremultiplication is to divide by the alpha
+		// which in 8bit pixel arithmetic is to multiply by 255 and divide by the alpha
+		uint8_t alpha = dstPtr[alphaOffset];
+		if( alpha ) {
+			dstPtr[redOffset] = std::min<int>( dstPtr[redOffset] * 255 / alpha, 255 );
+			dstPtr[greenOffset] = std::min<int>( dstPtr[greenOffset] * 255 / alpha, 255 );
+			dstPtr[blueOffset] = std::min<int>( dstPtr[blueOffset] * 255 / alpha, 255 );
+		}
+		dstPtr += pixelInc;
+	}
+}
 
-	surface->setPremultiplied( true );
+void unpremultiplyRow( float *dstPtr, uint8_t pixelInc, uint8_t redOffset, uint8_t greenOffset, uint8_t blueOffset, uint8_t alphaOffset, int32_t width )
+{
+	for( int32_t x = 0; x < width; ++x ) {
+		// The basic formula for unpremultiplication is to divide by the alpha
+		if( dstPtr[alphaOffset] != 0 ) {
+			float invAlpha = 1.0f / dstPtr[alphaOffset];
+			dstPtr[redOffset] *= invAlpha;
+			dstPtr[greenOffset] *= invAlpha;
+			dstPtr[blueOffset] *= invAlpha;
+		}
+		dstPtr += pixelInc;
+	}
+}
 
-	ptrdiff_t rowBytes = surface->getRowBytes();
-	uint8_t pixelInc = surface->getPixelInc();
-	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
-	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
-		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
-			// The basic formula for unpremultiplication is to divide by the alpha
-			T alpha = dstPtr[alphaOffset];
-			
-			dstPtr[redOffset] = CHANTRAIT<T>::premultiply( dstPtr[redOffset], alpha );
-			dstPtr[greenOffset] = CHANTRAIT<T>::premultiply( dstPtr[greenOffset], alpha );
-			dstPtr[blueOffset] = CHANTRAIT<T>::premultiply( dstPtr[blueOffset], alpha );
-			dstPtr += pixelInc;
+#if defined( CINDER_SIMD_SSE2 )
+
+// The vector kernels handle 4-channel pixels whose alpha is first or last, \a A being its offset, and return the number of pixels processed.
+// They match the scalar rows exactly: a * c / 255 is computed as ( x + 1 + ( x >> 8 ) ) >> 8 on 16-bit lanes, and c * 255 / a is a correctly
+// rounded float division, whose truncation is exact below 256 and clamped above it.
+
+template<int A>
+CINDER_SIMD_FORCEINLINE __m128i premultiplyHalfSse2( const __m128i &c, const __m128i &alphaMask )
+{
+	const __m128i alpha = _mm_shufflehi_epi16( _mm_shufflelo_epi16( c, _MM_SHUFFLE( A, A, A, A ) ), _MM_SHUFFLE( A, A, A, A ) );
+	__m128i t = _mm_mullo_epi16( c, alpha );
+	t = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( t, _mm_set1_epi16( 1 ) ), _mm_srli_epi16( t, 8 ) ), 8 );
+	return _mm_or_si128( _mm_and_si128( alphaMask, c ), _mm_andnot_si128( alphaMask, t ) );
+}
+
+template<int A>
+int32_t premultiplyRowSse2( uint8_t *dstPtr, int32_t width )
+{
+	const __m128i zero = _mm_setzero_si128(), alphaMask = _mm_set1_epi64x( (long long)( 0xFFFFULL << ( 16 * A ) ) );
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4 ) {
+		const __m128i c = _mm_loadu_si128( (const __m128i*)( dstPtr + x * 4 ) );
+		const __m128i lo = premultiplyHalfSse2<A>( _mm_unpacklo_epi8( c, zero ), alphaMask );
+		const __m128i hi = premultiplyHalfSse2<A>( _mm_unpackhi_epi8( c, zero ), alphaMask );
+		_mm_storeu_si128( (__m128i*)( dstPtr + x * 4 ), _mm_packus_epi16( lo, hi ) );
+	}
+	return x;
+}
+
+template<int A>
+int32_t premultiplyRowSse2( float *dstPtr, int32_t width )
+{
+	const __m128 alphaMask = _mm_castsi128_ps( _mm_set_epi32( A == 3 ? -1 : 0, 0, 0, A == 0 ? -1 : 0 ) );
+	for( int32_t x = 0; x < width; ++x ) {
+		const __m128 c = _mm_loadu_ps( dstPtr + x * 4 );
+		const __m128 t = _mm_mul_ps( c, _mm_shuffle_ps( c, c, _MM_SHUFFLE( A, A, A, A ) ) );
+		_mm_storeu_ps( dstPtr + x * 4, _mm_or_ps( _mm_and_ps( alphaMask, c ), _mm_andnot_ps( alphaMask, t ) ) );
+	}
+	return width;
+}
+
+// Unpremultiplies the single pixel held in the 32-bit lanes of \a c
+template<int A>
+CINDER_SIMD_FORCEINLINE __m128i unpremultiplyPixelSse2( const __m128i &c, const __m128 &keepMask )
+{
+	const __m128 cf = _mm_cvtepi32_ps( c );
+	const __m128 alpha = _mm_shuffle_ps( cf, cf, _MM_SHUFFLE( A, A, A, A ) );
+	const __m128 keep = _mm_or_ps( keepMask, _mm_cmpeq_ps( alpha, _mm_setzero_ps() ) );
+	const __m128 q = _mm_min_ps( _mm_div_ps( _mm_mul_ps( cf, _mm_set1_ps( 255.0f ) ), alpha ), _mm_set1_ps( 255.0f ) );
+	return _mm_cvttps_epi32( _mm_or_ps( _mm_and_ps( keep, cf ), _mm_andnot_ps( keep, q ) ) );
+}
+
+template<int A>
+int32_t unpremultiplyRowSse2( uint8_t *dstPtr, int32_t width )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 keepMask = _mm_castsi128_ps( _mm_set_epi32( A == 3 ? -1 : 0, 0, 0, A == 0 ? -1 : 0 ) );
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4 ) {
+		const __m128i c = _mm_loadu_si128( (const __m128i*)( dstPtr + x * 4 ) );
+		const __m128i lo = _mm_unpacklo_epi8( c, zero ), hi = _mm_unpackhi_epi8( c, zero );
+		const __m128i p0 = unpremultiplyPixelSse2<A>( _mm_unpacklo_epi16( lo, zero ), keepMask );
+		const __m128i p1 = unpremultiplyPixelSse2<A>( _mm_unpackhi_epi16( lo, zero ), keepMask );
+		const __m128i p2 = unpremultiplyPixelSse2<A>( _mm_unpacklo_epi16( hi, zero ), keepMask );
+		const __m128i p3 = unpremultiplyPixelSse2<A>( _mm_unpackhi_epi16( hi, zero ), keepMask );
+		_mm_storeu_si128( (__m128i*)( dstPtr + x * 4 ), _mm_packus_epi16( _mm_packs_epi32( p0, p1 ), _mm_packs_epi32( p2, p3 ) ) );
+	}
+	return x;
+}
+
+template<int A>
+int32_t unpremultiplyRowSse2( float *dstPtr, int32_t width )
+{
+	const __m128 keepMask = _mm_castsi128_ps( _mm_set_epi32( A == 3 ? -1 : 0, 0, 0, A == 0 ? -1 : 0 ) );
+	for( int32_t x = 0; x < width; ++x ) {
+		const __m128 c = _mm_loadu_ps( dstPtr + x * 4 );
+		const __m128 alpha = _mm_shuffle_ps( c, c, _MM_SHUFFLE( A, A, A, A ) );
+		const __m128 keep = _mm_or_ps( keepMask, _mm_cmpeq_ps( alpha, _mm_setzero_ps() ) );
+		const __m128 t = _mm_mul_ps( c, _mm_div_ps( _mm_set1_ps( 1.0f ), alpha ) );
+		_mm_storeu_ps( dstPtr + x * 4, _mm_or_ps( _mm_and_ps( keep, c ), _mm_andnot_ps( keep, t ) ) );
+	}
+	return width;
+}
+
+template<int A>
+CINDER_SIMD_TARGET_AVX2 int32_t premultiplyRowAvx2( uint8_t *dstPtr, int32_t width )
+{
+	const __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi16( 1 ), alphaMask = _mm256_set1_epi64x( (long long)( 0xFFFFULL << ( 16 * A ) ) );
+	int32_t x = 0;
+	for( ; x + 8 <= width; x += 8 ) {
+		const __m256i c = _mm256_loadu_si256( (const __m256i*)( dstPtr + x * 4 ) );
+		__m256i halves[2] = { _mm256_unpacklo_epi8( c, zero ), _mm256_unpackhi_epi8( c, zero ) };
+		for( int h = 0; h < 2; ++h ) {
+			const __m256i alpha = _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( halves[h], _MM_SHUFFLE( A, A, A, A ) ), _MM_SHUFFLE( A, A, A, A ) );
+			__m256i t = _mm256_mullo_epi16( halves[h], alpha );
+			t = _mm256_srli_epi16( _mm256_add_epi16( _mm256_add_epi16( t, one ), _mm256_srli_epi16( t, 8 ) ), 8 );
+			halves[h] = _mm256_blendv_epi8( t, halves[h], alphaMask );
+		}
+		_mm256_storeu_si256( (__m256i*)( dstPtr + x * 4 ), _mm256_packus_epi16( halves[0], halves[1] ) );
+	}
+	return x;
+}
+
+template<int A>
+CINDER_SIMD_TARGET_AVX2 int32_t premultiplyRowAvx2( float *dstPtr, int32_t width )
+{
+	const int blendMask = ( 1 << A ) | ( 1 << ( A + 4 ) );
+	int32_t x = 0;
+	for( ; x + 2 <= width; x += 2 ) {
+		const __m256 c = _mm256_loadu_ps( dstPtr + x * 4 );
+		const __m256 t = _mm256_mul_ps( c, _mm256_permute_ps( c, _MM_SHUFFLE( A, A, A, A ) ) );
+		_mm256_storeu_ps( dstPtr + x * 4, _mm256_blend_ps( t, c, blendMask ) );
+	}
+	return x;
+}
+
+template<int A>
+CINDER_SIMD_TARGET_AVX2 int32_t unpremultiplyRowAvx2( uint8_t *dstPtr, int32_t width )
+{
+	const __m256 zero = _mm256_setzero_ps(), max = _mm256_set1_ps( 255.0f );
+	const __m256 keepMask = _mm256_blend_ps( zero, _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) ), ( 1 << A ) | ( 1 << ( A + 4 ) ) );
+	int32_t x = 0;
+	for( ; x + 8 <= width; x += 8 ) {
+		__m256i p[4];
+		for( int i = 0; i < 4; ++i ) { // two pixels at a time, one per 128-bit lane
+			const __m256 cf = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_loadl_epi64( (const __m128i*)( dstPtr + ( x + i * 2 ) * 4 ) ) ) );
+			const __m256 alpha = _mm256_permute_ps( cf, _MM_SHUFFLE( A, A, A, A ) );
+			const __m256 keep = _mm256_or_ps( keepMask, _mm256_cmp_ps( alpha, zero, _CMP_EQ_OQ ) );
+			const __m256 q = _mm256_min_ps( _mm256_div_ps( _mm256_mul_ps( cf, max ), alpha ), max );
+			p[i] = _mm256_cvttps_epi32( _mm256_blendv_ps( q, cf, keep ) );
 		}
+		// packs interleave the 128-bit lanes; the permute restores pixel order
+		const __m256i packed = _mm256_packus_epi16( _mm256_packs_epi32( p[0], p[1] ), _mm256_packs_epi32( p[2], p[3] ) );
+		_mm256_storeu_si256( (__m256i*)( dstPtr + x * 4 ), _mm256_permutevar8x32_epi32( packed, _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 ) ) );
+	}
+	return x;
+}
+
+template<int A>
+CINDER_SIMD_TARGET_AVX2 int32_t unpremultiplyRowAvx2( float *dstPtr, int32_t width )
+{
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps( 1.0f );
+	const __m256 keepMask = _mm256_blend_ps( zero, _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) ), ( 1 << A ) | ( 1 << ( A + 4 ) ) );
+	int32_t x = 0;
+	for( ; x + 2 <= width; x += 2 ) {
+		const __m256 c = _mm256_loadu_ps( dstPtr + x * 4 );
+		const __m256 alpha = _mm256_permute_ps( c, _MM_SHUFFLE( A, A, A, A ) );
+		const __m256 keep = _mm256_or_ps( keepMask, _mm256_cmp_ps( alpha, zero, _CMP_EQ_OQ ) );
+		const __m256 t = _mm256_mul_ps( c, _mm256_div_ps( one, alpha ) );
+		_mm256_storeu_ps( dstPtr + x * 4, _mm256_blendv_ps( t, c, keep ) );
+	}
+	return x;
+}
+
+#endif // defined( CINDER_SIMD_SSE2 )
+
+// Returns the number of leading pixels of the row that the vector kernels premultiplied (or unpremultiplied), leaving the rest to the scalar row
+template<typename T>
+int32_t premultiplyRowSimd( T *dstPtr, uint8_t pixelInc, uint8_t alphaOffset, int32_t width, bool unpremult )
+{
+#if defined( CINDER_SIMD_SSE2 )
+	if( pixelInc != 4 || ( alphaOffset != 0 && alphaOffset != 3 ) )
+		return 0;
+
+	const simd::Level simdLevel = simd::getLevel();
+	if( simdLevel >= simd::Level::AVX2 ) {
+		if( unpremult )
+			return ( alphaOffset == 0 ) ? unpremultiplyRowAvx2<0>( dstPtr, width ) : unpremultiplyRowAvx2<3>( dstPtr, width );
+		else
+			return ( alphaOffset == 0 ) ? premultiplyRowAvx2<0>( dstPtr, width ) : premultiplyRowAvx2<3>( dstPtr, width );
 	}
+	else if( simdLevel >= simd::Level::SSE2 ) {
+		if( unpremult )
+			return ( alphaOffset == 0 ) ? unpremultiplyRowSse2<0>( dstPtr, width ) : unpremultiplyRowSse2<3>( dstPtr, width );
+		else
+			return ( alphaOffset == 0 ) ? premultiplyRowSse2<0>( dstPtr, width ) : premultiplyRowSse2<3>( dstPtr, width );
+	}
+#endif
+	return 0;
 }
 
-// this is a candidate for sse2
-template<>
-void unpremultiply<uint8_t>( SurfaceT<uint8_t> *surface )
+} // anonymous namespace
+
+template<typename T>
+void premultiply( SurfaceT<T> *surface )
 {
 	const Area clippedArea = surface->getBounds();
 
 	if( ! surface->hasAlpha() )
 		return;
 
-	surface->setPremultiplied( false );
+	surface->setPremultiplied( true );
 
 	ptrdiff_t rowBytes = surface->getRowBytes();
 	uint8_t pixelInc = surface->getPixelInc();
 	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
 	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
-		uint8_t *dstPtr = reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes;
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
-			// The basic formula for unpremultiplication is to divide by the alpha
-			// which in 8bit pixel arithmetic is to multiply by 255 and divide by the alpha
-			uint8_t alpha = dstPtr[alphaOffset];
-			if( alpha ) {
-				dstPtr[redOffset] = std::min<int>( dstPtr[redOffset] * 255 / alpha, 255 );
-				dstPtr[greenOffset] = std::min<int>( dstPtr[greenOffset] * 255 / alpha, 255 );
-				dstPtr[blueOffset] = std::min<int>( dstPtr[blueOffset] * 255 / alpha, 255 );
-			}
-			dstPtr += pixelInc;
-		}
-	}	
+		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
+		const int32_t x = premultiplyRowSimd( dstPtr, pixelInc, alphaOffset, clippedArea.getWidth(), false );
+		premultiplyRow( dstPtr + x * pixelInc, pixelInc, redOffset, greenOffset, blueOffset, alphaOffset, clippedArea.getWidth() - x );
+	}
 }
 
-template<>
-void unpremultiply<float>( SurfaceT<float> *surface )
+template<typename T>
+void unpremultiply( SurfaceT<T> *surface )
 {
 	const Area clippedArea = surface->getBounds();
 
@@ -100,24 +289,15 @@ void unpremultiply<float>( SurfaceT<float> *surface )
 	uint8_t pixelInc = surface->getPixelInc();
 	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
 	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
-		float *dstPtr = reinterpret_cast<float*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
-			// The basic formula for unpremultiplication is to divide by the alpha
-			if( dstPtr[alphaOffset] != 0 ) {
-				float invAlpha = 1.0f / dstPtr[alphaOffset];
-				dstPtr[redOffset] *= invAlpha;
-				dstPtr[greenOffset] *= invAlpha;
-				dstPtr[blueOffset] *= invAlpha;
-			}
-			dstPtr += pixelInc;
-		}
-	}	
+		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
+		const int32_t x = premultiplyRowSimd( dstPtr, pixelInc, alphaOffset, clippedArea.getWidth(), true );
+		unpremultiplyRow( dstPtr + x * pixelInc, pixelInc, redOffset, greenOffset, blueOffset, alphaOffset, clippedArea.getWidth() - x );
+	}
 }
 
-
-
 #define premult_PROTOTYPES(r,data,T)\
-	template void premultiply( SurfaceT<T> *Surface );
+	template void premultiply( SurfaceT<T> *Surface );\
+	template void unpremultiply( SurfaceT<T> *Surface );
 
 BOOST_PP_SEQ_FOR_EACH( premult_PROTOTYPES, ~, CHANNEL_TYPES )
 	
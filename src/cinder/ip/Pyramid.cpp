@@ -0,0 +1,442 @@
+/*
+ Copyright (c) 2016, The Cinder Project, All rights reserved.
+ 
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Pyramid.h"
+#include "cinder/ip/Parallel.h"
+#include "cinder/ChanTraits.h"
+
+#include <boost/preprocessor/seq.hpp>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+using namespace std;
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// Destination rows are filtered in bands this tall, so the horizontally filtered source rows they read stay in cache
+const int32_t BAND_ROWS = 32;
+
+struct Tap {
+	int32_t		mIndex;
+	float		mWeight;
+};
+
+// The source samples contributing to each destination sample along one axis
+class Taps {
+  public:
+	Taps() : mHalving( false ) {}
+
+	void		add( int32_t index, float weight )	{ mTaps.push_back( Tap{ index, weight } ); }
+	//! Marks the end of the current destination sample's taps
+	void		next()								{ mEnds.push_back( (int32_t)mTaps.size() ); }
+
+	const Tap*	begin( int32_t i ) const			{ return mTaps.data() + ( i ? mEnds[i - 1] : 0 ); }
+	const Tap*	end( int32_t i ) const				{ return mTaps.data() + mEnds[i]; }
+
+	//! Whether each destination sample is the average of source samples 2i and 2i + 1, the common case of mipmapping an even size
+	bool		isHalving() const					{ return mHalving; }
+	void		setHalving()						{ mHalving = true; }
+
+  private:
+	vector<Tap>		mTaps;
+	vector<int32_t>	mEnds;
+	bool			mHalving;
+};
+
+// Averages the area of the source each destination sample covers
+Taps calcBoxTaps( int32_t srcSize, int32_t dstSize )
+{
+	Taps result;
+	const double scale = double( srcSize ) / dstSize;
+	for( int32_t i = 0; i < dstSize; ++i ) {
+		const double x1 = i * scale, x2 = ( i + 1 ) * scale;
+		for( int32_t s = (int32_t)x1; s < x2 && s < srcSize; ++s ) {
+			const double coverage = std::min( x2, s + 1.0 ) - std::max( x1, (double)s );
+			if( coverage > 1e-9 )
+				result.add( s, float( coverage / scale ) );
+		}
+		result.next();
+	}
+	if( srcSize == dstSize * 2 )
+		result.setHalving();
+	return result;
+}
+
+const float BINOMIAL[5] = { 1 / 16.0f, 4 / 16.0f, 6 / 16.0f, 4 / 16.0f, 1 / 16.0f };
+
+// Blurs with the 5-tap binomial kernel centered on every other source sample, clamping at the edges
+Taps calcReduceTaps( int32_t srcSize, int32_t dstSize )
+{
+	Taps result;
+	for( int32_t i = 0; i < dstSize; ++i ) {
+		for( int32_t k = -2; k <= 2; ++k )
+			result.add( constrain<int32_t>( 2 * i + k, 0, srcSize - 1 ), BINOMIAL[k + 2] );
+		result.next();
+	}
+	return result;
+}
+
+// The inverse of calcReduceTaps(), interpolating the source as if its samples were interleaved with zeros
+Taps calcExpandTaps( int32_t srcSize, int32_t dstSize )
+{
+	Taps result;
+	for( int32_t i = 0; i < dstSize; ++i ) {
+		for( int32_t k = i / 2 - 1; k <= i / 2 + 1; ++k ) {
+			if( std::abs( i - 2 * k ) <= 2 )
+				result.add( constrain<int32_t>( k, 0, srcSize - 1 ), 2 * BINOMIAL[i - 2 * k + 2] );
+		}
+		result.next();
+	}
+	return result;
+}
+
+typedef std::function<const float*( int32_t row, float *scratch )> RowFunc;
+
+template<int32_t PIXEL_INC>
+void filterRow( const float *src, float *dst, int32_t dstWidth, const Taps &xTaps )
+{
+	if( xTaps.isHalving() ) {
+		for( int32_t x = 0; x < dstWidth; ++x, dst += PIXEL_INC, src += 2 * PIXEL_INC ) {
+			for( int32_t c = 0; c < PIXEL_INC; ++c )
+				dst[c] = ( src[c] + src[PIXEL_INC + c] ) * 0.5f;
+		}
+		return;
+	}
+
+	for( int32_t x = 0; x < dstWidth; ++x, dst += PIXEL_INC ) {
+		float sum[PIXEL_INC] = {};
+		for( const Tap *tap = xTaps.begin( x ); tap != xTaps.end( x ); ++tap ) {
+			const float *s = src + tap->mIndex * PIXEL_INC;
+			for( int32_t c = 0; c < PIXEL_INC; ++c )
+				sum[c] += s[c] * tap->mWeight;
+		}
+		for( int32_t c = 0; c < PIXEL_INC; ++c )
+			dst[c] = sum[c];
+	}
+}
+
+// Filters an image of \a srcSize, whose rows of \a pixelInc floats per pixel are returned by \a getRow, into \a dst of \a dstSize
+void resample( const RowFunc &getRow, const ivec2 &srcSize, float *dst, const ivec2 &dstSize, int32_t pixelInc, const Taps &xTaps, const Taps &yTaps, int numThreads )
+{
+	void (*filterRowFn)( const float*, float*, int32_t, const Taps& );
+	switch( pixelInc ) {
+		case 1: filterRowFn = filterRow<1>; break;
+		case 2: filterRowFn = filterRow<2>; break;
+		case 3: filterRowFn = filterRow<3>; break;
+		default: filterRowFn = filterRow<4>; break;
+	}
+
+	const size_t dstRowFloats = dstSize.x * pixelInc;
+	parallelForRows( 0, dstSize.y, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		vector<float> scratch( srcSize.x * pixelInc ), filtered;
+		for( int32_t bandBegin = rowBegin; bandBegin < rowEnd; bandBegin += BAND_ROWS ) {
+			const int32_t bandEnd = std::min( bandBegin + BAND_ROWS, rowEnd );
+			int32_t srcBegin = INT_MAX, srcEnd = 0;
+			for( int32_t y = bandBegin; y < bandEnd; ++y ) {
+				for( const Tap *tap = yTaps.begin( y ); tap != yTaps.end( y ); ++tap ) {
+					srcBegin = std::min( srcBegin, tap->mIndex );
+					srcEnd = std::max( srcEnd, tap->mIndex + 1 );
+				}
+			}
+
+			filtered.resize( ( srcEnd - srcBegin ) * dstRowFloats );
+			for( int32_t sy = srcBegin; sy < srcEnd; ++sy )
+				filterRowFn( getRow( sy, scratch.data() ), &filtered[( sy - srcBegin ) * dstRowFloats], dstSize.x, xTaps );
+
+			for( int32_t y = bandBegin; y < bandEnd; ++y ) {
+				float *out = dst + y * dstRowFloats;
+				std::fill( out, out + dstRowFloats, 0.0f );
+				for( const Tap *tap = yTaps.begin( y ); tap != yTaps.end( y ); ++tap ) {
+					const float *row = &filtered[( tap->mIndex - srcBegin ) * dstRowFloats];
+					const float weight = tap->mWeight;
+					for( size_t i = 0; i < dstRowFloats; ++i )
+						out[i] += row[i] * weight;
+				}
+			}
+		}
+	}, 1 );
+}
+
+inline float srgbToLinear( float c )
+{
+	return ( c <= 0.04045f ) ? c / 12.92f : std::pow( ( c + 0.055f ) / 1.055f, 2.4f );
+}
+
+inline float linearToSrgb( float l )
+{
+	return ( l <= 0.0031308f ) ? l * 12.92f : 1.055f * std::pow( l, 1 / 2.4f ) - 0.055f;
+}
+
+// Converts rows of a Surface to and from normalized floats in linear light
+template<typename T>
+class LinearLight {
+  public:
+	LinearLight( const SurfaceChannelOrder &channelOrder, bool srgb )
+		: mPixelInc( channelOrder.getPixelInc() )
+	{
+		for( int32_t c = 0; c < mPixelInc; ++c )
+			mSrgb[c] = srgb && ! ( channelOrder.hasAlpha() && c == channelOrder.getAlphaOffset() );
+
+		if( std::is_integral<T>::value ) {
+			const float maxValue = (float)CHANTRAIT<T>::max();
+			for( int32_t v = 0; v <= (int32_t)CHANTRAIT<T>::max(); ++v ) {
+				mLinearLut.push_back( v / maxValue );
+				mSrgbLut.push_back( srgbToLinear( v / maxValue ) );
+			}
+			// the smallest linear value which rounds to each 8-bit code, indexed by a coarse lookup, so that encoding needs no pow()
+			if( sizeof( T ) == 1 ) {
+				for( int32_t v = 0; v < 255; ++v )
+					mSrgbThresholds.push_back( srgbToLinear( ( v + 0.5f ) / 255 ) );
+				mSrgbThresholds.push_back( numeric_limits<float>::max() );
+				for( int32_t i = 0; i < SRGB_ENCODE_LUT_SIZE; ++i )
+					mSrgbEncodeLut.push_back( (uint8_t)( std::lower_bound( mSrgbThresholds.begin(), mSrgbThresholds.end(), i / float( SRGB_ENCODE_LUT_SIZE ) ) - mSrgbThresholds.begin() ) );
+			}
+		}
+	}
+
+	void	decode( const T *src, int32_t width, float *dst ) const
+	{
+		for( int32_t c = 0; c < mPixelInc; ++c ) {
+			if( std::is_integral<T>::value ) {
+				const float *lut = mSrgb[c] ? mSrgbLut.data() : mLinearLut.data();
+				for( int32_t x = 0; x < width; ++x )
+					dst[x * mPixelInc + c] = lut[(size_t)src[x * mPixelInc + c]];
+			}
+			else {
+				for( int32_t x = 0; x < width; ++x )
+					dst[x * mPixelInc + c] = mSrgb[c] ? srgbToLinear( (float)src[x * mPixelInc + c] ) : (float)src[x * mPixelInc + c];
+			}
+		}
+	}
+
+	void	encode( const float *src, int32_t width, T *dst ) const
+	{
+		for( int32_t c = 0; c < mPixelInc; ++c ) {
+			if( ! mSrgb[c] ) {
+				for( int32_t x = 0; x < width; ++x )
+					dst[x * mPixelInc + c] = quantize( src[x * mPixelInc + c] );
+			}
+			else if( ! mSrgbEncodeLut.empty() ) {
+				for( int32_t x = 0; x < width; ++x ) {
+					const float v = src[x * mPixelInc + c];
+					// the lookup lands on or just below the code, as sRGB's steps are never narrower than the lookup's near zero
+					int32_t code = mSrgbEncodeLut[(size_t)( constrain( v, 0.0f, 1.0f ) * ( SRGB_ENCODE_LUT_SIZE - 1 ) )];
+					while( v >= mSrgbThresholds[code] )
+						++code;
+					dst[x * mPixelInc + c] = (T)code;
+				}
+			}
+			else {
+				for( int32_t x = 0; x < width; ++x )
+					dst[x * mPixelInc + c] = quantize( linearToSrgb( std::max( src[x * mPixelInc + c], 0.0f ) ) );
+			}
+		}
+	}
+
+	//! Differences are stored as is in floats, and as ( d + 1 ) / 2 in integers
+	void	decodeDifference( const T *src, int32_t width, float *dst ) const
+	{
+		for( int32_t i = 0; i < width * mPixelInc; ++i )
+			dst[i] = std::is_integral<T>::value ? mLinearLut[(size_t)src[i]] * 2 - 1 : (float)src[i];
+	}
+
+	void	encodeDifference( const float *src, int32_t width, T *dst ) const
+	{
+		for( int32_t i = 0; i < width * mPixelInc; ++i )
+			dst[i] = std::is_integral<T>::value ? quantize( ( src[i] + 1 ) / 2 ) : (T)src[i];
+	}
+
+  private:
+	static const int32_t SRGB_ENCODE_LUT_SIZE = 4096;
+
+	static T	quantize( float v )
+	{
+		if( std::is_integral<T>::value )
+			return (T)( constrain( v, 0.0f, 1.0f ) * CHANTRAIT<T>::max() + 0.5f );
+		else
+			return (T)v;
+	}
+
+	int32_t				mPixelInc;
+	bool				mSrgb[4];
+	vector<float>		mLinearLut, mSrgbLut, mSrgbThresholds;
+	vector<uint8_t>		mSrgbEncodeLut;
+};
+
+// A level held as floats in linear light, pixelInc floats per pixel
+struct LinearLevel {
+	ivec2			mSize;
+	vector<float>	mData;
+
+	float*			getRow( int32_t y, int32_t pixelInc )	{ return &mData[y * mSize.x * pixelInc]; }
+};
+
+} // anonymous namespace
+
+template<typename T>
+Pyramid<T>::Pyramid( const SurfaceT<T> &surface, const Format &format )
+	: mFormat( format )
+{
+	if( surface.getWidth() <= 0 || surface.getHeight() <= 0 )
+		return;
+
+	const SurfaceChannelOrder &channelOrder = surface.getChannelOrder();
+	const int32_t pixelInc = surface.getPixelInc();
+	const int numThreads = getNumThreads( format.getNumThreads() );
+	const bool mipmap = format.getType() == Type::MIPMAP, laplacian = format.getType() == Type::LAPLACIAN;
+	const LinearLight<T> light( channelOrder, format.isSrgb() );
+
+	vector<LinearLevel> linear( 1, LinearLevel{ surface.getSize(), vector<float>() } );
+	while( ( format.getMaxLevels() <= 0 || (int)linear.size() < format.getMaxLevels() ) && ( linear.back().mSize.x > 1 || linear.back().mSize.y > 1 ) ) {
+		const ivec2 &size = linear.back().mSize;
+		linear.push_back( LinearLevel{ mipmap ? glm::max( size / 2, ivec2( 1 ) ) : ( size + 1 ) / 2, vector<float>() } );
+	}
+
+	auto encodeLevel = [&]( LinearLevel &level ) {
+		SurfaceT<T> result( level.mSize.x, level.mSize.y, surface.hasAlpha(), channelOrder );
+		parallelForRows( 0, level.mSize.y, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+			for( int32_t y = rowBegin; y < rowEnd; ++y )
+				light.encode( level.getRow( y, pixelInc ), level.mSize.x, result.getData( ivec2( 0, y ) ) );
+		} );
+		return result;
+	};
+
+	// Laplacian levels need every Gaussian level at once, so level 0 is decoded up front; otherwise it is decoded row by row as level 1 is filtered
+	RowFunc decodeSurfaceRow = [&]( int32_t y, float *scratch ) -> const float* {
+		light.decode( surface.getData( ivec2( 0, y ) ), surface.getWidth(), scratch );
+		return scratch;
+	};
+	if( laplacian ) {
+		linear[0].mData.resize( surface.getWidth() * surface.getHeight() * pixelInc );
+		parallelForRows( 0, surface.getHeight(), numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+			for( int32_t y = rowBegin; y < rowEnd; ++y )
+				decodeSurfaceRow( y, linear[0].getRow( y, pixelInc ) );
+		} );
+	}
+	else
+		mLevels.push_back( surface.clone() );
+
+	for( size_t l = 1; l < linear.size(); ++l ) {
+		LinearLevel &src = linear[l - 1], &dst = linear[l];
+		dst.mData.resize( dst.mSize.x * dst.mSize.y * pixelInc );
+		RowFunc getRow = ( src.mData.empty() ) ? decodeSurfaceRow : [&]( int32_t y, float * ) -> const float* { return src.getRow( y, pixelInc ); };
+		if( mipmap )
+			resample( getRow, src.mSize, dst.mData.data(), dst.mSize, pixelInc, calcBoxTaps( src.mSize.x, dst.mSize.x ), calcBoxTaps( src.mSize.y, dst.mSize.y ), numThreads );
+		else
+			resample( getRow, src.mSize, dst.mData.data(), dst.mSize, pixelInc, calcReduceTaps( src.mSize.x, dst.mSize.x ), calcReduceTaps( src.mSize.y, dst.mSize.y ), numThreads );
+
+		if( ! laplacian ) {
+			mLevels.push_back( encodeLevel( dst ) );
+			vector<float>().swap( src.mData );
+		}
+	}
+
+	if( laplacian ) {
+		// Each level but the last becomes its difference from the expansion of the next. Differences are taken against the levels as reconstruct() will
+		// rebuild them from the quantized levels above, so that quantization errors don't accumulate from level to level.
+		mLevels.resize( linear.size() );
+		mLevels.back() = encodeLevel( linear.back() );
+		LinearLevel rebuilt{ linear.back().mSize, vector<float>( linear.back().mData.size() ) };
+		for( int32_t y = 0; y < rebuilt.mSize.y; ++y )
+			light.decode( mLevels.back().getData( ivec2( 0, y ) ), rebuilt.mSize.x, rebuilt.getRow( y, pixelInc ) );
+
+		for( size_t l = linear.size() - 1; l-- > 0; ) {
+			LinearLevel &level = linear[l];
+			LinearLevel expanded{ level.mSize, vector<float>( level.mData.size() ) };
+			resample( [&]( int32_t y, float * ) -> const float* { return rebuilt.getRow( y, pixelInc ); }, rebuilt.mSize, expanded.mData.data(), expanded.mSize, pixelInc,
+					calcExpandTaps( rebuilt.mSize.x, level.mSize.x ), calcExpandTaps( rebuilt.mSize.y, level.mSize.y ), numThreads );
+
+			SurfaceT<T> difference( level.mSize.x, level.mSize.y, surface.hasAlpha(), channelOrder );
+			parallelForRows( 0, level.mSize.y, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+				for( int32_t y = rowBegin; y < rowEnd; ++y ) {
+					float *row = level.getRow( y, pixelInc ), *expandedRow = expanded.getRow( y, pixelInc );
+					for( int32_t i = 0; i < level.mSize.x * pixelInc; ++i )
+						row[i] -= expandedRow[i];
+					T *differenceRow = difference.getData( ivec2( 0, y ) );
+					light.encodeDifference( row, level.mSize.x, differenceRow );
+					light.decodeDifference( differenceRow, level.mSize.x, row );
+					for( int32_t i = 0; i < level.mSize.x * pixelInc; ++i )
+						expandedRow[i] += row[i];
+				}
+			} );
+			mLevels[l] = difference;
+			rebuilt = std::move( expanded );
+			vector<float>().swap( level.mData );
+		}
+	}
+}
+
+template<typename T>
+SurfaceT<T> Pyramid<T>::reconstruct() const
+{
+	if( mLevels.empty() )
+		return SurfaceT<T>();
+	else if( mFormat.getType() != Type::LAPLACIAN )
+		return mLevels.front().clone();
+
+	const SurfaceT<T> &top = mLevels.back();
+	const SurfaceChannelOrder &channelOrder = top.getChannelOrder();
+	const int32_t pixelInc = top.getPixelInc();
+	const int numThreads = getNumThreads( mFormat.getNumThreads() );
+	const LinearLight<T> light( channelOrder, mFormat.isSrgb() );
+
+	LinearLevel current{ top.getSize(), vector<float>( top.getWidth() * top.getHeight() * pixelInc ) };
+	for( int32_t y = 0; y < top.getHeight(); ++y )
+		light.decode( top.getData( ivec2( 0, y ) ), top.getWidth(), current.getRow( y, pixelInc ) );
+
+	for( size_t l = mLevels.size() - 1; l-- > 0; ) {
+		const SurfaceT<T> &difference = mLevels[l];
+		LinearLevel expanded{ difference.getSize(), vector<float>( difference.getWidth() * difference.getHeight() * pixelInc ) };
+		resample( [&]( int32_t y, float * ) -> const float* { return current.getRow( y, pixelInc ); }, current.mSize, expanded.mData.data(), expanded.mSize, pixelInc,
+				calcExpandTaps( current.mSize.x, expanded.mSize.x ), calcExpandTaps( current.mSize.y, expanded.mSize.y ), numThreads );
+		parallelForRows( 0, expanded.mSize.y, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+			vector<float> row( expanded.mSize.x * pixelInc );
+			for( int32_t y = rowBegin; y < rowEnd; ++y ) {
+				light.decodeDifference( difference.getData( ivec2( 0, y ) ), expanded.mSize.x, row.data() );
+				float *out = expanded.getRow( y, pixelInc );
+				for( size_t i = 0; i < row.size(); ++i )
+					out[i] += row[i];
+			}
+		} );
+		current = std::move( expanded );
+	}
+
+	SurfaceT<T> result( current.mSize.x, current.mSize.y, top.hasAlpha(), channelOrder );
+	parallelForRows( 0, current.mSize.y, numThreads, [&]( int32_t rowBegin, int32_t rowEnd ) {
+		for( int32_t y = rowBegin; y < rowEnd; ++y )
+			light.encode( current.getRow( y, pixelInc ), current.mSize.x, result.getData( ivec2( 0, y ) ) );
+	} );
+	return result;
+}
+
+#define pyramid_PROTOTYPES(r,data,T)\
+	template class Pyramid<T>;
+
+BOOST_PP_SEQ_FOR_EACH( pyramid_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
+
+} } // namespace cinder::ip
@@ -22,6 +22,7 @@
 
 #include "cinder/Surface.h"
 #include "cinder/ip/Resize.h"
+#include "cinder/ip/Parallel.h"
 #include "cinder/Filter.h"
 #include "cinder/Rect.h"
 #include "cinder/ChanTraits.h"
@@ -33,6 +34,7 @@ using std::pair;
 using std::unique_ptr;
 #include <limits>
 #include <fstream>
+#include <cstring>
 #include <algorithm>
 #include <boost/preprocessor/seq.hpp>
 
@@ -71,6 +73,23 @@ struct SCALETRAIT<float> {
 
 const float SCALETRAIT<float>::WEIGHTONE = 1.0f;
 
+// 16-bit data would overflow 32-bit integer accumulation after both passes, so it is filtered in float
+template<>
+struct SCALETRAIT<uint16_t> {
+	typedef float SUMT;
+	static const float WEIGHTONE;		// filter weight of one
+	static uint16_t ACCUMTOCHANNEL( const float in ) {
+		if( in <= 0 )
+			return 0;
+		else if( in >= 65535.0f )
+			return 65535;
+		return static_cast<uint16_t>( in + 0.5f );
+	}
+	static float CHANNELTOBUFFER( const float in ) { return in; }
+};
+
+const float SCALETRAIT<uint16_t>::WEIGHTONE = 1.0f;
+
 // the mapping from discrete dest coordinates b to continuous source coordinates:
 #define MAP(b, scale, offset)  (((b)+(offset))/(scale))
 
@@ -99,32 +118,22 @@ template<typename T, typename WT>
 void makeWeightTable( int32_t b, float cen, const FilterBase &filter, const FilterParams *params, int32_t len, bool trimzeros, WeightTable<WT> *wtab );
 
 template<typename AT, typename T>
-void scanlineShiftAccumToChannel( AT *accum, int32_t x1, int32_t y, int32_t width, ChannelT<T> *channel )
+void scanlineShiftAccumToChannel( const AT *accum, T *dst, int8_t pixelStride, int32_t width )
 {
-	AT result;
-	T *dst;
-
-	dst = channel->getData( x1, y );
-	int8_t pixelStride = channel->getIncrement();
-
 	for( int32_t i = 0; i < width; i++ ) {
-		result = SCALETRAIT<T>::ACCUMTOCHANNEL( *accum++ );
-		*dst = static_cast<T>( result );
+		*dst = static_cast<T>( SCALETRAIT<T>::ACCUMTOCHANNEL( *accum++ ) );
 		dst += pixelStride;
 	}
 }
 
 template<typename T, typename WT, typename AT>
-void scanlineFilterChannelToBuffer( WeightTable<WT> *weights, int32_t x, int32_t y, const ChannelT<T> &channel, AT *lineBuffer, int32_t width )
+void scanlineFilterChannelToBuffer( const WeightTable<WT> *weights, const T *srcLine, int8_t pixelStride, AT *lineBuffer, int32_t width )
 {
 	int32_t b, af;
 	AT sum;
-	AT *wp;
-	const T *srcLine, *src;
+	const AT *wp;
+	const T *src;
 
-	srcLine = channel.getData( x, y );
-
-	int8_t pixelStride = channel.getIncrement();
 	for ( b = 0; b < width; b++ ) {
 		if( std::numeric_limits<AT>::is_integer )
 			sum = 1 << 7;
@@ -141,32 +150,49 @@ void scanlineFilterChannelToBuffer( WeightTable<WT> *weights, int32_t x, int32_t
 	}	
 }
 
-// assumes channels are of same dimensions
+// The clipped source and dest regions of a resample along with the filter contributions for every dest column and row.
+// These are computed once up front and shared by all channels and bands, or by every row of a ResizeStream
 template<typename T>
-void resample( const vector<const ChannelT<T>*> &srcChannels, const FilterBase &filter, const Area &srcArea, const Area &dstArea, const vector<ChannelT<T>*> &dstChannels )
+struct ResampleWeights {
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
+
+	//! Returns \c false if the clipped source or dest regions are empty
+	bool	setup( const Area &srcBounds, const Rectf &srcRect, const Area &dstBounds, const Area &dstArea, const FilterBase &filter );
+
+	Area		mDstArea;
+	int32_t		mDstWidth, mDstHeight, mSrcWidth, mSrcHeight;
+	int32_t		mSrcOffsetX, mSrcOffsetY;
+	int32_t		mFilterHeight;	// number of x-filtered source lines which can contribute to one dest line
+
+	vector<WeightTable<SUMT>>	mXWeights, mYWeights;
+	vector<SUMT>				mXWeightBuffer, mYWeightBuffer;
+};
+
+template<typename T>
+bool ResampleWeights<T>::setup( const Area &srcBounds, const Rectf &srcRect, const Area &dstBounds, const Area &dstArea, const FilterBase &filter )
 {
 	Rectf clippedSrcRect;
-	Area clippedDstArea;
-	getClippedScaledRects( srcChannels[0]->getBounds(), Rectf( srcArea ), dstChannels[0]->getBounds(), dstArea, &clippedSrcRect, &clippedDstArea );
+	getClippedScaledRects( srcBounds, srcRect, dstBounds, dstArea, &clippedSrcRect, &mDstArea );
 	
-	if ( ( clippedSrcRect.getWidth() <= 0 ) || ( clippedDstArea.getWidth() <= 0 ) 
-		|| ( clippedSrcRect.getHeight() <= 0 ) || ( clippedDstArea.getHeight() <= 0 ) )
-		return;
+	if ( ( clippedSrcRect.getWidth() <= 0 ) || ( mDstArea.getWidth() <= 0 ) 
+		|| ( clippedSrcRect.getHeight() <= 0 ) || ( mDstArea.getHeight() <= 0 ) )
+		return false;
 	
 	FilterParams filterParamsX, filterParamsY;
 	Mapping m;
-	int32_t dstWidth = (int32_t)clippedDstArea.getWidth(), dstHeight = (int32_t)clippedDstArea.getHeight();
-	int32_t srcWidth = (int32_t)clippedSrcRect.getWidth(), srcHeight = (int32_t)clippedSrcRect.getHeight();
-	int32_t srcOffsetX = static_cast<int32_t>( floor( clippedSrcRect.getX1() ) );
-	int32_t srcOffsetY = static_cast<int32_t>( floor( clippedSrcRect.getY1() ) );
-	vector<pair<int32_t,unique_ptr<typename SCALETRAIT<T>::SUMT[]>>> linesBuffer;
-
-	m.sx = dstWidth / (float)srcWidth;
-	m.sy = dstHeight / (float)srcHeight;
-	m.tx = clippedDstArea.getX1() - 0.5f - m.sx * ( clippedSrcRect.getX1() - 0.5f );
-	m.ty = clippedDstArea.getY1() - 0.5f - m.sy * ( clippedSrcRect.getY1() - 0.5f );
-	m.ux = clippedDstArea.getX1() - m.sx * ( clippedSrcRect.getX1()- 0.5f ) - m.tx;
-	m.uy = clippedDstArea.getY1() - m.sy * ( clippedSrcRect.getY1()- 0.5f ) - m.ty;
+	mDstWidth = (int32_t)mDstArea.getWidth();
+	mDstHeight = (int32_t)mDstArea.getHeight();
+	mSrcWidth = (int32_t)clippedSrcRect.getWidth();
+	mSrcHeight = (int32_t)clippedSrcRect.getHeight();
+	mSrcOffsetX = static_cast<int32_t>( floor( clippedSrcRect.getX1() ) );
+	mSrcOffsetY = static_cast<int32_t>( floor( clippedSrcRect.getY1() ) );
+
+	m.sx = mDstWidth / (float)mSrcWidth;
+	m.sy = mDstHeight / (float)mSrcHeight;
+	m.tx = mDstArea.getX1() - 0.5f - m.sx * ( clippedSrcRect.getX1() - 0.5f );
+	m.ty = mDstArea.getY1() - 0.5f - m.sy * ( clippedSrcRect.getY1() - 0.5f );
+	m.ux = mDstArea.getX1() - m.sx * ( clippedSrcRect.getX1()- 0.5f ) - m.tx;
+	m.uy = mDstArea.getY1() - m.sy * ( clippedSrcRect.getY1()- 0.5f ) - m.ty;
 
 	filterParamsX.scale = std::max( 1.0f, 1.0f / m.sx );
 	filterParamsX.supp = std::max( 0.5f, filterParamsX.scale * filter.getSupport() );
@@ -175,47 +201,72 @@ void resample( const vector<const ChannelT<T>*> &srcChannels, const FilterBase &
 	filterParamsY.scale = std::max( 1.0f, 1.0f / m.sy );
 	filterParamsY.supp = std::max( 0.5f, filterParamsY.scale * filter.getSupport() );
 	filterParamsY.width = (int32_t)ceil( 2.0f * filterParamsY.supp );
+	mFilterHeight = filterParamsY.width;
 
-	for( int32_t i = 0; i < filterParamsY.width; i++ )
-		linesBuffer.push_back( std::make_pair( -1, unique_ptr<typename SCALETRAIT<T>::SUMT[]>( new typename SCALETRAIT<T>::SUMT[dstWidth] ) ) );
+	mXWeights.resize( mDstWidth );
+	mYWeights.resize( mDstHeight );
+	mXWeightBuffer.resize( mDstWidth * filterParamsX.width );
+	mYWeightBuffer.resize( mDstHeight * filterParamsY.width );
 
-	WeightTable<typename SCALETRAIT<T>::SUMT> *xWeights, yWeights;
-	typename SCALETRAIT<T>::SUMT *xWeightBuffer, *xWeightPtr;
-	xWeights = (WeightTable<typename SCALETRAIT<T>::SUMT>*)malloc( sizeof(WeightTable<int32_t>) * dstWidth );
-	xWeightBuffer = (typename SCALETRAIT<T>::SUMT*)malloc( sizeof(typename SCALETRAIT<T>::SUMT) * dstWidth * filterParamsX.width );
-	yWeights.weight = (typename SCALETRAIT<T>::SUMT*)malloc( sizeof(typename SCALETRAIT<T>::SUMT) * filterParamsY.width );
-	unique_ptr<typename SCALETRAIT<T>::SUMT[]> accum = unique_ptr<typename SCALETRAIT<T>::SUMT[]>( new typename SCALETRAIT<T>::SUMT[dstWidth] );
+	for ( int32_t bx = 0; bx < mDstWidth; bx++ ) {
+		mXWeights[bx].weight = &mXWeightBuffer[bx * filterParamsX.width];
+		makeWeightTable<T,SUMT>( bx, MAP(bx, m.sx, m.ux), filter, &filterParamsX, mSrcWidth, true, &mXWeights[bx] );
+	}
 
-	xWeightPtr = xWeightBuffer;
-	for ( int32_t bx = 0; bx < dstWidth; bx++, xWeightPtr += filterParamsX.width ) {
-		xWeights[bx].weight = xWeightPtr;
-		makeWeightTable<T,typename SCALETRAIT<T>::SUMT>( bx, MAP(bx, m.sx, m.ux), filter, &filterParamsX, srcWidth, true, &xWeights[bx] );
+	for ( int32_t by = 0; by < mDstHeight; by++ ) {
+		mYWeights[by].weight = &mYWeightBuffer[by * filterParamsY.width];
+		makeWeightTable<T,SUMT>( by, MAP(by, m.sy, m.uy), filter, &filterParamsY, mSrcHeight, false, &mYWeights[by] );
 	}
 
-	for( size_t chan = 0; chan < srcChannels.size(); ++chan ) {
-		for ( int32_t dstY = 0; dstY < dstHeight; ++dstY ) {     // loop over dest scanlines
-			// prepare a weight table for dest y position by
-			makeWeightTable<T,typename SCALETRAIT<T>::SUMT>( dstY, MAP(dstY, m.sy, m.uy), filter, &filterParamsY, srcHeight, false, &yWeights );
+	return true;
+}
 
-			memset( accum.get(), 0, sizeof(int32_t) * dstWidth );
+// assumes channels are of same dimensions
+template<typename T>
+void resample( const vector<const ChannelT<T>*> &srcChannels, const FilterBase &filter, const Area &srcArea, const Area &dstArea, const vector<ChannelT<T>*> &dstChannels, int numThreads )
+{
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
 
-			// loop over source scanlines that influence this dest scanline
-			for ( int32_t ayf = yWeights.start; ayf < yWeights.end; ayf++ ) {
-				typename SCALETRAIT<T>::SUMT *line = linesBuffer[ayf % filterParamsY.width].second.get();
-				if( linesBuffer[ayf % filterParamsY.width].first != ayf ) {
-					scanlineFilterChannelToBuffer( xWeights, srcOffsetX, srcOffsetY + ayf, *(srcChannels[chan]), line, dstWidth );
-					linesBuffer[ayf % filterParamsY.width].first = ayf;
+	ResampleWeights<T> w;
+	if( ! w.setup( srcChannels[0]->getBounds(), Rectf( srcArea ), dstChannels[0]->getBounds(), dstArea, filter ) )
+		return;
+
+	const int32_t dstWidth = w.mDstWidth;
+
+	// each band of dest scanlines keeps its own cache of x-filtered source lines, so the result doesn't depend on how the rows are split
+	auto resampleRows = [&]( int32_t rowBegin, int32_t rowEnd ) {
+		vector<pair<int32_t,unique_ptr<SUMT[]>>> linesBuffer;
+		for( int32_t i = 0; i < w.mFilterHeight; i++ )
+			linesBuffer.push_back( std::make_pair( -1, unique_ptr<SUMT[]>( new SUMT[dstWidth] ) ) );
+		unique_ptr<SUMT[]> accum( new SUMT[dstWidth] );
+
+		for( size_t chan = 0; chan < srcChannels.size(); ++chan ) {
+			const ChannelT<T> &srcChannel = *(srcChannels[chan]);
+			ChannelT<T> *dstChannel = dstChannels[chan];
+			for( auto &line : linesBuffer )
+				line.first = -1;
+
+			for ( int32_t dstY = rowBegin; dstY < rowEnd; ++dstY ) {     // loop over dest scanlines
+				const WeightTable<SUMT> &yWeightTable = w.mYWeights[dstY];
+
+				memset( accum.get(), 0, sizeof(SUMT) * dstWidth );
+
+				// loop over source scanlines that influence this dest scanline
+				for ( int32_t ayf = yWeightTable.start; ayf < yWeightTable.end; ayf++ ) {
+					SUMT *line = linesBuffer[ayf % w.mFilterHeight].second.get();
+					if( linesBuffer[ayf % w.mFilterHeight].first != ayf ) {
+						scanlineFilterChannelToBuffer( w.mXWeights.data(), srcChannel.getData( w.mSrcOffsetX, w.mSrcOffsetY + ayf ), srcChannel.getIncrement(), line, dstWidth );
+						linesBuffer[ayf % w.mFilterHeight].first = ayf;
+					}
+					scanlineAccumulate<SUMT,SUMT>( yWeightTable.weight[ayf - yWeightTable.start], line, dstWidth, accum.get() );
 				}
-				scanlineAccumulate<typename SCALETRAIT<T>::SUMT,typename SCALETRAIT<T>::SUMT>( yWeights.weight[ayf - yWeights.start], line, dstWidth, accum.get() );
-			}
 
-			scanlineShiftAccumToChannel( accum.get(), clippedDstArea.getX1(), clippedDstArea.getY1() + dstY, dstWidth, dstChannels[chan] );
+				scanlineShiftAccumToChannel( accum.get(), dstChannel->getData( w.mDstArea.getX1(), w.mDstArea.getY1() + dstY ), dstChannel->getIncrement(), dstWidth );
+			}
 		}
-	}
+	};
 
-	free( xWeights );
-	free( xWeightBuffer );
-	free( yWeights.weight );
+	parallelForRows( 0, w.mDstHeight, numThreads, resampleRows );
 }
 
 template<typename LT, typename AT>
@@ -309,7 +360,7 @@ void makeWeightTable( int32_t b, float cen, const FilterBase &filter, const Filt
 }
 
 template<typename T>
-void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter, int numThreads )
 {
 	vector<const ChannelT<T>*> srcChannels;
 	vector<ChannelT<T>*> dstChannels;
@@ -325,11 +376,11 @@ void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *ds
 		dstChannels.push_back( &dstSurface->getChannelAlpha() );	
 	}
 
-	resample( srcChannels, filter, srcArea, dstArea, dstChannels );
+	resample( srcChannels, filter, srcArea, dstArea, dstChannels, numThreads );
 }
 
 template<typename T>
-void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter )
+void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter, int numThreads )
 {
 	vector<const ChannelT<T>*> srcChannels;
 	vector<ChannelT<T>*> dstChannels;
@@ -337,36 +388,145 @@ void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *ds
 	srcChannels.push_back( &srcChannel );
 	dstChannels.push_back( dstChannel );
 	
-	resample( srcChannels, filter, srcArea, dstArea, dstChannels );
+	resample( srcChannels, filter, srcArea, dstArea, dstChannels, numThreads );
 }
 
 template<typename T>
-void resize( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter )
+void resize( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter, int numThreads )
 {
-	resize( srcSurface, srcSurface.getBounds(), dstSurface, dstSurface->getBounds(), filter );
+	resize( srcSurface, srcSurface.getBounds(), dstSurface, dstSurface->getBounds(), filter, numThreads );
 }
 
 template<typename T>
-SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &dstSize, const FilterBase &filter )
+SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &dstSize, const FilterBase &filter, int numThreads )
 {
 	SurfaceT<T> result( dstSize.x, dstSize.y, srcSurface.hasAlpha(), srcSurface.getChannelOrder() );
-	resize( srcSurface, srcArea, &result, result.getBounds(), filter );
+	resize( srcSurface, srcArea, &result, result.getBounds(), filter, numThreads );
 	return result;
 }
 
 template<typename T>
-void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter )
+void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter, int numThreads )
 {
-	resize( srcChannel, srcChannel.getBounds(), dstChannel, dstChannel->getBounds(), filter );
+	resize( srcChannel, srcChannel.getBounds(), dstChannel, dstChannel->getBounds(), filter, numThreads );
 }
 
-#define resize_PROTOTYPES(r,data,T)\
-	template void resize( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter ); \
-	template void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter ); \
-	template void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter ); \
-	template SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &dstSize, const FilterBase &filter ); \
-	template void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter );
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ResizeStream
+template<typename T>
+class ResizeStreamImpl {
+  public:
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
+
+	ResizeStreamImpl( const ivec2 &srcSize, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter );
+
+	void	pushRow( const T *row );
+	void	emitRow( int32_t dstY );
+	SUMT*	getLine( int32_t ayf, uint8_t chan ) { return &mLines[( ( ayf % mWeights.mFilterHeight ) * mNumChannels + chan ) * mWeights.mDstWidth]; }
+
+	SurfaceT<T>				*mDstSurface;
+	ResampleWeights<T>		mWeights;
+	bool					mEmpty;
+	int32_t					mNumRowsPushed, mNextDstRow;
+	uint8_t					mPixelInc, mNumChannels;
+	uint8_t					mChannelOffsets[4];
+	vector<SUMT>			mLines;		// ring of mFilterHeight x-filtered source lines, one per channel
+	vector<SUMT>			mAccum;
+};
+
+template<typename T>
+ResizeStreamImpl<T>::ResizeStreamImpl( const ivec2 &srcSize, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+	: mDstSurface( dstSurface ), mNumRowsPushed( 0 ), mNextDstRow( 0 )
+{
+	const Area srcBounds( 0, 0, srcSize.x, srcSize.y );
+	mEmpty = ! mWeights.setup( srcBounds, Rectf( srcBounds ), dstSurface->getBounds(), dstArea, filter );
+
+	mPixelInc = dstSurface->getPixelInc();
+	mChannelOffsets[0] = dstSurface->getRedOffset();
+	mChannelOffsets[1] = dstSurface->getGreenOffset();
+	mChannelOffsets[2] = dstSurface->getBlueOffset();
+	mChannelOffsets[3] = dstSurface->getAlphaOffset();
+	mNumChannels = dstSurface->hasAlpha() ? 4 : 3;
+
+	if( ! mEmpty ) {
+		mLines.resize( mWeights.mFilterHeight * mNumChannels * mWeights.mDstWidth );
+		mAccum.resize( mWeights.mDstWidth );
+	}
+}
 
-BOOST_PP_SEQ_FOR_EACH( resize_PROTOTYPES, ~, CHANNEL_TYPES )
+template<typename T>
+void ResizeStreamImpl<T>::pushRow( const T *row )
+{
+	const int32_t ayf = mNumRowsPushed++ - mWeights.mSrcOffsetY;
+	if( mEmpty || ( ayf < 0 ) || ( ayf >= mWeights.mSrcHeight ) )
+		return;
+
+	const T *srcLine = row + mWeights.mSrcOffsetX * mPixelInc;
+	for( uint8_t chan = 0; chan < mNumChannels; ++chan )
+		scanlineFilterChannelToBuffer( mWeights.mXWeights.data(), srcLine + mChannelOffsets[chan], (int8_t)mPixelInc, getLine( ayf, chan ), mWeights.mDstWidth );
+
+	// the y weight tables are ordered, so every dest row whose support ends here can be written now
+	while( ( mNextDstRow < mWeights.mDstHeight ) && ( mWeights.mYWeights[mNextDstRow].end <= ayf + 1 ) )
+		emitRow( mNextDstRow++ );
+}
+
+template<typename T>
+void ResizeStreamImpl<T>::emitRow( int32_t dstY )
+{
+	const WeightTable<SUMT> &yWeightTable = mWeights.mYWeights[dstY];
+	T *dstLine = mDstSurface->getData( ivec2( mWeights.mDstArea.getX1(), mWeights.mDstArea.getY1() + dstY ) );
+
+	for( uint8_t chan = 0; chan < mNumChannels; ++chan ) {
+		memset( mAccum.data(), 0, sizeof(SUMT) * mWeights.mDstWidth );
+		for( int32_t ayf = yWeightTable.start; ayf < yWeightTable.end; ayf++ )
+			scanlineAccumulate<SUMT,SUMT>( yWeightTable.weight[ayf - yWeightTable.start], getLine( ayf, chan ), mWeights.mDstWidth, mAccum.data() );
+		scanlineShiftAccumToChannel( mAccum.data(), dstLine + mChannelOffsets[chan], (int8_t)mPixelInc, mWeights.mDstWidth );
+	}
+}
+
+template<typename T>
+ResizeStream<T>::ResizeStream( const ivec2 &srcSize, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+	: mImpl( new ResizeStreamImpl<T>( srcSize, dstSurface, dstArea, filter ) )
+{
+}
+
+template<typename T>
+ResizeStream<T>::ResizeStream( const ivec2 &srcSize, SurfaceT<T> *dstSurface, const FilterBase &filter )
+	: mImpl( new ResizeStreamImpl<T>( srcSize, dstSurface, dstSurface->getBounds(), filter ) )
+{
+}
+
+template<typename T>
+ResizeStream<T>::~ResizeStream()
+{
+}
+
+template<typename T>
+void ResizeStream<T>::pushRow( const T *row )
+{
+	mImpl->pushRow( row );
+}
+
+template<typename T>
+int32_t ResizeStream<T>::getNumRowsPushed() const
+{
+	return mImpl->mNumRowsPushed;
+}
+
+template<typename T>
+bool ResizeStream<T>::isComplete() const
+{
+	return mImpl->mEmpty || ( mImpl->mNextDstRow >= mImpl->mWeights.mDstHeight );
+}
+
+#define resize_PROTOTYPES(r,data,T)\
+	template void resize( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter, int numThreads ); \
+	template void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter, int numThreads ); \
+	template void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter, int numThreads ); \
+	template SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, const ivec2 &dstSize, const FilterBase &filter, int numThreads ); \
+	template void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter, int numThreads ); \
+	template class ResizeStream<T>;
+
+BOOST_PP_SEQ_FOR_EACH( resize_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
 
 } } // namespace cinder::ip
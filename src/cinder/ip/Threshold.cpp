@@ -23,7 +23,6 @@
 #include "cinder/ip/Threshold.h"
 #include "cinder/ChanTraits.h"
 
-#include <stdlib.h>
 #include <boost/preprocessor/seq.hpp>
 
 
@@ -121,9 +120,9 @@ void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel
 }
 
 template<typename T>
-void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, typename CHANTRAIT<T>::Accum *integralImage, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel )
+void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, const IntegralImageT<T> &integralImage, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
+	typedef typename IntegralImageT<T>::SumT SUMT; 
 
 	int32_t imageWidth = srcChannel->getWidth();
 	int32_t imageHeight = srcChannel->getHeight();
@@ -155,11 +154,8 @@ void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, typename CHANTRA
 			
 			int32_t count = ( x2 - x1 ) * ( y2 - y1 );
 
-			// I(x,y)=s(x2,y2)-s(x1,y2)-s(x2,y1)+s(x1,x1)
-			SUMT sum =	integralImage[y2 * imageWidth + x2] -
-						integralImage[y1 * imageWidth + x2] -
-						integralImage[y2 * imageWidth + x1] +
-						integralImage[y1 * imageWidth + x1];
+			// sum of the region (x1,y1]x(x2,y2]; the integral image is offset by one row and column
+			SUMT sum = integralImage.getSum( x1 + 1, y1 + 1, x2 + 1, y2 + 1 );
 
 			*dst = ( (SUMT)(*src * count) < (sum * comparisonMult / 256) ) ? 0 : maxValue;
 			dst += dstInc;
@@ -169,9 +165,9 @@ void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, typename CHANTRA
 }
 
 template<typename T>
-void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, typename CHANTRAIT<T>::Accum *integralImage, int32_t windowSize, ChannelT<T> *dstChannel )
+void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, const IntegralImageT<T> &integralImage, int32_t windowSize, ChannelT<T> *dstChannel )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
+	typedef typename IntegralImageT<T>::SumT SUMT; 
 
 	int32_t imageWidth = srcChannel->getWidth();
 	int32_t imageHeight = srcChannel->getHeight();
@@ -199,11 +195,8 @@ void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, typename CHA
 			
 			int32_t count = ( x2 - x1 ) * ( y2 - y1 );
 
-			// I(x,y)=s(x2,y2)-s(x1,y2)-s(x2,y1)+s(x1,x1)
-			SUMT sum =	integralImage[y2 * imageWidth + x2] -
-						integralImage[y1 * imageWidth + x2] -
-						integralImage[y2 * imageWidth + x1] +
-						integralImage[y1 * imageWidth + x1];
+			// sum of the region (x1,y1]x(x2,y2]; the integral image is offset by one row and column
+			SUMT sum = integralImage.getSum( x1 + 1, y1 + 1, x2 + 1, y2 + 1 );
 
 			//*dst = ( (*dst * count) < sum ) ? 0 : maxValue;
 			int32_t diffSignExtended = (int32_t)( sum - *src * count );
@@ -217,135 +210,55 @@ void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, typename CHA
 }
 
 template<typename T>
-void calculateIntegralImage( const ChannelT<T> &channel, typename CHANTRAIT<T>::Accum *integralImage )
+void adaptiveThreshold( const IntegralImageT<T> &integralImage, const ChannelT<T> &srcChannel, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel )
 {
-	int32_t imageWidth = channel.getWidth(), imageHeight = channel.getHeight();
-	ptrdiff_t srcRowBytes = channel.getRowBytes();
-	uint8_t srcInc = channel.getIncrement();
-	const T *src = channel.getData();
-	/*for( int32_t i = 0; i < imageWidth; i++ ) {
-		// reset this column sum
-		typename CHANTRAIT<T>::Accum sum = 0;
-
-		for( int32_t j = 0; j < imageHeight; j++ ) {
-			uint32_t index = j * imageWidth + i;
-
-			sum += src[j*srcRowBytes+i*srcInc];
-			if( i == 0 )
-				integralImage[index] = sum;
-			else
-				integralImage[index] = integralImage[index-1] + sum;
-		}
-	}*/
-	for( int32_t j = 0; j < imageHeight; j++ ) {
-		// reset this column sum
-		typename CHANTRAIT<T>::Accum sum = 0;
-
-		for( int32_t i = 0; i < imageWidth; i++ ) {		
-			uint32_t index = j * imageWidth + i;
-
-			sum += src[j*srcRowBytes+i*srcInc];
-			if( j == 0 )
-				integralImage[index] = sum;
-			else
-				integralImage[index] = integralImage[index-imageWidth] + sum;
-		}
-	}
+	if( percentageDelta < 0.0001f )
+		calculateAdaptiveThresholdZero( &srcChannel, integralImage, windowSize, dstChannel );
+	else
+		calculateAdaptiveThreshold( &srcChannel, integralImage, windowSize, percentageDelta, dstChannel );
 }
 
 template<typename T>
 void adaptiveThreshold( const ChannelT<T> &srcChannel, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
-
-	int32_t imageWidth = srcChannel.getWidth();
-	int32_t imageHeight = srcChannel.getHeight();
-	SUMT *integralImage;
-
-	// create the integral image
-	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
-	calculateIntegralImage( srcChannel, integralImage );
-	
+	IntegralImageT<T> integralImage( srcChannel );
 	calculateAdaptiveThreshold( &srcChannel, integralImage, windowSize, percentageDelta, dstChannel );
-
-	free( integralImage );	
 }
 
 template<typename T>
 void adaptiveThreshold( ChannelT<T> *channel, int32_t windowSize, float percentageDelta )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
-
-	int32_t imageWidth = channel->getWidth();
-	int32_t imageHeight = channel->getHeight();
-	SUMT *integralImage;
-
-	// create the integral image
-	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
-	calculateIntegralImage( *channel, integralImage );
-
+	IntegralImageT<T> integralImage( *channel );
 	calculateAdaptiveThreshold( channel, integralImage, windowSize, percentageDelta, channel );
-
-	free( integralImage );	
 }
 
 template<typename T>
 void adaptiveThresholdZero( ChannelT<T> *channel, int32_t windowSize )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
-
-	int32_t imageWidth = channel->getWidth();
-	int32_t imageHeight = channel->getHeight();
-	SUMT *integralImage;
-
-	// create the integral image
-	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
-	calculateIntegralImage( *channel, integralImage );
-	
+	IntegralImageT<T> integralImage( *channel );
 	calculateAdaptiveThresholdZero( channel, integralImage, windowSize, channel );
-
-	free( integralImage );	
 }
 
 template<typename T>
 void adaptiveThresholdZero( const ChannelT<T> &srcChannel, int32_t windowSize, ChannelT<T> *dstChannel )
 {
-	typedef typename CHANTRAIT<T>::Accum SUMT; 
-
-	int32_t imageWidth = srcChannel.getWidth();
-	int32_t imageHeight = srcChannel.getHeight();
-	SUMT *integralImage;
-
-	// create the integral image
-	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
-	calculateIntegralImage( srcChannel, integralImage );
-	
+	IntegralImageT<T> integralImage( srcChannel );
 	calculateAdaptiveThresholdZero( &srcChannel, integralImage, windowSize, dstChannel );
-
-	free( integralImage );	
 }
 
 template<typename T>
 AdaptiveThresholdT<T>::AdaptiveThresholdT( const ChannelT<T> *channel )
-	: mChannel( channel )
+	: mChannel( channel ), mIntegralImage( *channel )
 {
 	mImageWidth = mChannel->getWidth();
 	mImageHeight = mChannel->getHeight();
 	mIncrement = mChannel->getIncrement();
-
-	// create the integral image
-	mIntegralImage.resize( mImageWidth * mImageHeight );
-	calculateIntegralImage( *channel, mIntegralImage.data() );
 }
 
 template<typename T>
 void AdaptiveThresholdT<T>::calculate( int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel )
 {
-	if( percentageDelta < 0.0001f ) {
-		calculateAdaptiveThresholdZero( mChannel, mIntegralImage.data(), windowSize, dstChannel );
-	} else {
-		calculateAdaptiveThreshold( mChannel, mIntegralImage.data(), windowSize, percentageDelta, dstChannel );
-	}
+	adaptiveThreshold( mIntegralImage, *mChannel, windowSize, percentageDelta, dstChannel );
 }
 
 template class AdaptiveThresholdT<uint8_t>;
@@ -357,6 +270,7 @@ template class AdaptiveThresholdT<float>;
 	template void threshold( const SurfaceT<T> &srcSurface, T value, SurfaceT<T> *dstSurface );\
 	template void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel );\
 	template void adaptiveThreshold( const ChannelT<T> &srcChannel, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel ); \
+	template void adaptiveThreshold( const IntegralImageT<T> &integralImage, const ChannelT<T> &srcChannel, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel ); \
 	template void adaptiveThreshold( ChannelT<T> *channel, int32_t windowSize, float percentageDelta ); \
 	template void adaptiveThresholdZero( ChannelT<T> *channel, int32_t windowSize ); \
 	template void adaptiveThresholdZero( const ChannelT<T> &srcChannel, int32_t windowSize, ChannelT<T> *dstChannel );
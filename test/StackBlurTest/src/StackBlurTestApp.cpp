@@ -2,6 +2,7 @@
 #include "cinder/app/RendererGl.h"
 #include "cinder/gl/gl.h"
 #include "cinder/ip/Blur.h"
+#include "cinder/CinderSimd.h"
 
 using namespace ci;
 using namespace ci::app;
@@ -26,6 +27,7 @@ class StackBlurTestApp : public App {
 void StackBlurTestApp::setup()
 {
 	mSourceImage = SurfaceT<T>( loadImage( loadAsset( "great_wall.jpg" ) ) );
+	mSourceChannel = ChannelT<T>( mSourceImage );
 	setWindowSize( mSourceImage.getSize() );
 	mBlurredImage = SurfaceT<T>( mSourceImage.getWidth(), mSourceImage.getHeight(), true, SurfaceChannelOrder::RGBA );
 	mBlurredImage.copyFrom( mSourceImage, mSourceImage.getBounds() );
@@ -48,17 +50,45 @@ void StackBlurTestApp::keyDown( KeyEvent event )
 
 void StackBlurTestApp::profile()
 {
-	mBlurredImage.copyFrom( mSourceImage, mSourceImage.getBounds() );
+	// compares the scalar implementation against the SIMD kernels available on this machine
+	const pair<simd::Level, string> levels[] = { { simd::Level::SCALAR, "scalar" }, { simd::Level::SSE2, "SSE2" }, { simd::Level::AVX2, "AVX2" } };
+	const simd::Level prevMaxLevel = simd::getMaxLevel();
+
+	for( const auto &level : levels ) {
+		simd::setMaxLevel( level.first );
+		if( simd::getLevel() != level.first )
+			continue;
+
+		mBlurredImage.copyFrom( mSourceImage, mSourceImage.getBounds() );
+		ChannelT<T> blurredChannel = mSourceChannel.clone();
+
+		Timer timer( true );
+		const int maxRadius = 777;
+		const int iterations = 1;
+		for( int radius = 0; radius < maxRadius; radius += 1 )
+			for( int i = 0; i < iterations; ++i )
+				ip::stackBlur( &mBlurredImage, radius );
+		timer.stop();
+		console() << level.second << ": " << iterations * maxRadius << " Surface iterations in " << timer.getSeconds() << std::endl;
 
+		timer.start();
+		for( int radius = 0; radius < maxRadius; radius += 1 )
+			for( int i = 0; i < iterations; ++i )
+				ip::stackBlur( &blurredChannel, radius );
+		timer.stop();
+		console() << level.second << ": " << iterations * maxRadius << " Channel iterations in " << timer.getSeconds() << std::endl;
+	}
+
+	simd::setMaxLevel( prevMaxLevel );
+
+	// the exact separable Gaussian, whose cost grows with sigma, at roughly the sigma of each stackBlur radius
+	mBlurredImage.copyFrom( mSourceImage, mSourceImage.getBounds() );
+	const int maxGaussianRadius = 100;
 	Timer timer( true );
-	const int maxRadius = 777;
-	const int iterations = 1;
-	for( int radius = 0; radius < maxRadius; radius += 1 )
-		for( int i = 0; i < iterations; ++i )
-			ip::stackBlur( &mBlurredImage, radius );
-	
+	for( int radius = 1; radius < maxGaussianRadius; radius += 1 )
+		ip::gaussianBlur( &mBlurredImage, radius / 2.5f, 0 );
 	timer.stop();
-	console() << iterations * maxRadius << " iterations in " << timer.getSeconds() << std::endl;
+	console() << "gaussianBlur: " << maxGaussianRadius - 1 << " Surface iterations in " << timer.getSeconds() << std::endl;
 }
 
 void StackBlurTestApp::draw()
@@ -0,0 +1,137 @@
+#include "cinder/ip/Blend.h"
+#include "cinder/ip/Premultiply.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/CinderSimd.h"
+
+#include "catch.hpp"
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+// Fills \a surface with a repeatable pattern, keeping colors <= alpha when it's premultiplied
+Surface8u makeSurface( int32_t width, int32_t height, SurfaceChannelOrder order, bool premultiplied, uint32_t seed )
+{
+	Surface8u result( width, height, order.hasAlpha(), order );
+	result.setPremultiplied( premultiplied );
+	auto iter = result.getIter();
+	while( iter.line() ) {
+		while( iter.pixel() ) {
+			seed = seed * 1664525u + 1013904223u;
+			const uint8_t alpha = ( seed >> 24 ) % 3 == 0 ? 255 : (uint8_t)( seed >> 16 );
+			const uint8_t maxColor = premultiplied ? alpha : 255;
+			iter.r() = (uint8_t)( ( seed >> 8 ) % ( maxColor + 1 ) );
+			iter.g() = (uint8_t)( ( seed >> 4 ) % ( maxColor + 1 ) );
+			iter.b() = (uint8_t)( seed % ( maxColor + 1 ) );
+			if( result.hasAlpha() )
+				iter.a() = alpha;
+		}
+	}
+	return result;
+}
+
+// The same pattern as makeSurface(), scaled to [0, 1]
+Surface32f makeSurface32f( int32_t width, int32_t height, SurfaceChannelOrder order, bool premultiplied, uint32_t seed )
+{
+	const Surface8u pattern = makeSurface( width, height, order, premultiplied, seed );
+	Surface32f result( width, height, order.hasAlpha(), order );
+	result.setPremultiplied( premultiplied );
+	for( int32_t y = 0; y < height; ++y )
+		for( int32_t x = 0; x < width * result.getPixelInc(); ++x )
+			result.getData( ivec2( 0, y ) )[x] = CHANTRAIT<float>::convert( pattern.getData( ivec2( 0, y ) )[x] );
+	return result;
+}
+
+template<typename T>
+bool isEqual( const SurfaceT<T> &a, const SurfaceT<T> &b )
+{
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		if( ! equal( a.getData( ivec2( 0, y ) ), a.getData( ivec2( 0, y ) ) + a.getWidth() * a.getPixelInc(), b.getData( ivec2( 0, y ) ) ) )
+			return false;
+	return true;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Blend", "Vectorized")
+{
+	SECTION("Vector kernels match the scalar path")
+	{
+		const SurfaceChannelOrder orders[] = { SurfaceChannelOrder::RGBA, SurfaceChannelOrder::BGRA, SurfaceChannelOrder::ARGB, SurfaceChannelOrder::RGBX };
+		for( const auto &backgroundOrder : orders ) {
+			for( const auto &foregroundOrder : orders ) {
+				for( int premult = 0; premult < 4; ++premult ) {
+					const Surface8u background = makeSurface( 41, 17, backgroundOrder, ( premult & 1 ) && backgroundOrder.hasAlpha(), 1 );
+					const Surface8u foreground = makeSurface( 37, 13, foregroundOrder, ( premult & 2 ) && foregroundOrder.hasAlpha(), 2 );
+					Surface8u scalar = background.clone(), vectorized = background.clone();
+					{
+						simd::ScopedMaxLevel scopedLevel( simd::Level::SCALAR );
+						ip::blend( &scalar, foreground, foreground.getBounds(), ivec2( 3, 2 ) );
+					}
+					ip::blend( &vectorized, foreground, foreground.getBounds(), ivec2( 3, 2 ) );
+					REQUIRE( isEqual( scalar, vectorized ) );
+				}
+			}
+		}
+	}
+
+	SECTION("Vector kernels match the scalar path for float Surfaces")
+	{
+		const SurfaceChannelOrder orders[] = { SurfaceChannelOrder::RGBA, SurfaceChannelOrder::BGRA, SurfaceChannelOrder::ARGB, SurfaceChannelOrder::RGBX };
+		for( const auto &backgroundOrder : orders ) {
+			for( const auto &foregroundOrder : orders ) {
+				for( int premult = 0; premult < 4; ++premult ) {
+					const Surface32f background = makeSurface32f( 41, 17, backgroundOrder, ( premult & 1 ) && backgroundOrder.hasAlpha(), 1 );
+					const Surface32f foreground = makeSurface32f( 37, 13, foregroundOrder, ( premult & 2 ) && foregroundOrder.hasAlpha(), 2 );
+					Surface32f scalar = background.clone(), vectorized = background.clone(), layered = background.clone();
+					{
+						simd::ScopedMaxLevel scopedLevel( simd::Level::SCALAR );
+						ip::blend( &scalar, foreground, foreground.getBounds(), ivec2( 3, 2 ) );
+					}
+					ip::blend( &vectorized, foreground, foreground.getBounds(), ivec2( 3, 2 ) );
+					ip::blend( &layered, { ip::BlendLayer32f( &foreground, ivec2( 3, 2 ) ) }, 2 );
+					REQUIRE( isEqual( scalar, vectorized ) );
+					REQUIRE( isEqual( scalar, layered ) );
+				}
+			}
+		}
+	}
+
+	SECTION("Layers match sequential blends")
+	{
+		const Surface8u background = makeSurface( 64, 40, SurfaceChannelOrder::RGBA, true, 3 );
+		const Surface8u layer1 = makeSurface( 30, 30, SurfaceChannelOrder::BGRA, false, 4 );
+		const Surface8u layer2 = makeSurface( 50, 20, SurfaceChannelOrder::RGBA, true, 5 );
+		Surface8u sequential = background.clone(), layered = background.clone();
+		ip::blend( &sequential, layer1, layer1.getBounds(), ivec2( -5, 3 ) );
+		ip::blend( &sequential, layer2, layer2.getBounds(), ivec2( 20, 25 ) );
+		ip::blend( &layered, { ip::BlendLayer( &layer1, ivec2( -5, 3 ) ), ip::BlendLayer( &layer2, ivec2( 20, 25 ) ) }, 3 );
+		REQUIRE( isEqual( sequential, layered ) );
+	}
+
+	SECTION("Vectorized premultiply matches the scalar path")
+	{
+		const Surface8u source = makeSurface( 67, 9, SurfaceChannelOrder::ARGB, false, 6 );
+		Surface8u scalar = source.clone(), vectorized = source.clone();
+		{
+			simd::ScopedMaxLevel scopedLevel( simd::Level::SCALAR );
+			ip::premultiply( &scalar );
+			ip::unpremultiply( &scalar );
+		}
+		ip::premultiply( &vectorized );
+		ip::unpremultiply( &vectorized );
+		REQUIRE( isEqual( scalar, vectorized ) );
+
+		const Surface32f source32f = makeSurface32f( 67, 9, SurfaceChannelOrder::ARGB, false, 6 );
+		Surface32f scalar32f = source32f.clone(), vectorized32f = source32f.clone();
+		{
+			simd::ScopedMaxLevel scopedLevel( simd::Level::SCALAR );
+			ip::premultiply( &scalar32f );
+			ip::unpremultiply( &scalar32f );
+		}
+		ip::premultiply( &vectorized32f );
+		ip::unpremultiply( &vectorized32f );
+		REQUIRE( isEqual( scalar32f, vectorized32f ) );
+	}
+}
@@ -0,0 +1,137 @@
+#include "cinder/ip/BlockCompress.h"
+#include "cinder/ip/Fill.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/Rand.h"
+
+#include "catch.hpp"
+
+#include <cstring>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+vector<uint8_t> compress( const Surface8u &surface, ip::BlockFormat format, ip::BlockQuality quality = ip::BlockQuality::NORMAL, int numThreads = 1 )
+{
+	vector<uint8_t> result( ip::calcBlockCompressedSize( format, surface.getSize() ) );
+	ip::blockCompress( surface, format, result.data(), quality, numThreads );
+	return result;
+}
+
+Surface8u roundTrip( const Surface8u &surface, ip::BlockFormat format, ip::BlockQuality quality = ip::BlockQuality::NORMAL )
+{
+	Surface8u result( surface.getWidth(), surface.getHeight(), true );
+	ip::blockDecompress( compress( surface, format, quality ).data(), format, &result );
+	return result;
+}
+
+// Returns the root mean squared error of the first numChannels channels, red first
+double calcRmse( const Surface8u &a, const Surface8u &b, int numChannels )
+{
+	double sum = 0;
+	for( int32_t y = 0; y < a.getHeight(); ++y ) {
+		for( int32_t x = 0; x < a.getWidth(); ++x ) {
+			const ColorA8u p = a.getPixel( ivec2( x, y ) ), q = b.getPixel( ivec2( x, y ) );
+			for( int c = 0; c < numChannels; ++c )
+				sum += ( p[c] - q[c] ) * ( p[c] - q[c] );
+		}
+	}
+	return sqrt( sum / ( a.getWidth() * a.getHeight() * numChannels ) );
+}
+
+// Smooth gradients with a little noise, like photographic content
+Surface8u makeTestImage( int32_t width, int32_t height )
+{
+	Surface8u result( width, height, true );
+	Rand rand( 11 );
+	for( int32_t y = 0; y < height; ++y ) {
+		for( int32_t x = 0; x < width; ++x ) {
+			auto noisy = [&]( float v ) { return uint8_t( constrain( v + rand.nextFloat( -4, 4 ), 0.0f, 255.0f ) ); };
+			result.setPixel( ivec2( x, y ), ColorA8u( noisy( x * 255.0f / width ), noisy( y * 255.0f / height ), noisy( 128 + 100 * sin( x * 0.1f ) ), noisy( ( x + y ) * 255.0f / ( width + height ) ) ) );
+		}
+	}
+	return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "BlockCompress" )
+{
+	SECTION( "sizes are padded to whole blocks" )
+	{
+		REQUIRE( ip::calcBlockCompressedSize( ip::BlockFormat::BC1, ivec2( 8, 8 ) ) == 32 );
+		REQUIRE( ip::calcBlockCompressedSize( ip::BlockFormat::BC3, ivec2( 5, 7 ) ) == 64 );
+		REQUIRE( ip::calcBlockCompressedSize( ip::BlockFormat::BC4, ivec2( 1, 1 ) ) == 8 );
+		REQUIRE( ip::calcBlockCompressedSize( ip::BlockFormat::BC5, ivec2( 16, 4 ) ) == 64 );
+	}
+
+	SECTION( "solid colors survive exactly" )
+	{
+		Surface8u surface( 8, 8, true );
+		ip::fill( &surface, ColorA8u( 255, 0, 255, 77 ) );
+		for( auto quality : { ip::BlockQuality::FAST, ip::BlockQuality::NORMAL, ip::BlockQuality::HIGH } ) {
+			REQUIRE( roundTrip( surface, ip::BlockFormat::BC3, quality ).getPixel( ivec2( 3, 5 ) ) == ColorA8u( 255, 0, 255, 77 ) );
+			REQUIRE( roundTrip( surface, ip::BlockFormat::BC5, quality ).getPixel( ivec2( 7, 7 ) ) == ColorA8u( 255, 0, 0, 255 ) );
+		}
+	}
+
+	SECTION( "gradients compress with small error" )
+	{
+		Surface8u surface = makeTestImage( 61, 35 );
+		Surface8u opaque( surface.getWidth(), surface.getHeight(), false );
+		opaque.copyFrom( surface, surface.getBounds() );
+		const double fast = calcRmse( opaque, roundTrip( opaque, ip::BlockFormat::BC1, ip::BlockQuality::FAST ), 3 );
+		const double normal = calcRmse( opaque, roundTrip( opaque, ip::BlockFormat::BC1, ip::BlockQuality::NORMAL ), 3 );
+		const double high = calcRmse( opaque, roundTrip( opaque, ip::BlockFormat::BC1, ip::BlockQuality::HIGH ), 3 );
+		INFO( "fast " << fast << " normal " << normal << " high " << high );
+		REQUIRE( fast < 8 );
+		REQUIRE( normal < fast );
+		REQUIRE( high <= normal );
+
+		Surface8u alpha = roundTrip( surface, ip::BlockFormat::BC3 );
+		double alphaError = 0;
+		for( int32_t y = 0; y < surface.getHeight(); ++y )
+			for( int32_t x = 0; x < surface.getWidth(); ++x )
+				alphaError = std::max<double>( alphaError, std::abs( surface.getPixel( ivec2( x, y ) ).a - alpha.getPixel( ivec2( x, y ) ).a ) );
+		REQUIRE( alphaError <= 4 );
+		REQUIRE( calcRmse( surface, roundTrip( surface, ip::BlockFormat::BC5 ), 2 ) < 2 );
+	}
+
+	SECTION( "BC1 alpha below 128 becomes transparent" )
+	{
+		Surface8u surface( 4, 4, true );
+		ip::fill( &surface, ColorA8u( 40, 200, 90, 255 ) );
+		surface.setPixel( ivec2( 2, 1 ), ColorA8u( 0, 0, 0, 10 ) );
+		Surface8u decoded = roundTrip( surface, ip::BlockFormat::BC1 );
+		REQUIRE( decoded.getPixel( ivec2( 2, 1 ) ).a == 0 );
+		REQUIRE( decoded.getPixel( ivec2( 0, 0 ) ).a == 255 );
+		REQUIRE( std::abs( decoded.getPixel( ivec2( 0, 0 ) ).g - 200 ) <= 2 );
+	}
+
+	SECTION( "BC4 compresses Channels" )
+	{
+		Channel8u channel( 9, 6 );
+		for( int32_t y = 0; y < 6; ++y )
+			for( int32_t x = 0; x < 9; ++x )
+				channel.setValue( ivec2( x, y ), ( x % 2 ) ? 255 : 0 );
+		vector<uint8_t> data( ip::calcBlockCompressedSize( ip::BlockFormat::BC4, channel.getSize() ) );
+		ip::blockCompress( channel, data.data() );
+		Surface8u decoded( 9, 6, false );
+		ip::blockDecompress( data.data(), ip::BlockFormat::BC4, &decoded );
+		REQUIRE( decoded.getPixel( ivec2( 8, 5 ) ).r == 0 );
+		REQUIRE( decoded.getPixel( ivec2( 7, 5 ) ).r == 255 );
+	}
+
+	SECTION( "threads and instruction sets produce identical blocks" )
+	{
+		Surface8u surface = makeTestImage( 130, 97 );
+		for( auto format : { ip::BlockFormat::BC1, ip::BlockFormat::BC3 } ) {
+			const vector<uint8_t> serial = compress( surface, format, ip::BlockQuality::HIGH, 1 );
+			REQUIRE( compress( surface, format, ip::BlockQuality::HIGH, 4 ) == serial );
+
+			simd::ScopedMaxLevel scopedLevel( simd::Level::SCALAR );
+			REQUIRE( compress( surface, format, ip::BlockQuality::HIGH, 1 ) == serial );
+		}
+	}
+}
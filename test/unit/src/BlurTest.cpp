@@ -0,0 +1,226 @@
+#include "cinder/ip/Blur.h"
+#include "cinder/CinderSimd.h"
+
+#include "catch.hpp"
+
+#include <cmath>
+#include <functional>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+void randomize( uint32_t &seed, uint8_t *v )	{ seed = seed * 1664525u + 1013904223u; *v = (uint8_t)( seed >> 24 ); }
+void randomize( uint32_t &seed, uint16_t *v )	{ seed = seed * 1664525u + 1013904223u; *v = (uint16_t)( seed >> 16 ); }
+void randomize( uint32_t &seed, float *v )		{ seed = seed * 1664525u + 1013904223u; *v = ( seed >> 8 ) / 16777216.0f; }
+
+template<typename T>
+SurfaceT<T> makeSurface( int32_t width, int32_t height, const SurfaceChannelOrder &order, uint32_t seed )
+{
+	SurfaceT<T> result( width, height, order.hasAlpha(), order );
+	for( int32_t y = 0; y < height; ++y )
+		for( int32_t x = 0; x < width * result.getPixelInc(); ++x )
+			randomize( seed, result.getData( ivec2( 0, y ) ) + x );
+	return result;
+}
+
+template<typename T>
+ChannelT<T> makeChannel( int32_t width, int32_t height, uint32_t seed )
+{
+	ChannelT<T> result( width, height );
+	for( int32_t y = 0; y < height; ++y )
+		for( int32_t x = 0; x < width; ++x )
+			randomize( seed, result.getData( x, y ) );
+	return result;
+}
+
+template<typename T>
+bool isEqual( const SurfaceT<T> &a, const SurfaceT<T> &b )
+{
+	if( a.getSize() != b.getSize() || !( a.getChannelOrder() == b.getChannelOrder() ) )
+		return false;
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		for( int32_t x = 0; x < a.getWidth() * a.getPixelInc(); ++x )
+			if( a.getData( ivec2( 0, y ) )[x] != b.getData( ivec2( 0, y ) )[x] )
+				return false;
+	return true;
+}
+
+template<typename T>
+bool isEqual( const ChannelT<T> &a, const ChannelT<T> &b )
+{
+	if( a.getSize() != b.getSize() )
+		return false;
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		for( int32_t x = 0; x < a.getWidth(); ++x )
+			if( a.getValue( ivec2( x, y ) ) != b.getValue( ivec2( x, y ) ) )
+				return false;
+	return true;
+}
+
+// Runs stackBlur on copies of \a surface over the full bounds and over an interior area, using the scalar path and then the widest vector path.
+template<typename T>
+bool stackBlurMatchesScalar( const SurfaceT<T> &surface, int radius )
+{
+	const Area area( 3, 5, surface.getWidth() - 7, surface.getHeight() - 2 );
+	SurfaceT<T> scalar = surface.clone(), scalarArea = surface.clone(), scalarChannel = surface.clone();
+	{
+		simd::ScopedMaxLevel scopedLevel( simd::Level::SCALAR );
+		ip::stackBlur( &scalar, radius );
+		ip::stackBlur( &scalarArea, area, radius );
+		ChannelT<T> green = scalarChannel.getChannelGreen();
+		ip::stackBlur( &green, area, radius );
+	}
+
+	SurfaceT<T> vector = surface.clone(), vectorArea = surface.clone(), vectorChannel = surface.clone();
+	ip::stackBlur( &vector, radius );
+	ip::stackBlur( &vectorArea, area, radius );
+	ChannelT<T> green = vectorChannel.getChannelGreen();
+	ip::stackBlur( &green, area, radius );
+
+	return isEqual( scalar, vector ) && isEqual( scalarArea, vectorArea ) && isEqual( scalarChannel, vectorChannel )
+			&& isEqual( scalar, ip::stackBlurCopy( surface, radius ) );
+}
+
+// Same as above for a packed Channel, whose rows are handled a strip of lanes at a time
+template<typename T>
+bool stackBlurChannelMatchesScalar( const ChannelT<T> &channel, int radius )
+{
+	ChannelT<T> scalar = channel.clone();
+	{
+		simd::ScopedMaxLevel scopedLevel( simd::Level::SCALAR );
+		ip::stackBlur( &scalar, radius );
+	}
+
+	ChannelT<T> vector = channel.clone();
+	ip::stackBlur( &vector, radius );
+	return isEqual( scalar, vector ) && isEqual( scalar, ip::stackBlurCopy( channel, radius ) );
+}
+
+// Brute force 2D convolution of \a channel with the separable kernel \a weight( k ) for k in [-radius, radius], repeating the edge pixels
+template<typename T>
+vector<double> convolveReference( const ChannelT<T> &channel, int radius, const function<double( int )> &weight )
+{
+	const int32_t width = channel.getWidth(), height = channel.getHeight();
+	vector<double> result( width * height );
+	for( int32_t y = 0; y < height; ++y ) {
+		for( int32_t x = 0; x < width; ++x ) {
+			double sum = 0;
+			for( int dy = -radius; dy <= radius; ++dy )
+				for( int dx = -radius; dx <= radius; ++dx )
+					sum += weight( dx ) * weight( dy ) * channel.getValue( ivec2( x + dx, y + dy ) );
+			result[y * width + x] = sum;
+		}
+	}
+	return result;
+}
+
+template<typename T>
+double maxReferenceError( const ChannelT<T> &channel, const vector<double> &reference )
+{
+	double result = 0;
+	for( int32_t y = 0; y < channel.getHeight(); ++y )
+		for( int32_t x = 0; x < channel.getWidth(); ++x )
+			result = std::max( result, std::abs( channel.getValue( ivec2( x, y ) ) - reference[y * channel.getWidth() + x] ) );
+	return result;
+}
+
+// Normalized Gaussian weights sampled at integer offsets out to 3 sigma
+function<double( int )> gaussianWeight( float sigma )
+{
+	const int radius = (int)std::ceil( sigma * 3 );
+	double sum = 0;
+	for( int k = -radius; k <= radius; ++k )
+		sum += std::exp( -( k * k ) / ( 2.0 * sigma * sigma ) );
+	return [=]( int k ) { return std::exp( -( k * k ) / ( 2.0 * sigma * sigma ) ) / sum; };
+}
+
+} // anonymous namespace
+
+TEST_CASE("StackBlur", "SIMD")
+{
+	// odd sizes leave partial strips of lanes in both passes
+	SECTION("8u vector path matches the scalar path exactly")
+	{
+		for( int radius : { 1, 4, 31 } ) {
+			REQUIRE( stackBlurMatchesScalar( makeSurface<uint8_t>( 83, 47, SurfaceChannelOrder::RGBA, 1 ), radius ) );
+			REQUIRE( stackBlurMatchesScalar( makeSurface<uint8_t>( 61, 29, SurfaceChannelOrder::BGR, 2 ), radius ) );
+
+			const Channel8u channel = makeChannel<uint8_t>( 77, 43, 3 );
+			REQUIRE( stackBlurChannelMatchesScalar( channel, radius ) );
+		}
+	}
+
+	SECTION("16u vector path matches the scalar path exactly")
+	{
+		for( int radius : { 1, 6, 40 } ) {
+			REQUIRE( stackBlurMatchesScalar( makeSurface<uint16_t>( 83, 47, SurfaceChannelOrder::RGBA, 4 ), radius ) );
+			REQUIRE( stackBlurMatchesScalar( makeSurface<uint16_t>( 61, 29, SurfaceChannelOrder::RGB, 5 ), radius ) );
+
+			const Channel16u channel = makeChannel<uint16_t>( 77, 43, 6 );
+			REQUIRE( stackBlurChannelMatchesScalar( channel, radius ) );
+		}
+	}
+
+	SECTION("32f vector path matches the scalar path exactly")
+	{
+		for( int radius : { 1, 5, 24 } ) {
+			REQUIRE( stackBlurMatchesScalar( makeSurface<float>( 83, 47, SurfaceChannelOrder::RGBA, 7 ), radius ) );
+			REQUIRE( stackBlurMatchesScalar( makeSurface<float>( 61, 29, SurfaceChannelOrder::BGR, 8 ), radius ) );
+
+			const Channel32f channel = makeChannel<float>( 77, 43, 9 );
+			REQUIRE( stackBlurChannelMatchesScalar( channel, radius ) );
+		}
+	}
+}
+
+TEST_CASE("SeparableBlur", "Threads")
+{
+	// an odd number of rows that doesn't divide evenly between the threads
+	const Surface8u surface8u = makeSurface<uint8_t>( 97, 53, SurfaceChannelOrder::RGBA, 10 );
+	const Surface32f surface32f = makeSurface<float>( 61, 37, SurfaceChannelOrder::RGB, 11 );
+
+	SECTION("Gaussian blur matches a brute force 2D convolution")
+	{
+		const float sigma = 2.5f;
+		const Channel32f channel = ip::gaussianBlurCopy( surface32f, sigma ).getChannelGreen();
+		REQUIRE( maxReferenceError( channel, convolveReference( surface32f.getChannelGreen(), 8, gaussianWeight( sigma ) ) ) < 1e-5 );
+
+		// 8 bit results are rounded to the nearest value
+		const Channel8u channel8u = ip::gaussianBlurCopy( surface8u.getChannelAlpha(), sigma );
+		REQUIRE( maxReferenceError( channel8u, convolveReference( surface8u.getChannelAlpha(), 8, gaussianWeight( sigma ) ) ) <= 0.5001 );
+	}
+
+	SECTION("Box blur matches a brute force 2D convolution, including a fractional radius")
+	{
+		for( float radius : { 3.0f, 2.25f } ) {
+			const int whole = (int)radius;
+			const double fraction = radius - whole;
+			auto weight = [=]( int k ) { return ( std::abs( k ) <= whole ? 1.0 : fraction ) / ( 2 * radius + 1 ); };
+
+			Channel32f channel = surface32f.getChannelRed().clone();
+			ip::boxBlur( &channel, radius, 3 );
+			REQUIRE( maxReferenceError( channel, convolveReference( surface32f.getChannelRed(), whole + 1, weight ) ) < 1e-5 );
+		}
+	}
+
+	SECTION("Results don't depend on the number of threads")
+	{
+		for( int numThreads : { 2, 3, 0 } ) {
+			REQUIRE( isEqual( ip::gaussianBlurCopy( surface8u, 3.3f, 1 ), ip::gaussianBlurCopy( surface8u, 3.3f, numThreads ) ) );
+			REQUIRE( isEqual( ip::boxBlurCopy( surface32f, 4.5f, 1 ), ip::boxBlurCopy( surface32f, 4.5f, numThreads ) ) );
+
+			const Area area( 5, 4, 90, 51 );
+			Surface8u single = surface8u.clone(), multi = surface8u.clone();
+			ip::gaussianBlur( &single, area, 1.7f, 1 );
+			ip::gaussianBlur( &multi, area, 1.7f, numThreads );
+			REQUIRE( isEqual( single, multi ) );
+
+			Channel32f singleChannel = surface32f.getChannelBlue().clone(), multiChannel = surface32f.getChannelBlue().clone();
+			ip::boxBlur( &singleChannel, 2.0f, 1 );
+			ip::boxBlur( &multiChannel, 2.0f, numThreads );
+			REQUIRE( isEqual( singleChannel, multiChannel ) );
+		}
+	}
+}
@@ -0,0 +1,101 @@
+#include "cinder/ip/Convert.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/CinderSimd.h"
+
+#include "catch.hpp"
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+const int sOrders[] = { SurfaceChannelOrder::RGBA, SurfaceChannelOrder::BGRA, SurfaceChannelOrder::ARGB, SurfaceChannelOrder::ABGR, SurfaceChannelOrder::RGBX,
+						SurfaceChannelOrder::BGRX, SurfaceChannelOrder::XRGB, SurfaceChannelOrder::XBGR, SurfaceChannelOrder::RGB, SurfaceChannelOrder::BGR };
+
+void randomize( uint32_t &seed, uint8_t *v )	{ seed = seed * 1664525u + 1013904223u; *v = (uint8_t)( seed >> 24 ); }
+void randomize( uint32_t &seed, uint16_t *v )	{ seed = seed * 1664525u + 1013904223u; *v = (uint16_t)( seed >> 16 ); }
+void randomize( uint32_t &seed, float *v )		{ seed = seed * 1664525u + 1013904223u; *v = ( seed >> 8 ) / 16777216.0f * 1.4f - 0.2f; }
+
+template<typename T>
+SurfaceT<T> makeSurface( int32_t width, int32_t height, int order )
+{
+	SurfaceT<T> result( width, height, SurfaceChannelOrder( order ).hasAlpha(), SurfaceChannelOrder( order ) );
+	uint32_t seed = order + 1;
+	for( int32_t y = 0; y < height; ++y )
+		for( int32_t x = 0; x < width * result.getPixelInc(); ++x )
+			randomize( seed, result.getData( ivec2( 0, y ) ) + x );
+	return result;
+}
+
+// Converts \a src to every channel order at every instruction set level, comparing against CHANTRAIT::convert() per element
+template<typename S, typename D>
+void testConvert()
+{
+	const Area srcArea( 3, 2, 3 + 45, 2 + 5 );
+	const ivec2 dstLT( 1, 1 );
+	for( int srcOrder : sOrders ) {
+		const SurfaceT<S> src = makeSurface<S>( 51, 9, srcOrder );
+		for( int dstOrder : sOrders ) {
+			for( auto level : { simd::Level::SCALAR, simd::Level::SSE2, simd::Level::AVX2 } ) {
+				simd::ScopedMaxLevel scopedLevel( level );
+				SurfaceT<D> dst = makeSurface<D>( 48, 8, dstOrder );
+				ip::convert( src, srcArea, &dst, dstLT, 2 );
+
+				const SurfaceChannelOrder &sco = src.getChannelOrder(), &dco = dst.getChannelOrder();
+				bool match = true;
+				for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
+					for( int32_t x = 0; x < srcArea.getWidth(); ++x ) {
+						const S *s = src.getData( srcArea.getUL() + ivec2( x, y ) );
+						const D *d = dst.getData( dstLT + ivec2( x, y ) );
+						const S alpha = sco.hasAlpha() ? s[sco.getAlphaOffset()] : CHANTRAIT<S>::max();
+						const S fourth = ( sco.getPixelInc() == 4 ) ? s[6 - sco.getRedOffset() - sco.getGreenOffset() - sco.getBlueOffset()] : CHANTRAIT<S>::max();
+						for( int e = 0; e < dco.getPixelInc(); ++e ) {
+							S expected = ( e == dco.getAlphaOffset() ) ? alpha : fourth;
+							if( e == dco.getRedOffset() ) expected = s[sco.getRedOffset()];
+							else if( e == dco.getGreenOffset() ) expected = s[sco.getGreenOffset()];
+							else if( e == dco.getBlueOffset() ) expected = s[sco.getBlueOffset()];
+							match = match && ( d[e] == CHANTRAIT<D>::convert( expected ) );
+						}
+					}
+				}
+				// pixels outside the destination area are untouched
+				const SurfaceT<D> untouched = makeSurface<D>( 48, 8, dstOrder );
+				match = match && memcmp( dst.getData(), untouched.getData(), dst.getRowBytes() ) == 0;
+				match = match && memcmp( dst.getData( ivec2( 0, 6 ) ), untouched.getData( ivec2( 0, 6 ) ), dst.getRowBytes() * 2 ) == 0;
+				match = match && dst.getPixel( ivec2( 0, 3 ) ) == untouched.getPixel( ivec2( 0, 3 ) ) && dst.getPixel( ivec2( 46, 3 ) ) == untouched.getPixel( ivec2( 46, 3 ) );
+				INFO( "src order " << srcOrder << ", dst order " << dstOrder << ", level " << (int)level );
+				REQUIRE( match );
+			}
+		}
+	}
+}
+
+} // anonymous namespace
+
+TEST_CASE("Convert", "Surface")
+{
+	SECTION("Channel order changes")
+	{
+		testConvert<uint8_t,uint8_t>();
+		testConvert<uint16_t,uint16_t>();
+		testConvert<float,float>();
+	}
+
+	SECTION("Depth changes")
+	{
+		testConvert<uint8_t,float>();
+		testConvert<float,uint8_t>();
+		testConvert<uint16_t,float>();
+		testConvert<float,uint16_t>();
+		testConvert<uint8_t,uint16_t>();
+		testConvert<uint16_t,uint8_t>();
+	}
+
+	SECTION("copyFrom converts channel orders")
+	{
+		Surface8u src = makeSurface<uint8_t>( 40, 4, SurfaceChannelOrder::BGRX );
+		Surface8u dst( 40, 4, true, SurfaceChannelOrder::RGBA );
+		dst.copyFrom( src, Area( 0, 0, 40, 4 ) );
+		REQUIRE( dst.getPixel( ivec2( 37, 2 ) ) == ColorA8u( src.getPixel( ivec2( 37, 2 ) ), 255 ) );
+	}
+}
@@ -0,0 +1,74 @@
+#include "cinder/DataSource.h"
+
+#include "catch.hpp"
+
+#include <cstring>
+#include <fstream>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+fs::path writeTestFile( const string &name, const string &contents )
+{
+	fs::path path = fs::temp_directory_path() / name;
+	ofstream( path.string(), ios::binary ) << contents;
+	return path;
+}
+
+string readTestFile( const fs::path &path )
+{
+	ifstream in( path.string(), ios::binary );
+	return string( istreambuf_iterator<char>( in ), istreambuf_iterator<char>() );
+}
+
+} // anonymous namespace
+
+TEST_CASE("DataSourceMapped", "DataSource")
+{
+	string contents( 100000, 0 );
+	for( size_t i = 0; i < contents.size(); ++i )
+		contents[i] = char( i * 31 + i / 256 );
+	const fs::path path = writeTestFile( "cinder_mapped_test.bin", contents );
+
+	SECTION("The Buffer holds the file's contents and outlives the DataSource")
+	{
+		BufferRef buffer;
+		for( auto hint : { DataSourceMapped::ACCESS_NORMAL, DataSourceMapped::ACCESS_SEQUENTIAL, DataSourceMapped::ACCESS_RANDOM, DataSourceMapped::ACCESS_WILL_NEED } ) {
+			DataSourceRef source = loadFileMapped( path, hint );
+			REQUIRE( source->isFilePath() );
+			REQUIRE( source->getFilePath() == path );
+			buffer = source->getBuffer();
+			REQUIRE( buffer->getSize() == contents.size() );
+			REQUIRE( memcmp( buffer->getData(), contents.data(), contents.size() ) == 0 );
+		}
+		REQUIRE( static_cast<const char*>( buffer->getData() )[contents.size() - 1] == contents.back() );
+	}
+
+	SECTION("Writing to the Buffer doesn't modify the file")
+	{
+		BufferRef buffer = loadFileMapped( path )->getBuffer();
+		memset( buffer->getData(), 0, 1000 );
+		REQUIRE( readTestFile( path ) == contents );
+		REQUIRE( loadFileMapped( path )->getBuffer()->getSize() == contents.size() );
+		buffer->resize( contents.size() + 10 );
+		REQUIRE( static_cast<const char*>( buffer->getData() )[2000] == contents[2000] );
+	}
+
+	SECTION("Streams read the mapped contents")
+	{
+		IStreamRef stream = loadFileMapped( path )->createStream();
+		REQUIRE( stream->getFileName() == path );
+		string read( contents.size(), 0 );
+		stream->readData( &read[0], read.size() );
+		REQUIRE( read == contents );
+		REQUIRE( stream->isEof() );
+	}
+
+	SECTION("Empty and missing files")
+	{
+		REQUIRE( loadFileMapped( writeTestFile( "cinder_mapped_empty.bin", "" ) )->getBuffer()->getSize() == 0 );
+		REQUIRE_THROWS_AS( loadFileMapped( fs::temp_directory_path() / "cinder_mapped_missing.bin" )->getBuffer(), const StreamExc& );
+	}
+}
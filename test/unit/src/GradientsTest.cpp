@@ -0,0 +1,62 @@
+#include "cinder/ip/EdgeDetect.h"
+#include "cinder/CinderSimd.h"
+
+#include "catch.hpp"
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+bool isEqual( const Channel32f &a, const Channel32f &b )
+{
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		if( ! equal( a.getData( 0, y ), a.getData( 0, y ) + a.getWidth(), b.getData( 0, y ) ) )
+			return false;
+	return true;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Gradients", "EdgeDetect")
+{
+	Channel8u channel( 45, 19 );
+	uint32_t seed = 1;
+	for( int32_t y = 0; y < channel.getHeight(); ++y ) {
+		for( int32_t x = 0; x < channel.getWidth(); ++x ) {
+			seed = seed * 1664525u + 1013904223u;
+			*channel.getData( x, y ) = (uint8_t)( seed >> 24 );
+		}
+	}
+
+	SECTION("Derivatives match the kernels, clamped at the edges")
+	{
+		for( auto kernel : { ip::GradientKernel::SOBEL, ip::GradientKernel::SCHARR } ) {
+			const float edge = ( kernel == ip::GradientKernel::SCHARR ) ? 3.0f : 1.0f, center = ( kernel == ip::GradientKernel::SCHARR ) ? 10.0f : 2.0f;
+			Channel32f dx( 45, 19 ), dy( 45, 19 ), magnitude( 45, 19 ), orientation( 45, 19 );
+			ip::gradients( channel, &dx, &dy, &magnitude, &orientation, kernel );
+			for( const ivec2 &p : { ivec2( 0, 0 ), ivec2( 7, 3 ), ivec2( 44, 10 ), ivec2( 20, 18 ) } ) {
+				auto v = [&]( int32_t x, int32_t y ) { return (float)channel.getValue( p + ivec2( x, y ) ); };
+				const float gx = edge * ( v( 1, -1 ) - v( -1, -1 ) ) + center * ( v( 1, 0 ) - v( -1, 0 ) ) + edge * ( v( 1, 1 ) - v( -1, 1 ) );
+				const float gy = edge * ( v( -1, 1 ) - v( -1, -1 ) ) + center * ( v( 0, 1 ) - v( 0, -1 ) ) + edge * ( v( 1, 1 ) - v( 1, -1 ) );
+				REQUIRE( dx.getValue( p ) == gx );
+				REQUIRE( dy.getValue( p ) == gy );
+				REQUIRE( magnitude.getValue( p ) == Approx( sqrt( gx * gx + gy * gy ) ) );
+				REQUIRE( abs( orientation.getValue( p ) - atan2( gy, gx ) ) < 1.2e-5f );
+			}
+		}
+	}
+
+	SECTION("Vector kernels and threads match the scalar path")
+	{
+		Channel32f scalar[4] = { Channel32f( 45, 19 ), Channel32f( 45, 19 ), Channel32f( 45, 19 ), Channel32f( 45, 19 ) };
+		Channel32f vectorized[4] = { Channel32f( 45, 19 ), Channel32f( 45, 19 ), Channel32f( 45, 19 ), Channel32f( 45, 19 ) };
+		{
+			simd::ScopedMaxLevel scopedLevel( simd::Level::SCALAR );
+			ip::gradients( channel, &scalar[0], &scalar[1], &scalar[2], &scalar[3], ip::GradientKernel::SCHARR );
+		}
+		ip::gradients( channel, &vectorized[0], &vectorized[1], &vectorized[2], &vectorized[3], ip::GradientKernel::SCHARR, 3 );
+		for( int i = 0; i < 4; ++i )
+			REQUIRE( isEqual( scalar[i], vectorized[i] ) );
+	}
+}
@@ -0,0 +1,277 @@
+#include "cinder/ip/Histogram.h"
+#include "cinder/CinderSimd.h"
+
+#include "catch.hpp"
+
+#include <numeric>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+void randomize( uint32_t &seed, uint16_t *v )	{ seed = seed * 1664525u + 1013904223u; *v = (uint16_t)( seed >> 16 ); }
+// floats reach outside [0, 1] to exercise the clamping of the first and last bins
+void randomize( uint32_t &seed, float *v )		{ seed = seed * 1664525u + 1013904223u; *v = ( seed >> 8 ) / 16777216.0f * 1.5f - 0.25f; }
+
+template<typename T>
+SurfaceT<T> makeSurface( int32_t width, int32_t height, const SurfaceChannelOrder &order, uint32_t seed )
+{
+	SurfaceT<T> result( width, height, order.hasAlpha(), order );
+	for( int32_t y = 0; y < height; ++y )
+		for( int32_t x = 0; x < width * result.getPixelInc(); ++x )
+			randomize( seed, result.getData( ivec2( 0, y ) ) + x );
+	return result;
+}
+
+template<typename T>
+bool isEqual( const SurfaceT<T> &a, const SurfaceT<T> &b )
+{
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		for( int32_t x = 0; x < a.getWidth() * a.getPixelInc(); ++x )
+			if( a.getData( ivec2( 0, y ) )[x] != b.getData( ivec2( 0, y ) )[x] )
+				return false;
+	return true;
+}
+
+// Returns the statistics of \a channel computed directly in double precision
+template<typename T>
+ip::StatisticsT<T> bruteForceStatistics( const ChannelT<T> &channel )
+{
+	ip::StatisticsT<T> result;
+	result.mMin = result.mMax = channel.getValue( ivec2( 0 ) );
+	double sum = 0, sumSquares = 0;
+	for( int32_t y = 0; y < channel.getHeight(); ++y ) {
+		for( int32_t x = 0; x < channel.getWidth(); ++x ) {
+			const T v = channel.getValue( ivec2( x, y ) );
+			result.mMin = std::min( result.mMin, v );
+			result.mMax = std::max( result.mMax, v );
+			sum += v;
+			sumSquares += (double)v * v;
+		}
+	}
+	result.mCount = (uint64_t)channel.getWidth() * channel.getHeight();
+	result.mMean = sum / result.mCount;
+	result.mStdDev = sqrt( sumSquares / result.mCount - result.mMean * result.mMean );
+	return result;
+}
+
+template<typename T>
+void requireStatistics( const ip::StatisticsT<T> &stats, const ip::StatisticsT<T> &expected )
+{
+	REQUIRE( stats.mCount == expected.mCount );
+	REQUIRE( stats.mMin == expected.mMin );
+	REQUIRE( stats.mMax == expected.mMax );
+	REQUIRE( stats.mMean == Approx( expected.mMean ) );
+	REQUIRE( stats.mStdDev == Approx( expected.mStdDev ) );
+}
+
+} // anonymous namespace
+
+TEST_CASE("Histogram", "Statistics")
+{
+	Surface8u surface( 67, 21, true, SurfaceChannelOrder::BGRA );
+	uint32_t seed = 1;
+	auto iter = surface.getIter();
+	while( iter.line() ) {
+		while( iter.pixel() ) {
+			seed = seed * 1664525u + 1013904223u;
+			iter.r() = (uint8_t)( seed >> 24 );
+			iter.g() = (uint8_t)( seed >> 16 );
+			iter.b() = (uint8_t)( seed >> 8 ) & 0x0F;
+			iter.a() = 200;
+		}
+	}
+
+	SECTION("Statistics match brute force, for the scalar and vector paths")
+	{
+		uint32_t minValue = 255, maxValue = 0;
+		double sum = 0, sumSquares = 0;
+		for( int32_t y = 0; y < surface.getHeight(); ++y ) {
+			for( int32_t x = 0; x < surface.getWidth(); ++x ) {
+				const uint8_t v = surface.getChannelRed().getValue( ivec2( x, y ) );
+				minValue = std::min<uint32_t>( minValue, v );
+				maxValue = std::max<uint32_t>( maxValue, v );
+				sum += v;
+				sumSquares += v * v;
+			}
+		}
+		const double count = surface.getWidth() * surface.getHeight(), mean = sum / count;
+
+		for( auto level : { simd::Level::SCALAR, simd::Level::AVX2 } ) {
+			simd::ScopedMaxLevel scopedLevel( level );
+			const ip::SurfaceStatistics8u stats = ip::statistics( surface, 2 );
+			const ip::Statistics8u &red = stats.mRed, &alpha = stats.mAlpha;
+			REQUIRE( red.mCount == (uint64_t)count );
+			REQUIRE( red.mMin == minValue );
+			REQUIRE( red.mMax == maxValue );
+			REQUIRE( red.mMean == Approx( mean ) );
+			REQUIRE( red.mStdDev == Approx( sqrt( sumSquares / count - mean * mean ) ) );
+			REQUIRE( alpha.mMin == 200 );
+			REQUIRE( alpha.mStdDev == 0 );
+
+			const ip::Statistics8u channelRed = ip::statistics( surface.getChannelRed() );
+			REQUIRE( channelRed.mMean == Approx( red.mMean ) );
+			REQUIRE( channelRed.mMax == red.mMax );
+		}
+	}
+
+	SECTION("Histograms")
+	{
+		const vector<uint32_t> blue = ip::histogram( surface.getChannelBlue() );
+		REQUIRE( blue.size() == 256 );
+		REQUIRE( accumulate( blue.begin(), blue.begin() + 16, 0u ) == (uint32_t)( surface.getWidth() * surface.getHeight() ) );
+
+		vector<uint32_t> red, alpha;
+		ip::histogram( surface, surface.getBounds(), 16, 0, 255, &red, nullptr, nullptr, &alpha, 3 );
+		REQUIRE( red == ip::histogram( surface.getChannelRed(), surface.getBounds(), 16, 0, 255 ) );
+		REQUIRE( alpha[200 / 16] == (uint32_t)( surface.getWidth() * surface.getHeight() ) );
+	}
+
+	SECTION("Equalization spreads values over the full range")
+	{
+		Channel8u channel( 64, 16 );
+		for( int32_t y = 0; y < channel.getHeight(); ++y )
+			for( int32_t x = 0; x < channel.getWidth(); ++x )
+				*channel.getData( x, y ) = (uint8_t)( 100 + x / 4 );
+		ip::equalizeHistogram( &channel );
+		REQUIRE( ip::statistics( channel ).mMin == 0 );
+		REQUIRE( ip::statistics( channel ).mMax == 255 );
+	}
+}
+
+TEST_CASE("Histogram16u32f", "Statistics")
+{
+	const Surface16u surface16u = makeSurface<uint16_t>( 53, 37, SurfaceChannelOrder::RGBA, 2 );
+	const Surface32f surface32f = makeSurface<float>( 45, 31, SurfaceChannelOrder::RGB, 3 );
+	const uint32_t count16u = surface16u.getWidth() * surface16u.getHeight(), count32f = surface32f.getWidth() * surface32f.getHeight();
+
+	SECTION("Statistics match brute force, for the scalar and vector paths")
+	{
+		for( auto level : { simd::Level::SCALAR, simd::Level::AVX2 } ) {
+			simd::ScopedMaxLevel scopedLevel( level );
+			const ip::SurfaceStatistics16u stats16u = ip::statistics( surface16u, 3 );
+			requireStatistics( stats16u.mGreen, bruteForceStatistics( surface16u.getChannelGreen() ) );
+			requireStatistics( stats16u.mAlpha, bruteForceStatistics( surface16u.getChannelAlpha() ) );
+			requireStatistics( ip::statistics( surface16u.getChannelRed() ), bruteForceStatistics( surface16u.getChannelRed() ) );
+
+			const ip::SurfaceStatistics32f stats32f = ip::statistics( surface32f, 2 );
+			requireStatistics( stats32f.mBlue, bruteForceStatistics( surface32f.getChannelBlue() ) );
+			REQUIRE( stats32f.mAlpha.mCount == 0 );
+			requireStatistics( ip::statistics( surface32f.getChannelRed(), 0 ), bruteForceStatistics( surface32f.getChannelRed() ) );
+		}
+	}
+
+	SECTION("Histograms")
+	{
+		const vector<uint32_t> red16u = ip::histogram( surface16u.getChannelRed(), 64 );
+		REQUIRE( red16u.size() == 64 );
+		REQUIRE( accumulate( red16u.begin(), red16u.end(), 0u ) == count16u );
+
+		vector<uint32_t> green16u;
+		ip::histogram( surface16u, surface16u.getBounds(), 64, 0, 65535, nullptr, &green16u, nullptr, nullptr, 2 );
+		REQUIRE( green16u == ip::histogram( surface16u.getChannelGreen(), 64, 3 ) );
+
+		// the upper 32 bins span [32768, 65535], so they count exactly the values with the high bit set
+		uint32_t highValues = 0;
+		for( int32_t y = 0; y < surface16u.getHeight(); ++y )
+			for( int32_t x = 0; x < surface16u.getWidth(); ++x )
+				highValues += surface16u.getChannelGreen().getValue( ivec2( x, y ) ) >> 15;
+		REQUIRE( accumulate( green16u.begin() + 32, green16u.end(), 0u ) == highValues );
+
+		uint32_t below = 0, above = 0;
+		for( int32_t y = 0; y < surface32f.getHeight(); ++y ) {
+			for( int32_t x = 0; x < surface32f.getWidth(); ++x ) {
+				const float v = surface32f.getChannelRed().getValue( ivec2( x, y ) );
+				below += ( v < 0.1f ) ? 1 : 0;
+				above += ( v >= 0.9f ) ? 1 : 0;
+			}
+		}
+		const vector<uint32_t> red32f = ip::histogram( surface32f.getChannelRed(), 10 );
+		REQUIRE( accumulate( red32f.begin(), red32f.end(), 0u ) == count32f );
+		REQUIRE( red32f.front() == below );
+		REQUIRE( red32f.back() == above );
+
+		vector<uint32_t> red32fSurface;
+		ip::histogram( surface32f, surface32f.getBounds(), 10, 0, 1, &red32fSurface, nullptr, nullptr, nullptr, 0 );
+		REQUIRE( red32fSurface == red32f );
+	}
+
+	SECTION("Equalization spreads values over the full range")
+	{
+		Channel16u channel16u( 64, 16 );
+		Channel32f channel32f( 64, 16 );
+		for( int32_t y = 0; y < channel16u.getHeight(); ++y ) {
+			for( int32_t x = 0; x < channel16u.getWidth(); ++x ) {
+				*channel16u.getData( x, y ) = (uint16_t)( 30000 + x * 10 );
+				*channel32f.getData( x, y ) = 0.4f + x / 640.0f;
+			}
+		}
+		ip::equalizeHistogram( &channel16u, 2 );
+		ip::equalizeHistogram( &channel32f );
+		REQUIRE( ip::statistics( channel16u ).mMin == 0 );
+		REQUIRE( ip::statistics( channel16u ).mMax == 65535 );
+		REQUIRE( ip::statistics( channel32f ).mMin == 0 );
+		REQUIRE( ip::statistics( channel32f ).mMax == 1 );
+	}
+}
+
+TEST_CASE("HistogramClahe", "Equalization")
+{
+	// the left half holds dark values and the right half bright ones, each varying down the rows
+	Channel8u channel( 64, 62 );
+	for( int32_t y = 0; y < channel.getHeight(); ++y )
+		for( int32_t x = 0; x < channel.getWidth(); ++x )
+			*channel.getData( x, y ) = (uint8_t)( ( x < 32 ? 10 : 200 ) + y / 2 );
+
+	SECTION("A single unclipped tile is a global equalization by the cumulative histogram")
+	{
+		Channel8u equalized = channel.clone();
+		ip::equalizeHistogramClahe( &equalized, ivec2( 1 ), 0 );
+
+		const vector<uint32_t> counts = ip::histogram( channel );
+		const float numValues = (float)( channel.getWidth() * channel.getHeight() );
+		for( int32_t y = 0; y < channel.getHeight(); ++y ) {
+			for( int32_t x = 0; x < channel.getWidth(); ++x ) {
+				const uint8_t v = channel.getValue( ivec2( x, y ) );
+				const uint32_t cumulative = accumulate( counts.begin(), counts.begin() + v + 1, 0u );
+				REQUIRE( equalized.getValue( ivec2( x, y ) ) == (uint8_t)( cumulative / numValues * 255 + 0.5f ) );
+			}
+		}
+	}
+
+	SECTION("Tiles adapt to local contrast")
+	{
+		Channel8u equalized = channel.clone();
+		ip::equalizeHistogramClahe( &equalized, ivec2( 2, 1 ), 0 );
+
+		// columns outside the tile centers use their own tile's mapping, stretching each half over the full range
+		const ip::Statistics8u left = ip::statistics( equalized, Area( 0, 0, 16, 62 ) );
+		const ip::Statistics8u right = ip::statistics( equalized, Area( 48, 0, 64, 62 ) );
+		REQUIRE( left.mMax == 255 );
+		REQUIRE( left.mMin < 10 );
+		REQUIRE( right.mMax == 255 );
+		REQUIRE( right.mMin < 10 );
+	}
+
+	SECTION("Clipping limits the contrast gain")
+	{
+		Channel8u unclipped = channel.clone(), clipped = channel.clone();
+		ip::equalizeHistogramClahe( &unclipped, ivec2( 2 ), 0 );
+		ip::equalizeHistogramClahe( &clipped, ivec2( 2 ), 2.0f );
+		// the top left pixels map through the top left tile alone, whose 16 values are each stretched less when clipped
+		const Area topLeft( 0, 0, 16, 15 );
+		REQUIRE( ip::statistics( clipped, topLeft ).mStdDev < ip::statistics( unclipped, topLeft ).mStdDev );
+		REQUIRE( ip::statistics( clipped, topLeft ).mStdDev > ip::statistics( channel, topLeft ).mStdDev );
+	}
+
+	SECTION("Results don't depend on the number of threads")
+	{
+		Surface16u surface = makeSurface<uint16_t>( 75, 41, SurfaceChannelOrder::RGB, 4 );
+		Surface16u single = surface.clone(), multi = surface.clone();
+		ip::equalizeHistogramClahe( &single, ivec2( 5, 3 ), 3.0f, 1 );
+		ip::equalizeHistogramClahe( &multi, ivec2( 5, 3 ), 3.0f, 0 );
+		REQUIRE( isEqual( single, multi ) );
+		REQUIRE( ! isEqual( single, surface ) );
+	}
+}
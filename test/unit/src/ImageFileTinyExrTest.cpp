@@ -0,0 +1,222 @@
+#include "cinder/ImageFileTinyExr.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+#include "catch.hpp"
+
+#include <cstring>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+BufferRef toBuffer( const OStreamMemRef &stream )
+{
+	BufferRef result = Buffer::create( (size_t)stream->tell() );
+	std::memcpy( result->getData(), stream->getBuffer(), result->getSize() );
+	return result;
+}
+
+BufferRef encodeExr( const Surface32f &surface, int numThreads )
+{
+	OStreamMemRef stream = OStreamMem::create();
+	ImageSourceRef source = (ImageSourceRef)surface;
+	writeImage( ImageTargetFileTinyExr::create( DataTargetStream::createRef( stream ), source, ImageTarget::Options().numThreads( numThreads ), "exr" ), source );
+	return toBuffer( stream );
+}
+
+shared_ptr<ImageSourceFileTinyExr> decodeExr( const BufferRef &buffer, const ImageSource::Options &options = ImageSource::Options() )
+{
+	return dynamic_pointer_cast<ImageSourceFileTinyExr>( ImageSourceFileTinyExr::create( DataSourceBuffer::create( buffer ), options ) );
+}
+
+Surface32f makeTestSurface( int32_t width, int32_t height, bool alpha )
+{
+	Surface32f result( width, height, alpha );
+	for( int32_t y = 0; y < height; ++y )
+		for( int32_t x = 0; x < width; ++x )
+			result.setPixel( ivec2( x, y ), ColorA( x * 0.5f, y * 0.25f, ( x ^ y ) * 0.125f, ( x + y ) * 0.0625f ) );
+	return result;
+}
+
+bool equal( const Surface32f &a, const Surface32f &b )
+{
+	if( a.getSize() != b.getSize() || a.hasAlpha() != b.hasAlpha() )
+		return false;
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		for( int32_t x = 0; x < a.getWidth(); ++x )
+			if( a.getPixel( ivec2( x, y ) ) != b.getPixel( ivec2( x, y ) ) )
+				return false;
+	return true;
+}
+
+// Writes an uncompressed, tiled and mipmapped RGB file whose red holds x + 1000 * level, green y and blue the level
+BufferRef makeTiledMipmappedExr( int32_t width, int32_t height, int32_t tileSize )
+{
+	OStreamMemRef stream = OStreamMem::create();
+	auto writeString = [&]( const string &s ) { stream->writeData( s.c_str(), s.size() + 1 ); };
+	auto writeAttributeHeader = [&]( const string &name, const string &type, int32_t size ) { writeString( name ); writeString( type ); stream->writeLittle( size ); };
+
+	stream->writeLittle( (int32_t)20000630 );
+	stream->writeLittle( (uint32_t)( 2 | 0x200 ) );
+	writeAttributeHeader( "channels", "chlist", 3 * 18 + 1 );
+	for( const char *name : { "B", "G", "R" } ) {
+		writeString( name );
+		for( int32_t field : { 2, 0, 1, 1 } ) // FLOAT, pLinear and reserved, sampling
+			stream->writeLittle( field );
+	}
+	stream->writeLittle( (uint8_t)0 );
+	writeAttributeHeader( "compression", "compression", 1 );
+	stream->writeLittle( (uint8_t)0 );
+	writeAttributeHeader( "dataWindow", "box2i", 16 );
+	for( int32_t v : { 0, 0, width - 1, height - 1 } )
+		stream->writeLittle( v );
+	writeAttributeHeader( "tiles", "tiledesc", 9 );
+	stream->writeLittle( (uint32_t)tileSize );
+	stream->writeLittle( (uint32_t)tileSize );
+	stream->writeLittle( (uint8_t)1 ); // MIPMAP_LEVELS, ROUND_DOWN
+	stream->writeLittle( (uint8_t)0 );
+
+	struct Tile { int32_t x, y, level, width, height; };
+	vector<Tile> tiles;
+	for( int32_t level = 0; ( std::max( width, height ) >> level ) > 0; ++level ) {
+		const int32_t w = std::max( 1, width >> level ), h = std::max( 1, height >> level );
+		for( int32_t ty = 0; ty * tileSize < h; ++ty )
+			for( int32_t tx = 0; tx * tileSize < w; ++tx )
+				tiles.push_back( { tx, ty, level, std::min( tileSize, w - tx * tileSize ), std::min( tileSize, h - ty * tileSize ) } );
+	}
+
+	// the offset table is written in reverse order of the tiles, which readers must not depend on
+	const off_t tableStart = stream->tell();
+	vector<uint64_t> offsets( tiles.size() );
+	stream->seekAbsolute( tableStart + tiles.size() * 8 );
+	for( size_t t = tiles.size(); t-- > 0; ) {
+		const Tile &tile = tiles[t];
+		offsets[t] = stream->tell();
+		for( int32_t v : { tile.x, tile.y, tile.level, tile.level, tile.width * tile.height * 12 } )
+			stream->writeLittle( v );
+		for( int32_t y = 0; y < tile.height; ++y ) {
+			for( int32_t x = 0; x < tile.width; ++x )
+				stream->writeLittle( (float)tile.level );
+			for( int32_t x = 0; x < tile.width; ++x )
+				stream->writeLittle( (float)( tile.y * tileSize + y ) );
+			for( int32_t x = 0; x < tile.width; ++x )
+				stream->writeLittle( (float)( tile.x * tileSize + x + 1000 * tile.level ) );
+		}
+	}
+	const off_t end = stream->tell();
+	stream->seekAbsolute( tableStart );
+	for( uint64_t offset : offsets ) {
+		stream->writeLittle( (uint32_t)offset );
+		stream->writeLittle( (uint32_t)( offset >> 32 ) );
+	}
+	stream->seekAbsolute( end );
+
+	return toBuffer( stream );
+}
+
+} // anonymous namespace
+
+TEST_CASE( "ImageFileTinyExr" )
+{
+	ImageTargetFileTinyExr::registerSelf();
+
+	SECTION( "RGB, RGBA and gray images round trip exactly" )
+	{
+		for( bool alpha : { false, true } ) {
+			Surface32f surface = makeTestSurface( 37, 53, alpha );
+			Surface32f decoded( (ImageSourceRef)decodeExr( encodeExr( surface, 1 ) ) );
+			REQUIRE( equal( surface, decoded ) );
+
+			Channel32f channel( surface.getChannelRed() );
+			OStreamMemRef stream = OStreamMem::create();
+			ImageSourceRef source = (ImageSourceRef)channel;
+			writeImage( ImageTargetFileTinyExr::create( DataTargetStream::createRef( stream ), source, ImageTarget::Options(), "exr" ), source );
+			auto graySource = decodeExr( toBuffer( stream ) );
+			REQUIRE( graySource->getColorModel() == ImageIo::CM_GRAY );
+			Channel32f grayDecoded( (ImageSourceRef)graySource );
+			REQUIRE( grayDecoded.getValue( ivec2( 36, 52 ) ) == channel.getValue( ivec2( 36, 52 ) ) );
+		}
+	}
+
+	SECTION( "channels keep their order" )
+	{
+		Surface32f surface( 4, 4, false );
+		surface.setPixel( ivec2( 1, 2 ), Color( 1, 0.5f, 0.25f ) );
+		Surface32f decoded( (ImageSourceRef)decodeExr( encodeExr( surface, 1 ) ) );
+		REQUIRE( decoded.getPixel( ivec2( 1, 2 ) ) == ColorA( 1, 0.5f, 0.25f, 1 ) );
+	}
+
+	SECTION( "parallel encoding and decoding match serial" )
+	{
+		Surface32f surface = makeTestSurface( 301, 197, true );
+		BufferRef serial = encodeExr( surface, 1 ), parallel = encodeExr( surface, 4 );
+		REQUIRE( serial->getSize() == parallel->getSize() );
+		REQUIRE( std::memcmp( serial->getData(), parallel->getData(), serial->getSize() ) == 0 );
+
+		Surface32f decoded( (ImageSourceRef)decodeExr( parallel, ImageSource::Options().numThreads( 4 ) ) );
+		REQUIRE( equal( surface, decoded ) );
+	}
+
+	SECTION( "rows are streamed into a target created directly" )
+	{
+		OStreamMemRef stream = OStreamMem::create();
+		auto target = ImageTargetFileTinyExr::create( DataTargetStream::createRef( stream ), 8, 40, false, ImageTarget::Options().numThreads( 2 ) );
+		for( int32_t y = 0; y < 40; ++y ) {
+			float *row = (float*)target->getRowPointer( y );
+			for( int32_t x = 0; x < 8; ++x ) {
+				row[x * 3 + 0] = (float)x;
+				row[x * 3 + 1] = (float)y;
+				row[x * 3 + 2] = 0.5f;
+			}
+		}
+		target->finalize();
+
+		Surface32f decoded( (ImageSourceRef)decodeExr( toBuffer( stream ) ) );
+		REQUIRE( decoded.getPixel( ivec2( 7, 39 ) ) == ColorA( 7, 39, 0.5f, 1 ) );
+
+		auto incomplete = ImageTargetFileTinyExr::create( DataTargetStream::createRef( OStreamMem::create() ), 8, 40, false );
+		incomplete->getRowPointer( 0 );
+		REQUIRE_THROWS_AS( incomplete->finalize(), const ImageIoExceptionFailedWriteTinyExr& );
+	}
+
+	SECTION( "a region is decoded without the rest of the image" )
+	{
+		Surface32f surface = makeTestSurface( 64, 64, false );
+		auto source = decodeExr( encodeExr( surface, 1 ) );
+		REQUIRE_FALSE( source->isTiled() );
+		REQUIRE( source->getNumLevels() == 1 );
+		source->setRegion( Area( 50, 20, 80, 30 ) );
+		Surface32f region( (ImageSourceRef)source );
+		REQUIRE( region.getSize() == ivec2( 14, 10 ) );
+		REQUIRE( region.getPixel( ivec2( 0, 0 ) ) == surface.getPixel( ivec2( 50, 20 ) ) );
+		REQUIRE( region.getPixel( ivec2( 13, 9 ) ) == surface.getPixel( ivec2( 63, 29 ) ) );
+	}
+
+	SECTION( "tiles and mip levels of tiled files" )
+	{
+		auto source = decodeExr( makeTiledMipmappedExr( 100, 60, 16 ) );
+		REQUIRE( source->isTiled() );
+		REQUIRE( source->getNumLevels() == 7 );
+		REQUIRE( source->getLevelSize( 2 ) == ivec2( 25, 15 ) );
+		REQUIRE( source->getLevelSize( 6 ) == ivec2( 1, 1 ) );
+
+		Surface32f full( (ImageSourceRef)source );
+		REQUIRE( full.getPixel( ivec2( 99, 59 ) ) == ColorA( 99, 59, 0, 1 ) );
+
+		source->setRegion( Area( 10, 5, 20, 14 ), 2 );
+		Surface32f region( (ImageSourceRef)source );
+		REQUIRE( region.getSize() == ivec2( 10, 9 ) );
+		REQUIRE( region.getPixel( ivec2( 0, 0 ) ) == ColorA( 2010, 5, 2, 1 ) );
+		REQUIRE( region.getPixel( ivec2( 9, 8 ) ) == ColorA( 2019, 13, 2, 1 ) );
+
+		// a reduced target size selects the mip level rather than filtering the full image
+		auto reduced = decodeExr( makeTiledMipmappedExr( 100, 60, 16 ), ImageSource::Options().targetSize( ivec2( 25, 15 ) ) );
+		Surface32f level( (ImageSourceRef)reduced );
+		REQUIRE( level.getSize() == ivec2( 25, 15 ) );
+		REQUIRE( level.getPixel( ivec2( 3, 4 ) ) == ColorA( 2003, 4, 2, 1 ) );
+
+		REQUIRE_THROWS_AS( source->setRegion( Area( 0, 0, 1, 1 ), 7 ), const ImageIoExceptionFailedLoadTinyExr& );
+	}
+}
@@ -0,0 +1,97 @@
+#include "cinder/ImageIo.h"
+#include "cinder/ImageSourceFileStbImage.h"
+#include "cinder/ImageTargetFileStbImage.h"
+
+#include "catch.hpp"
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+// A 16-bit gray source of constant \a value, which produces its rows through ImageSource::processRow()
+class ConstantSource16u : public ImageSource {
+  public:
+	ConstantSource16u( const ivec2 &size, uint16_t value, const Options &options )
+		: ImageSource(), mRow( size.x, value )
+	{
+		setColorModel( ImageIo::CM_GRAY );
+		setChannelOrder( ImageIo::Y );
+		setDataType( ImageIo::UINT16 );
+		setDecodedSize( size, options.calcReductionFactor( size ) );
+	}
+
+	void load( ImageTargetRef target ) override
+	{
+		RowFunc func = setupRowFunc( target );
+		for( int32_t row = 0; row < getDecodedHeight(); ++row )
+			processRow( func, target, row, mRow.data() );
+	}
+
+  private:
+	vector<uint16_t>	mRow;
+};
+
+} // anonymous namespace
+
+TEST_CASE( "ImageIo" )
+{
+	SECTION( "Options::calcReductionFactor" )
+	{
+		const ivec2 fullSize( 4000, 3000 );
+		REQUIRE( ImageSource::Options().calcReductionFactor( fullSize ) == 1 );
+		REQUIRE( ImageSource::Options().scale( 0.25f ).calcReductionFactor( fullSize ) == 4 );
+		REQUIRE( ImageSource::Options().scale( 0.3f ).calcReductionFactor( fullSize ) == 3 );
+		REQUIRE( ImageSource::Options().targetSize( ivec2( 512, 0 ) ).calcReductionFactor( fullSize ) == 7 );
+		REQUIRE( ImageSource::Options().targetSize( ivec2( 512, 512 ) ).calcReductionFactor( fullSize ) == 5 );
+		REQUIRE( ImageSource::Options().targetSize( ivec2( 8000, 8000 ) ).calcReductionFactor( fullSize ) == 1 );
+		REQUIRE( ImageSource::Options().targetSize( ivec2( 1, 1 ) ).calcReductionFactor( fullSize ) == 3000 );
+	}
+
+	SECTION( "Reduced decode box-filters whole blocks" )
+	{
+		Surface8u src( 203, 101, false, SurfaceChannelOrder::RGB );
+		for( int32_t y = 0; y < src.getHeight(); ++y )
+			for( int32_t x = 0; x < src.getWidth(); ++x )
+				*reinterpret_cast<Color8u*>( src.getData( ivec2( x, y ) ) ) = Color8u( x, y * 2, ( x * y ) & 0xFF );
+
+		ImageTargetFileStbImage::registerSelf();
+		const fs::path path = fs::temp_directory_path() / "cinder_imageio_reduce_test.png";
+		writeImage( path, src );
+
+		const int32_t factor = 4;
+		ImageSourceRef source = ImageSourceFileStbImage::create( loadFile( path ), ImageSource::Options().targetSize( ivec2( 50, 0 ) ) );
+		REQUIRE( source->getWidth() == ( src.getWidth() + factor - 1 ) / factor );
+		REQUIRE( source->getHeight() == ( src.getHeight() + factor - 1 ) / factor );
+
+		const Surface8u reduced( source );
+		bool match = true;
+		for( int32_t y = 0; y < reduced.getHeight(); ++y ) {
+			for( int32_t x = 0; x < reduced.getWidth(); ++x ) {
+				const Area block = Area( x * factor, y * factor, x * factor + factor, y * factor + factor ).getClipBy( src.getBounds() );
+				ivec3 sum( 0 );
+				for( int32_t by = block.y1; by < block.y2; ++by )
+					for( int32_t bx = block.x1; bx < block.x2; ++bx )
+						sum += ivec3( src.getData( ivec2( bx, by ) )[0], src.getData( ivec2( bx, by ) )[1], src.getData( ivec2( bx, by ) )[2] );
+				const int32_t count = block.calcArea();
+				const uint8_t *pixel = reduced.getData( ivec2( x, y ) );
+				for( int c = 0; c < 3; ++c )
+					match = match && ( pixel[c] == ( sum[c] + count / 2 ) / count );
+			}
+		}
+		REQUIRE( match );
+
+		fs::remove( path );
+	}
+
+	SECTION( "Reduced decode of 16-bit samples by large factors doesn't overflow" )
+	{
+		// each 600x600 block sums to well over 2^32
+		ImageSourceRef source( new ConstantSource16u( ivec2( 600, 1200 ), 65535, ImageSource::Options().targetSize( ivec2( 1, 2 ) ) ) );
+		REQUIRE( source->getWidth() == 1 );
+		REQUIRE( source->getHeight() == 2 );
+		const Channel16u reduced( source );
+		REQUIRE( reduced.getValue( ivec2( 0, 0 ) ) == 65535 );
+		REQUIRE( reduced.getValue( ivec2( 0, 1 ) ) == 65535 );
+	}
+}
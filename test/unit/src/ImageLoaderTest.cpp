@@ -0,0 +1,132 @@
+#include "cinder/ImageLoader.h"
+#include "cinder/ip/Fill.h"
+
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+std::atomic<bool> sGateOpen( true );
+
+// A 4x4 image format whose one byte of data is the value of every pixel. It fails to load when the value is 0, and blocks until sGateOpen when it is 255.
+ImageSourceRef createTestSource( DataSourceRef dataSource, ImageSource::Options /*options*/ )
+{
+	const uint8_t value = *static_cast<const uint8_t*>( dataSource->getBuffer()->getData() );
+	if( value == 0 )
+		throw ImageIoExceptionFailedLoad( "test image is empty" );
+	while( value == 255 && ! sGateOpen )
+		std::this_thread::yield();
+
+	Surface8u surface( 4, 4, false );
+	ip::fill( &surface, Color8u( value, value, value ) );
+	// the ImageSource shares the Surface's pixel storage
+	return ImageSourceRef( surface );
+}
+
+DataSourceRef makeTestImage( uint8_t value )
+{
+	BufferRef buffer = Buffer::create( 1 );
+	*static_cast<uint8_t*>( buffer->getData() ) = value;
+	return DataSourceBuffer::create( buffer, "test.ciltest" );
+}
+
+} // anonymous namespace
+
+TEST_CASE("ImageLoader", "ImageIo")
+{
+	ImageIoRegistrar::registerSourceType( "ciltest", createTestSource );
+	const ImageLoader::Options testOptions = ImageLoader::Options().extension( "ciltest" ).sourceOptions( ImageSource::Options().throwOnFirstException() );
+
+	SECTION("Futures receive the Surface or the loading exception")
+	{
+		ImageLoaderRef loader = ImageLoader::create( ImageLoader::Format().numThreads( 2 ) );
+		auto loaded = loader->loadFuture( makeTestImage( 42 ), testOptions );
+		auto failed = loader->loadFuture( makeTestImage( 0 ), testOptions );
+		Surface8uRef surface = loaded.get();
+		REQUIRE( surface->getWidth() == 4 );
+		REQUIRE( surface->getPixel( ivec2( 3, 3 ) ) == ColorA8u( 42, 42, 42, 255 ) );
+		REQUIRE_THROWS_AS( failed.get(), const ImageIoExceptionFailedLoad& );
+	}
+
+	SECTION("Results are polled or dispatched to callbacks on the calling thread")
+	{
+		ImageLoaderRef loader = ImageLoader::create( ImageLoader::Format().numThreads( 3 ) );
+		vector<ImageLoader::RequestId> ids;
+		for( int i = 1; i <= 20; ++i )
+			ids.push_back( loader->load( makeTestImage( (uint8_t)i ), testOptions ) );
+
+		int numCallbacks = 0;
+		const auto callerThread = this_thread::get_id();
+		loader->load( makeTestImage( 0 ), ImageLoader::Options( testOptions ).callback( [&]( const ImageLoader::Result &result ) {
+			REQUIRE( this_thread::get_id() == callerThread );
+			REQUIRE( ! result.isSuccess() );
+			REQUIRE( result.mError );
+			++numCallbacks;
+		} ) );
+
+		vector<ImageLoader::Result> results;
+		const auto deadline = chrono::steady_clock::now() + chrono::seconds( 10 );
+		while( ( results.size() < ids.size() || numCallbacks == 0 ) && chrono::steady_clock::now() < deadline ) {
+			loader->update();
+			ImageLoader::Result result;
+			while( loader->popResult( &result ) )
+				results.push_back( result );
+			this_thread::yield();
+		}
+
+		REQUIRE( numCallbacks == 1 );
+		REQUIRE( results.size() == ids.size() );
+		for( const auto &result : results ) {
+			REQUIRE( result.isSuccess() );
+			const size_t index = find( ids.begin(), ids.end(), result.mId ) - ids.begin();
+			REQUIRE( result.mSurface->getPixel( ivec2( 0, 0 ) ).r == index + 1 );
+		}
+		REQUIRE( loader->getNumPending() == 0 );
+		REQUIRE( loader->getNumInFlight() == 0 );
+	}
+
+	SECTION("Priorities, cancellation and the pending bound")
+	{
+		ImageLoaderRef loader = ImageLoader::create( ImageLoader::Format().numThreads( 1 ).maxPending( 8 ) );
+		// hold the worker so that every following request stays pending
+		sGateOpen = false;
+		auto gate = loader->loadFuture( makeTestImage( 255 ), testOptions );
+		while( loader->getNumInFlight() == 0 )
+			this_thread::yield();
+
+		vector<ImageLoader::RequestId> low;
+		for( int i = 0; i < 8; ++i )
+			low.push_back( loader->load( makeTestImage( 1 ), ImageLoader::Options( testOptions ).priority( -1 ) ) );
+		// the bound drops the lowest priority, which is the new request, then the oldest of the lowest
+		const auto lowest = loader->load( makeTestImage( 2 ), ImageLoader::Options( testOptions ).priority( -2 ) );
+		const auto important = loader->load( makeTestImage( 3 ), ImageLoader::Options( testOptions ).priority( 5 ) );
+		const auto stale = loader->load( makeTestImage( 4 ), testOptions );
+		REQUIRE( loader->cancel( stale ) );
+		REQUIRE( ! loader->cancel( stale ) );
+		REQUIRE( loader->getNumPending() == 7 );
+		sGateOpen = true;
+		REQUIRE( gate.get()->getPixel( ivec2( 0, 0 ) ).r == 255 );
+
+		vector<ImageLoader::Result> results;
+		const auto deadline = chrono::steady_clock::now() + chrono::seconds( 10 );
+		while( results.size() < 11 && chrono::steady_clock::now() < deadline ) {
+			ImageLoader::Result result;
+			while( loader->popResult( &result ) )
+				results.push_back( result );
+			this_thread::yield();
+		}
+
+		const vector<ImageLoader::RequestId> expected = { lowest, low[0], low[1], stale, important, low[2], low[3], low[4], low[5], low[6], low[7] };
+		REQUIRE( results.size() == expected.size() );
+		for( size_t i = 0; i < results.size(); ++i ) {
+			REQUIRE( results[i].mId == expected[i] );
+			REQUIRE( results[i].mCanceled == ( i < 4 ) );
+			REQUIRE( results[i].isSuccess() == ( i >= 4 ) );
+		}
+	}
+}
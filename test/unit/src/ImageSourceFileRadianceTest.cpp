@@ -0,0 +1,133 @@
+#include "cinder/ImageSourceFileRadiance.h"
+#include "cinder/ImageSourceFileStbImage.h"
+#include "cinder/ImageTargetFileStbImage.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/Surface.h"
+#include "cinder/Rand.h"
+
+#include "catch.hpp"
+
+#include <cstring>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+BufferRef encodeHdr( const Surface32f &surface )
+{
+	OStreamMemRef stream = OStreamMem::create();
+	ImageSourceRef source = surface;
+	writeImage( ImageTargetFileStbImage::create( DataTargetStream::createRef( stream ), source, ImageTarget::Options(), "hdr" ), source );
+	BufferRef result = Buffer::create( (size_t)stream->tell() );
+	std::memcpy( result->getData(), stream->getBuffer(), result->getSize() );
+	return result;
+}
+
+BufferRef makeBuffer( const string &header, const vector<uint8_t> &pixels )
+{
+	BufferRef result = Buffer::create( header.size() + pixels.size() );
+	std::memcpy( result->getData(), header.data(), header.size() );
+	std::memcpy( static_cast<uint8_t*>( result->getData() ) + header.size(), pixels.data(), pixels.size() );
+	return result;
+}
+
+ImageSourceRef decodeRadiance( const BufferRef &buffer, ImageSource::Options options = ImageSource::Options() )
+{
+	return ImageSourceFileRadiance::create( DataSourceBuffer::create( buffer ), options );
+}
+
+template<typename T>
+bool equal( const SurfaceT<T> &a, const SurfaceT<T> &b )
+{
+	if( a.getSize() != b.getSize() )
+		return false;
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		for( int32_t x = 0; x < a.getWidth(); ++x )
+			if( a.getPixel( ivec2( x, y ) ) != b.getPixel( ivec2( x, y ) ) )
+				return false;
+	return true;
+}
+
+} // anonymous namespace
+
+TEST_CASE("ImageSourceFileRadiance", "ImageIo")
+{
+	// a wide range of exponents, including values which become denormal floats, with runs for the encoder to find
+	Surface32f pattern( 301, 67, false );
+	Rand rand( 5 );
+	for( int32_t y = 0; y < pattern.getHeight(); ++y ) {
+		for( int32_t x = 0; x < pattern.getWidth(); ++x ) {
+			const float scale = ( x < 100 ) ? ldexpf( 1.0f, y * 4 - 140 ) : 1000.0f;
+			pattern.setPixel( ivec2( x, y ), ( x % 50 < 10 ) ? Color( 0.5f, 0.25f, 2.0f ) : Color( rand.nextFloat(), rand.nextFloat(), rand.nextFloat() ) * scale );
+		}
+	}
+	BufferRef rle = encodeHdr( pattern );
+	const Surface32f reference( ImageSourceFileStbImage::create( DataSourceBuffer::create( rle ), ImageSource::Options() ) );
+
+	SECTION("Run-length encoded scanlines match stb_image on any number of threads")
+	{
+		for( int numThreads : { 1, 3, 0 } ) {
+			const Surface32f direct( decodeRadiance( rle, ImageSource::Options().numThreads( numThreads ) ) );
+			REQUIRE( equal( direct, reference ) );
+		}
+
+		// with alpha, and converted through the generic row functions
+		const Surface32f withAlpha( decodeRadiance( rle, ImageSource::Options().numThreads( 2 ) ), SurfaceConstraintsDefault(), true );
+		REQUIRE( withAlpha.getPixel( ivec2( 150, 30 ) ) == ColorA( reference.getPixel( ivec2( 150, 30 ) ), 1.0f ) );
+		const Surface8u converted( decodeRadiance( rle, ImageSource::Options().numThreads( 2 ) ) );
+		REQUIRE( equal( converted, Surface8u( ImageSourceFileStbImage::create( DataSourceBuffer::create( rle ), ImageSource::Options() ) ) ) );
+	}
+
+	SECTION("The SIMD conversion matches the scalar conversion")
+	{
+		const Surface32f simd( decodeRadiance( rle ) );
+		simd::ScopedMaxLevel scopedLevel( simd::Level::SCALAR );
+		const Surface32f scalar( decodeRadiance( rle ) );
+		REQUIRE( equal( simd, scalar ) );
+	}
+
+	SECTION("Reduced decodes average the full decode")
+	{
+		const Surface32f reduced( decodeRadiance( rle, ImageSource::Options().scale( 0.4f ).numThreads( 2 ) ) );
+		REQUIRE( reduced.getSize() == ivec2( 151, 34 ) );
+		const ColorA expected = ( reference.getPixel( ivec2( 200, 20 ) ) + reference.getPixel( ivec2( 201, 20 ) ) + reference.getPixel( ivec2( 200, 21 ) ) + reference.getPixel( ivec2( 201, 21 ) ) ) * 0.25f;
+		const ColorA actual = reduced.getPixel( ivec2( 100, 10 ) );
+		REQUIRE( distance( vec3( actual.r, actual.g, actual.b ), vec3( expected.r, expected.g, expected.b ) ) < 1e-3f );
+	}
+
+	SECTION("Flat pixels and old-style runs, bottom to top")
+	{
+		// scanlines narrower than 8 pixels can't use new-style encoding. The second scanline opens with a run of the first scanline's last pixel
+		const vector<uint8_t> pixels = {
+			128, 64, 32, 129,	1, 1, 1, 2,		64, 64, 64, 130,
+			1, 1, 1, 2,			0, 0, 0, 0,		255, 128, 0, 128
+		};
+		const Surface32f surface( decodeRadiance( makeBuffer( "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n+Y 2 +X 4\n", pixels ) ) );
+		REQUIRE( surface.getSize() == ivec2( 4, 2 ) );
+		// +Y stores the bottom scanline first
+		REQUIRE( surface.getPixel( ivec2( 0, 1 ) ) == Color( 1.0f, 0.5f, 0.25f ) );
+		REQUIRE( surface.getPixel( ivec2( 2, 1 ) ) == Color( 1.0f, 0.5f, 0.25f ) );
+		REQUIRE( surface.getPixel( ivec2( 3, 1 ) ) == Color( 1.0f, 1.0f, 1.0f ) );
+		REQUIRE( surface.getPixel( ivec2( 0, 0 ) ) == Color( 1.0f, 1.0f, 1.0f ) );
+		REQUIRE( surface.getPixel( ivec2( 1, 0 ) ) == Color( 1.0f, 1.0f, 1.0f ) );
+		REQUIRE( surface.getPixel( ivec2( 2, 0 ) ) == Color( 0, 0, 0 ) );
+		REQUIRE( surface.getPixel( ivec2( 3, 0 ) ) == Color( 255 / 256.0f, 0.5f, 0 ) );
+	}
+
+	SECTION("Scanlines after truncated data load as black")
+	{
+		BufferRef truncated = Buffer::create( rle->getSize() / 2 );
+		std::memcpy( truncated->getData(), rle->getData(), truncated->getSize() );
+		const Surface32f surface( decodeRadiance( truncated, ImageSource::Options().numThreads( 2 ) ) );
+		REQUIRE( surface.getPixel( ivec2( 150, 0 ) ) == reference.getPixel( ivec2( 150, 0 ) ) );
+		REQUIRE( surface.getPixel( ivec2( 150, 66 ) ) == Color( 0, 0, 0 ) );
+	}
+
+	SECTION("Invalid files throw")
+	{
+		REQUIRE_THROWS_AS( decodeRadiance( makeBuffer( "P6\n", {} ) ), const ImageSourceFileRadianceException& );
+		REQUIRE_THROWS_AS( decodeRadiance( makeBuffer( "#?RADIANCE\nFORMAT=32-bit_rle_xyze\n\n-Y 1 +X 1\n", { 0, 0, 0, 0 } ) ), const ImageSourceFileRadianceException& );
+		REQUIRE_THROWS_AS( decodeRadiance( makeBuffer( "#?RADIANCE\n\n-Y 1 -X 1\n", { 0, 0, 0, 0 } ) ), const ImageSourceFileRadianceException& );
+	}
+}
@@ -0,0 +1,182 @@
+#include "cinder/ImageWriter.h"
+#include "cinder/ImageSourceFileStbImage.h"
+#include "cinder/ImageTargetFileStbImage.h"
+#include "cinder/Channel.h"
+#include "cinder/Rand.h"
+#include "cinder/ip/Fill.h"
+
+#include "catch.hpp"
+
+#include <atomic>
+#include <cstring>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+BufferRef encodeStb( const ImageSourceRef &source, const string &extension, int numThreads )
+{
+	OStreamMemRef stream = OStreamMem::create();
+	writeImage( ImageTargetFileStbImage::create( DataTargetStream::createRef( stream ), source, ImageTarget::Options().numThreads( numThreads ), extension ), source );
+	BufferRef result = Buffer::create( (size_t)stream->tell() );
+	std::memcpy( result->getData(), stream->getBuffer(), result->getSize() );
+	return result;
+}
+
+ImageSourceRef decodeStb( const BufferRef &buffer )
+{
+	return ImageSourceFileStbImage::create( DataSourceBuffer::create( buffer ), ImageSource::Options() );
+}
+
+// Noise in the top half and gradients below, so that strips compress very differently
+template<typename T>
+void fillTestPattern( SurfaceT<T> *surface, float maxValue )
+{
+	Rand rand( 17 );
+	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
+		for( int32_t x = 0; x < surface->getWidth(); ++x ) {
+			if( y < surface->getHeight() / 2 )
+				surface->setPixel( ivec2( x, y ), ColorAT<T>( T( rand.nextFloat() * maxValue ), T( rand.nextFloat() * maxValue ), T( rand.nextFloat() * maxValue ), T( rand.nextFloat() * maxValue ) ) );
+			else
+				surface->setPixel( ivec2( x, y ), ColorAT<T>( T( x % 256 / 255.0f * maxValue ), T( y % 256 / 255.0f * maxValue ), T( ( x + y ) % 256 / 255.0f * maxValue ), T( maxValue ) ) );
+		}
+	}
+}
+
+bool equal( const Surface8u &a, const Surface8u &b )
+{
+	if( a.getSize() != b.getSize() || a.hasAlpha() != b.hasAlpha() )
+		return false;
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		for( int32_t x = 0; x < a.getWidth(); ++x )
+			if( a.getPixel( ivec2( x, y ) ) != b.getPixel( ivec2( x, y ) ) )
+				return false;
+	return true;
+}
+
+std::atomic<bool> sGateOpen( true );
+std::mutex sWrittenMutex;
+std::vector<uint8_t> sWritten;
+
+// Records the red value of the first pixel of each image written with the "ciwtest" extension, waiting for sGateOpen first
+class TestTarget : public ImageTarget {
+  public:
+	TestTarget( ImageSourceRef imageSource )
+		: mRow( imageSource->getWidth() * 4 )
+	{
+		setSize( imageSource->getWidth(), imageSource->getHeight() );
+		setColorModel( ImageIo::CM_RGB );
+		setChannelOrder( ImageIo::RGBA );
+		setDataType( ImageIo::UINT8 );
+	}
+
+	void* getRowPointer( int32_t /*row*/ ) override	{ return mRow.data(); }
+
+	void finalize() override
+	{
+		while( ! sGateOpen )
+			std::this_thread::yield();
+		std::lock_guard<std::mutex> lock( sWrittenMutex );
+		sWritten.push_back( mRow[0] );
+	}
+
+	std::vector<uint8_t>	mRow;
+};
+
+ImageTargetRef createTestTarget( DataTargetRef /*dataTarget*/, ImageSourceRef imageSource, ImageTarget::Options /*options*/, const std::string & /*extensionData*/ )
+{
+	return ImageTargetRef( new TestTarget( imageSource ) );
+}
+
+} // anonymous namespace
+
+TEST_CASE("ImageWriter", "ImageIo")
+{
+	SECTION("Parallel PNG encoding decodes to the source")
+	{
+		// a little over 1.5 million filtered bytes, so several strips
+		Surface8u rgba( 1001, 403, true );
+		fillTestPattern( &rgba, 255.0f );
+		Surface8u rgb( 777, 301, false );
+		fillTestPattern( &rgb, 255.0f );
+
+		for( int numThreads : { 0, 1, 3 } ) {
+			REQUIRE( equal( Surface8u( decodeStb( encodeStb( rgba, "png", numThreads ) ) ), rgba ) );
+			REQUIRE( equal( Surface8u( decodeStb( encodeStb( rgb, "png", numThreads ) ) ), rgb ) );
+		}
+
+		Channel8u gray( rgb.getChannelRed() );
+		Channel8u decodedGray( decodeStb( encodeStb( gray, "png", 4 ) ) );
+		bool grayEqual = true;
+		for( int32_t y = 0; y < gray.getHeight(); ++y )
+			for( int32_t x = 0; x < gray.getWidth(); ++x )
+				grayEqual = grayEqual && gray.getValue( ivec2( x, y ) ) == decodedGray.getValue( ivec2( x, y ) );
+		REQUIRE( grayEqual );
+
+		Surface8u tiny( 1, 1, false );
+		ip::fill( &tiny, Color8u( 1, 2, 3 ) );
+		REQUIRE( equal( Surface8u( decodeStb( encodeStb( tiny, "png", 4 ) ) ), tiny ) );
+	}
+
+	SECTION("Parallel HDR encoding matches serial encoding")
+	{
+		Surface32f hdr( 640, 480, false );
+		fillTestPattern( &hdr, 4.0f );
+		BufferRef serial = encodeStb( hdr, "hdr", 1 );
+		BufferRef parallel = encodeStb( hdr, "hdr", 4 );
+		REQUIRE( serial->getSize() == parallel->getSize() );
+		REQUIRE( std::memcmp( serial->getData(), parallel->getData(), serial->getSize() ) == 0 );
+	}
+
+	ImageIoRegistrar::registerTargetType( "ciwtest", createTestTarget, 0, "" );
+	sWritten.clear();
+
+	SECTION("Surfaces are copied, and writes complete in order")
+	{
+		ImageWriterRef writer = ImageWriter::create( ImageWriter::Format().blockWhenFull().maxPending( 2 ) );
+		Surface8u surface( 8, 8, true );
+		vector<future<void>> futures;
+		for( uint8_t i = 1; i <= 10; ++i ) {
+			ip::fill( &surface, ColorA8u( i, 0, 0, 255 ) );
+			futures.push_back( writer->write( "frame.ciwtest", surface ) );
+			REQUIRE( writer->getNumPending() <= 2 );
+		}
+		writer->flush();
+		REQUIRE( writer->getNumPending() == 0 );
+		REQUIRE( writer->getNumInFlight() == 0 );
+		REQUIRE( writer->getNumDropped() == 0 );
+		REQUIRE( sWritten == vector<uint8_t>( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 } ) );
+		for( auto &f : futures )
+			REQUIRE_NOTHROW( f.get() );
+	}
+
+	SECTION("Writes beyond a full queue are dropped rather than blocking")
+	{
+		ImageWriterRef writer = ImageWriter::create( ImageWriter::Format().maxPending( 2 ) );
+		Surface8u surface( 8, 8, true );
+		sGateOpen = false;
+		ip::fill( &surface, ColorA8u( 1, 0, 0, 255 ) );
+		auto first = writer->write( "frame.ciwtest", surface );
+		while( writer->getNumInFlight() == 0 )
+			std::this_thread::yield();
+		auto second = writer->write( "frame.ciwtest", surface );
+		auto third = writer->write( "frame.ciwtest", surface );
+		auto dropped = writer->write( "frame.ciwtest", surface );
+		REQUIRE_THROWS_AS( dropped.get(), const ImageWriterExceptionDropped& );
+		REQUIRE( writer->getNumDropped() == 1 );
+		sGateOpen = true;
+		writer.reset(); // completes the queued writes
+		REQUIRE_NOTHROW( first.get() );
+		REQUIRE_NOTHROW( second.get() );
+		REQUIRE_NOTHROW( third.get() );
+		REQUIRE( sWritten.size() == 3 );
+	}
+
+	SECTION("Failures reach the future")
+	{
+		ImageWriterRef writer = ImageWriter::create();
+		Surface8u surface( 8, 8, false );
+		REQUIRE_THROWS_AS( writer->write( "frame.ciwnonexistent", surface ).get(), const ImageIoExceptionUnknownExtension& );
+	}
+}
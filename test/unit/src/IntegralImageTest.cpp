@@ -0,0 +1,115 @@
+#include "cinder/ip/IntegralImage.h"
+#include "cinder/ip/Fill.h"
+#include "cinder/ip/Threshold.h"
+
+#include "catch.hpp"
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+// adaptiveThreshold() as it was implemented before it used IntegralImage, with its own inclusive table and clamped windows
+Channel8u adaptiveThresholdReference( const Channel8u &channel, int32_t windowSize, float percentageDelta )
+{
+	const int32_t width = channel.getWidth(), height = channel.getHeight();
+	vector<uint32_t> integral( width * height );
+	for( int32_t y = 0; y < height; ++y ) {
+		uint32_t sum = 0;
+		for( int32_t x = 0; x < width; ++x ) {
+			sum += *channel.getData( x, y );
+			integral[y * width + x] = ( y == 0 ) ? sum : integral[( y - 1 ) * width + x] + sum;
+		}
+	}
+
+	Channel8u result( width, height );
+	const int32_t s2 = windowSize / 2;
+	const uint32_t comparisonMult = static_cast<uint32_t>( ( 1.0f - percentageDelta ) * 256 );
+	for( int32_t y = 0; y < height; ++y ) {
+		for( int32_t x = 0; x < width; ++x ) {
+			const int32_t x1 = std::max( x - s2, 0 ), x2 = std::min( x + s2, width - 1 );
+			const int32_t y1 = std::max( y - s2, 0 ), y2 = std::min( y + s2, height - 1 );
+			const int32_t count = ( x2 - x1 ) * ( y2 - y1 );
+			const uint32_t sum = integral[y2 * width + x2] - integral[y1 * width + x2] - integral[y2 * width + x1] + integral[y1 * width + x1];
+			*result.getData( x, y ) = ( (uint32_t)( *channel.getData( x, y ) * count ) < ( sum * comparisonMult / 256 ) ) ? 0 : 255;
+		}
+	}
+
+	return result;
+}
+
+bool isEqual( const Channel8u &a, const Channel8u &b )
+{
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		for( int32_t x = 0; x < a.getWidth(); ++x )
+			if( *a.getData( x, y ) != *b.getData( x, y ) )
+				return false;
+	return true;
+}
+
+} // anonymous namespace
+
+TEST_CASE("IntegralImage", "Sums")
+{
+	// large enough that a multithreaded build splits both the rows and the columns into bands
+	Channel8u channel( 1024, 512 );
+	for( int32_t y = 0; y < channel.getHeight(); ++y )
+		for( int32_t x = 0; x < channel.getWidth(); ++x )
+			*channel.getData( x, y ) = (uint8_t)( ( x * 7 + y * 13 ) & 0xFF );
+
+	auto bruteSum = [&]( int32_t x1, int32_t y1, int32_t x2, int32_t y2 ) {
+		uint32_t sum = 0;
+		for( int32_t y = y1; y < y2; ++y )
+			for( int32_t x = x1; x < x2; ++x )
+				sum += *channel.getData( x, y );
+		return sum;
+	};
+
+	SECTION("Box sums match brute force")
+	{
+		ip::IntegralImage8u integral( channel, true );
+		REQUIRE( integral.getSum( 0, 0, 1024, 512 ) == bruteSum( 0, 0, 1024, 512 ) );
+		REQUIRE( integral.getSum( 3, 5, 20, 11 ) == bruteSum( 3, 5, 20, 11 ) );
+		REQUIRE( integral.getSum( 700, 300, 1024, 512 ) == bruteSum( 700, 300, 1024, 512 ) );
+		REQUIRE( integral.getSum( Area( -10, -10, 5, 4 ) ) == bruteSum( 0, 0, 5, 4 ) );
+		REQUIRE( integral.getSum( Area( 1030, 520, 1040, 530 ) ) == 0 );
+		REQUIRE( integral.getSquaredSum( 1, 1, 2, 2 ) == (uint64_t)( 20 * 20 ) );
+	}
+
+	SECTION("Multithreaded build is identical")
+	{
+		ip::IntegralImage8u serial( channel, true, 1 ), parallel( channel, true, 4 );
+		const size_t size = serial.getRowStride() * ( serial.getHeight() + 1 );
+		REQUIRE( equal( serial.getData(), serial.getData() + size, parallel.getData() ) );
+		REQUIRE( equal( serial.getSquaredData(), serial.getSquaredData() + size, parallel.getSquaredData() ) );
+	}
+
+	SECTION("8u adaptive threshold is unchanged")
+	{
+		for( int32_t windowSize : { 3, 16, 128 } ) {
+			for( float percentageDelta : { 0.05f, 0.15f } ) {
+				const Channel8u reference = adaptiveThresholdReference( channel, windowSize, percentageDelta );
+				Channel8u thresholded( channel.getWidth(), channel.getHeight() );
+				ip::adaptiveThreshold( channel, windowSize, percentageDelta, &thresholded );
+				REQUIRE( isEqual( thresholded, reference ) );
+
+				Channel8u inPlace = channel.clone();
+				ip::adaptiveThreshold( &inPlace, windowSize, percentageDelta );
+				REQUIRE( isEqual( inPlace, reference ) );
+
+				ip::adaptiveThreshold( ip::IntegralImage8u( channel, false, 4 ), channel, windowSize, percentageDelta, &thresholded );
+				REQUIRE( isEqual( thresholded, reference ) );
+			}
+		}
+	}
+
+	SECTION("Box blur of a constant is constant")
+	{
+		Channel8u constant( 16, 16 );
+		ip::fill( &constant, (uint8_t)42 );
+		Channel8u blurred( 16, 16 );
+		ip::boxBlur( ip::IntegralImage8u( constant ), 5, &blurred );
+		REQUIRE( *blurred.getData( 0, 0 ) == 42 );
+		REQUIRE( *blurred.getData( 8, 8 ) == 42 );
+	}
+}
@@ -0,0 +1,115 @@
+#include "cinder/ip/Morphology.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/Surface.h"
+#include "cinder/ChanTraits.h"
+
+#include "catch.hpp"
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+template<typename T>
+void randomize( ChannelT<T> *channel, uint32_t seed )
+{
+	for( int32_t y = 0; y < channel->getHeight(); ++y ) {
+		for( int32_t x = 0; x < channel->getWidth(); ++x ) {
+			seed = seed * 1664525u + 1013904223u;
+			// sparse peaks, like a thresholded mask, plus noise
+			const float v = ( ( seed >> 28 ) == 0 ) ? 1.0f : ( seed >> 8 ) / 16777216.0f * 0.5f;
+			channel->setValue( ivec2( x, y ), CHANTRAIT<T>::convert( v ) );
+		}
+	}
+}
+
+// Brute force erosion or dilation, ignoring pixels outside the channel
+template<typename T>
+ChannelT<T> reference( const ChannelT<T> &src, const ivec2 &radius, ip::StructuringElement element, bool erode )
+{
+	ChannelT<T> result( src.getWidth(), src.getHeight() );
+	for( int32_t y = 0; y < src.getHeight(); ++y ) {
+		for( int32_t x = 0; x < src.getWidth(); ++x ) {
+			T v = src.getValue( ivec2( x, y ) );
+			for( int32_t dy = -radius.y; dy <= radius.y; ++dy ) {
+				for( int32_t dx = -radius.x; dx <= radius.x; ++dx ) {
+					const ivec2 p( x + dx, y + dy );
+					if( ( element == ip::StructuringElement::CROSS && dx != 0 && dy != 0 ) || p.x < 0 || p.y < 0 || p.x >= src.getWidth() || p.y >= src.getHeight() )
+						continue;
+					v = erode ? std::min( v, src.getValue( p ) ) : std::max( v, src.getValue( p ) );
+				}
+			}
+			result.setValue( ivec2( x, y ), v );
+		}
+	}
+	return result;
+}
+
+template<typename T>
+bool equal( const ChannelT<T> &a, const ChannelT<T> &b )
+{
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		for( int32_t x = 0; x < a.getWidth(); ++x )
+			if( a.getValue( ivec2( x, y ) ) != b.getValue( ivec2( x, y ) ) )
+				return false;
+	return true;
+}
+
+template<typename T>
+void testMorphology()
+{
+	ChannelT<T> src( 83, 47 );
+	randomize( &src, 7 );
+	for( auto element : { ip::StructuringElement::RECT, ip::StructuringElement::CROSS } ) {
+		for( ivec2 radius : { ivec2( 0, 0 ), ivec2( 1, 1 ), ivec2( 2, 5 ), ivec2( 7, 0 ), ivec2( 12, 30 ), ivec2( 60, 3 ) } ) {
+			const ChannelT<T> eroded = reference( src, radius, element, true );
+			const ChannelT<T> dilated = reference( src, radius, element, false );
+			for( auto level : { simd::Level::SCALAR, simd::Level::SSE2, simd::Level::AVX2 } ) {
+				simd::ScopedMaxLevel scopedLevel( level );
+				INFO( "radius " << radius.x << "x" << radius.y << ", cross " << ( element == ip::StructuringElement::CROSS ) << ", level " << (int)level );
+				ChannelT<T> dst( src.getWidth(), src.getHeight() );
+				ip::erode( src, &dst, radius, element, 3 );
+				REQUIRE( equal( dst, eroded ) );
+				ip::dilate( src, &dst, radius, element, 3 );
+				REQUIRE( equal( dst, dilated ) );
+			}
+		}
+	}
+}
+
+} // anonymous namespace
+
+TEST_CASE("Morphology", "Channel")
+{
+	SECTION("Erosion and dilation match brute force")
+	{
+		testMorphology<uint8_t>();
+		testMorphology<uint16_t>();
+		testMorphology<float>();
+	}
+
+	SECTION("Compound operations, in-place and on interleaved channels")
+	{
+		Surface8u surface( 64, 40, true );
+		Channel8u green = surface.getChannelGreen();
+		randomize( &green, 3 );
+		const Channel8u src = green.clone();
+		const ivec2 radius( 3, 2 );
+
+		const Channel8u eroded = reference( src, radius, ip::StructuringElement::RECT, true );
+		const Channel8u opened = reference( eroded, radius, ip::StructuringElement::RECT, false );
+		ip::open( &green, radius );
+		REQUIRE( equal( green, opened ) );
+
+		green.copyFrom( src, src.getBounds() );
+		const Channel8u closed = reference( reference( src, radius, ip::StructuringElement::CROSS, false ), radius, ip::StructuringElement::CROSS, true );
+		ip::close( &green, radius, ip::StructuringElement::CROSS, 2 );
+		REQUIRE( equal( green, closed ) );
+
+		Channel8u gradient( src.getWidth(), src.getHeight() );
+		ip::morphologicalGradient( src, &gradient, radius );
+		const Channel8u dilated = reference( src, radius, ip::StructuringElement::RECT, false );
+		REQUIRE( gradient.getValue( ivec2( 10, 10 ) ) == dilated.getValue( ivec2( 10, 10 ) ) - eroded.getValue( ivec2( 10, 10 ) ) );
+		REQUIRE( gradient.getValue( ivec2( 63, 39 ) ) == dilated.getValue( ivec2( 63, 39 ) ) - eroded.getValue( ivec2( 63, 39 ) ) );
+	}
+}
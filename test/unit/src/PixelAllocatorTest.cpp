@@ -0,0 +1,117 @@
+#include "cinder/PixelAllocator.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+#include "catch.hpp"
+
+#include <thread>
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+bool isAligned( const void *data )
+{
+	return ( reinterpret_cast<uintptr_t>( data ) % PixelAllocator::ALIGNMENT ) == 0;
+}
+
+} // anonymous namespace
+
+TEST_CASE("PixelAllocator", "Allocation")
+{
+	SECTION("Storage is aligned for every allocator and pixel type")
+	{
+		PixelPoolRef pool = PixelPool::create();
+		for( size_t numBytes : { 0, 1, 3, 63, 64, 65, 1000, 12345 } ) {
+			REQUIRE( isAligned( PixelAllocator::getHeap()->allocate( numBytes ).get() ) );
+			REQUIRE( isAligned( pool->allocate( numBytes ).get() ) );
+			REQUIRE( isAligned( pool->allocate( numBytes ).get() ) ); // reused from the free list
+
+			void *data = PixelAllocator::alignedMalloc( numBytes );
+			REQUIRE( data );
+			REQUIRE( isAligned( data ) );
+			PixelAllocator::alignedFree( data );
+		}
+
+		for( int32_t width : { 1, 7, 33 } ) {
+			REQUIRE( isAligned( Surface8u( width, 5, false ).getData() ) );
+			REQUIRE( isAligned( Surface16u( width, 5, true ).getData() ) );
+			REQUIRE( isAligned( Surface32f( width, 5, true, SurfaceConstraintsAligned( 16, pool ) ).getData() ) );
+			REQUIRE( isAligned( Channel32f( width, 5 ).getData() ) );
+
+			// aligned constraints pad each row, so every row starts aligned
+			const Surface8u padded( width, 3, false, SurfaceConstraintsAligned() );
+			for( int32_t y = 0; y < padded.getHeight(); ++y )
+				REQUIRE( isAligned( padded.getData( ivec2( 0, y ) ) ) );
+		}
+	}
+
+	SECTION("Pools reuse released storage of the same size")
+	{
+		PixelPoolRef pool = PixelPool::create();
+		void *first = pool->allocate( 4096 ).get();
+		REQUIRE( pool->getNumFreeBytes() == 4096 );
+
+		auto reused = pool->allocate( 4096 );
+		REQUIRE( reused.get() == first );
+		REQUIRE( pool->getNumFreeBytes() == 0 );
+		REQUIRE( pool->getNumReused() == 1 );
+
+		auto other = pool->allocate( 2048 );
+		REQUIRE( pool->getNumAllocated() == 2 );
+	}
+
+	SECTION("Trimming releases pooled storage, largest first")
+	{
+		PixelPoolRef pool = PixelPool::create( 10000 );
+		{
+			auto a = pool->allocate( 1000 ), b = pool->allocate( 1000 ), c = pool->allocate( 3000 ), d = pool->allocate( 4000 );
+		}
+		REQUIRE( pool->getNumFreeBytes() == 9000 );
+
+		pool->setMaxFreeBytes( 5000 );
+		REQUIRE( pool->getMaxFreeBytes() == 5000 );
+		REQUIRE( pool->getNumFreeBytes() == 5000 );
+		pool->allocate( 3000 );
+		REQUIRE( pool->getNumReused() == 1 );
+		pool->allocate( 4000 );
+		REQUIRE( pool->getNumReused() == 1 );
+
+		// storage larger than the limit is freed immediately
+		pool->allocate( 6000 );
+		REQUIRE( pool->getNumFreeBytes() == 5000 );
+
+		pool->clear();
+		REQUIRE( pool->getNumFreeBytes() == 0 );
+		pool->allocate( 1000 );
+		REQUIRE( pool->getNumReused() == 1 );
+	}
+
+	SECTION("Storage outliving its pool is freed rather than returned")
+	{
+		PixelPoolRef pool = PixelPool::create();
+		Surface8u surface( 16, 16, true, SurfaceConstraintsAligned( 64, pool ) );
+		pool.reset();
+		surface = Surface8u();
+	}
+
+	SECTION("Every thread sees the installed allocator")
+	{
+		REQUIRE( PixelAllocator::get() == PixelAllocator::getHeap() );
+
+		PixelPoolRef pool = PixelPool::create();
+		PixelAllocator::set( pool );
+		REQUIRE( PixelAllocator::get() == pool );
+
+		PixelAllocatorRef seenByThread;
+		thread( [&] { seenByThread = PixelAllocator::get(); Channel8u channel( 10, 10 ); } ).join();
+		REQUIRE( seenByThread == pool );
+		REQUIRE( pool->getNumAllocated() == 1 );
+
+		PixelAllocator::set( nullptr );
+		REQUIRE( PixelAllocator::get() == PixelAllocator::getHeap() );
+		thread( [&] { seenByThread = PixelAllocator::get(); } ).join();
+		REQUIRE( seenByThread == PixelAllocator::getHeap() );
+	}
+}
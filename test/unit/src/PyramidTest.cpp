@@ -0,0 +1,117 @@
+#include "cinder/ip/Pyramid.h"
+#include "cinder/ip/Fill.h"
+#include "cinder/Rand.h"
+
+#include "catch.hpp"
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+template<typename T>
+SurfaceT<T> makeNoise( int32_t width, int32_t height, bool alpha, float maxValue )
+{
+	SurfaceT<T> result( width, height, alpha );
+	Rand rand( 5 );
+	for( int32_t y = 0; y < height; ++y )
+		for( int32_t x = 0; x < width; ++x )
+			result.setPixel( ivec2( x, y ), ColorAT<T>( T( rand.nextFloat() * maxValue ), T( rand.nextFloat() * maxValue ), T( rand.nextFloat() * maxValue ), T( rand.nextFloat() * maxValue ) ) );
+	return result;
+}
+
+template<typename T>
+float maxDifference( const SurfaceT<T> &a, const SurfaceT<T> &b )
+{
+	float result = 0;
+	for( int32_t y = 0; y < a.getHeight(); ++y ) {
+		for( int32_t x = 0; x < a.getWidth(); ++x ) {
+			const ColorAT<T> p = a.getPixel( ivec2( x, y ) ), q = b.getPixel( ivec2( x, y ) );
+			for( int c = 0; c < 4; ++c )
+				result = std::max( result, std::abs( float( p[c] ) - float( q[c] ) ) );
+		}
+	}
+	return result;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "Pyramid" )
+{
+	SECTION( "mipmap levels halve down to 1x1, rounding down" )
+	{
+		ip::Pyramid8u pyramid( makeNoise<uint8_t>( 37, 20, true, 255 ) );
+		REQUIRE( pyramid.getNumLevels() == 6 );
+		REQUIRE( pyramid.getLevel( 1 ).getSize() == ivec2( 18, 10 ) );
+		REQUIRE( pyramid.getLevel( 3 ).getSize() == ivec2( 4, 2 ) );
+		REQUIRE( pyramid.getLevel( 5 ).getSize() == ivec2( 1, 1 ) );
+		REQUIRE( pyramid.getLevel( 1 ).hasAlpha() );
+
+		ip::Pyramid8u limited( makeNoise<uint8_t>( 37, 20, true, 255 ), ip::Pyramid8u::Format().maxLevels( 3 ) );
+		REQUIRE( limited.getNumLevels() == 3 );
+	}
+
+	SECTION( "odd sizes average the area each pixel covers" )
+	{
+		Surface32f surface( 3, 1, false );
+		surface.setPixel( ivec2( 0, 0 ), Color( 0, 0, 0 ) );
+		surface.setPixel( ivec2( 1, 0 ), Color( 3, 3, 3 ) );
+		surface.setPixel( ivec2( 2, 0 ), Color( 6, 6, 6 ) );
+		ip::Pyramid32f pyramid( surface );
+		REQUIRE( pyramid.getNumLevels() == 2 );
+		REQUIRE( pyramid.getLevel( 1 ).getPixel( ivec2( 0 ) ).r == Approx( 3 ) );
+	}
+
+	SECTION( "sRGB averaging happens in linear light" )
+	{
+		Surface8u surface( 2, 2, false );
+		ip::fill( &surface, Color8u( 0, 0, 0 ) );
+		surface.setPixel( ivec2( 1, 0 ), Color8u( 255, 255, 255 ) );
+		surface.setPixel( ivec2( 1, 1 ), Color8u( 255, 255, 255 ) );
+
+		ip::Pyramid8u plain( surface );
+		REQUIRE( plain.getLevel( 1 ).getPixel( ivec2( 0 ) ).r == 128 );
+		ip::Pyramid8u srgb( surface, ip::Pyramid8u::Format().srgb() );
+		REQUIRE( srgb.getLevel( 1 ).getPixel( ivec2( 0 ) ).r == 188 );
+
+		Surface8u gray( 16, 16, false );
+		ip::fill( &gray, Color8u( 100, 100, 100 ) );
+		ip::Pyramid8u constant( gray, ip::Pyramid8u::Format().srgb() );
+		REQUIRE( constant.getLevel( 4 ).getPixel( ivec2( 0 ) ) == ColorA8u( 100, 100, 100, 255 ) );
+	}
+
+	SECTION( "parallel levels match serial" )
+	{
+		Surface16u surface = makeNoise<uint16_t>( 211, 157, true, 65535 );
+		for( auto type : { ip::Pyramid16u::Type::MIPMAP, ip::Pyramid16u::Type::GAUSSIAN, ip::Pyramid16u::Type::LAPLACIAN } ) {
+			ip::Pyramid16u serial( surface, ip::Pyramid16u::Format().type( type ).srgb() );
+			ip::Pyramid16u parallel( surface, ip::Pyramid16u::Format().type( type ).srgb().numThreads( 4 ) );
+			REQUIRE( serial.getNumLevels() == parallel.getNumLevels() );
+			for( size_t l = 0; l < serial.getNumLevels(); ++l )
+				REQUIRE( maxDifference( serial.getLevel( l ), parallel.getLevel( l ) ) == 0 );
+		}
+	}
+
+	SECTION( "Gaussian levels halve rounding up and preserve constants" )
+	{
+		Surface32f surface( 37, 20, false );
+		ip::fill( &surface, Color( 0.25f, 0.5f, 0.75f ) );
+		ip::Pyramid32f pyramid( surface, ip::Pyramid32f::Format().type( ip::Pyramid32f::Type::GAUSSIAN ) );
+		REQUIRE( pyramid.getNumLevels() == 7 );
+		REQUIRE( pyramid.getLevel( 1 ).getSize() == ivec2( 19, 10 ) );
+		REQUIRE( pyramid.getLevel( 6 ).getSize() == ivec2( 1, 1 ) );
+		REQUIRE( pyramid.getLevel( 3 ).getPixel( ivec2( 2, 1 ) ).g == Approx( 0.5f ) );
+	}
+
+	SECTION( "Laplacian pyramids reconstruct the original" )
+	{
+		Surface32f surface = makeNoise<float>( 53, 31, true, 1 );
+		ip::Pyramid32f pyramid( surface, ip::Pyramid32f::Format().type( ip::Pyramid32f::Type::LAPLACIAN ).srgb() );
+		REQUIRE( pyramid.getNumLevels() == 7 );
+		REQUIRE( maxDifference( pyramid.reconstruct(), surface ) < 1e-4f );
+
+		Surface8u surface8u = makeNoise<uint8_t>( 53, 31, false, 255 );
+		ip::Pyramid8u pyramid8u( surface8u, ip::Pyramid8u::Format().type( ip::Pyramid8u::Type::LAPLACIAN ) );
+		REQUIRE( maxDifference( pyramid8u.reconstruct(), surface8u ) <= 1 );
+	}
+}
@@ -0,0 +1,131 @@
+#include "cinder/ip/Resize.h"
+#include "cinder/ImageIo.h"
+
+#include "catch.hpp"
+
+using namespace ci;
+using namespace std;
+
+namespace {
+
+void randomize( uint32_t &seed, uint8_t *v )	{ seed = seed * 1664525u + 1013904223u; *v = (uint8_t)( seed >> 24 ); }
+void randomize( uint32_t &seed, uint16_t *v )	{ seed = seed * 1664525u + 1013904223u; *v = (uint16_t)( seed >> 16 ); }
+void randomize( uint32_t &seed, float *v )		{ seed = seed * 1664525u + 1013904223u; *v = ( seed >> 8 ) / 16777216.0f; }
+
+template<typename T>
+SurfaceT<T> makeSurface( int32_t width, int32_t height, bool alpha )
+{
+	SurfaceT<T> result( width, height, alpha, alpha ? SurfaceChannelOrder::BGRA : SurfaceChannelOrder::RGB );
+	uint32_t seed = width * height + 1;
+	for( int32_t y = 0; y < height; ++y )
+		for( int32_t x = 0; x < width * result.getPixelInc(); ++x )
+			randomize( seed, result.getData( ivec2( 0, y ) ) + x );
+	return result;
+}
+
+template<typename T>
+bool pixelsEqual( const SurfaceT<T> &a, const SurfaceT<T> &b )
+{
+	if( a.getSize() != b.getSize() || !( a.getChannelOrder() == b.getChannelOrder() ) )
+		return false;
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		for( int32_t x = 0; x < a.getWidth() * a.getPixelInc(); ++x )
+			if( a.getData( ivec2( 0, y ) )[x] != b.getData( ivec2( 0, y ) )[x] )
+				return false;
+	return true;
+}
+
+template<typename T>
+bool pixelsEqual( const ChannelT<T> &a, const ChannelT<T> &b )
+{
+	if( a.getSize() != b.getSize() )
+		return false;
+	for( int32_t y = 0; y < a.getHeight(); ++y )
+		for( int32_t x = 0; x < a.getWidth(); ++x )
+			if( a.getValue( ivec2( x, y ) ) != b.getValue( ivec2( x, y ) ) )
+				return false;
+	return true;
+}
+
+// pushes \a src through a ResizeStream one row at a time and compares against resizing the whole Surface
+template<typename T>
+void testResizeStream( const ivec2 &srcSize, const ivec2 &dstSize, const Area &dstArea, const FilterBase &filter, bool alpha )
+{
+	const SurfaceT<T> src = makeSurface<T>( srcSize.x, srcSize.y, alpha );
+	SurfaceT<T> expected = makeSurface<T>( dstSize.x, dstSize.y, alpha );
+	SurfaceT<T> streamed = expected.clone();
+
+	ip::resize( src, src.getBounds(), &expected, dstArea, filter );
+
+	ip::ResizeStream<T> stream( srcSize, &streamed, dstArea, filter );
+	for( int32_t y = 0; y < srcSize.y; ++y )
+		stream.pushRow( src.getData( ivec2( 0, y ) ) );
+	REQUIRE( stream.isComplete() );
+	REQUIRE( stream.getNumRowsPushed() == srcSize.y );
+	REQUIRE( pixelsEqual( expected, streamed ) );
+}
+
+// resizes \a src to \a dstSize with one thread and with \a numThreads, which should give identical pixels
+template<typename T>
+bool resizeMatchesSingleThreaded( const SurfaceT<T> &src, const ivec2 &dstSize, const FilterBase &filter, int numThreads )
+{
+	SurfaceT<T> single( dstSize.x, dstSize.y, src.hasAlpha(), src.getChannelOrder() ), multi = single.clone( false );
+	ip::resize( src, &single, filter, 1 );
+	ip::resize( src, &multi, filter, numThreads );
+
+	ChannelT<T> singleChannel( dstSize.x, dstSize.y ), multiChannel( dstSize.x, dstSize.y );
+	ip::resize( src.getChannelGreen(), &singleChannel, filter, 1 );
+	ip::resize( src.getChannelGreen(), &multiChannel, filter, numThreads );
+
+	return pixelsEqual( single, multi ) && pixelsEqual( singleChannel, multiChannel );
+}
+
+} // anonymous namespace
+
+TEST_CASE( "Resize" )
+{
+	SECTION( "ResizeStream matches resize" )
+	{
+		testResizeStream<uint8_t>( ivec2( 301, 207 ), ivec2( 64, 48 ), Area( 0, 0, 64, 48 ), FilterTriangle(), true );
+		testResizeStream<uint8_t>( ivec2( 97, 61 ), ivec2( 64, 48 ), Area( 0, 0, 64, 48 ), FilterGaussian(), false );
+		testResizeStream<uint8_t>( ivec2( 33, 20 ), ivec2( 90, 75 ), Area( 0, 0, 90, 75 ), FilterCubic(), true );
+		testResizeStream<uint8_t>( ivec2( 120, 80 ), ivec2( 64, 48 ), Area( -10, 5, 50, 70 ), FilterBox(), false );
+		testResizeStream<uint16_t>( ivec2( 150, 110 ), ivec2( 40, 30 ), Area( 0, 0, 40, 30 ), FilterSincBlackman(), true );
+		testResizeStream<float>( ivec2( 150, 110 ), ivec2( 40, 70 ), Area( 0, 0, 40, 70 ), FilterTriangle(), false );
+	}
+
+	SECTION( "Multithreaded resize matches a single thread" )
+	{
+		// non-square sizes with odd row counts leave bands of uneven height
+		for( int numThreads : { 2, 3, 4, 0 } ) {
+			REQUIRE( resizeMatchesSingleThreaded( makeSurface<uint8_t>( 211, 97, true ), ivec2( 83, 41 ), FilterCubic(), numThreads ) );
+			REQUIRE( resizeMatchesSingleThreaded( makeSurface<uint8_t>( 67, 29, false ), ivec2( 150, 113 ), FilterTriangle(), numThreads ) );
+			REQUIRE( resizeMatchesSingleThreaded( makeSurface<uint16_t>( 125, 77, true ), ivec2( 51, 33 ), FilterSincBlackman(), numThreads ) );
+			REQUIRE( resizeMatchesSingleThreaded( makeSurface<float>( 93, 151, false ), ivec2( 47, 99 ), FilterGaussian(), numThreads ) );
+
+			// an area of a larger destination, which offsets the bands
+			const Surface8u src = makeSurface<uint8_t>( 181, 59, true );
+			Surface8u single = makeSurface<uint8_t>( 100, 80, true ), multi = single.clone();
+			ip::resize( src, Area( 3, 1, 170, 58 ), &single, Area( 7, 2, 90, 79 ), FilterBox(), 1 );
+			ip::resize( src, Area( 3, 1, 170, 58 ), &multi, Area( 7, 2, 90, 79 ), FilterBox(), numThreads );
+			REQUIRE( pixelsEqual( single, multi ) );
+		}
+	}
+
+	SECTION( "Surface resizes an ImageSource while loading" )
+	{
+		const Surface8u src = makeSurface<uint8_t>( 257, 190, true );
+		const Surface8u loaded( src, ivec2( 50, 40 ), FilterCubic() );
+		Surface8u expected( 50, 40, true, SurfaceChannelOrder::RGBA );
+		ip::resize( src, &expected, FilterCubic() );
+		REQUIRE( pixelsEqual( expected, loaded ) );
+
+		// a source without alpha gets an opaque alpha channel, just as when loading at full size
+		const Surface8u opaque( makeSurface<uint8_t>( 64, 64, false ), ivec2( 16, 16 ), FilterTriangle(), SurfaceConstraintsDefault(), true );
+		bool allOpaque = true;
+		for( int32_t y = 0; y < 16; ++y )
+			for( int32_t x = 0; x < 16; ++x )
+				allOpaque = allOpaque && ( opaque.getDataAlpha( ivec2( x, y ) )[0] == 255 );
+		REQUIRE( allOpaque );
+	}
+}
@@ -0,0 +1,106 @@
+#include "catch.hpp"
+#include "cinder/audio/ContextOffline.h"
+#include "cinder/audio/GenNode.h"
+#include "cinder/audio/GainNode.h"
+#include "cinder/audio/Exception.h"
+#include "cinder/CinderMath.h"
+#include "cinder/DataTarget.h"
+#include "utils.h"
+
+#include <cstring>
+
+using namespace ci;
+using namespace ci::audio;
+
+namespace {
+
+ContextOfflineRef makeSineContext( size_t framesPerBlock, float gain = 0.5f )
+{
+	auto ctx = ContextOffline::create( 44100, framesPerBlock, 1 );
+	auto gen = ctx->makeNode( new GenSineNode( 441 ) );
+	auto gainNode = ctx->makeNode( new GainNode( gain ) );
+	gen >> gainNode >> ctx->getOutput();
+	gen->enable();
+	return ctx;
+}
+
+uint32_t readUint32( const uint8_t *data )
+{
+	return data[0] | ( data[1] << 8 ) | ( data[2] << 16 ) | ( uint32_t( data[3] ) << 24 );
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/ContextOffline" )
+{
+
+SECTION( "renders the graph in whole blocks" )
+{
+	auto ctx = makeSineContext( 256 );
+	BufferDynamic rendered;
+	ctx->render( 1000, &rendered );
+
+	REQUIRE( rendered.getNumFrames() == 1000 );
+	REQUIRE( rendered.getNumChannels() == 1 );
+	REQUIRE( ctx->getNumProcessedFrames() == 1024 );
+	REQUIRE( ! ctx->isEnabled() );
+
+	float maxErr = 0;
+	for( size_t i = 0; i < rendered.getNumFrames(); i++ )
+		maxErr = std::max( maxErr, std::fabs( rendered[i] - 0.5f * sinf( 2 * float( M_PI ) * 441 * i / 44100.0f ) ) );
+	REQUIRE( maxErr < 1e-4f );
+}
+
+SECTION( "consecutive renders are continuous and deterministic" )
+{
+	BufferDynamic whole, first, second;
+	makeSineContext( 128 )->render( 700, &whole );
+
+	auto ctx = makeSineContext( 128 );
+	ctx->render( 300, &first );
+	ctx->render( 400, &second );
+
+	audio::Buffer joined( 700, 1 );
+	joined.copyOffset( first, 300, 0, 0 );
+	joined.copyOffset( second, 400, 300, 0 );
+	REQUIRE( maxError( whole, joined ) == 0 );
+}
+
+SECTION( "streams to a wav TargetFile" )
+{
+	auto ctx = makeSineContext( 512, 2.0f );
+	OStreamMemRef stream = OStreamMem::create();
+	auto target = TargetFile::create( DataTargetStream::createRef( stream ), 44100, 1, SampleType::INT_16, "wav" );
+	ctx->render( 1500, target.get() );
+
+	const uint8_t *data = static_cast<const uint8_t*>( stream->getBuffer() );
+	REQUIRE( stream->tell() == 44 + 1500 * 2 );
+	REQUIRE( std::memcmp( data, "RIFF", 4 ) == 0 );
+	REQUIRE( readUint32( data + 4 ) == 36 + 1500 * 2 );
+	REQUIRE( readUint32( data + 40 ) == 1500 * 2 );
+
+	// the 2x gain clips at full scale rather than wrapping, as clip detection is disabled offline
+	int16_t peak;
+	std::memcpy( &peak, data + 44 + 25 * 2, 2 );
+	REQUIRE( peak == 32767 );
+}
+
+SECTION( "has no hardware and requires matching targets" )
+{
+	auto ctx = ContextOffline::create( 48000, 64, 2 );
+	REQUIRE( ctx->getSampleRate() == 48000 );
+	REQUIRE( ctx->getFramesPerBlock() == 64 );
+	REQUIRE_THROWS_AS( ctx->createOutputDeviceNode( nullptr ), const AudioContextExc& );
+
+	OStreamMemRef stream = OStreamMem::create();
+	auto target = TargetFile::create( DataTargetStream::createRef( stream ), 44100, 2 );
+	REQUIRE_THROWS_AS( ctx->render( 64, target.get() ), const AudioFormatExc& );
+
+	// an empty graph renders silence
+	BufferDynamic rendered;
+	ctx->render( 100, &rendered );
+	REQUIRE( rendered.getNumChannels() == 2 );
+	REQUIRE( rendered[0] == 0 );
+}
+
+}
@@ -0,0 +1,107 @@
+#include "catch.hpp"
+#include "cinder/audio/ContextOffline.h"
+#include "cinder/audio/ConvolverNode.h"
+#include "cinder/audio/SamplePlayerNode.h"
+#include "cinder/Rand.h"
+
+using namespace ci;
+using namespace ci::audio;
+
+namespace {
+
+audio::BufferRef makeNoise( size_t numFrames, size_t numChannels, float decay, uint32_t seed )
+{
+	Rand rand( seed );
+	auto result = std::make_shared<audio::Buffer>( numFrames, numChannels );
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		for( size_t i = 0; i < numFrames; i++ )
+			result->getChannel( ch )[i] = rand.nextFloat( -1, 1 ) * expf( -decay * i );
+	}
+	return result;
+}
+
+// Renders \a input through a ConvolverNode and returns the largest difference from direct convolution, relative to the peak output. Only every
+// \a frameStep'th frame is checked, which keeps long impulse responses quick to verify.
+float maxConvolutionError( const ContextOfflineRef &ctx, const audio::BufferRef &input, const audio::BufferRef &impulseResponse, size_t *numTailThreads, size_t frameStep = 1 )
+{
+	auto player = ctx->makeNode( new BufferPlayerNode( input ) );
+	auto convolver = ctx->makeNode( new ConvolverNode( impulseResponse ) );
+	player >> convolver >> ctx->getOutput();
+	player->start();
+
+	BufferDynamic rendered;
+	ctx->render( input->getNumFrames(), &rendered );
+	*numTailThreads = convolver->getNumTailThreads();
+
+	float maxErr = 0, peak = 0;
+	for( size_t ch = 0; ch < input->getNumChannels(); ch++ ) {
+		const float *x = input->getChannel( ch );
+		const float *h = impulseResponse->getChannel( ch % impulseResponse->getNumChannels() );
+		for( size_t n = 0; n < input->getNumFrames(); n += frameStep ) {
+			double expected = 0;
+			for( size_t k = 0; k <= n && k < impulseResponse->getNumFrames(); k++ )
+				expected += (double)x[n - k] * h[k];
+
+			maxErr = std::max( maxErr, std::fabs( rendered.getChannel( ch )[n] - float( expected ) ) );
+			peak = std::max( peak, std::fabs( float( expected ) ) );
+		}
+	}
+	return maxErr / peak;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/ConvolverNode" )
+{
+
+SECTION( "matches direct convolution across the head and background stages" )
+{
+	// with 64 frame blocks the head covers 512 frames, then stages of 256 and 1024 frame partitions cover the rest
+	size_t numTailThreads;
+	auto ctx = ContextOffline::create( 44100, 64, 2 );
+	REQUIRE( maxConvolutionError( ctx, makeNoise( 6000, 2, 0, 1 ), makeNoise( 5000, 1, 0.001f, 2 ), &numTailThreads ) < 1e-5f );
+	REQUIRE( numTailThreads == 2 );
+}
+
+SECTION( "supports block sizes that aren't a power of two and an impulse response per channel" )
+{
+	size_t numTailThreads;
+	auto ctx = ContextOffline::create( 44100, 100, 2 );
+	REQUIRE( maxConvolutionError( ctx, makeNoise( 3000, 2, 0, 3 ), makeNoise( 1000, 2, 0.002f, 4 ), &numTailThreads ) < 1e-5f );
+	REQUIRE( numTailThreads == 1 );
+}
+
+SECTION( "keeps partitions a whole number of blocks when they stop growing" )
+{
+	// with 480 frame blocks the partitions grow from 480 to 1920 and 7680 frames, as another 4x would exceed 16384. The last stage starts at
+	// 15360 frames and covers the rest of the impulse response with 7680 frame partitions.
+	size_t numTailThreads;
+	auto ctx = ContextOffline::create( 48000, 480, 1 );
+	REQUIRE( maxConvolutionError( ctx, makeNoise( 44100, 1, 0, 6 ), makeNoise( 41000, 1, 0.0001f, 7 ), &numTailThreads, 7 ) < 1e-5f );
+	REQUIRE( numTailThreads == 2 );
+}
+
+SECTION( "is silent without an impulse response and can change it while enabled" )
+{
+	auto ctx = ContextOffline::create( 44100, 64, 1 );
+	auto player = ctx->makeNode( new BufferPlayerNode( makeNoise( 1024, 1, 0, 5 ) ) );
+	auto convolver = ctx->makeNode( new ConvolverNode );
+	player >> convolver >> ctx->getOutput();
+	player->start();
+
+	BufferDynamic rendered;
+	ctx->render( 128, &rendered );
+	REQUIRE( rendered[100] == 0 );
+
+	// a unit impulse delayed by 700 frames, which lands in a background stage
+	auto impulse = std::make_shared<audio::Buffer>( 701 );
+	impulse->getData()[700] = 1;
+	convolver->setImpulseResponse( impulse );
+	REQUIRE( convolver->getNumTailThreads() == 1 );
+
+	ctx->render( 1024, &rendered );
+	REQUIRE( std::fabs( rendered[699] ) < 1e-6f );
+	REQUIRE( rendered[700] == Approx( player->getBuffer()->getData()[128] ) );
+}
+
+}
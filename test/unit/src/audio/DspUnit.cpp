@@ -0,0 +1,146 @@
+#include "catch.hpp"
+#include "cinder/app/App.h"
+#include "cinder/audio/dsp/Converter.h"
+#include "cinder/audio/dsp/Dsp.h"
+#include "cinder/CinderSimd.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+
+#include <functional>
+
+using namespace ci;
+using namespace ci::audio;
+
+namespace {
+
+std::vector<float> randomSamples( size_t length, uint32_t seed )
+{
+	Rand rand( seed );
+	std::vector<float> result( length );
+	for( auto &sample : result )
+		sample = rand.nextFloat( -1, 1 );
+	return result;
+}
+
+// Runs fn with the vector kernels and again with the scalar loops, returning both results
+std::pair<std::vector<float>, std::vector<float>> simdAndScalar( size_t length, const std::function<void( float *result )> &fn )
+{
+	std::vector<float> simd( length, -2.0f ), scalar( length, -2.0f );
+	fn( simd.data() );
+	simd::ScopedMaxLevel scopedLevel( simd::Level::SCALAR );
+	fn( scalar.data() );
+	return std::make_pair( simd, scalar );
+}
+
+void printTiming( const char *name, const std::function<void()> &fn )
+{
+	double seconds[2];
+	for( int scalar = 0; scalar < 2; scalar++ ) {
+		simd::ScopedMaxLevel scopedLevel( scalar ? simd::Level::SCALAR : simd::getMaxLevel() );
+		Timer timer( true );
+		for( int i = 0; i < 100000; i++ )
+			fn();
+		seconds[scalar] = timer.getSeconds();
+	}
+	app::console() << name << ": " << seconds[0] << "s, scalar: " << seconds[1] << "s" << std::endl;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/dsp" )
+{
+
+const auto a = randomSamples( 80, 1 );
+const auto b = randomSamples( 80, 2 );
+
+SECTION( "element-wise operations match the scalar loops" )
+{
+	// every tail length and an unaligned start
+	for( size_t offset : { 0, 1 } ) {
+		for( size_t length = 0; length < 67; length++ ) {
+			const float *inA = a.data() + offset;
+			const float *inB = b.data() + offset;
+			auto check = [&]( const std::function<void( float *result )> &fn ) {
+				auto results = simdAndScalar( length, fn );
+				REQUIRE( results.first == results.second );
+			};
+
+			check( [&]( float *result ) { dsp::fill( 0.25f, result, length ); } );
+			check( [&]( float *result ) { dsp::add( inA, inB, result, length ); } );
+			check( [&]( float *result ) { dsp::add( inA, 0.3f, result, length ); } );
+			check( [&]( float *result ) { dsp::sub( inA, inB, result, length ); } );
+			check( [&]( float *result ) { dsp::sub( inA, 0.3f, result, length ); } );
+			check( [&]( float *result ) { dsp::mul( inA, inB, result, length ); } );
+			check( [&]( float *result ) { dsp::mul( inA, 0.3f, result, length ); } );
+			check( [&]( float *result ) { dsp::addMul( inA, inB, 0.7f, result, length ); } );
+			check( [&]( float *result ) { std::copy( inA, inA + length, result ); dsp::normalize( result, length, 0.9f ); } );
+		}
+	}
+}
+
+SECTION( "reductions match the scalar loops" )
+{
+	for( size_t length = 1; length < 67; length++ ) {
+		float simdSum = dsp::sum( a.data() + 1, length );
+		float simdRms = dsp::rms( a.data() + 1, length );
+		float scalarSum, scalarRms;
+		{
+			simd::ScopedMaxLevel scopedLevel( simd::Level::SCALAR );
+			scalarSum = dsp::sum( a.data() + 1, length );
+			scalarRms = dsp::rms( a.data() + 1, length );
+		}
+
+		REQUIRE( simdSum == Approx( scalarSum ).epsilon( 1e-4 ) );
+		REQUIRE( simdRms == Approx( scalarRms ).epsilon( 1e-5 ) );
+	}
+}
+
+SECTION( "normalize ignores negative peaks and NaN's" )
+{
+	std::vector<float> samples( 20, -4.0f );
+	samples[3] = std::numeric_limits<float>::quiet_NaN();
+	samples[13] = 0.5f;
+	dsp::normalize( samples.data(), samples.size() );
+	REQUIRE( samples[13] == 1.0f );
+	REQUIRE( samples[0] == -8.0f );
+}
+
+SECTION( "sumBuffers adds whole and partial buffers" )
+{
+	audio::Buffer source( 33, 2 ), dest( 33, 2 );
+	std::copy( a.begin(), a.begin() + source.getSize(), source.getData() );
+	std::copy( b.begin(), b.begin() + dest.getSize(), dest.getData() );
+	const audio::Buffer original = dest;
+
+	dsp::sumBuffers( &source, &dest );
+	REQUIRE( dest.getChannel( 1 )[32] == original.getChannel( 1 )[32] + source.getChannel( 1 )[32] );
+
+	dest = original;
+	dsp::sumBuffers( &source, &dest, 20 );
+	REQUIRE( dest.getChannel( 1 )[19] == original.getChannel( 1 )[19] + source.getChannel( 1 )[19] );
+	REQUIRE( dest.getChannel( 1 )[20] == original.getChannel( 1 )[20] );
+}
+
+}
+
+// hidden from the default run, as it only prints timings: run with "[benchmark]"
+TEST_CASE( "audio/dsp benchmark", "[.][benchmark]" )
+{
+	const size_t length = 512;
+	const auto a = randomSamples( length, 1 );
+	const auto b = randomSamples( length, 2 );
+	std::vector<float> result( length );
+	volatile float reduced = 0;
+
+	app::console() << "audio::dsp, 100,000 calls over " << length << " samples:" << std::endl;
+	printTiming( "add", [&] { dsp::add( a.data(), b.data(), result.data(), length ); } );
+	printTiming( "mul", [&] { dsp::mul( a.data(), 0.5f, result.data(), length ); } );
+	printTiming( "addMul", [&] { dsp::addMul( a.data(), b.data(), 0.5f, result.data(), length ); } );
+	printTiming( "fill", [&] { dsp::fill( 0.5f, result.data(), length ); } );
+	printTiming( "sum", [&] { reduced = dsp::sum( a.data(), length ); } );
+	printTiming( "rms", [&] { reduced = dsp::rms( a.data(), length ); } );
+	printTiming( "normalize", [&] { dsp::normalize( result.data(), length ); } );
+
+	audio::Buffer source( length / 2, 2 ), dest( length / 2, 2 );
+	printTiming( "sumBuffers", [&] { dsp::sumBuffers( &source, &dest ); } );
+}
@@ -1,8 +1,3 @@
-#include "cinder/Cinder.h"
-
-// FIXME: OOURA roundtrip FFT seems to be broken on windows for sizeFft = 4 (https://github.com/cinder/Cinder/issues/1263)
-#if defined( CINDER_MAC )
-
 #include "catch.hpp"
 #include "utils.h"
 
@@ -56,5 +51,3 @@ SECTION( "round trip error" )
 }
 
 } // "audio/Fft"
-
-#endif // ! defined( CINDER_MSW )
@@ -0,0 +1,107 @@
+#include "catch.hpp"
+#include "cinder/audio/ContextOffline.h"
+#include "cinder/audio/GainNode.h"
+#include "cinder/audio/GenNode.h"
+#include "utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+using namespace ci;
+using namespace ci::audio;
+
+namespace {
+
+// Nodes are released on the Context's retire thread, so give it a moment.
+bool waitUntilExpired( const std::weak_ptr<Node> &node )
+{
+	for( int i = 0; i < 200 && ! node.expired(); i++ )
+		std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+
+	return node.expired();
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/GraphEdit" )
+{
+
+auto ctx = ContextOffline::create( 44100, 64, 1 );
+auto voice = ctx->makeNode( new GenSineNode( 441 ) );
+voice >> ctx->getOutput();
+voice->enable();
+
+BufferDynamic rendered;
+ctx->render( 64, &rendered );
+
+SECTION( "connections don't wait for the audio thread" )
+{
+	auto gain = ctx->makeNode( new GainNode( 0.5f ) );
+	auto other = ctx->makeNode( new GenSineNode( 882 ) );
+
+	// holding the mutex stands in for an audio thread that is busy processing
+	std::unique_lock<std::mutex> lock( ctx->getMutex() );
+	auto edit = std::async( std::launch::async, [&] {
+		other >> gain >> ctx->getOutput();
+		other->enable();
+		voice->disconnectAll();
+	} );
+
+	REQUIRE( edit.wait_for( std::chrono::seconds( 1 ) ) == std::future_status::ready );
+	lock.unlock();
+
+	ctx->render( 64, &rendered );
+	REQUIRE( ctx->getOutput()->getNumConnectedInputs() == 1 );
+	REQUIRE( std::fabs( rendered[10] - 0.5f * sinf( 2 * float( M_PI ) * 882 * 10 / 44100.0f ) ) < 1e-4f );
+}
+
+SECTION( "removed Nodes are released once the audio thread swaps" )
+{
+	std::weak_ptr<Node> weakVoice = voice;
+	voice->disconnectAll();
+	voice.reset();
+
+	// the block currently being pulled still references the voice
+	REQUIRE( ! weakVoice.expired() );
+
+	ctx->render( 64, &rendered );
+	REQUIRE( rendered[10] == 0 );
+	REQUIRE( waitUntilExpired( weakVoice ) );
+}
+
+SECTION( "Nodes disconnected while rendering are released without another edit" )
+{
+	std::weak_ptr<Node> weakVoice = voice;
+	std::atomic<bool> disconnected( false );
+	auto render = std::async( std::launch::async, [&] {
+		BufferDynamic buffer;
+		while( ! disconnected )
+			ctx->render( 64, &buffer );
+
+		ctx->render( 64, &buffer );
+	} );
+
+	voice->disconnectAll();
+	voice.reset();
+	disconnected = true;
+
+	render.wait();
+	REQUIRE( waitUntilExpired( weakVoice ) );
+}
+
+SECTION( "edits within a ScopedGraphEdit are published together" )
+{
+	auto gain = ctx->makeNode( new GainNode( 2.0f ) );
+	{
+		Context::ScopedGraphEdit edit( ctx.get() );
+		voice->disconnectAll();
+		voice >> gain >> ctx->getOutput();
+	}
+
+	ctx->render( 64, &rendered );
+	REQUIRE( rendered[10] == Approx( 2.0f * sinf( 2 * float( M_PI ) * 441 * ( 64 + 10 ) / 44100.0f ) ).epsilon( 1e-3 ) );
+}
+
+}
@@ -0,0 +1,115 @@
+#include "catch.hpp"
+#include "cinder/audio/ContextOffline.h"
+#include "cinder/audio/GraphScheduler.h"
+#include "cinder/audio/GainNode.h"
+#include "cinder/audio/MonitorNode.h"
+#include "utils.h"
+
+#include <cmath>
+
+using namespace ci;
+using namespace ci::audio;
+
+namespace {
+
+// Writes the same samples every block, so that blocks rendered at different times can be compared exactly.
+class PatternNode : public Node {
+  public:
+	PatternNode( float freq )
+		: Node( Format().channels( 1 ) ), mProcessedOffAudioThread( false ), mFreq( freq )
+	{}
+
+	bool mProcessedOffAudioThread;
+
+  protected:
+	void process( audio::Buffer *buffer ) override
+	{
+		float *data = buffer->getData();
+		for( size_t i = 0; i < buffer->getNumFrames(); i++ )
+			data[i] = std::sin( mFreq * i );
+
+		if( ! getContext()->isAudioThread() )
+			mProcessedOffAudioThread = true;
+	}
+
+  private:
+	float mFreq;
+};
+
+} // anonymous namespace
+
+TEST_CASE( "audio/GraphScheduler" )
+{
+
+SECTION( "parallel processing is identical to serial processing" )
+{
+	auto ctx = ContextOffline::create( 44100, 256, 2 );
+	auto mixer = ctx->makeNode( new GainNode( 0.25f ) );
+
+	std::vector<std::shared_ptr<PatternNode>> voices;
+	for( int i = 0; i < 12; i++ ) {
+		voices.push_back( ctx->makeNode( new PatternNode( 0.01f * ( i + 1 ) ) ) );
+		voices.back() >> ctx->makeNode( new GainNode( 1.0f / ( i + 1 ) ) ) >> mixer;
+	}
+
+	// a monitor tapping one branch is pulled after the output, so that branch can still be processed in parallel
+	auto monitor = ctx->makeNode( new MonitorNode );
+	voices[0]->getOutputs()[0] >> monitor;
+
+	// a voice feeding two inputs of the mixer makes both of those branches fall back to serial processing
+	voices.push_back( ctx->makeNode( new PatternNode( 0.5f ) ) );
+	voices.back() >> ctx->makeNode( new GainNode( 0.5f ) ) >> mixer;
+	voices.back() >> ctx->makeNode( new GainNode( 0.75f ) ) >> mixer;
+
+	mixer >> ctx->getOutput();
+	for( auto &voice : voices )
+		voice->enable();
+
+	BufferDynamic serial, parallel, serialAgain;
+	ctx->render( 256, &serial );
+	REQUIRE( ctx->getNumProcessingThreads() == 1 );
+	REQUIRE( ctx->getGraphScheduler() == nullptr );
+
+	ctx->setNumProcessingThreads( 4 );
+	REQUIRE( ctx->getNumProcessingThreads() == 4 );
+	REQUIRE( ctx->getGraphScheduler() != nullptr );
+
+	for( int block = 0; block < 20; block++ ) {
+		ctx->render( 256, &parallel );
+		REQUIRE( maxError( serial, parallel ) == 0 );
+	}
+
+	ctx->setNumProcessingThreads( 1 );
+	ctx->render( 256, &serialAgain );
+	REQUIRE( maxError( serial, serialAgain ) == 0 );
+
+	REQUIRE( std::fabs( serial[10] ) > 0.01f );
+	REQUIRE( monitor->getVolume() > 0 );
+}
+
+SECTION( "worker threads count as audio threads" )
+{
+	auto ctx = ContextOffline::create( 44100, 64, 1 );
+	ctx->setNumProcessingThreads( 3 );
+
+	auto mixer = ctx->makeNode( new GainNode( 1.0f ) );
+	std::vector<std::shared_ptr<PatternNode>> voices;
+	for( int i = 0; i < 8; i++ ) {
+		voices.push_back( ctx->makeNode( new PatternNode( 0.1f ) ) );
+		voices.back() >> mixer;
+		voices.back()->enable();
+	}
+	mixer >> ctx->getOutput();
+
+	BufferDynamic rendered;
+	ctx->render( 64 * 10, &rendered );
+	for( auto &voice : voices )
+		REQUIRE( ! voice->mProcessedOffAudioThread );
+
+	// reconnecting while processing in parallel recompiles the graph
+	voices[0]->disconnectAll();
+	ctx->render( 64, &rendered );
+	REQUIRE( rendered[1] == Approx( 7 * std::sin( 0.1f ) ) );
+}
+
+}
@@ -0,0 +1,101 @@
+#include "catch.hpp"
+#include "cinder/audio/ContextOffline.h"
+#include "cinder/audio/GainNode.h"
+#include "cinder/audio/Param.h"
+#include "cinder/CinderSimd.h"
+
+using namespace ci;
+using namespace ci::audio;
+
+namespace {
+
+// the accumulating loops the built-in ramps used to run
+float maxRampError( const RampFn &rampFn, double (*curve)( double ), size_t count, double t, double tIncr )
+{
+	std::vector<float> ramped( count );
+	rampFn( ramped.data(), count, t, tIncr, 2.0f, -1.0f );
+
+	float maxErr = 0;
+	for( size_t i = 0; i < count; i++ ) {
+		float expected = lerp( 2.0f, -1.0f, float( curve( t ) ) );
+		maxErr = std::max( maxErr, std::fabs( ramped[i] - expected ) );
+		t += tIncr;
+	}
+	return maxErr;
+}
+
+} // anonymous namespace
+
+TEST_CASE( "audio/Param" )
+{
+
+auto ctx = ContextOffline::create( 44100, 64, 1 );
+auto gain = ctx->makeNode( new GainNode( 1.0f ) );
+Param *param = gain->getParam();
+std::vector<float> block( 64 );
+
+SECTION( "built-in ramps match their curves at any SIMD level" )
+{
+	for( auto level : { simd::Level::AVX2, simd::Level::SSE2, simd::Level::SCALAR } ) {
+		simd::ScopedMaxLevel scopedLevel( level );
+		for( size_t count : { 1, 7, 64, 1001 } ) {
+			const double tIncr = 1.0 / count;
+			REQUIRE( maxRampError( rampLinear, []( double t ) { return t; }, count, 0, tIncr ) < 1e-5f );
+			REQUIRE( maxRampError( rampInQuad, []( double t ) { return t * t; }, count, 0.25, tIncr * 0.75 ) < 1e-5f );
+			REQUIRE( maxRampError( rampOutQuad, []( double t ) { return -t * ( t - 2 ); }, count, 0, tIncr ) < 1e-5f );
+		}
+	}
+}
+
+SECTION( "a hold over the whole block is constant" )
+{
+	param->applyRamp( 0.5f, 0.5f, 1.0 );
+	REQUIRE( ! param->eval( 0.1, block.data(), block.size(), 44100 ) );
+	REQUIRE( param->getValue() == 0.5f );
+	REQUIRE( param->getNumEvents() == 1 );
+
+	// a custom ramp may still vary between equal values
+	param->applyRamp( 0.5f, 0.5f, 1.0, Param::Options().rampFn( []( float *array, size_t count, double t, double tIncr, float valueBegin, float ) {
+		for( size_t i = 0; i < count; i++ )
+			array[i] = valueBegin + float( t + i * tIncr );
+	} ) );
+	REQUIRE( param->eval( 0.1, block.data(), block.size(), 44100 ) );
+}
+
+SECTION( "appended ramps follow the Event that ends last, even when it began first" )
+{
+	param->appendRamp( 0.25f, 1.0, Param::Options().beginTime( 0.0 ) );
+	param->appendRamp( 0.75f, 0.3, Param::Options().beginTime( 0.2 ) );
+	REQUIRE( param->findEndTimeAndValue().first == Approx( 1.0 ) );
+	REQUIRE( param->findEndTimeAndValue().second == 0.25f );
+	REQUIRE( param->findDuration() == Approx( 1.0f ) );
+
+	auto appended = param->appendRamp( 0.5f, 0.1 );
+	REQUIRE( appended->getTimeBegin() == Approx( 1.0 ) );
+	REQUIRE( appended->getValueBegin() == 0.25f );
+	REQUIRE( param->findDuration() == Approx( 1.1f ) );
+}
+
+SECTION( "Events are evaluated in time order and removed once complete" )
+{
+	auto later = param->appendRamp( 0.0f, 1.0f, 0.001, Param::Options().beginTime( 0.002 ) );
+	auto earlier = param->appendRamp( 1.0f, 0.0f, 0.001, Param::Options().beginTime( 0.0 ) );
+	REQUIRE( param->findEndTimeAndValue().first == Approx( 0.003 ) );
+
+	// the earlier ramp ends at sample 44 and the later one begins at sample 88
+	REQUIRE( param->eval( 0.0, block.data(), block.size(), 44100 ) );
+	REQUIRE( block[0] == 1.0f );
+	REQUIRE( block[22] == Approx( 0.5f ).epsilon( 0.02 ) );
+	REQUIRE( block[63] == 0.0f );
+
+	double time = 64 / 44100.0;
+	for( int i = 0; i < 3; i++, time += 64 / 44100.0 )
+		param->eval( time, block.data(), block.size(), 44100 );
+
+	REQUIRE( earlier->isComplete() );
+	REQUIRE( later->isComplete() );
+	REQUIRE( param->getNumEvents() == 0 );
+	REQUIRE( param->getValue() == 1.0f );
+}
+
+}